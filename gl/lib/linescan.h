@@ -0,0 +1,109 @@
+/* Count and locate line delimiters in a buffer.
+   Copyright (C) 2021 Free Software Foundation, Inc.
+
+   This program is free software: you can redistribute it and/or modify
+   it under the terms of the GNU General Public License as published by
+   the Free Software Foundation, either version 3 of the License, or
+   (at your option) any later version.
+
+   This program is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU General Public License for more details.
+
+   You should have received a copy of the GNU General Public License
+   along with this program.  If not, see <https://www.gnu.org/licenses/>.  */
+
+#ifndef LINESCAN_H
+# define LINESCAN_H 1
+
+# include <stdbool.h>
+# include <stdint.h>
+# include <string.h>
+
+/* These primitives centralize the buffer scans that the line-oriented
+   tools (head, tail, split, wc) used to open-code individually.  They
+   build on memchr and memrchr, whose system specific implementations
+   outweigh anything we could portably open-code here.  */
+
+/* Return the number of occurrences of DELIM in BUF[0..SIZE).
+   *LONG_LINES caches whether the previous block averaged at least 15
+   bytes per delimiter; initialize it to false and pass the same
+   location for each successive block of one stream.
+   If the average line length in the block is >= 15, then use memchr
+   for the next block, where system specific optimizations may
+   outweigh function call overhead.
+   FIXME: This line length was determined in 2015, on both x86_64 and
+   ppc64, but it's worth re-evaluating in future with newer compilers,
+   CPUs, or memchr() implementations etc.  */
+
+static inline uintmax_t
+count_delims (char const *buf, size_t size, char delim, bool *long_lines)
+{
+  uintmax_t delims = 0;
+  char const *p = buf;
+  char const *end = buf + size;
+
+  if (! *long_lines)
+    {
+      /* Avoid function call overhead for shorter lines.  */
+      while (p != end)
+        delims += *p++ == delim;
+    }
+  else
+    {
+      /* memchr is more efficient with longer lines.  */
+      while ((p = memchr (p, delim, end - p)))
+        {
+          ++p;
+          ++delims;
+        }
+    }
+
+  *long_lines = delims <= size / 15;
+  return delims;
+}
+
+/* Skip up to *N occurrences of DELIM in BUF[0..SIZE), decrementing *N
+   for each one found.  Return a pointer just past the occurrence that
+   makes *N zero (BUF if *N is zero on entry), or NULL if the buffer
+   holds fewer occurrences than that.  */
+
+static inline char const *
+skip_delims (char const *buf, size_t size, char delim, uintmax_t *n)
+{
+  char const *p = buf;
+  char const *end = buf + size;
+
+  while (*n && (p = memchr (p, delim, end - p)))
+    {
+      ++p;
+      --*n;
+    }
+  return *n == 0 ? p : NULL;
+}
+
+/* Scan BUF[0..SIZE) for DELIM from right to left, decrementing *N at
+   each occurrence skipped.  Return a pointer to the occurrence found
+   with *N zero — the one followed by *N complete lines — or NULL,
+   with *N decremented once per occurrence, if the buffer holds no
+   more than *N of them.  */
+
+static inline char const *
+rskip_delims (char const *buf, size_t size, char delim, uintmax_t *n)
+{
+  size_t scan = size;
+
+  while (scan)
+    {
+      char const *p = memrchr (buf, delim, scan);
+      if (! p)
+        break;
+      scan = p - buf;
+      if ((*n)-- == 0)
+        return p;
+    }
+  return NULL;
+}
+
+#endif
@@ -63,3 +63,14 @@ cycle_warning_required (FTS const *fts, FTSENT const *ent)
           || (ISSET (fts, FTS_PHYSICAL) && ISSET (fts, FTS_COMFOLLOW)
               && ent->fts_level != FTS_ROOTLEVEL));
 }
+
+/* Order entries by inode number, so that a traversal visits each
+   directory's entries in rough disk order rather than hashed readdir
+   order.  Usable as the comparison function of fts_open.  */
+int
+xfts_compare_ino (FTSENT const **a, FTSENT const **b)
+{
+  ino_t a_ino = (*a)->fts_statp->st_ino;
+  ino_t b_ino = (*b)->fts_statp->st_ino;
+  return a_ino < b_ino ? -1 : b_ino < a_ino;
+}
@@ -5,6 +5,10 @@ FTS *
 xfts_open (char * const *, int options,
            int (*) (const FTSENT **, const FTSENT **));
 
+int
+xfts_compare_ino (FTSENT const **a, FTSENT const **b)
+  _GL_ATTRIBUTE_PURE;
+
 bool
 cycle_warning_required (FTS const *fts, FTSENT const *ent)
   _GL_ATTRIBUTE_PURE;
@@ -0,0 +1,89 @@
+#!/bin/sh
+# Benchmark the checksum and digest programs, reporting throughput.
+
+# Copyright (C) 2021 Free Software Foundation, Inc.
+
+# This program is free software: you can redistribute it and/or modify
+# it under the terms of the GNU General Public License as published by
+# the Free Software Foundation, either version 3 of the License, or
+# (at your option) any later version.
+
+# This program is distributed in the hope that it will be useful,
+# but WITHOUT ANY WARRANTY; without even the implied warranty of
+# MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+# GNU General Public License for more details.
+
+# You should have received a copy of the GNU General Public License
+# along with this program.  If not, see <https://www.gnu.org/licenses/>.
+
+# Usage: scripts/bench-digest.sh [BINDIR]
+# or, from a built tree: make bench-digest
+#
+# Times each digest program over generated data held in the page
+# cache, for several input sizes, and reports the best throughput of
+# several runs in GB/s.  For cksum, the CRC32 kernel selected by the
+# cpuid dispatch (slice-by-8, pclmul or vpclmulqdq) is reported, so a
+# regression in kernel selection shows up next to the numbers it
+# explains.
+#
+# Environment:
+#   BENCH_DIGESTS    programs to time (default:
+#                      cksum sum md5sum sha1sum sha256sum b2sum)
+#   BENCH_SIZES_MB   input sizes in MiB (default: 16 64 256)
+#   BENCH_REPS       runs per measurement; the best is kept (default: 3)
+
+bindir=${1-./src}
+digests=${BENCH_DIGESTS-'cksum sum md5sum sha1sum sha256sum b2sum'}
+sizes_mb=${BENCH_SIZES_MB-'16 64 256'}
+reps=${BENCH_REPS-3}
+
+test -x "$bindir/cksum" || {
+  echo "$0: no cksum in $bindir; build first or pass BINDIR" >&2
+  exit 1
+}
+
+tmpdir=$(mktemp -d) || exit 1
+trap 'rm -rf "$tmpdir"' 0
+trap 'exit 1' 1 2 13 15
+
+max_mb=0
+for mb in $sizes_mb; do
+  test "$mb" -gt "$max_mb" && max_mb=$mb
+done
+
+# Generated once at the largest size; smaller sizes are prefixes.
+# Pseudo-random data defeats any branch-predictable byte patterns.
+head -c "$((max_mb * 1024 * 1024))" /dev/urandom > "$tmpdir/data" || exit 1
+
+# Report the CRC32 kernel the cpuid dispatch selected.
+kernel=$("$bindir/cksum" --debug < /dev/null 2>&1 > /dev/null \
+           | sed 's/.*: //;q')
+echo "cksum kernel: ${kernel:-slice-by-8 (no hardware support detected)}"
+echo
+
+printf '%-12s %8s %10s\n' program MiB GB/s
+
+for prog in $digests; do
+  test -x "$bindir/$prog" || {
+    echo "$0: skipping $prog: not in $bindir" >&2
+    continue
+  }
+  for mb in $sizes_mb; do
+    bytes=$((mb * 1024 * 1024))
+    head -c "$bytes" "$tmpdir/data" > "$tmpdir/in"
+    # Warm the page cache so the first run is not charged for I/O.
+    cat "$tmpdir/in" > /dev/null
+    best=
+    r=0
+    while test "$r" -lt "$reps"; do
+      start=$(date +%s%N)
+      "$bindir/$prog" < "$tmpdir/in" > /dev/null || exit 1
+      end=$(date +%s%N)
+      ns=$((end - start))
+      test -z "$best" || test "$ns" -lt "$best" && best=$ns
+      r=$((r + 1))
+    done
+    awk -v prog="$prog" -v mb="$mb" -v bytes="$bytes" -v ns="$best" \
+      'BEGIN { printf "%-12s %8d %10.2f\n", prog, mb, bytes / ns }'
+  done
+done
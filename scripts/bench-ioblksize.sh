@@ -0,0 +1,111 @@
+#!/bin/sh
+# Benchmark the I/O paths that ioblksize.h's IO_BUFSIZE serves.
+
+# Copyright (C) 2021 Free Software Foundation, Inc.
+
+# This program is free software: you can redistribute it and/or modify
+# it under the terms of the GNU General Public License as published by
+# the Free Software Foundation, either version 3 of the License, or
+# (at your option) any later version.
+
+# This program is distributed in the hope that it will be useful,
+# but WITHOUT ANY WARRANTY; without even the implied warranty of
+# MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+# GNU General Public License for more details.
+
+# You should have received a copy of the GNU General Public License
+# along with this program.  If not, see <https://www.gnu.org/licenses/>.
+
+# Usage: scripts/bench-ioblksize.sh [BINDIR]
+# or, from a built tree: make bench-ioblksize
+#
+# Replaces the hand-run dd table in ioblksize.h's comment: sweeps dd
+# over a range of block sizes to locate the syscall-overhead knee on
+# this machine and backend, then times cat, cp and split at their
+# built-in buffer size (IO_BUFSIZE) so the shipped constant can be
+# judged against the sweep.  Point BENCH_DIR at a directory on the
+# backend of interest (tmpfs, NVMe, NFS, ...) to compare them.
+#
+# The report is tab-separated on stdout, one measurement per line:
+#   program  blksize  filesystem  bytes  seconds  GB/s
+# with blksize '-' where the program chooses its own.  Diagnostics go
+# to stderr.
+#
+# Environment:
+#   BENCH_DIR       directory on the backend to measure (default: .)
+#   BENCH_FILE_MB   size of the data file in MiB (default: 256)
+#   BENCH_BS        dd block sizes in bytes
+#                     (default: 1024 doubling to 1048576)
+#   BENCH_REPS      runs per measurement; the best is kept (default: 3)
+
+bindir=${1-./src}
+dir=${BENCH_DIR-.}
+file_mb=${BENCH_FILE_MB-256}
+bs_list=${BENCH_BS-'1024 2048 4096 8192 16384 32768 65536
+                    131072 262144 524288 1048576'}
+reps=${BENCH_REPS-3}
+
+for prog in cat cp dd split; do
+  test -x "$bindir/$prog" || {
+    echo "$0: no $prog in $bindir; build first or pass BINDIR" >&2
+    exit 1
+  }
+done
+
+workdir=$(mktemp -d "$dir/bench-io.XXXXXX") || exit 1
+trap 'rm -rf "$workdir"' 0
+trap 'exit 1' 1 2 13 15
+
+fstype=$(stat -f -c %T "$workdir" 2>/dev/null) || fstype=unknown
+bytes=$((file_mb * 1024 * 1024))
+
+echo "$0: benchmarking in $workdir ($fstype), ${file_mb}MiB file" >&2
+
+head -c "$bytes" /dev/urandom > "$workdir/data" || exit 1
+# Warm the page cache, so reads measure the syscall loop and not the
+# backing store (except where the backend cannot cache, as with NFS
+# mounted with caching disabled).
+cat "$workdir/data" > /dev/null
+
+# Time one command, writing a report line.  Arguments: program label,
+# block size label, then the command to run.
+measure ()
+{
+  label=$1; bs_label=$2; shift 2
+  best=
+  r=0
+  while test "$r" -lt "$reps"; do
+    rm -f "$workdir/out" "$workdir/piece"*
+    start=$(date +%s%N)
+    "$@" || exit 1
+    end=$(date +%s%N)
+    ns=$((end - start))
+    test -z "$best" || test "$ns" -lt "$best" && best=$ns
+    r=$((r + 1))
+  done
+  awk -v label="$label" -v bs="$bs_label" -v fs="$fstype" \
+      -v bytes="$bytes" -v ns="$best" \
+    'BEGIN { printf "%s\t%s\t%s\t%d\t%.3f\t%.2f\n",
+             label, bs, fs, bytes, ns / 1e9, bytes / ns }'
+}
+
+# The dd sweep: pure read loop, then a write loop onto the backend.
+for bs in $bs_list; do
+  measure dd-read "$bs" \
+    "$bindir/dd" if="$workdir/data" of=/dev/null bs="$bs" status=none
+  measure dd-write "$bs" \
+    "$bindir/dd" if="$workdir/data" of="$workdir/out" bs="$bs" status=none
+done
+
+# The tools that size their buffers from io_blksize().  cat needs its
+# redirections wrapped so that measure can exec a simple command.
+run_cat_read () { "$bindir/cat" < "$workdir/data" > /dev/null; }
+run_cat_copy () { "$bindir/cat" < "$workdir/data" > "$workdir/out"; }
+
+measure cat-read - run_cat_read
+measure cat-copy - run_cat_copy
+measure cp - "$bindir/cp" "$workdir/data" "$workdir/out"
+measure split - \
+  "$bindir/split" -b "$((bytes / 8))" "$workdir/data" "$workdir/piece"
+
+exit 0
@@ -0,0 +1,75 @@
+/* AVX2 kernel for base64 encoding
+   Copyright (C) 2021 Free Software Foundation, Inc.
+
+   This program is free software: you can redistribute it and/or modify
+   it under the terms of the GNU General Public License as published by
+   the Free Software Foundation, either version 3 of the License, or
+   (at your option) any later version.
+
+   This program is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU General Public License for more details.
+
+   You should have received a copy of the GNU General Public License
+   along with this program.  If not, see <https://www.gnu.org/licenses/>.  */
+
+/* This is the shuffle-based vector encoder described by Wojciech Mula
+   in "Base64 encoding with SIMD instructions": each iteration turns
+   24 input bytes into 32 output characters, one 3-byte group per
+   32-bit word.  */
+
+#include <config.h>
+
+#include <stddef.h>
+#include <x86intrin.h>
+
+#include "base64-simd.h"
+
+size_t
+base64_encode_avx2 (char const *restrict in, size_t inlen,
+                    char *restrict out)
+{
+  /* Alphabet offsets, indexed by a classification of each 6-bit
+     value: 0..25 -> 'A', 26..51 -> 'a' - 26, 52..61 -> '0' - 52,
+     62 -> '+' - 62, 63 -> '/' - 63.  */
+  const __m256i lut = _mm256_setr_epi8 (
+    65, 71, -4, -4, -4, -4, -4, -4, -4, -4, -4, -4, -19, -16, 0, 0,
+    65, 71, -4, -4, -4, -4, -4, -4, -4, -4, -4, -4, -19, -16, 0, 0);
+
+  /* For each 3-byte group b0 b1 b2, gather the bytes so that each
+     32-bit word holds b1 b0 b2 b1, from which the four 6-bit fields
+     can be extracted with one multiply-high and one multiply-low.  */
+  const __m256i shuf = _mm256_set_epi8 (
+    10, 11, 9, 10, 7, 8, 6, 7, 4, 5, 3, 4, 1, 2, 0, 1,
+    10, 11, 9, 10, 7, 8, 6, 7, 4, 5, 3, 4, 1, 2, 0, 1);
+
+  size_t i = 0;
+  while (i + 32 <= inlen)
+    {
+      /* Bytes i..i+11 in the low lane, i+12..i+23 in the high lane;
+         the second load reads 4 bytes past i+23, hence the loop
+         bound.  */
+      __m256i data = _mm256_set_m128i (
+        _mm_loadu_si128 ((__m128i const *) (in + i + 12)),
+        _mm_loadu_si128 ((__m128i const *) (in + i)));
+      __m256i t = _mm256_shuffle_epi8 (data, shuf);
+
+      __m256i t0 = _mm256_and_si256 (t, _mm256_set1_epi32 (0x0fc0fc00));
+      __m256i t1 = _mm256_mulhi_epu16 (t0, _mm256_set1_epi32 (0x04000040));
+      __m256i t2 = _mm256_and_si256 (t, _mm256_set1_epi32 (0x003f03f0));
+      __m256i t3 = _mm256_mullo_epi16 (t2, _mm256_set1_epi32 (0x01000010));
+      __m256i field = _mm256_or_si256 (t1, t3);
+
+      __m256i idx = _mm256_subs_epu8 (field, _mm256_set1_epi8 (51));
+      __m256i gt25 = _mm256_cmpgt_epi8 (field, _mm256_set1_epi8 (25));
+      idx = _mm256_sub_epi8 (idx, gt25);
+      __m256i ascii = _mm256_add_epi8 (field, _mm256_shuffle_epi8 (lut, idx));
+
+      _mm256_storeu_si256 ((__m256i *) out, ascii);
+      out += 32;
+      i += 24;
+    }
+
+  return i;
+}
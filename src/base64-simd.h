@@ -0,0 +1,27 @@
+/* AVX2 kernel for base64 encoding
+   Copyright (C) 2021 Free Software Foundation, Inc.
+
+   This program is free software: you can redistribute it and/or modify
+   it under the terms of the GNU General Public License as published by
+   the Free Software Foundation, either version 3 of the License, or
+   (at your option) any later version.
+
+   This program is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU General Public License for more details.
+
+   You should have received a copy of the GNU General Public License
+   along with this program.  If not, see <https://www.gnu.org/licenses/>.  */
+
+#ifndef COREUTILS_BASE64_SIMD_H
+#define COREUTILS_BASE64_SIMD_H
+
+/* Encode a prefix of the INLEN bytes at IN to OUT with AVX2, and
+   return the number of input bytes consumed, a multiple of 24 that
+   may be zero.  The caller encodes the rest with the scalar code and
+   must only call this when the CPU supports AVX2.  */
+size_t base64_encode_avx2 (char const *restrict in, size_t inlen,
+                           char *restrict out);
+
+#endif
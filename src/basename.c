@@ -129,9 +129,17 @@ main (int argc, char **argv)
 
   initialize_main (&argc, &argv);
   set_program_name (argv[0]);
-  setlocale (LC_ALL, "");
-  bindtextdomain (PACKAGE, LOCALEDIR);
-  textdomain (PACKAGE);
+
+  /* The normal output is a byte-level operation on the operands, so
+     postpone locale setup until an argument looks like an option and
+     option parsing may print translated text.  Diagnostic paths below
+     call initialize_locale themselves.  */
+  for (int i = 1; i < argc; i++)
+    if (argv[i][0] == '-')
+      {
+        initialize_locale ();
+        break;
+      }
 
   atexit (close_stdout);
 
@@ -167,12 +175,14 @@ main (int argc, char **argv)
 
   if (argc < optind + 1)
     {
+      initialize_locale ();
       error (0, 0, _("missing operand"));
       usage (EXIT_FAILURE);
     }
 
   if (!multiple_names && optind + 2 < argc)
     {
+      initialize_locale ();
       error (0, 0, _("extra operand %s"), quote (argv[optind + 2]));
       usage (EXIT_FAILURE);
     }
@@ -55,6 +55,11 @@
 # error missing/invalid BASE_TYPE definition
 #endif
 
+#if USE_AVX2_BASE64 && BASE_TYPE != 32
+# include <cpuid.h>
+# include "base64-simd.h"
+#endif
+
 
 
 #if BASE_TYPE == 42
@@ -201,7 +206,7 @@ verify (DEC_BLOCKSIZE % 40 == 0);  /* So complete encoded blocks are used.  */
 verify (ENC_BLOCKSIZE % 12 == 0);  /* So padding chars only on last block.  */
 verify (DEC_BLOCKSIZE % 12 == 0);  /* So complete encoded blocks are used.  */
 
-# define base_encode base64_encode
+# define base_encode base64_encode_fast
 # define base_decode_context base64_decode_context
 # define base_decode_ctx_init base64_decode_ctx_init
 # define base_decode_ctx base64_decode_ctx
@@ -256,6 +261,48 @@ char const *restrict in, size_t inlen,
 char *restrict out, size_t *outlen);
 #endif
 
+#if BASE_TYPE != 32
+
+# if USE_AVX2_BASE64
+/* Whether the CPU supports the AVX2 encoding kernel;
+   -1 before the first probe.  */
+static int have_avx2 = -1;
+
+static int
+avx2_supported (void)
+{
+  unsigned int eax = 0, ebx = 0, ecx = 0, edx = 0;
+
+  if (!__get_cpuid_count (7, 0, &eax, &ebx, &ecx, &edx))
+    return 0;
+
+  return (ebx & bit_AVX2) != 0;
+}
+# endif
+
+/* Encode like base64_encode, processing the bulk of IN with the AVX2
+   kernel when the CPU has it and finishing with the scalar code.  */
+static void
+base64_encode_fast (char const *restrict in, size_t inlen,
+                    char *restrict out, size_t outlen)
+{
+# if USE_AVX2_BASE64
+  if (have_avx2 < 0)
+    have_avx2 = avx2_supported ();
+
+  if (have_avx2)
+    {
+      size_t done = base64_encode_avx2 (in, inlen, out);
+      in += done;
+      inlen -= done;
+      out += done / 3 * 4;
+      outlen -= done / 3 * 4;
+    }
+# endif
+  base64_encode (in, inlen, out, outlen);
+}
+#endif
+
 
 
 
@@ -305,7 +352,7 @@ static void
 base64url_encode (char const *restrict in, size_t inlen,
                   char *restrict out, size_t outlen)
 {
-  base64_encode (in, inlen, out, outlen);
+  base64_encode_fast (in, inlen, out, outlen);
   /* translate 62nd and 63rd characters */
   char* p = out;
   while (outlen--)
@@ -931,39 +978,57 @@ base2msbf_decode_ctx (struct base_decode_context *ctx,
 
 
 
+/* Buffer into which wrapped output is assembled, with the newlines
+   already placed at the wrap columns, so each encoded block reaches
+   OUT as one write instead of one write per output line.  */
+static char *wrap_buf;
+static size_t wrap_buf_size;
+
 static void
 wrap_write (char const *buffer, size_t len,
             uintmax_t wrap_column, size_t *current_column, FILE *out)
 {
-  size_t written;
-
   if (wrap_column == 0)
     {
       /* Simple write. */
       if (fwrite (buffer, 1, len, stdout) < len)
         die (EXIT_FAILURE, errno, _("write error"));
+      return;
     }
-  else
-    for (written = 0; written < len;)
-      {
-        uintmax_t cols_remaining = wrap_column - *current_column;
-        size_t to_write = MIN (cols_remaining, SIZE_MAX);
-        to_write = MIN (to_write, len - written);
-
-        if (to_write == 0)
-          {
-            if (fputc ('\n', out) == EOF)
-              die (EXIT_FAILURE, errno, _("write error"));
-            *current_column = 0;
-          }
-        else
-          {
-            if (fwrite (buffer + written, 1, to_write, stdout) < to_write)
-              die (EXIT_FAILURE, errno, _("write error"));
-            *current_column += to_write;
-            written += to_write;
-          }
-      }
+
+  /* LEN data bytes, plus at most one newline per wrap column.  */
+  size_t need = len + len / MIN (wrap_column, SIZE_MAX) + 2;
+  if (wrap_buf_size < need)
+    {
+      free (wrap_buf);
+      wrap_buf = xmalloc (need);
+      wrap_buf_size = need;
+    }
+
+  char *o = wrap_buf;
+  for (size_t written = 0; written < len;)
+    {
+      uintmax_t cols_remaining = wrap_column - *current_column;
+      size_t to_write = MIN (cols_remaining, SIZE_MAX);
+      to_write = MIN (to_write, len - written);
+
+      if (to_write == 0)
+        {
+          *o++ = '\n';
+          *current_column = 0;
+        }
+      else
+        {
+          memcpy (o, buffer + written, to_write);
+          o += to_write;
+          *current_column += to_write;
+          written += to_write;
+        }
+    }
+
+  size_t assembled = o - wrap_buf;
+  if (fwrite (wrap_buf, 1, assembled, out) < assembled)
+    die (EXIT_FAILURE, errno, _("write error"));
 }
 
 static void
@@ -1009,6 +1074,7 @@ do_encode (FILE *in, FILE *out, uintmax_t wrap_column)
 
   IF_LINT (free (inbuf));
   IF_LINT (free (outbuf));
+  IF_LINT (free (wrap_buf));
 }
 
 static void
@@ -1152,7 +1218,7 @@ main (int argc, char **argv)
     case BASE64_OPTION:
       base_length = base64_length_wrapper;
       isbase = isbase64;
-      base_encode = base64_encode;
+      base_encode = base64_encode_fast;
       base_decode_ctx_init = base64_decode_ctx_init_wrapper;
       base_decode_ctx = base64_decode_ctx_wrapper;
       break;
@@ -0,0 +1,133 @@
+/*
+   BLAKE2 AVX2 compression function, in the style of the reference
+   implementation in blake2b-ref.c.  You may use this under the
+   terms of the CC0, the OpenSSL Licence, or the Apache Public License 2.0, at
+   your option.  The terms of these licenses can be found at:
+
+   - CC0 1.0 Universal : https://creativecommons.org/publicdomain/zero/1.0
+   - OpenSSL license   : https://www.openssl.org/source/license.html
+   - Apache 2.0        : https://www.apache.org/licenses/LICENSE-2.0
+
+   More information about the BLAKE2 hash function can be found at
+   https://blake2.net.
+*/
+
+#ifdef HAVE_CONFIG_H
+# include <config.h>
+#endif
+
+#include <stdint.h>
+#include <immintrin.h>
+
+#include "blake2.h"
+#include "blake2-impl.h"
+
+static const uint64_t blake2b_IV[8] =
+{
+  0x6a09e667f3bcc908ULL, 0xbb67ae8584caa73bULL,
+  0x3c6ef372fe94f82bULL, 0xa54ff53a5f1d36f1ULL,
+  0x510e527fade682d1ULL, 0x9b05688c2b3e6c1fULL,
+  0x1f83d9abfb41bd6bULL, 0x5be0cd19137e2179ULL
+};
+
+static const uint8_t blake2b_sigma[12][16] =
+{
+  {  0,  1,  2,  3,  4,  5,  6,  7,  8,  9, 10, 11, 12, 13, 14, 15 } ,
+  { 14, 10,  4,  8,  9, 15, 13,  6,  1, 12,  0,  2, 11,  7,  5,  3 } ,
+  { 11,  8, 12,  0,  5,  2, 15, 13, 10, 14,  3,  6,  7,  1,  9,  4 } ,
+  {  7,  9,  3,  1, 13, 12, 11, 14,  2,  6,  5, 10,  4,  0, 15,  8 } ,
+  {  9,  0,  5,  7,  2,  4, 10, 15, 14,  1, 11, 12,  6,  8,  3, 13 } ,
+  {  2, 12,  6, 10,  0, 11,  8,  3,  4, 13,  7,  5, 15, 14,  1,  9 } ,
+  { 12,  5,  1, 15, 14, 13,  4, 10,  0,  7,  6,  3,  9,  2,  8, 11 } ,
+  { 13, 11,  7, 14, 12,  1,  3,  9,  5,  0, 15,  4,  8,  6,  2, 10 } ,
+  {  6, 15, 14,  9, 11,  3,  0,  8, 12,  2, 13,  7,  1,  4, 10,  5 } ,
+  { 10,  2,  8,  4,  7,  6,  1,  5, 15, 11,  9, 14,  3, 12, 13 , 0 } ,
+  {  0,  1,  2,  3,  4,  5,  6,  7,  8,  9, 10, 11, 12, 13, 14, 15 } ,
+  { 14, 10,  4,  8,  9, 15, 13,  6,  1, 12,  0,  2, 11,  7,  5,  3 }
+};
+
+/* Rotations by 32 and 24/16 bits are lane shuffles; 63 is add+shift.  */
+#define ROT32(x) _mm256_shuffle_epi32( (x), _MM_SHUFFLE( 2, 3, 0, 1 ) )
+#define ROT24(x) _mm256_shuffle_epi8( (x), r24 )
+#define ROT16(x) _mm256_shuffle_epi8( (x), r16 )
+#define ROT63(x) _mm256_or_si256( _mm256_srli_epi64( (x), 63 ), \
+                                  _mm256_add_epi64( (x), (x) ) )
+
+/* The four column (or diagonal) G functions, computed lane-wise.  */
+#define G1(a,b,c,d,m)                                   \
+  do {                                                  \
+    a = _mm256_add_epi64( _mm256_add_epi64( a, m ), b );\
+    d = ROT32( _mm256_xor_si256( d, a ) );              \
+    c = _mm256_add_epi64( c, d );                       \
+    b = ROT24( _mm256_xor_si256( b, c ) );              \
+  } while(0)
+
+#define G2(a,b,c,d,m)                                   \
+  do {                                                  \
+    a = _mm256_add_epi64( _mm256_add_epi64( a, m ), b );\
+    d = ROT16( _mm256_xor_si256( d, a ) );              \
+    c = _mm256_add_epi64( c, d );                       \
+    b = ROT63( _mm256_xor_si256( b, c ) );              \
+  } while(0)
+
+/* Rotate rows so that each lane holds one diagonal, and back.  */
+#define DIAGONALIZE(b,c,d)                                        \
+  do {                                                            \
+    b = _mm256_permute4x64_epi64( b, _MM_SHUFFLE( 0, 3, 2, 1 ) ); \
+    c = _mm256_permute4x64_epi64( c, _MM_SHUFFLE( 1, 0, 3, 2 ) ); \
+    d = _mm256_permute4x64_epi64( d, _MM_SHUFFLE( 2, 1, 0, 3 ) ); \
+  } while(0)
+
+#define UNDIAGONALIZE(b,c,d)                                      \
+  do {                                                            \
+    b = _mm256_permute4x64_epi64( b, _MM_SHUFFLE( 2, 1, 0, 3 ) ); \
+    c = _mm256_permute4x64_epi64( c, _MM_SHUFFLE( 1, 0, 3, 2 ) ); \
+    d = _mm256_permute4x64_epi64( d, _MM_SHUFFLE( 0, 3, 2, 1 ) ); \
+  } while(0)
+
+void blake2b_compress_avx2( blake2b_state *S, const uint8_t block[BLAKE2B_BLOCKBYTES] )
+{
+  const __m256i r24 = _mm256_setr_epi8(  3,  4,  5,  6,  7,  0,  1,  2,
+                                        11, 12, 13, 14, 15,  8,  9, 10,
+                                         3,  4,  5,  6,  7,  0,  1,  2,
+                                        11, 12, 13, 14, 15,  8,  9, 10 );
+  const __m256i r16 = _mm256_setr_epi8(  2,  3,  4,  5,  6,  7,  0,  1,
+                                        10, 11, 12, 13, 14, 15,  8,  9,
+                                         2,  3,  4,  5,  6,  7,  0,  1,
+                                        10, 11, 12, 13, 14, 15,  8,  9 );
+  uint64_t m[16];
+  __m256i a, b, c, d;
+  size_t i, r;
+
+  for( i = 0; i < 16; ++i ) {
+    m[i] = load64( block + i * sizeof( m[i] ) );
+  }
+
+  /* Lane i of row a is v[i], of row b v[4+i], and so on.  */
+  a = _mm256_loadu_si256( ( const __m256i * )( S->h + 0 ) );
+  b = _mm256_loadu_si256( ( const __m256i * )( S->h + 4 ) );
+  c = _mm256_loadu_si256( ( const __m256i * )( blake2b_IV + 0 ) );
+  d = _mm256_xor_si256(
+        _mm256_loadu_si256( ( const __m256i * )( blake2b_IV + 4 ) ),
+        _mm256_setr_epi64x( S->t[0], S->t[1], S->f[0], S->f[1] ) );
+
+  for( r = 0; r < 12; ++r ) {
+    const uint8_t *s = blake2b_sigma[r];
+
+    G1( a, b, c, d, _mm256_setr_epi64x( m[s[ 0]], m[s[ 2]], m[s[ 4]], m[s[ 6]] ) );
+    G2( a, b, c, d, _mm256_setr_epi64x( m[s[ 1]], m[s[ 3]], m[s[ 5]], m[s[ 7]] ) );
+    DIAGONALIZE( b, c, d );
+    G1( a, b, c, d, _mm256_setr_epi64x( m[s[ 8]], m[s[10]], m[s[12]], m[s[14]] ) );
+    G2( a, b, c, d, _mm256_setr_epi64x( m[s[ 9]], m[s[11]], m[s[13]], m[s[15]] ) );
+    UNDIAGONALIZE( b, c, d );
+  }
+
+  a = _mm256_xor_si256( a, c );
+  b = _mm256_xor_si256( b, d );
+  a = _mm256_xor_si256( a,
+        _mm256_loadu_si256( ( const __m256i * )( S->h + 0 ) ) );
+  b = _mm256_xor_si256( b,
+        _mm256_loadu_si256( ( const __m256i * )( S->h + 4 ) ) );
+  _mm256_storeu_si256( ( __m256i * )( S->h + 0 ), a );
+  _mm256_storeu_si256( ( __m256i * )( S->h + 4 ), b );
+}
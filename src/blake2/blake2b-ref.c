@@ -24,6 +24,10 @@
 #include "blake2.h"
 #include "blake2-impl.h"
 
+#if USE_AVX2_BLAKE2
+# include <cpuid.h>
+#endif
+
 static const uint64_t blake2b_IV[8] =
 {
   0x6a09e667f3bcc908ULL, 0xbb67ae8584caa73bULL,
@@ -178,7 +182,7 @@ int blake2b_init_key( blake2b_state *S, size_t outlen, const void *key, size_t k
     G(r,7,v[ 3],v[ 4],v[ 9],v[14]); \
   } while(0)
 
-static void blake2b_compress( blake2b_state *S, const uint8_t block[BLAKE2B_BLOCKBYTES] )
+static void blake2b_compress_ref( blake2b_state *S, const uint8_t block[BLAKE2B_BLOCKBYTES] )
 {
   uint64_t m[16];
   uint64_t v[16];
@@ -222,6 +226,37 @@ static void blake2b_compress( blake2b_state *S, const uint8_t block[BLAKE2B_BLOC
 #undef G
 #undef ROUND
 
+#if USE_AVX2_BLAKE2
+/* Whether the CPU supports the AVX2 compression function;
+   -1 before the first probe.  */
+static int have_avx2 = -1;
+
+static int avx2_supported( void )
+{
+  unsigned int eax = 0, ebx = 0, ecx = 0, edx = 0;
+
+  if( !__get_cpuid_count( 7, 0, &eax, &ebx, &ecx, &edx ) )
+    return 0;
+
+  return ( ebx & bit_AVX2 ) != 0;
+}
+#endif
+
+static void blake2b_compress( blake2b_state *S, const uint8_t block[BLAKE2B_BLOCKBYTES] )
+{
+#if USE_AVX2_BLAKE2
+  if( have_avx2 < 0 )
+    have_avx2 = avx2_supported();
+
+  if( have_avx2 )
+    {
+      blake2b_compress_avx2( S, block );
+      return;
+    }
+#endif
+  blake2b_compress_ref( S, block );
+}
+
 int blake2b_update( blake2b_state *S, const void *pin, size_t inlen )
 {
   const unsigned char * in = (const unsigned char *)pin;
@@ -39,6 +39,7 @@
 #include "fadvise.h"
 #include "full-write.h"
 #include "safe-read.h"
+#include "stdbuf-policy.h"
 #include "xbinary-io.h"
 
 /* The official name of this program (e.g., no 'g' prefix).  */
@@ -236,6 +237,11 @@ simple_cat (
   /* Actual number of characters read, and therefore written.  */
   size_t n_read;
 
+  /* Buffer for the transformed output.  Each input byte expands to at
+     most 4 output bytes, so one allocation up front is enough for any
+     block, avoiding a sizing prescan and a malloc/free per read.  */
+  char *unibuf = xmalloc (bufsize * 4);
+
   /* Loop until the end of the file.  */
 
   while (true)
@@ -246,37 +252,22 @@ simple_cat (
       if (n_read == SAFE_READ_ERROR)
         {
           error (0, errno, "%s", quotef (infile));
+          free (unibuf);
           return false;
         }
 
       /* End of this file?  */
 
       if (n_read == 0)
-        return true;
-
-      /* Compute the size of the unicode buffer */
-
-      size_t uclen = 0;
-      for (int i = 0; i < n_read; i++) {
-        char c = buf[i];
-        char *puc = &buf[i];
-        if (c >= 'A' && c <= 'Z') {
-          puc = uppercase + (c - 'A') * 4;
-        } else if (c >= 'a' && c <= 'z') {
-          puc = lowercase + (c - 'a') * 2;
+        {
+          free (unibuf);
+          return true;
         }
-        uclen += char_size(puc);
-      }
 
-      /* Allocate unibuf and copy unicode characters into it */
+      /* Copy unicode characters into unibuf in a single pass */
 
-      char *unibuf = xmalloc (uclen);
-      if (unibuf == 0) {
-        die (EXIT_FAILURE, errno, _("out of memory error"));
-      }
-
-      int unibuf_offset = 0;
-      for (int i = 0; i < n_read; i++) {
+      size_t uclen = 0;
+      for (size_t i = 0; i < n_read; i++) {
         char c = buf[i];
         char *puc = &buf[i];
         if (c >= 'A' && c <= 'Z') {
@@ -286,17 +277,13 @@ simple_cat (
         }
         size_t clen = char_size (puc);
         for (size_t j = 0; j < clen; j++) {
-          unibuf[unibuf_offset++] = puc[j];
+          unibuf[uclen++] = puc[j];
         }
       }
-      {
-        /* The following is ok, since we know that 0 < n_read.  */
-        size_t n = uclen;
-        if (full_write (STDOUT_FILENO, unibuf, n) != n)
-          die (EXIT_FAILURE, errno, _("write error"));
 
-        free (unibuf);
-      }
+      /* The following is ok, since we know that 0 < n_read.  */
+      if (full_write (STDOUT_FILENO, unibuf, uclen) != uclen)
+        die (EXIT_FAILURE, errno, _("write error"));
     }
 }
 
@@ -618,6 +605,161 @@ cat (
     }
 }
 
+/* Plain cat with line numbering (-n or -b) and no other formatting.
+   Scan whole buffers with memchr instead of inspecting every byte,
+   copying line bodies wholesale and batching the formatted numbers
+   into OUTBUF.  Pending output is flushed before each read so that a
+   blocking input cannot delay lines that are already complete.
+   Return true if successful.  */
+
+static bool
+number_cat (char *inbuf, size_t insize, char *outbuf, size_t outsize,
+            bool number_nonblank)
+{
+  /* Stage at most this many bytes in OUTBUF before writing.  The
+     caller's allocation leaves LINE_COUNTER_BUF_LEN slack above it.  */
+  size_t stage = outsize - 1 + insize;
+  char *bpout = outbuf;
+  bool at_bol = newlines2 >= 0;
+
+  while (true)
+    {
+      write_pending (outbuf, &bpout);
+
+      size_t n_read = safe_read (input_desc, inbuf, insize);
+      if (n_read == SAFE_READ_ERROR)
+        {
+          error (0, errno, "%s", quotef (infile));
+          newlines2 = at_bol ? 0 : -1;
+          return false;
+        }
+      if (n_read == 0)
+        {
+          newlines2 = at_bol ? 0 : -1;
+          return true;
+        }
+
+      char *bpin = inbuf;
+      char *eob = inbuf + n_read;
+      while (bpin < eob)
+        {
+          /* Number the line starting here, unless it is an empty
+             line excluded by -b.  */
+          if (at_bol && ! (number_nonblank && *bpin == '\n'))
+            {
+              if (stage < bpout - outbuf + LINE_COUNTER_BUF_LEN)
+                write_pending (outbuf, &bpout);
+              next_line_num ();
+              bpout = stpcpy (bpout, line_num_print);
+            }
+
+          char *nl = memchr (bpin, '\n', eob - bpin);
+          size_t len = (nl ? nl + 1 : eob) - bpin;
+          at_bol = nl != NULL;
+
+          if (outsize <= len)
+            {
+              /* A chunk this large is cheaper to write directly.  */
+              write_pending (outbuf, &bpout);
+              if (full_write (STDOUT_FILENO, bpin, len) != len)
+                die (EXIT_FAILURE, errno, _("write error"));
+            }
+          else
+            {
+              if (stage < bpout - outbuf + len)
+                write_pending (outbuf, &bpout);
+              bpout = mempcpy (bpout, bpin, len);
+            }
+          bpin += len;
+        }
+    }
+}
+
+/* Plain cat with blank-line squeezing (-s) and no other formatting.
+   Rather than tracking newline state per byte, locate runs of blank
+   lines with memchr and write the spans between them wholesale, so
+   the common non-blank stretches cost one write each.  Return true
+   if successful.  */
+
+static bool
+squeeze_cat (char *inbuf, size_t insize)
+{
+  /* Newline state, with the same convention as 'cat': -1 in the middle
+     of a line, and otherwise one less than the number of consecutive
+     newlines just seen, clamped to 2.  */
+  int newlines = newlines2;
+
+  while (true)
+    {
+      size_t n_read = safe_read (input_desc, inbuf, insize);
+      if (n_read == SAFE_READ_ERROR)
+        {
+          error (0, errno, "%s", quotef (infile));
+          newlines2 = newlines;
+          return false;
+        }
+      if (n_read == 0)
+        {
+          newlines2 = newlines;
+          return true;
+        }
+
+      char *bpin = inbuf;
+      char *eob = inbuf + n_read;
+
+      while (bpin < eob)
+        {
+          if (*bpin == '\n')
+            {
+              /* A newline run, possibly continuing one from earlier
+                 input.  Keep at most enough of it to reach two
+                 consecutive newlines in the output; drop the rest.  */
+              char *p = bpin;
+              while (p < eob && *p == '\n')
+                p++;
+              size_t run = p - bpin;
+              size_t keep = newlines < 1 ? MIN (run, (size_t) (1 - newlines))
+                                         : 0;
+              if (keep != 0
+                  && full_write (STDOUT_FILENO, bpin, keep) != keep)
+                die (EXIT_FAILURE, errno, _("write error"));
+              newlines = MIN (newlines + (int) MIN (run, 3), 2);
+              bpin = p;
+            }
+          else
+            {
+              /* Copy the longest span needing no intervention: text
+                 together with up to two trailing newlines.  Only a
+                 third consecutive newline starts a squeeze.  */
+              char *q = bpin;
+              char *span_end = eob;
+              while ((q = memchr (q, '\n', eob - q)))
+                {
+                  if (3 <= eob - q && q[1] == '\n' && q[2] == '\n')
+                    {
+                      span_end = q + 2;
+                      break;
+                    }
+                  q++;
+                }
+
+              size_t len = span_end - bpin;
+              if (full_write (STDOUT_FILENO, bpin, len) != len)
+                die (EXIT_FAILURE, errno, _("write error"));
+
+              if (span_end < eob)
+                /* The span ended with two newlines.  */
+                newlines = 1;
+              else if (eob[-1] != '\n')
+                newlines = -1;
+              else
+                newlines = 2 <= eob - bpin && eob[-2] == '\n';
+              bpin = span_end;
+            }
+        }
+    }
+}
+
 int
 main (int argc, char **argv)
 {
@@ -757,6 +899,11 @@ main (int argc, char **argv)
     die (EXIT_FAILURE, errno, _("standard output"));
 
   outsize = io_blksize (stat_buf);
+
+  /* cat writes straight to the output descriptor, so a stdbuf-style
+     fully buffered size translates into the write block size.  */
+  outsize = stdbuf_policy_output_size (outsize);
+
   out_dev = stat_buf.st_dev;
   out_ino = stat_buf.st_ino;
   out_isreg = S_ISREG (stat_buf.st_mode) != 0;
@@ -831,6 +978,29 @@ main (int argc, char **argv)
 
           ok &= simple_cat (ptr_align (inbuf, page_size), insize);
         }
+      else if (number
+               && ! (show_ends || show_nonprinting
+                     || show_tabs || squeeze_blank))
+        {
+          insize = MAX (insize, outsize);
+          inbuf = xmalloc (insize + page_size - 1);
+          outbuf = xmalloc (outsize - 1 + insize + LINE_COUNTER_BUF_LEN
+                            + page_size - 1);
+
+          ok &= number_cat (ptr_align (inbuf, page_size), insize,
+                            ptr_align (outbuf, page_size), outsize,
+                            number_nonblank);
+
+          free (outbuf);
+        }
+      else if (squeeze_blank
+               && ! (number || show_ends || show_nonprinting || show_tabs))
+        {
+          insize = MAX (insize, outsize);
+          inbuf = xmalloc (insize + page_size - 1);
+
+          ok &= squeeze_cat (ptr_align (inbuf, page_size), insize);
+        }
       else
         {
           inbuf = xmalloc (insize + 1 + page_size - 1);
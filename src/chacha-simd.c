@@ -0,0 +1,112 @@
+/* AVX2 kernel for ChaCha keystream generation
+   Copyright (C) 2021 Free Software Foundation, Inc.
+
+   This program is free software: you can redistribute it and/or modify
+   it under the terms of the GNU General Public License as published by
+   the Free Software Foundation, either version 3 of the License, or
+   (at your option) any later version.
+
+   This program is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU General Public License for more details.
+
+   You should have received a copy of the GNU General Public License
+   along with this program.  If not, see <https://www.gnu.org/licenses/>.  */
+
+/* Two ChaCha blocks are computed in parallel, one per 128-bit lane:
+   each of the four 256-bit row vectors holds the corresponding state
+   row of both blocks, and only the row with the block counter differs
+   between the lanes.  The diagonal rounds are reached by rotating the
+   words of rows 1-3 within each lane, the standard vector ChaCha
+   formulation.  */
+
+#include <config.h>
+
+#include <stddef.h>
+#include <stdint.h>
+#include <x86intrin.h>
+
+#include "chacha-simd.h"
+
+/* One ChaCha quarterround on whole rows.  The 16- and 8-bit rotates
+   are byte shuffles; the others need a pair of shifts.  */
+#define QROUND(a, b, c, d, rol16, rol8)                         \
+  do                                                            \
+    {                                                           \
+      a = _mm256_add_epi32 (a, b);                              \
+      d = _mm256_shuffle_epi8 (_mm256_xor_si256 (d, a), rol16); \
+      c = _mm256_add_epi32 (c, d);                              \
+      b = _mm256_xor_si256 (b, c);                              \
+      b = _mm256_or_si256 (_mm256_slli_epi32 (b, 12),           \
+                           _mm256_srli_epi32 (b, 20));          \
+      a = _mm256_add_epi32 (a, b);                              \
+      d = _mm256_shuffle_epi8 (_mm256_xor_si256 (d, a), rol8);  \
+      c = _mm256_add_epi32 (c, d);                              \
+      b = _mm256_xor_si256 (b, c);                              \
+      b = _mm256_or_si256 (_mm256_slli_epi32 (b, 7),            \
+                           _mm256_srli_epi32 (b, 25));          \
+    }                                                           \
+  while (0)
+
+void
+chacha_blocks_avx2 (uint32_t const *state, size_t nblocks,
+                    unsigned char *out)
+{
+  const __m256i rol16 = _mm256_set_epi8 (
+    13, 12, 15, 14, 9, 8, 11, 10, 5, 4, 7, 6, 1, 0, 3, 2,
+    13, 12, 15, 14, 9, 8, 11, 10, 5, 4, 7, 6, 1, 0, 3, 2);
+  const __m256i rol8 = _mm256_set_epi8 (
+    14, 13, 12, 15, 10, 9, 8, 11, 6, 5, 4, 7, 2, 1, 0, 3,
+    14, 13, 12, 15, 10, 9, 8, 11, 6, 5, 4, 7, 2, 1, 0, 3);
+
+  __m256i a0 = _mm256_broadcastsi128_si256 (
+    _mm_loadu_si128 ((__m128i const *) state));
+  __m256i b0 = _mm256_broadcastsi128_si256 (
+    _mm_loadu_si128 ((__m128i const *) (state + 4)));
+  __m256i c0 = _mm256_broadcastsi128_si256 (
+    _mm_loadu_si128 ((__m128i const *) (state + 8)));
+  uint64_t ctr = state[12] | ((uint64_t) state[13] << 32);
+
+  for (size_t i = 0; i < nblocks; i += 2, ctr += 2, out += 128)
+    {
+      uint64_t ctr1 = ctr + 1;
+      __m256i d0 = _mm256_set_epi32 (state[15], state[14],
+                                     ctr1 >> 32, ctr1,
+                                     state[15], state[14],
+                                     ctr >> 32, ctr);
+      __m256i a = a0, b = b0, c = c0, d = d0;
+
+      for (int r = 0; r < 20; r += 2)
+        {
+          QROUND (a, b, c, d, rol16, rol8);
+
+          /* Rotate rows 1-3 to put each diagonal in a column.  */
+          b = _mm256_shuffle_epi32 (b, 0x39);
+          c = _mm256_shuffle_epi32 (c, 0x4e);
+          d = _mm256_shuffle_epi32 (d, 0x93);
+
+          QROUND (a, b, c, d, rol16, rol8);
+
+          b = _mm256_shuffle_epi32 (b, 0x93);
+          c = _mm256_shuffle_epi32 (c, 0x4e);
+          d = _mm256_shuffle_epi32 (d, 0x39);
+        }
+
+      a = _mm256_add_epi32 (a, a0);
+      b = _mm256_add_epi32 (b, b0);
+      c = _mm256_add_epi32 (c, c0);
+      d = _mm256_add_epi32 (d, d0);
+
+      /* The low lanes serialize the first block, the high lanes
+         the second.  */
+      _mm256_storeu_si256 ((__m256i *) out,
+                           _mm256_permute2x128_si256 (a, b, 0x20));
+      _mm256_storeu_si256 ((__m256i *) (out + 32),
+                           _mm256_permute2x128_si256 (c, d, 0x20));
+      _mm256_storeu_si256 ((__m256i *) (out + 64),
+                           _mm256_permute2x128_si256 (a, b, 0x31));
+      _mm256_storeu_si256 ((__m256i *) (out + 96),
+                           _mm256_permute2x128_si256 (c, d, 0x31));
+    }
+}
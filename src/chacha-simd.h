@@ -0,0 +1,23 @@
+/* AVX2 kernel for ChaCha keystream generation
+   Copyright (C) 2021 Free Software Foundation, Inc.
+
+   This program is free software: you can redistribute it and/or modify
+   it under the terms of the GNU General Public License as published by
+   the Free Software Foundation, either version 3 of the License, or
+   (at your option) any later version.
+
+   This program is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU General Public License for more details.
+
+   You should have received a copy of the GNU General Public License
+   along with this program.  If not, see <https://www.gnu.org/licenses/>.  */
+
+/* Write NBLOCKS 64-byte ChaCha keystream blocks derived from the
+   16-word STATE to OUT, incrementing the 64-bit block counter held in
+   STATE words 12 and 13 once per block; NBLOCKS must be even.  STATE
+   itself is left unchanged; the caller advances its counter.  The
+   caller must only call this when the CPU supports AVX2.  */
+void chacha_blocks_avx2 (uint32_t const *state, size_t nblocks,
+                         unsigned char *out);
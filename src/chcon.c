@@ -25,9 +25,11 @@
 #include "die.h"
 #include "error.h"
 #include "ignore-value.h"
+#include "meta-pool.h"
 #include "quote.h"
 #include "root-dev-ino.h"
 #include "selinux-at.h"
+#include "xdectoint.h"
 #include "xfts.h"
 
 /* The official name of this program (e.g., no 'g' prefix).  */
@@ -60,6 +62,15 @@ static char const *specified_role;
 static char const *specified_range;
 static char const *specified_type;
 
+/* Maximum number of worker threads issuing the context changes.  */
+static size_t nthreads = 1;
+
+/* The pool applying queued context changes, when multithreaded.  This
+   is only usable when the full target context is known up front; with
+   component options like --type, the new context is derived from each
+   file's old one, and that derivation diagnoses its own failures.  */
+static struct meta_pool *pool;
+
 /* For long options that have no equivalent short option, use a
    non-character as a pseudo short option, starting with CHAR_MAX + 1.  */
 enum
@@ -67,7 +78,8 @@ enum
   DEREFERENCE_OPTION = CHAR_MAX + 1,
   NO_PRESERVE_ROOT,
   PRESERVE_ROOT,
-  REFERENCE_FILE_OPTION
+  REFERENCE_FILE_OPTION,
+  THREADS_OPTION
 };
 
 static struct option const long_options[] =
@@ -78,6 +90,7 @@ static struct option const long_options[] =
   {"no-preserve-root", no_argument, NULL, NO_PRESERVE_ROOT},
   {"preserve-root", no_argument, NULL, PRESERVE_ROOT},
   {"reference", required_argument, NULL, REFERENCE_FILE_OPTION},
+  {"threads", required_argument, NULL, THREADS_OPTION},
   {"user", required_argument, NULL, 'u'},
   {"role", required_argument, NULL, 'r'},
   {"type", required_argument, NULL, 't'},
@@ -202,6 +215,40 @@ change_file_context (int fd, char const *file)
   return errors;
 }
 
+/* A context change queued for the worker threads.  */
+struct context_request
+{
+  bool failed;
+};
+
+static void
+context_apply (struct meta_job *job, void *tool_data)
+{
+  struct context_request *req = job->data;
+  int fail = (affect_symlink_referent
+              ? setfileconat (job->dir_fd, job->file, specified_context)
+              : lsetfileconat (job->dir_fd, job->file, specified_context));
+
+  if (fail)
+    {
+      req->failed = true;
+      job->err = errno;
+    }
+}
+
+static bool
+context_report (struct meta_job *job, void *tool_data)
+{
+  struct context_request const *req = job->data;
+
+  if (! req->failed)
+    return true;
+
+  error (0, job->err, _("failed to change context of %s to %s"),
+         quoteaf_n (0, job->file), quote_n (1, specified_context));
+  return false;
+}
+
 /* Change the context of FILE.
    Return true if successful.  This function is called
    once for every file system object that fts encounters.  */
@@ -294,6 +341,18 @@ process_file (FTS *fts, FTSENT *ent)
         printf (_("changing security context of %s\n"),
                 quoteaf (file_full_name));
 
+      /* Queue non-directory entries for the worker threads;
+         directories are changed in line.  */
+      if (pool
+          && (ent->fts_info == FTS_F || ent->fts_info == FTS_SL
+              || ent->fts_info == FTS_DEFAULT || ent->fts_info == FTS_NSOK))
+        {
+          struct context_request req = { false };
+          meta_pool_submit (pool, fts->fts_cwd_fd, file, file_full_name,
+                            &req, sizeof req);
+          return true;
+        }
+
       if (change_file_context (fts->fts_cwd_fd, file) != 0)
         ok = false;
     }
@@ -313,6 +372,9 @@ process_files (char **files, int bit_flags)
 {
   bool ok = true;
 
+  if (1 < nthreads && specified_context)
+    pool = meta_pool_start (nthreads, context_apply, context_report, NULL);
+
   FTS *fts = xfts_open (files, bit_flags, NULL);
 
   while (1)
@@ -331,9 +393,24 @@ process_files (char **files, int bit_flags)
           break;
         }
 
+      /* Queued changes name files relative to the walk's current
+         directory, so complete them before the walk moves on to
+         another one.  */
+      if (pool
+          && (ent->fts_info == FTS_D || ent->fts_info == FTS_DP
+              || ent->fts_info == FTS_DC || ent->fts_info == FTS_DNR
+              || ent->fts_info == FTS_ERR))
+        ok &= meta_pool_drain (pool);
+
       ok &= process_file (fts, ent);
     }
 
+  if (pool)
+    {
+      ok &= meta_pool_finish (pool);
+      pool = NULL;
+    }
+
   if (fts_close (fts) != 0)
     {
       error (0, errno, _("fts_close failed"));
@@ -384,6 +461,10 @@ With --reference, change the security context of each FILE to that of RFILE.\n\
 "), stdout);
       fputs (_("\
   -R, --recursive        operate on files and directories recursively\n\
+"), stdout);
+      fputs (_("\
+      --threads=N        apply the context changes with up to N threads\n\
+                         (requires a complete CONTEXT or --reference)\n\
 "), stdout);
       fputs (_("\
   -v, --verbose          output a diagnostic for every file processed\n\
@@ -470,6 +551,11 @@ main (int argc, char **argv)
           reference_file = optarg;
           break;
 
+        case THREADS_OPTION:
+          nthreads = xdectoumax (optarg, 1, SIZE_MAX, "",
+                                 _("invalid number of threads"), 0);
+          break;
+
         case 'R':
           recurse = true;
           break;
@@ -29,6 +29,7 @@
 #include "fts_.h"
 #include "quote.h"
 #include "root-dev-ino.h"
+#include "xdectoint.h"
 #include "xstrtol.h"
 
 /* The official name of this program (e.g., no 'g' prefix).  */
@@ -53,7 +54,8 @@ enum
   DEREFERENCE_OPTION = CHAR_MAX + 1,
   NO_PRESERVE_ROOT,
   PRESERVE_ROOT,
-  REFERENCE_FILE_OPTION
+  REFERENCE_FILE_OPTION,
+  THREADS_OPTION
 };
 
 static struct option const long_options[] =
@@ -67,6 +69,7 @@ static struct option const long_options[] =
   {"quiet", no_argument, NULL, 'f'},
   {"silent", no_argument, NULL, 'f'},
   {"reference", required_argument, NULL, REFERENCE_FILE_OPTION},
+  {"threads", required_argument, NULL, THREADS_OPTION},
   {"verbose", no_argument, NULL, 'v'},
   {GETOPT_HELP_OPTION_DECL},
   {GETOPT_VERSION_OPTION_DECL},
@@ -141,6 +144,9 @@ With --reference, change the group of each FILE to that of RFILE.\n\
 "), stdout);
       fputs (_("\
   -R, --recursive        operate on files and directories recursively\n\
+"), stdout);
+      fputs (_("\
+      --threads=N        apply the group changes with up to N threads\n\
 "), stdout);
       fputs (_("\
 \n\
@@ -234,6 +240,11 @@ main (int argc, char **argv)
           reference_file = optarg;
           break;
 
+        case THREADS_OPTION:
+          chopt.nthreads = xdectoumax (optarg, 1, SIZE_MAX, "",
+                                       _("invalid number of threads"), 0);
+          break;
+
         case 'R':
           chopt.recurse = true;
           break;
@@ -27,9 +27,11 @@
 #include "error.h"
 #include "filemode.h"
 #include "ignore-value.h"
+#include "meta-pool.h"
 #include "modechange.h"
 #include "quote.h"
 #include "root-dev-ino.h"
+#include "xdectoint.h"
 #include "xfts.h"
 
 /* The official name of this program (e.g., no 'g' prefix).  */
@@ -68,6 +70,9 @@ static mode_t umask_value;
 /* If true, change the modes of directories recursively. */
 static bool recurse;
 
+/* If true, visit each directory's entries in inode order.  */
+static bool inode_sort;
+
 /* If true, force silence (suppress most of error messages). */
 static bool force_silent;
 
@@ -83,24 +88,34 @@ static enum Verbosity verbosity = V_off;
    Otherwise NULL.  */
 static struct dev_ino *root_dev_ino;
 
+/* Maximum number of worker threads issuing the mode changes.  */
+static size_t nthreads = 1;
+
+/* The pool applying queued mode changes, when multithreaded.  */
+static struct meta_pool *pool;
+
 /* For long options that have no equivalent short option, use a
    non-character as a pseudo short option, starting with CHAR_MAX + 1.  */
 enum
 {
-  NO_PRESERVE_ROOT = CHAR_MAX + 1,
+  INODE_SORT_OPTION = CHAR_MAX + 1,
+  NO_PRESERVE_ROOT,
   PRESERVE_ROOT,
-  REFERENCE_FILE_OPTION
+  REFERENCE_FILE_OPTION,
+  THREADS_OPTION
 };
 
 static struct option const long_options[] =
 {
   {"changes", no_argument, NULL, 'c'},
+  {"inode-sort", no_argument, NULL, INODE_SORT_OPTION},
   {"recursive", no_argument, NULL, 'R'},
   {"no-preserve-root", no_argument, NULL, NO_PRESERVE_ROOT},
   {"preserve-root", no_argument, NULL, PRESERVE_ROOT},
   {"quiet", no_argument, NULL, 'f'},
   {"reference", required_argument, NULL, REFERENCE_FILE_OPTION},
   {"silent", no_argument, NULL, 'f'},
+  {"threads", required_argument, NULL, THREADS_OPTION},
   {"verbose", no_argument, NULL, 'v'},
   {GETOPT_HELP_OPTION_DECL},
   {GETOPT_VERSION_OPTION_DECL},
@@ -180,6 +195,94 @@ describe_change (char const *file, mode_t old_mode, mode_t mode,
           (unsigned long int) (mode & CHMOD_MODE_BITS), &perms[1]);
 }
 
+/* Diagnose the outcome of changing the mode of FILE, relative to
+   DIR_FD, from OLD_MODE to NEW_MODE; FILE_FULL_NAME is the name to use
+   in diagnostics.  OK is false if an earlier step already failed;
+   CHMOD_SUCCEEDED tells whether the chmod call succeeded, and
+   CHMOD_ERRNO is the errno value from a failed call.
+   Return true if FILE was processed successfully.  */
+
+static bool
+finish_change (int dir_fd, char const *file, char const *file_full_name,
+               mode_t old_mode, mode_t new_mode, bool ok,
+               bool chmod_succeeded, int chmod_errno)
+{
+  if (ok && ! chmod_succeeded && ! S_ISLNK (old_mode))
+    {
+      if (! force_silent)
+        error (0, chmod_errno, _("changing permissions of %s"),
+               quoteaf (file_full_name));
+      ok = false;
+    }
+
+  if (verbosity != V_off)
+    {
+      bool changed = (chmod_succeeded
+                      && mode_changed (dir_fd, file, file_full_name,
+                                       old_mode, new_mode));
+
+      if (changed || verbosity == V_high)
+        {
+          enum Change_status ch_status =
+            (!ok ? CH_FAILED
+             : !chmod_succeeded ? CH_NOT_APPLIED
+             : !changed ? CH_NO_CHANGE_REQUESTED
+             : CH_SUCCEEDED);
+          describe_change (file_full_name, old_mode, new_mode, ch_status);
+        }
+    }
+
+  if (chmod_succeeded && diagnose_surprises)
+    {
+      mode_t naively_expected_mode =
+        mode_adjust (old_mode, S_ISDIR (old_mode) != 0, 0, change, NULL);
+      if (new_mode & ~naively_expected_mode)
+        {
+          char new_perms[12];
+          char naively_expected_perms[12];
+          strmode (new_mode, new_perms);
+          strmode (naively_expected_mode, naively_expected_perms);
+          new_perms[10] = naively_expected_perms[10] = '\0';
+          error (0, 0,
+                 _("%s: new permissions are %s, not %s"),
+                 quotef (file_full_name),
+                 new_perms + 1, naively_expected_perms + 1);
+          ok = false;
+        }
+    }
+
+  return ok;
+}
+
+/* A mode change queued for the worker threads.  */
+struct change_request
+{
+  mode_t old_mode;
+  mode_t new_mode;
+  bool chmod_succeeded;
+};
+
+static void
+change_apply (struct meta_job *job, void *tool_data)
+{
+  struct change_request *req = job->data;
+
+  if (chmodat (job->dir_fd, job->file, req->new_mode) == 0)
+    req->chmod_succeeded = true;
+  else
+    job->err = errno;
+}
+
+static bool
+change_report (struct meta_job *job, void *tool_data)
+{
+  struct change_request const *req = job->data;
+
+  return finish_change (job->dir_fd, job->file, job->file_full_name,
+                        req->old_mode, req->new_mode, true,
+                        req->chmod_succeeded, job->err);
+}
+
 /* Change the mode of FILE.
    Return true if successful.  This function is called
    once for every file system object that fts encounters.  */
@@ -262,61 +365,35 @@ process_file (FTS *fts, FTSENT *ent)
       return false;
     }
 
+  int chmod_errno = 0;
   if (ok)
     {
       old_mode = file_stats->st_mode;
       new_mode = mode_adjust (old_mode, S_ISDIR (old_mode) != 0, umask_value,
                               change, NULL);
 
+      /* Queue ordinary files for the worker threads; directories are
+         changed in line, preorder, before the walk descends.  */
+      if (pool && ! S_ISLNK (old_mode)
+          && (ent->fts_info == FTS_F || ent->fts_info == FTS_DEFAULT))
+        {
+          struct change_request req = { old_mode, new_mode, false };
+          meta_pool_submit (pool, fts->fts_cwd_fd, file, file_full_name,
+                            &req, sizeof req);
+          return true;
+        }
+
       if (! S_ISLNK (old_mode))
         {
           if (chmodat (fts->fts_cwd_fd, file, new_mode) == 0)
             chmod_succeeded = true;
           else
-            {
-              if (! force_silent)
-                error (0, errno, _("changing permissions of %s"),
-                       quoteaf (file_full_name));
-              ok = false;
-            }
-        }
-    }
-
-  if (verbosity != V_off)
-    {
-      bool changed = (chmod_succeeded
-                      && mode_changed (fts->fts_cwd_fd, file, file_full_name,
-                                       old_mode, new_mode));
-
-      if (changed || verbosity == V_high)
-        {
-          enum Change_status ch_status =
-            (!ok ? CH_FAILED
-             : !chmod_succeeded ? CH_NOT_APPLIED
-             : !changed ? CH_NO_CHANGE_REQUESTED
-             : CH_SUCCEEDED);
-          describe_change (file_full_name, old_mode, new_mode, ch_status);
+            chmod_errno = errno;
         }
     }
 
-  if (chmod_succeeded && diagnose_surprises)
-    {
-      mode_t naively_expected_mode =
-        mode_adjust (old_mode, S_ISDIR (old_mode) != 0, 0, change, NULL);
-      if (new_mode & ~naively_expected_mode)
-        {
-          char new_perms[12];
-          char naively_expected_perms[12];
-          strmode (new_mode, new_perms);
-          strmode (naively_expected_mode, naively_expected_perms);
-          new_perms[10] = naively_expected_perms[10] = '\0';
-          error (0, 0,
-                 _("%s: new permissions are %s, not %s"),
-                 quotef (file_full_name),
-                 new_perms + 1, naively_expected_perms + 1);
-          ok = false;
-        }
-    }
+  ok = finish_change (fts->fts_cwd_fd, file, file_full_name,
+                      old_mode, new_mode, ok, chmod_succeeded, chmod_errno);
 
   if ( ! recurse)
     fts_set (fts, ent, FTS_SKIP);
@@ -333,7 +410,11 @@ process_files (char **files, int bit_flags)
 {
   bool ok = true;
 
-  FTS *fts = xfts_open (files, bit_flags, NULL);
+  if (1 < nthreads)
+    pool = meta_pool_start (nthreads, change_apply, change_report, NULL);
+
+  FTS *fts = xfts_open (files, bit_flags,
+                        inode_sort ? xfts_compare_ino : NULL);
 
   while (1)
     {
@@ -352,9 +433,24 @@ process_files (char **files, int bit_flags)
           break;
         }
 
+      /* Queued changes name files relative to the walk's current
+         directory, so complete them before the walk moves on to
+         another one.  */
+      if (pool
+          && (ent->fts_info == FTS_D || ent->fts_info == FTS_DP
+              || ent->fts_info == FTS_DC || ent->fts_info == FTS_DNR
+              || ent->fts_info == FTS_ERR))
+        ok &= meta_pool_drain (pool);
+
       ok &= process_file (fts, ent);
     }
 
+  if (pool)
+    {
+      ok &= meta_pool_finish (pool);
+      pool = NULL;
+    }
+
   if (fts_close (fts) != 0)
     {
       error (0, errno, _("fts_close failed"));
@@ -386,6 +482,9 @@ With --reference, change the mode of each FILE to that of RFILE.\n\
   -c, --changes          like verbose but report only when a change is made\n\
   -f, --silent, --quiet  suppress most error messages\n\
   -v, --verbose          output a diagnostic for every file processed\n\
+"), stdout);
+      fputs (_("\
+      --inode-sort       process each directory's entries in inode order\n\
 "), stdout);
       fputs (_("\
       --no-preserve-root  do not treat '/' specially (the default)\n\
@@ -396,6 +495,9 @@ With --reference, change the mode of each FILE to that of RFILE.\n\
 "), stdout);
       fputs (_("\
   -R, --recursive        change files and directories recursively\n\
+"), stdout);
+      fputs (_("\
+      --threads=N        apply the mode changes with up to N threads\n\
 "), stdout);
       fputs (HELP_OPTION_DESCRIPTION, stdout);
       fputs (VERSION_OPTION_DESCRIPTION, stdout);
@@ -481,6 +583,9 @@ main (int argc, char **argv)
             diagnose_surprises = true;
           }
           break;
+        case INODE_SORT_OPTION:
+          inode_sort = true;
+          break;
         case NO_PRESERVE_ROOT:
           preserve_root = false;
           break;
@@ -490,6 +595,10 @@ main (int argc, char **argv)
         case REFERENCE_FILE_OPTION:
           reference_file = optarg;
           break;
+        case THREADS_OPTION:
+          nthreads = xdectoumax (optarg, 1, SIZE_MAX, "",
+                                 _("invalid number of threads"), 0);
+          break;
         case 'R':
           recurse = true;
           break;
@@ -26,6 +26,7 @@
 #include "chown-core.h"
 #include "error.h"
 #include "ignore-value.h"
+#include "meta-pool.h"
 #include "root-dev-ino.h"
 #include "xfts.h"
 
@@ -64,6 +65,7 @@ chopt_init (struct Chown_option *chopt)
   chopt->force_silent = false;
   chopt->user_name = NULL;
   chopt->group_name = NULL;
+  chopt->nthreads = 1;
 }
 
 extern void
@@ -261,6 +263,140 @@ restricted_chown (int cwd_fd, char const *file,
   return status;
 }
 
+/* Diagnose the outcome of one ownership change of FILE_FULL_NAME to
+   UID/GID, where FILE_STATS describes the file beforehand (or is NULL
+   when it could not be examined).  OK is false if any step failed;
+   DO_CHOWN tells whether a change was attempted, SYMLINK_CHANGED
+   whether a symlink change was supported, and CHOWN_ERRNO is the errno
+   value from a failed change.  Return true if successful.  */
+static bool
+finish_chown (char const *file_full_name, struct stat const *file_stats,
+              uid_t uid, gid_t gid, bool ok, bool do_chown,
+              bool symlink_changed, int chown_errno,
+              struct Chown_option const *chopt)
+{
+  if (do_chown && !ok && ! chopt->force_silent)
+    error (0, chown_errno, (uid != (uid_t) -1
+                            ? _("changing ownership of %s")
+                            : _("changing group of %s")),
+           quoteaf (file_full_name));
+
+  if (chopt->verbosity != V_off)
+    {
+      bool changed =
+        ((do_chown && ok && symlink_changed)
+         && ! ((uid == (uid_t) -1 || uid == file_stats->st_uid)
+               && (gid == (gid_t) -1 || gid == file_stats->st_gid)));
+
+      if (changed || chopt->verbosity == V_high)
+        {
+          enum Change_status ch_status =
+            (!ok ? CH_FAILED
+             : !symlink_changed ? CH_NOT_APPLIED
+             : !changed ? CH_NO_CHANGE_REQUESTED
+             : CH_SUCCEEDED);
+          char *old_usr = file_stats ? uid_to_name (file_stats->st_uid) : NULL;
+          char *old_grp = file_stats ? gid_to_name (file_stats->st_gid) : NULL;
+          describe_change (file_full_name, ch_status,
+                           old_usr, old_grp,
+                           chopt->user_name, chopt->group_name);
+          free (old_usr);
+          free (old_grp);
+        }
+    }
+
+  return ok;
+}
+
+/* The fixed arguments of one chown_files run, shared with the worker
+   threads.  */
+struct chown_ctx
+{
+  uid_t uid;
+  gid_t gid;
+  uid_t required_uid;
+  gid_t required_gid;
+  struct Chown_option const *chopt;
+};
+
+/* An ownership change queued for the worker threads.  */
+struct chown_request
+{
+  struct stat st;		/* The file, as examined by the walk.  */
+  bool ok;
+  bool do_chown;
+  bool symlink_changed;
+};
+
+/* The pool applying queued ownership changes, when multithreaded.  */
+static struct meta_pool *pool;
+
+static void
+chown_apply (struct meta_job *job, void *tool_data)
+{
+  struct chown_ctx const *ctx = tool_data;
+  struct chown_request *req = job->data;
+  bool ok = true;
+
+  if ( ! ctx->chopt->affect_symlink_referent)
+    {
+      ok = (lchownat (job->dir_fd, job->file, ctx->uid, ctx->gid) == 0);
+
+      /* Ignore any error due to lack of support; POSIX requires
+         this behavior for top-level symbolic links with -h, and
+         implies that it's required for all symbolic links.  */
+      if (!ok && errno == EOPNOTSUPP)
+        {
+          ok = true;
+          req->symlink_changed = false;
+        }
+    }
+  else
+    {
+      enum RCH_status err
+        = restricted_chown (job->dir_fd, job->file, &req->st,
+                            ctx->uid, ctx->gid,
+                            ctx->required_uid, ctx->required_gid);
+      switch (err)
+        {
+        case RC_ok:
+          break;
+
+        case RC_do_ordinary_chown:
+          ok = (chownat (job->dir_fd, job->file, ctx->uid, ctx->gid) == 0);
+          break;
+
+        case RC_error:
+          ok = false;
+          break;
+
+        case RC_inode_changed:
+          /* FIXME: give a diagnostic in this case?  */
+        case RC_excluded:
+          req->do_chown = false;
+          ok = false;
+          break;
+
+        default:
+          abort ();
+        }
+    }
+
+  job->err = errno;
+  req->ok = ok;
+}
+
+static bool
+chown_report (struct meta_job *job, void *tool_data)
+{
+  struct chown_ctx const *ctx = tool_data;
+  struct chown_request const *req = job->data;
+
+  return finish_chown (job->file_full_name, &req->st,
+                       ctx->uid, ctx->gid, req->ok, req->do_chown,
+                       req->symlink_changed, job->err, ctx->chopt);
+}
+
 /* Change the owner and/or group of the file specified by FTS and ENT
    to UID and/or GID as appropriate.
    If REQUIRED_UID is not -1, then skip files with any other user ID.
@@ -399,6 +535,23 @@ change_file_owner (FTS *fts, FTSENT *ent,
       return false;
     }
 
+  /* Queue ordinary files and symlinks for the worker threads;
+     directories are changed in line, so that the walk never outruns
+     the changes it depends on.  */
+  if (pool && ok && do_chown
+      && (ent->fts_info == FTS_F || ent->fts_info == FTS_SL
+          || ent->fts_info == FTS_DEFAULT || ent->fts_info == FTS_NSOK))
+    {
+      struct chown_request req;
+      req.st = *file_stats;
+      req.ok = true;
+      req.do_chown = true;
+      req.symlink_changed = true;
+      meta_pool_submit (pool, fts->fts_cwd_fd, file, file_full_name,
+                        &req, sizeof req);
+      return true;
+    }
+
   if (do_chown)
     {
       if ( ! chopt->affect_symlink_referent)
@@ -460,37 +613,10 @@ change_file_owner (FTS *fts, FTSENT *ent,
          which a malicious user, M, could subvert a chown command run
          by some other user and operating on files in a directory
          where M has write access.  */
-
-      if (do_chown && !ok && ! chopt->force_silent)
-        error (0, errno, (uid != (uid_t) -1
-                          ? _("changing ownership of %s")
-                          : _("changing group of %s")),
-               quoteaf (file_full_name));
     }
 
-  if (chopt->verbosity != V_off)
-    {
-      bool changed =
-        ((do_chown && ok && symlink_changed)
-         && ! ((uid == (uid_t) -1 || uid == file_stats->st_uid)
-               && (gid == (gid_t) -1 || gid == file_stats->st_gid)));
-
-      if (changed || chopt->verbosity == V_high)
-        {
-          enum Change_status ch_status =
-            (!ok ? CH_FAILED
-             : !symlink_changed ? CH_NOT_APPLIED
-             : !changed ? CH_NO_CHANGE_REQUESTED
-             : CH_SUCCEEDED);
-          char *old_usr = file_stats ? uid_to_name (file_stats->st_uid) : NULL;
-          char *old_grp = file_stats ? gid_to_name (file_stats->st_gid) : NULL;
-          describe_change (file_full_name, ch_status,
-                           old_usr, old_grp,
-                           chopt->user_name, chopt->group_name);
-          free (old_usr);
-          free (old_grp);
-        }
-    }
+  ok = finish_chown (file_full_name, file_stats, uid, gid, ok, do_chown,
+                     symlink_changed, errno, chopt);
 
   if ( ! chopt->recurse)
     fts_set (fts, ent, FTS_SKIP);
@@ -522,6 +648,10 @@ chown_files (char **files, int bit_flags,
                     ? 0
                     : FTS_NOSTAT);
 
+  struct chown_ctx ctx = { uid, gid, required_uid, required_gid, chopt };
+  if (1 < chopt->nthreads)
+    pool = meta_pool_start (chopt->nthreads, chown_apply, chown_report, &ctx);
+
   FTS *fts = xfts_open (files, bit_flags | stat_flags, NULL);
 
   while (1)
@@ -541,10 +671,25 @@ chown_files (char **files, int bit_flags,
           break;
         }
 
+      /* Queued changes name files relative to the walk's current
+         directory, so complete them before the walk moves on to
+         another one.  */
+      if (pool
+          && (ent->fts_info == FTS_D || ent->fts_info == FTS_DP
+              || ent->fts_info == FTS_DC || ent->fts_info == FTS_DNR
+              || ent->fts_info == FTS_ERR))
+        ok &= meta_pool_drain (pool);
+
       ok &= change_file_owner (fts, ent, uid, gid,
                                required_uid, required_gid, chopt);
     }
 
+  if (pool)
+    {
+      ok &= meta_pool_finish (pool);
+      pool = NULL;
+    }
+
   if (fts_close (fts) != 0)
     {
       error (0, errno, _("fts_close failed"));
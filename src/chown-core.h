@@ -63,6 +63,9 @@ struct Chown_option
 
   /* The name of the group to which ownership of the files is being given. */
   char *group_name;
+
+  /* Maximum number of worker threads issuing the ownership changes.  */
+  size_t nthreads;
 };
 
 void
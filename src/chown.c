@@ -28,6 +28,7 @@
 #include "fts_.h"
 #include "quote.h"
 #include "root-dev-ino.h"
+#include "xdectoint.h"
 #include "userspec.h"
 
 /* The official name of this program (e.g., no 'g' prefix).  */
@@ -49,7 +50,8 @@ enum
   FROM_OPTION,
   NO_PRESERVE_ROOT,
   PRESERVE_ROOT,
-  REFERENCE_FILE_OPTION
+  REFERENCE_FILE_OPTION,
+  THREADS_OPTION
 };
 
 static struct option const long_options[] =
@@ -64,6 +66,7 @@ static struct option const long_options[] =
   {"quiet", no_argument, NULL, 'f'},
   {"silent", no_argument, NULL, 'f'},
   {"reference", required_argument, NULL, REFERENCE_FILE_OPTION},
+  {"threads", required_argument, NULL, THREADS_OPTION},
   {"verbose", no_argument, NULL, 'v'},
   {GETOPT_HELP_OPTION_DECL},
   {GETOPT_VERSION_OPTION_DECL},
@@ -118,6 +121,9 @@ With --reference, change the owner and group of each FILE to those of RFILE.\n\
 "), stdout);
       fputs (_("\
   -R, --recursive        operate on files and directories recursively\n\
+"), stdout);
+      fputs (_("\
+      --threads=N        apply the ownership changes with up to N threads\n\
 "), stdout);
       fputs (_("\
 \n\
@@ -225,6 +231,11 @@ main (int argc, char **argv)
           reference_file = optarg;
           break;
 
+        case THREADS_OPTION:
+          chopt.nthreads = xdectoumax (optarg, 1, SIZE_MAX, "",
+                                       _("invalid number of threads"), 0);
+          break;
+
         case FROM_OPTION:
           {
             char const *e = parse_user_spec (optarg,
@@ -142,13 +142,19 @@ main (void)
 
 #else /* !CRCTAB */
 
+# include <signal.h>
+# include <sys/socket.h>
+# include <sys/un.h>
+
 # include "die.h"
 # include "error.h"
+# include "full-write.h"
+# include "quote.h"
 
 # include "cksum.h"
-# if USE_PCLMUL_CRC32
+# if USE_PCLMUL_CRC32 || USE_VPCLMUL_CRC32
 #  include "cpuid.h"
-# endif /* USE_PCLMUL_CRC32 */
+# endif /* USE_PCLMUL_CRC32 || USE_VPCLMUL_CRC32 */
 
 /* Number of bytes to read at once.  */
 # define BUFLEN (1 << 16)
@@ -158,11 +164,13 @@ static bool debug;
 enum
 {
   DEBUG_PROGRAM_OPTION = CHAR_MAX + 1,
+  SERVER_OPTION,
 };
 
 static struct option const longopts[] =
 {
   {"debug", no_argument, NULL, DEBUG_PROGRAM_OPTION},
+  {"server", required_argument, NULL, SERVER_OPTION},
   {GETOPT_HELP_OPTION_DECL},
   {GETOPT_VERSION_OPTION_DECL},
   {NULL, 0, NULL, 0},
@@ -208,6 +216,36 @@ pclmul_supported (void)
 }
 # endif /* USE_PCLMUL_CRC32 */
 
+# if USE_VPCLMUL_CRC32
+static bool
+vpclmul_supported (void)
+{
+  unsigned int eax = 0;
+  unsigned int ebx = 0;
+  unsigned int ecx = 0;
+  unsigned int edx = 0;
+
+  if (! __get_cpuid_count (7, 0, &eax, &ebx, &ecx, &edx))
+    {
+      if (debug)
+        error (0, 0, "%s", _("failed to get cpuid"));
+      return false;
+    }
+
+  if (! (ebx & bit_AVX2) || ! (ecx & bit_VPCLMULQDQ))
+    {
+      if (debug)
+        error (0, 0, "%s", _("vpclmulqdq support not detected"));
+      return false;
+    }
+
+  if (debug)
+    error (0, 0, "%s", _("using vpclmulqdq hardware support"));
+
+  return true;
+}
+# endif /* USE_VPCLMUL_CRC32 */
+
 static bool
 cksum_slice8 (FILE *fp, char const *file, uint_fast32_t *crc_out,
               uintmax_t *length_out)
@@ -263,6 +301,145 @@ cksum_slice8 (FILE *fp, char const *file, uint_fast32_t *crc_out,
   return true;
 }
 
+/* Fold LENGTH into CRC as POSIX requires and return the final,
+   complemented checksum value.  */
+
+static uint_fast32_t
+cksum_finalize (uint_fast32_t crc, uintmax_t length)
+{
+  for (; length; length >>= 8)
+    crc = (crc << 8) ^ crctab[0][((crc >> 24) ^ length) & 0xFF];
+
+  return ~crc & 0xFFFFFFFF;
+}
+
+/* Serve checksum requests on a Unix-domain socket bound at SOCKET_NAME.
+   A request is a single byte carrying an open file descriptor as
+   SCM_RIGHTS ancillary data; the reply is a text line "CRC LENGTH\n"
+   ("error\n" if the descriptor could not be checksummed), computed with
+   the same kernels as the command-line mode.  A long-lived client thus
+   pays process startup and CPU-feature detection only once, however
+   many files it verifies.  Connections are served one at a time; the
+   server runs until killed.  This function does not return.  */
+
+static void
+cksum_server (char const *socket_name)
+{
+  struct sockaddr_un addr;
+
+  if (sizeof addr.sun_path <= strlen (socket_name))
+    die (EXIT_FAILURE, 0, _("socket name %s is too long"),
+         quote (socket_name));
+
+  int sock = socket (AF_UNIX, SOCK_STREAM, 0);
+  if (sock < 0)
+    die (EXIT_FAILURE, errno, _("cannot create socket"));
+
+  memset (&addr, 0, sizeof addr);
+  addr.sun_family = AF_UNIX;
+  strcpy (addr.sun_path, socket_name);
+
+  if (bind (sock, (struct sockaddr *) &addr, sizeof addr) != 0)
+    die (EXIT_FAILURE, errno, _("cannot bind to %s"), quote (socket_name));
+  if (listen (sock, SOMAXCONN) != 0)
+    die (EXIT_FAILURE, errno, _("cannot listen on %s"), quote (socket_name));
+
+  /* Survive clients that disconnect before reading their reply.  */
+  signal (SIGPIPE, SIG_IGN);
+
+  while (true)
+    {
+      int conn = accept (sock, NULL, NULL);
+      if (conn < 0)
+        {
+          if (errno == EINTR || errno == ECONNABORTED)
+            continue;
+          die (EXIT_FAILURE, errno, _("cannot accept connection on %s"),
+               quote (socket_name));
+        }
+
+      while (true)
+        {
+          char req;
+          char cbuf[CMSG_SPACE (sizeof (int))];
+          struct iovec iov;
+          struct msghdr msg;
+
+          iov.iov_base = &req;
+          iov.iov_len = 1;
+          memset (&msg, 0, sizeof msg);
+          msg.msg_iov = &iov;
+          msg.msg_iovlen = 1;
+          msg.msg_control = cbuf;
+          msg.msg_controllen = sizeof cbuf;
+
+          ssize_t n = recvmsg (conn, &msg, 0);
+          if (n < 0 && errno == EINTR)
+            continue;
+          if (n <= 0)
+            break;
+
+          int fd = -1;
+          for (struct cmsghdr *cm = CMSG_FIRSTHDR (&msg); cm;
+               cm = CMSG_NXTHDR (&msg, cm))
+            if (cm->cmsg_level == SOL_SOCKET && cm->cmsg_type == SCM_RIGHTS)
+              {
+                unsigned char const *data = CMSG_DATA (cm);
+                size_t n_fds = (cm->cmsg_len - CMSG_LEN (0)) / sizeof (int);
+                for (size_t i = 0; i < n_fds; i++)
+                  {
+                    int received;
+                    memcpy (&received, data + i * sizeof received,
+                            sizeof received);
+                    /* A request carries one descriptor; keep the
+                       first and close any surplus, lest misbehaving
+                       clients fill the server's descriptor table.  */
+                    if (fd < 0)
+                      fd = received;
+                    else
+                      close (received);
+                  }
+              }
+
+          char reply[2 * INT_BUFSIZE_BOUND (uintmax_t) + sizeof "error\n"];
+          size_t reply_len;
+
+          uint_fast32_t crc = 0;
+          uintmax_t length = 0;
+          bool ok = false;
+
+          if (0 <= fd)
+            {
+              FILE *fp = fdopen (fd, "r");
+              if (fp)
+                {
+                  fadvise (fp, FADVISE_SEQUENTIAL);
+                  ok = (cksum_fp (fp, _("file descriptor"), &crc, &length)
+                        && ! ferror (fp));
+                  fclose (fp);
+                }
+              else
+                close (fd);
+            }
+
+          if (ok)
+            reply_len = snprintf (reply, sizeof reply, "%u %ju\n",
+                                  (unsigned int) cksum_finalize (crc, length),
+                                  length);
+          else
+            {
+              strcpy (reply, "error\n");
+              reply_len = sizeof "error\n" - 1;
+            }
+
+          if (full_write (conn, reply, reply_len) != reply_len)
+            break;
+        }
+
+      close (conn);
+    }
+}
+
 /* Calculate and print the checksum and length in bytes
    of file FILE, or of the standard input if FILE is "-".
    If PRINT_NAME is true, print FILE next to the checksum and size.
@@ -314,10 +491,7 @@ cksum (char const *file, bool print_name)
 
   hp = umaxtostr (length, length_buf);
 
-  for (; length; length >>= 8)
-    crc = (crc << 8) ^ crctab[0][((crc >> 24) ^ length) & 0xFF];
-
-  crc = ~crc & 0xFFFFFFFF;
+  crc = cksum_finalize (crc, length);
 
   if (print_name)
     printf ("%u %s %s\n", (unsigned int) crc, hp, file);
@@ -345,6 +519,11 @@ Usage: %s [FILE]...\n\
       fputs (_("\
 Print CRC checksum and byte counts of each FILE.\n\
 \n\
+"), stdout);
+      fputs (_("\
+      --server=SOCKET  serve checksum requests on Unix socket SOCKET; each\n\
+                         request passes an open file descriptor and receives\n\
+                         its CRC and length on one line\n\
 "), stdout);
       fputs (HELP_OPTION_DESCRIPTION, stdout);
       fputs (VERSION_OPTION_DESCRIPTION, stdout);
@@ -358,6 +537,7 @@ main (int argc, char **argv)
 {
   int i, c;
   bool ok;
+  char const *server_socket = NULL;
 
   initialize_main (&argc, &argv);
   set_program_name (argv[0]);
@@ -379,6 +559,10 @@ main (int argc, char **argv)
           debug = true;
           break;
 
+        case SERVER_OPTION:
+          server_socket = optarg;
+          break;
+
         case_GETOPT_HELP_CHAR;
 
         case_GETOPT_VERSION_CHAR (PROGRAM_NAME, AUTHORS);
@@ -394,6 +578,20 @@ main (int argc, char **argv)
   if (pclmul_supported ())
      cksum_fp = cksum_pclmul;
 # endif /* USE_PCLMUL_CRC32 */
+# if USE_VPCLMUL_CRC32
+  if (vpclmul_supported ())
+     cksum_fp = cksum_vpclmul;
+# endif /* USE_VPCLMUL_CRC32 */
+
+  if (server_socket)
+    {
+      if (optind < argc)
+        {
+          error (0, 0, _("extra operand %s"), quote (argv[optind]));
+          usage (EXIT_FAILURE);
+        }
+      cksum_server (server_socket);
+    }
 
   if (optind == argc)
     ok = cksum ("-", false);
@@ -5,6 +5,10 @@ extern bool
 cksum_pclmul (FILE *fp, char const *file, uint_fast32_t *crc_out,
               uintmax_t *length_out);
 
+extern bool
+cksum_vpclmul (FILE *fp, char const *file, uint_fast32_t *crc_out,
+               uintmax_t *length_out);
+
 extern uint_fast32_t const crctab[8][256];
 
 uint_fast32_t const crctab[8][256] = {
@@ -0,0 +1,283 @@
+/* cksum -- calculate and print POSIX checksums and sizes of files
+   Copyright (C) 1992-2021 Free Software Foundation, Inc.
+
+   This program is free software: you can redistribute it and/or modify
+   it under the terms of the GNU General Public License as published by
+   the Free Software Foundation, either version 3 of the License, or
+   (at your option) any later version.
+
+   This program is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU General Public License for more details.
+
+   You should have received a copy of the GNU General Public License
+   along with this program.  If not, see <https://www.gnu.org/licenses/>.  */
+
+#include <config.h>
+
+#include <stdio.h>
+#include <sys/types.h>
+#include <stdint.h>
+#include <x86intrin.h>
+#include "system.h"
+#include "error.h"
+
+/* Number of bytes to read at once.  */
+#define BUFLEN (1 << 16)
+
+extern uint_fast32_t const crctab[8][256];
+
+extern bool
+cksum_vpclmul (FILE *fp, char const *file, uint_fast32_t *crc_out,
+               uintmax_t *length_out);
+
+/* Calculate CRC32 using the 256-bit VPCLMULQDQ CPU instructions,
+   folding 128 bytes per iteration of the main loop.  */
+
+bool
+cksum_vpclmul (FILE *fp, char const *file, uint_fast32_t *crc_out,
+               uintmax_t *length_out)
+{
+  __m128i buf[BUFLEN / sizeof (__m128i)];
+  uint_fast32_t crc = 0;
+  uintmax_t length = 0;
+  size_t bytes_read;
+  __m256i wide_mult_constant;
+  __m256i shuffle_wide_constant;
+  __m128i single_mult_constant;
+  __m128i four_mult_constant;
+  __m128i shuffle_constant;
+
+  if (!fp || !file || !crc_out || !length_out)
+    return false;
+
+  /* The folding constants are x^N mod G (the CRC polynomial), derived
+     as in the Intel whitepaper "Fast CRC Computation for Generic
+     Polynomials Using PCLMULQDQ Instruction"; the wide constants fold
+     each 128-bit lane across the 1024 bits consumed per iteration.  */
+  wide_mult_constant = _mm256_set_epi64x (0x10BD4D7C, 0x567FDDEB,
+                                          0x10BD4D7C, 0x567FDDEB);
+  single_mult_constant = _mm_set_epi64x (0xC5B9CD4C, 0xE8A45605);
+  four_mult_constant = _mm_set_epi64x (0x8833794C, 0xE6228B11);
+
+  /* Constant to byteswap a full SSE register, and both lanes of an
+     AVX register, as the CRC is processed in bit order.  */
+  shuffle_constant = _mm_set_epi8 (0, 1, 2, 3, 4, 5, 6, 7, 8,
+                                   9, 10, 11, 12, 13, 14, 15);
+  shuffle_wide_constant = _mm256_set_epi8 (0, 1, 2, 3, 4, 5, 6, 7, 8,
+                                           9, 10, 11, 12, 13, 14, 15,
+                                           0, 1, 2, 3, 4, 5, 6, 7, 8,
+                                           9, 10, 11, 12, 13, 14, 15);
+
+  while ((bytes_read = fread (buf, 1, BUFLEN, fp)) > 0)
+    {
+      __m128i *datap;
+      __m128i data;
+      __m128i data2;
+      __m128i fold_data;
+      __m128i xor_crc;
+      __m256i wdata;
+      __m256i wdata2;
+      __m256i wdata3;
+      __m256i wdata4;
+      __m256i wdata5;
+      __m256i wdata6;
+      __m256i wdata7;
+      __m256i wdata8;
+      __m256i wxor_crc;
+
+      if (length + bytes_read < length)
+        {
+          error (0, EOVERFLOW, _("%s: file too long"), quotef (file));
+          return false;
+        }
+      length += bytes_read;
+
+      datap = (__m128i *)buf;
+
+      /* Fold in parallel eight 32-byte blocks into four 32-byte blocks,
+         consuming 128 bytes per loop iteration.  */
+      if (bytes_read >= 32 * 8)
+        {
+          wdata = _mm256_loadu_si256 ((__m256i *) datap);
+          wdata = _mm256_shuffle_epi8 (wdata, shuffle_wide_constant);
+          /* XOR in initial CRC value (for us 0 so no effect), or CRC value
+             calculated for previous BUFLEN buffer from fread.  The first
+             16-byte block is the low lane of the first AVX register.  */
+          wxor_crc = _mm256_set_epi32 (0, 0, 0, 0, crc, 0, 0, 0);
+          crc = 0;
+          wdata = _mm256_xor_si256 (wdata, wxor_crc);
+          wdata3 = _mm256_loadu_si256 ((__m256i *) datap + 1);
+          wdata3 = _mm256_shuffle_epi8 (wdata3, shuffle_wide_constant);
+          wdata5 = _mm256_loadu_si256 ((__m256i *) datap + 2);
+          wdata5 = _mm256_shuffle_epi8 (wdata5, shuffle_wide_constant);
+          wdata7 = _mm256_loadu_si256 ((__m256i *) datap + 3);
+          wdata7 = _mm256_shuffle_epi8 (wdata7, shuffle_wide_constant);
+
+          while (bytes_read >= 32 * 8)
+            {
+              datap += 8;
+
+              /* Do multiplication here for eight consecutive 16 byte
+                 lanes, two per 256-bit register.  */
+              wdata2 = _mm256_clmulepi64_epi128 (wdata,
+                                                 wide_mult_constant, 0x00);
+              wdata = _mm256_clmulepi64_epi128 (wdata,
+                                                wide_mult_constant, 0x11);
+              wdata4 = _mm256_clmulepi64_epi128 (wdata3,
+                                                 wide_mult_constant, 0x00);
+              wdata3 = _mm256_clmulepi64_epi128 (wdata3,
+                                                 wide_mult_constant, 0x11);
+              wdata6 = _mm256_clmulepi64_epi128 (wdata5,
+                                                 wide_mult_constant, 0x00);
+              wdata5 = _mm256_clmulepi64_epi128 (wdata5,
+                                                 wide_mult_constant, 0x11);
+              wdata8 = _mm256_clmulepi64_epi128 (wdata7,
+                                                 wide_mult_constant, 0x00);
+              wdata7 = _mm256_clmulepi64_epi128 (wdata7,
+                                                 wide_mult_constant, 0x11);
+
+              /* Now multiplication results for the four registers are
+                 xor:ed with the next 128 bytes from the buffer, which
+                 effectively consumes the first 128 bytes.  Keep the xor
+                 results in variables for the next round of the loop.  */
+              wdata = _mm256_xor_si256 (wdata, wdata2);
+              wdata2 = _mm256_loadu_si256 ((__m256i *) datap);
+              wdata2 = _mm256_shuffle_epi8 (wdata2, shuffle_wide_constant);
+              wdata = _mm256_xor_si256 (wdata, wdata2);
+
+              wdata3 = _mm256_xor_si256 (wdata3, wdata4);
+              wdata4 = _mm256_loadu_si256 ((__m256i *) datap + 1);
+              wdata4 = _mm256_shuffle_epi8 (wdata4, shuffle_wide_constant);
+              wdata3 = _mm256_xor_si256 (wdata3, wdata4);
+
+              wdata5 = _mm256_xor_si256 (wdata5, wdata6);
+              wdata6 = _mm256_loadu_si256 ((__m256i *) datap + 2);
+              wdata6 = _mm256_shuffle_epi8 (wdata6, shuffle_wide_constant);
+              wdata5 = _mm256_xor_si256 (wdata5, wdata6);
+
+              wdata7 = _mm256_xor_si256 (wdata7, wdata8);
+              wdata8 = _mm256_loadu_si256 ((__m256i *) datap + 3);
+              wdata8 = _mm256_shuffle_epi8 (wdata8, shuffle_wide_constant);
+              wdata7 = _mm256_xor_si256 (wdata7, wdata8);
+
+              bytes_read -= 32 * 4;
+            }
+          /* At end of loop write the results from variables back into
+             the buffer, for use in the narrower fold loops below.  */
+          wdata = _mm256_shuffle_epi8 (wdata, shuffle_wide_constant);
+          _mm256_storeu_si256 ((__m256i *) datap, wdata);
+          wdata3 = _mm256_shuffle_epi8 (wdata3, shuffle_wide_constant);
+          _mm256_storeu_si256 ((__m256i *) datap + 1, wdata3);
+          wdata5 = _mm256_shuffle_epi8 (wdata5, shuffle_wide_constant);
+          _mm256_storeu_si256 ((__m256i *) datap + 2, wdata5);
+          wdata7 = _mm256_shuffle_epi8 (wdata7, shuffle_wide_constant);
+          _mm256_storeu_si256 ((__m256i *) datap + 3, wdata7);
+        }
+
+      /* Fold four 16-byte blocks into one 16-byte block, 64 bytes at
+         a time, as in the PCLMULQDQ-only implementation.  */
+      if (bytes_read >= 16 * 8)
+        {
+          __m128i data3;
+          __m128i data4;
+          __m128i data5;
+          __m128i data6;
+          __m128i data7;
+          __m128i data8;
+
+          data = _mm_loadu_si128 (datap);
+          data = _mm_shuffle_epi8 (data, shuffle_constant);
+          xor_crc = _mm_set_epi32 (crc, 0, 0, 0);
+          crc = 0;
+          data = _mm_xor_si128 (data, xor_crc);
+          data3 = _mm_loadu_si128 (datap + 1);
+          data3 = _mm_shuffle_epi8 (data3, shuffle_constant);
+          data5 = _mm_loadu_si128 (datap + 2);
+          data5 = _mm_shuffle_epi8 (data5, shuffle_constant);
+          data7 = _mm_loadu_si128 (datap + 3);
+          data7 = _mm_shuffle_epi8 (data7, shuffle_constant);
+
+          while (bytes_read >= 16 * 8)
+            {
+              datap += 4;
+
+              data2 = _mm_clmulepi64_si128 (data, four_mult_constant, 0x00);
+              data = _mm_clmulepi64_si128 (data, four_mult_constant, 0x11);
+              data4 = _mm_clmulepi64_si128 (data3, four_mult_constant, 0x00);
+              data3 = _mm_clmulepi64_si128 (data3, four_mult_constant, 0x11);
+              data6 = _mm_clmulepi64_si128 (data5, four_mult_constant, 0x00);
+              data5 = _mm_clmulepi64_si128 (data5, four_mult_constant, 0x11);
+              data8 = _mm_clmulepi64_si128 (data7, four_mult_constant, 0x00);
+              data7 = _mm_clmulepi64_si128 (data7, four_mult_constant, 0x11);
+
+              data = _mm_xor_si128 (data, data2);
+              data2 = _mm_loadu_si128 (datap);
+              data2 = _mm_shuffle_epi8 (data2, shuffle_constant);
+              data = _mm_xor_si128 (data, data2);
+
+              data3 = _mm_xor_si128 (data3, data4);
+              data4 = _mm_loadu_si128 (datap + 1);
+              data4 = _mm_shuffle_epi8 (data4, shuffle_constant);
+              data3 = _mm_xor_si128 (data3, data4);
+
+              data5 = _mm_xor_si128 (data5, data6);
+              data6 = _mm_loadu_si128 (datap + 2);
+              data6 = _mm_shuffle_epi8 (data6, shuffle_constant);
+              data5 = _mm_xor_si128 (data5, data6);
+
+              data7 = _mm_xor_si128 (data7, data8);
+              data8 = _mm_loadu_si128 (datap + 3);
+              data8 = _mm_shuffle_epi8 (data8, shuffle_constant);
+              data7 = _mm_xor_si128 (data7, data8);
+
+              bytes_read -= (16 * 4);
+            }
+          data = _mm_shuffle_epi8 (data, shuffle_constant);
+          _mm_storeu_si128 (datap, data);
+          data3 = _mm_shuffle_epi8 (data3, shuffle_constant);
+          _mm_storeu_si128 (datap + 1, data3);
+          data5 = _mm_shuffle_epi8 (data5, shuffle_constant);
+          _mm_storeu_si128 (datap + 2, data5);
+          data7 = _mm_shuffle_epi8 (data7, shuffle_constant);
+          _mm_storeu_si128 (datap + 3, data7);
+        }
+
+      /* Fold two 16-byte blocks into one 16-byte block */
+      if (bytes_read >= 32)
+        {
+          data = _mm_loadu_si128 (datap);
+          data = _mm_shuffle_epi8 (data, shuffle_constant);
+          xor_crc = _mm_set_epi32 (crc, 0, 0, 0);
+          crc = 0;
+          data = _mm_xor_si128 (data, xor_crc);
+          while (bytes_read >= 32)
+            {
+              datap++;
+
+              data2 = _mm_clmulepi64_si128 (data, single_mult_constant, 0x00);
+              data = _mm_clmulepi64_si128 (data, single_mult_constant, 0x11);
+              fold_data = _mm_loadu_si128 (datap);
+              fold_data = _mm_shuffle_epi8 (fold_data, shuffle_constant);
+              data = _mm_xor_si128 (data, data2);
+              data = _mm_xor_si128 (data, fold_data);
+              bytes_read -= 16;
+            }
+          data = _mm_shuffle_epi8 (data, shuffle_constant);
+          _mm_storeu_si128 (datap, data);
+        }
+
+      /* And finish up last 0-31 bytes in a byte by byte fashion */
+      unsigned char *cp = (unsigned char *)datap;
+      while (bytes_read--)
+        crc = (crc << 8) ^ crctab[0][((crc >> 24) ^ *cp++) & 0xFF];
+      if (feof (fp))
+        break;
+    }
+
+  *crc_out = crc;
+  *length_out = length;
+
+  return true;
+}
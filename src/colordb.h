@@ -0,0 +1,62 @@
+/* colordb.h -- compiled color database shared by dircolors and ls
+
+   Copyright (C) 2026 Free Software Foundation, Inc.
+
+   This program is free software: you can redistribute it and/or modify
+   it under the terms of the GNU General Public License as published by
+   the Free Software Foundation, either version 3 of the License, or
+   (at your option) any later version.
+
+   This program is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU General Public License for more details.
+
+   You should have received a copy of the GNU General Public License
+   along with this program.  If not, see <https://www.gnu.org/licenses/>.  */
+
+#ifndef COLORDB_H
+# define COLORDB_H
+
+# include <stdint.h>
+
+/* A compiled color database is a single binary blob laid out as a
+   header, then N_ENTRIES entry records, then a string pool.  The pool
+   bytes are stored fully unescaped, so a reader can point color
+   sequences directly into the loaded blob without per-entry parsing
+   or allocation.  All integers are in native byte order; BYTE_ORDER
+   lets a reader reject a blob written on another architecture.  */
+
+# define COLORDB_MAGIC "GNUlscolordb"
+# define COLORDB_BYTE_ORDER_MARK 0x01020304
+# define COLORDB_VERSION 1
+
+struct colordb_header
+{
+  char magic[sizeof COLORDB_MAGIC - 1];
+  uint32_t byte_order;		/* COLORDB_BYTE_ORDER_MARK */
+  uint32_t version;		/* COLORDB_VERSION */
+  uint32_t n_entries;
+  uint32_t pool_size;
+};
+
+/* One database entry, in source order.  An extension entry has
+   nonzero PATTERN_LEN and colors file names ending with the pattern
+   bytes; an indicator entry has PATTERN_LEN zero and sets the
+   two-letter indicator LABEL ("di", "ln", ...).  Offsets index the
+   string pool.  */
+
+struct colordb_entry
+{
+  uint32_t pattern_off;
+  uint32_t pattern_len;
+  uint32_t seq_off;
+  uint32_t seq_len;
+  char label[2];
+  char unused[2];		/* Zero padding.  */
+};
+
+bool color_unescape (char **dest, char const **src, bool equals_end,
+                     size_t *output_count);
+
+#endif
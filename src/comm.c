@@ -29,6 +29,7 @@
 #include "quote.h"
 #include "stdio--.h"
 #include "memcmp2.h"
+#include "sorted-cache.h"
 #include "xmemcoll.h"
 
 /* The official name of this program (e.g., no 'g' prefix).  */
@@ -60,6 +61,14 @@ static bool seen_unpairable;
 /* If nonzero, we have warned about disorder in that file. */
 static bool issued_disorder_warning[2];
 
+/* Name of the index of inputs already verified to be sorted,
+   or NULL if no index was requested.  */
+static char const *sorted_cache_file;
+
+/* If nonzero, the sorted order of that file is recorded in the index,
+   so per-line order checks can be skipped.  */
+static bool input_verified[2];
+
 /* line delimiter.  */
 static unsigned char delim = '\n';
 
@@ -86,6 +95,7 @@ enum
   CHECK_ORDER_OPTION = CHAR_MAX + 1,
   NOCHECK_ORDER_OPTION,
   OUTPUT_DELIMITER_OPTION,
+  SORTED_CACHE_OPTION,
   TOTAL_OPTION
 };
 
@@ -94,6 +104,7 @@ static struct option const long_options[] =
   {"check-order", no_argument, NULL, CHECK_ORDER_OPTION},
   {"nocheck-order", no_argument, NULL, NOCHECK_ORDER_OPTION},
   {"output-delimiter", required_argument, NULL, OUTPUT_DELIMITER_OPTION},
+  {"sorted-cache", required_argument, NULL, SORTED_CACHE_OPTION},
   {"total", no_argument, NULL, TOTAL_OPTION},
   {"zero-terminated", no_argument, NULL, 'z'},
   {GETOPT_HELP_OPTION_DECL},
@@ -140,6 +151,11 @@ and column three contains lines common to both files.\n\
 "), stdout);
       fputs (_("\
       --output-delimiter=STR  separate columns with STR\n\
+"), stdout);
+      fputs (_("\
+      --sorted-cache=FILE  with --check-order, record inputs verified to be\n\
+                            sorted in index FILE, and skip the order checks\n\
+                            for inputs already recorded there\n\
 "), stdout);
       fputs (_("\
       --total             output a summary\n\
@@ -165,6 +181,71 @@ Examples:\n\
   exit (status);
 }
 
+/* Size of the block buffer each input file is read through.  */
+enum { COMM_BUFFER_SIZE = 256 * 1024 };
+
+/* Block-buffered input state for one file.  */
+struct input_buffer
+{
+  char *buf;			/* Block of input bytes.  */
+  char *pos;			/* Next unconsumed byte.  */
+  char *lim;			/* End of the valid bytes.  */
+  bool eof;			/* No more bytes after LIM.  */
+};
+
+/* Read the next line from STREAM through IB into LINE, with the
+   semantics of readlinebuffer_delim: the line includes the DELIM
+   delimiter, and one is supplied at end of file if missing.  Reading
+   a block at a time and finding delimiters with memchr is much
+   faster than per-character input.  Return LINE, or NULL upon end of
+   file or read error.  */
+
+static struct linebuffer *
+read_line (struct linebuffer *line, FILE *stream, struct input_buffer *ib)
+{
+  size_t length = 0;
+
+  while (true)
+    {
+      if (ib->pos == ib->lim)
+        {
+          if (!ib->eof)
+            {
+              size_t n_read = fread (ib->buf, 1, COMM_BUFFER_SIZE, stream);
+              ib->pos = ib->buf;
+              ib->lim = ib->buf + n_read;
+              ib->eof = n_read < COMM_BUFFER_SIZE;
+            }
+          if (ib->pos == ib->lim)
+            {
+              if (length == 0 || ferror (stream))
+                return NULL;
+              if (line->buffer[length - 1] != delim)
+                {
+                  /* Supply the missing delimiter at end of file.  */
+                  if (length == line->size)
+                    line->buffer = x2realloc (line->buffer, &line->size);
+                  line->buffer[length++] = delim;
+                }
+              break;
+            }
+        }
+
+      char *p = memchr (ib->pos, delim, ib->lim - ib->pos);
+      size_t n = (p ? p + 1 : ib->lim) - ib->pos;
+      while (line->size - length < n)
+        line->buffer = x2realloc (line->buffer, &line->size);
+      memcpy (line->buffer + length, ib->pos, n);
+      length += n;
+      ib->pos += n;
+      if (p)
+        break;
+    }
+
+  line->length = length;
+  return line;
+}
+
 /* Output the line in linebuffer LINE to stream STREAM
    provided the switches say it should be output.
    CLASS is 1 for a line found only in file 1,
@@ -216,6 +297,8 @@ check_order (struct linebuffer const *prev,
              struct linebuffer const *current,
              int whatfile)
 {
+  if (input_verified[whatfile - 1])
+    return;
 
   if (check_input_order != CHECK_ORDER_DISABLED
       && ((check_input_order == CHECK_ORDER_ENABLED) || seen_unpairable))
@@ -271,11 +354,30 @@ compare_files (char **infiles)
   /* streams[i] holds the input stream for file i.  */
   FILE *streams[2];
 
+  /* ib[i] holds the block buffer file i is read through.  */
+  struct input_buffer ib[2];
+
   /* Counters for the summary.  */
   uintmax_t total[] = {0, 0, 0};
 
+  /* The identity of each input, and whether it can use the
+     verified-sorted index; only regular files can.  */
+  struct stat instat[2];
+  bool cacheable[2] = { false, false };
+
+  /* Digest of the settings that affect the line comparison.  */
+  uint32_t cache_opts = 0;
+
   int i, j;
 
+  if (sorted_cache_file)
+    {
+      cache_opts = delim;
+      if (hard_LC_COLLATE)
+        cache_opts = sorted_cache_digest (cache_opts,
+                                          setlocale (LC_COLLATE, NULL));
+    }
+
   /* Initialize the storage. */
   for (i = 0; i < 2; i++)
     {
@@ -293,8 +395,20 @@ compare_files (char **infiles)
 
       fadvise (streams[i], FADVISE_SEQUENTIAL);
 
-      thisline[i] = readlinebuffer_delim (all_line[i][alt[i][0]], streams[i],
-                                          delim);
+      if (sorted_cache_file
+          && fstat (fileno (streams[i]), &instat[i]) == 0
+          && S_ISREG (instat[i].st_mode))
+        {
+          cacheable[i] = true;
+          input_verified[i] = sorted_cache_lookup (sorted_cache_file,
+                                                   &instat[i], cache_opts);
+        }
+
+      ib[i].buf = xmalloc (COMM_BUFFER_SIZE);
+      ib[i].pos = ib[i].lim = ib[i].buf;
+      ib[i].eof = false;
+
+      thisline[i] = read_line (all_line[i][alt[i][0]], streams[i], &ib[i]);
       if (ferror (streams[i]))
         die (EXIT_FAILURE, errno, "%s", quotef (infiles[i]));
     }
@@ -365,8 +479,8 @@ compare_files (char **infiles)
             alt[i][1] = alt[i][0];
             alt[i][0] = (alt[i][0] + 1) & 0x03;
 
-            thisline[i] = readlinebuffer_delim (all_line[i][alt[i][0]],
-                                                streams[i], delim);
+            thisline[i] = read_line (all_line[i][alt[i][0]],
+                                     streams[i], &ib[i]);
 
             if (thisline[i])
               check_order (all_line[i][alt[i][1]], thisline[i], i + 1);
@@ -389,6 +503,15 @@ compare_files (char **infiles)
     if (fclose (streams[i]) != 0)
       die (EXIT_FAILURE, errno, "%s", quotef (infiles[i]));
 
+  /* Every adjacent pair of lines is compared only when order checking
+     is enabled, and disorder is then fatal, so getting here with
+     --check-order means each input was verified to be sorted.  */
+  if (sorted_cache_file && check_input_order == CHECK_ORDER_ENABLED)
+    for (i = 0; i < 2; i++)
+      if (cacheable[i] && ! input_verified[i]
+          && ! sorted_cache_note (sorted_cache_file, &instat[i], cache_opts))
+        error (0, errno, _("error writing %s"), quoteaf (sorted_cache_file));
+
   if (total_option)
     {
       /* Print the summary, minding the column and line delimiters.  */
@@ -460,6 +583,10 @@ main (int argc, char **argv)
         col_sep_len = *optarg ? strlen (optarg) : 1;
         break;
 
+      case SORTED_CACHE_OPTION:
+        sorted_cache_file = optarg;
+        break;
+
       case TOTAL_OPTION:
         total_option = true;
         break;
@@ -19,6 +19,8 @@
 #include <config.h>
 #include <stdio.h>
 #include <assert.h>
+#include <pthread.h>
+#include <signal.h>
 #include <sys/ioctl.h>
 #include <sys/types.h>
 #include <selinux/selinux.h>
@@ -52,6 +54,7 @@
 #include "hash-triple.h"
 #include "ignore-value.h"
 #include "ioblksize.h"
+#include "probes.h"
 #include "quote.h"
 #include "renameatu.h"
 #include "root-uid.h"
@@ -73,6 +76,15 @@
 # include "verror.h"
 #endif
 
+#if HAVE_AIO_WRITE
+# include <aio.h>
+#endif
+
+#if USE_AVX2_ZEROSCAN
+# include <cpuid.h>
+# include "zero-scan-simd.h"
+#endif
+
 #if HAVE_LINUX_FALLOC_H
 # include <linux/falloc.h>
 #endif
@@ -217,6 +229,52 @@ punch_hole (int fd, off_t offset, off_t length)
   return ret;
 }
 
+/* Nonzero when SIGUSR1 has requested an interim statistics report.
+   Set by the caller's signal handler; tested on the copy loops.  */
+sig_atomic_t volatile copy_stats_requested;
+
+/* Counters reported by copy_stats_report.  Worker threads spawned for
+   --parallel share them, so they are guarded by copy_stats_lock;
+   updates are batched per file, per extent or per hole to keep the
+   lock off the per-block path.  */
+static pthread_mutex_t copy_stats_lock = PTHREAD_MUTEX_INITIALIZER;
+static struct
+{
+  uintmax_t n_files;		/* Regular files whose data was copied.  */
+  uintmax_t n_hole_scans;	/* Files scanned for holes.  */
+  uintmax_t n_holes;		/* Holes reproduced in the destination.  */
+  uintmax_t hole_bytes;		/* Bytes covered by those holes.  */
+  uintmax_t bytes_offloaded;	/* Bytes moved in-kernel.  */
+  uintmax_t bytes_copied;	/* Bytes moved through read/write.  */
+} copy_stats;
+
+/* Add OFFLOADED bytes moved by copy_file_range and COPIED bytes moved
+   through the user-space buffer to the statistics.  */
+
+static void
+copy_stats_add (uintmax_t offloaded, uintmax_t copied)
+{
+  pthread_mutex_lock (&copy_stats_lock);
+  copy_stats.bytes_offloaded += offloaded;
+  copy_stats.bytes_copied += copied;
+  pthread_mutex_unlock (&copy_stats_lock);
+}
+
+void
+copy_stats_report (void)
+{
+  pthread_mutex_lock (&copy_stats_lock);
+  error (0, 0, _("%ju files copied: %ju bytes moved in-kernel,"
+                 " %ju bytes through read/write"),
+         copy_stats.n_files, copy_stats.bytes_offloaded,
+         copy_stats.bytes_copied);
+  error (0, 0, _("%ju files scanned for holes; %ju holes (%ju bytes)"
+                 " reproduced"),
+         copy_stats.n_hole_scans, copy_stats.n_holes,
+         copy_stats.hole_bytes);
+  pthread_mutex_unlock (&copy_stats_lock);
+}
+
 /* Create a hole at the end of a file,
    avoiding preallocation if requested.  */
 
@@ -241,9 +299,184 @@ create_hole (int fd, char const *name, bool punch_holes, off_t size)
       return false;
     }
 
+  pthread_mutex_lock (&copy_stats_lock);
+  copy_stats.n_holes++;
+  copy_stats.hole_bytes += size;
+  pthread_mutex_unlock (&copy_stats_lock);
+
   return true;
 }
 
+#if HAVE_AIO_WRITE
+
+/* Wait for the asynchronous write described by CB on the file
+   DST_NAME to complete, finishing any partial write synchronously.
+   Return true on success; print a diagnostic and return false
+   upon error.  */
+static bool
+await_write (struct aiocb *cb, char const *dst_name)
+{
+  while (aio_error (cb) == EINPROGRESS)
+    {
+      struct aiocb const *list[1] = { cb };
+      aio_suspend (list, 1, NULL);
+    }
+
+  int err = aio_error (cb);
+  ssize_t n_written = aio_return (cb);
+  if (err)
+    {
+      error (0, err, _("error writing %s"), quoteaf (dst_name));
+      return false;
+    }
+
+  /* A short write is possible; finish the chunk in the foreground.  */
+  if (n_written < (ssize_t) cb->aio_nbytes)
+    {
+      char const *rest = (char const *) cb->aio_buf + n_written;
+      size_t n_rest = cb->aio_nbytes - n_written;
+      if (lseek (cb->aio_fildes, cb->aio_offset + n_written, SEEK_SET) < 0
+          || full_write (cb->aio_fildes, rest, n_rest) != n_rest)
+        {
+          error (0, errno, _("error writing %s"), quoteaf (dst_name));
+          return false;
+        }
+    }
+
+  return true;
+}
+
+/* Copy from SRC_FD to DEST_FD, overlapping the write of each buffer
+   with the read of the next one so that neither device idles while
+   the other works.  BUF is the BUF_SIZE-byte buffer of the caller;
+   a second buffer of the same size is allocated here.  Copy no more
+   than MAX_N_READ bytes, adding the number of bytes read to
+   *TOTAL_N_READ.  Set *USED to whether the copy was attempted here;
+   if false, nothing was done and the caller should copy as usual.
+   Return true upon successful completion; print a diagnostic and
+   return false upon error.  */
+static bool
+overlap_copy (int src_fd, int dest_fd, char *buf, size_t buf_size,
+              char const *src_name, char const *dst_name,
+              uintmax_t max_n_read, off_t *total_n_read, bool *used)
+{
+  *used = false;
+
+  /* Asynchronous writes do not advance the file offset, so the
+     destination must be seekable to track position explicitly.  */
+  off_t dest_off = lseek (dest_fd, 0, SEEK_CUR);
+  if (dest_off < 0)
+    return true;
+
+  size_t buf_alignment = getpagesize ();
+  char *buf2_alloc = malloc (buf_size + buf_alignment);
+  if (! buf2_alloc)
+    return true;
+  char *bufs[2] = { buf, ptr_align (buf2_alloc, buf_alignment) };
+
+  *used = true;
+  bool ok = true;
+  bool write_pending = false;
+  int cur = 0;
+  struct aiocb cb = { .aio_fildes = dest_fd };
+
+  while (max_n_read)
+    {
+      ssize_t n_read = read (src_fd, bufs[cur], MIN (max_n_read, buf_size));
+      if (n_read < 0)
+        {
+          if (errno == EINTR)
+            continue;
+          error (0, errno, _("error reading %s"), quoteaf (src_name));
+          ok = false;
+          break;
+        }
+      if (n_read == 0)
+        break;
+
+      /* The previous chunk must land before its buffer is reused.  */
+      if (write_pending)
+        {
+          write_pending = false;
+          if (! await_write (&cb, dst_name))
+            {
+              ok = false;
+              break;
+            }
+        }
+
+      cb.aio_buf = bufs[cur];
+      cb.aio_nbytes = n_read;
+      cb.aio_offset = dest_off;
+      if (aio_write (&cb) == 0)
+        write_pending = true;
+      else
+        {
+          /* Queue full or AIO unsupported; write this chunk in the
+             foreground and carry on.  */
+          if (lseek (dest_fd, dest_off, SEEK_SET) < 0
+              || full_write (dest_fd, bufs[cur], n_read) != n_read)
+            {
+              error (0, errno, _("error writing %s"), quoteaf (dst_name));
+              ok = false;
+              break;
+            }
+        }
+
+      dest_off += n_read;
+      max_n_read -= n_read;
+      *total_n_read += n_read;
+      cur = !cur;
+    }
+
+  if (write_pending && ! await_write (&cb, dst_name))
+    ok = false;
+
+  free (buf2_alloc);
+
+  /* Leave the file offset where a synchronous copy would have.  */
+  if (ok && lseek (dest_fd, dest_off, SEEK_SET) < 0)
+    {
+      error (0, errno, _("cannot lseek %s"), quoteaf (dst_name));
+      ok = false;
+    }
+
+  return ok;
+}
+
+#endif
+
+#if USE_AVX2_ZEROSCAN
+/* Whether the CPU supports the AVX2 zero scanner;
+   -1 before the first probe.  */
+static int have_avx2 = -1;
+
+static int
+avx2_supported (void)
+{
+  unsigned int eax = 0, ebx = 0, ecx = 0, edx = 0;
+
+  if (!__get_cpuid_count (7, 0, &eax, &ebx, &ecx, &edx))
+    return 0;
+
+  return (ebx & bit_AVX2) != 0;
+}
+#endif
+
+/* Return whether the CSIZE bytes at CBUF are all NUL, like is_nul,
+   checking with the AVX2 scanner when the CPU has it.  */
+static bool
+buffer_is_nul (char const *cbuf, size_t csize)
+{
+#if USE_AVX2_ZEROSCAN
+  if (have_avx2 < 0)
+    have_avx2 = avx2_supported ();
+
+  if (have_avx2)
+    return is_nul_avx2 (cbuf, csize);
+#endif
+  return is_nul (cbuf, csize);
+}
 
 /* Copy the regular file open on SRC_FD/SRC_NAME to DST_FD/DST_NAME,
    honoring the MAKE_HOLES setting and using the BUF_SIZE-byte buffer
@@ -285,6 +518,7 @@ sparse_copy (int src_fd, int dest_fd, char *buf, size_t buf_size,
                input file seems empty.  */
             if (*total_n_read == 0)
               break;
+            copy_stats_add (*total_n_read, 0);
             return true;
           }
         if (n_copied < 0)
@@ -298,6 +532,7 @@ sparse_copy (int src_fd, int dest_fd, char *buf, size_t buf_size,
               {
                 error (0, errno, _("error copying %s to %s"),
                        quoteaf_n (0, src_name), quoteaf_n (1, dst_name));
+                copy_stats_add (*total_n_read, 0);
                 return false;
               }
           }
@@ -305,17 +540,45 @@ sparse_copy (int src_fd, int dest_fd, char *buf, size_t buf_size,
         *total_n_read += n_copied;
       }
 
+  /* Bytes moved so far went through copy_file_range; the rest go
+     through the user-space buffer.  */
+  uintmax_t n_offloaded = *total_n_read;
+
+#if HAVE_AIO_WRITE
+  /* When not looking for holes, overlap reads and writes so that
+     consecutive chunks are in flight on both files at once.  */
+  if (!hole_size && max_n_read)
+    {
+      bool used;
+      bool ok = overlap_copy (src_fd, dest_fd, buf, buf_size,
+                              src_name, dst_name, max_n_read,
+                              total_n_read, &used);
+      if (used)
+        {
+          copy_stats_add (n_offloaded, *total_n_read - n_offloaded);
+          return ok;
+        }
+    }
+#endif
+
   bool make_hole = false;
   off_t psize = 0;
 
   while (max_n_read)
     {
+      if (copy_stats_requested)
+        {
+          copy_stats_requested = 0;
+          copy_stats_report ();
+        }
+
       ssize_t n_read = read (src_fd, buf, MIN (max_n_read, buf_size));
       if (n_read < 0)
         {
           if (errno == EINTR)
             continue;
           error (0, errno, _("error reading %s"), quoteaf (src_name));
+          copy_stats_add (n_offloaded, *total_n_read - n_offloaded);
           return false;
         }
       if (n_read == 0)
@@ -334,7 +597,7 @@ sparse_copy (int src_fd, int dest_fd, char *buf, size_t buf_size,
           csize = MIN (csize, n_read);
 
           if (hole_size && csize)
-            make_hole = is_nul (cbuf, csize);
+            make_hole = buffer_is_nul (cbuf, csize);
 
           bool transition = (make_hole != prev_hole) && psize;
           bool last_chunk = (n_read == csize && ! make_hole) || ! csize;
@@ -350,13 +613,17 @@ sparse_copy (int src_fd, int dest_fd, char *buf, size_t buf_size,
                     {
                       error (0, errno, _("error writing %s"),
                              quoteaf (dst_name));
+                      copy_stats_add (n_offloaded, *total_n_read - n_offloaded);
                       return false;
                     }
                 }
               else
                 {
                   if (! create_hole (dest_fd, dst_name, punch_holes, psize))
-                    return false;
+                    {
+                      copy_stats_add (n_offloaded, *total_n_read - n_offloaded);
+                      return false;
+                    }
                 }
 
               pbuf = cbuf;
@@ -378,6 +645,7 @@ sparse_copy (int src_fd, int dest_fd, char *buf, size_t buf_size,
               if (INT_ADD_WRAPV (psize, csize, &psize))
                 {
                   error (0, 0, _("overflow reading %s"), quoteaf (src_name));
+                  copy_stats_add (n_offloaded, *total_n_read - n_offloaded);
                   return false;
                 }
             }
@@ -396,10 +664,10 @@ sparse_copy (int src_fd, int dest_fd, char *buf, size_t buf_size,
 
   /* Ensure a trailing hole is created, so that subsequent
      calls of sparse_copy() start at the correct offset.  */
-  if (make_hole && ! create_hole (dest_fd, dst_name, punch_holes, psize))
-    return false;
-  else
-    return true;
+  bool ok = ! (make_hole
+               && ! create_hole (dest_fd, dst_name, punch_holes, psize));
+  copy_stats_add (n_offloaded, *total_n_read - n_offloaded);
+  return ok;
 }
 
 /* Perform the O(1) btrfs clone operation, if possible.
@@ -522,6 +790,7 @@ extent_copy (int src_fd, int dest_fd, char *buf, size_t buf_size,
                 {
                   error (0, errno, _("cannot lseek %s"), quoteaf (src_name));
                 fail:
+                  extent_scan_drain (scan);
                   extent_scan_free (scan);
                   return false;
                 }
@@ -613,6 +882,10 @@ extent_copy (int src_fd, int dest_fd, char *buf, size_t buf_size,
         }
     }
 
+  /* The copy can stop short of the last fetched extent, e.g. at the
+     apparent size, with a read-ahead of further extents in flight.  */
+  extent_scan_drain (scan);
+
   /* When the source file ends with a hole, we have to do a little more work,
      since the above copied only up to and including the final extent.
      In order to complete the copy, we may have to insert a hole or write
@@ -723,12 +996,14 @@ lseek_copy (int src_fd, int dest_fd, char *buf, size_t buf_size,
       last_ext_len = ext_len;
 
       /* Copy this extent, looking for further opportunities to not
-         bother to write zeros unless --sparse=never, since SEEK_HOLE
-         is conservative and may miss some holes.  */
+         bother to write zeros only with --sparse=always, since
+         SEEK_HOLE has already identified the holes that matter.
+         Passing no hole size lets sparse_copy use copy_file_range,
+         moving each extent within the kernel.  */
       off_t n_read;
       bool read_hole;
       if ( ! sparse_copy (src_fd, dest_fd, buf, buf_size,
-                          sparse_mode == SPARSE_NEVER ? 0 : hole_size,
+                          sparse_mode == SPARSE_ALWAYS ? hole_size : 0,
                           true, src_name, dst_name, ext_len, &n_read,
                           &read_hole))
         return false;
@@ -902,6 +1177,76 @@ copy_attr (char const *src_path _GL_UNUSED,
 }
 #endif /* USE_XATTR */
 
+/* A copy of one directory entry, deferred so that a worker thread
+   can perform it.  */
+struct copy_job
+{
+  char *src_name;
+  char *dst_name;
+  bool ok;
+  bool copy_into_self;
+  bool first_dir_created;
+};
+
+/* Shared state for the worker threads copying the entries of one
+   directory.  */
+struct copy_pool
+{
+  struct copy_job *jobs;
+  size_t njobs;
+  size_t next;                  /* Index of the next unclaimed job.  */
+  pthread_mutex_t lock;
+  bool new_dst;
+  struct stat const *src_sb;
+  struct dir_list *ancestors;
+  struct cp_options const *options;
+  bool first_dir_created;       /* Seed value for every job.  */
+};
+
+/* Claim jobs from POOL_ARG and run each through copy_internal until
+   none remain.  */
+static void *
+copy_job_thread (void *pool_arg)
+{
+  struct copy_pool *pool = pool_arg;
+
+  while (true)
+    {
+      pthread_mutex_lock (&pool->lock);
+      size_t i = pool->next;
+      if (i < pool->njobs)
+        pool->next++;
+      pthread_mutex_unlock (&pool->lock);
+      if (pool->njobs <= i)
+        break;
+
+      struct copy_job *job = &pool->jobs[i];
+      bool first_dir_created = pool->first_dir_created;
+      job->ok = copy_internal (job->src_name, job->dst_name, pool->new_dst,
+                               pool->src_sb, pool->ancestors, pool->options,
+                               false, &first_dir_created,
+                               &job->copy_into_self, NULL);
+      job->first_dir_created = first_dir_created;
+    }
+
+  return NULL;
+}
+
+/* Whether the directory entry SRC_NAME may be copied by a worker
+   thread.  Only ordinary regular files with a single link qualify:
+   directories must be created in order on the main thread, symbolic
+   links may resolve to files the link-preserving machinery is still
+   copying, and multiply linked files must be seen by that machinery
+   one at a time.  */
+static bool
+parallel_eligible (char const *src_name)
+{
+  struct stat sb;
+  return (lstat (src_name, &sb) == 0
+          && S_ISREG (sb.st_mode)
+          && sb.st_nlink == 1);
+}
+
 /* Read the contents of the directory SRC_NAME_IN, and recursively
    copy the contents to DST_NAME_IN.  NEW_DST is true if
    DST_NAME_IN is a directory that was created previously in the
@@ -940,6 +1285,20 @@ copy_dir (char const *src_name_in, char const *dst_name_in, bool new_dst,
   if (x->dereference == DEREF_COMMAND_LINE_ARGUMENTS)
     non_command_line_options.dereference = DEREF_NEVER;
 
+  /* Prompting from several threads at once would interleave, so run
+     workers only when no per-file prompting can occur; mv without -f
+     may prompt even with I_UNSPECIFIED.  In move mode each worker
+     also unlinks its source file after copying it, and the emptied
+     source directories are still removed in order, since that happens
+     only after the pool for each directory has been joined.  */
+  bool parallel = (1 < x->nthreads
+                   && x->interactive != I_ASK_USER
+                   && ! (x->move_mode && x->interactive == I_UNSPECIFIED
+                         && x->stdin_tty));
+  struct copy_job *jobs = NULL;
+  size_t njobs = 0;
+  size_t jobs_alloc = 0;
+
   bool new_first_dir_created = false;
   namep = name_space;
   while (*namep != '\0')
@@ -949,6 +1308,18 @@ copy_dir (char const *src_name_in, char const *dst_name_in, bool new_dst,
       char *dst_name = file_name_concat (dst_name_in, namep, NULL);
       bool first_dir_created = *first_dir_created_per_command_line_arg;
 
+      if (parallel && parallel_eligible (src_name))
+        {
+          /* Defer this entry to the worker pool below.  */
+          if (njobs == jobs_alloc)
+            jobs = X2NREALLOC (jobs, &jobs_alloc);
+          jobs[njobs].src_name = src_name;
+          jobs[njobs].dst_name = dst_name;
+          njobs++;
+          namep += strlen (namep) + 1;
+          continue;
+        }
+
       ok &= copy_internal (src_name, dst_name, new_dst, src_sb,
                            ancestors, &non_command_line_options, false,
                            &first_dir_created,
@@ -968,6 +1339,48 @@ copy_dir (char const *src_name_in, char const *dst_name_in, bool new_dst,
       namep += strlen (namep) + 1;
     }
   free (name_space);
+
+  if (njobs)
+    {
+      struct copy_pool pool;
+      pool.jobs = jobs;
+      pool.njobs = njobs;
+      pool.next = 0;
+      pthread_mutex_init (&pool.lock, NULL);
+      pool.new_dst = new_dst;
+      pool.src_sb = src_sb;
+      pool.ancestors = ancestors;
+      pool.options = &non_command_line_options;
+      pool.first_dir_created = *first_dir_created_per_command_line_arg;
+
+      /* Spawn up to nthreads workers, counting this thread, which
+         joins in below; if thread creation fails, the survivors and
+         this thread simply drain the whole queue.  */
+      size_t nworkers = MIN (x->nthreads, njobs) - 1;
+      pthread_t *threads = xnmalloc (nworkers, sizeof *threads);
+      size_t nstarted = 0;
+      while (nstarted < nworkers
+             && pthread_create (&threads[nstarted], NULL,
+                                copy_job_thread, &pool) == 0)
+        nstarted++;
+
+      copy_job_thread (&pool);
+
+      for (size_t i = 0; i < nstarted; i++)
+        pthread_join (threads[i], NULL);
+      free (threads);
+      pthread_mutex_destroy (&pool.lock);
+
+      for (size_t i = 0; i < njobs; i++)
+        {
+          ok &= jobs[i].ok;
+          *copy_into_self |= jobs[i].copy_into_self;
+          new_first_dir_created |= jobs[i].first_dir_created;
+          free (jobs[i].dst_name);
+          free (jobs[i].src_name);
+        }
+    }
+  free (jobs);
   *first_dir_created_per_command_line_arg = new_first_dir_created;
 
   return ok;
@@ -1252,6 +1665,120 @@ infer_scantype (int fd, struct stat const *sb,
   return scan->initial_scan_failed ? ZERO_SCANTYPE : EXTENT_SCANTYPE;
 }
 
+/* With --fsync, copied regular files are not synced one by one.
+   Instead their descriptors are kept open and fsynced in batches of
+   FSYNC_BATCH, so the device flush for each batch overlaps with the
+   writeback of the files copied after it.  Shared by the --parallel
+   worker threads.  */
+
+enum { FSYNC_BATCH = 64 };
+
+struct fsync_ent
+{
+  int fd;
+  char *name;
+};
+
+static struct
+{
+  pthread_mutex_t lock;
+  struct fsync_ent ent[FSYNC_BATCH];
+  size_t n_ent;
+  bool failed;
+} fsync_queue = { .lock = PTHREAD_MUTEX_INITIALIZER };
+
+/* Fsync and close the N_ENT files in ENT, freeing their names.
+   Return true if every one was synced and closed successfully.  */
+
+static bool
+fsync_batch (struct fsync_ent *ent, size_t n_ent)
+{
+  bool ok = true;
+
+  for (size_t i = 0; i < n_ent; i++)
+    {
+      if (fsync (ent[i].fd) != 0)
+        {
+          error (0, errno, _("failed to sync %s"), quoteaf (ent[i].name));
+          ok = false;
+          close (ent[i].fd);
+        }
+      else if (close (ent[i].fd) < 0)
+        {
+          error (0, errno, _("failed to close %s"), quoteaf (ent[i].name));
+          ok = false;
+        }
+      free (ent[i].name);
+    }
+
+  return ok;
+}
+
+/* Queue DEST_DESC, the descriptor of the just-copied file DST_NAME,
+   for a batched fsync, taking ownership of the descriptor.  */
+
+static void
+defer_fsync (int dest_desc, char const *dst_name)
+{
+#if HAVE_SYNC_FILE_RANGE
+  /* Start writeback now, so that by the time this file's batch is
+     fsynced most of its pages are already on their way to the disk.  */
+  sync_file_range (dest_desc, 0, 0, SYNC_FILE_RANGE_WRITE);
+#endif
+
+  struct fsync_ent batch[FSYNC_BATCH];
+  size_t n_batch = 0;
+
+  pthread_mutex_lock (&fsync_queue.lock);
+  fsync_queue.ent[fsync_queue.n_ent].fd = dest_desc;
+  fsync_queue.ent[fsync_queue.n_ent].name = xstrdup (dst_name);
+  if (++fsync_queue.n_ent == FSYNC_BATCH)
+    {
+      memcpy (batch, fsync_queue.ent, sizeof batch);
+      n_batch = fsync_queue.n_ent;
+      fsync_queue.n_ent = 0;
+    }
+  pthread_mutex_unlock (&fsync_queue.lock);
+
+  if (n_batch && ! fsync_batch (batch, n_batch))
+    {
+      pthread_mutex_lock (&fsync_queue.lock);
+      fsync_queue.failed = true;
+      pthread_mutex_unlock (&fsync_queue.lock);
+    }
+}
+
+/* Reopen NAME and queue it for a batched fsync, for callers that
+   rewrite a file after copying it (install --strip); the fsync queued
+   by the copy covered only the pre-rewrite contents.  Return true
+   unless the file cannot be reopened.  */
+
+extern bool
+copy_defer_fsync (char const *name)
+{
+  int fd = open (name, O_RDONLY | O_BINARY);
+  if (fd < 0)
+    {
+      error (0, errno, _("failed to sync %s"), quoteaf (name));
+      return false;
+    }
+  defer_fsync (fd, name);
+  return true;
+}
+
+/* Fsync any files still queued by defer_fsync.  Called once, after
+   all copying is done and the worker threads have been joined.
+   Return true if every deferred fsync, including those of earlier
+   batches, succeeded.  */
+
+extern bool
+copy_flush_fsync (void)
+{
+  bool ok = fsync_batch (fsync_queue.ent, fsync_queue.n_ent);
+  fsync_queue.n_ent = 0;
+  return ok && ! fsync_queue.failed;
+}
+
 
 /* Copy a regular file from SRC_NAME to DST_NAME.
    If the source file contains holes, copies holes and blocks of zeros
@@ -1300,6 +1827,9 @@ copy_reg (char const *src_name, char const *dst_name,
       goto close_src_desc;
     }
 
+  COREUTILS_PROBE2 (copy_file_start, src_name,
+                    (uintmax_t) src_open_sb.st_size);
+
   /* Compare the source dev/ino from the open file to the incoming,
      saved ones obtained via a previous call to stat.  */
   if (! SAME_INODE (*src_sb, src_open_sb))
@@ -1485,6 +2015,12 @@ copy_reg (char const *src_name, char const *dst_name,
           return_val = false;
           goto close_src_and_dst_desc;
         }
+
+      pthread_mutex_lock (&copy_stats_lock);
+      copy_stats.n_files++;
+      copy_stats.n_hole_scans += scantype != PLAIN_SCANTYPE;
+      pthread_mutex_unlock (&copy_stats_lock);
+
       bool make_holes
         = (S_ISREG (sb.st_mode)
            && (x->sparse_mode == SPARSE_ALWAYS
@@ -1637,7 +2173,9 @@ copy_reg (char const *src_name, char const *dst_name,
     }
 
 close_src_and_dst_desc:
-  if (close (dest_desc) < 0)
+  if (x->require_fsync && return_val)
+    defer_fsync (dest_desc, dst_name);
+  else if (close (dest_desc) < 0)
     {
       error (0, errno, _("failed to close %s"), quoteaf (dst_name));
       return_val = false;
@@ -1649,6 +2187,8 @@ close_src_desc:
       return_val = false;
     }
 
+  COREUTILS_PROBE3 (copy_file_done, src_name, dst_name, return_val);
+
   free (buf_alloc);
   free (name_alloc);
   return return_val;
@@ -3253,6 +3793,8 @@ cp_options_default (struct cp_options *x)
   x->chown_privileges = x->owner_privileges = (geteuid () == ROOT_UID);
 #endif
   x->rename_errno = -1;
+  x->nthreads = 1;
+  x->require_fsync = false;
 }
 
 /* Return true if it's OK for chown to fail, where errno is
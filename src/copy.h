@@ -19,6 +19,7 @@
 #ifndef COPY_H
 # define COPY_H
 
+# include <signal.h>
 # include <stdbool.h>
 # include "hash.h"
 
@@ -263,6 +264,16 @@ struct cp_options
   /* Control creation of COW files.  */
   enum Reflink_type reflink_mode;
 
+  /* If greater than 1, copy the ordinary regular files within each
+     directory with up to this many worker threads (cp --parallel).
+     Directories are still created in order on the main thread.  */
+  size_t nthreads;
+
+  /* If true, fsync each copied regular file (cp/install --fsync).
+     The fsyncs are issued in batches as the copy proceeds, and the
+     caller must invoke copy_flush_fsync once all copying is done.  */
+  bool require_fsync;
+
   /* This is a set of destination name/inode/dev triples.  Each such triple
      represents a file we have created corresponding to a source file name
      that was specified on the command line.  Use it to avoid clobbering
@@ -291,6 +302,15 @@ bool copy (char const *src_name, char const *dst_name,
            bool nonexistent_dst, const struct cp_options *options,
            bool *copy_into_self, bool *rename_succeeded);
 
+extern bool copy_defer_fsync (char const *name);
+extern bool copy_flush_fsync (void);
+
+/* Nonzero requests an interim statistics report from the copy loops;
+   a SIGUSR1 handler in the caller may set it.  */
+extern sig_atomic_t volatile copy_stats_requested;
+
+extern void copy_stats_report (void);
+
 extern bool set_process_security_ctx (char const *src_name,
                                       char const *dst_name,
                                       mode_t mode, bool new_dst,
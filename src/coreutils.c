@@ -21,15 +21,30 @@
 
 #include <config.h>
 #include <getopt.h>
+#include <selinux/selinux.h>
+#include <signal.h>
 #include <stdio.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <sys/wait.h>
 #if HAVE_PRCTL
 # include <sys/prctl.h>
 #endif
 
 #include "system.h"
+
+#if ! HAVE_NICE
+/* Include this after "system.h" so we're sure to have definitions
+   (from time.h or sys/time.h) required for e.g. the ru_utime member.  */
+# include <sys/resource.h>
+#endif
+
 #include "die.h"
 #include "error.h"
+#include "fd-reopen.h"
+#include "filenamecat.h"
 #include "quote.h"
+#include "xstrtol.h"
 
 #ifdef SINGLE_BINARY
 /* Declare the main function on each one of the selected tools.  This name
@@ -83,6 +98,34 @@ Built-in programs:\n\
 %s\n", prog_name_list);
 #endif
 
+      fputs (_("\
+\n\
+A persistent supervisor amortizes process start-up cost over many\n\
+short-lived invocations:\n\
+      --coreutils-server=SOCKET   listen on the Unix domain SOCKET and run\n\
+                                    each received request in a forked,\n\
+                                    pre-initialized worker\n\
+      --coreutils-client=SOCKET PROGRAM_NAME [PARAMETERS]...\n\
+                                  forward the invocation and the standard\n\
+                                    file descriptors to such a server, and\n\
+                                    exit with the program's exit status\n\
+"), stdout);
+
+      fputs (_("\
+\n\
+A combined launcher applies a whole wrapper chain in a single exec:\n\
+      --coreutils-launch [--chroot=DIR] [--context=CONTEXT] [--nohup]\n\
+          [--nice=N] [--input=MODE] [--output=MODE] [--error=MODE]\n\
+          [--unset=NAME] [NAME=VALUE]... PROGRAM [PARAMETERS]...\n\
+                                  run PROGRAM with a changed root\n\
+                                    directory, a security context, nohup\n\
+                                    semantics, stdbuf buffering modes, a\n\
+                                    niceness adjustment and environment\n\
+                                    changes applied here, instead of via\n\
+                                    stacked chroot, runcon, nohup, stdbuf,\n\
+                                    nice and env wrappers\n\
+"), stdout);
+
       printf (_("\
 \n\
 Use: '%s --coreutils-prog=PROGRAM_NAME --help' for individual program help.\n"),
@@ -127,6 +170,528 @@ launch_program (char const *prog_name, int prog_argc, char **prog_argv)
   exit (prog_main (prog_argc, prog_argv));
 }
 
+/* The --coreutils-server protocol.  A request is a single stream of
+   NUL-terminated strings: the client's working directory, its umask
+   in octal, and then the applet argument vector; the client's three
+   standard file descriptors ride along as SCM_RIGHTS ancillary data
+   on the first chunk, and the end of the vector is marked by closing
+   the writing side.  The reply is one byte: the applet's exit status,
+   with 128 added to the signal number if it was killed by a signal.
+   Forked workers inherit the supervisor's already-loaded program
+   text, shared libraries and locale data, which is what makes this
+   cheaper than an exec per invocation; they also inherit its
+   environment and locale settings, so clients with a different
+   LC_ALL or TZ see the server's.  */
+
+/* Fill SA with the AF_UNIX address of SOCKET_NAME, or die.  */
+
+static void
+set_socket_address (struct sockaddr_un *sa, char const *socket_name)
+{
+  if (sizeof sa->sun_path <= strlen (socket_name))
+    die (EXIT_FAILURE, 0, _("socket name %s is too long"),
+         quote (socket_name));
+  memset (sa, 0, sizeof *sa);
+  sa->sun_family = AF_UNIX;
+  strcpy (sa->sun_path, socket_name);
+}
+
+/* Run the applet described by the request in BUF (of BUF_LEN bytes,
+   parsed as above) with the standard file descriptors STD_FDS, then
+   report its exit status over CONN.  Called in a forked handler, so
+   exits rather than returns.  */
+
+static void
+serve_request (int conn, char *buf, size_t buf_len, int *std_fds)
+{
+  /* Split the request into its strings.  */
+  size_t nstrings = 0;
+  for (size_t i = 0; i < buf_len; i++)
+    nstrings += !buf[i];
+  if (nstrings < 3 || buf[buf_len - 1])
+    _exit (EXIT_FAILURE);
+
+  char **strings = xnmalloc (nstrings + 1, sizeof *strings);
+  char *p = buf;
+  for (size_t i = 0; i < nstrings; i++)
+    {
+      strings[i] = p;
+      p += strlen (p) + 1;
+    }
+  strings[nstrings] = NULL;
+
+  char const *cwd = strings[0];
+  mode_t mask = strtoul (strings[1], NULL, 8);
+  char **prog_argv = strings + 2;
+  int prog_argc = nstrings - 2;
+
+  /* Handlers must be able to wait for the applet even though the
+     supervisor lets init reap them.  */
+  signal (SIGCHLD, SIG_DFL);
+
+  pid_t pid = fork ();
+  if (pid < 0)
+    _exit (EXIT_FAILURE);
+  if (pid == 0)
+    {
+      for (int fd = 0; fd < 3; fd++)
+        if (dup2 (std_fds[fd], fd) < 0)
+          _exit (EXIT_FAILURE);
+      close (conn);
+
+      if (chdir (cwd) != 0)
+        die (EXIT_FAILURE, errno, _("cannot change to directory %s"),
+             quote (cwd));
+      umask (mask);
+
+      char *prog_name = last_component (prog_argv[0]);
+      char ginstall[] = "ginstall";
+      if (STREQ (prog_name, "install"))
+        prog_name = ginstall;
+      launch_program (prog_name, prog_argc, prog_argv);
+      die (EXIT_FAILURE, 0, _("unknown program %s"), quote (prog_name));
+    }
+
+  for (int fd = 0; fd < 3; fd++)
+    close (std_fds[fd]);
+
+  int wstatus;
+  while (waitpid (pid, &wstatus, 0) < 0)
+    if (errno != EINTR)
+      _exit (EXIT_FAILURE);
+
+  unsigned char status = (WIFEXITED (wstatus)
+                          ? WEXITSTATUS (wstatus)
+                          : 128 + WTERMSIG (wstatus));
+  ignore_value (write (conn, &status, 1));
+  _exit (EXIT_SUCCESS);
+}
+
+/* Read one request from CONN and run it via serve_request.
+   Called in a forked handler, so exits rather than returns.  */
+
+static void
+serve_connection (int conn)
+{
+  int std_fds[3] = { -1, -1, -1 };
+  size_t buf_size = 8192;
+  char *buf = xmalloc (buf_size);
+  size_t buf_len = 0;
+
+  /* The first chunk carries the file descriptors.  */
+  char cmsg_buf[CMSG_SPACE (3 * sizeof (int))];
+  struct iovec iov = { .iov_base = buf, .iov_len = buf_size };
+  struct msghdr msg = { .msg_iov = &iov, .msg_iovlen = 1,
+                        .msg_control = cmsg_buf,
+                        .msg_controllen = sizeof cmsg_buf };
+  ssize_t n = recvmsg (conn, &msg, MSG_CMSG_CLOEXEC);
+  if (n <= 0)
+    _exit (EXIT_FAILURE);
+  buf_len = n;
+
+  struct cmsghdr *cmsg = CMSG_FIRSTHDR (&msg);
+  if (! cmsg || cmsg->cmsg_level != SOL_SOCKET
+      || cmsg->cmsg_type != SCM_RIGHTS
+      || cmsg->cmsg_len != CMSG_LEN (3 * sizeof (int)))
+    _exit (EXIT_FAILURE);
+  memcpy (std_fds, CMSG_DATA (cmsg), sizeof std_fds);
+
+  /* Read the rest of the request, up to end of stream.  */
+  while (true)
+    {
+      if (buf_len == buf_size)
+        buf = x2realloc (buf, &buf_size);
+      n = read (conn, buf + buf_len, buf_size - buf_len);
+      if (n < 0 && errno == EINTR)
+        continue;
+      if (n < 0)
+        _exit (EXIT_FAILURE);
+      if (n == 0)
+        break;
+      buf_len += n;
+    }
+
+  serve_request (conn, buf, buf_len, std_fds);
+}
+
+/* Serve applet invocations on SOCKET_NAME until killed.  */
+
+static void server_run (char const *) ATTRIBUTE_NORETURN;
+static void
+server_run (char const *socket_name)
+{
+  struct sockaddr_un sa;
+  set_socket_address (&sa, socket_name);
+
+  int listen_fd = socket (AF_UNIX, SOCK_STREAM, 0);
+  if (listen_fd < 0)
+    die (EXIT_FAILURE, errno, _("cannot create socket"));
+
+  if (bind (listen_fd, (struct sockaddr *) &sa, sizeof sa) != 0)
+    {
+      /* A previous server may have left a stale socket behind;
+         take it over only if no one answers.  */
+      bool stale = false;
+      if (errno == EADDRINUSE)
+        {
+          int probe = socket (AF_UNIX, SOCK_STREAM, 0);
+          stale = (0 <= probe
+                   && connect (probe, (struct sockaddr *) &sa, sizeof sa) != 0
+                   && errno == ECONNREFUSED);
+          if (0 <= probe)
+            close (probe);
+        }
+      errno = EADDRINUSE;
+      if (! (stale
+             && unlink (socket_name) == 0
+             && bind (listen_fd, (struct sockaddr *) &sa, sizeof sa) == 0))
+        die (EXIT_FAILURE, errno, _("cannot bind to %s"),
+             quote (socket_name));
+    }
+
+  if (listen (listen_fd, 128) != 0)
+    die (EXIT_FAILURE, errno, _("cannot listen on %s"), quote (socket_name));
+
+  /* Let init reap the per-connection handlers, and survive clients
+     that disconnect before reading their exit status.  */
+  signal (SIGCHLD, SIG_IGN);
+  signal (SIGPIPE, SIG_IGN);
+
+  while (true)
+    {
+      int conn = accept (listen_fd, NULL, NULL);
+      if (conn < 0)
+        {
+          if (errno == EINTR || errno == ECONNABORTED)
+            continue;
+          die (EXIT_FAILURE, errno, _("cannot accept connection on %s"),
+               quote (socket_name));
+        }
+
+      pid_t pid = fork ();
+      if (pid == 0)
+        {
+          close (listen_fd);
+          serve_connection (conn);
+        }
+      if (pid < 0)
+        error (0, errno, _("cannot fork"));
+      close (conn);
+    }
+}
+
+/* Forward an invocation of PROG_ARGV (PROG_ARGC elements) to the
+   server at SOCKET_NAME and exit with the reported status.  */
+
+static void client_run (char const *, int, char **) ATTRIBUTE_NORETURN;
+static void
+client_run (char const *socket_name, int prog_argc, char **prog_argv)
+{
+  struct sockaddr_un sa;
+  set_socket_address (&sa, socket_name);
+
+  int conn = socket (AF_UNIX, SOCK_STREAM, 0);
+  if (conn < 0)
+    die (EXIT_FAILURE, errno, _("cannot create socket"));
+  if (connect (conn, (struct sockaddr *) &sa, sizeof sa) != 0)
+    die (EXIT_FAILURE, errno, _("cannot connect to %s"), quote (socket_name));
+
+  char *cwd = getcwd (NULL, 0);
+  if (! cwd)
+    die (EXIT_FAILURE, errno, _("cannot get current directory"));
+  mode_t mask = umask (0);
+  umask (mask);
+  char mask_buf[INT_BUFSIZE_BOUND (int)];
+  sprintf (mask_buf, "%o", (unsigned int) mask);
+
+  size_t buf_len = strlen (cwd) + 1 + strlen (mask_buf) + 1;
+  for (int i = 0; i < prog_argc; i++)
+    buf_len += strlen (prog_argv[i]) + 1;
+  char *buf = xmalloc (buf_len);
+  char *p = stpcpy (buf, cwd) + 1;
+  p = stpcpy (p, mask_buf) + 1;
+  for (int i = 0; i < prog_argc; i++)
+    p = stpcpy (p, prog_argv[i]) + 1;
+  free (cwd);
+
+  /* Attach the standard file descriptors to the first chunk.  */
+  char cmsg_buf[CMSG_SPACE (3 * sizeof (int))];
+  int std_fds[3] = { STDIN_FILENO, STDOUT_FILENO, STDERR_FILENO };
+  struct iovec iov = { .iov_base = buf, .iov_len = buf_len };
+  struct msghdr msg = { .msg_iov = &iov, .msg_iovlen = 1,
+                        .msg_control = cmsg_buf,
+                        .msg_controllen = sizeof cmsg_buf };
+  struct cmsghdr *cmsg = CMSG_FIRSTHDR (&msg);
+  cmsg->cmsg_level = SOL_SOCKET;
+  cmsg->cmsg_type = SCM_RIGHTS;
+  cmsg->cmsg_len = CMSG_LEN (3 * sizeof (int));
+  memcpy (CMSG_DATA (cmsg), std_fds, sizeof std_fds);
+
+  ssize_t n = sendmsg (conn, &msg, 0);
+  if (n < 0)
+    die (EXIT_FAILURE, errno, _("cannot send request to %s"),
+         quote (socket_name));
+  for (size_t sent = n; sent < buf_len; sent += n)
+    {
+      n = write (conn, buf + sent, buf_len - sent);
+      if (n < 0)
+        {
+          if (errno == EINTR)
+            {
+              n = 0;
+              continue;
+            }
+          die (EXIT_FAILURE, errno, _("cannot send request to %s"),
+               quote (socket_name));
+        }
+    }
+  if (shutdown (conn, SHUT_WR) != 0)
+    die (EXIT_FAILURE, errno, _("cannot send request to %s"),
+         quote (socket_name));
+
+  unsigned char status;
+  while ((n = read (conn, &status, 1)) < 0 && errno == EINTR)
+    continue;
+  if (n != 1)
+    die (EXIT_FAILURE, n < 0 ? errno : 0,
+         _("no reply from server on %s"), quote (socket_name));
+  exit (status);
+}
+
+/* The --coreutils-launch applet.  Job and sandbox launchers commonly
+   stack wrappers -- chroot ... runcon ... nohup stdbuf -oL nice env
+   ... COMMAND -- paying an exec per wrapper before the command runs.
+   The launcher applies the whole chain in this process and then
+   execs COMMAND once.  */
+
+/* Apply nohup's semantics: move the standard streams off the
+   terminal and ignore SIGHUP.  A condensed version of nohup's main;
+   unlike nohup, a failed exec's diagnostic may end up in nohup.out,
+   as the original standard error is not saved.  */
+
+static void
+launch_apply_nohup (void)
+{
+  bool ignoring_input = isatty (STDIN_FILENO);
+  bool redirecting_stdout = isatty (STDOUT_FILENO);
+  bool stdout_is_closed = (!redirecting_stdout && errno == EBADF);
+  bool redirecting_stderr = isatty (STDERR_FILENO);
+  int out_fd = STDOUT_FILENO;
+
+  /* Note /dev/null is deliberately opened for *writing*, to ensure
+     any read evokes an error.  */
+  if (ignoring_input
+      && fd_reopen (STDIN_FILENO, "/dev/null", O_WRONLY, 0) < 0)
+    die (EXIT_CANCELED, errno, _("failed to render standard input unusable"));
+
+  if (redirecting_stdout || (redirecting_stderr && stdout_is_closed))
+    {
+      char *in_home = NULL;
+      char const *file = "nohup.out";
+      int flags = O_CREAT | O_WRONLY | O_APPEND;
+      mode_t mode = S_IRUSR | S_IWUSR;
+      mode_t umask_value = umask (~mode);
+      out_fd = (redirecting_stdout
+                ? fd_reopen (STDOUT_FILENO, file, flags, mode)
+                : open (file, flags, mode));
+
+      if (out_fd < 0)
+        {
+          char const *home = getenv ("HOME");
+          if (home)
+            {
+              in_home = file_name_concat (home, file, NULL);
+              out_fd = (redirecting_stdout
+                        ? fd_reopen (STDOUT_FILENO, in_home, flags, mode)
+                        : open (in_home, flags, mode));
+              file = in_home;
+            }
+          if (out_fd < 0)
+            die (EXIT_CANCELED, errno, _("failed to open %s"), quoteaf (file));
+        }
+
+      umask (umask_value);
+      error (0, 0,
+             _(ignoring_input
+               ? N_("ignoring input and appending output to %s")
+               : N_("appending output to %s")),
+             quoteaf (file));
+      free (in_home);
+    }
+
+  if (redirecting_stderr)
+    {
+      if (dup2 (out_fd, STDERR_FILENO) < 0)
+        die (EXIT_CANCELED, errno, _("failed to redirect standard error"));
+      if (stdout_is_closed)
+        close (out_fd);
+    }
+
+  signal (SIGHUP, SIG_IGN);
+}
+
+/* Export the buffering MODE for the stream whose stdbuf protocol
+   variable is VARNAME ("_STDBUF_I", "_STDBUF_O" or "_STDBUF_E"),
+   validating MODE as stdbuf does.  */
+
+static void
+launch_set_buffering (char const *varname, char const *mode)
+{
+  if (*mode == 'L' && STREQ (varname, "_STDBUF_I"))
+    die (EXIT_CANCELED, 0, _("line buffering stdin is meaningless"));
+
+  if (! STREQ (mode, "L"))
+    {
+      uintmax_t size;
+      if (xstrtoumax (mode, NULL, 10, &size, "EGkKMPTYZ0") != LONGINT_OK
+          || SIZE_MAX < size)
+        die (EXIT_CANCELED, 0, _("invalid mode %s"), quote (mode));
+    }
+
+  if (setenv (varname, mode, 1) != 0)
+    die (EXIT_CANCELED, errno, _("failed to update the environment with %s"),
+         quote (varname));
+}
+
+/* Preload libstdbuf so the buffering policy also reaches commands
+   that do not read the _STDBUF_* protocol natively.  The launcher is
+   reached through the installed multicall binary, so look only in
+   the installation directory, unlike stdbuf which also probes the
+   directory it was run from.  */
+
+static void
+launch_set_preload (void)
+{
+  char *old_libs = getenv ("LD_PRELOAD");
+  char *preload;
+  int ret = (old_libs
+             ? asprintf (&preload, "LD_PRELOAD=%s:%s/%s",
+                         old_libs, PKGLIBEXECDIR, "libstdbuf.so")
+             : asprintf (&preload, "LD_PRELOAD=%s/%s",
+                         PKGLIBEXECDIR, "libstdbuf.so"));
+  if (ret < 0)
+    xalloc_die ();
+
+  if (putenv (preload) != 0)
+    die (EXIT_CANCELED, errno, _("failed to update the environment with %s"),
+         quote (preload));
+}
+
+/* Run the command named by the first non-option element of ARGV
+   (ARGC elements), after applying the launch options and NAME=VALUE
+   environment assignments preceding it.  */
+
+static void launch_run (int, char **) ATTRIBUTE_NORETURN;
+static void
+launch_run (int argc, char **argv)
+{
+  bool apply_nohup = false;
+  bool buffering = false;
+  int adjustment = 0;
+  char const *newroot = NULL;
+  char const *scontext = NULL;
+  int i;
+
+  for (i = 0; i < argc; i++)
+    {
+      char *arg = argv[i];
+      if (STREQ (arg, "--nohup"))
+        apply_nohup = true;
+      else if (STRPREFIX (arg, "--chroot="))
+        newroot = arg + strlen ("--chroot=");
+      else if (STRPREFIX (arg, "--context="))
+        scontext = arg + strlen ("--context=");
+      else if (STRPREFIX (arg, "--nice="))
+        {
+          intmax_t tmp;
+          char const *spec = arg + strlen ("--nice=");
+          if (xstrtoimax (spec, NULL, 10, &tmp, "") != LONGINT_OK)
+            die (EXIT_CANCELED, 0, _("invalid adjustment %s"), quote (spec));
+          adjustment = MAX (INT_MIN, MIN (tmp, INT_MAX));
+        }
+      else if (STRPREFIX (arg, "--input="))
+        {
+          launch_set_buffering ("_STDBUF_I", arg + strlen ("--input="));
+          buffering = true;
+        }
+      else if (STRPREFIX (arg, "--output="))
+        {
+          launch_set_buffering ("_STDBUF_O", arg + strlen ("--output="));
+          buffering = true;
+        }
+      else if (STRPREFIX (arg, "--error="))
+        {
+          launch_set_buffering ("_STDBUF_E", arg + strlen ("--error="));
+          buffering = true;
+        }
+      else if (STRPREFIX (arg, "--unset="))
+        unsetenv (arg + strlen ("--unset="));
+      else if (STREQ (arg, "--"))
+        {
+          i++;
+          break;
+        }
+      else if (arg[0] != '-' && strchr (arg, '='))
+        {
+          if (putenv (arg) != 0)
+            die (EXIT_CANCELED, errno,
+                 _("failed to update the environment with %s"), quote (arg));
+        }
+      else
+        break;
+    }
+
+  if (argc <= i)
+    die (EXIT_CANCELED, 0, _("missing program name"));
+
+  /* Change the root first, so that like a chroot wrapper the command
+     is looked up inside the new root.  */
+  if (newroot)
+    {
+      if (chroot (newroot) != 0)
+        die (EXIT_CANCELED, errno, _("cannot change root directory to %s"),
+             quoteaf (newroot));
+      if (chdir ("/"))
+        die (EXIT_CANCELED, errno, _("cannot chdir to root directory"));
+    }
+
+  if (buffering)
+    launch_set_preload ();
+
+  if (adjustment)
+    {
+      /* As with nice, failure to adjust the niceness is diagnosed
+         but does not prevent running the command.  */
+      bool ok;
+      errno = 0;
+#if HAVE_NICE
+      ok = (nice (adjustment) != -1 || errno == 0);
+#else
+      int current = getpriority (PRIO_PROCESS, 0);
+      ok = (! (current == -1 && errno != 0)
+            && setpriority (PRIO_PROCESS, 0, current + adjustment) == 0);
+#endif
+      if (! ok)
+        error (0, errno, _("cannot set niceness"));
+    }
+
+  if (apply_nohup)
+    launch_apply_nohup ();
+
+  /* Like runcon, set the context last, just before the exec it
+     applies to.  */
+  if (scontext && setexeccon (scontext) != 0)
+    die (EXIT_CANCELED, errno, _("unable to set security context %s"),
+         quote (scontext));
+
+  char **cmd = argv + i;
+  execvp (*cmd, cmd);
+
+  int exit_status = errno == ENOENT ? EXIT_ENOENT : EXIT_CANNOT_INVOKE;
+  error (0, errno, _("failed to run command %s"), quoteaf (*cmd));
+  exit (exit_status);
+}
+
 int
 main (int argc, char **argv)
 {
@@ -154,6 +719,34 @@ main (int argc, char **argv)
       size_t nskip = 0;
       char *arg_name = NULL;
 
+      if (STRPREFIX (argv[1], "--coreutils-server="))
+        {
+          set_program_name (argv[0]);
+          setlocale (LC_ALL, "");
+          bindtextdomain (PACKAGE, LOCALEDIR);
+          textdomain (PACKAGE);
+          server_run (argv[1] + strlen ("--coreutils-server="));
+        }
+
+      if (STRPREFIX (argv[1], "--coreutils-client="))
+        {
+          set_program_name (argv[0]);
+          if (argc < 3)
+            die (EXIT_FAILURE, 0, _("missing program name"));
+          client_run (argv[1] + strlen ("--coreutils-client="),
+                      argc - 2, argv + 2);
+        }
+
+      if (STREQ (argv[1], "--coreutils-launch"))
+        {
+          set_program_name (argv[0]);
+          setlocale (LC_ALL, "");
+          bindtextdomain (PACKAGE, LOCALEDIR);
+          textdomain (PACKAGE);
+          initialize_exit_failure (EXIT_CANCELED);
+          launch_run (argc - 2, argv + 2);
+        }
+
       /* If calling coreutils directly, the "script" name isn't passed.
          Distinguish the two cases with a -shebang suffix.  */
       if (STRPREFIX (argv[1], "--coreutils-prog="))
@@ -15,22 +15,32 @@
    along with this program.  If not, see <https://www.gnu.org/licenses/>.
 
    Written by Torbjorn Granlund, Sweden (tege@sics.se).
-   Rewritten to use lib/hash.c by Jim Meyering.  */
+   Rewritten to use lib/hash.c by Jim Meyering.
+   Rewritten again as a sharded open-addressing table.  */
 
 #include <config.h>
 
 #include <sys/types.h>
+#include <pthread.h>
 #include "system.h"
 
-#include "hash.h"
 #include "cp-hash.h"
 
-/* Use ST_DEV and ST_INO as the key, FILENAME as the value.
-   These are used e.g., in copy.c to associate the destination name with
-   the source device/inode pair so that if we encounter a matching dev/ino
-   pair in the source tree we can arrange to create a hard link between
-   the corresponding names in the destination tree.  */
-struct Src_to_dest
+/* This table maps source dev/ino to destination file name.
+   We use it to preserve hard links when copying.
+
+   The table is split into independently locked and independently
+   resized shards, selected by the key's hash.  Worker threads
+   dispatched by copy.c therefore rarely contend with one another, and
+   a growth pause is bounded by the size of one shard rather than by
+   the whole table.  Within a shard, entries are kept in a linear-probe
+   open-addressing array at no more than half occupancy, so lookups
+   touch a handful of adjacent slots instead of chasing list links.  */
+
+/* One slot of a shard.  NAME is null in a slot that has never been
+   used, and TOMBSTONE in a slot whose entry has been removed; probe
+   sequences continue through the latter.  */
+struct cp_hash_entry
 {
   ino_t st_ino;
   dev_t st_dev;
@@ -40,40 +50,98 @@ struct Src_to_dest
   char *name;
 };
 
-/* This table maps source dev/ino to destination file name.
-   We use it to preserve hard links when copying.  */
-static Hash_table *src_to_dest;
+static char tombstone_storage;
+#define TOMBSTONE (&tombstone_storage)
+
+struct cp_hash_shard
+{
+  struct cp_hash_entry *table;
+  size_t size;                  /* Allocated slots; a power of two.  */
+  size_t n_live;                /* Slots holding a current entry.  */
+  size_t n_occupied;            /* Live slots plus tombstones.  */
+  pthread_mutex_t lock;
+};
+
+/* The shard count trades memory against lock contention; it must be a
+   power of two.  */
+enum { N_SHARDS = 16 };
+
+static struct cp_hash_shard shards[N_SHARDS];
 
-/* Initial size of the above hash table.  */
-#define INITIAL_TABLE_SIZE 103
+/* Initial number of slots per shard.  */
+enum { INITIAL_SHARD_SIZE = 16 };
 
+/* Hash the dev/ino pair INO, DEV into a well-mixed word.  Inode
+   numbers are frequently sequential, so multiply by a large odd
+   constant to spread them across the probe space.  */
 static size_t
-src_to_dest_hash (void const *x, size_t table_size)
+cp_hash_key (ino_t ino, dev_t dev)
 {
-  struct Src_to_dest const *p = x;
+  uintmax_t h = (uintmax_t) ino * 0x9E3779B97F4A7C15;
+  h ^= (uintmax_t) dev * 0xC2B2AE3D27D4EB4F;
+  return h ^ h >> 32;
+}
 
-  /* Ignoring the device number here should be fine.  */
-  /* The cast to uintmax_t prevents negative remainders
-     if st_ino is negative.  */
-  return (uintmax_t) p->st_ino % table_size;
+/* The shard responsible for hash H.  */
+static struct cp_hash_shard *
+cp_hash_shard (size_t h)
+{
+  return &shards[h & (N_SHARDS - 1)];
 }
 
-/* Compare two Src_to_dest entries.
-   Return true if their keys are judged 'equal'.  */
-static bool
-src_to_dest_compare (void const *x, void const *y)
+/* Return the slot in SHARD where the entry for H, INO, DEV lives, or
+   the slot where it should be inserted: the first tombstone on the
+   probe path if any, otherwise the terminating never-used slot.  */
+static struct cp_hash_entry *
+cp_hash_probe (struct cp_hash_shard *shard, size_t h, ino_t ino, dev_t dev)
 {
-  struct Src_to_dest const *a = x;
-  struct Src_to_dest const *b = y;
-  return SAME_INODE (*a, *b) ? true : false;
+  size_t mask = shard->size - 1;
+  struct cp_hash_entry *grave = NULL;
+
+  for (size_t i = (h / N_SHARDS) & mask; ; i = (i + 1) & mask)
+    {
+      struct cp_hash_entry *e = &shard->table[i];
+      if (! e->name)
+        return grave ? grave : e;
+      if (e->name == TOMBSTONE)
+        {
+          if (! grave)
+            grave = e;
+        }
+      else if (e->st_ino == ino && e->st_dev == dev)
+        return e;
+    }
 }
 
+/* Ensure SHARD has room for one more entry, keeping it no more than
+   half occupied.  Growing rehashes only this shard, so the pause is a
+   small fraction of the whole table.  */
 static void
-src_to_dest_free (void *x)
+cp_hash_reserve (struct cp_hash_shard *shard)
 {
-  struct Src_to_dest *a = x;
-  free (a->name);
-  free (x);
+  if (shard->n_occupied + 1 <= shard->size / 2)
+    return;
+
+  /* Double only when live entries warrant it; otherwise rebuild at
+     the same size to flush accumulated tombstones.  */
+  size_t new_size = shard->size;
+  if (shard->size / 4 <= shard->n_live)
+    new_size = shard->size * 2;
+
+  struct cp_hash_entry *old_table = shard->table;
+  size_t old_size = shard->size;
+  shard->table = xcalloc (new_size, sizeof *shard->table);
+  shard->size = new_size;
+  shard->n_occupied = shard->n_live;
+
+  for (size_t i = 0; i < old_size; i++)
+    {
+      struct cp_hash_entry *e = &old_table[i];
+      if (e->name && e->name != TOMBSTONE)
+        *cp_hash_probe (shard, cp_hash_key (e->st_ino, e->st_dev),
+                        e->st_ino, e->st_dev) = *e;
+    }
+  free (old_table);
 }
 
 /* Remove the entry matching INO/DEV from the table
@@ -81,16 +149,21 @@ src_to_dest_free (void *x)
 extern void
 forget_created (ino_t ino, dev_t dev)
 {
-  struct Src_to_dest probe;
-  struct Src_to_dest *ent;
+  size_t h = cp_hash_key (ino, dev);
+  struct cp_hash_shard *shard = cp_hash_shard (h);
+  char *name = NULL;
 
-  probe.st_ino = ino;
-  probe.st_dev = dev;
-  probe.name = NULL;
+  pthread_mutex_lock (&shard->lock);
+  struct cp_hash_entry *e = cp_hash_probe (shard, h, ino, dev);
+  if (e->name && e->name != TOMBSTONE)
+    {
+      name = e->name;
+      e->name = TOMBSTONE;
+      shard->n_live--;
+    }
+  pthread_mutex_unlock (&shard->lock);
 
-  ent = hash_remove (src_to_dest, &probe);
-  if (ent)
-    src_to_dest_free (ent);
+  free (name);
 }
 
 /* If INO/DEV correspond to an already-copied source file, return the
@@ -99,12 +172,15 @@ forget_created (ino_t ino, dev_t dev)
 extern char *
 src_to_dest_lookup (ino_t ino, dev_t dev)
 {
-  struct Src_to_dest ent;
-  struct Src_to_dest const *e;
-  ent.st_ino = ino;
-  ent.st_dev = dev;
-  e = hash_lookup (src_to_dest, &ent);
-  return e ? e->name : NULL;
+  size_t h = cp_hash_key (ino, dev);
+  struct cp_hash_shard *shard = cp_hash_shard (h);
+
+  pthread_mutex_lock (&shard->lock);
+  struct cp_hash_entry *e = cp_hash_probe (shard, h, ino, dev);
+  char *name = e->name && e->name != TOMBSTONE ? e->name : NULL;
+  pthread_mutex_unlock (&shard->lock);
+
+  return name;
 }
 
 /* Add file NAME, copied from inode number INO and device number DEV,
@@ -114,51 +190,60 @@ src_to_dest_lookup (ino_t ino, dev_t dev)
 extern char *
 remember_copied (char const *name, ino_t ino, dev_t dev)
 {
-  struct Src_to_dest *ent;
-  struct Src_to_dest *ent_from_table;
-
-  ent = xmalloc (sizeof *ent);
-  ent->name = xstrdup (name);
-  ent->st_ino = ino;
-  ent->st_dev = dev;
-
-  ent_from_table = hash_insert (src_to_dest, ent);
-  if (ent_from_table == NULL)
+  size_t h = cp_hash_key (ino, dev);
+  struct cp_hash_shard *shard = cp_hash_shard (h);
+  char *earlier_name = NULL;
+
+  pthread_mutex_lock (&shard->lock);
+  cp_hash_reserve (shard);
+  struct cp_hash_entry *e = cp_hash_probe (shard, h, ino, dev);
+  if (e->name && e->name != TOMBSTONE)
+    earlier_name = e->name;
+  else
     {
-      /* Insertion failed due to lack of memory.  */
-      xalloc_die ();
+      if (! e->name)
+        shard->n_occupied++;
+      e->st_ino = ino;
+      e->st_dev = dev;
+      e->name = xstrdup (name);
+      shard->n_live++;
     }
+  pthread_mutex_unlock (&shard->lock);
 
-  /* Determine whether there was already an entry in the table
-     with a matching key.  If so, free ENT (it wasn't inserted) and
-     return the 'name' from the table entry.  */
-  if (ent_from_table != ent)
-    {
-      src_to_dest_free (ent);
-      return (char *) ent_from_table->name;
-    }
-
-  /* New key;  insertion succeeded.  */
-  return NULL;
+  return earlier_name;
 }
 
 /* Initialize the hash table.  */
 extern void
 hash_init (void)
 {
-  src_to_dest = hash_initialize (INITIAL_TABLE_SIZE, NULL,
-                                 src_to_dest_hash,
-                                 src_to_dest_compare,
-                                 src_to_dest_free);
-  if (src_to_dest == NULL)
-    xalloc_die ();
+  for (int s = 0; s < N_SHARDS; s++)
+    {
+      shards[s].table = xcalloc (INITIAL_SHARD_SIZE,
+                                 sizeof *shards[s].table);
+      shards[s].size = INITIAL_SHARD_SIZE;
+      shards[s].n_live = 0;
+      shards[s].n_occupied = 0;
+      pthread_mutex_init (&shards[s].lock, NULL);
+    }
 }
 
-/* Reset the hash structure in the global variable 'htab' to
-   contain no entries.  */
+/* Reset the hash structure so that it contains no entries.  */
 
 extern void
 forget_all (void)
 {
-  hash_free (src_to_dest);
+  for (int s = 0; s < N_SHARDS; s++)
+    {
+      for (size_t i = 0; i < shards[s].size; i++)
+        {
+          char *name = shards[s].table[i].name;
+          if (name && name != TOMBSTONE)
+            free (name);
+        }
+      free (shards[s].table);
+      shards[s].table = NULL;
+      shards[s].size = 0;
+      pthread_mutex_destroy (&shards[s].lock);
+    }
 }
@@ -18,19 +18,32 @@
 
 #include <config.h>
 #include <stdio.h>
+#include <signal.h>
 #include <sys/types.h>
 #include <getopt.h>
 #include <selinux/label.h>
 
+/* Use SA_NOCLDSTOP as a proxy for whether the sigaction machinery is
+   present.  */
+#ifndef SA_NOCLDSTOP
+# define SA_NOCLDSTOP 0
+#endif
+#ifndef SA_RESTART
+# define SA_RESTART 0
+#endif
+
 #include "system.h"
 #include "argmatch.h"
 #include "backupfile.h"
 #include "copy.h"
 #include "cp-hash.h"
 #include "die.h"
+#include "dir-set.h"
 #include "error.h"
 #include "filenamecat.h"
 #include "ignore-value.h"
+#include "nproc.h"
+#include "xdectoint.h"
 #include "quote.h"
 #include "stat-time.h"
 #include "utimens.h"
@@ -65,11 +78,14 @@ enum
 {
   ATTRIBUTES_ONLY_OPTION = CHAR_MAX + 1,
   COPY_CONTENTS_OPTION,
+  FSYNC_OPTION,
   NO_PRESERVE_ATTRIBUTES_OPTION,
+  PARALLEL_OPTION,
   PARENTS_OPTION,
   PRESERVE_ATTRIBUTES_OPTION,
   REFLINK_OPTION,
   SPARSE_OPTION,
+  STATS_OPTION,
   STRIP_TRAILING_SLASHES_OPTION,
   UNLINK_DEST_BEFORE_OPENING
 };
@@ -84,6 +100,18 @@ static bool parents_option = false;
 /* Remove any trailing slashes from each SOURCE argument.  */
 static bool remove_trailing_slashes;
 
+/* If true, report copy statistics on stderr at exit (--stats).  */
+static bool stats;
+
+/* Handle SIGUSR1 by requesting an interim --stats report, which the
+   copy loops print at the next block boundary.  */
+
+static void
+stats_sighandler (int sig)
+{
+  copy_stats_requested = 1;
+}
+
 static char const *const sparse_type_string[] =
 {
   "never", "auto", "always", NULL
@@ -112,6 +140,7 @@ static struct option const long_opts[] =
   {"copy-contents", no_argument, NULL, COPY_CONTENTS_OPTION},
   {"dereference", no_argument, NULL, 'L'},
   {"force", no_argument, NULL, 'f'},
+  {"fsync", no_argument, NULL, FSYNC_OPTION},
   {"interactive", no_argument, NULL, 'i'},
   {"link", no_argument, NULL, 'l'},
   {"no-clobber", no_argument, NULL, 'n'},
@@ -119,12 +148,14 @@ static struct option const long_opts[] =
   {"no-preserve", required_argument, NULL, NO_PRESERVE_ATTRIBUTES_OPTION},
   {"no-target-directory", no_argument, NULL, 'T'},
   {"one-file-system", no_argument, NULL, 'x'},
+  {"parallel", optional_argument, NULL, PARALLEL_OPTION},
   {"parents", no_argument, NULL, PARENTS_OPTION},
   {"path", no_argument, NULL, PARENTS_OPTION},   /* Deprecated.  */
   {"preserve", optional_argument, NULL, PRESERVE_ATTRIBUTES_OPTION},
   {"recursive", no_argument, NULL, 'R'},
   {"remove-destination", no_argument, NULL, UNLINK_DEST_BEFORE_OPENING},
   {"sparse", required_argument, NULL, SPARSE_OPTION},
+  {"stats", no_argument, NULL, STATS_OPTION},
   {"reflink", optional_argument, NULL, REFLINK_OPTION},
   {"strip-trailing-slashes", no_argument, NULL, STRIP_TRAILING_SLASHES_OPTION},
   {"suffix", required_argument, NULL, 'S'},
@@ -170,6 +201,8 @@ Copy SOURCE to DEST, or multiple SOURCE(s) to DIRECTORY.\n\
   -f, --force                  if an existing destination file cannot be\n\
                                  opened, remove it and try again (this option\n\
                                  is ignored when the -n option is also used)\n\
+      --fsync                  sync each copied file to disk before exiting;\n\
+                                 the syncs are issued in overlapping batches\n\
   -i, --interactive            prompt before overwrite (overrides a previous -n\
 \n\
                                   option)\n\
@@ -194,6 +227,9 @@ Copy SOURCE to DEST, or multiple SOURCE(s) to DIRECTORY.\n\
 "), stdout);
       fputs (_("\
       --no-preserve=ATTR_LIST  don't preserve the specified attributes\n\
+      --parallel[=N]           with -R, copy the regular files within each\n\
+                                 directory with up to N threads\n\
+                                 (default: number of processors)\n\
       --parents                use full source file name under DIRECTORY\n\
 "), stdout);
       fputs (_("\
@@ -204,6 +240,8 @@ Copy SOURCE to DEST, or multiple SOURCE(s) to DIRECTORY.\n\
 \n"), stdout);
       fputs (_("\
       --sparse=WHEN            control creation of sparse files. See below\n\
+      --stats                  report copy statistics on stderr at exit;\n\
+                                 SIGUSR1 requests an interim report\n\
       --strip-trailing-slashes  remove any trailing slashes from each SOURCE\n\
                                  argument\n\
 "), stdout);
@@ -387,6 +425,14 @@ make_dir_parents_private (char const *const_dir, size_t src_offset,
 
   *attr_list = NULL;
 
+  /* If an earlier operand already created or verified this parent
+     chain, there is nothing left to stat or make.  */
+  if (dir_set_contains (dst_dir))
+    {
+      *new_dst = false;
+      return true;
+    }
+
   /* XXX: If all dirs are present at the destination,
      no permissions or security contexts will be updated.  */
   if (stat (dst_dir, &stats) != 0)
@@ -404,7 +450,8 @@ make_dir_parents_private (char const *const_dir, size_t src_offset,
           bool missing_dir;
 
           *slash = '\0';
-          missing_dir = (stat (dir, &stats) != 0);
+          bool known_dir = dir_set_contains (dir);
+          missing_dir = !known_dir && stat (dir, &stats) != 0;
 
           if (missing_dir || x->preserve_ownership || x->preserve_mode
               || x->preserve_timestamps)
@@ -517,7 +564,7 @@ make_dir_parents_private (char const *const_dir, size_t src_offset,
                     }
                 }
             }
-          else if (!S_ISDIR (stats.st_mode))
+          else if (!known_dir && !S_ISDIR (stats.st_mode))
             {
               error (0, 0, _("%s exists but is not a directory"),
                      quoteaf (dir));
@@ -526,6 +573,8 @@ make_dir_parents_private (char const *const_dir, size_t src_offset,
           else
             *new_dst = false;
 
+          dir_set_insert (dir);
+
           /* For existing dirs, set the security context as per that already
              set for the process global context.  */
           if (! *new_dst
@@ -556,6 +605,8 @@ make_dir_parents_private (char const *const_dir, size_t src_offset,
     {
       *new_dst = false;
     }
+
+  dir_set_insert (dst_dir);
   return true;
 }
 
@@ -648,6 +699,8 @@ do_copy (int n_files, char **file, char const *target_directory,
         {
           dest_info_init (x);
           src_info_init (x);
+          if (parents_option)
+            dir_set_init ();
         }
 
       for (int i = 0; i < n_files; i++)
@@ -960,6 +1013,10 @@ main (int argc, char **argv)
                                      sparse_type_string, sparse_type);
           break;
 
+        case STATS_OPTION:
+          stats = true;
+          break;
+
         case REFLINK_OPTION:
           if (optarg == NULL)
             x.reflink_mode = REFLINK_ALWAYS;
@@ -997,6 +1054,18 @@ main (int argc, char **argv)
           copy_contents = true;
           break;
 
+        case FSYNC_OPTION:
+          x.require_fsync = true;
+          break;
+
+        case PARALLEL_OPTION:
+          if (optarg)
+            x.nthreads = xdectoumax (optarg, 1, SIZE_MAX, "",
+                                     _("invalid number of threads"), 0);
+          else
+            x.nthreads = num_processors (NPROC_CURRENT_OVERRIDABLE);
+          break;
+
         case 'd':
           x.preserve_links = true;
           x.dereference = DEREF_NEVER;
@@ -1215,6 +1284,21 @@ main (int argc, char **argv)
                             "built without xattr support"));
 #endif
 
+  if (stats)
+    {
+      /* Let SIGUSR1 request an interim report; restart interrupted
+         reads so the signal does not perturb the copy.  */
+#if SA_NOCLDSTOP
+      struct sigaction act;
+      sigemptyset (&act.sa_mask);
+      act.sa_handler = stats_sighandler;
+      act.sa_flags = SA_RESTART;
+      sigaction (SIGUSR1, &act, NULL);
+#else
+      signal (SIGUSR1, stats_sighandler);
+#endif
+    }
+
   /* Allocate space for remembering copied and created files.  */
 
   hash_init ();
@@ -1222,6 +1306,12 @@ main (int argc, char **argv)
   ok = do_copy (argc - optind, argv + optind,
                 target_directory, no_target_directory, &x);
 
+  if (x.require_fsync)
+    ok &= copy_flush_fsync ();
+
+  if (stats)
+    copy_stats_report ();
+
 #ifdef lint
   forget_all ();
 #endif
@@ -58,6 +58,10 @@ struct control
   bool ignore;			/* If true, produce no output (for regexp). */
   bool regexpr;			/* True if regular expression was used. */
   struct re_pattern_buffer re_compiled;	/* Compiled regular expression. */
+  char *literal;		/* The pattern bytes, when the regexp has no
+				   metacharacters and substring search can
+				   stand in for the engine; else NULL. */
+  size_t literal_len;		/* Number of bytes in LITERAL. */
 };
 
 /* Initial size of data area in buffers. */
@@ -787,6 +791,27 @@ regexp_error (struct control *p, uintmax_t repetition, bool ignore)
   cleanup_fatal ();
 }
 
+/* Return true if the LINE_LEN bytes at STR (excluding any trailing
+   newline) match the pattern in P, using substring search when the
+   pattern is a literal string. */
+
+static bool
+line_matches (struct control const *p, char const *str, size_t line_len)
+{
+  if (p->literal)
+    return (p->literal_len <= line_len
+            && memmem (str, line_len, p->literal, p->literal_len) != NULL);
+
+  regoff_t ret = re_search (&p->re_compiled, str, line_len,
+                            0, line_len, NULL);
+  if (ret == -2)
+    {
+      error (0, 0, _("error in regular expression search"));
+      cleanup_fatal ();
+    }
+  return ret != -1;
+}
+
 /* Read the input until a line matches the regexp in P, outputting
    it unless P->IGNORE is true.
    REPETITION is this repeat-count; 0 means the first time. */
@@ -798,7 +823,6 @@ process_regexp (struct control *p, uintmax_t repetition)
   size_t line_len;		/* To make "$" in regexps work. */
   uintmax_t break_line;		/* First line number of next file. */
   bool ignore = p->ignore;	/* If true, skip this section. */
-  regoff_t ret;
 
   if (!ignore)
     create_output_file ();
@@ -828,26 +852,22 @@ process_regexp (struct control *p, uintmax_t repetition)
           line_len = line->len;
           if (line->str[line_len - 1] == '\n')
             line_len--;
-          ret = re_search (&p->re_compiled, line->str, line_len,
-                           0, line_len, NULL);
-          if (ret == -2)
-            {
-              error (0, 0, _("error in regular expression search"));
-              cleanup_fatal ();
-            }
-          if (ret == -1)
-            {
-              line = remove_line ();
-              if (!ignore)
-                save_line_to_file (line);
-            }
-          else
+          if (line_matches (p, line->str, line_len))
             break;
+          line = remove_line ();
+          if (!ignore)
+            save_line_to_file (line);
         }
     }
   else
     {
-      /* Buffer the lines. */
+      /* Buffer the lines.  Only -P->OFFSET lines of lookbehind are
+         needed: the split point precedes the match by that many lines,
+         so anything further behind the scan position is certain to
+         belong to the current section.  Output (or with IGNORE, drop)
+         such lines as we go, rather than retaining the whole section.  */
+      uintmax_t lookbehind = -p->offset;
+
       while (true)
         {
           line = find_line (++current_line);
@@ -868,15 +888,16 @@ process_regexp (struct control *p, uintmax_t repetition)
           line_len = line->len;
           if (line->str[line_len - 1] == '\n')
             line_len--;
-          ret = re_search (&p->re_compiled, line->str, line_len,
-                           0, line_len, NULL);
-          if (ret == -2)
-            {
-              error (0, 0, _("error in regular expression search"));
-              cleanup_fatal ();
-            }
-          if (ret != -1)
+          if (line_matches (p, line->str, line_len))
             break;
+
+          if (lookbehind < current_line)
+            while (head && head->first_available <= current_line - lookbehind)
+              {
+                struct cstring *decided = remove_line ();
+                if (!ignore)
+                  save_line_to_file (decided);
+              }
         }
     }
 
@@ -1074,6 +1095,8 @@ new_control_record (void)
   p->repeat_forever = false;
   p->lines_required = 0;
   p->offset = 0;
+  p->literal = NULL;
+  p->literal_len = 0;
   return p;
 }
 
@@ -1162,6 +1185,16 @@ extract_regexp (int argnum, bool ignore, char const *str)
       cleanup_fatal ();
     }
 
+  /* A pattern without metacharacters matches exactly where its bytes
+     occur, so substring search can stand in for the regexp engine.
+     Conservatively require that none of the characters special in basic
+     regular expressions appear anywhere in the pattern.  */
+  if (0 < len && len <= strcspn (str + 1, ".[^$*\\\n"))
+    {
+      p->literal = xmemdup (str + 1, len);
+      p->literal_len = len;
+    }
+
   if (closing_delim[1])
     check_for_offset (p, str, closing_delim + 1);
 
@@ -25,14 +25,13 @@
 #include <config.h>
 
 #include <stdio.h>
-#include <assert.h>
 #include <getopt.h>
 #include <sys/types.h>
 #include "system.h"
+#include "dec-input.h"
 
 #include "error.h"
 #include "fadvise.h"
-#include "getndelim2.h"
 #include "hash.h"
 #include "xstrndup.h"
 
@@ -111,6 +110,10 @@ static size_t output_delimiter_length;
    string consisting of the input delimiter.  */
 static char *output_delimiter_string;
 
+/* If true, filter compressed inputs, recognized by their magic
+   bytes, through the matching decompressor (--decompress).  */
+static bool decompress_input;
+
 /* True if we have ever read standard input. */
 static bool have_read_stdin;
 
@@ -119,7 +122,8 @@ static bool have_read_stdin;
 enum
 {
   OUTPUT_DELIMITER_OPTION = CHAR_MAX + 1,
-  COMPLEMENT_OPTION
+  COMPLEMENT_OPTION,
+  DECOMPRESS_OPTION
 };
 
 static struct option const longopts[] =
@@ -131,6 +135,7 @@ static struct option const longopts[] =
   {"only-delimited", no_argument, NULL, 's'},
   {"output-delimiter", required_argument, NULL, OUTPUT_DELIMITER_OPTION},
   {"complement", no_argument, NULL, COMPLEMENT_OPTION},
+  {"decompress", no_argument, NULL, DECOMPRESS_OPTION},
   {"zero-terminated", no_argument, NULL, 'z'},
   {GETOPT_HELP_OPTION_DECL},
   {GETOPT_VERSION_OPTION_DECL},
@@ -169,6 +174,8 @@ Print selected parts of lines from each FILE to standard output.\n\
       fputs (_("\
       --complement        complement the set of selected bytes, characters\n\
                             or fields\n\
+      --decompress        filter inputs recognized as compressed by their\n\
+                            magic bytes through the matching decompressor\n\
 "), stdout);
       fputs (_("\
   -s, --only-delimited    do not print lines not containing delimiters\n\
@@ -219,19 +226,21 @@ print_kth (uintmax_t k)
   return current_rp->lo <= k;
 }
 
-/* Return nonzero if K'th byte is the beginning of a range. */
-
-static inline bool
-is_range_start_index (uintmax_t k)
-{
-  return k == current_rp->lo;
-}
+/* Size of the block reads done by cut_bytes.  */
+enum { CUT_BUFFER_SIZE = 64 * 1024 };
 
-/* Read from stream STREAM, printing to standard output any selected bytes.  */
+/* Read from stream STREAM, printing to standard output any selected bytes.
+   Input is processed a block at a time: line boundaries are located
+   with memchr, and each selected range is written with one fwrite
+   straight from the block, so the tab of ranges is consulted only per
+   range rather than per byte.  A line may span several blocks, so the
+   ranges are intersected with the part of the line at hand.  */
 
 static void
 cut_bytes (FILE *stream)
 {
+  static char buf[CUT_BUFFER_SIZE];
+  size_t nread;
   uintmax_t byte_idx;	/* Number of bytes in the line so far. */
   /* Whether to begin printing delimiters between ranges for the current line.
      Set after we've begun printing data corresponding to the first range.  */
@@ -240,64 +249,93 @@ cut_bytes (FILE *stream)
   byte_idx = 0;
   print_delimiter = false;
   current_rp = frp;
-  while (true)
-    {
-      int c;		/* Each character from the file. */
 
-      c = getc (stream);
+  while ((nread = fread (buf, sizeof (char), sizeof buf, stream)) != 0)
+    {
+      char const *p = buf;
+      char const *lim = buf + nread;
 
-      if (c == line_delim)
-        {
-          putchar (c);
-          byte_idx = 0;
-          print_delimiter = false;
-          current_rp = frp;
-        }
-      else if (c == EOF)
-        {
-          if (byte_idx > 0)
-            putchar (line_delim);
-          break;
-        }
-      else
+      while (p < lim)
         {
-          next_item (&byte_idx);
-          if (print_kth (byte_idx))
+          char const *nl = memchr (p, line_delim, lim - p);
+          size_t n = (nl ? nl : lim) - p;
+
+          if (n)
             {
-              if (output_delimiter_specified)
+              /* Print the selected parts of line bytes
+                 BYTE_IDX + 1 .. BYTE_IDX + N, which are in P[0 .. N).  */
+              uintmax_t hi_idx = byte_idx + n;
+              while (current_rp->lo <= hi_idx)
                 {
-                  if (print_delimiter && is_range_start_index (byte_idx))
+                  uintmax_t lo = MAX (current_rp->lo, byte_idx + 1);
+                  uintmax_t hi = MIN (current_rp->hi, hi_idx);
+
+                  if (output_delimiter_specified)
                     {
-                      fwrite (output_delimiter_string, sizeof (char),
-                              output_delimiter_length, stdout);
+                      if (print_delimiter && lo == current_rp->lo)
+                        {
+                          fwrite (output_delimiter_string, sizeof (char),
+                                  output_delimiter_length, stdout);
+                        }
+                      print_delimiter = true;
                     }
-                  print_delimiter = true;
+
+                  fwrite (p + (lo - byte_idx - 1), sizeof (char),
+                          hi - lo + 1, stdout);
+
+                  if (current_rp->hi <= hi_idx)
+                    current_rp++;
+                  else
+                    break;
                 }
+              byte_idx = hi_idx;
+              p += n;
+            }
 
-              putchar (c);
+          if (nl)
+            {
+              putchar (line_delim);
+              p++;
+              byte_idx = 0;
+              print_delimiter = false;
+              current_rp = frp;
             }
         }
     }
+
+  if (byte_idx > 0)
+    putchar (line_delim);
 }
 
-/* Read from stream STREAM, printing to standard output any selected fields.  */
+/* Read from stream STREAM, printing to standard output any selected fields.
+   As in cut_bytes, input is processed a block at a time, with the
+   delimiters located by memchr and whole field spans written with one
+   fwrite each.  The only bytes ever copied aside are those of a first
+   field that must be buffered to learn whether its line is delimited.  */
 
 static void
 cut_fields (FILE *stream)
 {
-  int c;
+  static char buf[CUT_BUFFER_SIZE];
+  size_t nread;
   uintmax_t field_idx = 1;
   bool found_any_selected_field = false;
   bool buffer_first_field;
 
-  current_rp = frp;
+  /* True before any of the current line has been seen.  */
+  bool at_line_start = true;
 
-  c = getc (stream);
-  if (c == EOF)
-    return;
+  /* True while the first field accumulates in FIELD_1_BUFFER,
+     and the number of bytes accumulated there.  */
+  bool buffering_field_1 = false;
+  size_t field_1_len = 0;
 
-  ungetc (c, stream);
-  c = 0;
+  /* With -d matching the line delimiter, a delimiter at the end of a
+     block separates two fields only if more input follows; this is
+     set while that lookahead is unresolved.  */
+  bool pending_delim = false;
+
+  current_rp = frp;
 
   /* To support the semantics of the -s flag, we may have to buffer
      all of the first field to determine whether it is 'delimited.'
@@ -307,121 +345,161 @@ cut_fields (FILE *stream)
      That is because a non-delimited line has exactly one field.  */
   buffer_first_field = (suppress_non_delimited ^ !print_kth (1));
 
-  while (1)
+  while ((nread = fread (buf, sizeof (char), sizeof buf, stream)) != 0)
     {
-      if (field_idx == 1 && buffer_first_field)
-        {
-          ssize_t len;
-          size_t n_bytes;
+      char const *p = buf;
+      char const *lim = buf + nread;
 
-          len = getndelim2 (&field_1_buffer, &field_1_bufsize, 0,
-                            GETNLINE_NO_LIMIT, delim, line_delim, stream);
-          if (len < 0)
+      if (pending_delim)
+        {
+          /* More input arrived: the delimiter at the previous block
+             boundary separated two fields after all.  */
+          pending_delim = false;
+          if (buffering_field_1)
+            {
+              if (print_kth (1))
+                {
+                  fwrite (field_1_buffer, sizeof (char), field_1_len, stdout);
+                  found_any_selected_field = true;
+                }
+              buffering_field_1 = false;
+            }
+          next_item (&field_idx);
+          if (print_kth (field_idx))
             {
-              free (field_1_buffer);
-              field_1_buffer = NULL;
-              if (ferror (stream) || feof (stream))
-                break;
-              xalloc_die ();
+              if (found_any_selected_field)
+                fwrite (output_delimiter_string, sizeof (char),
+                        output_delimiter_length, stdout);
+              found_any_selected_field = true;
             }
+        }
 
-          n_bytes = len;
-          assert (n_bytes != 0);
-
-          c = 0;
+      while (p < lim)
+        {
+          char const *d = memchr (p, line_delim, lim - p);
+          if (delim != line_delim)
+            {
+              char const *d2 = memchr (p, delim, (d ? d : lim) - p);
+              if (d2)
+                d = d2;
+            }
 
-          /* If the first field extends to the end of line (it is not
-             delimited) and we are printing all non-delimited lines,
-             print this one.  */
-          if (to_uchar (field_1_buffer[n_bytes - 1]) != delim)
+          if (at_line_start)
             {
-              if (suppress_non_delimited)
-                {
-                  /* Empty.  */
-                }
-              else
+              at_line_start = false;
+              if (buffer_first_field)
                 {
-                  fwrite (field_1_buffer, sizeof (char), n_bytes, stdout);
-                  /* Make sure the output line is newline terminated.  */
-                  if (field_1_buffer[n_bytes - 1] != line_delim)
-                    putchar (line_delim);
-                  c = line_delim;
+                  buffering_field_1 = true;
+                  field_1_len = 0;
+                  if (! field_1_buffer)
+                    field_1_buffer = x2realloc (NULL, &field_1_bufsize);
                 }
-              continue;
+              else if (print_kth (field_idx))
+                found_any_selected_field = true;
             }
-          if (print_kth (1))
-            {
-              /* Print the field, but not the trailing delimiter.  */
-              fwrite (field_1_buffer, sizeof (char), n_bytes - 1, stdout);
 
-              /* With -d$'\n' don't treat the last '\n' as a delimiter.  */
-              if (delim == line_delim)
+          size_t n = (d ? d : lim) - p;
+          if (n)
+            {
+              if (buffering_field_1)
                 {
-                  int last_c = getc (stream);
-                  if (last_c != EOF)
-                    {
-                      ungetc (last_c, stream);
-                      found_any_selected_field = true;
-                    }
+                  while (field_1_bufsize < field_1_len + n)
+                    field_1_buffer = x2realloc (field_1_buffer,
+                                                &field_1_bufsize);
+                  memcpy (field_1_buffer + field_1_len, p, n);
+                  field_1_len += n;
                 }
-              else
-                found_any_selected_field = true;
+              else if (print_kth (field_idx))
+                fwrite (p, sizeof (char), n, stdout);
+              p += n;
             }
-          next_item (&field_idx);
-        }
 
-      int prev_c = c;
+          if (!d)
+            break;
+          p++;
 
-      if (print_kth (field_idx))
-        {
-          if (found_any_selected_field)
+          if (delim == line_delim && p == lim)
             {
-              fwrite (output_delimiter_string, sizeof (char),
-                      output_delimiter_length, stdout);
+              /* With -d$'\n' don't treat the input's last '\n' as a
+                 delimiter; look ahead before deciding.  */
+              pending_delim = true;
+              break;
             }
-          found_any_selected_field = true;
 
-          while ((c = getc (stream)) != delim && c != line_delim && c != EOF)
+          if (to_uchar (*d) == delim)
             {
-              putchar (c);
-              prev_c = c;
+              if (buffering_field_1)
+                {
+                  /* The first field is delimited; its fate is known.  */
+                  if (print_kth (1))
+                    {
+                      fwrite (field_1_buffer, sizeof (char), field_1_len,
+                              stdout);
+                      found_any_selected_field = true;
+                    }
+                  buffering_field_1 = false;
+                }
+              next_item (&field_idx);
+              if (print_kth (field_idx))
+                {
+                  if (found_any_selected_field)
+                    fwrite (output_delimiter_string, sizeof (char),
+                            output_delimiter_length, stdout);
+                  found_any_selected_field = true;
+                }
             }
-        }
-      else
-        {
-          while ((c = getc (stream)) != delim && c != line_delim && c != EOF)
+          else
             {
-              prev_c = c;
-            }
-        }
+              /* End of line.  */
+              if (buffering_field_1)
+                {
+                  /* The line has no delimiter; print it in full
+                     unless such lines are suppressed.  */
+                  if (! suppress_non_delimited)
+                    {
+                      fwrite (field_1_buffer, sizeof (char), field_1_len,
+                              stdout);
+                      putchar (line_delim);
+                    }
+                }
+              else if (found_any_selected_field
+                       || !(suppress_non_delimited && field_idx == 1))
+                putchar (line_delim);
 
-      /* With -d$'\n' don't treat the last '\n' as a delimiter.  */
-      if (delim == line_delim && c == delim)
-        {
-          int last_c = getc (stream);
-          if (last_c != EOF)
-            ungetc (last_c, stream);
-          else
-            c = last_c;
+              field_idx = 1;
+              current_rp = frp;
+              found_any_selected_field = false;
+              buffering_field_1 = false;
+              at_line_start = true;
+            }
         }
+    }
 
-      if (c == delim)
-        next_item (&field_idx);
-      else if (c == line_delim || c == EOF)
+  if (pending_delim || ! at_line_start)
+    {
+      /* The input ended mid line.  */
+      if (buffering_field_1)
         {
-          if (found_any_selected_field
-              || !(suppress_non_delimited && field_idx == 1))
+          if (pending_delim)
             {
-              if (c == line_delim || prev_c != line_delim
-                  || delim == line_delim)
+              /* The first field was delimited, but the delimiter also
+                 ended the input, so nothing may follow the field.  */
+              if (print_kth (1))
+                fwrite (field_1_buffer, sizeof (char), field_1_len, stdout);
+              next_item (&field_idx);
+              if (found_any_selected_field
+                  || !(suppress_non_delimited && field_idx == 1))
                 putchar (line_delim);
             }
-          if (c == EOF)
-            break;
-          field_idx = 1;
-          current_rp = frp;
-          found_any_selected_field = false;
+          else if (! suppress_non_delimited)
+            {
+              fwrite (field_1_buffer, sizeof (char), field_1_len, stdout);
+              putchar (line_delim);
+            }
         }
+      else if (found_any_selected_field
+               || !(suppress_non_delimited && field_idx == 1))
+        putchar (line_delim);
     }
 }
 
@@ -457,6 +535,9 @@ cut_file (char const *file)
         }
     }
 
+  if (decompress_input)
+    stream = dec_input_stream (stream, file, EXIT_FAILURE);
+
   fadvise (stream, FADVISE_SEQUENTIAL);
 
   cut_stream (stream);
@@ -466,13 +547,19 @@ cut_file (char const *file)
       error (0, errno, "%s", quotef (file));
       return false;
     }
-  if (STREQ (file, "-"))
+  int fd = fileno (stream);
+  if (stream == stdin)
     clearerr (stream);		/* Also clear EOF. */
   else if (fclose (stream) == EOF)
     {
       error (0, errno, "%s", quotef (file));
       return false;
     }
+  if (! dec_input_reap (fd))
+    {
+      error (0, 0, _("%s: decompression failed"), quotef (file));
+      return false;
+    }
   return true;
 }
 
@@ -550,6 +637,10 @@ main (int argc, char **argv)
           line_delim = '\0';
           break;
 
+        case DECOMPRESS_OPTION:
+          decompress_input = true;
+          break;
+
         case COMPLEMENT_OPTION:
           complement = true;
           break;
@@ -23,11 +23,16 @@
 #include <sys/types.h>
 #include <signal.h>
 
+#if HAVE_AIO_WRITE
+# include <aio.h>
+#endif
+
 #include "system.h"
 #include "close-stream.h"
 #include "die.h"
 #include "error.h"
 #include "fd-reopen.h"
+#include "full-write.h"
 #include "gethrxtime.h"
 #include "human.h"
 #include "ioblksize.h"
@@ -192,6 +197,20 @@ static int output_flags = 0;
 /* Status flags for what is printed to stderr.  */
 static int status_level = STATUS_DEFAULT;
 
+/* File descriptor given with telemetry=FD, or -1.  */
+static int telemetry_fd = -1;
+
+/* Stream wrapping TELEMETRY_FD, or NULL when telemetry is off.  */
+static FILE *telemetry_stream;
+
+/* Time between periodic reports, for status=progress and telemetry=FD.  */
+static xtime_t report_interval = XTIME_PRECISION;
+
+/* Cumulative time spent blocked in reads and in writes, accumulated
+   only while telemetry is enabled.  */
+static xtime_t read_time;
+static xtime_t write_time;
+
 /* If nonzero, filter characters through the translation table.  */
 static bool translation_needed = false;
 
@@ -216,6 +235,9 @@ static xtime_t start_time;
 /* Next time to report periodic progress.  */
 static xtime_t next_time;
 
+/* Next time to emit a periodic telemetry record.  */
+static xtime_t next_tele_time;
+
 /* If positive, the number of bytes output in the current progress line.  */
 static int progress_len;
 
@@ -231,6 +253,17 @@ static int input_seek_errno;
 static uintmax_t input_offset;
 static bool input_offset_overflow;
 
+/* True if holes in a regular input file should be skipped with
+   lseek instead of being read (see probe_input_extent).  */
+static bool input_hole_scan;
+
+/* With INPUT_HOLE_SCAN, the end of the data region containing the
+   current input offset, and the start of the data that follows the
+   current hole.  Reads below INPUT_DATA_END need no probing, and
+   zeros below INPUT_DATA_NEXT are synthesized without reading.  */
+static off_t input_data_end;
+static off_t input_data_next;
+
 /* True if a partial read should be diagnosed.  */
 static bool warn_partial_read;
 
@@ -273,9 +306,14 @@ static bool i_nocache, o_nocache;
 /* Whether to instruct the kernel to discard the complete file.  */
 static bool i_nocache_eof, o_nocache_eof;
 
+/* Whether to overlap writes of the output with subsequent reads.  */
+static bool o_async;
+
 /* Function used for read (to handle iflag=fullblock parameter).  */
 static ssize_t (*iread_fnc) (int fd, char *buf, size_t size);
 
+static void emit_telemetry (char const *event, xtime_t now);
+
 /* A longest symbol in the struct symbol_values tables below.  */
 #define LONGEST_SYMBOL "count_bytes"
 
@@ -342,7 +380,10 @@ enum
     O_SKIP_BYTES = FFS_MASK (v4),
     v5 = v4 ^ O_SKIP_BYTES,
 
-    O_SEEK_BYTES = FFS_MASK (v5)
+    O_SEEK_BYTES = FFS_MASK (v5),
+    v6 = v5 ^ O_SEEK_BYTES,
+
+    O_ASYNC_WRITES = FFS_MASK (v6)
   };
 
 /* Ensure that we got something.  */
@@ -351,6 +392,7 @@ verify (O_NOCACHE != 0);
 verify (O_COUNT_BYTES != 0);
 verify (O_SKIP_BYTES != 0);
 verify (O_SEEK_BYTES != 0);
+verify (O_ASYNC_WRITES != 0);
 
 #define MULTIPLE_BITS_SET(i) (((i) & ((i) - 1)) != 0)
 
@@ -360,11 +402,15 @@ verify ( ! MULTIPLE_BITS_SET (O_NOCACHE));
 verify ( ! MULTIPLE_BITS_SET (O_COUNT_BYTES));
 verify ( ! MULTIPLE_BITS_SET (O_SKIP_BYTES));
 verify ( ! MULTIPLE_BITS_SET (O_SEEK_BYTES));
+verify ( ! MULTIPLE_BITS_SET (O_ASYNC_WRITES));
 
 /* Flags, for iflag="..." and oflag="...".  */
 static struct symbol_value const flags[] =
 {
   {"append",	  O_APPEND},
+#if HAVE_AIO_WRITE
+  {"async",	  O_ASYNC_WRITES}, /* Keep output writes in flight.  */
+#endif
   {"binary",	  O_BINARY},
   {"cio",	  O_CIO},
   {"direct",	  O_DIRECT},
@@ -568,7 +614,8 @@ Usage: %s [OPERAND]...\n\
 Copy a file, converting and formatting according to the operands.\n\
 \n\
   bs=BYTES        read and write up to BYTES bytes at a time (default: 512);\n\
-                  overrides ibs and obs\n\
+                  overrides ibs and obs; 'auto' selects a size suited\n\
+                  to the input and output files\n\
   cbs=BYTES       convert BYTES bytes at a time\n\
   conv=CONVS      convert the file as per the comma separated symbol list\n\
   count=N         copy only N input blocks\n\
@@ -577,6 +624,7 @@ Copy a file, converting and formatting according to the operands.\n\
       fputs (_("\
   if=FILE         read from FILE instead of stdin\n\
   iflag=FLAGS     read as per the comma separated symbol list\n\
+  interval=SECONDS  seconds between periodic reports (default: 1)\n\
   obs=BYTES       write BYTES bytes at a time (default: 512)\n\
   of=FILE         write to FILE instead of stdout\n\
   oflag=FLAGS     write as per the comma separated symbol list\n\
@@ -586,6 +634,8 @@ Copy a file, converting and formatting according to the operands.\n\
                   'none' suppresses everything but error messages,\n\
                   'noxfer' suppresses the final transfer statistics,\n\
                   'progress' shows periodic transfer statistics\n\
+  telemetry=FD    write machine-readable progress and summary records,\n\
+                  one JSON object per line, to file descriptor FD\n\
 "), stdout);
       fputs (_("\
 \n\
@@ -624,6 +674,11 @@ Each FLAG symbol may be:\n\
 \n\
   append    append mode (makes sense only for output; conv=notrunc suggested)\n\
 "), stdout);
+#if HAVE_AIO_WRITE
+      fputs (_("\
+  async     overlap output writes with later reads (oflag only)\n\
+"), stdout);
+#endif
       if (O_CIO)
         fputs (_("  cio       use concurrent I/O for data\n"), stdout);
       if (O_DIRECT)
@@ -1027,6 +1082,12 @@ finish_up (void)
   process_signals ();
   cleanup ();
   print_stats ();
+  if (telemetry_stream)
+    {
+      emit_telemetry ("summary", gethrxtime ());
+      fclose (telemetry_stream);
+      telemetry_stream = NULL;
+    }
 }
 
 static void ATTRIBUTE_NORETURN
@@ -1132,6 +1193,66 @@ invalidate_cache (int fd, off_t len)
   return adv_ret != -1 ? true : false;
 }
 
+#ifdef SEEK_HOLE
+/* Probe the data/hole layout of the regular input file open on FD
+   around the current input offset, updating INPUT_DATA_END and
+   INPUT_DATA_NEXT.  Disable hole skipping if the probe is not
+   supported.  Return false (setting errno) if the file offset was
+   left astray and reading cannot continue.  */
+
+static bool
+probe_input_extent (int fd)
+{
+  off_t data_pos = lseek (fd, input_offset, SEEK_DATA);
+
+  if (data_pos < 0)
+    {
+      if (errno != ENXIO)
+        {
+          /* A failed lseek leaves the file offset alone.  */
+          input_hole_scan = false;
+          return true;
+        }
+
+      /* No data follows: the rest of the file is one big hole.
+         SEEK_END leaves the offset where reads resume once the
+         zeros have been synthesized.  */
+      off_t file_end = lseek (fd, 0, SEEK_END);
+      if (0 <= file_end && input_offset < (uintmax_t) file_end)
+        input_data_next = file_end;
+      else
+        {
+          input_hole_scan = false;
+          if (lseek (fd, input_offset, SEEK_SET) < 0)
+            return false;
+        }
+    }
+  else if (input_offset < (uintmax_t) data_pos)
+    {
+      /* In a hole; the file offset is now at the data that follows
+         it, where reads will resume once the zeros in between are
+         synthesized.  */
+      input_data_next = data_pos;
+    }
+  else
+    {
+      /* In data; find where it ends, and restore the file offset.  */
+      off_t hole_pos = lseek (fd, input_offset, SEEK_HOLE);
+      if (hole_pos < 0)
+        input_hole_scan = false;
+      else
+        input_data_end = hole_pos;
+      if (lseek (fd, input_offset, SEEK_SET) < 0)
+        {
+          input_hole_scan = false;
+          return false;
+        }
+    }
+
+  return true;
+}
+#endif
+
 /* Read from FD into the buffer BUF of size SIZE, processing any
    signals that arrive before bytes are read.  Return the number of
    bytes read if successful, -1 (setting errno) on failure.  */
@@ -1141,7 +1262,43 @@ iread (int fd, char *buf, size_t size)
 {
   ssize_t nread;
   static ssize_t prev_nread;
+  size_t zeros = 0;
 
+#ifdef SEEK_HOLE
+  /* When the input is a regular file, skip over any hole at the
+     current offset with lseek, synthesizing the zeros that read
+     would have returned without touching the disk.  */
+  if (input_hole_scan && ! input_offset_overflow)
+    {
+      if ((uintmax_t) input_data_end <= input_offset
+          && (uintmax_t) input_data_next <= input_offset
+          && ! probe_input_extent (fd))
+        return -1;
+
+      if (input_hole_scan && input_offset < (uintmax_t) input_data_next)
+        {
+          process_signals ();
+          uintmax_t gap = input_data_next - input_offset;
+          if (size <= gap)
+            {
+              memset (buf, 0, size);
+              prev_nread = size;
+              return size;
+            }
+
+          /* The hole ends inside this block: zero its start, and
+             read the rest from the data that follows, so that
+             callers see the block a plain read would have
+             returned.  */
+          zeros = gap;
+          memset (buf, 0, zeros);
+          buf += zeros;
+          size -= zeros;
+        }
+    }
+#endif
+
+  xtime_t t0 = telemetry_stream ? gethrxtime () : 0;
   do
     {
       process_signals ();
@@ -1157,6 +1314,8 @@ iread (int fd, char *buf, size_t size)
         }
     }
   while (nread < 0 && errno == EINTR);
+  if (telemetry_stream)
+    read_time += gethrxtime () - t0;
 
   /* Short read may be due to received signal.  */
   if (0 < nread && nread < size)
@@ -1178,6 +1337,16 @@ iread (int fd, char *buf, size_t size)
         }
     }
 
+  if (nread < 0)
+    {
+      /* Report the error on the next read, after the zeros already
+         synthesized from the hole.  */
+      if (zeros)
+        nread = zeros;
+    }
+  else
+    nread += zeros;
+
   prev_nread = nread;
   return nread;
 }
@@ -1203,13 +1372,13 @@ iread_fullblock (int fd, char *buf, size_t size)
   return nread;
 }
 
-/* Write to FD the buffer BUF of size SIZE, processing any signals
-   that arrive.  Return the number of bytes written, setting errno if
-   this is less than SIZE.  Keep trying if there are partial
-   writes.  */
+/* Write to FD the buffer BUF of size SIZE synchronously, processing
+   any signals that arrive.  Return the number of bytes written,
+   setting errno if this is less than SIZE.  Keep trying if there are
+   partial writes.  */
 
 static size_t
-iwrite (int fd, char const *buf, size_t size)
+iwrite_sync (int fd, char const *buf, size_t size)
 {
   size_t total_written = 0;
 
@@ -1284,6 +1453,242 @@ iwrite (int fd, char const *buf, size_t size)
   return total_written;
 }
 
+#if HAVE_AIO_WRITE
+
+/* Number of output buffers the oflag=async engine keeps in flight.  */
+enum { ASYNC_N_BUFS = 4 };
+
+/* State for the oflag=async write engine.  Asynchronous writes do
+   not advance the file offset, so the offset of the next write is
+   tracked explicitly in ASYNC_OFFSET.  */
+static struct aiocb async_cb[ASYNC_N_BUFS];
+static char *async_buf[ASYNC_N_BUFS];	/* Page-aligned bounce buffers.  */
+static char *async_buf_alloc[ASYNC_N_BUFS];
+static bool async_in_flight[ASYNC_N_BUFS];
+static int async_slot;		/* Next buffer to (re)use.  */
+static off_t async_offset;	/* Output offset of the next write.  */
+static bool async_ready;	/* Whether the engine is set up.  */
+
+/* Wait for the write that last used buffer SLOT to complete,
+   finishing any partial write synchronously.  Return true on
+   success; set errno and return false upon error.  */
+
+static bool
+async_await (int slot)
+{
+  struct aiocb *cb = &async_cb[slot];
+
+  if (! async_in_flight[slot])
+    return true;
+  async_in_flight[slot] = false;
+
+  while (aio_error (cb) == EINPROGRESS)
+    {
+      struct aiocb const *list[1] = { cb };
+      process_signals ();
+      aio_suspend (list, 1, NULL);
+    }
+
+  int err = aio_error (cb);
+  ssize_t n_written = aio_return (cb);
+  if (err)
+    {
+      errno = err;
+      return false;
+    }
+
+  /* A short write is possible; finish the block in the foreground.  */
+  if (n_written < (ssize_t) cb->aio_nbytes)
+    {
+      char const *rest = (char const *) cb->aio_buf + n_written;
+      size_t n_rest = cb->aio_nbytes - n_written;
+      if (lseek (cb->aio_fildes, cb->aio_offset + n_written, SEEK_SET) < 0
+          || full_write (cb->aio_fildes, rest, n_rest) != n_rest)
+        return false;
+    }
+
+  return true;
+}
+
+/* Wait for all outstanding writes to FD, and restore its file offset
+   so that synchronous I/O can resume where the writes left off.
+   Return true on success; set errno and return false upon error.  */
+
+static bool
+async_drain (int fd)
+{
+  bool ok = true;
+
+  if (! async_ready)
+    return true;
+
+  for (int i = 0; i < ASYNC_N_BUFS; i++)
+    ok &= async_await ((async_slot + i) % ASYNC_N_BUFS);
+
+  if (ok && lseek (fd, async_offset, SEEK_SET) < 0)
+    return false;
+
+  return ok;
+}
+
+/* Set up the oflag=async engine for FD.  Return true if asynchronous
+   writes can be used; return false to leave writes synchronous.  */
+
+static bool
+async_start (int fd)
+{
+  /* The output must be seekable, to track write offsets explicitly.  */
+  async_offset = lseek (fd, 0, SEEK_CUR);
+  if (async_offset < 0)
+    return false;
+
+  size_t buf_size = MAX (input_blocksize, output_blocksize);
+  for (int i = 0; i < ASYNC_N_BUFS; i++)
+    {
+      async_buf_alloc[i] = malloc (buf_size + page_size - 1);
+      if (! async_buf_alloc[i])
+        {
+          while (i--)
+            free (async_buf_alloc[i]);
+          return false;
+        }
+      async_buf[i] = ptr_align (async_buf_alloc[i], page_size);
+    }
+
+  return true;
+}
+
+/* An asynchronous counterpart to iwrite_sync, for oflag=async: copy
+   BUF into an idle bounce buffer and start writing it to FD at the
+   next output offset, waiting only for the write that last used that
+   buffer.  Sparse blocks and partial blocks are handed to the
+   synchronous path after a drain, so their special cases (seeking
+   over NUL blocks, dropping O_DIRECT for the final write) apply as
+   usual.  Return the number of bytes written, setting errno if this
+   is less than SIZE.  */
+
+static size_t
+iwrite_async (int fd, char const *buf, size_t size)
+{
+  if (! async_ready)
+    {
+      if (! async_start (fd))
+        {
+          o_async = false;	/* Write synchronously from now on.  */
+          return iwrite_sync (fd, buf, size);
+        }
+      async_ready = true;
+    }
+
+  if (size < output_blocksize
+      || ((conversions_mask & C_SPARSE) && is_nul (buf, size)))
+    {
+      if (! async_drain (fd))
+        return 0;
+      size_t total_written = iwrite_sync (fd, buf, size);
+      async_offset += total_written;
+      return total_written;
+    }
+
+  /* The write that last used this buffer must land before reuse.  */
+  if (! async_await (async_slot))
+    return 0;
+
+  struct aiocb *cb = &async_cb[async_slot];
+  memcpy (async_buf[async_slot], buf, size);
+  cb->aio_fildes = fd;
+  cb->aio_buf = async_buf[async_slot];
+  cb->aio_nbytes = size;
+  cb->aio_offset = async_offset;
+
+  process_signals ();
+  if (aio_write (cb) != 0)
+    {
+      /* Queue full or AIO unsupported; write this block in the
+         foreground and carry on.  */
+      if (lseek (fd, async_offset, SEEK_SET) < 0)
+        return 0;
+      size_t total_written = iwrite_sync (fd, buf, size);
+      async_offset += total_written;
+      return total_written;
+    }
+
+  async_in_flight[async_slot] = true;
+  async_slot = (async_slot + 1) % ASYNC_N_BUFS;
+  async_offset += size;
+  final_op_was_seek = false;
+
+  if (o_nocache)
+    invalidate_cache (fd, size);
+
+  return size;
+}
+
+/* Return the number of asynchronous writes currently in flight.  */
+
+static int
+async_writes_pending (void)
+{
+  int n = 0;
+  for (int i = 0; i < ASYNC_N_BUFS; i++)
+    n += async_in_flight[i];
+  return n;
+}
+
+#endif
+
+/* Write to FD the buffer BUF of size SIZE, processing any signals
+   that arrive.  Return the number of bytes written, setting errno if
+   this is less than SIZE.  Keep trying if there are partial
+   writes.  */
+
+static size_t
+iwrite (int fd, char const *buf, size_t size)
+{
+  xtime_t t0 = telemetry_stream ? gethrxtime () : 0;
+#if HAVE_AIO_WRITE
+  size_t total_written = (o_async
+                          ? iwrite_async (fd, buf, size)
+                          : iwrite_sync (fd, buf, size));
+#else
+  size_t total_written = iwrite_sync (fd, buf, size);
+#endif
+  if (telemetry_stream)
+    write_time += gethrxtime () - t0;
+  return total_written;
+}
+
+/* Emit one line-delimited JSON telemetry record of type EVENT,
+   reflecting the transfer state at time NOW.  */
+
+static void
+emit_telemetry (char const *event, xtime_t now)
+{
+  double elapsed = (now - start_time) / (double) XTIME_PRECISION;
+  double rate = elapsed <= 0 ? 0 : w_bytes / elapsed;
+
+  fprintf (telemetry_stream,
+           "{\"event\":\"%s\",\"bytes\":%"PRIuMAX",\"elapsed\":%.6f,"
+           "\"rate\":%.0f"
+           ",\"records_in\":[%"PRIuMAX",%"PRIuMAX"]"
+           ",\"records_out\":[%"PRIuMAX",%"PRIuMAX"]"
+           ",\"truncated\":%"PRIuMAX,
+           event, w_bytes, elapsed, rate,
+           r_full, r_partial, w_full, w_partial, r_truncate);
+#if HAVE_AIO_WRITE
+  if (o_async)
+    fprintf (telemetry_stream, ",\"writes_in_flight\":%d",
+             async_writes_pending ());
+#endif
+  if (STREQ (event, "summary"))
+    fprintf (telemetry_stream,
+             ",\"read_seconds\":%.6f,\"write_seconds\":%.6f",
+             read_time / (double) XTIME_PRECISION,
+             write_time / (double) XTIME_PRECISION);
+  fputs ("}\n", telemetry_stream);
+  fflush (telemetry_stream);
+}
+
 /* Write, then empty, the output buffer 'obuf'. */
 
 static void
@@ -1490,9 +1895,11 @@ static void
 scanargs (int argc, char *const *argv)
 {
   size_t blocksize = 0;
+  bool blocksize_auto = false;
   uintmax_t count = (uintmax_t) -1;
   uintmax_t skip = 0;
   uintmax_t seek = 0;
+  uintmax_t interval = 1;
 
   for (int i = optind; i < argc; i++)
     {
@@ -1523,6 +1930,11 @@ scanargs (int argc, char *const *argv)
       else if (operand_is (name, "status"))
         status_level = parse_symbols (val, statuses, true,
                                       N_("invalid status level"));
+      else if (operand_is (name, "bs") && STREQ (val, "auto"))
+        {
+          blocksize_auto = true;
+          blocksize = 0;
+        }
       else
         {
           strtol_error invalid = LONGINT_OK;
@@ -1547,6 +1959,7 @@ scanargs (int argc, char *const *argv)
               n_min = 1;
               n_max = MAX_BLOCKSIZE (INPUT_BLOCK_SLOP);
               blocksize = n;
+              blocksize_auto = false;
             }
           else if (operand_is (name, "cbs"))
             {
@@ -1560,6 +1973,17 @@ scanargs (int argc, char *const *argv)
             seek = n;
           else if (operand_is (name, "count"))
             count = n;
+          else if (operand_is (name, "telemetry"))
+            {
+              n_max = INT_MAX;
+              telemetry_fd = n;
+            }
+          else if (operand_is (name, "interval"))
+            {
+              n_min = 1;
+              n_max = TYPE_MAXIMUM (xtime_t) / XTIME_PRECISION;
+              interval = n;
+            }
           else
             {
               error (0, 0, _("unrecognized operand %s"),
@@ -1578,6 +2002,29 @@ scanargs (int argc, char *const *argv)
         }
     }
 
+  if (blocksize_auto)
+    {
+      /* With bs=auto, choose a block size suited to the input and
+         output files, as io_blksize infers it: the preferred I/O
+         block size of each file, but at least IO_BUFSIZE.  Stat by
+         name, as the files are not open yet; a file that cannot be
+         examined (e.g. an output file yet to be created) just gets
+         the IO_BUFSIZE floor.  */
+      struct stat stat_buf;
+      size_t in_blksize = IO_BUFSIZE;
+      size_t out_blksize = IO_BUFSIZE;
+      if (input_file
+          ? stat (input_file, &stat_buf) == 0
+          : ifstat (STDIN_FILENO, &stat_buf) == 0)
+        in_blksize = io_blksize (stat_buf);
+      if (output_file
+          ? stat (output_file, &stat_buf) == 0
+          : ifstat (STDOUT_FILENO, &stat_buf) == 0)
+        out_blksize = io_blksize (stat_buf);
+      blocksize = MIN (MAX (in_blksize, out_blksize),
+                       MAX_BLOCKSIZE (INPUT_BLOCK_SLOP));
+    }
+
   if (blocksize)
     input_blocksize = output_blocksize = blocksize;
   else
@@ -1617,6 +2064,12 @@ scanargs (int argc, char *const *argv)
       usage (EXIT_FAILURE);
     }
 
+  if (input_flags & O_ASYNC_WRITES)
+    {
+      error (0, 0, "%s: %s", _("invalid input flag"), quote ("async"));
+      usage (EXIT_FAILURE);
+    }
+
   if (input_flags & O_SKIP_BYTES && skip != 0)
     {
       skip_records = skip / input_blocksize;
@@ -1680,6 +2133,22 @@ scanargs (int argc, char *const *argv)
       o_nocache_eof = (max_records == 0 && max_bytes == 0);
       output_flags &= ~O_NOCACHE;
     }
+
+  if (output_flags & O_ASYNC_WRITES)
+    {
+      o_async = true;
+      output_flags &= ~O_ASYNC_WRITES;
+    }
+
+  report_interval = interval * XTIME_PRECISION;
+
+  if (0 <= telemetry_fd)
+    {
+      telemetry_stream = fdopen (telemetry_fd, "w");
+      if (! telemetry_stream)
+        die (EXIT_FAILURE, errno,
+             _("cannot open telemetry file descriptor %d"), telemetry_fd);
+    }
 }
 
 /* Fix up translation table. */
@@ -2181,13 +2650,18 @@ dd_copy (void)
 
   while (1)
     {
-      if (status_level == STATUS_PROGRESS)
+      if (status_level == STATUS_PROGRESS || telemetry_stream)
         {
           xtime_t progress_time = gethrxtime ();
-          if (next_time <= progress_time)
+          if (status_level == STATUS_PROGRESS && next_time <= progress_time)
             {
               print_xfer_stats (progress_time);
-              next_time += XTIME_PRECISION;
+              next_time += report_interval;
+            }
+          if (telemetry_stream && next_tele_time <= progress_time)
+            {
+              emit_telemetry ("progress", progress_time);
+              next_tele_time += report_interval;
             }
         }
 
@@ -2352,6 +2826,16 @@ dd_copy (void)
         }
     }
 
+#if HAVE_AIO_WRITE
+  /* Let any writes still in flight complete, and restore the file
+     offset for the code below.  */
+  if (o_async && ! async_drain (STDOUT_FILENO))
+    {
+      error (0, errno, _("error writing %s"), quoteaf (output_file));
+      return EXIT_FAILURE;
+    }
+#endif
+
   /* If the last write was converted to a seek, then for a regular file
      or shared memory object, ftruncate to extend the size.  */
   if (final_op_was_seek)
@@ -2448,6 +2932,16 @@ main (int argc, char **argv)
   input_offset = MAX (0, offset);
   input_seek_errno = errno;
 
+#ifdef SEEK_HOLE
+  /* For regular files, holes can be skipped rather than read.  */
+  if (input_seekable)
+    {
+      struct stat in_stat;
+      input_hole_scan = (ifstat (STDIN_FILENO, &in_stat) == 0
+                         && S_ISREG (in_stat.st_mode));
+    }
+#endif
+
   if (output_file == NULL)
     {
       output_file = _("standard output");
@@ -2508,7 +3002,7 @@ main (int argc, char **argv)
     }
 
   start_time = gethrxtime ();
-  next_time = start_time + XTIME_PRECISION;
+  next_time = next_tele_time = start_time + report_interval;
 
   exit_status = dd_copy ();
 
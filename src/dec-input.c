@@ -0,0 +1,195 @@
+/* dec-input.c -- transparent decompression of compressed input files
+
+   Copyright (C) 2021 Free Software Foundation, Inc.
+
+   This program is free software: you can redistribute it and/or modify
+   it under the terms of the GNU General Public License as published by
+   the Free Software Foundation, either version 3 of the License, or
+   (at your option) any later version.
+
+   This program is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU General Public License for more details.
+
+   You should have received a copy of the GNU General Public License
+   along with this program.  If not, see <https://www.gnu.org/licenses/>.  */
+
+/* With --decompress, an input that starts with the magic bytes of a
+   known compression format is filtered through that format's
+   decompressor, so callers read plain bytes from the returned
+   descriptor or stream.  Only seekable regular files are probed: the
+   magic bytes are read and the file rewound before the decompressor
+   child inherits it, so the child sees the whole file directly and
+   no bytes are copied through the invoking process.  */
+
+#include <config.h>
+#include <pthread.h>
+#include <stdio.h>
+#include <sys/types.h>
+#include <sys/stat.h>
+#include <sys/wait.h>
+
+#include "system.h"
+#include "die.h"
+#include "error.h"
+#include "quote.h"
+#include "dec-input.h"
+
+/* A compression format known by its leading magic bytes, and the
+   program run to decompress it.  Each program must accept -dc.  */
+struct dec_format
+{
+  char magic[6];
+  int magic_len;
+  char const *program;
+};
+
+static struct dec_format const dec_formats[] =
+{
+  { "\x1f\x8b",             2, "gzip"  },
+  { "\x28\xb5\x2f\xfd",     4, "zstd"  },
+  { "\xfd""7zXZ",           6, "xz"    },
+  { "BZh",                  3, "bzip2" },
+  { "\x04\x22\x4d\x18",     4, "lz4"   },
+};
+
+/* Decompressor children not yet reaped, keyed by the read end of
+   their output pipe.  The list stays short: one entry per
+   concurrently open compressed input.  */
+struct dec_child
+{
+  int fd;
+  pid_t pid;
+  struct dec_child *next;
+};
+static struct dec_child *dec_children;
+
+/* Serializes access to DEC_CHILDREN; wc counts files from several
+   threads at once.  */
+static pthread_mutex_t dec_children_lock = PTHREAD_MUTEX_INITIALIZER;
+
+/* If FD, named FILE, is a seekable regular file beginning with the
+   magic bytes of a known compression format, start that format's
+   decompressor reading it and return a descriptor yielding the
+   decompressed bytes; the caller should close FD and read the
+   returned descriptor instead.  Otherwise return FD, rewound to
+   where it was.  Die with status FAILURE_STATUS if the decompressor
+   cannot be started.  */
+
+extern int
+dec_input_fd (int fd, char const *file, int failure_status)
+{
+  struct stat st;
+  if (fstat (fd, &st) != 0 || ! S_ISREG (st.st_mode))
+    return fd;
+
+  off_t pos = lseek (fd, 0, SEEK_CUR);
+  if (pos < 0)
+    return fd;
+
+  char magic[sizeof dec_formats[0].magic];
+  ssize_t n = read (fd, magic, sizeof magic);
+  if (lseek (fd, pos, SEEK_SET) < 0)
+    die (failure_status, errno, "%s", quotef (file));
+  if (n <= 0)
+    return fd;
+
+  struct dec_format const *fmt = NULL;
+  for (size_t i = 0; i < ARRAY_CARDINALITY (dec_formats); i++)
+    if (dec_formats[i].magic_len <= n
+        && memcmp (magic, dec_formats[i].magic, dec_formats[i].magic_len) == 0)
+      {
+        fmt = &dec_formats[i];
+        break;
+      }
+  if (! fmt)
+    return fd;
+
+  int pipefds[2];
+  if (pipe (pipefds) != 0)
+    die (failure_status, errno, _("cannot create pipe"));
+
+  pid_t pid = fork ();
+  if (pid < 0)
+    die (failure_status, errno, _("fork system call failed"));
+
+  if (pid == 0)
+    {
+      close (pipefds[0]);
+      if (dup2 (fd, STDIN_FILENO) < 0
+          || dup2 (pipefds[1], STDOUT_FILENO) < 0)
+        _exit (EXIT_CANCELED);
+      if (STDIN_FILENO < fd)
+        close (fd);
+      if (STDOUT_FILENO < pipefds[1])
+        close (pipefds[1]);
+      execlp (fmt->program, fmt->program, "-dc", (char *) NULL);
+      _exit (EXIT_CANCELED);
+    }
+
+  close (pipefds[1]);
+
+  struct dec_child *child = xmalloc (sizeof *child);
+  child->fd = pipefds[0];
+  child->pid = pid;
+  pthread_mutex_lock (&dec_children_lock);
+  child->next = dec_children;
+  dec_children = child;
+  pthread_mutex_unlock (&dec_children_lock);
+
+  return pipefds[0];
+}
+
+/* Stream interface to dec_input_fd.  If FP, named FILE, starts a
+   known compression format, return a stream of its decompressed
+   bytes and close FP (unless it is stdin); otherwise return FP.  */
+
+extern FILE *
+dec_input_stream (FILE *fp, char const *file, int failure_status)
+{
+  int fd = fileno (fp);
+  int dfd = dec_input_fd (fd, file, failure_status);
+  if (dfd == fd)
+    return fp;
+
+  if (fd != STDIN_FILENO)
+    fclose (fp);
+
+  FILE *dfp = fdopen (dfd, "r");
+  if (! dfp)
+    die (failure_status, errno, "%s", quotef (file));
+  return dfp;
+}
+
+/* If FD came from dec_input_fd, wait for its decompressor and
+   return true only if it succeeded.  For other descriptors return
+   true.  The caller reports any failure, with its own diagnostic
+   and exit status.  */
+
+extern bool
+dec_input_reap (int fd)
+{
+  pid_t pid = 0;
+
+  pthread_mutex_lock (&dec_children_lock);
+  for (struct dec_child **p = &dec_children; *p; p = &(*p)->next)
+    if ((*p)->fd == fd)
+      {
+        struct dec_child *child = *p;
+        *p = child->next;
+        pid = child->pid;
+        free (child);
+        break;
+      }
+  pthread_mutex_unlock (&dec_children_lock);
+
+  if (! pid)
+    return true;
+
+  int status;
+  while (waitpid (pid, &status, 0) < 0)
+    if (errno != EINTR)
+      return false;
+  return WIFEXITED (status) && WEXITSTATUS (status) == 0;
+}
@@ -0,0 +1,21 @@
+/* dec-input.h -- prototypes for transparent input decompression
+
+   Copyright (C) 2021 Free Software Foundation, Inc.
+
+   This program is free software: you can redistribute it and/or modify
+   it under the terms of the GNU General Public License as published by
+   the Free Software Foundation, either version 3 of the License, or
+   (at your option) any later version.
+
+   This program is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU General Public License for more details.
+
+   You should have received a copy of the GNU General Public License
+   along with this program.  If not, see <https://www.gnu.org/licenses/>.  */
+
+extern int dec_input_fd (int fd, char const *file, int failure_status);
+extern FILE *dec_input_stream (FILE *fp, char const *file,
+                               int failure_status);
+extern bool dec_input_reap (int fd);
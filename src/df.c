@@ -22,6 +22,7 @@
 #include <stdio.h>
 #include <sys/types.h>
 #include <getopt.h>
+#include <pthread.h>
 #include <assert.h>
 #include <c-ctype.h>
 #include <wchar.h>
@@ -39,6 +40,7 @@
 #include "quote.h"
 #include "find-mount-point.h"
 #include "hash.h"
+#include "xdectoint.h"
 #include "xstrtol-error.h"
 
 /* The official name of this program (e.g., no 'g' prefix).  */
@@ -127,6 +129,10 @@ static bool print_grand_total;
 /* Grand total data.  */
 static struct fs_usage grand_fsu;
 
+/* Number of threads collecting file system usage when listing all
+   file systems.  */
+static size_t nthreads = 1;
+
 /* Display modes.  */
 enum
 {
@@ -250,6 +256,7 @@ enum
 {
   NO_SYNC_OPTION = CHAR_MAX + 1,
   SYNC_OPTION,
+  THREADS_OPTION,
   TOTAL_OPTION,
   OUTPUT_OPTION
 };
@@ -267,6 +274,7 @@ static struct option const long_options[] =
   {"print-type", no_argument, NULL, 'T'},
   {"sync", no_argument, NULL, SYNC_OPTION},
   {"no-sync", no_argument, NULL, NO_SYNC_OPTION},
+  {"threads", required_argument, NULL, THREADS_OPTION},
   {"total", no_argument, NULL, TOTAL_OPTION},
   {"type", required_argument, NULL, 't'},
   {"exclude-type", required_argument, NULL, 'x'},
@@ -722,13 +730,22 @@ filter_mount_list (bool devices_only)
       struct stat buf;
       struct mount_entry *discard_me = NULL;
 
-      /* Avoid stating remote file systems as that may hang.
-         On Linux we probably have me_dev populated from /proc/self/mountinfo,
-         however we still stat() in case another device was mounted later.  */
+      /* A device number parsed from /proc/self/mountinfo is as current
+         as one from stat, and obtaining it did not touch the mount
+         point, which for stale or automounted entries could hang.  */
+      bool kernel_dev = (me->me_mntroot
+                         && me->me_dev != (dev_t) -1
+                         && me->me_dev != (dev_t) -2);
+      if (kernel_dev)
+        buf.st_dev = me->me_dev;
+
+      /* Avoid stating remote file systems as that may hang, and avoid
+         stating each of possibly 10000 mount points to learn device
+         numbers the kernel has already provided.  */
       if ((me->me_remote && show_local_fs)
           || (me->me_dummy && !show_all_fs && !show_listed_fs)
           || (!selected_fstype (me->me_type) || excluded_fstype (me->me_type))
-          || -1 == stat (me->me_mountdir, &buf))
+          || (! kernel_dev && -1 == stat (me->me_mountdir, &buf)))
         {
           /* If remote, and showing just local, or FS type is excluded,
              add ME for filtering later.
@@ -975,6 +992,66 @@ add_to_grand_total (struct field_values_t *bv, struct field_values_t *iv)
                             bv->negate_available);
 }
 
+/* A file system usage result collected by a worker thread.  */
+struct fsu_result
+{
+  struct fs_usage fsu;
+  int err;
+  bool filled;
+};
+
+/* The collected result for the mount entry get_dev is currently
+   processing, or NULL to query the file system directly.  */
+static struct fsu_result const *prefetched_fsu;
+
+/* Like get_fs_usage, but prefer any result already collected by the
+   parallel pass over the mount list.  */
+static int
+df_get_fs_usage (char const *stat_file, char const *disk,
+                 struct fs_usage *fsu)
+{
+  struct fsu_result const *r = prefetched_fsu;
+  if (r && r->filled)
+    {
+      *fsu = r->fsu;
+      errno = r->err;
+      return r->err ? -1 : 0;
+    }
+  return get_fs_usage (stat_file, disk, fsu);
+}
+
+/* Work pool for the parallel pass: threads claim mount entries in
+   order and collect each one's usage into the matching result.  */
+struct fsu_pool
+{
+  pthread_mutex_t mutex;
+  struct mount_entry **entries;
+  struct fsu_result *results;
+  size_t n;
+  size_t next;
+};
+
+static void *
+fsu_pool_thread (void *arg)
+{
+  struct fsu_pool *p = arg;
+
+  while (true)
+    {
+      pthread_mutex_lock (&p->mutex);
+      size_t i = p->next++;
+      pthread_mutex_unlock (&p->mutex);
+      if (p->n <= i)
+        return NULL;
+
+      struct mount_entry const *me = p->entries[i];
+      struct fsu_result *r = &p->results[i];
+      if (get_fs_usage (me->me_mountdir, me->me_devname, &r->fsu))
+        r->err = errno;
+      r->filled = true;
+    }
+}
+
 /* Obtain a space listing for the disk device with absolute file name DISK.
    If MOUNT_POINT is non-NULL, it is the name of the root of the
    file system on DISK.
@@ -1021,7 +1098,7 @@ get_dev (char const *disk, char const *mount_point, char const* file,
   struct fs_usage fsu;
   if (force_fsu)
     fsu = *force_fsu;
-  else if (get_fs_usage (stat_file, disk, &fsu))
+  else if (df_get_fs_usage (stat_file, disk, &fsu))
     {
       /* If we can't access a system provided entry due
          to it not being present (now), or due to permissions,
@@ -1386,10 +1463,22 @@ get_point (char const *point, const struct stat *statp)
         }
     }
   free (resolved);
-  if (best_match
-      && (stat (best_match->me_mountdir, &disk_stats) != 0
-          || disk_stats.st_dev != statp->st_dev))
-    best_match = NULL;
+  if (best_match)
+    {
+      /* An entry from /proc/self/mountinfo carries the kernel's device
+         number, which confirms the match without statting the mount
+         point; such a stat may hang on a stale remote mount.  */
+      if (best_match->me_mntroot
+          && best_match->me_dev != (dev_t) -1
+          && best_match->me_dev != (dev_t) -2)
+        {
+          if (best_match->me_dev != statp->st_dev)
+            best_match = NULL;
+        }
+      else if (stat (best_match->me_mountdir, &disk_stats) != 0
+               || disk_stats.st_dev != statp->st_dev)
+        best_match = NULL;
+    }
 
   if (! best_match)
     for (me = mount_list; me; me = me->me_next)
@@ -1418,9 +1507,11 @@ get_point (char const *point, const struct stat *statp)
             && !STREQ (me->me_type, "lofs")
             && (!best_match || best_match->me_dummy || !me->me_dummy))
           {
-            /* Skip bogus mtab entries.  */
-            if (stat (me->me_mountdir, &disk_stats) != 0
-                || disk_stats.st_dev != me->me_dev)
+            /* Skip bogus mtab entries; the kernel cannot supply those,
+               so trust entries from /proc/self/mountinfo as is.  */
+            if (! me->me_mntroot
+                && (stat (me->me_mountdir, &disk_stats) != 0
+                    || disk_stats.st_dev != me->me_dev))
               me->me_dev = (dev_t) -2;
             else
               best_match = me;
@@ -1470,6 +1561,58 @@ get_all_entries (void)
 
   filter_mount_list (show_all_fs);
 
+  size_t n_entries = 0;
+  for (me = mount_list; me; me = me->me_next)
+    n_entries++;
+
+  if (1 < nthreads && 1 < n_entries)
+    {
+      struct fsu_pool pool;
+      pthread_mutex_init (&pool.mutex, NULL);
+      pool.entries = xnmalloc (n_entries, sizeof *pool.entries);
+      pool.results = xcalloc (n_entries, sizeof *pool.results);
+      pool.n = 0;
+      pool.next = 0;
+
+      /* Collect usage only for entries get_dev will not skip, so that
+         for example --local still never touches a remote mount.  */
+      for (me = mount_list; me; me = me->me_next)
+        if (! ((me->me_remote && show_local_fs)
+               || (me->me_dummy && !show_all_fs && !show_listed_fs)
+               || !selected_fstype (me->me_type)
+               || excluded_fstype (me->me_type)
+               || ! IS_ABSOLUTE_FILE_NAME (me->me_mountdir)))
+          pool.entries[pool.n++] = me;
+
+      size_t nworkers = MIN (nthreads, MAX (pool.n, 1));
+      pthread_t *tids = xnmalloc (nworkers, sizeof *tids);
+      size_t started = 0;
+      for (size_t i = 1; i < nworkers; i++)
+        if (pthread_create (&tids[started], NULL, fsu_pool_thread, &pool) == 0)
+          started++;
+      fsu_pool_thread (&pool);
+      for (size_t i = 0; i < started; i++)
+        pthread_join (tids[i], NULL);
+      free (tids);
+      pthread_mutex_destroy (&pool.mutex);
+
+      /* Report in mount list order, as the serial code does.  */
+      size_t ri = 0;
+      for (me = mount_list; me; me = me->me_next)
+        {
+          prefetched_fsu = (ri < pool.n && pool.entries[ri] == me
+                            ? &pool.results[ri++]
+                            : NULL);
+          get_dev (me->me_devname, me->me_mountdir, NULL, NULL, me->me_type,
+                   me->me_dummy, me->me_remote, NULL, true);
+        }
+      prefetched_fsu = NULL;
+
+      free (pool.entries);
+      free (pool.results);
+      return;
+    }
+
   for (me = mount_list; me; me = me->me_next)
     get_dev (me->me_devname, me->me_mountdir, NULL, NULL, me->me_type,
              me->me_dummy, me->me_remote, NULL, true);
@@ -1540,6 +1683,8 @@ or all file systems by default.\n\
       --sync            invoke sync before getting usage info\n\
 "), stdout);
       fputs (_("\
+      --threads=N       when listing all file systems, query up to N of\n\
+                          them concurrently\n\
       --total           elide all entries insignificant to available space,\n\
                           and produce a grand total\n\
 "), stdout);
@@ -1663,6 +1808,11 @@ main (int argc, char **argv)
           require_sync = false;
           break;
 
+        case THREADS_OPTION:
+          nthreads = xdectoumax (optarg, 1, SIZE_MAX, "",
+                                 _("invalid number of threads"), 0);
+          break;
+
         case 'F':
           /* Accept -F as a synonym for -t for compatibility with Solaris.  */
         case 't':
@@ -0,0 +1,245 @@
+/* Compute SHA-1 and SHA-256 digests with x86 SHA instructions.
+   Copyright (C) 2021 Free Software Foundation, Inc.
+
+   This program is free software: you can redistribute it and/or modify
+   it under the terms of the GNU General Public License as published by
+   the Free Software Foundation, either version 3 of the License, or
+   (at your option) any later version.
+
+   This program is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU General Public License for more details.
+
+   You should have received a copy of the GNU General Public License
+   along with this program.  If not, see <https://www.gnu.org/licenses/>.  */
+
+#include <config.h>
+
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <string.h>
+#include <x86intrin.h>
+
+#include "digest-sha-ni.h"
+
+/* Number of bytes to read at once; a multiple of the 64-byte block.  */
+#define BLOCKSIZE 32768
+
+/* The SHA-256 round constants (FIPS-180-2, section 4.2.2).  */
+static uint32_t const K256[64] =
+{
+  0x428a2f98, 0x71374491, 0xb5c0fbcf, 0xe9b5dba5,
+  0x3956c25b, 0x59f111f1, 0x923f82a4, 0xab1c5ed5,
+  0xd807aa98, 0x12835b01, 0x243185be, 0x550c7dc3,
+  0x72be5d74, 0x80deb1fe, 0x9bdc06a7, 0xc19bf174,
+  0xe49b69c1, 0xefbe4786, 0x0fc19dc6, 0x240ca1cc,
+  0x2de92c6f, 0x4a7484aa, 0x5cb0a9dc, 0x76f988da,
+  0x983e5152, 0xa831c66d, 0xb00327c8, 0xbf597fc7,
+  0xc6e00bf3, 0xd5a79147, 0x06ca6351, 0x14292967,
+  0x27b70a85, 0x2e1b2138, 0x4d2c6dfc, 0x53380d13,
+  0x650a7354, 0x766a0abb, 0x81c2c92e, 0x92722c85,
+  0xa2bfe8a1, 0xa81a664b, 0xc24b8b70, 0xc76c51a3,
+  0xd192e819, 0xd6990624, 0xf40e3585, 0x106aa070,
+  0x19a4c116, 0x1e376c08, 0x2748774c, 0x34b0bcb5,
+  0x391c0cb3, 0x4ed8aa4a, 0x5b9cca4f, 0x682e6ff3,
+  0x748f82ee, 0x78a5636f, 0x84c87814, 0x8cc70208,
+  0x90befffa, 0xa4506ceb, 0xbef9a3f7, 0xc67178f2
+};
+
+/* Update the SHA-256 STATE with NBLOCKS 64-byte blocks from DATA,
+   two rounds per sha256rnds2 instruction.  The register handling
+   follows the scheme in the Intel SHA extensions white paper: the
+   state is kept transposed as ABEF/CDGH across blocks.  */
+
+static void
+sha256_ni_blocks (uint32_t *state, unsigned char const *data, size_t nblocks)
+{
+  __m128i const shuf_mask =
+    _mm_set_epi64x (0x0c0d0e0f08090a0bULL, 0x0405060700010203ULL);
+  __m128i state0, state1, tmp;
+
+  /* Load the state and transpose DCBA/HGFE to ABEF/CDGH.  */
+  tmp = _mm_loadu_si128 ((__m128i const *) &state[0]);
+  state1 = _mm_loadu_si128 ((__m128i const *) &state[4]);
+  tmp = _mm_shuffle_epi32 (tmp, 0xB1);
+  state1 = _mm_shuffle_epi32 (state1, 0x1B);
+  state0 = _mm_alignr_epi8 (tmp, state1, 8);
+  state1 = _mm_blend_epi16 (state1, tmp, 0xF0);
+
+  while (nblocks--)
+    {
+      __m128i const save0 = state0;
+      __m128i const save1 = state1;
+      __m128i m[4];
+
+      for (int i = 0; i < 4; i++)
+        m[i] = _mm_shuffle_epi8
+          (_mm_loadu_si128 ((__m128i const *) (data + 16 * i)), shuf_mask);
+
+      for (int i = 0; i < 16; i++)
+        {
+          __m128i msg =
+            _mm_add_epi32 (m[i & 3],
+                           _mm_loadu_si128 ((__m128i const *) &K256[4 * i]));
+          state1 = _mm_sha256rnds2_epu32 (state1, state0, msg);
+          msg = _mm_shuffle_epi32 (msg, 0x0E);
+          state0 = _mm_sha256rnds2_epu32 (state0, state1, msg);
+
+          /* Schedule the message words four rounds ahead.  */
+          if (i < 12)
+            {
+              __m128i x = _mm_sha256msg1_epu32 (m[i & 3], m[(i + 1) & 3]);
+              x = _mm_add_epi32 (x, _mm_alignr_epi8 (m[(i + 3) & 3],
+                                                     m[(i + 2) & 3], 4));
+              m[i & 3] = _mm_sha256msg2_epu32 (x, m[(i + 3) & 3]);
+            }
+        }
+
+      state0 = _mm_add_epi32 (state0, save0);
+      state1 = _mm_add_epi32 (state1, save1);
+      data += 64;
+    }
+
+  /* Transpose back and store.  */
+  tmp = _mm_shuffle_epi32 (state0, 0x1B);
+  state1 = _mm_shuffle_epi32 (state1, 0xB1);
+  state0 = _mm_blend_epi16 (tmp, state1, 0xF0);
+  state1 = _mm_alignr_epi8 (state1, tmp, 8);
+  _mm_storeu_si128 ((__m128i *) &state[0], state0);
+  _mm_storeu_si128 ((__m128i *) &state[4], state1);
+}
+
+/* Update the SHA-1 STATE with NBLOCKS 64-byte blocks from DATA, four
+   rounds per sha1rnds4 instruction.  The instruction takes the round
+   function selector as an immediate, so the 20 scheduling steps are
+   grouped in fours.  */
+
+#define SHA1_STEPS(first, imm)                                          \
+  for (int j = (first); j < (first) + 5; j++)                           \
+    {                                                                   \
+      prev = abcd;                                                      \
+      abcd = _mm_sha1rnds4_epu32 (abcd, e, imm);                        \
+      e = _mm_sha1nexte_epu32 (prev, m[(j + 1) & 3]);                   \
+      if (j < 16)                                                       \
+        m[j & 3] = _mm_sha1msg2_epu32                                   \
+          (_mm_xor_si128 (_mm_sha1msg1_epu32 (m[j & 3], m[(j + 1) & 3]), \
+                          m[(j + 2) & 3]),                              \
+           m[(j + 3) & 3]);                                             \
+    }
+
+static void
+sha1_ni_blocks (uint32_t *state, unsigned char const *data, size_t nblocks)
+{
+  __m128i const shuf_mask =
+    _mm_set_epi64x (0x0001020304050607ULL, 0x08090a0b0c0d0e0fULL);
+  __m128i abcd, e, prev;
+
+  abcd = _mm_shuffle_epi32 (_mm_loadu_si128 ((__m128i const *) state), 0x1B);
+  e = _mm_set_epi32 (state[4], 0, 0, 0);
+
+  while (nblocks--)
+    {
+      __m128i const abcd_save = abcd;
+      __m128i const e_save = e;
+      __m128i m[4];
+
+      for (int i = 0; i < 4; i++)
+        m[i] = _mm_shuffle_epi8
+          (_mm_loadu_si128 ((__m128i const *) (data + 16 * i)), shuf_mask);
+
+      e = _mm_add_epi32 (e, m[0]);
+      SHA1_STEPS (0, 0);
+      SHA1_STEPS (5, 1);
+      SHA1_STEPS (10, 2);
+      SHA1_STEPS (15, 3);
+
+      e = _mm_sha1nexte_epu32 (prev, e_save);
+      abcd = _mm_add_epi32 (abcd, abcd_save);
+      data += 64;
+    }
+
+  _mm_storeu_si128 ((__m128i *) state,
+                    _mm_shuffle_epi32 (abcd, 0x1B));
+  state[4] = _mm_extract_epi32 (e, 3);
+}
+
+/* Digest STREAM into STATE (RES_WORDS 32-bit words of output) using
+   the per-block function PROCESS, then store the big-endian result in
+   RESBLOCK.  Implements the common buffering, padding and length
+   encoding of SHA-1 and SHA-256.  Return zero upon success, nonzero
+   (setting errno) upon read error.  */
+
+static int
+sha_ni_stream (FILE *stream, uint32_t *state,
+               void (*process) (uint32_t *, unsigned char const *, size_t),
+               unsigned char *resblock, size_t res_words)
+{
+  /* Room for a partial block, the pad byte, and the length.  */
+  unsigned char buf[BLOCKSIZE + 128];
+  uintmax_t total = 0;
+  size_t fill = 0;
+
+  while (true)
+    {
+      size_t n = fread (buf + fill, 1, BLOCKSIZE - fill, stream);
+      if (n == 0)
+        {
+          if (ferror (stream))
+            return 1;
+          break;
+        }
+      fill += n;
+      total += n;
+
+      size_t whole = fill - fill % 64;
+      process (state, buf, whole / 64);
+      memmove (buf, buf + whole, fill - whole);
+      fill -= whole;
+    }
+
+  /* Pad to a 56 mod 64 byte boundary and append the bit length.  */
+  buf[fill++] = 0x80;
+  size_t padded = (fill + 8 <= 64 ? 64 : 128);
+  memset (buf + fill, 0, padded - 8 - fill);
+  uintmax_t bits = total << 3;
+  for (int i = 0; i < 8; i++)
+    buf[padded - 1 - i] = bits >> (8 * i);
+  process (state, buf, padded / 64);
+
+  for (size_t i = 0; i < res_words; i++)
+    for (int b = 0; b < 4; b++)
+      resblock[4 * i + b] = state[i] >> (8 * (3 - b));
+
+  return 0;
+}
+
+int
+sha1_ni_stream (FILE *stream, void *resblock)
+{
+  uint32_t state[5] =
+    { 0x67452301, 0xefcdab89, 0x98badcfe, 0x10325476, 0xc3d2e1f0 };
+
+  return sha_ni_stream (stream, state, sha1_ni_blocks, resblock, 5);
+}
+
+int
+sha224_ni_stream (FILE *stream, void *resblock)
+{
+  uint32_t state[8] =
+    { 0xc1059ed8, 0x367cd507, 0x3070dd17, 0xf70e5939,
+      0xffc00b31, 0x68581511, 0x64f98fa7, 0xbefa4fa4 };
+
+  return sha_ni_stream (stream, state, sha256_ni_blocks, resblock, 7);
+}
+
+int
+sha256_ni_stream (FILE *stream, void *resblock)
+{
+  uint32_t state[8] =
+    { 0x6a09e667, 0xbb67ae85, 0x3c6ef372, 0xa54ff53a,
+      0x510e527f, 0x9b05688c, 0x1f83d9ab, 0x5be0cd19 };
+
+  return sha_ni_stream (stream, state, sha256_ni_blocks, resblock, 8);
+}
@@ -0,0 +1,33 @@
+/* Compute SHA-1 and SHA-256 digests with x86 SHA instructions.
+   Copyright (C) 2021 Free Software Foundation, Inc.
+
+   This program is free software: you can redistribute it and/or modify
+   it under the terms of the GNU General Public License as published by
+   the Free Software Foundation, either version 3 of the License, or
+   (at your option) any later version.
+
+   This program is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU General Public License for more details.
+
+   You should have received a copy of the GNU General Public License
+   along with this program.  If not, see <https://www.gnu.org/licenses/>.  */
+
+#ifndef DIGEST_SHA_NI_H
+# define DIGEST_SHA_NI_H
+
+# include <stdio.h>
+
+/* Compute the respective message digest of the whole of STREAM with
+   the x86 SHA instruction set extensions, storing the binary result
+   in RESBLOCK.  These follow the contract of the gnulib sha*_stream
+   functions: return zero upon success, nonzero (setting errno) upon
+   read error.  Call only after a cpuid probe has confirmed SHA
+   support.  */
+
+extern int sha1_ni_stream (FILE *stream, void *resblock);
+extern int sha224_ni_stream (FILE *stream, void *resblock);
+extern int sha256_ni_stream (FILE *stream, void *resblock);
+
+#endif
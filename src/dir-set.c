@@ -0,0 +1,86 @@
+/* dir-set.c -- the set of destination directories known to exist
+
+   Copyright (C) 2021 Free Software Foundation, Inc.
+
+   This program is free software: you can redistribute it and/or modify
+   it under the terms of the GNU General Public License as published by
+   the Free Software Foundation, either version 3 of the License, or
+   (at your option) any later version.
+
+   This program is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU General Public License for more details.
+
+   You should have received a copy of the GNU General Public License
+   along with this program.  If not, see <https://www.gnu.org/licenses/>.  */
+
+#include <config.h>
+
+#include <sys/types.h>
+#include "system.h"
+
+#include "hash.h"
+#include "dir-set.h"
+
+/* Destination directories created or verified during this run.
+   cp --parents and install -D must ensure the ancestor chain of every
+   destination they write; when many destinations share ancestors,
+   consulting this set replaces the repeated stat and mkdir of each
+   shared component with one lookup.  Entries are keyed by the textual
+   directory name as the tool composed it, which is stable within a
+   run.  The set is consulted only from the serial argument loop, so
+   no locking is needed.  */
+
+static Hash_table *dir_set;
+
+enum { DIR_SET_INITIAL_CAPACITY = 61 };
+
+static size_t
+dir_set_hasher (void const *name, size_t table_size)
+{
+  return hash_string (name, table_size);
+}
+
+static bool
+dir_set_comparator (void const *a, void const *b)
+{
+  return STREQ (a, b);
+}
+
+/* Enable the set.  Until this is called, dir_set_contains reports
+   nothing and dir_set_insert records nothing, so callers that cannot
+   benefit (a single destination, say) simply skip initialization.  */
+
+extern void
+dir_set_init (void)
+{
+  dir_set = hash_initialize (DIR_SET_INITIAL_CAPACITY, NULL,
+                             dir_set_hasher, dir_set_comparator, free);
+  if (dir_set == NULL)
+    xalloc_die ();
+}
+
+/* Return true if DIR was recorded as existing.  */
+
+extern bool
+dir_set_contains (char const *dir)
+{
+  return dir_set && hash_lookup (dir_set, dir) != NULL;
+}
+
+/* Record that DIR exists as a directory.  */
+
+extern void
+dir_set_insert (char const *dir)
+{
+  if (dir_set == NULL)
+    return;
+
+  char *name = xstrdup (dir);
+  char *existing = hash_insert (dir_set, name);
+  if (existing == NULL)
+    xalloc_die ();
+  if (existing != name)
+    free (name);
+}
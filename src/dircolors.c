@@ -24,6 +24,7 @@
 #include "system.h"
 #include "dircolors.h"
 #include "c-strcase.h"
+#include "colordb.h"
 #include "die.h"
 #include "error.h"
 #include "obstack.h"
@@ -59,6 +60,19 @@ enum Shell_syntax
    variable.  */
 static struct obstack lsc_obstack;
 
+/* With --compile, write a compiled color database to this file
+   instead of emitting shell code.  */
+static char const *compile_file;
+
+/* Accumulate entry records and unescaped pool bytes for --compile.  */
+static struct obstack entry_obstack;
+static struct obstack pool_obstack;
+
+enum
+{
+  COMPILE_OPTION = CHAR_MAX + 1
+};
+
 static char const *const slack_codes[] =
 {
   "NORMAL", "NORM", "FILE", "RESET", "DIR", "LNK", "LINK",
@@ -84,6 +98,7 @@ static struct option const long_options[] =
     {"csh", no_argument, NULL, 'c'},
     {"c-shell", no_argument, NULL, 'c'},
     {"print-database", no_argument, NULL, 'p'},
+    {"compile", required_argument, NULL, COMPILE_OPTION},
     {GETOPT_HELP_OPTION_DECL},
     {GETOPT_VERSION_OPTION_DECL},
     {NULL, 0, NULL, 0}
@@ -104,6 +119,9 @@ Determine format of output:\n\
   -b, --sh, --bourne-shell    output Bourne shell code to set LS_COLORS\n\
   -c, --csh, --c-shell        output C shell code to set LS_COLORS\n\
   -p, --print-database        output defaults\n\
+      --compile=FILE          write a compiled color database to FILE,\n\
+                                for use via the LS_COLORS_DB environment\n\
+                                variable of ls\n\
 "), stdout);
       fputs (HELP_OPTION_DESCRIPTION, stdout);
       fputs (VERSION_OPTION_DESCRIPTION, stdout);
@@ -228,6 +246,121 @@ append_quoted (char const *str)
     }
 }
 
+/* Decode STR exactly as ls will when it parses LS_COLORS, appending
+   the resulting bytes to pool_obstack and adding the decoded length
+   to *LEN.  An unescaped : or = is literal here, since database
+   entries are delimited by structure, not by separator bytes.
+   Return true if successful.  */
+
+static bool
+compile_string (char const *str, uint32_t *len)
+{
+  char *buf = xmalloc (strlen (str) + 1);
+  char const *src = str;
+  bool ok = true;
+
+  while (true)
+    {
+      char *dest = buf;
+      size_t n;
+      if (! color_unescape (&dest, &src, false, &n))
+        {
+          ok = false;
+          break;
+        }
+      obstack_grow (&pool_obstack, buf, n);
+      *len += n;
+      if (*src != ':')
+        break;
+      obstack_1grow (&pool_obstack, ':');
+      ++*len;
+      ++src;
+    }
+
+  free (buf);
+  return ok;
+}
+
+/* Append a compiled extension entry for pattern KEYWD (prefixed with
+   '*' if ADD_STAR) and color sequence ARG.  Return true if both
+   strings decode successfully.  */
+
+static bool
+compile_ext (char const *keywd, char const *arg, bool add_star)
+{
+  struct colordb_entry e = { 0 };
+
+  e.pattern_off = obstack_object_size (&pool_obstack);
+  if (add_star)
+    obstack_1grow (&pool_obstack, '*');
+  e.pattern_len = add_star;
+  if (! compile_string (keywd, &e.pattern_len))
+    return false;
+
+  e.seq_off = obstack_object_size (&pool_obstack);
+  if (! compile_string (arg, &e.seq_len))
+    return false;
+
+  obstack_grow (&entry_obstack, &e, sizeof e);
+  return true;
+}
+
+/* Append a compiled indicator entry for the two-letter LABEL with
+   color sequence ARG.  Return true if ARG decodes successfully.  */
+
+static bool
+compile_indicator (char const *label, char const *arg)
+{
+  struct colordb_entry e = { 0 };
+
+  e.label[0] = label[0];
+  e.label[1] = label[1];
+  e.seq_off = obstack_object_size (&pool_obstack);
+  if (! compile_string (arg, &e.seq_len))
+    return false;
+
+  obstack_grow (&entry_obstack, &e, sizeof e);
+  return true;
+}
+
+/* Write the accumulated compiled database to FILE.
+   Return true if successful.  */
+
+static bool
+write_compiled_db (char const *file)
+{
+  struct colordb_header h;
+  size_t entry_bytes = obstack_object_size (&entry_obstack);
+  size_t pool_size = obstack_object_size (&pool_obstack);
+
+  memcpy (h.magic, COLORDB_MAGIC, sizeof h.magic);
+  h.byte_order = COLORDB_BYTE_ORDER_MARK;
+  h.version = COLORDB_VERSION;
+  h.n_entries = entry_bytes / sizeof (struct colordb_entry);
+  h.pool_size = pool_size;
+  if (pool_size != h.pool_size)
+    die (EXIT_FAILURE, 0, _("color database is too large"));
+
+  FILE *fp = fopen (file, "w");
+  if (! fp)
+    {
+      error (0, errno, "%s", quotef (file));
+      return false;
+    }
+
+  if (fwrite (&h, sizeof h, 1, fp) != 1
+      || fwrite (obstack_base (&entry_obstack), 1, entry_bytes, fp)
+         != entry_bytes
+      || fwrite (obstack_base (&pool_obstack), 1, pool_size, fp) != pool_size
+      || fclose (fp) != 0)
+    {
+      error (0, errno, "%s", quotef (file));
+      return false;
+    }
+
+  return true;
+}
+
 /* Read the file open on FP (with name FILENAME).  First, look for a
    'TERM name' directive where name matches the current terminal type.
    Once found, translate and accumulate the associated directives onto
@@ -307,20 +440,28 @@ dc_parse_stream (FILE *fp, char const *filename)
 
           if (state != ST_TERMNO)
             {
-              if (keywd[0] == '.')
-                {
-                  APPEND_CHAR ('*');
-                  append_quoted (keywd);
-                  APPEND_CHAR ('=');
-                  append_quoted (arg);
-                  APPEND_CHAR (':');
-                }
-              else if (keywd[0] == '*')
+              if (keywd[0] == '.' || keywd[0] == '*')
                 {
-                  append_quoted (keywd);
-                  APPEND_CHAR ('=');
-                  append_quoted (arg);
-                  APPEND_CHAR (':');
+                  if (compile_file)
+                    {
+                      if (! compile_ext (keywd, arg, keywd[0] == '.'))
+                        {
+                          error (0, 0, _("%s:%lu: invalid escape sequence"),
+                                 (filename ? quotef (filename)
+                                  : _("<internal>")),
+                                 (unsigned long int) line_number);
+                          ok = false;
+                        }
+                    }
+                  else
+                    {
+                      if (keywd[0] == '.')
+                        APPEND_CHAR ('*');
+                      append_quoted (keywd);
+                      APPEND_CHAR ('=');
+                      append_quoted (arg);
+                      APPEND_CHAR (':');
+                    }
                 }
               else if (c_strcasecmp (keywd, "OPTIONS") == 0
                        || c_strcasecmp (keywd, "COLOR") == 0
@@ -338,10 +479,25 @@ dc_parse_stream (FILE *fp, char const *filename)
 
                   if (slack_codes[i] != NULL)
                     {
-                      APPEND_TWO_CHAR_STRING (ls_codes[i]);
-                      APPEND_CHAR ('=');
-                      append_quoted (arg);
-                      APPEND_CHAR (':');
+                      if (compile_file)
+                        {
+                          if (! compile_indicator (ls_codes[i], arg))
+                            {
+                              error (0, 0,
+                                     _("%s:%lu: invalid escape sequence"),
+                                     (filename ? quotef (filename)
+                                      : _("<internal>")),
+                                     (unsigned long int) line_number);
+                              ok = false;
+                            }
+                        }
+                      else
+                        {
+                          APPEND_TWO_CHAR_STRING (ls_codes[i]);
+                          APPEND_CHAR ('=');
+                          append_quoted (arg);
+                          APPEND_CHAR (':');
+                        }
                     }
                   else
                     {
@@ -423,6 +579,10 @@ main (int argc, char **argv)
         print_database = true;
         break;
 
+      case COMPILE_OPTION:
+        compile_file = optarg;
+        break;
+
       case_GETOPT_HELP_CHAR;
 
       case_GETOPT_VERSION_CHAR (PROGRAM_NAME, AUTHORS);
@@ -444,6 +604,15 @@ main (int argc, char **argv)
       usage (EXIT_FAILURE);
     }
 
+  if (compile_file && (print_database || syntax != SHELL_SYNTAX_UNKNOWN))
+    {
+      error (0, 0,
+             _("the option to compile a color database may not be combined\n"
+               "with the options to output the internal database or to\n"
+               "select a shell syntax"));
+      usage (EXIT_FAILURE);
+    }
+
   if ((!print_database) < argc)
     {
       error (0, 0, _("extra operand %s"), quote (argv[!print_database]));
@@ -463,6 +632,19 @@ main (int argc, char **argv)
           p += strlen (p) + 1;
         }
     }
+  else if (compile_file)
+    {
+      obstack_init (&entry_obstack);
+      obstack_init (&pool_obstack);
+
+      if (argc == 0)
+        ok = dc_parse_stream (NULL, NULL);
+      else
+        ok = dc_parse_file (argv[0]);
+
+      if (ok)
+        ok = write_compiled_db (compile_file);
+    }
   else
     {
       /* If shell syntax was not explicitly specified, try to guess it. */
@@ -0,0 +1,112 @@
+/* Read directory entries in large batches with getdents64.
+   Copyright (C) 2021 Free Software Foundation, Inc.
+
+   This program is free software: you can redistribute it and/or modify
+   it under the terms of the GNU General Public License as published by
+   the Free Software Foundation, either version 3 of the License, or
+   (at your option) any later version.
+
+   This program is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU General Public License for more details.
+
+   You should have received a copy of the GNU General Public License
+   along with this program.  If not, see <https://www.gnu.org/licenses/>.  */
+
+/* readdir hands back one entry per call from a buffer of a few tens
+   of kibibytes, so enumerating a directory of millions of entries
+   spends a large share of its time crossing the syscall boundary.
+   On GNU/Linux the records that getdents64 fills in have exactly the
+   layout of struct dirent once d_ino and d_off are 64 bits wide,
+   which configure guarantees via _FILE_OFFSET_BITS, so the entries
+   of a much larger buffer can be handed out in place.  Elsewhere, or
+   when the layouts do not match, these functions devolve to plain
+   readdir.  */
+
+#include <stddef.h>
+#include <dirent.h>
+#ifdef __linux__
+# include <sys/syscall.h>
+# include <unistd.h>
+#endif
+
+/* Size of the batch buffer.  One getdents64 call typically returns
+   on the order of ten thousand entries at this size.  */
+enum { DIRENT_BATCH_BUFSIZE = 1024 * 1024 };
+
+/* Whether struct dirent records can alias getdents64 records.  */
+#if defined __linux__ && defined SYS_getdents64
+# define DIRENT_BATCH_USABLE \
+   (sizeof (((struct dirent *) 0)->d_ino) == 8 \
+    && sizeof (((struct dirent *) 0)->d_off) == 8 \
+    && offsetof (struct dirent, d_reclen) == 16 \
+    && offsetof (struct dirent, d_type) == 18 \
+    && offsetof (struct dirent, d_name) == 19)
+#else
+# define DIRENT_BATCH_USABLE 0
+#endif
+
+struct dirent_batch
+{
+  char *buf;                    /* Batch buffer, or NULL in readdir mode.  */
+  size_t pos;                   /* Offset of the next unread record.  */
+  size_t len;                   /* Bytes of records in BUF.  */
+};
+
+/* Prepare DB to read the entries of DIRP.  */
+static void
+dirent_batch_init (struct dirent_batch *db, DIR *dirp)
+{
+  db->pos = db->len = 0;
+  db->buf = (DIRENT_BATCH_USABLE && 0 <= dirfd (dirp)
+             ? malloc (DIRENT_BATCH_BUFSIZE)
+             : NULL);
+}
+
+/* Return the next entry of DIRP, or NULL with errno set upon error,
+   or NULL with errno zero at end of directory, as readdir would.
+   The result is invalidated by the next call.  */
+static struct dirent *
+dirent_batch_read (struct dirent_batch *db, DIR *dirp)
+{
+  if (! db->buf)
+    return readdir (dirp);
+
+#if defined __linux__ && defined SYS_getdents64
+  while (true)
+    {
+      if (db->len <= db->pos)
+        {
+          ssize_t n = syscall (SYS_getdents64, dirfd (dirp), db->buf,
+                               DIRENT_BATCH_BUFSIZE);
+          if (n < 0)
+            return NULL;
+          if (n == 0)
+            {
+              errno = 0;
+              return NULL;
+            }
+          db->pos = 0;
+          db->len = n;
+        }
+
+      struct dirent *d = (struct dirent *) (db->buf + db->pos);
+      db->pos += d->d_reclen;
+
+      /* readdir skips records whose inode is zero; do likewise.  */
+      if (d->d_ino != 0)
+        return d;
+    }
+#else
+  return NULL;
+#endif
+}
+
+/* Release the resources of DB; DIRP remains the caller's to close.  */
+static void
+dirent_batch_free (struct dirent_batch *db)
+{
+  free (db->buf);
+  db->buf = NULL;
+}
@@ -84,9 +84,17 @@ main (int argc, char **argv)
 
   initialize_main (&argc, &argv);
   set_program_name (argv[0]);
-  setlocale (LC_ALL, "");
-  bindtextdomain (PACKAGE, LOCALEDIR);
-  textdomain (PACKAGE);
+
+  /* The normal output is a byte-level operation on the operands, so
+     postpone locale setup until an argument looks like an option and
+     option parsing may print translated text.  The diagnostic path
+     below calls initialize_locale itself.  */
+  for (int i = 1; i < argc; i++)
+    if (argv[i][0] == '-')
+      {
+        initialize_locale ();
+        break;
+      }
 
   atexit (close_stdout);
 
@@ -113,6 +121,7 @@ main (int argc, char **argv)
 
   if (argc < optind + 1)
     {
+      initialize_locale ();
       error (0, 0, _("missing operand"));
       usage (EXIT_FAILURE);
     }
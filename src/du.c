@@ -25,8 +25,20 @@
 
 #include <config.h>
 #include <getopt.h>
+#include <pthread.h>
+#include <signal.h>
 #include <sys/types.h>
 #include <assert.h>
+
+/* Use SA_NOCLDSTOP as a proxy for whether the sigaction machinery is
+   present.  */
+#ifndef SA_NOCLDSTOP
+# define SA_NOCLDSTOP 0
+#endif
+#ifndef SA_RESTART
+# define SA_RESTART 0
+#endif
+
 #include "system.h"
 #include "argmatch.h"
 #include "argv-iter.h"
@@ -34,19 +46,30 @@
 #include "die.h"
 #include "error.h"
 #include "exclude.h"
+#include "filenamecat.h"
 #include "fprintftime.h"
+#include "hash.h"
 #include "human.h"
+#include "json-quote.h"
 #include "mountlist.h"
 #include "quote.h"
 #include "stat-size.h"
 #include "stat-time.h"
+#include "statx.h"
 #include "stdio--.h"
+#include "xdectoint.h"
 #include "xfts.h"
 #include "xstrtol.h"
 #include "xstrtol-error.h"
 
 extern bool fts_debug;
 
+#if HAVE_STATX && defined STATX_INO
+# define USE_STATX 1
+#else
+# define USE_STATX 0
+#endif
+
 /* The official name of this program (e.g., no 'g' prefix).  */
 #define PROGRAM_NAME "du"
 
@@ -69,16 +92,15 @@ static struct di_set *di_files;
 /* A set containing a dev/ino pair for each local mount point directory.  */
 static struct di_set *di_mnt;
 
-/* Keep track of the preceding "level" (depth in hierarchy)
-   from one call of process_file to the next.  */
-static size_t prev_level;
-
 /* Define a class for collecting directory information. */
 struct duinfo
 {
   /* Size of files in directory.  */
   uintmax_t size;
 
+  /* Sum of apparent sizes, maintained for --sparseness.  */
+  uintmax_t apparent;
+
   /* Number of inodes in directory.  */
   uintmax_t inodes;
 
@@ -92,6 +114,7 @@ static inline void
 duinfo_init (struct duinfo *a)
 {
   a->size = 0;
+  a->apparent = 0;
   a->inodes = 0;
   a->tmax.tv_sec = TYPE_MINIMUM (time_t);
   a->tmax.tv_nsec = -1;
@@ -99,9 +122,11 @@ duinfo_init (struct duinfo *a)
 
 /* Set directory data.  */
 static inline void
-duinfo_set (struct duinfo *a, uintmax_t size, struct timespec tmax)
+duinfo_set (struct duinfo *a, uintmax_t size, uintmax_t apparent,
+            struct timespec tmax)
 {
   a->size = size;
+  a->apparent = apparent;
   a->inodes = 1;
   a->tmax = tmax;
 }
@@ -112,6 +137,8 @@ duinfo_add (struct duinfo *a, struct duinfo const *b)
 {
   uintmax_t sum = a->size + b->size;
   a->size = a->size <= sum ? sum : UINTMAX_MAX;
+  sum = a->apparent + b->apparent;
+  a->apparent = a->apparent <= sum ? sum : UINTMAX_MAX;
   a->inodes = a->inodes + b->inodes;
   if (timespec_cmp (a->tmax, b->tmax) < 0)
     a->tmax = b->tmax;
@@ -127,6 +154,93 @@ struct dulevel
   struct duinfo subdir;
 };
 
+/* One --cache record: the aggregate of the direct non-directory
+   entries of the directory identified by DEV/INO, valid as long as the
+   directory's own timestamps still equal MTIME and CTIME.  Both size
+   bases and all time types are kept so that one index serves runs with
+   differing options.  Records are read from and written to the cache
+   file verbatim, so the index is private to one machine and build.  */
+struct ducache_ent
+{
+  dev_t dev;
+  ino_t ino;
+  struct timespec mtime;
+  struct timespec ctime;
+
+  uintmax_t blocks;		/* Sum of ST_NBLOCKS-based usage.  */
+  uintmax_t apparent;		/* Sum of apparent sizes.  */
+  uintmax_t inodes;		/* Number of entries summed.  */
+  struct timespec tmax[3];	/* Latest timestamp, indexed by time_type.  */
+};
+
+/* Per-level cache bookkeeping for the directory being read at each
+   depth of a traversal.  */
+struct ducache_dir
+{
+  /* The validated record for this directory, or NULL.  */
+  struct ducache_ent const *hit;
+
+  /* The aggregate under construction for a new record.  */
+  struct ducache_ent agg;
+
+  /* False once an entry was skipped, excluded, inaccessible, or
+     multiply linked, since AGG then no longer describes the directory
+     on its own.  */
+  bool cacheable;
+};
+
+/* The state of one traversal, so that concurrent --threads walks do
+   not share accumulators.  */
+struct dustate
+{
+  /* Per-level accumulators, grown on demand.  */
+  struct dulevel *dulvl;
+  size_t n_alloc;
+
+  /* The "level" (depth in hierarchy) of the entry preceding the
+     current one.  */
+  size_t prev_level;
+
+  /* Depth of this walk's root below the command-line operand: the
+     serial walk starts at the operand itself, --threads walks at its
+     immediate children.  */
+  size_t level_offset;
+
+  /* Whether the root of this walk is a directory.  */
+  bool root_is_dir;
+
+  /* Sum over every entry counted by this walk.  */
+  struct duinfo tot;
+
+  /* With --cache, bookkeeping for the directory open at each depth,
+     grown on demand like DULVL.  */
+  struct ducache_dir *cdir;
+  size_t cdir_alloc;
+
+  /* Where to write this walk's output lines.  */
+  FILE *out;
+};
+
+/* Maximum number of threads traversing the immediate children of one
+   directory operand; 1 means a single serial traversal.  */
+static size_t nthreads = 1;
+
+/* The --cache index file name, or NULL without --cache.  */
+static char const *cache_file;
+
+/* If true, maintain the on-disk index named by --cache.  */
+static bool opt_cache = false;
+
+/* If true, skip the direct non-directory entries of directories whose
+   cache records validate.  False when a walk may legitimately revisit
+   files that a cached aggregate also counts (multiple operands,
+   --files0-from) or must list them individually (--all); the index is
+   still brought up to date in those cases.  */
+static bool cache_consult = false;
+
+/* The cache records, keyed by dev/ino.  */
+static Hash_table *ducache;
+
 /* If true, display counts for all files, not just directories.  */
 static bool opt_all = false;
 
@@ -161,9 +275,20 @@ static intmax_t opt_threshold = 0;
 /* Human-readable options for output.  */
 static int human_output_opts;
 
+/* If true, visit each directory's entries in inode order.  */
+static bool opt_inode_sort = false;
+
 /* Output inodes count instead of blocks used.  */
 static bool opt_inodes = false;
 
+/* If true, report apparent size alongside disk usage, so sparse-file
+   savings are visible per subtree.  */
+static bool opt_sparseness = false;
+
+/* If true, print each record as one JSON object per line, with raw
+   byte counts, instead of formatted columns.  */
+static bool opt_json = false;
+
 /* If true, print most recently modified date, using the specified format.  */
 static bool opt_time = false;
 
@@ -196,6 +321,40 @@ static struct exclude *exclude;
 /* Grand total size of all args, in bytes. Also latest modified date. */
 static struct duinfo tot_dui;
 
+/* If true, report traversal statistics on stderr at exit (--stats).  */
+static bool stats;
+
+/* Counters for --stats.  Worker threads spawned for --threads share
+   them, so they are guarded by stats_lock.  */
+static pthread_mutex_t stats_lock = PTHREAD_MUTEX_INITIALIZER;
+static uintmax_t n_entries;	/* Entries processed.  */
+static uintmax_t n_dirs;	/* Directories read.  */
+
+/* Nonzero when SIGUSR1 has requested an interim statistics report.  */
+static sig_atomic_t volatile stats_requested;
+
+/* Handle SIGUSR1 by requesting an interim --stats report, which the
+   traversal prints at the next entry.  */
+
+static void
+stats_sighandler (int sig)
+{
+  stats_requested = 1;
+}
+
+/* Report the statistics accumulated so far on stderr.  */
+
+static void
+stats_report (void)
+{
+  pthread_mutex_lock (&stats_lock);
+  uintmax_t entries = n_entries;
+  uintmax_t dirs = n_dirs;
+  pthread_mutex_unlock (&stats_lock);
+  error (0, 0, _("%ju entries processed, %ju directories read"),
+         entries, dirs);
+}
+
 #define IS_DIR_TYPE(Type)	\
   ((Type) == FTS_DP		\
    || (Type) == FTS_DNR)
@@ -205,10 +364,16 @@ static struct duinfo tot_dui;
 enum
 {
   APPARENT_SIZE_OPTION = CHAR_MAX + 1,
+  CACHE_OPTION,
   EXCLUDE_OPTION,
   FILES0_FROM_OPTION,
   HUMAN_SI_OPTION,
+  INODE_SORT_OPTION,
+  JSON_OPTION,
   FTS_DEBUG,
+  SPARSENESS_OPTION,
+  STATS_OPTION,
+  THREADS_OPTION,
   TIME_OPTION,
   TIME_STYLE_OPTION,
   INODES_OPTION
@@ -220,6 +385,7 @@ static struct option const long_options[] =
   {"apparent-size", no_argument, NULL, APPARENT_SIZE_OPTION},
   {"block-size", required_argument, NULL, 'B'},
   {"bytes", no_argument, NULL, 'b'},
+  {"cache", required_argument, NULL, CACHE_OPTION},
   {"count-links", no_argument, NULL, 'l'},
   /* {"-debug", no_argument, NULL, FTS_DEBUG}, */
   {"dereference", no_argument, NULL, 'L'},
@@ -228,15 +394,20 @@ static struct option const long_options[] =
   {"exclude-from", required_argument, NULL, 'X'},
   {"files0-from", required_argument, NULL, FILES0_FROM_OPTION},
   {"human-readable", no_argument, NULL, 'h'},
+  {"inode-sort", no_argument, NULL, INODE_SORT_OPTION},
   {"inodes", no_argument, NULL, INODES_OPTION},
+  {"json", no_argument, NULL, JSON_OPTION},
   {"si", no_argument, NULL, HUMAN_SI_OPTION},
   {"max-depth", required_argument, NULL, 'd'},
   {"null", no_argument, NULL, '0'},
   {"no-dereference", no_argument, NULL, 'P'},
   {"one-file-system", no_argument, NULL, 'x'},
   {"separate-dirs", no_argument, NULL, 'S'},
+  {"sparseness", no_argument, NULL, SPARSENESS_OPTION},
+  {"stats", no_argument, NULL, STATS_OPTION},
   {"summarize", no_argument, NULL, 's'},
   {"total", no_argument, NULL, 'c'},
+  {"threads", required_argument, NULL, THREADS_OPTION},
   {"threshold", required_argument, NULL, 't'},
   {"time", optional_argument, NULL, TIME_OPTION},
   {"time-style", required_argument, NULL, TIME_STYLE_OPTION},
@@ -306,6 +477,9 @@ Summarize disk usage of the set of FILEs, recursively for directories.\n\
                            '-BM' prints sizes in units of 1,048,576 bytes;\n\
                            see SIZE format below\n\
   -b, --bytes           equivalent to '--apparent-size --block-size=1'\n\
+      --cache=FILE      maintain in FILE an index of per-directory totals,\n\
+                          and use it to avoid examining the files of\n\
+                          directories whose timestamps have not changed\n\
   -c, --total           produce a grand total\n\
   -D, --dereference-args  dereference only symlinks that are listed on the\n\
                           command line\n\
@@ -321,7 +495,10 @@ Summarize disk usage of the set of FILEs, recursively for directories.\n\
   -H                    equivalent to --dereference-args (-D)\n\
   -h, --human-readable  print sizes in human readable format (e.g., 1K 234M 2G)\
 \n\
+      --inode-sort      process each directory's entries in inode order\n\
       --inodes          list inode usage information instead of block usage\n\
+      --json            print each record as one JSON object per line, with\n\
+                          raw byte counts, as each subtree completes\n\
 "), stdout);
       fputs (_("\
   -k                    like --block-size=1K\n\
@@ -333,11 +510,17 @@ Summarize disk usage of the set of FILEs, recursively for directories.\n\
   -P, --no-dereference  don't follow any symbolic links (this is the default)\n\
   -S, --separate-dirs   for directories do not include size of subdirectories\n\
       --si              like -h, but use powers of 1000 not 1024\n\
+      --sparseness      also print each entry's apparent size, in a second\n\
+                          column, to expose sparse-file savings\n\
   -s, --summarize       display only a total for each argument\n\
+      --stats           report traversal statistics on stderr at exit;\n\
+                          SIGUSR1 requests an interim report\n\
 "), stdout);
       fputs (_("\
   -t, --threshold=SIZE  exclude entries smaller than SIZE if positive,\n\
                           or entries greater than SIZE if negative\n\
+      --threads=N       traverse the immediate subdirectories of each\n\
+                          directory operand with up to N threads\n\
       --time            show time of the last modification of any file in the\n\
                           directory, or any of its subdirectories\n\
       --time=WORD       show time as WORD instead of modification time:\n\
@@ -363,10 +546,18 @@ Summarize disk usage of the set of FILEs, recursively for directories.\n\
 /* Try to insert the INO/DEV pair into DI_SET.
    Return true if the pair is successfully inserted,
    false if the pair was already there.  */
+/* Serialize di_set updates among --threads workers.  */
+static pthread_mutex_t di_lock = PTHREAD_MUTEX_INITIALIZER;
+
 static bool
 hash_ins (struct di_set *di_set, ino_t ino, dev_t dev)
 {
-  int inserted = di_set_insert (di_set, dev, ino);
+  int inserted;
+  if (1 < nthreads)
+    pthread_mutex_lock (&di_lock);
+  inserted = di_set_insert (di_set, dev, ino);
+  if (1 < nthreads)
+    pthread_mutex_unlock (&di_lock);
   if (inserted < 0)
     xalloc_die ();
   return inserted;
@@ -377,49 +568,101 @@ hash_ins (struct di_set *di_set, ino_t ino, dev_t dev)
    in FORMAT.  */
 
 static void
-show_date (char const *format, struct timespec when, timezone_t tz)
+show_date (FILE *out, char const *format, struct timespec when, timezone_t tz)
 {
   struct tm tm;
   if (localtime_rz (tz, &when.tv_sec, &tm))
-    fprintftime (stdout, format, &tm, tz, when.tv_nsec);
+    fprintftime (out, format, &tm, tz, when.tv_nsec);
   else
     {
       char buf[INT_BUFSIZE_BOUND (intmax_t)];
       char *when_str = timetostr (when.tv_sec, buf);
       error (0, 0, _("time %s is out of range"), quote (when_str));
-      fputs (when_str, stdout);
+      fputs (when_str, out);
     }
 }
 
 /* Print N_BYTES.  Convert it to a readable value before printing.  */
 
 static void
-print_only_size (uintmax_t n_bytes)
+print_only_size (FILE *out, uintmax_t n_bytes)
 {
   char buf[LONGEST_HUMAN_READABLE + 1];
   fputs ((n_bytes == UINTMAX_MAX
           ? _("Infinity")
           : human_readable (n_bytes, buf, human_output_opts,
                             1, output_block_size)),
-         stdout);
+         out);
+}
+
+/* Print *PDUI as one JSON object on OUT.  STRING is the entry name,
+   or NULL for the grand total.  The values are raw counts, not
+   scaled by the output block size.  A line is emitted as soon as a
+   subtree completes, and flushed, so consumers can aggregate while
+   the traversal is still running.  */
+
+static void
+print_json_record (FILE *out, const struct duinfo *pdui, char const *string)
+{
+  if (string)
+    {
+      fputs ("{\"path\":", out);
+      json_fputs_quoted (string, out);
+    }
+  else
+    fputs ("{\"total\":true", out);
+
+  uintmax_t v = opt_inodes ? pdui->inodes : pdui->size;
+  char const *key = opt_inodes ? "inodes" : "size";
+  if (v == UINTMAX_MAX)
+    fprintf (out, ",\"%s\":null", key);
+  else
+    fprintf (out, ",\"%s\":%ju", key, v);
+
+  if (opt_sparseness)
+    {
+      if (pdui->apparent == UINTMAX_MAX)
+        fputs (",\"apparent\":null", out);
+      else
+        fprintf (out, ",\"apparent\":%ju", pdui->apparent);
+    }
+
+  if (opt_time)
+    fprintf (out, ",\"time_sec\":%jd,\"time_nsec\":%ld",
+             (intmax_t) pdui->tmax.tv_sec, (long int) pdui->tmax.tv_nsec);
+
+  fputs ("}\n", out);
+  fflush (out);
 }
 
 /* Print size (and optionally time) indicated by *PDUI, followed by STRING.  */
 
 static void
-print_size (const struct duinfo *pdui, char const *string)
+print_size (FILE *out, const struct duinfo *pdui, char const *string)
 {
-  print_only_size (opt_inodes
-                   ? pdui->inodes
-                   : pdui->size);
+  if (opt_json)
+    {
+      print_json_record (out, pdui, string);
+      return;
+    }
+
+  print_only_size (out, opt_inodes
+                        ? pdui->inodes
+                        : pdui->size);
+
+  if (opt_sparseness)
+    {
+      putc ('\t', out);
+      print_only_size (out, pdui->apparent);
+    }
 
   if (opt_time)
     {
-      putchar ('\t');
-      show_date (time_format, pdui->tmax, localtz);
+      putc ('\t', out);
+      show_date (out, time_format, pdui->tmax, localtz);
     }
-  printf ("\t%s%c", string, opt_nul_terminate_output ? '\0' : '\n');
-  fflush (stdout);
+  fprintf (out, "\t%s%c", string, opt_nul_terminate_output ? '\0' : '\n');
+  fflush (out);
 }
 
 /* Fill the di_mnt set with local mount point dev/ino pairs.  */
@@ -480,19 +723,283 @@ mount_point_in_fts_cycle (FTSENT const *ent)
   return false;
 }
 
+/* The leading bytes of a --cache index file.  The stored record size
+   follows, so that an index from a different machine or build is
+   recognized and ignored rather than misread.  */
+static char const ducache_magic[] = "GNU du cache 1\n";
+
+static size_t
+ducache_hash (void const *x, size_t table_size)
+{
+  struct ducache_ent const *e = x;
+  return (e->ino ^ e->dev) % table_size;
+}
+
+static bool
+ducache_compare (void const *x, void const *y)
+{
+  struct ducache_ent const *a = x;
+  struct ducache_ent const *b = y;
+  return a->ino == b->ino && a->dev == b->dev;
+}
+
+/* Read the --cache index into the DUCACHE table.  A missing file is
+   simply an empty index; an unrecognized one is diagnosed and
+   rebuilt.  */
+
+static void
+ducache_load (void)
+{
+  ducache = hash_initialize (61, NULL, ducache_hash, ducache_compare, free);
+  if (! ducache)
+    xalloc_die ();
+
+  FILE *f = fopen (cache_file, "r");
+  if (! f)
+    {
+      if (errno != ENOENT)
+        die (EXIT_FAILURE, errno, _("cannot open %s for reading"),
+             quoteaf (cache_file));
+      return;
+    }
+
+  char magic[sizeof ducache_magic - 1];
+  uintmax_t recsize;
+  if (fread (magic, 1, sizeof magic, f) != sizeof magic
+      || memcmp (magic, ducache_magic, sizeof magic) != 0
+      || fread (&recsize, sizeof recsize, 1, f) != 1
+      || recsize != sizeof (struct ducache_ent))
+    error (0, 0, _("ignoring unrecognized cache file %s"),
+           quoteaf (cache_file));
+  else
+    while (true)
+      {
+        struct ducache_ent *e = xmalloc (sizeof *e);
+        if (fread (e, sizeof *e, 1, f) != 1)
+          {
+            free (e);
+            break;
+          }
+        struct ducache_ent *prev = hash_insert (ducache, e);
+        if (! prev)
+          xalloc_die ();
+        if (prev != e)
+          free (e);
+      }
+
+  if (ferror (f))
+    die (EXIT_FAILURE, errno, _("error reading %s"), quoteaf (cache_file));
+  fclose (f);
+}
+
+static bool
+ducache_write_ent (void *ent, void *f)
+{
+  return fwrite (ent, sizeof (struct ducache_ent), 1, f) == 1;
+}
+
+/* Rewrite the --cache index from the DUCACHE table.
+   Return true if successful.  */
+
+static bool
+ducache_save (void)
+{
+  FILE *f = fopen (cache_file, "w");
+  if (! f)
+    {
+      error (0, errno, _("cannot create %s"), quoteaf (cache_file));
+      return false;
+    }
+
+  uintmax_t recsize = sizeof (struct ducache_ent);
+  fwrite (ducache_magic, 1, sizeof ducache_magic - 1, f);
+  fwrite (&recsize, sizeof recsize, 1, f);
+  hash_do_for_each (ducache, ducache_write_ent, f);
+
+  bool ok = ! ferror (f);
+  if (fclose (f) != 0)
+    ok = false;
+  if (! ok)
+    error (0, errno, _("error writing %s"), quoteaf (cache_file));
+  return ok;
+}
+
+/* Return the cache record for the directory *SB if its timestamps
+   still match, else NULL.  */
+
+static struct ducache_ent const *
+ducache_lookup (struct stat const *sb)
+{
+  struct ducache_ent key;
+  key.dev = sb->st_dev;
+  key.ino = sb->st_ino;
+  struct ducache_ent const *e = hash_lookup (ducache, &key);
+  if (e
+      && timespec_cmp (e->mtime, get_stat_mtime (sb)) == 0
+      && timespec_cmp (e->ctime, get_stat_ctime (sb)) == 0)
+    return e;
+  return NULL;
+}
+
+/* Insert or update the cache record for the directory *SB, whose
+   direct non-directory entries AGG describes.  */
+
+static void
+ducache_store (struct stat const *sb, struct ducache_ent const *agg)
+{
+  struct ducache_ent *e = xzalloc (sizeof *e);
+  e->blocks = agg->blocks;
+  e->apparent = agg->apparent;
+  e->inodes = agg->inodes;
+  for (int i = 0; i < 3; i++)
+    e->tmax[i] = agg->tmax[i];
+  e->dev = sb->st_dev;
+  e->ino = sb->st_ino;
+  e->mtime = get_stat_mtime (sb);
+  e->ctime = get_stat_ctime (sb);
+
+  struct ducache_ent *prev = hash_insert (ducache, e);
+  if (! prev)
+    xalloc_die ();
+  if (prev != e)
+    {
+      *prev = *e;
+      free (e);
+    }
+}
+
+/* Derive the directory data of a cached aggregate E under the current
+   options.  */
+
+static void
+ducache_get_dui (struct ducache_ent const *e, struct duinfo *dui)
+{
+  dui->size = apparent_size ? e->apparent : e->blocks;
+  dui->apparent = e->apparent;
+  dui->inodes = e->inodes;
+  dui->tmax = e->tmax[time_type];
+}
+
+/* Account for the direct non-directory entry *SB of the directory that
+   CDIR describes.  */
+
+static void
+ducache_note_child (struct ducache_dir *cdir, struct stat const *sb)
+{
+  struct ducache_ent *agg = &cdir->agg;
+
+  uintmax_t sum = agg->blocks + (uintmax_t) ST_NBLOCKS (*sb) * ST_NBLOCKSIZE;
+  agg->blocks = agg->blocks <= sum ? sum : UINTMAX_MAX;
+  sum = agg->apparent + MAX (0, sb->st_size);
+  agg->apparent = agg->apparent <= sum ? sum : UINTMAX_MAX;
+  agg->inodes++;
+
+  struct timespec t[3];
+  t[time_mtime] = get_stat_mtime (sb);
+  t[time_ctime] = get_stat_ctime (sb);
+  t[time_atime] = get_stat_atime (sb);
+  for (int i = 0; i < 3; i++)
+    if (timespec_cmp (agg->tmax[i], t[i]) < 0)
+      agg->tmax[i] = t[i];
+
+  /* Caching a multiply linked file could count it both from a record
+     and from a traversal elsewhere, so leave its directory out of the
+     index.  */
+  if (1 < sb->st_nlink)
+    cdir->cacheable = false;
+}
+
+/* Begin reading the directory ENT at its level: reset the aggregate
+   under construction, and look up a still-valid record for it.  */
+
+static void
+ducache_enter_dir (struct dustate *state, FTSENT const *ent)
+{
+  size_t level = ent->fts_level;
+  if (state->cdir_alloc <= level)
+    {
+      state->cdir = xnrealloc (state->cdir, level + 1,
+                               2 * sizeof *state->cdir);
+      state->cdir_alloc = 2 * (level + 1);
+    }
+
+  struct ducache_dir *cdir = &state->cdir[level];
+  memset (&cdir->agg, 0, sizeof cdir->agg);
+  for (int i = 0; i < 3; i++)
+    {
+      cdir->agg.tmax[i].tv_sec = TYPE_MINIMUM (time_t);
+      cdir->agg.tmax[i].tv_nsec = -1;
+    }
+  cdir->cacheable = true;
+  cdir->hit = cache_consult ? ducache_lookup (ent->fts_statp) : NULL;
+}
+
+/* Note that an entry of the directory at level LEVEL - 1 was not
+   counted the ordinary way, so no new record may be stored for it.  */
+
+static void
+ducache_mark_uncacheable (struct dustate *state, size_t level)
+{
+  if (opt_cache && 0 < level)
+    state->cdir[level - 1].cacheable = false;
+}
+
+#if USE_STATX
+/* The statx fields needed under the current options.  Restricting the
+   request matters on some network file systems, where unneeded
+   attributes can cost extra server round trips.  */
+
+static unsigned int _GL_ATTRIBUTE_PURE
+du_stat_mask (void)
+{
+  /* The type distinguishes directories; the link count and inode
+     detect hard links.  The device number is always provided.  */
+  unsigned int mask = STATX_TYPE | STATX_NLINK | STATX_INO;
+
+  if (opt_cache)
+    /* Cache records aggregate both size bases and every time type.  */
+    return mask | STATX_SIZE | STATX_BLOCKS
+           | STATX_ATIME | STATX_MTIME | STATX_CTIME;
+
+  if (! opt_inodes)
+    mask |= apparent_size ? STATX_SIZE : STATX_BLOCKS;
+  if (opt_sparseness)
+    mask |= STATX_SIZE | STATX_BLOCKS;
+  if (opt_time)
+    mask |= (time_type == time_mtime ? STATX_MTIME
+             : time_type == time_atime ? STATX_ATIME
+             : STATX_CTIME);
+  return mask;
+}
+
+/* Fill ENT's stat buffer via statx, requesting only the fields du
+   will read.  Return 0 if successful, -1 (setting errno) if not.  */
+
+static int
+du_statx (FTSENT *ent)
+{
+  struct statx stx = { 0, };
+  if (statx (AT_FDCWD, ent->fts_accpath,
+             AT_SYMLINK_NOFOLLOW | AT_NO_AUTOMOUNT,
+             du_stat_mask (), &stx) != 0)
+    return -1;
+  statx_to_stat (&stx, ent->fts_statp);
+  return 0;
+}
+#endif
+
 /* This function is called once for every file system object that fts
    encounters.  fts does a depth-first traversal.  This function knows
    that and accumulates per-directory totals based on changes in
    the depth of the current entry.  It returns true on success.  */
 
 static bool
-process_file (FTS *fts, FTSENT *ent)
+process_file (FTS *fts, FTSENT *ent, struct dustate *state)
 {
   bool ok = true;
   struct duinfo dui;
   struct duinfo dui_to_print;
   size_t level;
-  static size_t n_alloc;
   /* First element of the structure contains:
      The sum of the st_size values of all entries in the single directory
      at the corresponding level.  Although this does include the st_size
@@ -501,12 +1008,25 @@ process_file (FTS *fts, FTSENT *ent)
      Second element of the structure contains:
      The sum of the sizes of all entries in the hierarchy at or below the
      directory at the specified level.  */
-  static struct dulevel *dulvl;
 
   char const *file = ent->fts_path;
   const struct stat *sb = ent->fts_statp;
   int info = ent->fts_info;
 
+  if (stats)
+    {
+      pthread_mutex_lock (&stats_lock);
+      n_entries += info != FTS_DP;
+      n_dirs += info == FTS_DP || info == FTS_DNR;
+      pthread_mutex_unlock (&stats_lock);
+
+      if (stats_requested)
+        {
+          stats_requested = 0;
+          stats_report ();
+        }
+    }
+
   if (info == FTS_DNR)
     {
       /* An error occurred, but the size is known, so count it.  */
@@ -515,6 +1035,13 @@ process_file (FTS *fts, FTSENT *ent)
     }
   else if (info != FTS_DP)
     {
+      /* The record of a validated directory already counts its direct
+         non-directory entries; skip them, statted or not.  */
+      if (opt_cache && 0 < ent->fts_level
+          && info != FTS_D && info != FTS_DC
+          && state->cdir[ent->fts_level - 1].hit)
+        return true;
+
       bool excluded = excluded_file_name (exclude, file);
       if (! excluded)
         {
@@ -522,15 +1049,25 @@ process_file (FTS *fts, FTSENT *ent)
 
           if (info == FTS_NSOK)
             {
+#if USE_STATX
+              if (du_statx (ent) != 0)
+                {
+                  error (0, errno, _("cannot access %s"), quoteaf (file));
+                  ducache_mark_uncacheable (state, ent->fts_level);
+                  return false;
+                }
+#else
               fts_set (fts, ent, FTS_AGAIN);
               FTSENT const *e = fts_read (fts);
               assert (e == ent);
               info = ent->fts_info;
+#endif
             }
 
           if (info == FTS_NS || info == FTS_SLNONE)
             {
               error (0, ent->fts_errno, _("cannot access %s"), quoteaf (file));
+              ducache_mark_uncacheable (state, ent->fts_level);
               return false;
             }
 
@@ -559,6 +1096,8 @@ process_file (FTS *fts, FTSENT *ent)
               FTSENT const *e = fts_read (fts);
               assert (e == ent);
             }
+          else
+            ducache_mark_uncacheable (state, ent->fts_level);
 
           return true;
         }
@@ -566,11 +1105,14 @@ process_file (FTS *fts, FTSENT *ent)
       switch (info)
         {
         case FTS_D:
+          if (opt_cache)
+            ducache_enter_dir (state, ent);
           return true;
 
         case FTS_ERR:
           /* An error occurred, but the size is known, so count it.  */
           error (0, ent->fts_errno, "%s", quotef (file));
+          ducache_mark_uncacheable (state, ent->fts_level);
           ok = false;
           break;
 
@@ -590,6 +1132,7 @@ process_file (FTS *fts, FTSENT *ent)
               (apparent_size
                ? MAX (0, sb->st_size)
                : (uintmax_t) ST_NBLOCKS (*sb) * ST_NBLOCKSIZE),
+              MAX (0, sb->st_size),
               (time_type == time_mtime ? get_stat_mtime (sb)
                : time_type == time_atime ? get_stat_atime (sb)
                : get_stat_ctime (sb)));
@@ -597,34 +1140,57 @@ process_file (FTS *fts, FTSENT *ent)
   level = ent->fts_level;
   dui_to_print = dui;
 
-  if (n_alloc == 0)
+  if (opt_cache && 0 < level && ! IS_DIR_TYPE (info))
+    ducache_note_child (&state->cdir[level - 1], sb);
+
+  /* When a directory's record validated in preorder, its skipped
+     direct entries are accounted for here in postorder, as if each had
+     been processed at LEVEL + 1.  If subdirectories were traversed,
+     merge the cached aggregate into their sums so that the ascent
+     below propagates it; otherwise inject it after the level
+     accumulators are known to be set up.  */
+  bool cache_hit = opt_cache && info == FTS_DP && state->cdir[level].hit;
+  bool cache_propagated = cache_hit && level < state->prev_level;
+  struct duinfo cache_dui;
+  if (cache_hit)
     {
-      n_alloc = level + 10;
-      dulvl = xcalloc (n_alloc, sizeof *dulvl);
+      ducache_get_dui (state->cdir[level].hit, &cache_dui);
+      duinfo_add (&state->tot, &cache_dui);
+      if (cache_propagated)
+        duinfo_add (&state->dulvl[state->prev_level].ent, &cache_dui);
+    }
+  else if (opt_cache && info == FTS_DP && state->cdir[level].cacheable)
+    ducache_store (sb, &state->cdir[level].agg);
+
+  if (state->n_alloc == 0)
+    {
+      state->n_alloc = level + 10;
+      state->dulvl = xcalloc (state->n_alloc, sizeof *state->dulvl);
     }
   else
     {
-      if (level == prev_level)
+      if (level == state->prev_level)
         {
           /* This is usually the most common case.  Do nothing.  */
         }
-      else if (level > prev_level)
+      else if (level > state->prev_level)
         {
           /* Descending the hierarchy.
              Clear the accumulators for *all* levels between prev_level
              and the current one.  The depth may change dramatically,
              e.g., from 1 to 10.  */
 
-          if (n_alloc <= level)
+          if (state->n_alloc <= level)
             {
-              dulvl = xnrealloc (dulvl, level, 2 * sizeof *dulvl);
-              n_alloc = level * 2;
+              state->dulvl = xnrealloc (state->dulvl, level,
+                                        2 * sizeof *state->dulvl);
+              state->n_alloc = level * 2;
             }
 
-          for (size_t i = prev_level + 1; i <= level; i++)
+          for (size_t i = state->prev_level + 1; i <= level; i++)
             {
-              duinfo_init (&dulvl[i].ent);
-              duinfo_init (&dulvl[i].subdir);
+              duinfo_init (&state->dulvl[i].ent);
+              duinfo_init (&state->dulvl[i].subdir);
             }
         }
       else /* level < prev_level */
@@ -635,54 +1201,70 @@ process_file (FTS *fts, FTSENT *ent)
              propagate sums from the children (prev_level) to the parent.
              Here, the current level is always one smaller than the
              previous one.  */
-          assert (level == prev_level - 1);
-          duinfo_add (&dui_to_print, &dulvl[prev_level].ent);
+          assert (level == state->prev_level - 1);
+          duinfo_add (&dui_to_print, &state->dulvl[state->prev_level].ent);
           if (!opt_separate_dirs)
-            duinfo_add (&dui_to_print, &dulvl[prev_level].subdir);
-          duinfo_add (&dulvl[level].subdir, &dulvl[prev_level].ent);
-          duinfo_add (&dulvl[level].subdir, &dulvl[prev_level].subdir);
+            duinfo_add (&dui_to_print,
+                        &state->dulvl[state->prev_level].subdir);
+          duinfo_add (&state->dulvl[level].subdir,
+                      &state->dulvl[state->prev_level].ent);
+          duinfo_add (&state->dulvl[level].subdir,
+                      &state->dulvl[state->prev_level].subdir);
         }
     }
 
-  prev_level = level;
+  state->prev_level = level;
+
+  if (cache_hit && ! cache_propagated)
+    {
+      duinfo_add (&dui_to_print, &cache_dui);
+      duinfo_add (&state->dulvl[level].subdir, &cache_dui);
+    }
 
   /* Let the size of a directory entry contribute to the total for the
      containing directory, unless --separate-dirs (-S) is specified.  */
   if (! (opt_separate_dirs && IS_DIR_TYPE (info)))
-    duinfo_add (&dulvl[level].ent, &dui);
+    duinfo_add (&state->dulvl[level].ent, &dui);
 
   /* Even if this directory is unreadable or we can't chdir into it,
      do let its size contribute to the total. */
-  duinfo_add (&tot_dui, &dui);
+  duinfo_add (&state->tot, &dui);
+
+  if (level == 0)
+    state->root_is_dir = IS_DIR_TYPE (info);
+
+  /* Print according to the depth below the command-line operand, which
+     for a --threads walk is one more than the depth in this walk.  */
+  size_t out_level = level + state->level_offset;
 
-  if ((IS_DIR_TYPE (info) && level <= max_depth)
-      || (opt_all && level <= max_depth)
-      || level == 0)
+  if ((IS_DIR_TYPE (info) && out_level <= max_depth)
+      || (opt_all && out_level <= max_depth)
+      || out_level == 0)
     {
       /* Print or elide this entry according to the --threshold option.  */
       uintmax_t v = opt_inodes ? dui_to_print.inodes : dui_to_print.size;
       if (opt_threshold < 0
           ? v <= -opt_threshold
           : v >= opt_threshold)
-        print_size (&dui_to_print, file);
+        print_size (state->out, &dui_to_print, file);
     }
 
   return ok;
 }
 
-/* Recursively print the sizes of the directories (and, if selected, files)
-   named in FILES, the last entry of which is NULL.
-   BIT_FLAGS controls how fts works.
+/* Traverse the hierarchies named in FILES, the last entry of which is
+   NULL, accumulating into STATE.  BIT_FLAGS controls how fts works.
    Return true if successful.  */
 
 static bool
-du_files (char **files, int bit_flags)
+du_walk (char **files, int bit_flags, struct dustate *state)
 {
   bool ok = true;
 
   if (*files)
     {
-      FTS *fts = xfts_open (files, bit_flags, NULL);
+      FTS *fts = xfts_open (files, bit_flags,
+                            opt_inode_sort ? xfts_compare_ino : NULL);
 
       while (1)
         {
@@ -698,15 +1280,15 @@ du_files (char **files, int bit_flags)
                   ok = false;
                 }
 
-              /* When exiting this loop early, be careful to reset the
-                 global, prev_level, used in process_file.  Otherwise, its
+              /* When exiting this loop early, be careful to reset
+                 state->prev_level, used in process_file.  Otherwise, its
                  (level == prev_level - 1) assertion could fail.  */
-              prev_level = 0;
+              state->prev_level = 0;
               break;
             }
           FTS_CROSS_CHECK (fts);
 
-          ok &= process_file (fts, ent);
+          ok &= process_file (fts, ent, state);
         }
 
       if (fts_close (fts) != 0)
@@ -719,6 +1301,211 @@ du_files (char **files, int bit_flags)
   return ok;
 }
 
+/* Recursively print the sizes of the directories (and, if selected, files)
+   named in FILES, the last entry of which is NULL.
+   BIT_FLAGS controls how fts works.
+   Return true if successful.  */
+
+static bool
+du_files (char **files, int bit_flags)
+{
+  struct dustate state = { 0, };
+  duinfo_init (&state.tot);
+  state.out = stdout;
+
+  bool ok = du_walk (files, bit_flags, &state);
+
+  duinfo_add (&tot_dui, &state.tot);
+  free (state.dulvl);
+  free (state.cdir);
+  return ok;
+}
+
+/* Work shared by the threads traversing the children of one directory
+   operand.  Each child is walked independently, buffering its output,
+   so that the merged result matches a serial traversal.  */
+struct du_pool
+{
+  pthread_mutex_t mutex;	/* Guards NEXT and OK.  */
+  char **paths;			/* The child paths, in directory order.  */
+  size_t n_paths;
+  size_t next;			/* Index of the next unclaimed child.  */
+  int bit_flags;		/* fts options for the walks.  */
+  char **buf;			/* Per-child buffered output lines.  */
+  size_t *buf_size;
+  struct duinfo *tot;		/* Per-child walk totals.  */
+  bool *is_dir;			/* Whether each child is a directory.  */
+  bool ok;
+};
+
+static void *
+du_thread (void *arg)
+{
+  struct du_pool *pool = arg;
+
+  while (true)
+    {
+      pthread_mutex_lock (&pool->mutex);
+      size_t i = pool->next++;
+      pthread_mutex_unlock (&pool->mutex);
+      if (pool->n_paths <= i)
+        return NULL;
+
+      struct dustate state = { 0, };
+      duinfo_init (&state.tot);
+      state.level_offset = 1;
+      state.out = open_memstream (&pool->buf[i], &pool->buf_size[i]);
+      if (! state.out)
+        xalloc_die ();
+
+      char *argv1[] = { pool->paths[i], NULL };
+      bool ok = du_walk (argv1, pool->bit_flags, &state);
+      if (fclose (state.out) != 0)
+        ok = false;
+
+      pool->tot[i] = state.tot;
+      pool->is_dir[i] = state.root_is_dir;
+      free (state.dulvl);
+      free (state.cdir);
+
+      if (! ok)
+        {
+          pthread_mutex_lock (&pool->mutex);
+          pool->ok = false;
+          pthread_mutex_unlock (&pool->mutex);
+        }
+    }
+}
+
+/* Traverse the directory operand FILE with up to NTHREADS worker
+   threads, one immediate child of FILE per walk.  Return true if the
+   operand was fully handled, false if the caller should fall back to
+   the serial traversal.  Update *OK as du_files would.  */
+
+static bool
+du_files_parallel (char *file, int bit_flags, bool *ok)
+{
+  /* Walk roots matter to -x (device comparisons) and to -L (cycle
+     detection through the lazily built mount table), so leave those
+     modes to the serial traversal.  The same goes for --cache, whose
+     table updates are not serialized among workers.  */
+  if (bit_flags & (FTS_XDEV | FTS_LOGICAL))
+    return false;
+  if (opt_cache)
+    return false;
+
+  struct stat sb;
+  if (lstat (file, &sb) != 0 || ! S_ISDIR (sb.st_mode))
+    return false;
+
+  /* Handle the cases where the serial walk would skip this hierarchy
+     entirely.  */
+  if (excluded_file_name (exclude, file))
+    return true;
+  if (! opt_count_all && hash_all
+      && ! hash_ins (di_files, sb.st_ino, sb.st_dev))
+    return true;
+
+  DIR *dirp = opendir (file);
+  if (! dirp)
+    return false;		/* Let the serial walk diagnose this.  */
+
+  size_t n_paths = 0;
+  size_t n_alloc = 0;
+  char **paths = NULL;
+
+  while (true)
+    {
+      errno = 0;
+      struct dirent const *dp = readdir (dirp);
+      if (! dp)
+        break;
+      if (dp->d_name[0] == '.'
+          && (dp->d_name[1] == '\0'
+              || (dp->d_name[1] == '.' && dp->d_name[2] == '\0')))
+        continue;
+      if (n_paths == n_alloc)
+        paths = x2nrealloc (paths, &n_alloc, sizeof *paths);
+      paths[n_paths++] = file_name_concat (file, dp->d_name, NULL);
+    }
+  if (errno != 0)
+    {
+      error (0, errno, _("cannot read directory %s"), quoteaf (file));
+      *ok = false;
+    }
+  closedir (dirp);
+
+  struct du_pool pool = { PTHREAD_MUTEX_INITIALIZER, paths, n_paths, 0,
+                          bit_flags,
+                          xnmalloc (n_paths, sizeof *pool.buf),
+                          xnmalloc (n_paths, sizeof *pool.buf_size),
+                          xnmalloc (n_paths, sizeof *pool.tot),
+                          xcalloc (n_paths, sizeof *pool.is_dir),
+                          true };
+
+  size_t nworkers = MIN (nthreads, n_paths);
+  pthread_t *threads = xnmalloc (nworkers ? nworkers - 1 : 0,
+                                 sizeof *threads);
+  size_t started = 0;
+
+  /* This thread is a worker too; if a thread cannot be created, the
+     others simply pick up the remaining children.  */
+  for (size_t i = 0; i + 1 < nworkers; i++)
+    {
+      if (pthread_create (&threads[started], NULL, du_thread, &pool) != 0)
+        break;
+      started++;
+    }
+  if (n_paths != 0)
+    du_thread (&pool);
+  for (size_t i = 0; i < started; i++)
+    pthread_join (threads[i], NULL);
+  free (threads);
+
+  /* The operand's own entry.  */
+  struct duinfo dui;
+  duinfo_set (&dui,
+              (apparent_size
+               ? MAX (0, sb.st_size)
+               : (uintmax_t) ST_NBLOCKS (sb) * ST_NBLOCKSIZE),
+              MAX (0, sb.st_size),
+              (time_type == time_mtime ? get_stat_mtime (&sb)
+               : time_type == time_atime ? get_stat_atime (&sb)
+               : get_stat_ctime (&sb)));
+  struct duinfo dui_to_print = dui;
+  duinfo_add (&tot_dui, &dui);
+
+  for (size_t i = 0; i < n_paths; i++)
+    {
+      /* Print each child's buffered lines in directory order, matching
+         the postorder of one serial walk.  */
+      fwrite (pool.buf[i], 1, pool.buf_size[i], stdout);
+      free (pool.buf[i]);
+
+      duinfo_add (&tot_dui, &pool.tot[i]);
+      if (! (opt_separate_dirs && pool.is_dir[i]))
+        duinfo_add (&dui_to_print, &pool.tot[i]);
+      free (paths[i]);
+    }
+
+  /* Print or elide the operand according to the --threshold option.  */
+  uintmax_t v = opt_inodes ? dui_to_print.inodes : dui_to_print.size;
+  if (opt_threshold < 0
+      ? v <= -opt_threshold
+      : v >= opt_threshold)
+    print_size (stdout, &dui_to_print, file);
+
+  if (! pool.ok)
+    *ok = false;
+
+  free (paths);
+  free (pool.buf);
+  free (pool.buf_size);
+  free (pool.tot);
+  free (pool.is_dir);
+  return true;
+}
+
 int
 main (int argc, char **argv)
 {
@@ -726,6 +1513,7 @@ main (int argc, char **argv)
   bool max_depth_specified = false;
   bool ok = true;
   char *files_from = NULL;
+  bool have_exclude = false;
 
   /* Bit flags that control how fts works.  */
   int bit_flags = FTS_NOSTAT;
@@ -787,6 +1575,11 @@ main (int argc, char **argv)
           output_block_size = 1;
           break;
 
+        case CACHE_OPTION:
+          cache_file = optarg;
+          opt_cache = true;
+          break;
+
         case 'c':
           print_grand_total = true;
           break;
@@ -855,6 +1648,15 @@ main (int argc, char **argv)
           bit_flags |= FTS_XDEV;
           break;
 
+        case STATS_OPTION:
+          stats = true;
+          break;
+
+        case THREADS_OPTION:
+          nthreads = xdectoumax (optarg, 1, SIZE_MAX, "",
+                                 _("invalid number of threads"), 0);
+          break;
+
         case 'B':
           {
             enum strtol_error e = human_options (optarg, &human_output_opts,
@@ -888,6 +1690,7 @@ main (int argc, char **argv)
               error (0, errno, "%s", quotef (optarg));
               ok = false;
             }
+          have_exclude = true;
           break;
 
         case FILES0_FROM_OPTION:
@@ -896,12 +1699,25 @@ main (int argc, char **argv)
 
         case EXCLUDE_OPTION:
           add_exclude (exclude, optarg, EXCLUDE_WILDCARDS);
+          have_exclude = true;
+          break;
+
+        case INODE_SORT_OPTION:
+          opt_inode_sort = true;
+          break;
+
+        case SPARSENESS_OPTION:
+          opt_sparseness = true;
           break;
 
         case INODES_OPTION:
           opt_inodes = true;
           break;
 
+        case JSON_OPTION:
+          opt_json = true;
+          break;
+
         case TIME_OPTION:
           opt_time = true;
           time_type =
@@ -933,6 +1749,21 @@ main (int argc, char **argv)
       usage (EXIT_FAILURE);
     }
 
+  /* Cache records built while dereferencing symlinks, or with some
+     files excluded, would not describe the directories themselves, and
+     would poison later runs.  */
+  if (opt_cache && symlink_deref_bits == FTS_LOGICAL)
+    {
+      error (0, 0, _("cannot use --cache when dereferencing symlinks"));
+      usage (EXIT_FAILURE);
+    }
+
+  if (opt_cache && have_exclude)
+    {
+      error (0, 0, _("cannot use --cache together with --exclude"));
+      usage (EXIT_FAILURE);
+    }
+
   if (opt_summarize_only && max_depth_specified && max_depth == 0)
     {
       error (0, 0,
@@ -956,9 +1787,30 @@ main (int argc, char **argv)
           error (0, 0, _("warning: options --apparent-size and -b are "
                          "ineffective with --inodes"));
         }
+      if (opt_sparseness)
+        {
+          error (0, 0, _("warning: option --sparseness is "
+                         "ineffective with --inodes"));
+          opt_sparseness = false;
+        }
       output_block_size = 1;
     }
 
+  if (stats)
+    {
+      /* Let SIGUSR1 request an interim report; restart interrupted
+         reads so the signal does not perturb the traversal.  */
+#if SA_NOCLDSTOP
+      struct sigaction act;
+      sigemptyset (&act.sa_mask);
+      act.sa_handler = stats_sighandler;
+      act.sa_flags = SA_RESTART;
+      sigaction (SIGUSR1, &act, NULL);
+#else
+      signal (SIGUSR1, stats_sighandler);
+#endif
+    }
+
   /* Process time style if printing last times.  */
   if (opt_time)
     {
@@ -1046,6 +1898,12 @@ main (int argc, char **argv)
   if (!ai)
     xalloc_die ();
 
+  if (opt_cache)
+    {
+      cache_consult = ! hash_all && ! opt_all;
+      ducache_load ();
+    }
+
   /* Initialize the set of dev,inode pairs.  */
   di_files = di_set_alloc ();
   if (!di_files)
@@ -1117,7 +1975,8 @@ main (int argc, char **argv)
 
       if (skip_file)
         ok = false;
-      else
+      else if (nthreads <= 1
+               || ! du_files_parallel (file_name, bit_flags, &ok))
         {
           temp_argv[0] = file_name;
           ok &= du_files (temp_argv, bit_flags);
@@ -1130,11 +1989,25 @@ main (int argc, char **argv)
   if (di_mnt)
     di_set_free (di_mnt);
 
+  if (opt_cache)
+    {
+      ok &= ducache_save ();
+      hash_free (ducache);
+    }
+
   if (files_from && (ferror (stdin) || fclose (stdin) != 0) && ok)
     die (EXIT_FAILURE, 0, _("error reading %s"), quoteaf (files_from));
 
   if (print_grand_total)
-    print_size (&tot_dui, _("total"));
+    {
+      if (opt_json)
+        print_json_record (stdout, &tot_dui, NULL);
+      else
+        print_size (stdout, &tot_dui, _("total"));
+    }
+
+  if (stats)
+    stats_report ();
 
   return ok ? EXIT_SUCCESS : EXIT_FAILURE;
 }
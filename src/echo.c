@@ -120,21 +120,24 @@ main (int argc, char **argv)
 
   initialize_main (&argc, &argv);
   set_program_name (argv[0]);
-  setlocale (LC_ALL, "");
-  bindtextdomain (PACKAGE, LOCALEDIR);
-  textdomain (PACKAGE);
 
   atexit (close_stdout);
 
   /* We directly parse options, rather than use parse_long_options, in
-     order to avoid accepting abbreviations.  */
+     order to avoid accepting abbreviations.  The output is a pure
+     byte operation, so the locale is set up only where translated
+     text can actually be printed.  */
   if (allow_options && argc == 2)
     {
       if (STREQ (argv[1], "--help"))
-        usage (EXIT_SUCCESS);
+        {
+          initialize_locale ();
+          usage (EXIT_SUCCESS);
+        }
 
       if (STREQ (argv[1], "--version"))
         {
+          initialize_locale ();
           version_etc (stdout, PROGRAM_NAME, PACKAGE_NAME, Version, AUTHORS,
                        (char *) NULL);
           return EXIT_SUCCESS;
@@ -45,6 +45,11 @@ static char const **usvars;
 static size_t usvars_alloc;
 static idx_t usvars_used;
 
+/* Array of files to load environment entries from.  */
+static char const **env_files;
+static size_t env_files_alloc;
+static idx_t env_files_used;
+
 /* Annotate the output with extra info to aid the user.  */
 static bool dev_debug;
 
@@ -87,6 +92,7 @@ enum
   IGNORE_SIGNAL_OPTION,
   BLOCK_SIGNAL_OPTION,
   LIST_SIGNAL_HANDLING_OPTION,
+  ENV_FILE_OPTION,
 };
 
 static struct option const longopts[] =
@@ -94,6 +100,7 @@ static struct option const longopts[] =
   {"ignore-environment", no_argument, NULL, 'i'},
   {"null", no_argument, NULL, '0'},
   {"unset", required_argument, NULL, 'u'},
+  {"env-file", required_argument, NULL, ENV_FILE_OPTION},
   {"chdir", required_argument, NULL, 'C'},
   {"default-signal", optional_argument, NULL, DEFAULT_SIGNAL_OPTION},
   {"ignore-signal",  optional_argument, NULL, IGNORE_SIGNAL_OPTION},
@@ -126,6 +133,11 @@ Set each NAME to VALUE in the environment and run COMMAND.\n\
   -i, --ignore-environment  start with an empty environment\n\
   -0, --null           end each output line with NUL, not newline\n\
   -u, --unset=NAME     remove variable from the environment\n\
+"), stdout);
+      fputs (_("\
+      --env-file=FILE  add NUL-terminated NAME=VALUE entries from FILE,\n\
+                        as produced by 'env --null'; with FILE of '-',\n\
+                        read them from standard input\n\
 "), stdout);
       fputs (_("\
   -C, --chdir=DIR      change working directory to DIR\n\
@@ -174,6 +186,61 @@ append_unset_var (char const *var)
   usvars[usvars_used++] = var;
 }
 
+static void
+append_env_file (char const *file)
+{
+  if (env_files_used == env_files_alloc)
+    env_files = x2nrealloc (env_files, &env_files_alloc, sizeof *env_files);
+  env_files[env_files_used++] = file;
+}
+
+/* Put each NAME=VALUE entry of FILE into the environment.  Entries
+   are NUL-terminated, as output by 'env --null', so the whole file is
+   an envp block needing no parsing beyond the terminators; the buffer
+   is referenced by the environment and never freed.  A FILE of "-"
+   reads standard input.  */
+
+static void
+load_env_file (char const *file)
+{
+  bool is_stdin = STREQ (file, "-");
+  int fd = is_stdin ? STDIN_FILENO : open (file, O_RDONLY);
+  if (fd < 0)
+    die (EXIT_CANCELED, errno, _("failed to open %s"), quoteaf (file));
+
+  devmsg ("env-file: %s\n", quoteaf (file));
+
+  idx_t used = 0;
+  size_t alloc = 16 * 1024;
+  char *buf = xmalloc (alloc);
+  for (;;)
+    {
+      if (alloc - used < 2)
+        buf = x2realloc (buf, &alloc);
+      ssize_t n = read (fd, buf + used, alloc - used - 1);
+      if (n < 0)
+        die (EXIT_CANCELED, errno, _("error reading %s"), quoteaf (file));
+      if (n == 0)
+        break;
+      used += n;
+    }
+  if (! is_stdin && close (fd) != 0)
+    die (EXIT_CANCELED, errno, _("failed to close %s"), quoteaf (file));
+  buf[used] = '\0';            /* In case the last entry lacks a NUL.  */
+
+  for (char *entry = buf; entry < buf + used; entry += strlen (entry) + 1)
+    {
+      if (! *entry)
+        continue;
+      if (! strchr (entry, '='))
+        die (EXIT_CANCELED, 0, _("%s: invalid environment entry %s"),
+             quotef (file), quote (entry));
+      devmsg ("setenv:   %s\n", entry);
+      if (putenv (entry))
+        die (EXIT_CANCELED, errno, _("cannot set %s"), quote (entry));
+    }
+}
+
 static void
 unset_envvars (void)
 {
@@ -780,6 +847,9 @@ main (int argc, char **argv)
         case 'u':
           append_unset_var (optarg);
           break;
+        case ENV_FILE_OPTION:
+          append_env_file (optarg);
+          break;
         case 'v':
           dev_debug = true;
           break;
@@ -836,6 +906,11 @@ main (int argc, char **argv)
   else
     unset_envvars ();
 
+  /* Load environment files before the NAME=VALUE operands,
+     so the operands override their entries.  */
+  for (idx_t i = 0; i < env_files_used; ++i)
+    load_env_file (env_files[i]);
+
   char *eq;
   while (optind < argc && (eq = strchr (argv[optind], '=')))
     {
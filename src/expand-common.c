@@ -272,6 +272,16 @@ finalize_tab_stops (void)
     tab_size = tab_list[0];
   else
     tab_size = 0;
+
+  /* '/' and '+' add tab stops beyond the explicit list, with gaps that
+     may exceed any gap within the list itself.  */
+  uintmax_t repeat_size = extend_size ? extend_size : increment_size;
+  if (max_column_width < repeat_size)
+    {
+      if (SIZE_MAX < repeat_size)
+        die (EXIT_FAILURE, 0, _("tabs are too far apart"));
+      max_column_width = repeat_size;
+    }
 }
 
 
@@ -374,6 +384,23 @@ next_file (FILE *fp)
   return NULL;
 }
 
+/* Read up to SIZE bytes into BUF from the stream *FP,
+   switching to the next input file at end of input.
+   Return the number of bytes read; 0 means all input is exhausted
+   and *FP is then NULL.  */
+extern size_t
+fill_input_buffer (FILE **fp, char *buf, size_t size)
+{
+  while (*fp)
+    {
+      size_t n = fread (buf, 1, size, *fp);
+      if (n)
+        return n;
+      *fp = next_file (*fp);
+    }
+  return 0;
+}
+
 /* */
 extern void
 cleanup_file_list_stdin (void)
@@ -67,6 +67,16 @@ set_file_list (char **file_list);
 extern FILE *
 next_file (FILE *fp);
 
+/* Size of the input buffer used by expand and unexpand.  */
+enum { EXPAND_BUFFER_SIZE = 64 * 1024 };
+
+/* Read up to SIZE bytes into BUF from the stream *FP,
+   switching to the next input file at end of input.
+   Return the number of bytes read; 0 means all input is exhausted
+   and *FP is then NULL.  */
+extern size_t
+fill_input_buffer (FILE **fp, char *buf, size_t size);
+
 /* */
 extern void
 cleanup_file_list_stdin (void);
@@ -90,91 +90,155 @@ Convert tabs in each FILE to spaces, writing to standard output.\n\
 }
 
 
+/* Write N bytes from P to stdout, or die.  */
+
+static void
+write_block (char const *p, size_t n)
+{
+  if (fwrite (p, 1, n, stdout) != n)
+    die (EXIT_FAILURE, errno, _("write error"));
+}
+
 /* Change tabs to spaces, writing to stdout.
    Read each file in 'file_list', in order.  */
 
 static void
 expand (void)
 {
+  static char buf[EXPAND_BUFFER_SIZE];
+  static char spaces[512];
+
   /* Input stream.  */
   FILE *fp = next_file (NULL);
 
-  if (!fp)
-    return;
-
-  while (true)
-    {
-      /* Input character, or EOF.  */
-      int c;
+  /* If true, perform translations.  */
+  bool convert = true;
 
-      /* If true, perform translations.  */
-      bool convert = true;
+  /* The following variables have valid values only when CONVERT
+     is true:  */
 
+  /* Column of next input character.  */
+  uintmax_t column = 0;
 
-      /* The following variables have valid values only when CONVERT
-         is true:  */
+  /* Index in TAB_LIST of next tab stop to examine.  */
+  size_t tab_index = 0;
 
-      /* Column of next input character.  */
-      uintmax_t column = 0;
+  size_t len;
 
-      /* Index in TAB_LIST of next tab stop to examine.  */
-      size_t tab_index = 0;
+  if (!fp)
+    return;
 
+  memset (spaces, ' ', sizeof spaces);
 
-      /* Convert a line of text.  */
+  while ((len = fill_input_buffer (&fp, buf, sizeof buf)) != 0)
+    {
+      char const *p = buf;
+      char const *lim = buf + len;
 
-      do
+      while (p < lim)
         {
-          while ((c = getc (fp)) < 0 && (fp = next_file (fp)))
-            continue;
-
-          if (convert)
+          if (! convert)
             {
-              if (c == '\t')
+              /* The rest of the line is copied verbatim.  */
+              char const *nl = memchr (p, '\n', lim - p);
+              size_t n = (nl ? nl + 1 : lim) - p;
+              write_block (p, n);
+              p += n;
+              if (nl)
                 {
-                  /* Column the next input tab stop is on.  */
-                  uintmax_t next_tab_column;
-                  bool last_tab IF_LINT (=0);
+                  convert = true;
+                  column = 0;
+                  tab_index = 0;
+                }
+              continue;
+            }
 
-                  next_tab_column = get_next_tab_column (column, &tab_index,
-                                                         &last_tab);
+          /* Find the run of characters that merely advance the column,
+             so the tab stops need be consulted only at its end.  */
+          char const *q;
+          if (convert_entire_line)
+            {
+              char const *nl = memchr (p, '\n', lim - p);
+              q = nl ? nl : lim;
+              char const *tab = memchr (p, '\t', q - p);
+              if (tab)
+                q = tab;
+              char const *bs = memchr (p, '\b', q - p);
+              if (bs)
+                q = bs;
+            }
+          else
+            {
+              /* With -i, only blanks keep the line in convert mode.  */
+              q = p;
+              while (q < lim && *q == ' ')
+                q++;
+            }
 
-                  if (last_tab)
-                    next_tab_column = column + 1;
+          if (p < q)
+            {
+              size_t n = q - p;
+              if (column + n < column)
+                die (EXIT_FAILURE, 0, _("input line is too long"));
+              column += n;
+              write_block (p, n);
+              p = q;
+              continue;
+            }
 
-                  if (next_tab_column < column)
-                    die (EXIT_FAILURE, 0, _("input line is too long"));
+          unsigned char c = *p++;
+          if (c == '\t')
+            {
+              /* Column the next input tab stop is on.  */
+              uintmax_t next_tab_column;
+              bool last_tab IF_LINT (=0);
 
-                  while (++column < next_tab_column)
-                    if (putchar (' ') < 0)
-                      die (EXIT_FAILURE, errno, _("write error"));
+              next_tab_column = get_next_tab_column (column, &tab_index,
+                                                     &last_tab);
 
-                  c = ' ';
-                }
-              else if (c == '\b')
-                {
-                  /* Go back one column, and force recalculation of the
-                     next tab stop.  */
-                  column -= !!column;
-                  tab_index -= !!tab_index;
-                }
-              else
+              if (last_tab)
+                next_tab_column = column + 1;
+
+              if (next_tab_column < column)
+                die (EXIT_FAILURE, 0, _("input line is too long"));
+
+              for (uintmax_t nspaces = next_tab_column - column; nspaces; )
                 {
-                  column++;
-                  if (!column)
-                    die (EXIT_FAILURE, 0, _("input line is too long"));
+                  size_t nw = MIN (nspaces, sizeof spaces);
+                  write_block (spaces, nw);
+                  nspaces -= nw;
                 }
-
-              convert &= convert_entire_line || !! isblank (c);
+              column = next_tab_column;
+            }
+          else if (c == '\b')
+            {
+              /* Go back one column, and force recalculation of the
+                 next tab stop.  */
+              column -= !!column;
+              tab_index -= !!tab_index;
+              convert = convert_entire_line;
+              if (putchar (c) < 0)
+                die (EXIT_FAILURE, errno, _("write error"));
+            }
+          else if (c == '\n')
+            {
+              if (putchar (c) < 0)
+                die (EXIT_FAILURE, errno, _("write error"));
+              column = 0;
+              tab_index = 0;
+            }
+          else
+            {
+              /* Reached only with -i: a character other than a space
+                 that may or may not end the conversion.  */
+              column++;
+              if (!column)
+                die (EXIT_FAILURE, 0, _("input line is too long"));
+              convert = convert_entire_line || !! isblank (c);
+              if (putchar (c) < 0)
+                die (EXIT_FAILURE, errno, _("write error"));
             }
-
-          if (c < 0)
-            return;
-
-          if (putchar (c) < 0)
-            die (EXIT_FAILURE, errno, _("write error"));
         }
-      while (c != '\n');
     }
 }
 
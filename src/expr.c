@@ -70,7 +70,8 @@ enum
 /* The kinds of value we can have.  */
 enum valtype
 {
-  integer,
+  integer,			/* Fits in an intmax_t.  */
+  bignum,			/* Spilled into a GMP integer.  */
   string
 };
 typedef enum valtype TYPE;
@@ -81,6 +82,7 @@ struct valinfo
   TYPE type;			/* Which kind. */
   union
   {				/* The value itself. */
+    intmax_t n;
     mpz_t i;
     char *s;
   } u;
@@ -366,11 +368,36 @@ static VALUE *
 int_value (unsigned long int i)
 {
   VALUE *v = xmalloc (sizeof *v);
-  v->type = integer;
-  mpz_init_set_ui (v->u.i, i);
+  if (i <= INTMAX_MAX)
+    {
+      v->type = integer;
+      v->u.n = i;
+    }
+  else
+    {
+      v->type = bignum;
+      mpz_init_set_ui (v->u.i, i);
+    }
   return v;
 }
 
+/* Promote the machine integer V to a GMP integer, in place.  */
+
+static void
+tobig (VALUE *v)
+{
+  intmax_t n = v->u.n;
+  if (LONG_MIN <= n && n <= LONG_MAX)
+    mpz_init_set_si (v->u.i, n);
+  else
+    {
+      char buf[INT_BUFSIZE_BOUND (intmax_t)];
+      sprintf (buf, "%" PRIdMAX, n);
+      mpz_init_set_str (v->u.i, buf, 10);
+    }
+  v->type = bignum;
+}
+
 /* Return a VALUE for S.  */
 
 static VALUE *
@@ -389,7 +416,7 @@ freev (VALUE *v)
 {
   if (v->type == string)
     free (v->u.s);
-  else
+  else if (v->type == bignum)
     mpz_clear (v->u.i);
   free (v);
 }
@@ -402,6 +429,9 @@ printv (VALUE *v)
   switch (v->type)
     {
     case integer:
+      printf ("%" PRIdMAX "\n", v->u.n);
+      break;
+    case bignum:
       mpz_out_str (stdout, 10, v->u.i);
       putchar ('\n');
       break;
@@ -421,6 +451,8 @@ null (VALUE *v)
   switch (v->type)
     {
     case integer:
+      return v->u.n == 0;
+    case bignum:
       return mpz_sgn (v->u.i) == 0;
     case string:
       {
@@ -467,6 +499,14 @@ tostring (VALUE *v)
   switch (v->type)
     {
     case integer:
+      {
+        char buf[INT_BUFSIZE_BOUND (intmax_t)];
+        sprintf (buf, "%" PRIdMAX, v->u.n);
+        v->u.s = xstrdup (buf);
+        v->type = string;
+      }
+      break;
+    case bignum:
       {
         char *s = mpz_get_str (NULL, 10, v->u.i);
         mpz_clear (v->u.i);
@@ -489,6 +529,7 @@ toarith (VALUE *v)
   switch (v->type)
     {
     case integer:
+    case bignum:
       return true;
     case string:
       {
@@ -496,10 +537,21 @@ toarith (VALUE *v)
 
         if (! looks_like_integer (s))
           return false;
-        if (mpz_init_set_str (v->u.i, s, 10) != 0)
-          die (EXPR_FAILURE, ERANGE, "%s", (s));
+        errno = 0;
+        intmax_t n = strtoimax (s, NULL, 10);
+        if (errno != ERANGE)
+          {
+            v->u.n = n;
+            v->type = integer;
+          }
+        else
+          {
+            /* Too wide for a machine integer; spill to GMP.  */
+            if (mpz_init_set_str (v->u.i, s, 10) != 0)
+              die (EXPR_FAILURE, ERANGE, "%s", (s));
+            v->type = bignum;
+          }
         free (s);
-        v->type = integer;
         return true;
       }
     default:
@@ -507,17 +559,25 @@ toarith (VALUE *v)
     }
 }
 
-/* Extract a size_t value from an integer value I.
+/* Extract a size_t value from the integer value V.
    If the value is negative, return SIZE_MAX.
    If the value is too large, return SIZE_MAX - 1.  */
 static size_t
-getsize (mpz_t i)
+getsize (VALUE const *v)
 {
-  if (mpz_sgn (i) < 0)
+  if (v->type == integer)
+    {
+      if (v->u.n < 0)
+        return SIZE_MAX;
+      if ((uintmax_t) v->u.n < SIZE_MAX)
+        return v->u.n;
+      return SIZE_MAX - 1;
+    }
+  if (mpz_sgn (v->u.i) < 0)
     return SIZE_MAX;
-  if (mpz_fits_ulong_p (i))
+  if (mpz_fits_ulong_p (v->u.i))
     {
-      unsigned long int ul = mpz_get_ui (i);
+      unsigned long int ul = mpz_get_ui (v->u.i);
       if (ul < SIZE_MAX)
         return ul;
     }
@@ -585,27 +645,54 @@ docolon (VALUE *sv, VALUE *pv)
 {
   VALUE *v IF_LINT ( = NULL);
   char const *errmsg;
-  struct re_pattern_buffer re_buffer;
-  char fastmap[UCHAR_MAX + 1];
+  static struct re_pattern_buffer re_buffer;
+  static char fastmap[UCHAR_MAX + 1];
+  static char *cached_pattern;
   struct re_registers re_regs;
   regoff_t matchlen;
 
   tostring (sv);
   tostring (pv);
 
+  /* A pattern with no characters special to basic regular expressions
+     can only match a literal copy of itself, and the match is
+     anchored, so a prefix comparison replaces the regexp engine.
+     Such a pattern cannot contain \( \), so the result is a count.  */
+  size_t patlen = strlen (pv->u.s);
+  if (patlen == strcspn (pv->u.s, ".[^$*\\"))
+    {
+      if (strncmp (sv->u.s, pv->u.s, patlen) != 0)
+        return int_value (0);
+      size_t i = (MB_CUR_MAX == 1
+                  ? patlen
+                  : mbs_offset_to_chars (sv->u.s, patlen));
+      return int_value (i);
+    }
+
   re_regs.num_regs = 0;
   re_regs.start = NULL;
   re_regs.end = NULL;
 
-  re_buffer.buffer = NULL;
-  re_buffer.allocated = 0;
-  re_buffer.fastmap = fastmap;
-  re_buffer.translate = NULL;
-  re_syntax_options =
-    RE_SYNTAX_POSIX_BASIC & ~RE_CONTEXT_INVALID_DUP & ~RE_NO_EMPTY_RANGES;
-  errmsg = re_compile_pattern (pv->u.s, strlen (pv->u.s), &re_buffer);
-  if (errmsg)
-    die (EXPR_INVALID, 0, "%s", (errmsg));
+  /* An expression can apply one pattern to many strings; keep the
+     most recently compiled pattern.  */
+  if (! (cached_pattern && STREQ (cached_pattern, pv->u.s)))
+    {
+      free (cached_pattern);
+      cached_pattern = NULL;
+      re_buffer.fastmap = NULL;
+      regfree (&re_buffer);
+
+      re_buffer.buffer = NULL;
+      re_buffer.allocated = 0;
+      re_buffer.fastmap = fastmap;
+      re_buffer.translate = NULL;
+      re_syntax_options =
+        RE_SYNTAX_POSIX_BASIC & ~RE_CONTEXT_INVALID_DUP & ~RE_NO_EMPTY_RANGES;
+      errmsg = re_compile_pattern (pv->u.s, strlen (pv->u.s), &re_buffer);
+      if (errmsg)
+        die (EXPR_INVALID, 0, "%s", (errmsg));
+      cached_pattern = xstrdup (pv->u.s);
+    }
   re_buffer.newline_anchor = 0;
 
   matchlen = re_match (&re_buffer, sv->u.s, strlen (sv->u.s), 0, &re_regs);
@@ -650,8 +737,6 @@ docolon (VALUE *sv, VALUE *pv)
       free (re_regs.start);
       free (re_regs.end);
     }
-  re_buffer.fastmap = NULL;
-  regfree (&re_buffer);
   return v;
 }
 
@@ -751,8 +836,8 @@ eval6 (bool evaluate)
         v = str_value ("");
       else
         {
-          size_t pos = getsize (i1->u.i);
-          size_t len = getsize (i2->u.i);
+          size_t pos = getsize (i1);
+          size_t len = getsize (i2);
 
           char *s = mbs_logical_substr (l->u.s, pos, len);
           v = str_value (s);
@@ -827,12 +912,37 @@ eval4 (bool evaluate)
         {
           if (!toarith (l) || !toarith (r))
             die (EXPR_INVALID, 0, _("non-integer argument"));
-          if (fxn != multiply && mpz_sgn (r->u.i) == 0)
+          if (fxn != multiply
+              && (r->type == integer ? r->u.n == 0 : mpz_sgn (r->u.i) == 0))
             die (EXPR_INVALID, 0, _("division by zero"));
-          ((fxn == multiply ? mpz_mul
-            : fxn == divide ? mpz_tdiv_q
-            : mpz_tdiv_r)
-           (l->u.i, l->u.i, r->u.i));
+          bool done = false;
+          if (l->type == integer && r->type == integer)
+            {
+              /* Machine arithmetic; spill to GMP only on overflow.  */
+              intmax_t val;
+              if (fxn == multiply
+                  ? ! INT_MULTIPLY_WRAPV (l->u.n, r->u.n, &val)
+                  : ! (l->u.n == INTMAX_MIN && r->u.n == -1)
+                    && ((val = (fxn == divide
+                                ? l->u.n / r->u.n
+                                : l->u.n % r->u.n)),
+                        true))
+                {
+                  l->u.n = val;
+                  done = true;
+                }
+            }
+          if (! done)
+            {
+              if (l->type == integer)
+                tobig (l);
+              if (r->type == integer)
+                tobig (r);
+              ((fxn == multiply ? mpz_mul
+                : fxn == divide ? mpz_tdiv_q
+                : mpz_tdiv_r)
+               (l->u.i, l->u.i, r->u.i));
+            }
         }
       freev (r);
     }
@@ -864,7 +974,26 @@ eval3 (bool evaluate)
         {
           if (!toarith (l) || !toarith (r))
             die (EXPR_INVALID, 0, _("non-integer argument"));
-          (fxn == plus ? mpz_add : mpz_sub) (l->u.i, l->u.i, r->u.i);
+          bool done = false;
+          if (l->type == integer && r->type == integer)
+            {
+              intmax_t val;
+              if (! (fxn == plus
+                     ? INT_ADD_WRAPV (l->u.n, r->u.n, &val)
+                     : INT_SUBTRACT_WRAPV (l->u.n, r->u.n, &val)))
+                {
+                  l->u.n = val;
+                  done = true;
+                }
+            }
+          if (! done)
+            {
+              if (l->type == integer)
+                tobig (l);
+              if (r->type == integer)
+                tobig (r);
+              (fxn == plus ? mpz_add : mpz_sub) (l->u.i, l->u.i, r->u.i);
+            }
         }
       freev (r);
     }
@@ -909,24 +1038,33 @@ eval2 (bool evaluate)
       if (evaluate)
         {
           int cmp;
-          tostring (l);
-          tostring (r);
 
-          if (looks_like_integer (l->u.s) && looks_like_integer (r->u.s))
-            cmp = strintcmp (l->u.s, r->u.s);
+          if (l->type == integer && r->type == integer)
+            /* A decimal-string comparison of machine integers reduces
+               to comparing the integers themselves.  */
+            cmp = (l->u.n < r->u.n ? -1 : l->u.n > r->u.n);
           else
             {
-              errno = 0;
-              cmp = strcoll (l->u.s, r->u.s);
+              tostring (l);
+              tostring (r);
 
-              if (errno)
+              if (looks_like_integer (l->u.s) && looks_like_integer (r->u.s))
+                cmp = strintcmp (l->u.s, r->u.s);
+              else
                 {
-                  error (0, errno, _("string comparison failed"));
-                  error (0, 0, _("set LC_ALL='C' to work around the problem"));
-                  die (EXPR_INVALID, 0,
-                       _("the strings compared were %s and %s"),
-                       quotearg_n_style (0, locale_quoting_style, l->u.s),
-                       quotearg_n_style (1, locale_quoting_style, r->u.s));
+                  errno = 0;
+                  cmp = strcoll (l->u.s, r->u.s);
+
+                  if (errno)
+                    {
+                      error (0, errno, _("string comparison failed"));
+                      error (0, 0,
+                             _("set LC_ALL='C' to work around the problem"));
+                      die (EXPR_INVALID, 0,
+                           _("the strings compared were %s and %s"),
+                           quotearg_n_style (0, locale_quoting_style, l->u.s),
+                           quotearg_n_style (1, locale_quoting_style, r->u.s));
+                    }
                 }
             }
 
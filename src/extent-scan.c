@@ -17,6 +17,7 @@
    Written by Jie Liu (jeff.liu@oracle.com).  */
 
 #include <config.h>
+#include <pthread.h>
 #include <sys/types.h>
 #include <sys/ioctl.h>
 #include <sys/utsname.h>
@@ -63,6 +64,13 @@ extent_need_sync (void)
 #endif
 }
 
+/* Initial and maximal number of extents to request per FIEMAP call.
+   The initial value matches what a 4KiB result buffer used to hold;
+   the count doubles while calls keep coming back full, so heavily
+   fragmented files need far fewer ioctl round trips.  */
+enum { FM_COUNT_INITIAL = 72 };
+enum { FM_COUNT_MAX = 4608 };
+
 /* Allocate space for struct extent_scan, initialize the entries if
    necessary and return it as the input argument of extent_scan_read().  */
 extern void
@@ -75,6 +83,34 @@ extent_scan_init (int src_fd, struct extent_scan *scan)
   scan->initial_scan_failed = false;
   scan->hit_final_extent = false;
   scan->fm_flags = extent_need_sync () ? FIEMAP_FLAG_SYNC : 0;
+  scan->fm_count = FM_COUNT_INITIAL;
+  scan->prefetch = NULL;
+  scan->batch_returned = false;
+}
+
+/* State for reading the next batch of extents in the background while
+   the current batch is being copied.  The clone owns its result array
+   until extent_scan_read or extent_scan_drain claims it.  */
+struct extent_prefetch
+{
+  struct extent_scan scan;
+  bool ok;
+  pthread_t thread;
+};
+
+/* Wait for any read-ahead of the next extent batch to finish and
+   discard its result.  A no-op unless extent_scan_read started one.  */
+extern void
+extent_scan_drain (struct extent_scan *scan)
+{
+  struct extent_prefetch *prefetch = scan->prefetch;
+  if (prefetch)
+    {
+      pthread_join (prefetch->thread, NULL);
+      free (prefetch->scan.ext_info);
+      free (prefetch);
+      scan->prefetch = NULL;
+    }
 }
 
 #ifdef __linux__
@@ -82,26 +118,25 @@ extent_scan_init (int src_fd, struct extent_scan *scan)
 #  define FS_IOC_FIEMAP _IOWR ('f', 11, struct fiemap)
 # endif
 /* Call ioctl(2) with FS_IOC_FIEMAP (available in linux 2.6.27) to
-   obtain a map of file extents excluding holes.  */
-extern bool
-extent_scan_read (struct extent_scan *scan)
+   obtain a map of file extents excluding holes, filling SCAN with
+   one batch of roughly fm_count extents.  */
+static bool
+extent_scan_read_batch (struct extent_scan *scan)
 {
   unsigned int si = 0;
   struct extent_info *last_ei = scan->ext_info;
 
   while (true)
     {
-      union { struct fiemap f; char c[4096]; } fiemap_buf;
-      struct fiemap *fiemap = &fiemap_buf.f;
-      struct fiemap_extent *fm_extents = &fiemap->fm_extents[0];
       enum { headersize = offsetof (struct fiemap, fm_extents) };
-      enum { count = (sizeof fiemap_buf - headersize) / sizeof *fm_extents };
-      verify (count > 1);
+      unsigned int count = scan->fm_count;
 
-      /* This is required at least to initialize fiemap->fm_start,
-         but also serves (in mid 2010) to appease valgrind, which
-         appears not to know the semantics of the FIEMAP ioctl. */
-      memset (&fiemap_buf, 0, sizeof fiemap_buf);
+      /* Zeroing initializes fiemap->fm_start, and also serves (in mid
+         2010) to appease valgrind, which appears not to know the
+         semantics of the FIEMAP ioctl. */
+      struct fiemap *fiemap =
+        xzalloc (headersize + count * sizeof *fiemap->fm_extents);
+      struct fiemap_extent *fm_extents = &fiemap->fm_extents[0];
 
       fiemap->fm_start = scan->scan_start;
       fiemap->fm_flags = scan->fm_flags;
@@ -112,6 +147,7 @@ extent_scan_read (struct extent_scan *scan)
          the first time.  */
       if (ioctl (scan->fd, FS_IOC_FIEMAP, fiemap) < 0)
         {
+          free (fiemap);
           if (scan->scan_start == 0)
             scan->initial_scan_failed = true;
           return false;
@@ -120,10 +156,16 @@ extent_scan_read (struct extent_scan *scan)
       /* If 0 extents are returned, then no more scans are needed.  */
       if (fiemap->fm_mapped_extents == 0)
         {
+          free (fiemap);
           scan->hit_final_extent = true;
           return scan->scan_start != 0;
         }
 
+      /* Ask for more per call while full batches keep arriving, so
+         heavily fragmented files need fewer ioctl round trips.  */
+      if (fiemap->fm_mapped_extents == count && scan->fm_count < FM_COUNT_MAX)
+        scan->fm_count = count * 2;
+
       assert (scan->ei_count <= SIZE_MAX - fiemap->fm_mapped_extents);
       scan->ei_count += fiemap->fm_mapped_extents;
       {
@@ -175,6 +217,7 @@ extent_scan_read (struct extent_scan *scan)
               /* If an extent is contained within the previous one, fail.  */
               if (length_adjust < fm_extents[i].fe_length)
                 {
+                  free (fiemap);
                   if (scan->scan_start == 0)
                     scan->initial_scan_failed = true;
                   return false;
@@ -206,6 +249,8 @@ extent_scan_read (struct extent_scan *scan)
       /* We don't bother reallocating any trailing slots.  */
       scan->ei_count = si;
 
+      free (fiemap);
+
       if (scan->hit_final_extent)
         break;
       else
@@ -217,6 +262,57 @@ extent_scan_read (struct extent_scan *scan)
 
   return true;
 }
+
+/* Fill the private clone of the scan state with the next batch.  */
+static void *
+extent_prefetch_thread (void *prefetch_arg)
+{
+  struct extent_prefetch *prefetch = prefetch_arg;
+  prefetch->ok = extent_scan_read_batch (&prefetch->scan);
+  return NULL;
+}
+
+/* Read the next batch of extents into SCAN, adopting the batch already
+   fetched in the background if there is one, and then start fetching
+   the following batch so that extent discovery overlaps the data copy.
+   The first batch is fetched during scan-type inference, where the
+   caller may yet choose another copy strategy, so read-ahead begins
+   with the second call.  */
+extern bool
+extent_scan_read (struct extent_scan *scan)
+{
+  bool subsequent_call = scan->batch_returned;
+  bool ok;
+
+  struct extent_prefetch *prefetch = scan->prefetch;
+  if (prefetch)
+    {
+      pthread_join (prefetch->thread, NULL);
+      scan->prefetch = NULL;
+      ok = prefetch->ok;
+      *scan = prefetch->scan;
+      free (prefetch);
+    }
+  else
+    ok = extent_scan_read_batch (scan);
+
+  scan->batch_returned = true;
+
+  if (subsequent_call && ok && ! scan->hit_final_extent)
+    {
+      struct extent_prefetch *p = xmalloc (sizeof *p);
+      p->scan = *scan;
+      p->scan.ei_count = 0;
+      p->scan.ext_info = NULL;
+      p->scan.prefetch = NULL;
+      if (pthread_create (&p->thread, NULL, extent_prefetch_thread, p) == 0)
+        scan->prefetch = p;
+      else
+        free (p);               /* Carry on with synchronous scans.  */
+    }
+
+  return ok;
+}
 #else
 extern bool
 extent_scan_read (struct extent_scan *scan _GL_UNUSED)
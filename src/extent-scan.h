@@ -32,6 +32,8 @@ struct extent_info
   unsigned int ext_flags;
 };
 
+struct extent_prefetch;
+
 /* Structure used to reserve extent scan information per file.  */
 struct extent_scan
 {
@@ -44,6 +46,18 @@ struct extent_scan
   /* Flags to use for scan.  */
   unsigned int fm_flags;
 
+  /* Extents to request per FIEMAP call; grows while calls keep
+     coming back full.  */
+  unsigned int fm_count;
+
+  /* In-flight read-ahead of the next batch, or NULL.  */
+  struct extent_prefetch *prefetch;
+
+  /* Whether a batch has already been handed to the caller; read-ahead
+     starts only after that, since the first batch is fetched while
+     merely inferring the scan type.  */
+  bool batch_returned;
+
   /* How many extent info returned for a scan.  */
   size_t ei_count;
 
@@ -62,6 +76,8 @@ void extent_scan_init (int src_fd, struct extent_scan *scan);
 
 bool extent_scan_read (struct extent_scan *scan);
 
+void extent_scan_drain (struct extent_scan *scan);
+
 static inline void
 extent_scan_free (struct extent_scan *scan)
 {
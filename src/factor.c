@@ -102,6 +102,7 @@
 
 #include <config.h>
 #include <getopt.h>
+#include <pthread.h>
 #include <stdio.h>
 #include <gmp.h>
 #include <assert.h>
@@ -112,6 +113,7 @@
 #include "full-write.h"
 #include "quote.h"
 #include "readtokens.h"
+#include "xdectoint.h"
 #include "xstrtol.h"
 
 /* The official name of this program (e.g., no 'g' prefix).  */
@@ -220,12 +222,14 @@ const unsigned char factor_clz_tab[129] =
 
 enum
 {
-  DEV_DEBUG_OPTION = CHAR_MAX + 1
+  DEV_DEBUG_OPTION = CHAR_MAX + 1,
+  THREADS_OPTION
 };
 
 static struct option const long_options[] =
 {
   {"-debug", no_argument, NULL, DEV_DEBUG_OPTION},
+  {"threads", required_argument, NULL, THREADS_OPTION},
   {GETOPT_HELP_OPTION_DECL},
   {GETOPT_VERSION_OPTION_DECL},
   {NULL, 0, NULL, 0}
@@ -699,6 +703,10 @@ static bool dev_debug = false;
 /* Prove primality or run probabilistic tests.  */
 static bool flag_prove_primality = PROVE_PRIMALITY;
 
+/* Maximum number of Brent cycles raced when splitting a two-word
+   composite.  */
+static size_t nthreads = 1;
+
 /* Number of Miller-Rabin tests to run when not proving primality. */
 #define MR_REPS 25
 
@@ -1446,62 +1454,102 @@ mp_prime_p (mpz_t n)
   return is_prime;
 }
 
+/* Number of independent Brent cycles advanced in lock step by
+   factor_using_pollard_rho.  One walk's mulredc chain is strictly
+   serial, so a second walk with its own parameter hides most of the
+   multiplication latency; whichever walk meets a factor first
+   delivers it, and the resulting prime factors are the same either
+   way.  */
+enum { RHO_WALKS = 2 };
+
+/* The state of one Brent cycle: the iterate X, the saved iterates Z
+   and Y for cycle detection and backtracking, the product P of the
+   differences whose gcd with n is tested in batches, and the phase
+   bookkeeping of the original single-walk loop, with ADVANCING set
+   while the walk moves X ahead of the new Z without accumulating
+   into P.  */
+struct rho_walk
+{
+  uintmax_t x, z, y, P;
+  unsigned long int k, l, i;
+  bool advancing;
+};
+
 static void
 factor_using_pollard_rho (uintmax_t n, unsigned long int a,
                           struct factors *factors)
 {
-  uintmax_t x, z, y, P, t, ni, g;
-
-  unsigned long int k = 1;
-  unsigned long int l = 1;
+  struct rho_walk w[RHO_WALKS];
+  uintmax_t t, ni, g;
 
-  redcify (P, 1, n);
-  addmod (x, P, P, n);          /* i.e., redcify(2) */
-  y = z = x;
+  for (int j = 0; j < RHO_WALKS; j++)
+    {
+      uintmax_t P;
+      redcify (P, 1, n);
+      w[j].P = P;
+      addmod (w[j].x, P, P, n);  /* i.e., redcify(2) */
+      w[j].y = w[j].z = w[j].x;
+      w[j].k = w[j].l = 1;
+      w[j].i = 0;
+      w[j].advancing = false;
+    }
 
   while (n != 1)
     {
-      assert (a < n);
+      assert (a + RHO_WALKS - 1 < n);
 
       binv (ni, n);             /* FIXME: when could we use old 'ni' value? */
 
-      for (;;)
-        {
-          do
-            {
-              x = mulredc (x, x, n, ni);
-              addmod (x, x, a, n);
-
-              submod (t, z, x, n);
-              P = mulredc (P, t, n, ni);
-
-              if (k % 32 == 1)
-                {
-                  if (gcd_odd (P, n) != 1)
-                    goto factor_found;
-                  y = x;
-                }
-            }
-          while (--k != 0);
-
-          z = x;
-          k = l;
-          l = 2 * l;
-          for (unsigned long int i = 0; i < k; i++)
-            {
-              x = mulredc (x, x, n, ni);
-              addmod (x, x, a, n);
-            }
-          y = x;
-        }
+      int fw = -1;              /* walk whose gcd batch hit a factor */
+      while (fw < 0)
+        for (int j = 0; j < RHO_WALKS; j++)
+          {
+            struct rho_walk *r = &w[j];
+
+            r->x = mulredc (r->x, r->x, n, ni);
+            addmod (r->x, r->x, a + j, n);
+
+            if (r->advancing)
+              {
+                if (--r->i == 0)
+                  {
+                    r->y = r->x;
+                    r->advancing = false;
+                  }
+              }
+            else
+              {
+                submod (t, r->z, r->x, n);
+                r->P = mulredc (r->P, t, n, ni);
+
+                if (r->k % 32 == 1)
+                  {
+                    if (gcd_odd (r->P, n) != 1)
+                      {
+                        fw = j;
+                        break;
+                      }
+                    r->y = r->x;
+                  }
+
+                if (--r->k == 0)
+                  {
+                    r->z = r->x;
+                    r->k = r->l;
+                    r->l = 2 * r->l;
+                    r->i = r->k;
+                    r->advancing = true;
+                  }
+              }
+          }
 
-    factor_found:
+      struct rho_walk *r = &w[fw];
       do
         {
-          y = mulredc (y, y, n, ni);
-          addmod (y, y, a, n);
+          r->y = mulredc (r->y, r->y, n, ni);
+          addmod (r->y, r->y, a + fw, n);
 
-          submod (t, z, y, n);
+          submod (t, r->z, r->y, n);
           g = gcd_odd (t, n);
         }
       while (g == 1);
@@ -1509,14 +1557,14 @@ factor_using_pollard_rho (uintmax_t n, unsigned long int a,
       if (n == g)
         {
           /* Found n itself as factor.  Restart with different params.  */
-          factor_using_pollard_rho (n, a + 1, factors);
+          factor_using_pollard_rho (n, a + RHO_WALKS, factors);
           return;
         }
 
       n = n / g;
 
       if (!prime_p (g))
-        factor_using_pollard_rho (g, a + 1, factors);
+        factor_using_pollard_rho (g, a + RHO_WALKS, factors);
       else
         factor_insert (factors, g);
 
@@ -1526,10 +1574,163 @@ factor_using_pollard_rho (uintmax_t n, unsigned long int a,
           break;
         }
 
-      x = x % n;
-      z = z % n;
-      y = y % n;
+      for (int j = 0; j < RHO_WALKS; j++)
+        {
+          w[j].x %= n;
+          w[j].z %= n;
+          w[j].y %= n;
+        }
+    }
+}
+
+/* State shared by the threads racing to split one two-word composite.
+   Each worker runs independent Brent cycles with parameters drawn
+   from NEXT; the first proper factor recorded wins and the others
+   stop at their next gcd batch.  */
+struct rho2_race
+{
+  pthread_mutex_t mutex;
+  uintmax_t n1, n0;
+  unsigned long int next;       /* next cycle parameter to try */
+  uintmax_t g1, g0;             /* the winning factor */
+  bool found;
+};
+
+/* Race the other workers on the composite in *R with the walk of
+   factor_using_pollard_rho2 below; a cycle that only rediscovers n
+   itself restarts with a fresh parameter.  */
+
+static void *
+rho2_race_thread (void *arg)
+{
+  struct rho2_race *r = arg;
+  uintmax_t n1 = r->n1, n0 = r->n0;
+  uintmax_t x1, x0, z1, z0, y1, y0, P1, P0, t1, t0, ni, g1, g0, r1m;
+  unsigned long int a, k, l;
+  bool stop;
+
+  binv (ni, n0);
+
+ restart:
+  pthread_mutex_lock (&r->mutex);
+  a = r->next++;
+  stop = r->found;
+  pthread_mutex_unlock (&r->mutex);
+  if (stop)
+    return NULL;
+
+  k = l = 1;
+  redcify2 (P1, P0, 1, n1, n0);
+  addmod2 (x1, x0, P1, P0, P1, P0, n1, n0); /* i.e., redcify(2) */
+  y1 = z1 = x1;
+  y0 = z0 = x0;
+
+  for (;;)
+    {
+      do
+        {
+          x0 = mulredc2 (&r1m, x1, x0, x1, x0, n1, n0, ni);
+          x1 = r1m;
+          addmod2 (x1, x0, x1, x0, 0, (uintmax_t) a, n1, n0);
+
+          submod2 (t1, t0, z1, z0, x1, x0, n1, n0);
+          P0 = mulredc2 (&r1m, P1, P0, t1, t0, n1, n0, ni);
+          P1 = r1m;
+
+          if (k % 32 == 1)
+            {
+              g0 = gcd2_odd (&g1, P1, P0, n1, n0);
+              if (g1 != 0 || g0 != 1)
+                goto factor_found;
+              y1 = x1; y0 = x0;
+
+              pthread_mutex_lock (&r->mutex);
+              stop = r->found;
+              pthread_mutex_unlock (&r->mutex);
+              if (stop)
+                return NULL;
+            }
+        }
+      while (--k != 0);
+
+      z1 = x1; z0 = x0;
+      k = l;
+      l = 2 * l;
+      for (unsigned long int i = 0; i < k; i++)
+        {
+          x0 = mulredc2 (&r1m, x1, x0, x1, x0, n1, n0, ni);
+          x1 = r1m;
+          addmod2 (x1, x0, x1, x0, 0, (uintmax_t) a, n1, n0);
+
+          if (i % 32 == 0)
+            {
+              pthread_mutex_lock (&r->mutex);
+              stop = r->found;
+              pthread_mutex_unlock (&r->mutex);
+              if (stop)
+                return NULL;
+            }
+        }
+      y1 = x1; y0 = x0;
     }
+
+ factor_found:
+  do
+    {
+      y0 = mulredc2 (&r1m, y1, y0, y1, y0, n1, n0, ni);
+      y1 = r1m;
+      addmod2 (y1, y0, y1, y0, 0, (uintmax_t) a, n1, n0);
+
+      submod2 (t1, t0, z1, z0, y1, y0, n1, n0);
+      g0 = gcd2_odd (&g1, t1, t0, n1, n0);
+    }
+  while (g1 == 0 && g0 == 1);
+
+  if (g1 == n1 && g0 == n0)
+    goto restart;
+
+  pthread_mutex_lock (&r->mutex);
+  if (! r->found)
+    {
+      r->found = true;
+      r->g1 = g1;
+      r->g0 = g0;
+    }
+  pthread_mutex_unlock (&r->mutex);
+  return NULL;
+}
+
+/* Split the two-word composite <N1,N0> with up to nthreads racing
+   cycles, the first starting from parameter A, and return the factor
+   found (low word; the high word goes to *G1P).  The factor is proper
+   but possibly composite.  */
+
+static uintmax_t
+pollard_rho2_race (uintmax_t *g1p, uintmax_t n1, uintmax_t n0,
+                   unsigned long int a)
+{
+  struct rho2_race r = { PTHREAD_MUTEX_INITIALIZER, n1, n0, a, 0, 0, false };
+
+  pthread_t *threads = xnmalloc (nthreads - 1, sizeof *threads);
+  size_t started = 0;
+
+  /* This thread races too; if a thread cannot be created, its cycles
+     are simply never started.  */
+  for (size_t i = 0; i < nthreads - 1; i++)
+    {
+      if (pthread_create (&threads[i], NULL, rho2_race_thread, &r) != 0)
+        break;
+      started++;
+    }
+
+  rho2_race_thread (&r);
+
+  for (size_t i = 0; i < started; i++)
+    pthread_join (threads[i], NULL);
+  free (threads);
+
+  *g1p = r.g1;
+  return r.g0;
 }
 
 static void
@@ -1550,6 +1751,14 @@ factor_using_pollard_rho2 (uintmax_t n1, uintmax_t n0, unsigned long int a,
     {
       binv (ni, n0);
 
+      if (1 < nthreads)
+        {
+          /* The racing cycles never report n itself, so the restart
+             case below is not taken in this mode.  */
+          g0 = pollard_rho2_race (&g1, n1, n0, a);
+          goto found;
+        }
+
       for (;;)
         {
           do
@@ -1596,6 +1805,7 @@ factor_using_pollard_rho2 (uintmax_t n1, uintmax_t n0, unsigned long int a,
         }
       while (g1 == 0 && g0 == 1);
 
+    found:
       if (g1 == 0)
         {
           /* The found factor is one word, and > 1. */
@@ -2455,6 +2665,140 @@ print_factors_single (uintmax_t t1, uintmax_t t0)
   lbuf_putc ('\n');
 }
 
+/* A run of consecutive single-word values pending factorization, as
+   produced by seq.  Instead of repeating trial division from scratch
+   for every value, factor_range_segment strips each table prime from
+   the whole run in one pass, dividing only the entries the sieve
+   proves divisible; whatever remains of each value goes through the
+   usual primality test and Pollard rho.  Runs shorter than
+   RANGE_RUN_MIN are factored one value at a time, as the per-prime
+   start-up cost would exceed the trial division saved.  */
+
+enum
+{
+  RANGE_RUN_MIN = 16,
+  /* Values sieved together; bounds the buffered factor state.  */
+  RANGE_SEGMENT = 1024
+};
+
+static uintmax_t range_lo;
+static size_t range_len;
+static bool range_pending;
+
+static void
+factor_range_segment (uintmax_t lo, size_t n)
+{
+  uintmax_t *rest = xnmalloc (n, sizeof *rest);
+  struct factors *fs = xnmalloc (n, sizeof *fs);
+
+  for (size_t i = 0; i < n; i++)
+    {
+      rest[i] = lo + i;
+      fs[i].nfactors = 0;
+    }
+
+  /* Powers of 2.  */
+  for (size_t i = lo % 2; i < n; i += 2)
+    {
+      unsigned int cnt;
+      count_trailing_zeros (cnt, rest[i]);
+      rest[i] >>= cnt;
+      factor_insert_multiplicity (&fs[i], 2, cnt);
+    }
+
+  /* The odd table primes.  Every entry the sieve lands on is known
+     divisible, so the first inverse multiplication per entry always
+     divides; further iterations cast out higher powers.  */
+  uintmax_t p = 3;
+  for (unsigned int pi = 0; pi < PRIMES_PTAB_ENTRIES; pi++)
+    {
+      uintmax_t r = lo % p;
+      for (uintmax_t i = r == 0 ? 0 : p - r; i < n; i += p)
+        for (;;)
+          {
+            uintmax_t q = rest[i] * primes_dtab[pi].binv;
+            if (q > primes_dtab[pi].lim)
+              break;
+            rest[i] = q;
+            factor_insert (&fs[i], p);
+          }
+      p += primes_diff[pi + 1];
+    }
+
+  for (size_t i = 0; i < n; i++)
+    {
+      uintmax_t c = rest[i];
+      if (c != 1)
+        {
+          /* Small primes have been cast out above.  */
+          if (prime_p (c))
+            factor_insert (&fs[i], c);
+          else
+            factor_using_pollard_rho (c, 1, &fs[i]);
+        }
+
+      print_uintmaxes (0, lo + i);
+      lbuf_putc (':');
+      for (unsigned int j = 0; j < fs[i].nfactors; j++)
+        for (unsigned int k = 0; k < fs[i].e[j]; k++)
+          {
+            lbuf_putc (' ');
+            print_uintmaxes (0, fs[i].p[j]);
+          }
+      lbuf_putc ('\n');
+    }
+
+  free (fs);
+  free (rest);
+}
+
+/* Factor and print any pending run.  */
+
+static void
+range_flush (void)
+{
+  if (! range_pending)
+    return;
+  range_pending = false;
+
+  if (RANGE_RUN_MIN <= range_len)
+    factor_range_segment (range_lo, range_len);
+  else
+    for (size_t i = 0; i < range_len; i++)
+      print_factors_single (0, range_lo + i);
+}
+
+/* Append the single-word value T0 to the pending run, starting a new
+   run (and flushing the old one) when T0 does not extend it.  A run
+   reaching RANGE_SEGMENT values is factored immediately and stays
+   open for further extension, so output keeps streaming on unbounded
+   input.  */
+
+static void
+range_add (uintmax_t t0)
+{
+  if (range_pending && t0 == range_lo + range_len && 2 <= t0)
+    {
+      if (++range_len == RANGE_SEGMENT)
+        {
+          factor_range_segment (range_lo, range_len);
+          range_lo += range_len;
+          range_len = 0;
+        }
+      return;
+    }
+
+  range_flush ();
+  if (2 <= t0)
+    {
+      range_lo = t0;
+      range_len = 1;
+      range_pending = true;
+    }
+  else
+    print_factors_single (0, t0);
+}
+
 /* Emit the factors of the indicated number.  If we have the option of using
    either algorithm, we select on the basis of the length of the number.
    For longer numbers, we prefer the MP algorithm even if the native algorithm
@@ -2483,7 +2827,13 @@ print_factors (char const *input)
       if (((t1 << 1) >> 1) == t1)
         {
           devmsg ("[using single-precision arithmetic] ");
-          print_factors_single (t1, t0);
+          if (t1 == 0)
+            range_add (t0);
+          else
+            {
+              range_flush ();
+              print_factors_single (t1, t0);
+            }
           return true;
         }
       break;
@@ -2493,10 +2843,13 @@ print_factors (char const *input)
       break;
 
     default:
+      range_flush ();
       error (0, 0, _("%s is not a valid positive integer"), quote (input));
       return false;
     }
 
+  range_flush ();
+
   devmsg ("[using arbitrary-precision arithmetic] ");
   mpz_t t;
   struct mp_factors factors;
@@ -2537,6 +2890,10 @@ Usage: %s [NUMBER]...\n\
 Print the prime factors of each specified integer NUMBER.  If none\n\
 are specified on the command line, read them from standard input.\n\
 \n\
+"), stdout);
+      fputs (_("\
+      --threads=N  race up to N Pollard rho cycles on separate threads\n\
+                     when splitting a composite wider than one machine word\n\
 "), stdout);
       fputs (HELP_OPTION_DESCRIPTION, stdout);
       fputs (VERSION_OPTION_DESCRIPTION, stdout);
@@ -2561,6 +2918,7 @@ do_stdin (void)
         break;
       ok &= print_factors (tokenbuffer.buffer);
     }
+  range_flush ();
   free (tokenbuffer.buffer);
 
   return ok;
@@ -2588,6 +2946,11 @@ main (int argc, char **argv)
           dev_debug = true;
           break;
 
+        case THREADS_OPTION:
+          nthreads = xdectoumax (optarg, 1, SIZE_MAX, "",
+                                 _("invalid number of threads"), 0);
+          break;
+
         case_GETOPT_HELP_CHAR;
 
         case_GETOPT_VERSION_CHAR (PROGRAM_NAME, AUTHORS);
@@ -2610,6 +2973,7 @@ main (int argc, char **argv)
       for (int i = optind; i < argc; i++)
         if (! print_factors (argv[i]))
           ok = false;
+      range_flush ();
     }
 
 #if STAT_SQUFOF
@@ -853,6 +853,27 @@ fmt_paragraph (void)
   int saved_length;
 
   word_limit->best_cost = 0;
+
+  /* If the paragraph fits on one line, put it there: any break costs
+     at least LINE_COST less the sentence and paren bonuses, which is
+     still positive, so the search below would choose the single line
+     anyway.  The ragged comparison with a preceding line can tip the
+     balance, so take this path only when there is no such line.  */
+
+  if (last_line_length == 0 && word < word_limit)
+    {
+      len = first_indent + word->length;
+      for (w = word + 1; w < word_limit && len < max_width; w++)
+        len += (w - 1)->space + w->length;
+      if (w == word_limit && len < max_width)
+        {
+          word->next_break = word_limit;
+          word->line_length = len;
+          word->best_cost = base_cost (word);
+          return;
+        }
+    }
+
   saved_length = word_limit->length;
   word_limit->length = max_width;	/* sentinel */
 
@@ -112,6 +112,103 @@ adjust_column (size_t column, char c)
   return column;
 }
 
+/* Size of the input buffer used when folding whole buffers.  */
+
+enum { FOLD_BUFFER_SIZE = 64 * 1024 };
+
+/* Fold the contents of ISTREAM to stdout at WIDTH, counting each byte
+   as one column, until end of file or a read error.  Used without -s,
+   where no lookback for a blank is needed: in byte mode every byte
+   counts one column, and in column mode so does every byte other than
+   backspace, carriage return and tab.  Whole buffers are scanned for
+   the few bytes that need attention and everything between them is
+   written in chunks of the remaining line width.  */
+
+static void
+fold_plain (FILE *istream, size_t width)
+{
+  static char *buf;
+  size_t column = 0;		/* Screen column where next char will go. */
+  size_t out_len = 0;		/* Bytes written on the current line. */
+  size_t n_read;
+
+  if (!buf)
+    buf = xmalloc (FOLD_BUFFER_SIZE + 1);
+
+  while ((n_read = fread (buf, 1, FOLD_BUFFER_SIZE, istream)) > 0)
+    {
+      char *p = buf;
+      char *lim = buf + n_read;
+      *lim = '\0';
+
+      while (p < lim)
+        {
+          /* Find the next byte that cannot simply be chunked: a
+             newline, or in column mode also a byte which adjust_column
+             does not count as one column.  strcspn may also stop at a
+             NUL byte, which the slow path below handles like any
+             other.  */
+          char *stop;
+          if (count_bytes)
+            {
+              stop = memchr (p, '\n', lim - p);
+              if (!stop)
+                stop = lim;
+            }
+          else
+            stop = p + strcspn (p, "\n\b\r\t");
+
+          /* Write [P, STOP), breaking whenever the line fills up.  */
+          size_t len = stop - p;
+          while (len != 0)
+            {
+              size_t take;
+              if (column < width)
+                take = MIN (len, width - column);
+              else if (out_len == 0)
+                take = 1;	/* Avoid an empty line.  */
+              else
+                {
+                  putchar ('\n');
+                  column = out_len = 0;
+                  continue;
+                }
+              fwrite (p, sizeof (char), take, stdout);
+              p += take;
+              len -= take;
+              column += take;
+              out_len += take;
+            }
+
+          if (p == lim)
+            break;
+
+          char c = *p++;
+          if (c == '\n')
+            {
+              putchar ('\n');
+              column = out_len = 0;
+              continue;
+            }
+
+          while (true)
+            {
+              size_t new_column = adjust_column (column, c);
+              if (width < new_column && out_len != 0)
+                {
+                  putchar ('\n');
+                  column = out_len = 0;
+                  continue;
+                }
+              putchar (c);
+              column = new_column;
+              out_len++;
+              break;
+            }
+        }
+    }
+}
+
 /* Fold file FILENAME, or standard input if FILENAME is "-",
    to stdout, with maximum line length WIDTH.
    Return true if successful.  */
@@ -143,77 +240,80 @@ fold_file (char const *filename, size_t width)
 
   fadvise (istream, FADVISE_SEQUENTIAL);
 
-  while ((c = getc (istream)) != EOF)
-    {
-      if (offset_out + 1 >= allocated_out)
-        line_out = X2REALLOC (line_out, &allocated_out);
-
-      if (c == '\n')
-        {
-          line_out[offset_out++] = c;
-          fwrite (line_out, sizeof (char), offset_out, stdout);
-          column = offset_out = 0;
-          continue;
-        }
-
-    rescan:
-      column = adjust_column (column, c);
-
-      if (column > width)
-        {
-          /* This character would make the line too long.
-             Print the line plus a newline, and make this character
-             start the next line. */
-          if (break_spaces)
-            {
-              bool found_blank = false;
-              size_t logical_end = offset_out;
-
-              /* Look for the last blank. */
-              while (logical_end)
-                {
-                  --logical_end;
-                  if (isblank (to_uchar (line_out[logical_end])))
-                    {
-                      found_blank = true;
-                      break;
-                    }
-                }
-
-              if (found_blank)
-                {
-                  size_t i;
-
-                  /* Found a blank.  Don't output the part after it. */
-                  logical_end++;
-                  fwrite (line_out, sizeof (char), (size_t) logical_end,
-                          stdout);
-                  putchar ('\n');
-                  /* Move the remainder to the beginning of the next line.
-                     The areas being copied here might overlap. */
-                  memmove (line_out, line_out + logical_end,
-                           offset_out - logical_end);
-                  offset_out -= logical_end;
-                  for (column = i = 0; i < offset_out; i++)
-                    column = adjust_column (column, line_out[i]);
-                  goto rescan;
-                }
-            }
-
-          if (offset_out == 0)
-            {
-              line_out[offset_out++] = c;
-              continue;
-            }
-
-          line_out[offset_out++] = '\n';
-          fwrite (line_out, sizeof (char), (size_t) offset_out, stdout);
-          column = offset_out = 0;
-          goto rescan;
-        }
-
-      line_out[offset_out++] = c;
-    }
+  if (! break_spaces)
+    fold_plain (istream, width);
+  else
+    while ((c = getc (istream)) != EOF)
+      {
+        if (offset_out + 1 >= allocated_out)
+          line_out = X2REALLOC (line_out, &allocated_out);
+
+        if (c == '\n')
+          {
+            line_out[offset_out++] = c;
+            fwrite (line_out, sizeof (char), offset_out, stdout);
+            column = offset_out = 0;
+            continue;
+          }
+
+      rescan:
+        column = adjust_column (column, c);
+
+        if (column > width)
+          {
+            /* This character would make the line too long.
+               Print the line plus a newline, and make this character
+               start the next line. */
+            if (break_spaces)
+              {
+                bool found_blank = false;
+                size_t logical_end = offset_out;
+
+                /* Look for the last blank. */
+                while (logical_end)
+                  {
+                    --logical_end;
+                    if (isblank (to_uchar (line_out[logical_end])))
+                      {
+                        found_blank = true;
+                        break;
+                      }
+                  }
+
+                if (found_blank)
+                  {
+                    size_t i;
+
+                    /* Found a blank.  Don't output the part after it. */
+                    logical_end++;
+                    fwrite (line_out, sizeof (char), (size_t) logical_end,
+                            stdout);
+                    putchar ('\n');
+                    /* Move the remainder to the beginning of the next line.
+                       The areas being copied here might overlap. */
+                    memmove (line_out, line_out + logical_end,
+                             offset_out - logical_end);
+                    offset_out -= logical_end;
+                    for (column = i = 0; i < offset_out; i++)
+                      column = adjust_column (column, line_out[i]);
+                    goto rescan;
+                  }
+              }
+
+            if (offset_out == 0)
+              {
+                line_out[offset_out++] = c;
+                continue;
+              }
+
+            line_out[offset_out++] = '\n';
+            fwrite (line_out, sizeof (char), (size_t) offset_out, stdout);
+            column = offset_out = 0;
+            goto rescan;
+          }
+
+        line_out[offset_out++] = c;
+      }
 
   saved_errno = errno;
 
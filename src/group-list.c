@@ -23,6 +23,7 @@
 #include <sys/types.h>
 #include <pwd.h>
 #include <grp.h>
+#include <pthread.h>
 
 #include "system.h"
 #include "error.h"
@@ -30,6 +31,140 @@
 #include "quote.h"
 #include "group-list.h"
 
+/* Group names resolved ahead of printing by prefetch_group_names,
+   sorted by gid; NAME is null when the gid has no name.  */
+struct gid_name
+{
+  gid_t gid;
+  char *name;
+};
+
+static struct gid_name *prefetched;
+static size_t n_prefetched;
+
+static int
+gid_name_cmp (void const *a, void const *b)
+{
+  gid_t ga = ((struct gid_name const *) a)->gid;
+  gid_t gb = ((struct gid_name const *) b)->gid;
+  return ga < gb ? -1 : gb < ga;
+}
+
+/* Shared state for the threads resolving group names.  */
+struct gid_pool
+{
+  struct gid_name *ents;
+  size_t n_ents;
+  size_t next;                  /* Index of the next unclaimed entry.  */
+  pthread_mutex_t lock;
+};
+
+/* Claim entries from POOL_ARG and resolve each gid with getgrgid_r,
+   until none remain.  Entries are distinct, so only claiming an
+   index needs the lock.  */
+static void *
+group_name_thread (void *pool_arg)
+{
+  struct gid_pool *pool = pool_arg;
+  size_t bufsize = 1024;
+  char *buf = xmalloc (bufsize);
+
+  while (true)
+    {
+      pthread_mutex_lock (&pool->lock);
+      size_t i = pool->next;
+      if (i < pool->n_ents)
+        pool->next++;
+      pthread_mutex_unlock (&pool->lock);
+      if (pool->n_ents <= i)
+        break;
+
+      struct gid_name *ent = &pool->ents[i];
+      while (true)
+        {
+          struct group grp, *res;
+          int err = getgrgid_r (ent->gid, &grp, buf, bufsize, &res);
+          if (err == 0 && res)
+            ent->name = xstrdup (grp.gr_name);
+          if (err != ERANGE)
+            break;
+          buf = xrealloc (buf, bufsize *= 2);
+        }
+    }
+
+  free (buf);
+  return NULL;
+}
+
+/* Number of threads resolving group names concurrently.  Each cold
+   lookup against a networked group data base is a round trip, and a
+   directory-service user can be in a great many groups.  */
+enum { GROUP_LOOKUP_NTHREADS = 8 };
+
+/* Resolve the names of the N_GIDS group ids in GIDS concurrently,
+   so that the later per-group lookups are cache hits.  */
+extern void
+prefetch_group_names (gid_t const *gids, int n_gids)
+{
+  if (n_gids <= 1)
+    return;
+
+  struct gid_pool pool;
+  pool.ents = xnmalloc (n_gids, sizeof *pool.ents);
+  pool.n_ents = 0;
+  pool.next = 0;
+
+  for (int i = 0; i < n_gids; i++)
+    {
+      pool.ents[pool.n_ents].gid = gids[i];
+      pool.ents[pool.n_ents].name = NULL;
+      pool.n_ents++;
+    }
+  qsort (pool.ents, pool.n_ents, sizeof *pool.ents, gid_name_cmp);
+
+  /* Elide duplicates, which would otherwise be resolved twice.  */
+  size_t uniq = 0;
+  for (size_t i = 1; i < pool.n_ents; i++)
+    if (pool.ents[i].gid != pool.ents[uniq].gid)
+      pool.ents[++uniq] = pool.ents[i];
+  pool.n_ents = uniq + 1;
+
+  pthread_mutex_init (&pool.lock, NULL);
+  pthread_t threads[GROUP_LOOKUP_NTHREADS];
+  size_t nstarted = 0;
+  while (nstarted < MIN (GROUP_LOOKUP_NTHREADS, pool.n_ents) - 1
+         && pthread_create (&threads[nstarted], NULL,
+                            group_name_thread, &pool) == 0)
+    nstarted++;
+
+  group_name_thread (&pool);
+
+  for (size_t i = 0; i < nstarted; i++)
+    pthread_join (threads[i], NULL);
+  pthread_mutex_destroy (&pool.lock);
+
+  prefetched = pool.ents;
+  n_prefetched = pool.n_ents;
+}
+
+/* Return the name of GID, or NULL if it has none, preferring the
+   names resolved by prefetch_group_names over a serial lookup.  */
+extern char const *
+lookup_group_name (gid_t gid)
+{
+  if (n_prefetched)
+    {
+      struct gid_name key;
+      key.gid = gid;
+      struct gid_name *ent = bsearch (&key, prefetched, n_prefetched,
+                                      sizeof key, gid_name_cmp);
+      if (ent)
+        return ent->name;
+    }
+
+  struct group *grp = getgrgid (gid);
+  return grp ? grp->gr_name : NULL;
+}
 
 /* Print all of the distinct groups the user is in. */
 extern bool
@@ -75,6 +210,9 @@ print_group_list (char const *username,
         return false;
       }
 
+    if (use_names)
+      prefetch_group_names (groups, n_groups);
+
     for (int i = 0; i < n_groups; i++)
       if (groups[i] != rgid && groups[i] != egid)
         {
@@ -102,13 +240,13 @@ gidtostr_ptr (gid_t const *gid)
 extern bool
 print_group (gid_t gid, bool use_name)
 {
-  struct group *grp = NULL;
+  char const *name = NULL;
   bool ok = true;
 
   if (use_name)
     {
-      grp = getgrgid (gid);
-      if (grp == NULL)
+      name = lookup_group_name (gid);
+      if (name == NULL)
         {
           error (0, 0, _("cannot find name for group ID %lu"),
                  (unsigned long int) gid);
@@ -116,7 +254,6 @@ print_group (gid_t gid, bool use_name)
         }
     }
 
-  char *s = grp ? grp->gr_name : gidtostr (gid);
-  fputs (s, stdout);
+  fputs (name ? name : gidtostr (gid), stdout);
   return ok;
 }
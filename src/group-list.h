@@ -17,3 +17,5 @@
 
 bool print_group (gid_t, bool);
 bool print_group_list (char const *, uid_t, gid_t, gid_t, bool, char);
+void prefetch_group_names (gid_t const *, int);
+char const *lookup_group_name (gid_t);
@@ -34,6 +34,7 @@
 #include "die.h"
 #include "error.h"
 #include "full-read.h"
+#include "linescan.h"
 #include "quote.h"
 #include "safe-read.h"
 #include "stat-size.h"
@@ -187,6 +188,45 @@ xwrite_stdout (char const *buffer, size_t n_bytes)
     }
 }
 
+#ifdef SPLICE_F_MOVE
+/* Try to move at most N_BYTES from FD to standard output with
+   splice, which the kernel satisfies without copying the data
+   through user space whenever either side is a pipe.  Set *N_MOVED
+   to the number of bytes moved.  Return true when done, that is
+   when N_BYTES were moved or end of file was reached; return false
+   when splice cannot proceed, in which case the caller should copy
+   the rest through a buffer.  */
+
+static bool
+splice_to_stdout (int fd, uintmax_t n_bytes, uintmax_t *n_moved)
+{
+  *n_moved = 0;
+
+  /* Keep raw writes ordered after anything stdio has buffered.  */
+  if (fflush (stdout) != 0)
+    die (EXIT_FAILURE, errno, _("error writing %s"),
+         quoteaf ("standard output"));
+
+  while (*n_moved < n_bytes)
+    {
+      size_t n = MIN (n_bytes - *n_moved, (uintmax_t) SSIZE_MAX);
+      ssize_t spliced = splice (fd, NULL, STDOUT_FILENO, NULL, n,
+                                SPLICE_F_MOVE | SPLICE_F_MORE);
+      if (spliced == 0)
+        return true;
+      if (spliced < 0)
+        {
+          if (errno == EINTR)
+            continue;
+          return false;
+        }
+      *n_moved += spliced;
+    }
+
+  return true;
+}
+#endif
+
 /* Copy no more than N_BYTES from file descriptor SRC_FD to stdout.
    Return an appropriate indication of success or read failure.  */
 
@@ -196,6 +236,16 @@ copy_fd (int src_fd, uintmax_t n_bytes)
   char buf[BUFSIZ];
   const size_t buf_size = sizeof (buf);
 
+#ifdef SPLICE_F_MOVE
+  {
+    uintmax_t n_spliced;
+    bool done = splice_to_stdout (src_fd, n_bytes, &n_spliced);
+    n_bytes -= n_spliced;
+    if (done)
+      return n_bytes == 0 ? COPY_FD_OK : COPY_FD_UNEXPECTED_EOF;
+  }
+#endif
+
   /* Copy the file contents.  */
   while (0 < n_bytes)
     {
@@ -257,196 +307,132 @@ elide_tail_bytes_pipe (char const *filename, int fd, uintmax_t n_elide_0,
 #endif
 #define READ_BUFSIZE HEAD_TAIL_PIPE_READ_BUFSIZE
 
-  /* If we're eliding no more than this many bytes, then it's ok to allocate
-     more memory in order to use a more time-efficient algorithm.
-     FIXME: use a fraction of available memory instead, as in sort.
-     FIXME: is this even worthwhile?  */
-#ifndef HEAD_TAIL_PIPE_BYTECOUNT_THRESHOLD
-# define HEAD_TAIL_PIPE_BYTECOUNT_THRESHOLD 1024 * 1024
+  /* Buffer the pending elision window in a ring of segments of at
+     most this size, reading and writing a whole segment at a time so
+     the number of system calls does not grow with N_ELIDE.  */
+#ifndef HEAD_TAIL_PIPE_SEGMENT_MAX
+# define HEAD_TAIL_PIPE_SEGMENT_MAX (1024 * 1024)
 #endif
 
-#if HEAD_TAIL_PIPE_BYTECOUNT_THRESHOLD < 2 * READ_BUFSIZE
-  "HEAD_TAIL_PIPE_BYTECOUNT_THRESHOLD must be at least 2 * READ_BUFSIZE"
-#endif
+  size_t segment = MAX (READ_BUFSIZE,
+                        MIN (n_elide_0, HEAD_TAIL_PIPE_SEGMENT_MAX));
 
-  if (SIZE_MAX < n_elide_0 + READ_BUFSIZE)
+  if (SIZE_MAX - 2 * segment < n_elide_0)
     {
       char umax_buf[INT_BUFSIZE_BOUND (n_elide_0)];
       die (EXIT_FAILURE, 0, _("%s: number of bytes is too large"),
            umaxtostr (n_elide_0, umax_buf));
     }
 
-  /* Two cases to consider...
-     1) n_elide is small enough that we can afford to double-buffer:
-        allocate 2 * (READ_BUFSIZE + n_elide) bytes
-     2) n_elide is too big for that, so we allocate only
-        (READ_BUFSIZE + n_elide) bytes
-
-     FIXME: profile, to see if double-buffering is worthwhile
-
-     CAUTION: do not fail (out of memory) when asked to elide
-     a ridiculous amount, but when given only a small input.  */
-
-  if (n_elide <= HEAD_TAIL_PIPE_BYTECOUNT_THRESHOLD)
-    {
-      bool first = true;
-      bool eof = false;
-      size_t n_to_read = READ_BUFSIZE + n_elide;
-      bool i;
-      char *b[2];
-      b[0] = xnmalloc (2, n_to_read);
-      b[1] = b[0] + n_to_read;
-
-      for (i = false; ! eof ; i = !i)
-        {
-          size_t n_read = full_read (fd, b[i], n_to_read);
-          size_t delta = 0;
-          if (n_read < n_to_read)
-            {
-              if (errno != 0)
-                {
-                  error (0, errno, _("error reading %s"), quoteaf (filename));
-                  ok = false;
-                  break;
-                }
-
-              /* reached EOF */
-              if (n_read <= n_elide)
-                {
-                  if (first)
-                    {
-                      /* The input is no larger than the number of bytes
-                         to elide.  So there's nothing to output, and
-                         we're done.  */
-                    }
-                  else
-                    {
-                      delta = n_elide - n_read;
-                    }
-                }
-              eof = true;
-            }
-
-          /* Output any (but maybe just part of the) elided data from
-             the previous round.  */
-          if (! first)
-            {
-              desired_pos += n_elide - delta;
-              xwrite_stdout (b[!i] + READ_BUFSIZE, n_elide - delta);
-            }
-          first = false;
-
-          if (n_elide < n_read)
-            {
-              desired_pos += n_read - n_elide;
-              xwrite_stdout (b[i], n_read - n_elide);
-            }
-        }
-
-      free (b[0]);
-    }
-  else
-    {
-      /* Read blocks of size READ_BUFSIZE, until we've read at least n_elide
-         bytes.  Then, for each new buffer we read, also write an old one.  */
-
-      bool eof = false;
-      size_t n_read;
-      bool buffered_enough;
-      size_t i, i_next;
-      char **b = NULL;
-      /* Round n_elide up to a multiple of READ_BUFSIZE.  */
-      size_t rem = READ_BUFSIZE - (n_elide % READ_BUFSIZE);
-      size_t n_elide_round = n_elide + rem;
-      size_t n_bufs = n_elide_round / READ_BUFSIZE + 1;
-      size_t n_alloc = 0;
-      size_t n_array_alloc = 0;
-
-      buffered_enough = false;
-      for (i = 0, i_next = 1; !eof; i = i_next, i_next = (i_next + 1) % n_bufs)
-        {
-          if (n_array_alloc == i)
-            {
-              /* reallocate between 16 and n_bufs entries.  */
-              if (n_array_alloc == 0)
-                n_array_alloc = MIN (n_bufs, 16);
-              else if (n_array_alloc <= n_bufs / 2)
-                n_array_alloc *= 2;
-              else
-                n_array_alloc = n_bufs;
-              b = xnrealloc (b, n_array_alloc, sizeof *b);
-            }
+  {
+    /* Read blocks of size SEGMENT, until we've read at least n_elide
+       bytes.  Then, for each new buffer we read, also write an old one,
+       so each byte is read and written at most once.
+
+       CAUTION: do not fail (out of memory) when asked to elide
+       a ridiculous amount, but when given only a small input; the
+       segments are allocated only as the data actually arrives.  */
+
+    bool eof = false;
+    size_t n_read;
+    bool buffered_enough;
+    size_t i, i_next;
+    char **b = NULL;
+    /* Round n_elide up to a multiple of SEGMENT.  */
+    size_t rem = segment - (n_elide % segment);
+    size_t n_elide_round = n_elide + rem;
+    size_t n_bufs = n_elide_round / segment + 1;
+    size_t n_alloc = 0;
+    size_t n_array_alloc = 0;
+
+    buffered_enough = false;
+    for (i = 0, i_next = 1; !eof; i = i_next, i_next = (i_next + 1) % n_bufs)
+      {
+        if (n_array_alloc == i)
+          {
+            /* reallocate between 16 and n_bufs entries.  */
+            if (n_array_alloc == 0)
+              n_array_alloc = MIN (n_bufs, 16);
+            else if (n_array_alloc <= n_bufs / 2)
+              n_array_alloc *= 2;
+            else
+              n_array_alloc = n_bufs;
+            b = xnrealloc (b, n_array_alloc, sizeof *b);
+          }
 
-          if (! buffered_enough)
-            {
-              b[i] = xmalloc (READ_BUFSIZE);
-              n_alloc = i + 1;
-            }
-          n_read = full_read (fd, b[i], READ_BUFSIZE);
-          if (n_read < READ_BUFSIZE)
-            {
-              if (errno != 0)
-                {
-                  error (0, errno, _("error reading %s"), quoteaf (filename));
-                  ok = false;
-                  goto free_mem;
-                }
-              eof = true;
-            }
+        if (! buffered_enough)
+          {
+            b[i] = xmalloc (segment);
+            n_alloc = i + 1;
+          }
+        n_read = full_read (fd, b[i], segment);
+        if (n_read < segment)
+          {
+            if (errno != 0)
+              {
+                error (0, errno, _("error reading %s"), quoteaf (filename));
+                ok = false;
+                goto free_mem;
+              }
+            eof = true;
+          }
 
-          if (i + 1 == n_bufs)
-            buffered_enough = true;
+        if (i + 1 == n_bufs)
+          buffered_enough = true;
 
-          if (buffered_enough)
-            {
-              desired_pos += n_read;
-              xwrite_stdout (b[i_next], n_read);
-            }
-        }
+        if (buffered_enough)
+          {
+            desired_pos += n_read;
+            xwrite_stdout (b[i_next], n_read);
+          }
+      }
 
-      /* Output any remainder: rem bytes from b[i] + n_read.  */
-      if (rem)
-        {
-          if (buffered_enough)
-            {
-              size_t n_bytes_left_in_b_i = READ_BUFSIZE - n_read;
-              desired_pos += rem;
-              if (rem < n_bytes_left_in_b_i)
-                {
-                  xwrite_stdout (b[i] + n_read, rem);
-                }
-              else
-                {
-                  xwrite_stdout (b[i] + n_read, n_bytes_left_in_b_i);
-                  xwrite_stdout (b[i_next], rem - n_bytes_left_in_b_i);
-                }
-            }
-          else if (i + 1 == n_bufs)
-            {
-              /* This happens when n_elide < file_size < n_elide_round.
-
-                 |READ_BUF.|
-                 |                      |  rem |
-                 |---------!---------!---------!---------|
-                 |---- n_elide ---------|
-                 |                      | x |
-                 |                   |y |
-                 |---- file size -----------|
-                 |                   |n_read|
-                 |---- n_elide_round ----------|
-               */
-              size_t y = READ_BUFSIZE - rem;
-              size_t x = n_read - y;
-              desired_pos += x;
-              xwrite_stdout (b[i_next], x);
-            }
-        }
+    /* Output any remainder: rem bytes from b[i] + n_read.  */
+    if (rem)
+      {
+        if (buffered_enough)
+          {
+            size_t n_bytes_left_in_b_i = segment - n_read;
+            desired_pos += rem;
+            if (rem < n_bytes_left_in_b_i)
+              {
+                xwrite_stdout (b[i] + n_read, rem);
+              }
+            else
+              {
+                xwrite_stdout (b[i] + n_read, n_bytes_left_in_b_i);
+                xwrite_stdout (b[i_next], rem - n_bytes_left_in_b_i);
+              }
+          }
+        else if (i + 1 == n_bufs)
+          {
+            /* This happens when n_elide < file_size < n_elide_round.
+
+               |SEGMENT..|
+               |                      |  rem |
+               |---------!---------!---------!---------|
+               |---- n_elide ---------|
+               |                      | x |
+               |                   |y |
+               |---- file size -----------|
+               |                   |n_read|
+               |---- n_elide_round ----------|
+             */
+            size_t y = segment - rem;
+            if (y < n_read)
+              {
+                size_t x = n_read - y;
+                desired_pos += x;
+                xwrite_stdout (b[i_next], x);
+              }
+          }
+      }
 
-    free_mem:
-      for (i = 0; i < n_alloc; i++)
-        free (b[i]);
-      free (b);
-    }
+  free_mem:
+    for (i = 0; i < n_alloc; i++)
+      free (b[i]);
+    free (b);
+  }
 
   if (0 <= current_pos && elseek (fd, desired_pos, SEEK_SET, filename) < 0)
     ok = false;
@@ -509,6 +495,7 @@ elide_tail_lines_pipe (char const *filename, int fd, uintmax_t n_elide,
   typedef struct linebuffer LBUFFER;
   LBUFFER *first, *last, *tmp;
   size_t total_lines = 0;	/* Total number of newlines in all buffers.  */
+  bool long_lines = false;	/* Line length heuristic for count_delims.  */
   bool ok = true;
   size_t n_read;		/* Size in bytes of most recent read */
 
@@ -538,15 +525,7 @@ elide_tail_lines_pipe (char const *filename, int fd, uintmax_t n_elide,
       tmp->next = NULL;
 
       /* Count the number of newlines just read.  */
-      {
-        char const *buffer_end = tmp->buffer + n_read;
-        char const *p = tmp->buffer;
-        while ((p = memchr (p, line_end, buffer_end - p)))
-          {
-            ++p;
-            ++tmp->nlines;
-          }
-      }
+      tmp->nlines = count_delims (tmp->buffer, n_read, line_end, &long_lines);
       total_lines += tmp->nlines;
 
       /* If there is enough room in the last buffer read, just append the new
@@ -606,15 +585,8 @@ elide_tail_lines_pipe (char const *filename, int fd, uintmax_t n_elide,
   /* Print the first 'total_lines - n_elide' lines of tmp->buffer.  */
   if (n_elide < total_lines)
     {
-      size_t n = total_lines - n_elide;
-      char const *buffer_end = tmp->buffer + tmp->nbytes;
-      char const *p = tmp->buffer;
-      while (n && (p = memchr (p, line_end, buffer_end - p)))
-        {
-          ++p;
-          ++tmp->nlines;
-          --n;
-        }
+      uintmax_t n = total_lines - n_elide;
+      char const *p = skip_delims (tmp->buffer, tmp->nbytes, line_end, &n);
       desired_pos += p - tmp->buffer;
       xwrite_stdout (tmp->buffer, p - tmp->buffer);
     }
@@ -678,47 +650,42 @@ elide_tail_lines_seekable (char const *pretty_filename, int fd,
 
   while (1)
     {
-      /* Scan backward, counting the newlines in this bufferfull.  */
+      /* Scan backward, counting the newlines in this bufferfull.
+         With ALL_LINES, nothing is elided, so the boundary is simply
+         the last byte read.  */
 
-      size_t n = bytes_read;
-      while (n)
+      char const *nl;
+      if (all_lines)
+        nl = bytes_read ? buffer + (bytes_read - 1) : NULL;
+      else
+        nl = rskip_delims (buffer, bytes_read, line_end, &n_lines);
+      if (nl)
         {
-          if (all_lines)
-            n -= 1;
-          else
-            {
-              char const *nl;
-              nl = memrchr (buffer, line_end, n);
-              if (nl == NULL)
-                break;
-              n = nl - buffer;
-            }
-          if (n_lines-- == 0)
+          /* Found it.  */
+          size_t n = nl - buffer;
+
+          /* If necessary, restore the file pointer and copy
+             input to output up to position, POS.  */
+          if (start_pos < pos)
             {
-              /* Found it.  */
-              /* If necessary, restore the file pointer and copy
-                 input to output up to position, POS.  */
-              if (start_pos < pos)
+              enum Copy_fd_status err;
+              if (elseek (fd, start_pos, SEEK_SET, pretty_filename) < 0)
+                return false;
+
+              err = copy_fd (fd, pos - start_pos);
+              if (err != COPY_FD_OK)
                 {
-                  enum Copy_fd_status err;
-                  if (elseek (fd, start_pos, SEEK_SET, pretty_filename) < 0)
-                    return false;
-
-                  err = copy_fd (fd, pos - start_pos);
-                  if (err != COPY_FD_OK)
-                    {
-                      diagnose_copy_fd_failure (err, pretty_filename);
-                      return false;
-                    }
+                  diagnose_copy_fd_failure (err, pretty_filename);
+                  return false;
                 }
+            }
 
-              /* Output the initial portion of the buffer
-                 in which we found the desired newline byte.  */
-              xwrite_stdout (buffer, n + 1);
+          /* Output the initial portion of the buffer
+             in which we found the desired newline byte.  */
+          xwrite_stdout (buffer, n + 1);
 
-              /* Set file pointer to the byte after what we've output.  */
-              return 0 <= elseek (fd, pos + n + 1, SEEK_SET, pretty_filename);
-            }
+          /* Set file pointer to the byte after what we've output.  */
+          return 0 <= elseek (fd, pos + n + 1, SEEK_SET, pretty_filename);
         }
 
       /* Not enough newlines in that bufferfull.  */
@@ -776,6 +743,15 @@ head_bytes (char const *filename, int fd, uintmax_t bytes_to_write)
   char buffer[BUFSIZ];
   size_t bytes_to_read = BUFSIZ;
 
+#ifdef SPLICE_F_MOVE
+  {
+    uintmax_t n_spliced;
+    if (splice_to_stdout (fd, bytes_to_write, &n_spliced))
+      return true;
+    bytes_to_write -= n_spliced;
+  }
+#endif
+
   while (bytes_to_write)
     {
       size_t bytes_read;
@@ -795,6 +771,40 @@ head_bytes (char const *filename, int fd, uintmax_t bytes_to_write)
   return true;
 }
 
+/* For the seekable regular file with name FILENAME and descriptor FD,
+   positioned at START_POS, output the next LINES_TO_WRITE lines.
+   Locate the boundary of the last line first, reading but writing
+   nothing, then move the prefix as one byte range through head_bytes,
+   which splices it through the kernel when it can.  Return true upon
+   success.  Give a diagnostic and return false upon error.  */
+
+static bool
+head_lines_seekable (char const *filename, int fd, uintmax_t lines_to_write,
+                     off_t start_pos)
+{
+  char buffer[BUFSIZ];
+  off_t end_pos = start_pos;
+
+  while (lines_to_write)
+    {
+      size_t bytes_read = safe_read (fd, buffer, BUFSIZ);
+      if (bytes_read == SAFE_READ_ERROR)
+        {
+          error (0, errno, _("error reading %s"), quoteaf (filename));
+          return false;
+        }
+      if (bytes_read == 0)
+        break;
+      char const *p = skip_delims (buffer, bytes_read, line_end,
+                                   &lines_to_write);
+      end_pos += p ? p - buffer : bytes_read;
+    }
+
+  if (elseek (fd, start_pos, SEEK_SET, filename) < 0)
+    return false;
+  return head_bytes (filename, fd, end_pos - start_pos);
+}
+
 static bool
 head_lines (char const *filename, int fd, uintmax_t lines_to_write)
 {
@@ -803,7 +813,7 @@ head_lines (char const *filename, int fd, uintmax_t lines_to_write)
   while (lines_to_write)
     {
       size_t bytes_read = safe_read (fd, buffer, BUFSIZ);
-      size_t bytes_to_write = 0;
+      size_t bytes_to_write;
 
       if (bytes_read == SAFE_READ_ERROR)
         {
@@ -812,21 +822,24 @@ head_lines (char const *filename, int fd, uintmax_t lines_to_write)
         }
       if (bytes_read == 0)
         break;
-      while (bytes_to_write < bytes_read)
-        if (buffer[bytes_to_write++] == line_end && --lines_to_write == 0)
-          {
-            off_t n_bytes_past_EOL = bytes_read - bytes_to_write;
-            /* If we have read more data than that on the specified number
-               of lines, try to seek back to the position we would have
-               gotten to had we been reading one byte at a time.  */
-            if (lseek (fd, -n_bytes_past_EOL, SEEK_CUR) < 0)
-              {
-                struct stat st;
-                if (fstat (fd, &st) != 0 || S_ISREG (st.st_mode))
-                  elseek (fd, -n_bytes_past_EOL, SEEK_CUR, filename);
-              }
-            break;
-          }
+      char const *p = skip_delims (buffer, bytes_read, line_end,
+                                   &lines_to_write);
+      if (p)
+        {
+          bytes_to_write = p - buffer;
+          off_t n_bytes_past_EOL = bytes_read - bytes_to_write;
+          /* If we have read more data than that on the specified number
+             of lines, try to seek back to the position we would have
+             gotten to had we been reading one byte at a time.  */
+          if (lseek (fd, -n_bytes_past_EOL, SEEK_CUR) < 0)
+            {
+              struct stat st;
+              if (fstat (fd, &st) != 0 || S_ISREG (st.st_mode))
+                elseek (fd, -n_bytes_past_EOL, SEEK_CUR, filename);
+            }
+        }
+      else
+        bytes_to_write = bytes_read;
       xwrite_stdout (buffer, bytes_to_write);
     }
   return true;
@@ -861,7 +874,21 @@ head (char const *filename, int fd, uintmax_t n_units, bool count_lines,
         return elide_tail_bytes_file (filename, fd, n_units, &st, current_pos);
     }
   if (count_lines)
-    return head_lines (filename, fd, n_units);
+    {
+      /* For a seekable regular file, separate finding the boundary
+         from moving the data, so the prefix goes to stdout without
+         passing through user space.  */
+      struct stat st;
+      if (! presume_input_pipe && 0 < n_units
+          && fstat (fd, &st) == 0 && S_ISREG (st.st_mode)
+          && usable_st_size (&st))
+        {
+          off_t current_pos = lseek (fd, 0, SEEK_CUR);
+          if (0 <= current_pos)
+            return head_lines_seekable (filename, fd, n_units, current_pos);
+        }
+      return head_lines (filename, fd, n_units);
+    }
   else
     return head_bytes (filename, fd, n_units);
 }
@@ -406,6 +406,8 @@ print_full_info (char const *username)
         return;
       }
 
+    prefetch_group_names (groups, n_groups);
+
     if (n_groups > 0)
       fputs (_(" groups="), stdout);
     for (int i = 0; i < n_groups; i++)
@@ -413,9 +415,9 @@ print_full_info (char const *username)
         if (i > 0)
           putchar (',');
         fputs (gidtostr (groups[i]), stdout);
-        grp = getgrgid (groups[i]);
-        if (grp)
-          printf ("(%s)", grp->gr_name);
+        char const *name = lookup_group_name (groups[i]);
+        if (name)
+          printf ("(%s)", name);
       }
     free (groups);
   }
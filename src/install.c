@@ -32,8 +32,10 @@
 #include "cp-hash.h"
 #include "copy.h"
 #include "die.h"
+#include "dir-set.h"
 #include "filenamecat.h"
 #include "full-read.h"
+#include "ioblksize.h"
 #include "mkancesdirs.h"
 #include "mkdir-p.h"
 #include "modechange.h"
@@ -110,7 +112,8 @@ static char const *strip_program = "strip";
    non-character as a pseudo short option, starting with CHAR_MAX + 1.  */
 enum
 {
-  PRESERVE_CONTEXT_OPTION = CHAR_MAX + 1,
+  FSYNC_OPTION = CHAR_MAX + 1,
+  PRESERVE_CONTEXT_OPTION,
   STRIP_PROGRAM_OPTION
 };
 
@@ -120,6 +123,7 @@ static struct option const long_options[] =
   {"compare", no_argument, NULL, 'C'},
   {GETOPT_SELINUX_CONTEXT_OPTION_DECL},
   {"directory", no_argument, NULL, 'd'},
+  {"fsync", no_argument, NULL, FSYNC_OPTION},
   {"group", required_argument, NULL, 'g'},
   {"mode", required_argument, NULL, 'm'},
   {"no-target-directory", no_argument, NULL, 'T'},
@@ -141,13 +145,18 @@ static struct option const long_options[] =
 static bool
 have_same_content (int a_fd, int b_fd)
 {
-  enum { CMP_BLOCK_SIZE = 4096 };
-  static char a_buff[CMP_BLOCK_SIZE];
-  static char b_buff[CMP_BLOCK_SIZE];
+  static char *a_buff;
+  static char *b_buff;
+
+  if (!a_buff)
+    {
+      a_buff = xmalloc (IO_BUFSIZE);
+      b_buff = xmalloc (IO_BUFSIZE);
+    }
 
   size_t size;
-  while (0 < (size = full_read (a_fd, a_buff, sizeof a_buff))) {
-    if (size != full_read (b_fd, b_buff, sizeof b_buff))
+  while (0 < (size = full_read (a_fd, a_buff, IO_BUFSIZE))) {
+    if (size != full_read (b_fd, b_buff, IO_BUFSIZE))
       return false;
 
     if (memcmp (a_buff, b_buff, size) != 0)
@@ -236,6 +245,10 @@ need_copy (char const *src_name, char const *dest_name,
         return true;
     }
 
+  /* the same inode (e.g., via a hard link) needs no reading at all */
+  if (SAME_INODE (src_sb, dest_sb))
+    return false;
+
   /* compare files content */
   src_fd = open (src_name, O_RDONLY | O_BINARY);
   if (src_fd < 0)
@@ -623,6 +636,8 @@ In the 4th form, create all components of the given DIRECTORY(ies).\n\
   -D                  create all leading components of DEST except the last,\n\
                         or all components of --target-directory,\n\
                         then copy SOURCE to DEST\n\
+      --fsync         sync each installed file to disk before exiting;\n\
+                        the syncs are issued in overlapping batches\n\
   -g, --group=GROUP   set group ownership, instead of process' current group\n\
   -m, --mode=MODE     set permission mode (as in chmod), instead of rwxr-xr-x\n\
   -o, --owner=OWNER   set ownership (super-user only)\n\
@@ -670,12 +685,18 @@ install_file_in_file (char const *from, char const *to,
   if (! copy_file (from, to, x))
     return false;
   if (strip_files)
-    if (! strip (to))
-      {
-        if (unlink (to) != 0)  /* Cleanup.  */
-          die (EXIT_FAILURE, errno, _("cannot unlink %s"), quoteaf (to));
+    {
+      if (! strip (to))
+        {
+          if (unlink (to) != 0)  /* Cleanup.  */
+            die (EXIT_FAILURE, errno, _("cannot unlink %s"), quoteaf (to));
+          return false;
+        }
+      /* The fsync queued when copying covered only the pre-strip
+         contents; queue the stripped result as well.  */
+      if (x->require_fsync && ! copy_defer_fsync (to))
         return false;
-      }
+    }
   if (x->preserve_timestamps && (strip_files || ! S_ISREG (from_sb.st_mode))
       && ! change_timestamps (&from_sb, to))
     return false;
@@ -690,6 +711,20 @@ static bool
 mkancesdirs_safe_wd (char const *from, char *to, struct cp_options *x,
                      bool save_always)
 {
+  /* If an earlier file already created or verified TO's parent, the
+     ancestor walk (and the working-directory dance protecting it) can
+     be skipped outright.  */
+  size_t dirlen = dir_len (to);
+  char *to_dir = NULL;
+  if (dirlen != 0)
+    {
+      to_dir = alloca (dirlen + 1);
+      memcpy (to_dir, to, dirlen);
+      to_dir[dirlen] = '\0';
+      if (dir_set_contains (to_dir))
+        return true;
+    }
+
   bool save_working_directory =
     save_always
     || ! (IS_ABSOLUTE_FILE_NAME (from) && IS_ABSOLUTE_FILE_NAME (to));
@@ -720,6 +755,9 @@ mkancesdirs_safe_wd (char const *from, char *to, struct cp_options *x,
           return false;
         }
     }
+
+  if (status == EXIT_SUCCESS && to_dir)
+    dir_set_insert (to_dir);
   return status == EXIT_SUCCESS;
 }
 
@@ -816,6 +854,9 @@ main (int argc, char **argv)
           strip_program = xstrdup (optarg);
           strip_program_specified = true;
           break;
+        case FSYNC_OPTION:
+          x.require_fsync = true;
+          break;
         case 'd':
           dir_arg = true;
           break;
@@ -1002,6 +1043,9 @@ main (int argc, char **argv)
          required by copy.c::copy. */
       hash_init ();
 
+      if (mkdir_and_install)
+        dir_set_init ();
+
       if (!target_directory)
         {
           if (! (mkdir_and_install
@@ -1020,5 +1064,8 @@ main (int argc, char **argv)
         }
     }
 
+  if (x.require_fsync && ! copy_flush_fsync ())
+    exit_status = EXIT_FAILURE;
+
   return exit_status;
 }
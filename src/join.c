@@ -27,9 +27,12 @@
 #include "error.h"
 #include "fadvise.h"
 #include "hard-locale.h"
+#include "hash.h"
 #include "linebuffer.h"
+#include "linebuffer-span.h"
 #include "memcasecmp.h"
 #include "quote.h"
+#include "sorted-cache.h"
 #include "stdio--.h"
 #include "xmemcoll.h"
 #include "xstrtol.h"
@@ -116,6 +119,14 @@ static bool seen_unpairable;
 /* If nonzero, we have warned about disorder in that file. */
 static bool issued_disorder_warning[2];
 
+/* Name of the index of inputs already verified to be sorted,
+   or NULL if no index was requested.  */
+static char const *sorted_cache_file;
+
+/* If nonzero, the sorted order of that file is recorded in the index,
+   so per-line order checks can be skipped.  */
+static bool input_verified[2];
+
 /* Empty output field filler.  */
 static char const *empty_filler;
 
@@ -130,6 +141,15 @@ static size_t autocount_2;
 static size_t join_field_1 = SIZE_MAX;
 static size_t join_field_2 = SIZE_MAX;
 
+/* Field the files past the second join on in a multi-way join,
+   settable only via -j; SIZE_MAX means not determined yet.  */
+static size_t join_field_multi = SIZE_MAX;
+
+/* Input files past the second, for a multi-way join.  */
+static char **extra_names;
+static size_t n_extra_names;
+static size_t extra_names_alloc;
+
 /* List of fields to print.  */
 static struct outlist outlist_head;
 
@@ -153,7 +173,9 @@ enum
 {
   CHECK_ORDER_OPTION = CHAR_MAX + 1,
   NOCHECK_ORDER_OPTION,
-  HEADER_LINE_OPTION
+  HEADER_LINE_OPTION,
+  SORTED_CACHE_OPTION,
+  UNSORTED_OPTION
 };
 
 
@@ -164,6 +186,8 @@ static struct option const longopts[] =
   {"nocheck-order", no_argument, NULL, NOCHECK_ORDER_OPTION},
   {"zero-terminated", no_argument, NULL, 'z'},
   {"header", no_argument, NULL, HEADER_LINE_OPTION},
+  {"sorted-cache", required_argument, NULL, SORTED_CACHE_OPTION},
+  {"unsorted", no_argument, NULL, UNSORTED_OPTION},
   {GETOPT_HELP_OPTION_DECL},
   {GETOPT_VERSION_OPTION_DECL},
   {NULL, 0, NULL, 0}
@@ -179,6 +203,10 @@ static bool ignore_case;
    join them without checking for ordering */
 static bool join_header_lines;
 
+/* If nonzero, pair lines with a hash table rather than a merge, so
+   the inputs need not be sorted.  */
+static bool hash_join;
+
 /* The character marking end of line. Default to \n. */
 static char eolchar = '\n';
 
@@ -190,7 +218,7 @@ usage (int status)
   else
     {
       printf (_("\
-Usage: %s [OPTION]... FILE1 FILE2\n\
+Usage: %s [OPTION]... FILE1 FILE2 [FILE]...\n\
 "),
               program_name);
       fputs (_("\
@@ -200,6 +228,12 @@ standard output.  The default join field is the first, delimited by blanks.\
 "), stdout);
       fputs (_("\
 \n\
+With more than two files, merge-join all of them in one pass, writing\n\
+only groups present in every file; files past the second join on the\n\
+-j field (or the first), and -a, -v, -o and --unsorted do not apply.\n\
+"), stdout);
+      fputs (_("\
+\n\
 When FILE1 or FILE2 (not both) is -, read standard input.\n\
 "), stdout);
       fputs (_("\
@@ -223,6 +257,12 @@ When FILE1 or FILE2 (not both) is -, read standard input.\n\
       --nocheck-order    do not check that the input is correctly sorted\n\
       --header           treat the first line in each file as field headers,\n\
                            print them without trying to pair them\n\
+      --sorted-cache=FILE  with --check-order, record inputs verified to be\n\
+                           sorted in index FILE, and skip the order checks\n\
+                           for inputs already recorded there\n\
+      --unsorted         pair lines with a hash table instead of a merge,\n\
+                           so the inputs need not be sorted; FILE1 is read\n\
+                           entirely into memory\n\
 "), stdout);
       fputs (_("\
   -z, --zero-terminated  line delimiter is NUL, not newline\n\
@@ -395,6 +435,9 @@ check_order (const struct line *prev,
              const struct line *current,
              int whatfile)
 {
+  if (input_verified[whatfile - 1])
+    return;
+
   if (check_input_order != CHECK_ORDER_DISABLED
       && ((check_input_order == CHECK_ORDER_ENABLED) || seen_unpairable))
     {
@@ -459,7 +502,7 @@ get_line (FILE *fp, struct line **linep, int which)
   else
     line = init_linep (linep);
 
-  if (! readlinebuffer_delim (&line->buf, fp, eolchar))
+  if (! readlinebuffer_span (&line->buf, fp, eolchar))
     {
       if (ferror (fp))
         die (EXIT_FAILURE, errno, _("read error"));
@@ -809,6 +852,453 @@ join (FILE *fp1, FILE *fp2)
   delseq (&seq2);
 }
 
+/* Set *KEY and *KEY_LEN to the join field of LINE (zero-based field
+   JF), or to NULL and 0 when the field is absent.  */
+
+static void
+line_key (struct line const *line, size_t jf,
+          char const **key, size_t *key_len)
+{
+  if (jf < line->nfields)
+    {
+      *key = line->fields[jf].beg;
+      *key_len = line->fields[jf].len;
+    }
+  else
+    {
+      *key = NULL;
+      *key_len = 0;
+    }
+}
+
+/* A group of FILE1 lines sharing a join field value, for --unsorted.  */
+
+struct hashed_group
+{
+  char const *key;		/* The join field bytes, within LINES[0].  */
+  size_t key_len;
+  struct line **lines;
+  size_t count;
+  size_t alloc;
+  bool matched;			/* A FILE2 line has joined with this group.  */
+};
+
+/* A FILE1 line in input order, with the group it belongs to.  */
+
+struct hashed_line
+{
+  struct line *line;
+  struct hashed_group *group;
+};
+
+static size_t
+hashed_group_hash (void const *x, size_t table_size)
+{
+  struct hashed_group const *g = x;
+  size_t h = 0;
+
+  /* FNV-1a, folding case when comparisons do.  */
+  for (size_t i = 0; i < g->key_len; i++)
+    {
+      unsigned char c = g->key[i];
+      if (ignore_case)
+        c = tolower (c);
+      h = (h ^ c) * 16777619;
+    }
+
+  return h % table_size;
+}
+
+static bool
+hashed_group_compare (void const *x, void const *y)
+{
+  struct hashed_group const *a = x;
+  struct hashed_group const *b = y;
+  if (a->key_len != b->key_len)
+    return false;
+  if (a->key_len == 0)
+    return true;
+  return (ignore_case
+          ? memcasecmp (a->key, b->key, a->key_len)
+          : memcmp (a->key, b->key, a->key_len)) == 0;
+}
+
+static void
+hashed_group_free (void *x)
+{
+  struct hashed_group *g = x;
+  free (g->lines);
+  free (g);
+}
+
+/* Print the join of FP1 and FP2 using a hash table, so neither input
+   need be sorted.  FILE1 is read entirely into memory and grouped by
+   join field, then FILE2 streams past it.  Keys match byte for byte
+   (case-folded with -i), rather than by LC_COLLATE equivalence.
+   Pairable lines are output in FILE2 order, with matching FILE1 lines
+   in input order within each pairing; unpairable FILE1 lines follow
+   at the end, in input order.  */
+
+static void
+join_hash (FILE *fp1, FILE *fp2)
+{
+  struct line *line1 = NULL;
+  struct line *line2 = NULL;
+  struct hashed_line *file1 = NULL;
+  size_t n_file1 = 0;
+  size_t n_alloc = 0;
+
+  fadvise (fp1, FADVISE_SEQUENTIAL);
+  fadvise (fp2, FADVISE_SEQUENTIAL);
+
+  Hash_table *table = hash_initialize (61, NULL, hashed_group_hash,
+                                       hashed_group_compare,
+                                       hashed_group_free);
+  if (! table)
+    xalloc_die ();
+
+  bool got1 = get_line (fp1, &line1, 1);
+  bool got2 = get_line (fp2, &line2, 2);
+
+  if (autoformat)
+    {
+      autocount_1 = got1 ? line1->nfields : 0;
+      autocount_2 = got2 ? line2->nfields : 0;
+    }
+
+  if (join_header_lines && (got1 || got2))
+    {
+      prjoin (got1 ? line1 : &uni_blank, got2 ? line2 : &uni_blank);
+      prevline[0] = NULL;
+      prevline[1] = NULL;
+      if (got1)
+        {
+          freeline (line1);
+          free (line1);
+          line1 = NULL;
+          got1 = get_line (fp1, &line1, 1);
+        }
+      if (got2)
+        got2 = get_line (fp2, &line2, 2);
+    }
+
+  /* Build phase: group all FILE1 lines by join field.  */
+  while (got1)
+    {
+      struct hashed_group probe;
+      line_key (line1, join_field_1, &probe.key, &probe.key_len);
+
+      struct hashed_group *g = hash_lookup (table, &probe);
+      if (! g)
+        {
+          g = xcalloc (1, sizeof *g);
+          g->key = probe.key;
+          g->key_len = probe.key_len;
+          if (hash_insert (table, g) == NULL)
+            xalloc_die ();
+        }
+      if (g->count == g->alloc)
+        g->lines = x2nrealloc (g->lines, &g->alloc, sizeof *g->lines);
+      g->lines[g->count++] = line1;
+
+      if (n_file1 == n_alloc)
+        file1 = x2nrealloc (file1, &n_alloc, sizeof *file1);
+      file1[n_file1].line = line1;
+      file1[n_file1].group = g;
+      n_file1++;
+
+      line1 = NULL;		/* Retained by its group.  */
+      got1 = get_line (fp1, &line1, 1);
+    }
+  free (line1);
+
+  /* Probe phase: stream FILE2 past the table.  */
+  while (got2)
+    {
+      struct hashed_group probe;
+      line_key (line2, join_field_2, &probe.key, &probe.key_len);
+
+      struct hashed_group *g = hash_lookup (table, &probe);
+      if (g)
+        {
+          g->matched = true;
+          if (print_pairables)
+            for (size_t i = 0; i < g->count; i++)
+              prjoin (g->lines[i], line2);
+        }
+      else if (print_unpairables_2)
+        prjoin (&uni_blank, line2);
+
+      got2 = get_line (fp2, &line2, 2);
+    }
+  freeline (line2);
+  free (line2);
+
+  if (print_unpairables_1)
+    for (size_t i = 0; i < n_file1; i++)
+      if (! file1[i].group->matched)
+        prjoin (file1[i].line, &uni_blank);
+
+  for (size_t i = 0; i < n_file1; i++)
+    {
+      freeline (file1[i].line);
+      free (file1[i].line);
+    }
+  free (file1);
+  hash_free (table);
+  prevline[0] = NULL;
+  prevline[1] = NULL;
+}
+
+/* A cursor over one presorted input of a multi-way join.  Unlike the
+   two-way engine, which threads its state through per-file globals,
+   each cursor owns its lines outright: the current group of lines
+   sharing a join field value, plus one lookahead line that begins the
+   following group.  */
+
+struct mcursor
+{
+  FILE *fp;
+  char const *name;
+  size_t join_field;
+  struct seq seq;		/* Lines of the current key group.  */
+  struct line *ahead;		/* First line of the following group.  */
+  bool have_ahead;
+  uintmax_t line_no;
+  bool warned;			/* A disorder diagnostic was issued.  */
+};
+
+/* Read a line from C into *LINEP, reusing its buffers, and split it
+   into fields.  Return true if successful.  */
+
+static bool
+mcur_read (struct mcursor *c, struct line **linep)
+{
+  struct line *line = *linep;
+
+  if (line)
+    reset_line (line);
+  else
+    line = init_linep (linep);
+
+  if (! readlinebuffer_span (&line->buf, c->fp, eolchar))
+    {
+      if (ferror (c->fp))
+        die (EXIT_FAILURE, errno, _("read error"));
+      return false;
+    }
+  ++c->line_no;
+
+  xfields (line);
+  return true;
+}
+
+/* Diagnose that C's lookahead line sorts before its current group,
+   under the same conditions check_order uses.  */
+
+static void
+mcur_disorder (struct mcursor *c)
+{
+  if (c->warned
+      || check_input_order == CHECK_ORDER_DISABLED
+      || ! (check_input_order == CHECK_ORDER_ENABLED || seen_unpairable))
+    return;
+
+  size_t len = c->ahead->buf.length;
+  if (0 < len && c->ahead->buf.buffer[len - 1] == eolchar)
+    --len;
+  len = MIN (INT_MAX, len);
+
+  error ((check_input_order == CHECK_ORDER_ENABLED ? EXIT_FAILURE : 0),
+         0, _("%s:%"PRIuMAX": is not sorted: %.*s"),
+         c->name, c->line_no, (int) len, c->ahead->buf.buffer);
+
+  c->warned = true;
+  issued_disorder_warning[0] = true;
+}
+
+/* Replace C's current group with the next one, gathering lines as
+   long as their join fields match the lookahead that heads the group.
+   Return false when the input is exhausted.  */
+
+static bool
+mcur_advance (struct mcursor *c)
+{
+  if (! c->have_ahead)
+    {
+      c->seq.count = 0;
+      return false;
+    }
+
+  c->seq.count = 0;
+  while (true)
+    {
+      if (c->seq.count == c->seq.alloc)
+        {
+          c->seq.lines = X2NREALLOC (c->seq.lines, &c->seq.alloc);
+          for (size_t i = c->seq.count; i < c->seq.alloc; i++)
+            c->seq.lines[i] = NULL;
+        }
+      SWAPLINES (c->seq.lines[c->seq.count], c->ahead);
+      ++c->seq.count;
+
+      if (! mcur_read (c, &c->ahead))
+        {
+          c->have_ahead = false;
+          return true;
+        }
+
+      int diff = keycmp (c->seq.lines[0], c->ahead,
+                         c->join_field, c->join_field);
+      if (diff != 0)
+        {
+          if (0 < diff)
+            mcur_disorder (c);
+          return true;
+        }
+    }
+}
+
+/* Print one multi-way joined line, assembled from one line of each of
+   the NFILES cursors in PICKS: the join field, then the other fields
+   of every line in file order.  */
+
+static void
+prjoin_multi (size_t nfiles, struct mcursor const *cur,
+              struct line const **picks)
+{
+  prfield (cur[0].join_field, picks[0]);
+  for (size_t i = 0; i < nfiles; i++)
+    prfields (picks[i], cur[i].join_field, 0);
+  putchar (eolchar);
+}
+
+/* Print the cross product of the current groups of the NFILES
+   cursors, which all share a join field value.  IDX is scratch space
+   for NFILES indices.  */
+
+static void
+prgroups_multi (size_t nfiles, struct mcursor const *cur,
+                struct line const **picks, size_t *idx)
+{
+  memset (idx, 0, nfiles * sizeof *idx);
+
+  while (true)
+    {
+      for (size_t i = 0; i < nfiles; i++)
+        picks[i] = cur[i].seq.lines[idx[i]];
+      prjoin_multi (nfiles, cur, picks);
+
+      /* Step the odometer, least significant file last.  */
+      size_t k = nfiles;
+      do
+        {
+          k--;
+          if (++idx[k] < cur[k].seq.count)
+            break;
+          idx[k] = 0;
+        }
+      while (k != 0);
+      if (k == 0 && idx[0] == 0)
+        break;
+    }
+}
+
+/* Merge-join the NFILES presorted inputs in CUR in a single pass,
+   printing only fully pairable groups.  Each step compares the heads
+   of all current groups and advances those below the maximum key, so
+   k inputs join without materializing any intermediate result.  */
+
+static void
+join_multi (size_t nfiles, struct mcursor *cur)
+{
+  struct line const **picks = xnmalloc (nfiles, sizeof *picks);
+  size_t *idx = xnmalloc (nfiles, sizeof *idx);
+
+  for (size_t i = 0; i < nfiles; i++)
+    {
+      fadvise (cur[i].fp, FADVISE_SEQUENTIAL);
+      cur[i].have_ahead = mcur_read (&cur[i], &cur[i].ahead);
+    }
+
+  if (join_header_lines)
+    {
+      bool any = false;
+      for (size_t i = 0; i < nfiles; i++)
+        {
+          picks[i] = cur[i].have_ahead ? cur[i].ahead : &uni_blank;
+          any |= cur[i].have_ahead;
+        }
+      if (any)
+        prjoin_multi (nfiles, cur, picks);
+      for (size_t i = 0; i < nfiles; i++)
+        if (cur[i].have_ahead)
+          cur[i].have_ahead = mcur_read (&cur[i], &cur[i].ahead);
+    }
+
+  bool all = true;
+  for (size_t i = 0; i < nfiles; i++)
+    all &= mcur_advance (&cur[i]);
+
+  while (all)
+    {
+      /* Find the greatest key among the group heads.  */
+      struct line const *maxline = cur[0].seq.lines[0];
+      size_t maxjf = cur[0].join_field;
+      bool all_equal = true;
+      for (size_t i = 1; i < nfiles; i++)
+        {
+          int diff = keycmp (cur[i].seq.lines[0], maxline,
+                             cur[i].join_field, maxjf);
+          if (0 < diff)
+            {
+              maxline = cur[i].seq.lines[0];
+              maxjf = cur[i].join_field;
+            }
+          if (diff != 0)
+            all_equal = false;
+        }
+
+      if (all_equal)
+        {
+          if (print_pairables)
+            prgroups_multi (nfiles, cur, picks, idx);
+          for (size_t i = 0; i < nfiles; i++)
+            all &= mcur_advance (&cur[i]);
+        }
+      else
+        {
+          seen_unpairable = true;
+          for (size_t i = 0; i < nfiles; i++)
+            if (keycmp (cur[i].seq.lines[0], maxline,
+                        cur[i].join_field, maxjf) < 0)
+              all &= mcur_advance (&cur[i]);
+        }
+    }
+
+  /* Any group left when another input ran out is unpairable.  */
+  for (size_t i = 0; i < nfiles; i++)
+    if (cur[i].seq.count)
+      seen_unpairable = true;
+
+  /* Verify the order of whatever remains unread, as the two-way
+     engine does for its tails.  */
+  if (check_input_order != CHECK_ORDER_DISABLED
+      && (check_input_order == CHECK_ORDER_ENABLED || seen_unpairable))
+    for (size_t i = 0; i < nfiles; i++)
+      while (! cur[i].warned && mcur_advance (&cur[i]))
+        continue;
+
+  for (size_t i = 0; i < nfiles; i++)
+    {
+      delseq (&cur[i].seq);
+      freeline (cur[i].ahead);
+      free (cur[i].ahead);
+    }
+  free (picks);
+  free (idx);
+}
+
 /* Add a field spec for field FIELD of file FILE to 'outlist'.  */
 
 static void
@@ -966,6 +1456,17 @@ add_file_name (char *name, char *names[2],
       switch (operand_status[op0])
         {
         case MUST_BE_OPERAND:
+          /* With two unambiguous operands already in hand, further
+             unambiguous names are additional inputs for a multi-way
+             join.  Ambiguous names keep the historical diagnostic.  */
+          if (*prev_optc_status == MUST_BE_OPERAND
+              && operand_status[1] == MUST_BE_OPERAND)
+            {
+              if (n_extra_names == extra_names_alloc)
+                extra_names = X2NREALLOC (extra_names, &extra_names_alloc);
+              extra_names[n_extra_names++] = name;
+              return;
+            }
           error (0, 0, _("extra operand %s"), quoteaf (name));
           usage (EXIT_FAILURE);
 
@@ -1083,6 +1584,7 @@ main (int argc, char **argv)
             {
               set_join_field (&join_field_1, string_to_join_field (optarg));
               set_join_field (&join_field_2, join_field_1);
+              set_join_field (&join_field_multi, join_field_1);
             }
           break;
 
@@ -1136,6 +1638,14 @@ main (int argc, char **argv)
           join_header_lines = true;
           break;
 
+        case SORTED_CACHE_OPTION:
+          sorted_cache_file = optarg;
+          break;
+
+        case UNSORTED_OPTION:
+          hash_join = true;
+          break;
+
         case_GETOPT_HELP_CHAR;
 
         case_GETOPT_VERSION_CHAR (PROGRAM_NAME, AUTHORS);
@@ -1169,12 +1679,36 @@ main (int argc, char **argv)
       {
         set_join_field (&join_field_1, i);
         set_join_field (&join_field_2, i);
+        set_join_field (&join_field_multi, i);
       }
 
   if (join_field_1 == SIZE_MAX)
     join_field_1 = 0;
   if (join_field_2 == SIZE_MAX)
     join_field_2 = 0;
+  if (join_field_multi == SIZE_MAX)
+    join_field_multi = 0;
+
+  if (n_extra_names)
+    {
+      if (hash_join)
+        die (EXIT_FAILURE, 0,
+             _("--unsorted does not support more than two files"));
+      if (print_unpairables_1 || print_unpairables_2)
+        die (EXIT_FAILURE, 0,
+             _("-a and -v do not support more than two files"));
+      if (outlist_head.next || autoformat)
+        die (EXIT_FAILURE, 0,
+             _("-o does not support more than two files"));
+    }
+
+  if (hash_join)
+    {
+      if (check_input_order == CHECK_ORDER_ENABLED)
+        die (EXIT_FAILURE, 0,
+             _("--check-order is incompatible with --unsorted"));
+      check_input_order = CHECK_ORDER_DISABLED;
+    }
 
   fp1 = STREQ (g_names[0], "-") ? stdin : fopen (g_names[0], "r");
   if (!fp1)
@@ -1184,7 +1718,93 @@ main (int argc, char **argv)
     die (EXIT_FAILURE, errno, "%s", quotef (g_names[1]));
   if (fp1 == fp2)
     die (EXIT_FAILURE, errno, _("both files cannot be standard input"));
-  join (fp1, fp2);
+
+  /* The identity of each input, and whether it can use the
+     verified-sorted index; only regular files can.  The settings
+     digests differ per file, as the join fields may.  */
+  struct stat instat[2];
+  bool cacheable[2] = { false, false };
+  uint32_t cache_opts[2] = { 0, 0 };
+
+  if (sorted_cache_file && ! hash_join && ! n_extra_names)
+    {
+      FILE *fps[2] = { fp1, fp2 };
+      size_t fields[2] = { join_field_1, join_field_2 };
+      for (i = 0; i < 2; i++)
+        {
+          uint32_t h = to_uchar (eolchar);
+          h = h * 33 ^ (tab & 0xFF);
+          h = h * 33 ^ ignore_case;
+          h = h * 33 ^ join_header_lines;
+          h = h * 33 ^ fields[i];
+          if (hard_LC_COLLATE)
+            h = sorted_cache_digest (h, setlocale (LC_COLLATE, NULL));
+          cache_opts[i] = h;
+          if (fstat (fileno (fps[i]), &instat[i]) == 0
+              && S_ISREG (instat[i].st_mode))
+            {
+              cacheable[i] = true;
+              input_verified[i] = sorted_cache_lookup (sorted_cache_file,
+                                                       &instat[i], h);
+            }
+        }
+    }
+
+  if (n_extra_names)
+    {
+      size_t nf = 2 + n_extra_names;
+      struct mcursor *cur = xcalloc (nf, sizeof *cur);
+
+      cur[0].fp = fp1;
+      cur[0].name = g_names[0];
+      cur[0].join_field = join_field_1;
+      cur[1].fp = fp2;
+      cur[1].name = g_names[1];
+      cur[1].join_field = join_field_2;
+      for (size_t j = 0; j < n_extra_names; j++)
+        {
+          char const *name = extra_names[j];
+          FILE *fp = STREQ (name, "-") ? stdin : fopen (name, "r");
+          if (! fp)
+            die (EXIT_FAILURE, errno, "%s", quotef (name));
+          if (fp == stdin)
+            {
+              bool stdin_used = (fp1 == stdin || fp2 == stdin);
+              for (size_t k = 0; k < j; k++)
+                stdin_used |= cur[2 + k].fp == stdin;
+              if (stdin_used)
+                die (EXIT_FAILURE, 0,
+                     _("only one file may be standard input"));
+            }
+          cur[2 + j].fp = fp;
+          cur[2 + j].name = name;
+          cur[2 + j].join_field = join_field_multi;
+        }
+
+      join_multi (nf, cur);
+
+      for (size_t j = 0; j < n_extra_names; j++)
+        if (fclose (cur[2 + j].fp) != 0)
+          die (EXIT_FAILURE, errno, "%s", quotef (extra_names[j]));
+      free (cur);
+      free (extra_names);
+    }
+  else if (hash_join)
+    join_hash (fp1, fp2);
+  else
+    join (fp1, fp2);
+
+  /* Every adjacent pair of lines is compared only when order checking
+     is enabled, and disorder is then fatal, so getting here with
+     --check-order means each input was read to its end and verified
+     to be sorted.  */
+  if (sorted_cache_file && ! hash_join
+      && check_input_order == CHECK_ORDER_ENABLED)
+    for (i = 0; i < 2; i++)
+      if (cacheable[i] && ! input_verified[i]
+          && ! sorted_cache_note (sorted_cache_file, &instat[i],
+                                  cache_opts[i]))
+        error (0, errno, _("error writing %s"), quoteaf (sorted_cache_file));
 
   if (fclose (fp1) != 0)
     die (EXIT_FAILURE, errno, "%s", quotef (g_names[0]));
@@ -0,0 +1,65 @@
+/* Writing byte strings as JSON strings
+   Copyright (C) 2026 Free Software Foundation, Inc.
+
+   This program is free software: you can redistribute it and/or modify
+   it under the terms of the GNU General Public License as published by
+   the Free Software Foundation, either version 3 of the License, or
+   (at your option) any later version.
+
+   This program is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU General Public License for more details.
+
+   You should have received a copy of the GNU General Public License
+   along with this program.  If not, see <https://www.gnu.org/licenses/>.  */
+
+/* Write NAME to OUT as a JSON string, including the surrounding
+   quotes.  Bytes pass through verbatim apart from '"', '\\' and
+   control bytes, so the encoding is exact for UTF-8 names and still
+   lossless for names holding arbitrary bytes.  Runs of ordinary
+   bytes are written with one fwrite each.  */
+
+static void
+json_fputs_quoted (char const *name, FILE *out)
+{
+  char const *p = name;
+  char const *lim = name + strlen (name);
+
+  putc ('"', out);
+  while (p < lim)
+    {
+      char const *q = p;
+      while (q < lim && *q != '"' && *q != '\\' && 0x20 <= to_uchar (*q))
+        q++;
+      fwrite (p, 1, q - p, out);
+      if (q == lim)
+        break;
+
+      char esc[sizeof "\\u0000"];
+      int len;
+      switch (*q)
+        {
+        case '"': case '\\':
+          esc[0] = '\\';
+          esc[1] = *q;
+          len = 2;
+          break;
+        case '\n':
+          len = 2, memcpy (esc, "\\n", 2);
+          break;
+        case '\r':
+          len = 2, memcpy (esc, "\\r", 2);
+          break;
+        case '\t':
+          len = 2, memcpy (esc, "\\t", 2);
+          break;
+        default:
+          len = sprintf (esc, "\\u%04x", to_uchar (*q));
+          break;
+        }
+      fwrite (esc, 1, len, out);
+      p = q + 1;
+    }
+  putc ('"', out);
+}
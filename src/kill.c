@@ -21,8 +21,13 @@
 #include <getopt.h>
 #include <sys/types.h>
 #include <signal.h>
+#if HAVE_PIDFD_OPEN && HAVE_PIDFD_SEND_SIGNAL
+# include <sys/pidfd.h>
+# define USE_PIDFD 1
+#endif
 
 #include "system.h"
+#include "die.h"
 #include "error.h"
 #include "sig2str.h"
 #include "operand2sig.h"
@@ -51,6 +56,14 @@
 # endif
 #endif
 
+/* If true, also signal the descendants of each process operand.  */
+static bool signal_tree;
+
+enum
+{
+  TREE_OPTION = CHAR_MAX + 1
+};
+
 static char const short_options[] =
   "0::1::2::3::4::5::6::7::8::9::"
   "A::B::C::D::E::F::G::H::I::J::K::M::"
@@ -62,6 +75,7 @@ static struct option const long_options[] =
   {"list", no_argument, NULL, 'l'},
   {"signal", required_argument, NULL, 's'},
   {"table", no_argument, NULL, 't'},
+  {"tree", no_argument, NULL, TREE_OPTION},
   {GETOPT_HELP_OPTION_DECL},
   {GETOPT_VERSION_OPTION_DECL},
   {NULL, 0, NULL, 0}
@@ -91,6 +105,8 @@ Send signals to processes, or list signals.\n\
                    specify the name or number of the signal to be sent\n\
   -l, --list       list signal names, or convert signal names to/from numbers\n\
   -t, --table      print a table of signal information\n\
+      --tree       also signal the descendants of each PID, found in one\n\
+                     scan of the process table; each PID must be positive\n\
 "), stdout);
       fputs (HELP_OPTION_DESCRIPTION, stdout);
       fputs (VERSION_OPTION_DESCRIPTION, stdout);
@@ -186,6 +202,191 @@ list_signals (bool table, char *const *argv)
   return status;
 }
 
+/* Send signal SIGNUM to the process PID, which is positive.
+   Return 0 if successful, -1 (setting errno) otherwise.
+   Prefer a pidfd, which cannot signal a recycled process id:
+   kill can race with pid reuse if PID exits between the caller
+   naming it and the signal's delivery.  */
+
+static int
+send_signal (pid_t pid, int signum)
+{
+#ifdef USE_PIDFD
+  static bool pidfd_works = true;
+  if (pidfd_works)
+    {
+      int fd = pidfd_open (pid, 0);
+      if (0 <= fd)
+        {
+          int r = pidfd_send_signal (fd, signum, NULL, 0);
+          int err = errno;
+          close (fd);
+          errno = err;
+          return r;
+        }
+      if (errno == ENOSYS)
+        pidfd_works = false;
+      else if (errno != EMFILE && errno != ENFILE)
+        return -1;
+    }
+#endif
+  return kill (pid, signum);
+}
+
+/* An entry in a snapshot of the process table.  */
+struct proc_entry
+{
+  pid_t pid;
+  pid_t ppid;
+};
+
+/* Read the pid and parent pid of every process from /proc into a
+   newly allocated table, storing its length in *N_PROCS.
+   Processes that vanish mid-scan are silently omitted.  */
+
+static struct proc_entry *
+read_proc_table (size_t *n_procs)
+{
+  DIR *dir = opendir ("/proc");
+  if (! dir)
+    die (EXIT_FAILURE, errno, _("cannot read the process table %s"),
+         quoteaf ("/proc"));
+
+  size_t alloc = 512;
+  size_t used = 0;
+  struct proc_entry *table = xnmalloc (alloc, sizeof *table);
+
+  for (struct dirent const *ent; (ent = readdir (dir)); )
+    {
+      char *endp;
+      intmax_t n = (errno = 0, strtoimax (ent->d_name, &endp, 10));
+      pid_t pid = n;
+      if (errno || pid != n || n <= 0 || endp == ent->d_name || *endp)
+        continue;
+
+      char stat_file[sizeof "/proc//stat" + INT_BUFSIZE_BOUND (intmax_t)];
+      sprintf (stat_file, "/proc/%s/stat", ent->d_name);
+      int fd = open (stat_file, O_RDONLY);
+      if (fd < 0)
+        continue;
+
+      /* The fields of interest precede the command name's closing
+         parenthesis or closely follow it, so a small read suffices:
+         "pid (comm) state ppid ...".  */
+      char buf[1024];
+      ssize_t bytes = read (fd, buf, sizeof buf - 1);
+      close (fd);
+      if (bytes <= 0)
+        continue;
+      buf[bytes] = '\0';
+
+      /* Scan back from the end, as the command name may itself
+         contain a ')'.  */
+      char *rparen = strrchr (buf, ')');
+      long int ppid;
+      if (! rparen || sscanf (rparen + 1, " %*c %ld", &ppid) != 1)
+        continue;
+
+      if (used == alloc)
+        table = x2nrealloc (table, &alloc, sizeof *table);
+      table[used].pid = pid;
+      table[used].ppid = ppid;
+      used++;
+    }
+
+  closedir (dir);
+  *n_procs = used;
+  return table;
+}
+
+/* Send signal SIGNUM to the process PID and all of its descendants,
+   found via one scan of the process table.  Return 0 if PID was
+   signaled successfully, -1 (setting errno) otherwise; failure to
+   signal a descendant is not diagnosed, as descendants may
+   legitimately exit at any time.  */
+
+static int
+send_signal_tree (pid_t pid, int signum)
+{
+  size_t n_procs;
+  struct proc_entry *table = read_proc_table (&n_procs);
+
+  /* Collect PID and its descendants, breadth first.  Consumed table
+     entries get their parent set to -1 so that a cycle created by pid
+     reuse mid-scan cannot make this loop endlessly.  */
+  pid_t *targets = xnmalloc (n_procs + 1, sizeof *targets);
+  size_t n_targets = 0;
+  targets[n_targets++] = pid;
+  for (size_t i = 0; i < n_targets; i++)
+    for (size_t j = 0; j < n_procs; j++)
+      if (table[j].ppid == targets[i] && table[j].pid != pid)
+        {
+          table[j].ppid = -1;
+          targets[n_targets++] = table[j].pid;
+        }
+  free (table);
+
+  int root_errno = 0;
+  int status = 0;
+
+#ifdef USE_PIDFD
+  /* Open a pidfd for every target before sending any signal, so that
+     signaling the parents cannot cause a child's pid to be recycled
+     before its own signal is dispatched.  */
+  int *fds = xnmalloc (n_targets, sizeof *fds);
+  bool pidfds_ok = true;
+  for (size_t i = 0; i < n_targets && pidfds_ok; i++)
+    {
+      fds[i] = pidfd_open (targets[i], 0);
+      if (fds[i] < 0)
+        {
+          if (errno == ENOSYS || errno == EMFILE || errno == ENFILE)
+            {
+              /* Fall back to kill for the whole batch.  */
+              while (i--)
+                if (0 <= fds[i])
+                  close (fds[i]);
+              pidfds_ok = false;
+            }
+          else if (i == 0)
+            {
+              status = -1;
+              root_errno = errno;
+            }
+        }
+    }
+
+  if (pidfds_ok)
+    {
+      for (size_t i = 0; i < n_targets; i++)
+        if (0 <= fds[i])
+          {
+            if (pidfd_send_signal (fds[i], signum, NULL, 0) != 0 && i == 0)
+              {
+                status = -1;
+                root_errno = errno;
+              }
+            close (fds[i]);
+          }
+      free (fds);
+      free (targets);
+      errno = root_errno;
+      return status;
+    }
+  free (fds);
+#endif
+
+  for (size_t i = 0; i < n_targets; i++)
+    if (kill (targets[i], signum) != 0 && i == 0)
+      {
+        status = -1;
+        root_errno = errno;
+      }
+  free (targets);
+  errno = root_errno;
+  return status;
+}
+
 /* Send signal SIGNUM to all the processes or process groups specified
    by ARGV.  Return a suitable exit status.  */
 
@@ -206,7 +407,16 @@ send_signals (int signum, char *const *argv)
           error (0, 0, _("%s: invalid process id"), quote (arg));
           status = EXIT_FAILURE;
         }
-      else if (kill (pid, signum) != 0)
+      else if (signal_tree && pid <= 0)
+        {
+          error (0, 0, _("%s: process id must be positive with --tree"),
+                 quote (arg));
+          status = EXIT_FAILURE;
+        }
+      else if ((signal_tree ? send_signal_tree (pid, signum)
+                : 0 < pid ? send_signal (pid, signum)
+                : kill (pid, signum))
+               != 0)
         {
           error (0, errno, "%s", quote (arg));
           status = EXIT_FAILURE;
@@ -287,6 +497,10 @@ main (int argc, char **argv)
         list = true;
         break;
 
+      case TREE_OPTION:
+        signal_tree = true;
+        break;
+
       case_GETOPT_HELP_CHAR;
       case_GETOPT_VERSION_CHAR (PROGRAM_NAME, AUTHORS);
       default:
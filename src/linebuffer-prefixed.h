@@ -0,0 +1,70 @@
+/* Length-prefixed record reader
+   Copyright (C) 2026 Free Software Foundation, Inc.
+
+   This program is free software: you can redistribute it and/or modify
+   it under the terms of the GNU General Public License as published by
+   the Free Software Foundation, either version 3 of the License, or
+   (at your option) any later version.
+
+   This program is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU General Public License for more details.
+
+   You should have received a copy of the GNU General Public License
+   along with this program.  If not, see <https://www.gnu.org/licenses/>.  */
+
+#include "die.h"
+#include "linebuffer.h"
+#include "varint.h"
+
+/* Read one length-prefixed record from FP into LB, appending a NUL to
+   the payload where a delimited line would keep its delimiter, so
+   LB->length counts the payload plus one.  Return NULL when no bytes
+   remain or on read error; diagnose and exit on a malformed or
+   truncated record.  */
+
+static struct linebuffer *
+readlinebuffer_prefixed (struct linebuffer *lb, FILE *fp)
+{
+  char prefix[VARINT_BYTES_BOUND];
+  size_t navail = 0;
+  uintmax_t len;
+  size_t n;
+
+  if (feof (fp))
+    return NULL;
+
+  do
+    {
+      int c = getc (fp);
+      if (c == EOF)
+        {
+          if (navail == 0 || ferror (fp))
+            return NULL;
+          die (EXIT_FAILURE, 0, _("truncated length-prefixed record"));
+        }
+      prefix[navail++] = c;
+      n = varint_decode (prefix, navail, &len);
+      if (n == SIZE_MAX || (navail == sizeof prefix && n == 0))
+        die (EXIT_FAILURE, 0, _("invalid record length prefix"));
+    }
+  while (n == 0);
+
+  if (SIZE_MAX - 1 < len)
+    die (EXIT_FAILURE, 0, _("invalid record length prefix"));
+
+  while (lb->size < len + 1)
+    lb->buffer = x2realloc (lb->buffer, &lb->size);
+
+  if (fread (lb->buffer, 1, len, fp) != len)
+    {
+      if (ferror (fp))
+        return NULL;
+      die (EXIT_FAILURE, 0, _("truncated length-prefixed record"));
+    }
+
+  lb->buffer[len] = '\0';
+  lb->length = len + 1;
+  return lb;
+}
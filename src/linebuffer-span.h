@@ -0,0 +1,80 @@
+/* Span-copying delimited line reader
+   Copyright (C) 2026 Free Software Foundation, Inc.
+
+   This program is free software: you can redistribute it and/or modify
+   it under the terms of the GNU General Public License as published by
+   the Free Software Foundation, either version 3 of the License, or
+   (at your option) any later version.
+
+   This program is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU General Public License for more details.
+
+   You should have received a copy of the GNU General Public License
+   along with this program.  If not, see <https://www.gnu.org/licenses/>.  */
+
+#include "freadptr.h"
+#include "freadseek.h"
+#include "linebuffer.h"
+
+/* Read a line delimited by DELIMITER from FP into LB, like
+   readlinebuffer_delim, but copy whole spans of the stdio buffer with
+   memchr and memcpy rather than one byte at a time.  As there,
+   consider lines to be terminated by DELIMITER, keep the delimiter,
+   append one if the file ends in some other byte, and return NULL
+   upon error or when no bytes remain.  */
+
+static struct linebuffer *
+readlinebuffer_span (struct linebuffer *lb, FILE *fp, char delimiter)
+{
+  size_t length = 0;
+
+  if (feof (fp))
+    return NULL;
+
+  while (true)
+    {
+      size_t avail;
+      char const *p = freadptr (fp, &avail);
+      if (! p)
+        {
+          /* The stdio buffer is empty (or FP is unbuffered); refill
+             via getc.  */
+          int c = getc (fp);
+          if (c == EOF)
+            break;
+          if (lb->size <= length)
+            lb->buffer = x2realloc (lb->buffer, &lb->size);
+          lb->buffer[length++] = c;
+          if (c == delimiter)
+            goto done;
+          continue;
+        }
+
+      char const *eol = memchr (p, delimiter, avail);
+      size_t n = (eol ? eol - p + 1 : avail);
+      while (lb->size < length + n)
+        lb->buffer = x2realloc (lb->buffer, &lb->size);
+      memcpy (lb->buffer + length, p, n);
+      length += n;
+      if (freadseek (fp, n) != 0)
+        break;
+      if (eol)
+        goto done;
+    }
+
+  /* At end of file or on read error.  */
+  if (length == 0 || ferror (fp))
+    return NULL;
+  if (lb->buffer[length - 1] != delimiter)
+    {
+      if (lb->size <= length)
+        lb->buffer = x2realloc (lb->buffer, &lb->size);
+      lb->buffer[length++] = delimiter;
+    }
+
+ done:
+  lb->length = length;
+  return lb;
+}
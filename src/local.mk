@@ -43,8 +43,11 @@ noinst_HEADERS =		\
   src/chown-core.h		\
   src/copy.h			\
   src/cp-hash.h			\
+  src/dec-input.h		\
   src/die.h			\
+  src/dir-set.h		\
   src/dircolors.h		\
+  src/dirent-batch.h		\
   src/expand-common.h		\
   src/fiemap.h			\
   src/find-mount-point.h	\
@@ -52,15 +55,25 @@ noinst_HEADERS =		\
   src/fs-is-local.h		\
   src/group-list.h		\
   src/ioblksize.h		\
+  src/json-quote.h		\
+  src/linebuffer-prefixed.h	\
+  src/linebuffer-span.h	\
   src/longlong.h		\
   src/ls.h			\
+  src/meta-pool.h		\
   src/operand2sig.h		\
   src/prog-fprintf.h		\
+  src/probes.h			\
   src/remove.h			\
+  src/repeat-fill.h		\
   src/set-fields.h		\
+  src/sorted-cache.h		\
   src/statx.h			\
+  src/stdbuf-policy.h		\
   src/system.h			\
-  src/uname.h
+  src/uname.h			\
+  src/utmp-map.h		\
+  src/varint.h
 
 EXTRA_DIST +=		\
   src/dcgen		\
@@ -96,6 +109,7 @@ LDADD = src/libver.a lib/libcoreutils.a $(LIBINTL) lib/libcoreutils.a
 # First, list all programs, to make listing per-program libraries easier.
 # See [ below.
 src_arch_LDADD = $(LDADD)
+src_b2sum_LDADD = $(LDADD)
 src_base64_LDADD = $(LDADD)
 src_base32_LDADD = $(LDADD)
 src_basenc_LDADD = $(LDADD)
@@ -246,6 +260,8 @@ src_mknod_LDADD += $(LIB_SELINUX)
 src_mknod_LDADD += $(LIB_SMACK)
 src_runcon_LDADD += $(LIB_SELINUX)
 src_stat_LDADD += $(LIB_SELINUX)
+# for --coreutils-launch's --context
+src_coreutils_LDADD += $(LIB_SELINUX)
 
 # for nvlist_lookup_uint64_array
 src_stat_LDADD += $(LIB_NVPAIR)
@@ -318,7 +334,36 @@ src_uname_LDADD += $(GETHOSTNAME_LIB)
 src_kill_LDADD += $(LIBTHREAD)
 
 # for pthread
+copy_ldadd += $(LIB_PTHREAD)
+remove_ldadd += $(LIB_PTHREAD)
+src_chcon_LDADD += $(LIB_PTHREAD)
+src_chgrp_LDADD += $(LIB_PTHREAD)
+src_chmod_LDADD += $(LIB_PTHREAD)
+src_chown_LDADD += $(LIB_PTHREAD)
+src_cut_LDADD += $(LIB_PTHREAD)
+src_df_LDADD += $(LIB_PTHREAD)
+src_du_LDADD += $(LIB_PTHREAD)
+src_groups_LDADD += $(LIB_PTHREAD)
+src_id_LDADD += $(LIB_PTHREAD)
+src_ls_LDADD += $(LIB_PTHREAD)
+src_factor_LDADD += $(LIB_PTHREAD)
+src_mkdir_LDADD += $(LIB_PTHREAD)
+src_ptx_LDADD += $(LIB_PTHREAD)
+src_od_LDADD += $(LIB_PTHREAD)
+src_shred_LDADD += $(LIB_PTHREAD)
 src_sort_LDADD += $(LIB_PTHREAD)
+src_sum_LDADD += $(LIB_PTHREAD)
+src_tee_LDADD += $(LIB_PTHREAD)
+src_touch_LDADD += $(LIB_PTHREAD)
+src_truncate_LDADD += $(LIB_PTHREAD)
+src_b2sum_LDADD += $(LIB_PTHREAD)
+src_md5sum_LDADD += $(LIB_PTHREAD)
+src_sha1sum_LDADD += $(LIB_PTHREAD)
+src_sha224sum_LDADD += $(LIB_PTHREAD)
+src_sha256sum_LDADD += $(LIB_PTHREAD)
+src_sha384sum_LDADD += $(LIB_PTHREAD)
+src_sha512sum_LDADD += $(LIB_PTHREAD)
+src_wc_LDADD += $(LIB_PTHREAD)
 
 # Get the release year from lib/version-etc.c.
 RELEASE_YEAR = \
@@ -332,6 +377,7 @@ selinux_sources = \
 copy_sources = \
   src/copy.c \
   src/cp-hash.c \
+  src/dir-set.c \
   src/extent-scan.c \
   src/extent-scan.h \
   src/force-link.c \
@@ -366,18 +412,75 @@ cksum_pclmul_ldadd = src/libcksum_pclmul.a
 src_cksum_LDADD += $(cksum_pclmul_ldadd)
 src_libcksum_pclmul_a_CFLAGS = -mavx -mpclmul $(AM_CFLAGS)
 endif
+if USE_VPCLMUL_CRC32
+noinst_LIBRARIES += src/libcksum_vpclmul.a
+src_libcksum_vpclmul_a_SOURCES = src/cksum_vpclmul.c src/cksum.h
+cksum_vpclmul_ldadd = src/libcksum_vpclmul.a
+src_cksum_LDADD += $(cksum_vpclmul_ldadd)
+src_libcksum_vpclmul_a_CFLAGS = -mavx2 -mpclmul -mvpclmulqdq $(AM_CFLAGS)
+endif
+
+if USE_SHA_NI
+noinst_LIBRARIES += src/libdigest_sha_ni.a
+src_libdigest_sha_ni_a_SOURCES = src/digest-sha-ni.c src/digest-sha-ni.h
+digest_sha_ni_ldadd = src/libdigest_sha_ni.a
+src_sha1sum_LDADD += $(digest_sha_ni_ldadd)
+src_sha224sum_LDADD += $(digest_sha_ni_ldadd)
+src_sha256sum_LDADD += $(digest_sha_ni_ldadd)
+src_libdigest_sha_ni_a_CFLAGS = -msha -msse4.1 $(AM_CFLAGS)
+endif
+
+if USE_AVX2_BLAKE2
+noinst_LIBRARIES += src/libblake2_avx2.a
+src_libblake2_avx2_a_SOURCES = src/blake2/blake2b-avx2.c \
+			       src/blake2/blake2.h src/blake2/blake2-impl.h
+blake2_avx2_ldadd = src/libblake2_avx2.a
+src_b2sum_LDADD += $(blake2_avx2_ldadd)
+src_libblake2_avx2_a_CFLAGS = -mavx2 $(AM_CFLAGS)
+endif
+
+if USE_AVX2_BASE64
+noinst_LIBRARIES += src/libbase64_avx2.a
+src_libbase64_avx2_a_SOURCES = src/base64-simd.c src/base64-simd.h
+base64_avx2_ldadd = src/libbase64_avx2.a
+src_base64_LDADD += $(base64_avx2_ldadd)
+src_basenc_LDADD += $(base64_avx2_ldadd)
+src_libbase64_avx2_a_CFLAGS = -mavx2 $(AM_CFLAGS)
+endif
+
+if USE_AVX2_CHACHA
+noinst_LIBRARIES += src/libchacha_avx2.a
+src_libchacha_avx2_a_SOURCES = src/chacha-simd.c src/chacha-simd.h
+chacha_avx2_ldadd = src/libchacha_avx2.a
+src_shred_LDADD += $(chacha_avx2_ldadd)
+src_libchacha_avx2_a_CFLAGS = -mavx2 $(AM_CFLAGS)
+endif
+
+if USE_AVX2_ZEROSCAN
+noinst_LIBRARIES += src/libzeroscan_avx2.a
+src_libzeroscan_avx2_a_SOURCES = src/zero-scan-simd.c src/zero-scan-simd.h
+zeroscan_avx2_ldadd = src/libzeroscan_avx2.a
+src_cp_LDADD += $(zeroscan_avx2_ldadd)
+src_ginstall_LDADD += $(zeroscan_avx2_ldadd)
+src_mv_LDADD += $(zeroscan_avx2_ldadd)
+src_libzeroscan_avx2_a_CFLAGS = -mavx2 $(AM_CFLAGS)
+endif
 src_cp_SOURCES = src/cp.c $(copy_sources) $(selinux_sources)
-src_dir_SOURCES = src/ls.c src/ls-dir.c
+src_dircolors_SOURCES = src/dircolors.c src/colordb.c src/colordb.h
+src_dir_SOURCES = src/ls.c src/ls-dir.c src/colordb.c src/colordb.h
 src_env_SOURCES = src/env.c src/operand2sig.c
-src_vdir_SOURCES = src/ls.c src/ls-vdir.c
+src_vdir_SOURCES = src/ls.c src/ls-vdir.c src/colordb.c src/colordb.h
 src_id_SOURCES = src/id.c src/group-list.c
 src_groups_SOURCES = src/groups.c src/group-list.c
-src_ls_SOURCES = src/ls.c src/ls-ls.c
+src_ls_SOURCES = src/ls.c src/ls-ls.c src/colordb.c src/colordb.h
 src_ln_SOURCES = src/ln.c \
   src/force-link.c src/force-link.h \
   src/relpath.c src/relpath.h
-src_chown_SOURCES = src/chown.c src/chown-core.c
-src_chgrp_SOURCES = src/chgrp.c src/chown-core.c
+src_chmod_SOURCES = src/chmod.c src/meta-pool.c
+src_chown_SOURCES = src/chown.c src/chown-core.c src/meta-pool.c
+src_chgrp_SOURCES = src/chgrp.c src/chown-core.c src/meta-pool.c
+src_chcon_SOURCES = src/chcon.c src/meta-pool.c
+src_touch_SOURCES = src/touch.c src/meta-pool.c
 src_kill_SOURCES = src/kill.c src/operand2sig.c
 src_realpath_SOURCES = src/realpath.c src/relpath.c src/relpath.h
 src_timeout_SOURCES = src/timeout.c src/operand2sig.c
@@ -397,9 +500,18 @@ src_stat_SOURCES = src/stat.c src/find-mount-point.c
 src_uname_SOURCES = src/uname.c src/uname-uname.c
 src_arch_SOURCES = src/uname.c src/uname-arch.c
 
-src_cut_SOURCES = src/cut.c src/set-fields.c
+src_cut_SOURCES = src/cut.c src/set-fields.c src/dec-input.c
 src_numfmt_SOURCES = src/numfmt.c src/set-fields.c
 
+src_sort_SOURCES = src/sort.c src/dec-input.c src/stdbuf-policy.c
+src_wc_SOURCES = src/wc.c src/dec-input.c
+
+src_cat_SOURCES = src/cat.c src/stdbuf-policy.c
+src_tail_SOURCES = src/tail.c src/stdbuf-policy.c
+
+src_pinky_SOURCES = src/pinky.c src/utmp-map.c
+src_who_SOURCES = src/who.c src/utmp-map.c
+
 src_md5sum_CPPFLAGS = -DHASH_ALGO_MD5=1 $(AM_CPPFLAGS)
 src_sha1sum_SOURCES = src/md5sum.c
 src_sha1sum_CPPFLAGS = -DHASH_ALGO_SHA1=1 $(AM_CPPFLAGS)
@@ -441,6 +553,8 @@ BUILT_SOURCES += src/coreutils.h
 if SINGLE_BINARY
 # Single binary dependencies
 src_coreutils_CFLAGS = -DSINGLE_BINARY $(AM_CFLAGS)
+# --coreutils-launch preloads the installed libstdbuf.
+src_coreutils_CPPFLAGS = -DPKGLIBEXECDIR='"$(pkglibexecdir)"' $(AM_CPPFLAGS)
 #src_coreutils_LDFLAGS = $(AM_LDFLAGS)
 src_coreutils_LDADD = $(single_binary_deps) $(LDADD) $(single_binary_libs)
 src_coreutils_DEPENDENCIES = $(LDADD) $(single_binary_deps)
@@ -53,7 +53,9 @@
 #include <assert.h>
 #include <setjmp.h>
 #include <pwd.h>
+#include <grp.h>
 #include <getopt.h>
+#include <pthread.h>
 #include <signal.h>
 #include <selinux/selinux.h>
 #include <wchar.h>
@@ -87,8 +89,10 @@
 #include "acl.h"
 #include "argmatch.h"
 #include "c-strcase.h"
+#include "colordb.h"
 #include "dev-ino.h"
 #include "die.h"
+#include "dirent-batch.h"
 #include "error.h"
 #include "filenamecat.h"
 #include "hard-locale.h"
@@ -96,7 +100,9 @@
 #include "human.h"
 #include "filemode.h"
 #include "filevercmp.h"
+#include "flexmember.h"
 #include "idcache.h"
+#include "json-quote.h"
 #include "ls.h"
 #include "mbswidth.h"
 #include "mpsort.h"
@@ -269,9 +275,11 @@ static size_t quote_name_buf (char **inbuf, size_t bufsize, char *name,
 static char *make_link_name (char const *name, char const *linkname);
 static int decode_switches (int argc, char **argv);
 static bool file_ignored (char const *name);
+struct prestat;
 static uintmax_t gobble_file (char const *name, enum filetype type,
                               ino_t inode, bool command_line_arg,
-                              char const *dirname);
+                              char const *dirname,
+                              struct prestat const *prestat);
 static const struct bin_str * get_color_indicator (const struct fileinfo *f,
                                                    bool symlink_target);
 static bool print_color_indicator (const struct bin_str *ind);
@@ -293,6 +301,7 @@ static size_t print_file_name_and_frills (const struct fileinfo *f,
 static void print_horizontal (void);
 static int format_user_width (uid_t u);
 static int format_group_width (gid_t g);
+static void print_json_format (const struct fileinfo *f);
 static void print_long_format (const struct fileinfo *f);
 static void print_many_per_line (void);
 static size_t print_name_with_quoting (const struct fileinfo *f,
@@ -303,6 +312,7 @@ static void prep_non_filename_text (void);
 static bool print_type_indicator (bool stat_ok, mode_t mode,
                                   enum filetype type);
 static void print_with_separator (char sep);
+static void print_streamed_file (size_t *pos, bool *first);
 static void queue_directory (char const *name, char const *realname,
                              bool command_line_arg);
 static void sort_files (void);
@@ -436,6 +446,17 @@ enum format
 
 static enum format format;
 
+/* (--json) If true, print the long-format information as one JSON
+   object per line instead of columns.  Collection behaves as for
+   long_format, but nothing is aligned, so no column widths are
+   accumulated, and names are JSON-encoded rather than quoted for a
+   terminal.  */
+static bool json_output;
+
+/* The directory whose entries are currently being printed, for the
+   "dir" member of --json records, or NULL for command-line files.  */
+static char const *json_dirname;
+
 /* 'full-iso' uses full ISO-style dates and times.  'long-iso' uses longer
    ISO-style timestamps, though shorter than 'full-iso'.  'iso' uses shorter
    ISO-style timestamps.  'locale' uses locale-dependent timestamps.  */
@@ -639,7 +660,7 @@ static struct bin_str color_indicator[] =
     { LEN_STR_PAIR ("37;44") },		/* st: sticky: black on blue */
     { LEN_STR_PAIR ("34;42") },		/* ow: other-writable: blue on green */
     { LEN_STR_PAIR ("30;42") },		/* tw: ow w/ sticky: black on green */
-    { LEN_STR_PAIR ("30;41") },		/* ca: black on red */
+    { 0, NULL },			/* ca: disabled by default */
     { 0, NULL },			/* mh: disabled by default */
     { LEN_STR_PAIR ("\033[K") },	/* cl: clear to end of line */
   };
@@ -647,6 +668,29 @@ static struct bin_str color_indicator[] =
 /* FIXME: comment  */
 static struct color_ext_type *color_ext_list = NULL;
 
+/* Hash index over COLOR_EXT_LIST, so that per-file suffix lookup need
+   not scan the whole list.  Keys are case-folded suffix bytes plus
+   their length; ORDER breaks ties the way the list scan would, i.e.,
+   the entry nearest the list head wins.  */
+struct ext_color_entry
+  {
+    char const *suffix;		/* Case-folded pattern bytes */
+    size_t len;
+    size_t order;		/* Position in COLOR_EXT_LIST */
+    struct bin_str const *seq;
+  };
+static Hash_table *ext_color_table;
+
+/* The distinct pattern lengths present in EXT_COLOR_TABLE, their
+   number, and the largest of them.  A file name is looked up once per
+   distinct length.  */
+static size_t *ext_color_lens;
+static size_t ext_color_n_lens;
+static size_t ext_color_max_len;
+
+/* Scratch holding the case-folded tail of the name being looked up.  */
+static char *ext_color_scratch;
+
 /* Buffer for color sequences */
 static char *color_buf;
 
@@ -839,6 +883,7 @@ enum
   HIDE_OPTION,
   HYPERLINK_OPTION,
   INDICATOR_STYLE_OPTION,
+  JSON_OPTION,
   QUOTING_STYLE_OPTION,
   SHOW_CONTROL_CHARS_OPTION,
   SI_OPTION,
@@ -876,6 +921,7 @@ static struct option const long_options[] =
   {"hide", required_argument, NULL, HIDE_OPTION},
   {"ignore", required_argument, NULL, 'I'},
   {"indicator-style", required_argument, NULL, INDICATOR_STYLE_OPTION},
+  {"json", no_argument, NULL, JSON_OPTION},
   {"dereference", no_argument, NULL, 'L'},
   {"literal", no_argument, NULL, 'N'},
   {"quote-name", no_argument, NULL, 'Q'},
@@ -1731,13 +1777,13 @@ main (int argc, char **argv)
   if (n_files <= 0)
     {
       if (immediate_dirs)
-        gobble_file (".", directory, NOT_AN_INODE_NUMBER, true, "");
+        gobble_file (".", directory, NOT_AN_INODE_NUMBER, true, "", NULL);
       else
         queue_directory (".", NULL, true);
     }
   else
     do
-      gobble_file (argv[i++], unknown, NOT_AN_INODE_NUMBER, true, "");
+      gobble_file (argv[i++], unknown, NOT_AN_INODE_NUMBER, true, "", NULL);
     while (i < argc);
 
   if (cwd_n_used)
@@ -1755,7 +1801,7 @@ main (int argc, char **argv)
   if (cwd_n_used)
     {
       print_current_files ();
-      if (pending_dirs)
+      if (pending_dirs && !json_output)
         DIRED_PUTCHAR ('\n');
     }
   else if (n_files <= 1 && pending_dirs && pending_dirs->next == 0)
@@ -2234,6 +2280,11 @@ decode_switches (int argc, char **argv)
             break;
           }
 
+        case JSON_OPTION:
+          format = long_format;
+          json_output = true;
+          break;
+
         case HYPERLINK_OPTION:
           {
             int i;
@@ -2344,10 +2395,15 @@ decode_switches (int argc, char **argv)
   dirname_quoting_options = clone_quoting_options (NULL);
   set_char_quoting (dirname_quoting_options, ':', 1);
 
+  /* --json overrides any other layout option; its records carry the
+     long-format information.  */
+  if (json_output)
+    format = long_format;
+
   /* --dired is meaningful only with --format=long (-l).
      Otherwise, ignore it.  FIXME: warn about this?
      Alternatively, make --dired imply --format=long?  */
-  if (dired && (format != long_format || print_hyperlink))
+  if (dired && (format != long_format || print_hyperlink || json_output))
     dired = false;
 
   /* If -c or -u is specified and not -l (or any other option that implies -l),
@@ -2454,214 +2510,6 @@ decode_switches (int argc, char **argv)
   return optind;
 }
 
-/* Parse a string as part of the LS_COLORS variable; this may involve
-   decoding all kinds of escape characters.  If equals_end is set an
-   unescaped equal sign ends the string, otherwise only a : or \0
-   does.  Set *OUTPUT_COUNT to the number of bytes output.  Return
-   true if successful.
-
-   The resulting string is *not* null-terminated, but may contain
-   embedded nulls.
-
-   Note that both dest and src are char **; on return they point to
-   the first free byte after the array and the character that ended
-   the input string, respectively.  */
-
-static bool
-get_funky_string (char **dest, char const **src, bool equals_end,
-                  size_t *output_count)
-{
-  char num;			/* For numerical codes */
-  size_t count;			/* Something to count with */
-  enum {
-    ST_GND, ST_BACKSLASH, ST_OCTAL, ST_HEX, ST_CARET, ST_END, ST_ERROR
-  } state;
-  char const *p;
-  char *q;
-
-  p = *src;			/* We don't want to double-indirect */
-  q = *dest;			/* the whole darn time.  */
-
-  count = 0;			/* No characters counted in yet.  */
-  num = 0;
-
-  state = ST_GND;		/* Start in ground state.  */
-  while (state < ST_END)
-    {
-      switch (state)
-        {
-        case ST_GND:		/* Ground state (no escapes) */
-          switch (*p)
-            {
-            case ':':
-            case '\0':
-              state = ST_END;	/* End of string */
-              break;
-            case '\\':
-              state = ST_BACKSLASH; /* Backslash escape sequence */
-              ++p;
-              break;
-            case '^':
-              state = ST_CARET; /* Caret escape */
-              ++p;
-              break;
-            case '=':
-              if (equals_end)
-                {
-                  state = ST_END; /* End */
-                  break;
-                }
-              FALLTHROUGH;
-            default:
-              *(q++) = *(p++);
-              ++count;
-              break;
-            }
-          break;
-
-        case ST_BACKSLASH:	/* Backslash escaped character */
-          switch (*p)
-            {
-            case '0':
-            case '1':
-            case '2':
-            case '3':
-            case '4':
-            case '5':
-            case '6':
-            case '7':
-              state = ST_OCTAL;	/* Octal sequence */
-              num = *p - '0';
-              break;
-            case 'x':
-            case 'X':
-              state = ST_HEX;	/* Hex sequence */
-              num = 0;
-              break;
-            case 'a':		/* Bell */
-              num = '\a';
-              break;
-            case 'b':		/* Backspace */
-              num = '\b';
-              break;
-            case 'e':		/* Escape */
-              num = 27;
-              break;
-            case 'f':		/* Form feed */
-              num = '\f';
-              break;
-            case 'n':		/* Newline */
-              num = '\n';
-              break;
-            case 'r':		/* Carriage return */
-              num = '\r';
-              break;
-            case 't':		/* Tab */
-              num = '\t';
-              break;
-            case 'v':		/* Vtab */
-              num = '\v';
-              break;
-            case '?':		/* Delete */
-              num = 127;
-              break;
-            case '_':		/* Space */
-              num = ' ';
-              break;
-            case '\0':		/* End of string */
-              state = ST_ERROR;	/* Error! */
-              break;
-            default:		/* Escaped character like \ ^ : = */
-              num = *p;
-              break;
-            }
-          if (state == ST_BACKSLASH)
-            {
-              *(q++) = num;
-              ++count;
-              state = ST_GND;
-            }
-          ++p;
-          break;
-
-        case ST_OCTAL:		/* Octal sequence */
-          if (*p < '0' || *p > '7')
-            {
-              *(q++) = num;
-              ++count;
-              state = ST_GND;
-            }
-          else
-            num = (num << 3) + (*(p++) - '0');
-          break;
-
-        case ST_HEX:		/* Hex sequence */
-          switch (*p)
-            {
-            case '0':
-            case '1':
-            case '2':
-            case '3':
-            case '4':
-            case '5':
-            case '6':
-            case '7':
-            case '8':
-            case '9':
-              num = (num << 4) + (*(p++) - '0');
-              break;
-            case 'a':
-            case 'b':
-            case 'c':
-            case 'd':
-            case 'e':
-            case 'f':
-              num = (num << 4) + (*(p++) - 'a') + 10;
-              break;
-            case 'A':
-            case 'B':
-            case 'C':
-            case 'D':
-            case 'E':
-            case 'F':
-              num = (num << 4) + (*(p++) - 'A') + 10;
-              break;
-            default:
-              *(q++) = num;
-              ++count;
-              state = ST_GND;
-              break;
-            }
-          break;
-
-        case ST_CARET:		/* Caret escape */
-          state = ST_GND;	/* Should be the next state... */
-          if (*p >= '@' && *p <= '~')
-            {
-              *(q++) = *(p++) & 037;
-              ++count;
-            }
-          else if (*p == '?')
-            {
-              *(q++) = 127;
-              ++count;
-            }
-          else
-            state = ST_ERROR;
-          break;
-
-        default:
-          abort ();
-        }
-    }
-
-  *dest = q;
-  *src = p;
-  *output_count = count;
-
-  return state != ST_ERROR;
-}
-
 enum parse_state
   {
     PS_START = 1,
@@ -2696,6 +2544,192 @@ known_term_type (void)
   return false;
 }
 
+/* Load the compiled color database FILE, as written by dircolors
+   --compile, pointing the indicator table and the extension list
+   directly into its string pool.  Return true on success; on any
+   failure diagnose, leave the color tables untouched, and let the
+   caller fall back to parsing LS_COLORS.  */
+
+static bool
+load_color_db (char const *file)
+{
+  FILE *fp = fopen (file, "r");
+  if (! fp)
+    {
+      error (0, errno, "%s", quotef (file));
+      return false;
+    }
+
+  bool ok = false;
+  struct colordb_header h;
+  struct colordb_entry *entries = NULL;
+  char *pool = NULL;
+  struct stat st;
+  size_t n_exts = 0;
+
+  if (fread (&h, sizeof h, 1, fp) == 1
+      && memcmp (h.magic, COLORDB_MAGIC, sizeof h.magic) == 0
+      && h.byte_order == COLORDB_BYTE_ORDER_MARK
+      && h.version == COLORDB_VERSION
+      && fstat (fileno (fp), &st) == 0
+      && 0 <= st.st_size
+      && (uintmax_t) st.st_size
+         == (sizeof h + (uintmax_t) h.n_entries * sizeof *entries
+             + h.pool_size))
+    {
+      entries = xnmalloc (h.n_entries, sizeof *entries);
+      pool = xmalloc (h.pool_size);
+      if (fread (entries, sizeof *entries, h.n_entries, fp) == h.n_entries
+          && fread (pool, 1, h.pool_size, fp) == h.pool_size)
+        {
+          /* Validate everything before applying anything, so a bad
+             database cannot leave the tables partially updated.  */
+          ok = true;
+          for (uint32_t i = 0; ok && i < h.n_entries; i++)
+            {
+              struct colordb_entry const *e = &entries[i];
+              if (h.pool_size < e->pattern_len
+                  || h.pool_size - e->pattern_len < e->pattern_off
+                  || h.pool_size < e->seq_len
+                  || h.pool_size - e->seq_len < e->seq_off)
+                ok = false;
+              else if (e->pattern_len)
+                {
+                  /* Patterns are stored with their leading '*', which
+                     the suffix matcher does not expect; see below.  */
+                  ok = pool[e->pattern_off] == '*';
+                  n_exts++;
+                }
+              else
+                {
+                  int ind_no;
+                  for (ind_no = 0; indicator_name[ind_no] != NULL; ++ind_no)
+                    if (STREQ_LEN (e->label, indicator_name[ind_no], 2))
+                      break;
+                  ok = indicator_name[ind_no] != NULL;
+                }
+            }
+        }
+    }
+
+  if (! ok)
+    {
+      error (0, 0, _("ignoring invalid color database %s"), quoteaf (file));
+      free (entries);
+      free (pool);
+      fclose (fp);
+      return false;
+    }
+  fclose (fp);
+
+  struct color_ext_type *ext_nodes = xnmalloc (n_exts, sizeof *ext_nodes);
+  for (uint32_t i = 0; i < h.n_entries; i++)
+    {
+      struct colordb_entry const *e = &entries[i];
+      if (e->pattern_len)
+        {
+          /* Prepend, so that a later entry overrides an earlier one,
+             as with LS_COLORS.  Strip the leading '*': the suffix
+             matcher sees only the bytes after it, as with LS_COLORS
+             parsing.  */
+          struct color_ext_type *node = &ext_nodes[--n_exts];
+          node->ext.string = pool + e->pattern_off + 1;
+          node->ext.len = e->pattern_len - 1;
+          node->seq.string = pool + e->seq_off;
+          node->seq.len = e->seq_len;
+          node->next = color_ext_list;
+          color_ext_list = node;
+        }
+      else
+        for (int ind_no = 0; indicator_name[ind_no] != NULL; ++ind_no)
+          if (STREQ_LEN (e->label, indicator_name[ind_no], 2))
+            {
+              color_indicator[ind_no].string = pool + e->seq_off;
+              color_indicator[ind_no].len = e->seq_len;
+              break;
+            }
+    }
+
+  free (entries);
+  color_buf = pool;
+  return true;
+}
+
+static size_t
+ext_color_hash (void const *v, size_t table_size)
+{
+  struct ext_color_entry const *e = v;
+  size_t h = e->len;
+  for (size_t i = 0; i < e->len; i++)
+    h = h * 31 + to_uchar (e->suffix[i]);
+  return h % table_size;
+}
+
+static bool
+ext_color_compare (void const *v1, void const *v2)
+{
+  struct ext_color_entry const *e1 = v1;
+  struct ext_color_entry const *e2 = v2;
+  return (e1->len == e2->len
+          && memcmp (e1->suffix, e2->suffix, e1->len) == 0);
+}
+
+/* Build EXT_COLOR_TABLE from COLOR_EXT_LIST, so that per-file color
+   lookup hashes the candidate suffixes instead of scanning the list
+   with a case comparison per entry.  If table construction fails,
+   leave EXT_COLOR_TABLE null and fall back to the list scan.  */
+
+static void
+build_ext_color_table (void)
+{
+  size_t n = 0;
+  size_t pool_bytes = 0;
+  for (struct color_ext_type const *e = color_ext_list; e; e = e->next)
+    {
+      n++;
+      pool_bytes += e->ext.len;
+      if (ext_color_max_len < e->ext.len)
+        ext_color_max_len = e->ext.len;
+    }
+  if (n == 0)
+    return;
+
+  ext_color_table = hash_initialize (n, NULL, ext_color_hash,
+                                     ext_color_compare, NULL);
+  if (ext_color_table == NULL)
+    return;
+
+  struct ext_color_entry *entries = xnmalloc (n, sizeof *entries);
+  char *pool = xmalloc (pool_bytes);
+  ext_color_lens = xnmalloc (n, sizeof *ext_color_lens);
+  ext_color_scratch = xmalloc (ext_color_max_len);
+
+  size_t order = 0;
+  for (struct color_ext_type const *e = color_ext_list; e;
+       e = e->next, order++)
+    {
+      struct ext_color_entry *ent = &entries[order];
+      ent->suffix = pool;
+      ent->len = e->ext.len;
+      ent->order = order;
+      ent->seq = &e->seq;
+      for (size_t i = 0; i < e->ext.len; i++)
+        *pool++ = c_tolower (to_uchar (e->ext.string[i]));
+
+      /* On a duplicate key the first insertion is kept, which is the
+         entry the list scan would have found.  */
+      if (hash_insert (ext_color_table, ent) == NULL)
+        xalloc_die ();
+
+      size_t j;
+      for (j = 0; j < ext_color_n_lens; j++)
+        if (ext_color_lens[j] == ent->len)
+          break;
+      if (j == ext_color_n_lens)
+        ext_color_lens[ext_color_n_lens++] = ent->len;
+    }
+}
+
 static void
 parse_ls_color (void)
 {
@@ -2705,6 +2739,18 @@ parse_ls_color (void)
   char label[3];		/* Indicator label */
   struct color_ext_type *ext;	/* Extension we are working on */
 
+  /* A compiled color database takes precedence over LS_COLORS; it
+     needs no unescaping and no per-entry allocation.  */
+  char const *db = getenv ("LS_COLORS_DB");
+  if (db && *db && load_color_db (db))
+    {
+      build_ext_color_table ();
+      if (color_indicator[C_LINK].len == 6
+          && !STRNCMP_LIT (color_indicator[C_LINK].string, "target"))
+        color_symlink_as_referent = true;
+      return;
+    }
+
   if ((p = getenv ("LS_COLORS")) == NULL || *p == '\0')
     {
       /* LS_COLORS takes precedence, but if that's not set then
@@ -2751,7 +2797,7 @@ parse_ls_color (void)
               ++p;
               ext->ext.string = buf;
 
-              state = (get_funky_string (&buf, &p, true, &ext->ext.len)
+              state = (color_unescape (&buf, &p, true, &ext->ext.len)
                        ? PS_4 : PS_FAIL);
               break;
 
@@ -2785,7 +2831,7 @@ parse_ls_color (void)
                   if (STREQ (label, indicator_name[ind_no]))
                     {
                       color_indicator[ind_no].string = buf;
-                      state = (get_funky_string (&buf, &p, false,
+                      state = (color_unescape (&buf, &p, false,
                                                  &color_indicator[ind_no].len)
                                ? PS_START : PS_FAIL);
                       break;
@@ -2800,7 +2846,7 @@ parse_ls_color (void)
           if (*(p++) == '=')
             {
               ext->seq.string = buf;
-              state = (get_funky_string (&buf, &p, false, &ext->seq.len)
+              state = (color_unescape (&buf, &p, false, &ext->seq.len)
                        ? PS_START : PS_FAIL);
             }
           else
@@ -2833,6 +2879,9 @@ parse_ls_color (void)
       print_with_color = false;
     }
 
+  if (print_with_color)
+    build_ext_color_table ();
+
   if (color_indicator[C_LINK].len == 6
       && !STRNCMP_LIT (color_indicator[C_LINK].string, "target"))
     color_symlink_as_referent = true;
@@ -2901,6 +2950,399 @@ queue_directory (char const *name, char const *realname, bool command_line_arg)
   pending_dirs = new;
 }
 
+/* Return whether gobble_file must stat the file of type TYPE with
+   inode INODE, given COMMAND_LINE_ARG.  print_dir also uses this to
+   decide which entries its prefetch pool should stat.  */
+static bool
+file_needs_stat (enum filetype type, ino_t inode, bool command_line_arg)
+{
+  return (command_line_arg
+          || print_hyperlink
+          || format_needs_stat
+          /* When coloring a directory (we may know the type from
+             direct.d_type), we have to stat it in order to indicate
+             sticky and/or other-writable attributes.  */
+          || (type == directory && print_with_color
+              && (is_colored (C_OTHER_WRITABLE)
+                  || is_colored (C_STICKY)
+                  || is_colored (C_STICKY_OTHER_WRITABLE)))
+          /* When dereferencing symlinks, the inode and type must come from
+             stat, but readdir provides the inode and type of lstat.  */
+          || ((print_inode || format_needs_type)
+              && (type == symbolic_link || type == unknown)
+              && (dereference == DEREF_ALWAYS
+                  || color_symlink_as_referent || check_symlink_mode))
+          /* Command line dereferences are already taken care of by the above
+             assertion that the inode number is not yet known.  */
+          || (print_inode && inode == NOT_AN_INODE_NUMBER)
+          || (format_needs_type
+              && (type == unknown || command_line_arg
+                  /* --indicator-style=classify (aka -F)
+                     requires that we stat each regular file
+                     to see if it's executable.  */
+                  || (type == normal && (indicator_style == classify
+                                         /* This is so that --color ends up
+                                            highlighting files with these mode
+                                            bits set even when options like -F
+                                            are not specified.  Note we do a
+                                            redundant stat in the very unlikely
+                                            case where C_CAP is set but not the
+                                            others. */
+                                         || (print_with_color
+                                             && (is_colored (C_EXEC)
+                                                 || is_colored (C_SETUID)
+                                                 || is_colored (C_SETGID)
+                                                 || is_colored (C_CAP)))
+                                         )))));
+}
+
+/* The result of a stat call prefetched by print_dir's worker pool.  */
+struct prestat
+{
+  struct stat st;
+  char *linkname;               /* Prefetched symlink target, or NULL.  */
+  int err;                      /* 0, or the errno of the failed call.  */
+  int link_err;                 /* errno when a prefetched readlink failed.  */
+  bool valid;                   /* Whether this entry was prefetched.  */
+  bool link_valid;              /* Whether the target was prefetched.  */
+};
+
+/* A directory entry read ahead of processing.  */
+struct pending_ent
+{
+  char *name;
+  enum filetype type;
+  ino_t inode;
+  struct prestat prestat;
+};
+
+/* Shared state for the threads prefetching stat data.  */
+struct prestat_pool
+{
+  struct pending_ent *ents;
+  size_t n_ents;
+  size_t next;                  /* Index of the next unclaimed entry.  */
+  pthread_mutex_t lock;
+  char const *dirname;
+};
+
+/* Deliver the prefetched result PS into *ST, as stat would.  */
+static int
+prestat_result (struct prestat const *ps, struct stat *st)
+{
+  if (ps->err)
+    {
+      errno = ps->err;
+      return -1;
+    }
+  *st = ps->st;
+  return 0;
+}
+
+/* Claim entries from POOL_ARG and stat each one the way gobble_file
+   would, until none remain.  */
+static void *
+prestat_thread (void *pool_arg)
+{
+  struct prestat_pool *pool = pool_arg;
+
+  while (true)
+    {
+      pthread_mutex_lock (&pool->lock);
+      size_t i = pool->next;
+      if (i < pool->n_ents)
+        pool->next++;
+      pthread_mutex_unlock (&pool->lock);
+      if (pool->n_ents <= i)
+        break;
+
+      struct pending_ent *e = &pool->ents[i];
+      if (! file_needs_stat (e->type, e->inode, false))
+        continue;
+
+      char *full_name;
+      if (e->name[0] == '/' || pool->dirname[0] == 0)
+        full_name = e->name;
+      else
+        {
+          full_name = xmalloc (strlen (e->name)
+                               + strlen (pool->dirname) + 2);
+          attach (full_name, pool->dirname, e->name);
+        }
+
+      int err = (dereference == DEREF_ALWAYS
+                 ? do_stat (full_name, &e->prestat.st)
+                 : do_lstat (full_name, &e->prestat.st));
+      e->prestat.err = err == 0 ? 0 : errno;
+      e->prestat.valid = true;
+
+      /* Resolve symlink targets here too, so the readlink calls of
+         'ls -l' on a directory of links overlap like the stat calls.
+         gobble_file interns the name and reports any failure.  */
+      if (err == 0 && S_ISLNK (e->prestat.st.st_mode)
+          && (format == long_format || check_symlink_mode))
+        {
+          e->prestat.linkname
+            = areadlink_with_size (full_name, e->prestat.st.st_size);
+          e->prestat.link_err = e->prestat.linkname ? 0 : errno;
+          e->prestat.link_valid = true;
+        }
+
+      if (full_name != e->name)
+        free (full_name);
+    }
+
+  return NULL;
+}
+
+/* A user or group name cached by the prefetching lookups below,
+   keyed by the numeric id; NAME is null when the id has no name, so
+   negative answers are remembered too.  */
+struct id_name
+{
+  unsigned long int id;
+  char *name;
+};
+
+/* Names already resolved or being resolved, or null when no
+   prefetching has happened.  Written only by the main thread.  */
+static Hash_table *user_name_cache;
+static Hash_table *group_name_cache;
+
+static size_t
+id_name_hash (void const *x, size_t table_size)
+{
+  return ((struct id_name const *) x)->id % table_size;
+}
+
+static bool
+id_name_compare (void const *x, void const *y)
+{
+  return (((struct id_name const *) x)->id
+          == ((struct id_name const *) y)->id);
+}
+
+/* One name still to resolve: the cache entry to fill in, and which
+   data base to ask.  */
+struct id_job
+{
+  struct id_name *ent;
+  bool is_group;
+};
+
+/* Shared state for the threads resolving names.  */
+struct id_pool
+{
+  struct id_job *jobs;
+  size_t n_jobs;
+  size_t next;                  /* Index of the next unclaimed job.  */
+  pthread_mutex_t lock;
+};
+
+/* Claim jobs from POOL_ARG and resolve each id with the reentrant
+   lookup functions, until none remain.  Each job fills in a distinct
+   cache entry, so only claiming an index needs the lock.  */
+static void *
+id_lookup_thread (void *pool_arg)
+{
+  struct id_pool *pool = pool_arg;
+  size_t bufsize = 1024;
+  char *buf = xmalloc (bufsize);
+
+  while (true)
+    {
+      pthread_mutex_lock (&pool->lock);
+      size_t i = pool->next;
+      if (i < pool->n_jobs)
+        pool->next++;
+      pthread_mutex_unlock (&pool->lock);
+      if (pool->n_jobs <= i)
+        break;
+
+      struct id_job *job = &pool->jobs[i];
+      while (true)
+        {
+          int err;
+          if (job->is_group)
+            {
+              struct group grp, *res;
+              err = getgrgid_r (job->ent->id, &grp, buf, bufsize, &res);
+              if (err == 0 && res)
+                job->ent->name = xstrdup (grp.gr_name);
+            }
+          else
+            {
+              struct passwd pwd, *res;
+              err = getpwuid_r (job->ent->id, &pwd, buf, bufsize, &res);
+              if (err == 0 && res)
+                job->ent->name = xstrdup (pwd.pw_name);
+            }
+          if (err != ERANGE)
+            break;
+          buf = xrealloc (buf, bufsize *= 2);
+        }
+    }
+
+  free (buf);
+  return NULL;
+}
+
+/* Enter ID into *CACHE, creating the table on first use, and
+   schedule a lookup job in POOL unless the id is already known.  */
+static void
+queue_id_lookup (Hash_table **cache, unsigned long int id,
+                 bool is_group, struct id_pool *pool, size_t *jobs_alloc)
+{
+  if (! *cache)
+    {
+      *cache = hash_initialize (61, NULL, id_name_hash,
+                                id_name_compare, NULL);
+      if (*cache == NULL)
+        xalloc_die ();
+    }
+
+  struct id_name key;
+  key.id = id;
+  if (hash_lookup (*cache, &key))
+    return;
+
+  struct id_name *ent = xmalloc (sizeof *ent);
+  ent->id = id;
+  ent->name = NULL;
+  if (hash_insert (*cache, ent) == NULL)
+    xalloc_die ();
+
+  if (pool->n_jobs == *jobs_alloc)
+    pool->jobs = X2NREALLOC (pool->jobs, jobs_alloc);
+  pool->jobs[pool->n_jobs].ent = ent;
+  pool->jobs[pool->n_jobs].is_group = is_group;
+  pool->n_jobs++;
+}
+
+/* Number of threads resolving names concurrently.  A directory tends
+   to have few distinct owners, but with a networked name service
+   each cold lookup is a round trip, and they serialize inside
+   gobble_file otherwise.  */
+enum { ID_LOOKUP_NTHREADS = 8 };
+
+/* Resolve the user and group names of the successfully stated ENTS
+   concurrently, before gobble_file asks for them one by one.  */
+static void
+prefetch_id_names (struct pending_ent const *ents, size_t n_ents)
+{
+  if (numeric_ids || format != long_format
+      || ! (print_owner || print_group))
+    return;
+
+  struct id_pool pool;
+  pool.jobs = NULL;
+  pool.n_jobs = 0;
+  pool.next = 0;
+  size_t jobs_alloc = 0;
+
+  for (size_t i = 0; i < n_ents; i++)
+    {
+      if (! ents[i].prestat.valid || ents[i].prestat.err)
+        continue;
+      if (print_owner)
+        queue_id_lookup (&user_name_cache, ents[i].prestat.st.st_uid,
+                         false, &pool, &jobs_alloc);
+      if (print_group)
+        queue_id_lookup (&group_name_cache, ents[i].prestat.st.st_gid,
+                         true, &pool, &jobs_alloc);
+    }
+
+  if (pool.n_jobs == 0)
+    return;
+
+  pthread_mutex_init (&pool.lock, NULL);
+  pthread_t threads[ID_LOOKUP_NTHREADS];
+  size_t nstarted = 0;
+  while (nstarted < MIN (ID_LOOKUP_NTHREADS, pool.n_jobs) - 1
+         && pthread_create (&threads[nstarted], NULL,
+                            id_lookup_thread, &pool) == 0)
+    nstarted++;
+
+  id_lookup_thread (&pool);
+
+  for (size_t i = 0; i < nstarted; i++)
+    pthread_join (threads[i], NULL);
+  pthread_mutex_destroy (&pool.lock);
+  free (pool.jobs);
+}
+
+/* Return the name of the user with id U, or null if it has none,
+   preferring the prefetched cache over the serial lookup.  */
+static char const *
+cached_getuser (uid_t u)
+{
+  if (user_name_cache)
+    {
+      struct id_name key;
+      key.id = u;
+      struct id_name *ent = hash_lookup (user_name_cache, &key);
+      if (ent)
+        return ent->name;
+    }
+  return getuser (u);
+}
+
+/* Likewise, for groups.  */
+static char const *
+cached_getgroup (gid_t g)
+{
+  if (group_name_cache)
+    {
+      struct id_name key;
+      key.id = g;
+      struct id_name *ent = hash_lookup (group_name_cache, &key);
+      if (ent)
+        return ent->name;
+    }
+  return getgroup (g);
+}
+
+/* Number of threads used to prefetch stat data, and the directory
+   size below which the pool is not worth its setup cost.  The stat
+   calls for large directories dominate 'ls -l', and on network file
+   systems their latency serializes; overlapping a handful of them
+   hides most of it.  */
+enum { PRESTAT_NTHREADS = 8 };
+enum { PRESTAT_THRESHOLD = 100 };
+
+/* Stat the entries of ENTS that will need it, concurrently.
+   Entries left with an invalid prestat are handled by gobble_file
+   as usual.  */
+static void
+prestat_entries (struct pending_ent *ents, size_t n_ents,
+                 char const *dirname)
+{
+  if (n_ents < PRESTAT_THRESHOLD)
+    return;
+
+  struct prestat_pool pool;
+  pool.ents = ents;
+  pool.n_ents = n_ents;
+  pool.next = 0;
+  pthread_mutex_init (&pool.lock, NULL);
+  pool.dirname = dirname;
+
+  pthread_t threads[PRESTAT_NTHREADS];
+  size_t nstarted = 0;
+  while (nstarted < PRESTAT_NTHREADS - 1
+         && pthread_create (&threads[nstarted], NULL,
+                            prestat_thread, &pool) == 0)
+    nstarted++;
+
+  prestat_thread (&pool);
+
+  for (size_t i = 0; i < nstarted; i++)
+    pthread_join (threads[i], NULL);
+  pthread_mutex_destroy (&pool.lock);
+
+  prefetch_id_names (ents, n_ents);
+}
+
 /* Read directory NAME, and list the files in it.
    If REALNAME is nonzero, print its name instead of NAME;
    this is used for symbolic links to directories.
@@ -2954,7 +3396,10 @@ print_dir (char const *name, char const *realname, bool command_line_arg)
 
   clear_files ();
 
-  if (recursive || print_dir_name)
+  /* --json records name their directory instead of a header line.  */
+  json_dirname = realname ? realname : name;
+
+  if ((recursive || print_dir_name) && !json_output)
     {
       if (!first)
         DIRED_PUTCHAR ('\n');
@@ -2980,12 +3425,34 @@ print_dir (char const *name, char const *realname, bool command_line_arg)
   /* Read the directory entries, and insert the subfiles into the 'cwd_file'
      table.  */
 
+  /* When no sorting or cross-entry layout pass is required, print out
+     each name right away, so ls uses constant memory and produces
+     output immediately while processing the entries of this directory.
+     Useful when there are many (millions) of entries in a directory.
+     Otherwise collect the whole batch first, so the stat data the
+     batch needs can be prefetched in parallel.  */
+  bool stream_entries = (sort_type == sort_none
+                         && !print_block_size && !recursive
+                         && (format == one_per_line
+                             || format == with_commas
+                             || ((format == many_per_line
+                                  || format == horizontal)
+                                 && ! line_length)));
+  size_t stream_pos = 0;
+  bool stream_first = true;
+  struct pending_ent *ents = NULL;
+  size_t n_ents = 0;
+  size_t ents_alloc = 0;
+
+  struct dirent_batch batch;
+  dirent_batch_init (&batch, dirp);
+
   while (1)
     {
       /* Set errno to zero so we can distinguish between a readdir failure
          and when readdir simply finds that there are no more entries.  */
       errno = 0;
-      next = readdir (dirp);
+      next = dirent_batch_read (&batch, dirp);
       if (next)
         {
           if (! file_ignored (next->d_name))
@@ -3007,24 +3474,31 @@ print_dir (char const *name, char const *realname, bool command_line_arg)
 # endif
                 }
 #endif
-              total_blocks += gobble_file (next->d_name, type,
-                                           RELIABLE_D_INO (next),
-                                           false, name);
-
-              /* In this narrow case, print out each name right away, so
-                 ls uses constant memory while processing the entries of
-                 this directory.  Useful when there are many (millions)
-                 of entries in a directory.  */
-              if (format == one_per_line && sort_type == sort_none
-                      && !print_block_size && !recursive)
+              if (stream_entries)
                 {
+                  total_blocks += gobble_file (next->d_name, type,
+                                               RELIABLE_D_INO (next),
+                                               false, name, NULL);
+
                   /* We must call sort_files in spite of
                      "sort_type == sort_none" for its initialization
                      of the sorted_file vector.  */
                   sort_files ();
-                  print_current_files ();
+                  print_streamed_file (&stream_pos, &stream_first);
                   clear_files ();
                 }
+              else
+                {
+                  if (n_ents == ents_alloc)
+                    ents = X2NREALLOC (ents, &ents_alloc);
+                  ents[n_ents].name = store_name (next->d_name);
+                  ents[n_ents].type = type;
+                  ents[n_ents].inode = RELIABLE_D_INO (next);
+                  ents[n_ents].prestat.valid = false;
+                  ents[n_ents].prestat.link_valid = false;
+                  ents[n_ents].prestat.linkname = NULL;
+                  n_ents++;
+                }
             }
         }
       else if (errno != 0)
@@ -3042,6 +3516,19 @@ print_dir (char const *name, char const *realname, bool command_line_arg)
       process_signals ();
     }
 
+  dirent_batch_free (&batch);
+
+  prestat_entries (ents, n_ents, name);
+  for (size_t i = 0; i < n_ents; i++)
+    {
+      total_blocks += gobble_file (ents[i].name, ents[i].type,
+                                   ents[i].inode, false, name,
+                                   &ents[i].prestat);
+      free (ents[i].prestat.linkname);
+      process_signals ();
+    }
+  free (ents);
+
   if (closedir (dirp) != 0)
     {
       file_failure (command_line_arg, _("closing directory %s"), name);
@@ -3057,7 +3544,7 @@ print_dir (char const *name, char const *realname, bool command_line_arg)
   if (recursive)
     extract_dirs_from_files (name, false);
 
-  if (format == long_format || print_block_size)
+  if ((format == long_format && !json_output) || print_block_size)
     {
       char const *p;
       char buf[LONGEST_HUMAN_READABLE + 1];
@@ -3072,6 +3559,10 @@ print_dir (char const *name, char const *realname, bool command_line_arg)
       DIRED_PUTCHAR ('\n');
     }
 
+  /* A streamed separator-joined listing still needs its final newline.  */
+  if (stream_entries && format != one_per_line && ! stream_first)
+    putchar ('\n');
+
   if (cwd_n_used)
     print_current_files ();
 }
@@ -3158,14 +3649,69 @@ has_capability (char const *name _GL_UNUSED)
 }
 #endif
 
+/* The strings hung off struct fileinfo (name, linkname, absolute_name)
+   are packed end to end into large blocks released wholesale in
+   clear_files, instead of one malloc/free pair per string.  On large
+   directories that removes millions of allocator calls, and keeping
+   the names adjacent in memory helps the comparisons done while
+   sorting.  */
+
+struct name_block
+{
+  struct name_block *next;
+  size_t used;
+  size_t size;
+  char store[FLEXIBLE_ARRAY_MEMBER];
+};
+
+static struct name_block *name_blocks;
+
+enum { NAME_BLOCK_SIZE = 256 * 1024 };
+
+/* Return a copy of STR that lives until the next free_names call.  */
+static char *
+store_name (char const *str)
+{
+  size_t len = strlen (str) + 1;
+  struct name_block *b = name_blocks;
+  if (!b || b->size - b->used < len)
+    {
+      size_t size = MAX (len, (size_t) NAME_BLOCK_SIZE);
+      b = xmalloc (FLEXSIZEOF (struct name_block, store, size));
+      b->next = name_blocks;
+      b->used = 0;
+      b->size = size;
+      name_blocks = b;
+    }
+  char *p = b->store + b->used;
+  b->used += len;
+  return memcpy (p, str, len);
+}
+
+/* Release all stored names at once.  The newest block is kept for
+   reuse, so when streaming entries one at a time this costs nothing.  */
+static void
+free_names (void)
+{
+  if (name_blocks)
+    {
+      struct name_block *b = name_blocks->next;
+      name_blocks->used = 0;
+      name_blocks->next = NULL;
+      while (b)
+        {
+          struct name_block *next = b->next;
+          free (b);
+          b = next;
+        }
+    }
+}
+
 /* Enter and remove entries in the table 'cwd_file'.  */
 
 static void
 free_ent (struct fileinfo *f)
 {
-  free (f->name);
-  free (f->linkname);
-  free (f->absolute_name);
   if (f->scontext != UNKNOWN_SECURITY_CONTEXT)
     {
       if (is_smack_enabled ())
@@ -3185,6 +3731,7 @@ clear_files (void)
       free_ent (f);
     }
 
+  free_names ();
   cwd_n_used = 0;
   cwd_some_quoted = false;
   any_has_acl = false;
@@ -3299,7 +3846,8 @@ needs_quoting (char const* name)
    Return the number of blocks that the file occupies.  */
 static uintmax_t
 gobble_file (char const *name, enum filetype type, ino_t inode,
-             bool command_line_arg, char const *dirname)
+             bool command_line_arg, char const *dirname,
+             struct prestat const *prestat)
 {
   uintmax_t blocks = 0;
   struct fileinfo *f;
@@ -3328,44 +3876,7 @@ gobble_file (char const *name, enum filetype type, ino_t inode,
         cwd_some_quoted = 1;
     }
 
-  if (command_line_arg
-      || print_hyperlink
-      || format_needs_stat
-      /* When coloring a directory (we may know the type from
-         direct.d_type), we have to stat it in order to indicate
-         sticky and/or other-writable attributes.  */
-      || (type == directory && print_with_color
-          && (is_colored (C_OTHER_WRITABLE)
-              || is_colored (C_STICKY)
-              || is_colored (C_STICKY_OTHER_WRITABLE)))
-      /* When dereferencing symlinks, the inode and type must come from
-         stat, but readdir provides the inode and type of lstat.  */
-      || ((print_inode || format_needs_type)
-          && (type == symbolic_link || type == unknown)
-          && (dereference == DEREF_ALWAYS
-              || color_symlink_as_referent || check_symlink_mode))
-      /* Command line dereferences are already taken care of by the above
-         assertion that the inode number is not yet known.  */
-      || (print_inode && inode == NOT_AN_INODE_NUMBER)
-      || (format_needs_type
-          && (type == unknown || command_line_arg
-              /* --indicator-style=classify (aka -F)
-                 requires that we stat each regular file
-                 to see if it's executable.  */
-              || (type == normal && (indicator_style == classify
-                                     /* This is so that --color ends up
-                                        highlighting files with these mode
-                                        bits set even when options like -F are
-                                        not specified.  Note we do a redundant
-                                        stat in the very unlikely case where
-                                        C_CAP is set but not the others. */
-                                     || (print_with_color
-                                         && (is_colored (C_EXEC)
-                                             || is_colored (C_SETUID)
-                                             || is_colored (C_SETGID)
-                                             || is_colored (C_CAP)))
-                                     )))))
-
+  if (file_needs_stat (type, inode, command_line_arg))
     {
       /* Absolute name of this file.  */
       char *full_name;
@@ -3382,17 +3893,25 @@ gobble_file (char const *name, enum filetype type, ino_t inode,
 
       if (print_hyperlink)
         {
-          f->absolute_name = canonicalize_filename_mode (full_name,
-                                                         CAN_MISSING);
-          if (! f->absolute_name)
+          char *absolute_name = canonicalize_filename_mode (full_name,
+                                                            CAN_MISSING);
+          if (! absolute_name)
             file_failure (command_line_arg,
                           _("error canonicalizing %s"), full_name);
+          else
+            {
+              f->absolute_name = store_name (absolute_name);
+              free (absolute_name);
+            }
         }
 
       switch (dereference)
         {
         case DEREF_ALWAYS:
-          err = do_stat (full_name, &f->stat);
+          if (prestat && prestat->valid)
+            err = prestat_result (prestat, &f->stat);
+          else
+            err = do_stat (full_name, &f->stat);
           do_deref = true;
           break;
 
@@ -3421,7 +3940,10 @@ gobble_file (char const *name, enum filetype type, ino_t inode,
           FALLTHROUGH;
 
         default: /* DEREF_NEVER */
-          err = do_lstat (full_name, &f->stat);
+          if (prestat && prestat->valid)
+            err = prestat_result (prestat, &f->stat);
+          else
+            err = do_lstat (full_name, &f->stat);
           do_deref = false;
           break;
         }
@@ -3439,7 +3961,7 @@ gobble_file (char const *name, enum filetype type, ino_t inode,
           if (command_line_arg)
             return 0;
 
-          f->name = xstrdup (name);
+          f->name = store_name (name);
           cwd_n_used++;
 
           return 0;
@@ -3501,7 +4023,19 @@ gobble_file (char const *name, enum filetype type, ino_t inode,
         {
           struct stat linkstats;
 
-          get_link_name (full_name, f, command_line_arg);
+          if (prestat && prestat->link_valid)
+            {
+              if (prestat->linkname)
+                f->linkname = store_name (prestat->linkname);
+              else
+                {
+                  errno = prestat->link_err;
+                  file_failure (command_line_arg,
+                                _("cannot read symbolic link %s"), full_name);
+                }
+            }
+          else
+            get_link_name (full_name, f, command_line_arg);
           char *linkname = make_link_name (full_name, f->linkname);
 
           /* Use the slower quoting path for this entry, though
@@ -3534,7 +4068,8 @@ gobble_file (char const *name, enum filetype type, ino_t inode,
         f->filetype = normal;
 
       blocks = ST_NBLOCKS (f->stat);
-      if (format == long_format || print_block_size)
+      /* --json needs no column widths, so skip accumulating them.  */
+      if ((format == long_format && !json_output) || print_block_size)
         {
           char buf[LONGEST_HUMAN_READABLE + 1];
           int len = mbswidth (human_readable (blocks, buf, human_output_opts,
@@ -3544,7 +4079,7 @@ gobble_file (char const *name, enum filetype type, ino_t inode,
             block_size_width = len;
         }
 
-      if (format == long_format)
+      if (format == long_format && !json_output)
         {
           if (print_owner)
             {
@@ -3575,7 +4110,7 @@ gobble_file (char const *name, enum filetype type, ino_t inode,
             scontext_width = len;
         }
 
-      if (format == long_format)
+      if (format == long_format && !json_output)
         {
           char b[INT_BUFSIZE_BOUND (uintmax_t)];
           int b_len = strlen (umaxtostr (f->stat.st_nlink, b));
@@ -3609,7 +4144,7 @@ gobble_file (char const *name, enum filetype type, ino_t inode,
         }
     }
 
-  if (print_inode)
+  if (print_inode && !json_output)
     {
       char buf[INT_BUFSIZE_BOUND (uintmax_t)];
       int len = strlen (umaxtostr (f->stat.st_ino, buf));
@@ -3617,7 +4152,7 @@ gobble_file (char const *name, enum filetype type, ino_t inode,
         inode_number_width = len;
     }
 
-  f->name = xstrdup (name);
+  f->name = store_name (name);
   cwd_n_used++;
 
   return blocks;
@@ -3645,10 +4180,15 @@ is_linked_directory (const struct fileinfo *f)
 static void
 get_link_name (char const *filename, struct fileinfo *f, bool command_line_arg)
 {
-  f->linkname = areadlink_with_size (filename, f->stat.st_size);
-  if (f->linkname == NULL)
+  char *linkname = areadlink_with_size (filename, f->stat.st_size);
+  if (linkname == NULL)
     file_failure (command_line_arg, _("cannot read symbolic link %s"),
                   filename);
+  else
+    {
+      f->linkname = store_name (linkname);
+      free (linkname);
+    }
 }
 
 /* If LINKNAME is a relative name and NAME contains one or more
@@ -3752,9 +4292,11 @@ extract_dirs_from_files (char const *dirname, bool command_line_arg)
 }
 
 /* Use strcoll to compare strings in this locale.  If an error occurs,
-   report an error and longjmp to failed_strcoll.  */
+   report an error and longjmp to failed_strcoll.  The buffer is
+   per-thread so that each thread of a parallel sort recovers from its
+   own collation failures independently.  */
 
-static jmp_buf failed_strcoll;
+static _Thread_local jmp_buf failed_strcoll;
 
 static int
 xstrcoll (char const *a, char const *b)
@@ -4029,6 +4571,175 @@ update_current_files_info (void)
     }
 }
 
+/* A parallel sort of SORTED_FILE, used for large directories: the
+   entries are split into slices sorted concurrently, and the sorted
+   slices are then merged pairwise, also concurrently, akin to the
+   merge tree sort(1) builds.  Comparators may fail (xstrcoll), so
+   each thread catches its own collation failure via the per-thread
+   FAILED_STRCOLL and the caller retries with strcmp.  */
+
+enum { PARSORT_NSLICES = 8 };
+
+/* Entries below this are sorted sequentially; the sort of a small
+   directory is too short for thread startup to pay off.  */
+enum { PARSORT_THRESHOLD = 100000 };
+
+struct sort_run
+{
+  void **p;
+  size_t n;
+};
+
+struct parsort_job
+{
+  struct sort_run a;            /* Slice to sort, or first run to merge.  */
+  struct sort_run b;            /* Second run to merge; n == 0 when sorting.  */
+  void **dst;                   /* Where the result goes.  */
+  qsortFunc cmp;
+  bool failed;                  /* A comparison failed in this job.  */
+  bool spawned;
+  pthread_t thread;
+};
+
+static void *
+parsort_thread (void *job_arg)
+{
+  struct parsort_job *job = job_arg;
+
+  if (setjmp (failed_strcoll))
+    {
+      job->failed = true;
+      return NULL;
+    }
+
+  if (job->b.n == 0)
+    {
+      /* Sort the slice in a private region of scratch space,
+         as mpsort needs headroom beyond the array it sorts.  */
+      memcpy (job->dst, job->a.p, job->a.n * sizeof *job->dst);
+      mpsort ((void const **) job->dst, job->a.n, job->cmp);
+    }
+  else
+    {
+      void **a = job->a.p;
+      void **b = job->b.p;
+      void **dst = job->dst;
+      size_t na = job->a.n;
+      size_t nb = job->b.n;
+
+      while (na && nb)
+        {
+          if (job->cmp (*a, *b) <= 0)
+            {
+              *dst++ = *a++;
+              na--;
+            }
+          else
+            {
+              *dst++ = *b++;
+              nb--;
+            }
+        }
+      memcpy (dst, na ? a : b, (na ? na : nb) * sizeof *dst);
+    }
+
+  return NULL;
+}
+
+/* Run NJOBS jobs concurrently, the first on this thread.  If a worker
+   thread cannot be created its job simply runs here too.  */
+
+static void
+parsort_run_jobs (struct parsort_job *jobs, int njobs)
+{
+  for (int i = 1; i < njobs; i++)
+    {
+      jobs[i].spawned =
+        pthread_create (&jobs[i].thread, NULL, parsort_thread, &jobs[i]) == 0;
+      if (! jobs[i].spawned)
+        parsort_thread (&jobs[i]);
+    }
+  parsort_thread (&jobs[0]);
+  for (int i = 1; i < njobs; i++)
+    if (jobs[i].spawned)
+      pthread_join (jobs[i].thread, NULL);
+}
+
+/* Sort SORTED_FILE with CMP using several threads.  Return false if
+   this was declined and the caller should sort sequentially;
+   otherwise set *FAILED to whether a collation failure occurred,
+   in which case the order is undefined and the caller must retry
+   with an infallible comparator.  */
+
+static bool
+sort_files_parallel (qsortFunc cmp, bool *failed)
+{
+  size_t n = cwd_n_used;
+  if (n < PARSORT_THRESHOLD)
+    return false;
+
+  void **scratch = malloc ((n + n / 2 + PARSORT_NSLICES) * sizeof *scratch);
+  if (! scratch)
+    return false;
+
+  struct parsort_job jobs[PARSORT_NSLICES];
+  struct sort_run runs[PARSORT_NSLICES];
+  *failed = false;
+
+  size_t lo = 0, off = 0;
+  for (int i = 0; i < PARSORT_NSLICES; i++)
+    {
+      size_t len = n / PARSORT_NSLICES + (i < n % PARSORT_NSLICES);
+      jobs[i].a = (struct sort_run) { sorted_file + lo, len };
+      jobs[i].b.n = 0;
+      jobs[i].dst = scratch + off;
+      jobs[i].cmp = cmp;
+      jobs[i].failed = false;
+      runs[i] = (struct sort_run) { jobs[i].dst, len };
+      lo += len;
+      off += len + len / 2 + 1;
+    }
+  parsort_run_jobs (jobs, PARSORT_NSLICES);
+  for (int i = 0; i < PARSORT_NSLICES; i++)
+    *failed |= jobs[i].failed;
+
+  /* Merge pairs of runs, alternating between SORTED_FILE and SCRATCH
+     so that sources and destinations never overlap.  PARSORT_NSLICES
+     is a power of two, so every pass pairs all runs, and with three
+     passes the final merge lands back in SORTED_FILE.  */
+  int nruns = PARSORT_NSLICES;
+  bool into_files = true;
+  while (1 < nruns && ! *failed)
+    {
+      void **dstbase = into_files ? sorted_file : scratch;
+      size_t pos = 0;
+      int npairs = nruns / 2;
+
+      for (int i = 0; i < npairs; i++)
+        {
+          jobs[i].a = runs[2 * i];
+          jobs[i].b = runs[2 * i + 1];
+          jobs[i].dst = dstbase + pos;
+          jobs[i].cmp = cmp;
+          jobs[i].failed = false;
+          runs[i] = (struct sort_run) { jobs[i].dst, jobs[i].a.n + jobs[i].b.n };
+          pos += runs[i].n;
+        }
+      parsort_run_jobs (jobs, npairs);
+      for (int i = 0; i < npairs; i++)
+        *failed |= jobs[i].failed;
+
+      nruns = npairs;
+      into_files = ! into_files;
+    }
+
+  if (! *failed && runs[0].p != sorted_file)
+    memcpy (sorted_file, runs[0].p, n * sizeof *sorted_file);
+
+  free (scratch);
+  return true;
+}
+
 /* Sort the files now in the table.  */
 
 static void
@@ -4065,10 +4776,29 @@ sort_files (void)
     }
 
   /* When sort_type == sort_time, use time_type as subindex.  */
-  mpsort ((void const **) sorted_file, cwd_n_used,
-          sort_functions[sort_type + (sort_type == sort_time ? time_type : 0)]
-                        [use_strcmp][sort_reverse]
-                        [directories_first]);
+  qsortFunc cmp =
+    sort_functions[sort_type + (sort_type == sort_time ? time_type : 0)]
+                  [use_strcmp][sort_reverse]
+                  [directories_first];
+
+  bool collation_failed;
+  if (sort_files_parallel (cmp, &collation_failed))
+    {
+      if (! collation_failed)
+        return;
+
+      /* A worker hit a collation error; fall back on strcmp ordering,
+         as the longjmp above does for the sequential sort.  */
+      assert (sort_type != sort_version);
+      initialize_ordering_vector ();
+      cmp = sort_functions[sort_type + (sort_type == sort_time ? time_type : 0)]
+                          [true][sort_reverse]
+                          [directories_first];
+      if (sort_files_parallel (cmp, &collation_failed))
+        return;                 /* strcmp comparisons cannot fail.  */
+    }
+
+  mpsort ((void const **) sorted_file, cwd_n_used, cmp);
 }
 
 /* List all the files now in the table.  */
@@ -4109,9 +4839,14 @@ print_current_files (void)
     case long_format:
       for (i = 0; i < cwd_n_used; i++)
         {
-          set_normal_color ();
-          print_long_format (sorted_file[i]);
-          DIRED_PUTCHAR ('\n');
+          if (json_output)
+            print_json_format (sorted_file[i]);
+          else
+            {
+              set_normal_color ();
+              print_long_format (sorted_file[i]);
+              DIRED_PUTCHAR ('\n');
+            }
         }
       break;
     }
@@ -4202,7 +4937,7 @@ static void
 format_user (uid_t u, int width, bool stat_ok)
 {
   format_user_or_group (! stat_ok ? "?" :
-                        (numeric_ids ? NULL : getuser (u)), u, width);
+                        (numeric_ids ? NULL : cached_getuser (u)), u, width);
 }
 
 /* Likewise, for groups.  */
@@ -4211,7 +4946,7 @@ static void
 format_group (gid_t g, int width, bool stat_ok)
 {
   format_user_or_group (! stat_ok ? "?" :
-                        (numeric_ids ? NULL : getgroup (g)), g, width);
+                        (numeric_ids ? NULL : cached_getgroup (g)), g, width);
 }
 
 /* Return the number of columns that format_user_or_group will print.  */
@@ -4237,7 +4972,8 @@ format_user_or_group_width (char const *name, unsigned long int id)
 static int
 format_user_width (uid_t u)
 {
-  return format_user_or_group_width (numeric_ids ? NULL : getuser (u), u);
+  return format_user_or_group_width (numeric_ids ? NULL : cached_getuser (u),
+                                     u);
 }
 
 /* Likewise, for groups.  */
@@ -4245,7 +4981,8 @@ format_user_width (uid_t u)
 static int
 format_group_width (gid_t g)
 {
-  return format_user_or_group_width (numeric_ids ? NULL : getgroup (g), g);
+  return format_user_or_group_width (numeric_ids ? NULL : cached_getgroup (g),
+                                     g);
 }
 
 /* Return a pointer to a formatted version of F->stat.st_ino,
@@ -4479,6 +5216,149 @@ print_long_format (const struct fileinfo *f)
     print_type_indicator (f->stat_ok, f->stat.st_mode, f->filetype);
 }
 
+/* Print information about F as one JSON object per line.  The fixed
+   fields are assembled in a stack buffer and flushed in spans around
+   the streamed name strings, so the serializer allocates nothing,
+   and no column widths are needed.  */
+
+static void
+print_json_format (const struct fileinfo *f)
+{
+  /* Ample for every numeric member plus the key syntax around it.  */
+  char buf[16 * (INT_BUFSIZE_BOUND (uintmax_t) + sizeof "\"mtime_nsec\":,")];
+  char *p = buf;
+
+  fputs ("{\"name\":", stdout);
+  json_fputs_quoted (f->name, stdout);
+
+  if (json_dirname)
+    {
+      fputs (",\"dir\":", stdout);
+      json_fputs_quoted (json_dirname, stdout);
+    }
+
+  p += sprintf (p, ",\"type\":\"%c\"", filetype_letter[f->filetype]);
+
+  if (f->stat_ok)
+    {
+      static char const *const time_keys[] =
+        { "mtime", "ctime", "atime", "btime" };
+      struct timespec when_timespec;
+
+      switch (time_type)
+        {
+        case time_ctime:
+          when_timespec = get_stat_ctime (&f->stat);
+          break;
+        case time_mtime:
+          when_timespec = get_stat_mtime (&f->stat);
+          break;
+        case time_atime:
+          when_timespec = get_stat_atime (&f->stat);
+          break;
+        case time_btime:
+          when_timespec = get_stat_btime (&f->stat);
+          break;
+        default:
+          abort ();
+        }
+
+      p += sprintf (p, ",\"mode\":\"%jo\",\"nlink\":%ju",
+                    (uintmax_t) f->stat.st_mode,
+                    (uintmax_t) f->stat.st_nlink);
+      p += sprintf (p, ",\"uid\":%ju,\"gid\":%ju",
+                    (uintmax_t) f->stat.st_uid, (uintmax_t) f->stat.st_gid);
+
+      if (! numeric_ids)
+        {
+          char const *owner = cached_getuser (f->stat.st_uid);
+          char const *group = cached_getgroup (f->stat.st_gid);
+          if (owner)
+            {
+              fwrite (buf, 1, p - buf, stdout);
+              p = buf;
+              fputs (",\"owner\":", stdout);
+              json_fputs_quoted (owner, stdout);
+            }
+          if (group)
+            {
+              fwrite (buf, 1, p - buf, stdout);
+              p = buf;
+              fputs (",\"group\":", stdout);
+              json_fputs_quoted (group, stdout);
+            }
+        }
+
+      if (S_ISCHR (f->stat.st_mode) || S_ISBLK (f->stat.st_mode))
+        p += sprintf (p, ",\"major\":%ju,\"minor\":%ju",
+                      (uintmax_t) major (f->stat.st_rdev),
+                      (uintmax_t) minor (f->stat.st_rdev));
+      else
+        p += sprintf (p, ",\"size\":%ju",
+                      unsigned_file_size (f->stat.st_size));
+
+      p += sprintf (p, ",\"blocks\":%ju,\"inode\":%ju",
+                    (uintmax_t) ST_NBLOCKS (f->stat),
+                    (uintmax_t) f->stat.st_ino);
+
+      if (! (time_type == time_btime
+             && when_timespec.tv_sec == -1 && when_timespec.tv_nsec == -1))
+        p += sprintf (p, ",\"%s_sec\":%jd,\"%s_nsec\":%ld",
+                      time_keys[time_type], (intmax_t) when_timespec.tv_sec,
+                      time_keys[time_type], (long int) when_timespec.tv_nsec);
+    }
+
+  fwrite (buf, 1, p - buf, stdout);
+
+  if (f->filetype == symbolic_link && f->linkname)
+    {
+      fputs (",\"target\":", stdout);
+      json_fputs_quoted (f->linkname, stdout);
+    }
+
+  if (print_scontext)
+    {
+      fputs (",\"scontext\":", stdout);
+      json_fputs_quoted (f->scontext, stdout);
+    }
+
+  fputs ("}\n", stdout);
+}
+
+/* Return true if the LEN bytes at BUF are all printable ASCII
+   characters, in which case their display width is simply LEN.
+   Checking a word at a time keeps this cheap for the common all-ASCII
+   file names, so the multibyte machinery below only runs for names
+   that actually need it.  */
+
+static bool
+all_ascii_printable (char const *buf, size_t len)
+{
+  unsigned char const *p = (unsigned char const *) buf;
+  uintmax_t const ones = UINTMAX_MAX / 0xff;    /* 0x0101...01  */
+  uintmax_t const highs = ones << 7;            /* 0x8080...80  */
+  size_t i = 0;
+
+  for (; sizeof (uintmax_t) <= len - i; i += sizeof (uintmax_t))
+    {
+      uintmax_t x;
+      memcpy (&x, p + i, sizeof x);
+
+      /* Flag any byte with the high bit set, any byte less than
+         0x20, and any 0x7f (DEL) byte.  */
+      if ((x & highs)
+          | ((x - ones * 0x20) & ~x & highs)
+          | (((x ^ ones * 0x7f) - ones) & ~(x ^ ones * 0x7f) & highs))
+        return false;
+    }
+
+  for (; i < len; i++)
+    if (! (0x20 <= p[i] && p[i] < 0x7f))
+      return false;
+
+  return true;
+}
+
 /* Write to *BUF a quoted representation of the file name NAME, if non-NULL,
    using OPTIONS to control quoting.  *BUF is set to NAME if no quoting
    is required.  *BUF is allocated if more space required (and the original
@@ -4533,7 +5413,9 @@ quote_name_buf (char **inbuf, size_t bufsize, char *name,
 
   if (needs_further_quoting)
     {
-      if (MB_CUR_MAX > 1)
+      if (all_ascii_printable (buf, len))
+        displayed_width = len;  /* Nothing to replace.  */
+      else if (MB_CUR_MAX > 1)
         {
           char const *p = buf;
           char const *plimit = buf + len;
@@ -4650,7 +5532,9 @@ quote_name_buf (char **inbuf, size_t bufsize, char *name,
     }
   else if (width != NULL)
     {
-      if (MB_CUR_MAX > 1)
+      if (all_ascii_printable (buf, len))
+        displayed_width = len;
+      else if (MB_CUR_MAX > 1)
         displayed_width = mbsnwidth (buf, len, 0);
       else
         {
@@ -5011,20 +5895,50 @@ get_color_indicator (const struct fileinfo *f, bool symlink_target)
     }
 
   /* Check the file's suffix only if still classified as C_FILE.  */
-  ext = NULL;
+  struct bin_str const *ext_seq = NULL;
   if (type == C_FILE)
     {
       /* Test if NAME has a recognized suffix.  */
 
       len = strlen (name);
       name += len;		/* Pointer to final \0.  */
-      for (ext = color_ext_list; ext != NULL; ext = ext->next)
+
+      if (ext_color_table)
         {
+          /* Case-fold the longest candidate tail once, then probe the
+             table with each distinct pattern length.  Among matches,
+             the entry nearest the head of COLOR_EXT_LIST wins, as
+             with the list scan.  */
+          size_t tail = MIN (len, ext_color_max_len);
+          for (size_t i = 0; i < tail; i++)
+            ext_color_scratch[i] = c_tolower (to_uchar (name[i - tail]));
+
+          struct ext_color_entry const *best = NULL;
+          for (size_t i = 0; i < ext_color_n_lens; i++)
+            {
+              size_t elen = ext_color_lens[i];
+              if (len < elen)
+                continue;
+              struct ext_color_entry key;
+              key.suffix = ext_color_scratch + (tail - elen);
+              key.len = elen;
+              struct ext_color_entry const *found
+                = hash_lookup (ext_color_table, &key);
+              if (found && (! best || found->order < best->order))
+                best = found;
+            }
+          if (best)
+            ext_seq = best->seq;
+        }
+      else
+        for (ext = color_ext_list; ext != NULL; ext = ext->next)
           if (ext->ext.len <= len
               && c_strncasecmp (name - ext->ext.len, ext->ext.string,
                                 ext->ext.len) == 0)
-            break;
-        }
+            {
+              ext_seq = &ext->seq;
+              break;
+            }
     }
 
   /* Adjust the color for orphaned symlinks.  */
@@ -5035,7 +5949,7 @@ get_color_indicator (const struct fileinfo *f, bool symlink_target)
     }
 
   const struct bin_str *const s
-    = ext ? &(ext->seq) : &color_indicator[type];
+    = ext_seq ? ext_seq : &color_indicator[type];
 
   return s->string ? s : NULL;
 }
@@ -5209,6 +6123,54 @@ print_with_separator (char sep)
   putchar ('\n');
 }
 
+/* Print the single entry in sorted_file as part of a streamed
+   directory listing, where print_dir prints each entry as readdir
+   returns it instead of collecting the whole directory.  *POS is the
+   output position carried across calls, as in print_with_separator;
+   *FIRST is whether no entry has been printed yet.  The caller prints
+   the final newline of separator-joined formats.  */
+
+static void
+print_streamed_file (size_t *pos, bool *first)
+{
+  struct fileinfo const *f = sorted_file[0];
+
+  if (format == one_per_line)
+    {
+      print_file_name_and_frills (f, 0);
+      putchar ('\n');
+      return;
+    }
+
+  char sep = format == with_commas ? ',' : ' ';
+  size_t len = line_length ? length_of_file_name_and_frills (f) : 0;
+
+  if (! *first)
+    {
+      char separator;
+
+      if (! line_length
+          || ((*pos + len + 2 < line_length)
+              && (*pos <= SIZE_MAX - len - 2)))
+        {
+          *pos += 2;
+          separator = ' ';
+        }
+      else
+        {
+          *pos = 0;
+          separator = '\n';
+        }
+
+      putchar (sep);
+      putchar (separator);
+    }
+  *first = false;
+
+  print_file_name_and_frills (f, *pos);
+  *pos += len;
+}
+
 /* Assuming cursor is at position FROM, indent up to position TO.
    Use a TAB character instead of two or more spaces whenever possible.  */
 
@@ -5455,6 +6417,11 @@ Sort entries alphabetically if none of -cftuvSUX nor --sort is specified.\n\
       fputs (_("\
       --hyperlink[=WHEN]     hyperlink file names; WHEN can be 'always'\n\
                                (default if omitted), 'auto', or 'never'\n\
+"), stdout);
+      fputs (_("\
+      --json                 list one JSON object per line, carrying the\n\
+                               long-format information; entries inside a\n\
+                               directory name it in a \"dir\" member\n\
 "), stdout);
       fputs (_("\
       --indicator-style=WORD  append indicator with style WORD to entry names:\
@@ -19,6 +19,7 @@
 #include <config.h>
 
 #include <getopt.h>
+#include <pthread.h>
 #include <sys/types.h>
 
 #include "system.h"
@@ -45,6 +46,8 @@
 #include "die.h"
 #include "error.h"
 #include "fadvise.h"
+#include "hash.h"
+#include "stat-time.h"
 #include "stdio--.h"
 #include "xbinary-io.h"
 
@@ -102,6 +105,42 @@
 # error "Can't decide which hash algorithm to compile."
 #endif
 
+#if USE_SHA_NI && (HASH_ALGO_SHA1 || HASH_ALGO_SHA256 || HASH_ALGO_SHA224)
+# define DIGEST_DISPATCH 1
+# include "cpuid.h"
+# include "digest-sha-ni.h"
+# if HASH_ALGO_SHA1
+#  define DIGEST_STREAM_NI sha1_ni_stream
+# elif HASH_ALGO_SHA256
+#  define DIGEST_STREAM_NI sha256_ni_stream
+# else
+#  define DIGEST_STREAM_NI sha224_ni_stream
+# endif
+
+/* The stream function in use: the portable gnulib implementation
+   unless startup finds the SHA instruction set extensions.  */
+static int (*digest_stream) (FILE *, void *) = DIGEST_STREAM;
+# undef DIGEST_STREAM
+# define DIGEST_STREAM digest_stream
+
+/* Return true if this CPU has the SHA and SSE4.1 instruction sets the
+   dedicated kernel requires.  */
+static bool
+sha_ni_supported (void)
+{
+  unsigned int eax = 0;
+  unsigned int ebx = 0;
+  unsigned int ecx = 0;
+  unsigned int edx = 0;
+
+  if (! __get_cpuid_count (7, 0, &eax, &ebx, &ecx, &edx)
+      || ! (ebx & bit_SHA))
+    return false;
+
+  return __get_cpuid (1, &eax, &ebx, &ecx, &edx) && (ecx & bit_SSE4_1);
+}
+#endif /* USE_SHA_NI */
+
 #if HASH_ALGO_BLAKE2
 # define AUTHORS \
   proper_name ("Padraig Brady"), \
@@ -154,6 +193,18 @@ static bool quiet = false;
    improperly formatted. */
 static bool strict = false;
 
+/* If greater than 1, hash up to this many files concurrently
+   (--threads).  Output and diagnostics keep the input order.  */
+static size_t nthreads = 1;
+
+/* With --check, the name of the verification cache file (--cache),
+   or NULL for no cache.  */
+static char const *cache_file;
+
+/* With --cache, hash listed files even when their cache entries are
+   fresh (--rehash).  The cache is still updated.  */
+static bool rehash_all;
+
 /* Whether a BSD reversed format checksum is detected.  */
 static int bsd_reversed = -1;
 
@@ -192,11 +243,14 @@ static uintmax_t blake2_max_len[]=
    non-character as a pseudo short option, starting with CHAR_MAX + 1.  */
 enum
 {
-  IGNORE_MISSING_OPTION = CHAR_MAX + 1,
+  CACHE_OPTION = CHAR_MAX + 1,
+  IGNORE_MISSING_OPTION,
+  REHASH_OPTION,
   STATUS_OPTION,
   QUIET_OPTION,
   STRICT_OPTION,
-  TAG_OPTION
+  TAG_OPTION,
+  THREADS_OPTION
 };
 
 static struct option const long_options[] =
@@ -205,14 +259,17 @@ static struct option const long_options[] =
   { "length", required_argument, NULL, 'l'},
 #endif
   { "binary", no_argument, NULL, 'b' },
+  { "cache", required_argument, NULL, CACHE_OPTION },
   { "check", no_argument, NULL, 'c' },
   { "ignore-missing", no_argument, NULL, IGNORE_MISSING_OPTION},
   { "quiet", no_argument, NULL, QUIET_OPTION },
+  { "rehash", no_argument, NULL, REHASH_OPTION },
   { "status", no_argument, NULL, STATUS_OPTION },
   { "text", no_argument, NULL, 't' },
   { "warn", no_argument, NULL, 'w' },
   { "strict", no_argument, NULL, STRICT_OPTION },
   { "tag", no_argument, NULL, TAG_OPTION },
+  { "threads", required_argument, NULL, THREADS_OPTION },
   { "zero", no_argument, NULL, 'z' },
   { GETOPT_HELP_OPTION_DECL },
   { GETOPT_VERSION_OPTION_DECL },
@@ -257,6 +314,10 @@ Print or check %s (%d-bit) checksums.\n\
 #endif
       fputs (_("\
       --tag            create a BSD-style checksum\n\
+"), stdout);
+      fputs (_("\
+      --threads=N      hash up to N files concurrently;\n\
+                       output still follows the input order\n\
 "), stdout);
       if (O_BINARY)
         fputs (_("\
@@ -272,9 +333,13 @@ Print or check %s (%d-bit) checksums.\n\
 "), stdout);
       fputs (_("\
 \n\
-The following five options are useful only when verifying checksums:\n\
+The following options are useful only when verifying checksums:\n\
+      --cache=FILE     consult and update a digest cache in FILE, skipping\n\
+                       files whose size, mtime and ctime are unchanged\n\
       --ignore-missing  don't fail or report status for missing files\n\
       --quiet          don't print OK for each successfully verified file\n\
+      --rehash         with --cache, hash files even when their cache\n\
+                       entries are fresh; the cache is still updated\n\
       --status         don't output anything, status code shows success\n\
       --strict         exit non-zero for improperly formatted checksum lines\n\
   -w, --warn           warn about improperly formatted checksum lines\n\
@@ -575,51 +640,70 @@ print_filename (char const *file, bool escape)
     }
 }
 
+/* One file to hash.  Jobs carry everything a worker thread needs, and
+   record the outcome instead of printing it, so that diagnostics and
+   output can be emitted in input order by the dispatching thread.  */
+
+struct digest_job
+{
+  char const *file;
+  int binary;
+  unsigned char *digest;        /* Where to put the binary digest.  */
+  bool ok;
+  bool missing;                 /* Nonexistent, with --ignore-missing.  */
+  int err;                      /* The errno to report when ! ok.  */
+  bool deferred;                /* Hash on the main thread (stdin).  */
+#if HASH_ALGO_BLAKE2
+  uintmax_t b2_len;             /* Digest length in bits for this job.  */
+#endif
+};
+
 /* An interface to the function, DIGEST_STREAM.
-   Operate on FILENAME (it may be "-").
+   Operate on JOB->file (it may be "-").
 
-   *BINARY indicates whether the file is binary.  BINARY < 0 means it
-   depends on whether binary mode makes any difference and the file is
-   a terminal; in that case, clear *BINARY if the file was treated as
-   text because it was a terminal.
+   JOB->binary indicates whether the file is binary.  BINARY < 0 means
+   it depends on whether binary mode makes any difference and the file
+   is a terminal; in that case, clear JOB->binary if the file was
+   treated as text because it was a terminal.
 
-   Put the checksum in *BIN_RESULT, which must be properly aligned.
-   Put true in *MISSING if the file can't be opened due to ENOENT.
-   Return true if successful.  */
+   Put the checksum in JOB->digest, which must be properly aligned.
+   Set JOB->missing if the file can't be opened due to ENOENT.
+   Return true if successful, else set JOB->err for the caller
+   to report.  */
 
 static bool
-digest_file (char const *filename, int *binary, unsigned char *bin_result,
-             bool *missing)
+digest_file_job (struct digest_job *job)
 {
   FILE *fp;
   int err;
-  bool is_stdin = STREQ (filename, "-");
+  bool is_stdin = STREQ (job->file, "-");
 
-  *missing = false;
+  job->missing = false;
+  job->err = 0;
 
   if (is_stdin)
     {
       have_read_stdin = true;
       fp = stdin;
-      if (O_BINARY && *binary)
+      if (O_BINARY && job->binary)
         {
-          if (*binary < 0)
-            *binary = ! isatty (STDIN_FILENO);
-          if (*binary)
+          if (job->binary < 0)
+            job->binary = ! isatty (STDIN_FILENO);
+          if (job->binary)
             xset_binary_mode (STDIN_FILENO, O_BINARY);
         }
     }
   else
     {
-      fp = fopen (filename, (O_BINARY && *binary ? "rb" : "r"));
+      fp = fopen (job->file, (O_BINARY && job->binary ? "rb" : "r"));
       if (fp == NULL)
         {
           if (ignore_missing && errno == ENOENT)
             {
-              *missing = true;
+              job->missing = true;
               return true;
             }
-          error (0, errno, "%s", quotef (filename));
+          job->err = errno;
           return false;
         }
     }
@@ -627,13 +711,13 @@ digest_file (char const *filename, int *binary, unsigned char *bin_result,
   fadvise (fp, FADVISE_SEQUENTIAL);
 
 #if HASH_ALGO_BLAKE2
-  err = DIGEST_STREAM (fp, bin_result, b2_length / 8);
+  err = blake2fns[b2_algorithm] (fp, job->digest, job->b2_len / 8);
 #else
-  err = DIGEST_STREAM (fp, bin_result);
+  err = DIGEST_STREAM (fp, job->digest);
 #endif
   if (err)
     {
-      error (0, errno, "%s", quotef (filename));
+      job->err = errno;
       if (fp != stdin)
         fclose (fp);
       return false;
@@ -641,13 +725,444 @@ digest_file (char const *filename, int *binary, unsigned char *bin_result,
 
   if (!is_stdin && fclose (fp) != 0)
     {
-      error (0, errno, "%s", quotef (filename));
+      job->err = errno;
+      return false;
+    }
+
+  return true;
+}
+
+/* As digest_file_job, but with the historical interface, reporting
+   any failure to stderr directly.  */
+
+static bool
+digest_file (char const *filename, int *binary, unsigned char *bin_result,
+             bool *missing)
+{
+  struct digest_job job;
+
+  job.file = filename;
+  job.binary = *binary;
+  job.digest = bin_result;
+#if HASH_ALGO_BLAKE2
+  job.b2_len = b2_length;
+#endif
+
+  bool ok = digest_file_job (&job);
+  *binary = job.binary;
+  *missing = job.missing;
+  if (! ok)
+    error (0, job.err, "%s", quotef (filename));
+  return ok;
+}
+
+/* A pool of jobs hashed by concurrent workers.  Each thread claims the
+   next unclaimed job under the lock; file order does not matter here,
+   as results are reported by the dispatching thread afterwards.  */
+
+struct digest_pool
+{
+  struct digest_job **jobs;
+  size_t njobs;
+  size_t next;                  /* Index of the next unclaimed job.  */
+  pthread_mutex_t lock;
+};
+
+static void *
+digest_pool_thread (void *pool_arg)
+{
+  struct digest_pool *pool = pool_arg;
+
+  while (true)
+    {
+      pthread_mutex_lock (&pool->lock);
+      size_t i = pool->next++;
+      pthread_mutex_unlock (&pool->lock);
+      if (pool->njobs <= i)
+        break;
+
+      struct digest_job *job = pool->jobs[i];
+      if (! job->deferred)
+        job->ok = digest_file_job (job);
+    }
+
+  return NULL;
+}
+
+/* Hash the NJOBS jobs with up to nthreads threads, this one included.
+   Jobs marked deferred (standard input) run on this thread afterwards,
+   in input order.  If worker threads cannot be created the remaining
+   jobs are simply hashed here.  */
+
+static void
+digest_jobs (struct digest_job **jobs, size_t njobs)
+{
+  struct digest_pool pool = { jobs, njobs, 0, PTHREAD_MUTEX_INITIALIZER };
+  size_t nworkers = MIN (nthreads, njobs) - 1;
+  pthread_t *threads = xnmalloc (nworkers, sizeof *threads);
+  size_t started = 0;
+
+  for (size_t i = 0; i < nworkers; i++)
+    if (pthread_create (&threads[started], NULL,
+                        digest_pool_thread, &pool) == 0)
+      started++;
+
+  digest_pool_thread (&pool);
+
+  while (started)
+    pthread_join (threads[--started], NULL);
+  free (threads);
+
+  for (size_t i = 0; i < njobs; i++)
+    if (jobs[i]->deferred)
+      jobs[i]->ok = digest_file_job (jobs[i]);
+}
+
+/* Print the digest line for FILE, hashed with result BIN_BUFFER.  */
+
+static void
+print_digest_line (char const *file, int file_is_binary,
+                   unsigned char const *bin_buffer, bool prefix_tag)
+{
+  /* We don't really need to escape, and hence detect, the '\\'
+     char, and not doing so should be both forwards and backwards
+     compatible, since only escaped lines would have a '\\' char at
+     the start.  However just in case users are directly comparing
+     against old (hashed) outputs, in the presence of files
+     containing '\\' characters, we decided to not simplify the
+     output in this case.  */
+  bool needs_escape = (strchr (file, '\\') || strchr (file, '\n'))
+                      && delim == '\n';
+
+  if (prefix_tag)
+    {
+      if (needs_escape)
+        putchar ('\\');
+
+#if HASH_ALGO_BLAKE2
+      fputs (algorithm_out_string[b2_algorithm], stdout);
+      if (b2_length < blake2_max_len[b2_algorithm] * 8)
+        printf ("-%"PRIuMAX, b2_length);
+#else
+      fputs (DIGEST_TYPE_STRING, stdout);
+#endif
+      fputs (" (", stdout);
+      print_filename (file, needs_escape);
+      fputs (") = ", stdout);
+    }
+
+  /* Output a leading backslash if the file name contains
+     a newline or backslash.  */
+  if (!prefix_tag && needs_escape)
+    putchar ('\\');
+
+  for (size_t i = 0; i < (digest_hex_bytes / 2); ++i)
+    printf ("%02x", bin_buffer[i]);
+
+  if (!prefix_tag)
+    {
+      putchar (' ');
+
+      putchar (file_is_binary ? '*' : ' ');
+
+      print_filename (file, needs_escape);
+    }
+
+  putchar (delim);
+}
+
+/* Hash the N_OPERANDS file operands with the worker pool and print
+   their digest lines in input order.  Return true if all succeeded.  */
+
+static bool
+digest_operands_parallel (char **operands, size_t n_operands, int binary,
+                          bool prefix_tag)
+{
+  struct digest_job *jobv = xnmalloc (n_operands, sizeof *jobv);
+  struct digest_job **jobs = xnmalloc (n_operands, sizeof *jobs);
+  unsigned char *digests = xnmalloc (n_operands, DIGEST_BIN_BYTES);
+  bool ok = true;
+
+  for (size_t i = 0; i < n_operands; i++)
+    {
+      jobv[i].file = operands[i];
+      jobv[i].binary = binary;
+      jobv[i].digest = digests + i * DIGEST_BIN_BYTES;
+      jobv[i].deferred = STREQ (operands[i], "-");
+#if HASH_ALGO_BLAKE2
+      jobv[i].b2_len = b2_length;
+#endif
+      jobs[i] = &jobv[i];
+    }
+
+  digest_jobs (jobs, n_operands);
+
+  for (size_t i = 0; i < n_operands; i++)
+    {
+      if (! jobv[i].ok)
+        {
+          error (0, jobv[i].err, "%s", quotef (jobv[i].file));
+          ok = false;
+        }
+      else
+        print_digest_line (jobv[i].file, jobv[i].binary, jobv[i].digest,
+                           prefix_tag);
+    }
+
+  free (digests);
+  free (jobs);
+  free (jobv);
+  return ok;
+}
+
+/* The verification cache (--cache): one entry per file name, holding
+   the metadata and hex digest recorded when the file was last hashed.
+   A listed file whose size, mtime and ctime all still match its entry
+   is not rehashed; the cached digest stands in for the computed one.  */
+
+struct cache_entry
+{
+  char *file;
+  uintmax_t size;
+  struct timespec mtime;
+  struct timespec ctime;
+  char *hex;                    /* The digest, in lower case hex.  */
+};
+
+static Hash_table *cache_table;
+
+/* Whether the cache changed and must be written back.  */
+static bool cache_dirty;
+
+static size_t
+cache_entry_hash (void const *x, size_t table_size)
+{
+  struct cache_entry const *e = x;
+  size_t h = 0;
+
+  /* FNV-1a.  */
+  for (char const *p = e->file; *p; p++)
+    h = (h ^ to_uchar (*p)) * 16777619;
+
+  return h % table_size;
+}
+
+static bool
+cache_entry_compare (void const *x, void const *y)
+{
+  struct cache_entry const *a = x;
+  struct cache_entry const *b = y;
+  return STREQ (a->file, b->file);
+}
+
+static void
+cache_entry_free (void *x)
+{
+  struct cache_entry *e = x;
+  free (e->file);
+  free (e->hex);
+  free (e);
+}
+
+/* Record in the cache that FILE, with metadata SIZE, MTIME and CTIME,
+   hashed to HEX, taking ownership of HEX.  */
+
+static void
+cache_store (char const *file, uintmax_t size, struct timespec mtime,
+             struct timespec ctime, char *hex)
+{
+  struct cache_entry key;
+  key.file = (char *) file;
+  struct cache_entry *e = hash_lookup (cache_table, &key);
+
+  if (! e)
+    {
+      e = xmalloc (sizeof *e);
+      e->file = xstrdup (file);
+      e->hex = NULL;
+      if (hash_insert (cache_table, e) == NULL)
+        xalloc_die ();
+    }
+
+  e->size = size;
+  e->mtime = mtime;
+  e->ctime = ctime;
+  free (e->hex);
+  e->hex = hex;
+}
+
+/* Read the cache file into cache_table.  A missing cache file is an
+   empty cache, and lines that do not parse are ignored, so a stale or
+   corrupted cache merely forces rehashing.  */
+
+static void
+cache_load (void)
+{
+  cache_table = hash_initialize (61, NULL, cache_entry_hash,
+                                 cache_entry_compare, cache_entry_free);
+  if (! cache_table)
+    xalloc_die ();
+
+  FILE *fp = fopen (cache_file, "r");
+  if (! fp)
+    {
+      if (errno != ENOENT)
+        error (0, errno, "%s", quotef (cache_file));
+      return;
+    }
+
+  char *line = NULL;
+  size_t line_alloc = 0;
+  ssize_t line_length;
+
+  while (0 < (line_length = getline (&line, &line_alloc, fp)))
+    {
+      if (line[line_length - 1] == '\n')
+        line[--line_length] = '\0';
+
+      char *p = line;
+      bool escaped = *p == '\\';
+      p += escaped;
+
+      char *hex = p;
+      while (isxdigit (to_uchar (*p)))
+        p++;
+      if (p == hex || (p - hex) % 2 || *p != ' ')
+        continue;
+      *p++ = '\0';
+
+      uintmax_t size;
+      intmax_t mtime_sec, ctime_sec;
+      long int mtime_nsec, ctime_nsec;
+      int filepos;
+      if (sscanf (p, "%ju %jd.%9ld %jd.%9ld %n", &size,
+                  &mtime_sec, &mtime_nsec, &ctime_sec, &ctime_nsec,
+                  &filepos) != 5)
+        continue;
+
+      char *file = p + filepos;
+      if (! *file
+          || (escaped && ! filename_unescape (file, strlen (file))))
+        continue;
+
+      for (char *q = hex; *q; q++)
+        *q = tolower (to_uchar (*q));
+
+      struct timespec mtime = { mtime_sec, mtime_nsec };
+      struct timespec ctime = { ctime_sec, ctime_nsec };
+      cache_store (file, size, mtime, ctime, xstrdup (hex));
+    }
+
+  free (line);
+  if (ferror (fp))
+    error (0, 0, _("%s: read error"), quotef (cache_file));
+  fclose (fp);
+}
+
+/* If the cache has an entry for FILE whose metadata still matches ST
+   and whose digest is DIGEST_BIN_BYTES long, copy the digest into
+   DIGEST and return true.  */
+
+static bool
+cache_fresh_digest (char const *file, struct stat const *st,
+                    size_t digest_bin_bytes, unsigned char *digest)
+{
+  struct cache_entry key;
+  key.file = (char *) file;
+  struct cache_entry *e = hash_lookup (cache_table, &key);
+
+  if (! e
+      || e->size != (uintmax_t) st->st_size
+      || timespec_cmp (e->mtime, get_stat_mtime (st)) != 0
+      || timespec_cmp (e->ctime, get_stat_ctime (st)) != 0
+      || strlen (e->hex) != 2 * digest_bin_bytes)
+    return false;
+
+  for (size_t i = 0; i < digest_bin_bytes; i++)
+    {
+      char hi = e->hex[2 * i];
+      char lo = e->hex[2 * i + 1];
+      digest[i] = ((('0' <= hi && hi <= '9' ? hi - '0' : hi - 'a' + 10) << 4)
+                   | ('0' <= lo && lo <= '9' ? lo - '0' : lo - 'a' + 10));
+    }
+  return true;
+}
+
+/* Write the cache back to the cache file, one entry per line: the hex
+   digest, the size, mtime and ctime, and the file name, escaped as in
+   digest lines.  Return true if successful.  */
+
+static bool
+cache_save (void)
+{
+  FILE *fp = fopen (cache_file, "w");
+  if (! fp)
+    {
+      error (0, errno, "%s", quotef (cache_file));
       return false;
     }
 
+  for (struct cache_entry *e = hash_get_first (cache_table); e;
+       e = hash_get_next (cache_table, e))
+    {
+      bool needs_escape = strchr (e->file, '\\') || strchr (e->file, '\n');
+      if (needs_escape)
+        putc ('\\', fp);
+      fprintf (fp, "%s %ju %jd.%09ld %jd.%09ld ", e->hex, e->size,
+               (intmax_t) e->mtime.tv_sec, e->mtime.tv_nsec,
+               (intmax_t) e->ctime.tv_sec, e->ctime.tv_nsec);
+      for (char const *p = e->file; *p; p++)
+        switch (*p)
+          {
+          case '\n':
+            fputs ("\\n", fp);
+            break;
+          case '\\':
+            fputs ("\\\\", fp);
+            break;
+          default:
+            putc (*p, fp);
+            break;
+          }
+      putc ('\n', fp);
+    }
+
+  if (ferror (fp))
+    {
+      fclose (fp);
+      error (0, 0, _("%s: write error"), quotef (cache_file));
+      return false;
+    }
+  if (fclose (fp) != 0)
+    {
+      error (0, errno, "%s", quotef (cache_file));
+      return false;
+    }
   return true;
 }
 
+/* One parsed line of a checksum file, either misformatted or carrying
+   a hashing job, retained until its outcome is reported.  */
+
+struct check_entry
+{
+  char *line;                   /* Owned buffer, parsed in place.  */
+  size_t line_alloc;
+  uintmax_t line_number;
+  bool misformatted;
+  char *filename;
+  unsigned char *hex_digest;
+  size_t digest_bin_bytes;
+  bool cached;                  /* Digest taken from the cache.  */
+  bool have_stat;               /* ST below is valid (--cache).  */
+  struct stat st;
+  struct digest_job job;
+};
+
+/* How many checksum lines to read ahead and hash concurrently
+   with --threads.  */
+enum { CHECK_BATCH = 1024 };
+
 static bool
 digest_check (char const *checkfile_name)
 {
@@ -658,12 +1173,7 @@ digest_check (char const *checkfile_name)
   uintmax_t n_open_or_read_failures = 0;
   bool properly_formatted_lines = false;
   bool matched_checksums = false;
-  unsigned char bin_buffer_unaligned[DIGEST_BIN_BYTES + DIGEST_ALIGN];
-  /* Make sure bin_buffer is properly aligned. */
-  unsigned char *bin_buffer = ptr_align (bin_buffer_unaligned, DIGEST_ALIGN);
   uintmax_t line_number;
-  char *line;
-  size_t line_chars_allocated;
   bool is_stdin = STREQ (checkfile_name, "-");
 
   if (is_stdin)
@@ -682,67 +1192,129 @@ digest_check (char const *checkfile_name)
         }
     }
 
+  /* Lines are read ahead in batches so that with --threads the
+     listed files can be hashed concurrently; results are reported
+     in input order once each batch completes.  With one thread the
+     batch size is one and behavior matches the historical loop.  */
+  size_t batch = 1 < nthreads ? CHECK_BATCH : 1;
+  struct check_entry *entries = xcalloc (batch, sizeof *entries);
+  struct digest_job **jobs = xnmalloc (batch, sizeof *jobs);
+  unsigned char *digests = xnmalloc (batch, DIGEST_BIN_BYTES);
+  bool done = false;
+
   line_number = 0;
-  line = NULL;
-  line_chars_allocated = 0;
-  do
+  while (! done)
     {
-      char *filename IF_LINT ( = NULL);
-      int binary;
-      unsigned char *hex_digest IF_LINT ( = NULL);
-      ssize_t line_length;
-
-      ++line_number;
-      if (line_number == 0)
-        die (EXIT_FAILURE, 0, _("%s: too many checksum lines"),
-             quotef (checkfile_name));
-
-      line_length = getline (&line, &line_chars_allocated, checkfile_stream);
-      if (line_length <= 0)
-        break;
-
-      /* Ignore comment lines, which begin with a '#' character.  */
-      if (line[0] == '#')
-        continue;
-
-      /* Remove any trailing newline.  */
-      if (line[line_length - 1] == '\n')
-        line[--line_length] = '\0';
+      size_t n_entries = 0;
+      size_t n_jobs = 0;
 
-      if (! (split_3 (line, line_length, &hex_digest, &binary, &filename)
-             && ! (is_stdin && STREQ (filename, "-"))))
+      while (n_entries < batch
+             && !feof (checkfile_stream) && !ferror (checkfile_stream))
         {
-          ++n_misformatted_lines;
+          struct check_entry *e = &entries[n_entries];
+          ssize_t line_length;
 
-          if (warn)
+          ++line_number;
+          if (line_number == 0)
+            die (EXIT_FAILURE, 0, _("%s: too many checksum lines"),
+                 quotef (checkfile_name));
+
+          line_length = getline (&e->line, &e->line_alloc, checkfile_stream);
+          if (line_length <= 0)
             {
-              error (0, 0,
-                     _("%s: %" PRIuMAX
-                       ": improperly formatted %s checksum line"),
-                     quotef (checkfile_name), line_number,
-                     DIGEST_TYPE_STRING);
+              done = true;
+              break;
             }
 
-          ++n_improperly_formatted_lines;
+          /* Ignore comment lines, which begin with a '#' character.  */
+          if (e->line[0] == '#')
+            continue;
+
+          /* Remove any trailing newline.  */
+          if (e->line[line_length - 1] == '\n')
+            e->line[--line_length] = '\0';
+
+          e->line_number = line_number;
+          e->filename = NULL;
+          e->hex_digest = NULL;
+          e->misformatted =
+            ! (split_3 (e->line, line_length,
+                        &e->hex_digest, &e->job.binary, &e->filename)
+               && ! (is_stdin && STREQ (e->filename, "-")));
+
+          if (! e->misformatted)
+            {
+              e->digest_bin_bytes = digest_hex_bytes / 2;
+              e->job.file = e->filename;
+              e->job.digest = digests + n_entries * DIGEST_BIN_BYTES;
+              e->job.deferred = STREQ (e->filename, "-");
+#if HASH_ALGO_BLAKE2
+              e->job.b2_len = b2_length;
+#endif
+              e->cached = false;
+              e->have_stat = false;
+              if (cache_table && ! e->job.deferred)
+                {
+                  e->have_stat = stat (e->filename, &e->st) == 0;
+                  if (e->have_stat && ! rehash_all
+                      && cache_fresh_digest (e->filename, &e->st,
+                                             e->digest_bin_bytes,
+                                             e->job.digest))
+                    {
+                      e->cached = true;
+                      e->job.ok = true;
+                      e->job.missing = false;
+                      e->job.err = 0;
+                    }
+                }
+              if (! e->cached)
+                jobs[n_jobs++] = &e->job;
+            }
+          n_entries++;
         }
-      else
+
+      if (feof (checkfile_stream) || ferror (checkfile_stream))
+        done = true;
+
+      if (n_jobs)
+        digest_jobs (jobs, n_jobs);
+
+      for (size_t i = 0; i < n_entries; i++)
         {
+          struct check_entry *e = &entries[i];
+          char const *filename = e->filename;
+
+          if (e->misformatted)
+            {
+              ++n_misformatted_lines;
+
+              if (warn)
+                {
+                  error (0, 0,
+                         _("%s: %" PRIuMAX
+                           ": improperly formatted %s checksum line"),
+                         quotef (checkfile_name), e->line_number,
+                         DIGEST_TYPE_STRING);
+                }
+
+              ++n_improperly_formatted_lines;
+              continue;
+            }
+
           static const char bin2hex[] = { '0', '1', '2', '3',
                                           '4', '5', '6', '7',
                                           '8', '9', 'a', 'b',
                                           'c', 'd', 'e', 'f' };
-          bool ok;
-          bool missing;
+          unsigned char const *bin_buffer = e->job.digest;
           /* Only escape in the edge case producing multiple lines,
              to ease automatic processing of status output.  */
           bool needs_escape = ! status_only && strchr (filename, '\n');
 
           properly_formatted_lines = true;
 
-          ok = digest_file (filename, &binary, bin_buffer, &missing);
-
-          if (!ok)
+          if (! e->job.ok)
             {
+              error (0, e->job.err, "%s", quotef (filename));
               ++n_open_or_read_failures;
               if (!status_only)
                 {
@@ -752,23 +1324,38 @@ digest_check (char const *checkfile_name)
                   printf (": %s\n", _("FAILED open or read"));
                 }
             }
-          else if (ignore_missing && missing)
+          else if (ignore_missing && e->job.missing)
             {
               /* Ignore missing files with --ignore-missing.  */
               ;
             }
           else
             {
-              size_t digest_bin_bytes = digest_hex_bytes / 2;
+              size_t digest_bin_bytes = e->digest_bin_bytes;
               size_t cnt;
 
+              if (cache_table && e->have_stat && ! e->cached)
+                {
+                  char *hex = xmalloc (2 * digest_bin_bytes + 1);
+                  for (size_t k = 0; k < digest_bin_bytes; k++)
+                    {
+                      hex[2 * k] = bin2hex[bin_buffer[k] >> 4];
+                      hex[2 * k + 1] = bin2hex[bin_buffer[k] & 0xf];
+                    }
+                  hex[2 * digest_bin_bytes] = '\0';
+                  cache_store (e->filename, e->st.st_size,
+                               get_stat_mtime (&e->st),
+                               get_stat_ctime (&e->st), hex);
+                  cache_dirty = true;
+                }
+
               /* Compare generated binary number with text representation
                  in check file.  Ignore case of hex digits.  */
               for (cnt = 0; cnt < digest_bin_bytes; ++cnt)
                 {
-                  if (tolower (hex_digest[2 * cnt])
+                  if (tolower (e->hex_digest[2 * cnt])
                       != bin2hex[bin_buffer[cnt] >> 4]
-                      || (tolower (hex_digest[2 * cnt + 1])
+                      || (tolower (e->hex_digest[2 * cnt + 1])
                           != (bin2hex[bin_buffer[cnt] & 0xf])))
                     break;
                 }
@@ -794,9 +1381,12 @@ digest_check (char const *checkfile_name)
             }
         }
     }
-  while (!feof (checkfile_stream) && !ferror (checkfile_stream));
 
-  free (line);
+  for (size_t i = 0; i < batch; i++)
+    free (entries[i].line);
+  free (entries);
+  free (jobs);
+  free (digests);
 
   if (ferror (checkfile_stream))
     {
@@ -882,6 +1472,11 @@ main (int argc, char **argv)
      so that processes running in parallel do not intersperse their output.  */
   setvbuf (stdout, NULL, _IOLBF, 0);
 
+#if DIGEST_DISPATCH
+  if (sha_ni_supported ())
+    digest_stream = DIGEST_STREAM_NI;
+#endif
+
 #if HASH_ALGO_BLAKE2
   const char* short_opts = "l:bctwz";
   const char* b2_length_str = "";
@@ -923,9 +1518,15 @@ main (int argc, char **argv)
         warn = true;
         quiet = false;
         break;
+      case CACHE_OPTION:
+        cache_file = optarg;
+        break;
       case IGNORE_MISSING_OPTION:
         ignore_missing = true;
         break;
+      case REHASH_OPTION:
+        rehash_all = true;
+        break;
       case QUIET_OPTION:
         status_only = false;
         warn = false;
@@ -938,6 +1539,10 @@ main (int argc, char **argv)
         prefix_tag = true;
         binary = 1;
         break;
+      case THREADS_OPTION:
+        nthreads = xdectoumax (optarg, 1, SIZE_MAX, "",
+                               _("invalid number of threads"), 0);
+        break;
       case 'z':
         delim = '\0';
         break;
@@ -996,6 +1601,21 @@ main (int argc, char **argv)
       usage (EXIT_FAILURE);
     }
 
+  if (cache_file && !do_check)
+    {
+      error (0, 0,
+             _("the --cache option is meaningful only when "
+               "verifying checksums"));
+      usage (EXIT_FAILURE);
+    }
+
+  if (rehash_all && !cache_file)
+    {
+      error (0, 0,
+             _("the --rehash option is meaningful only with --cache"));
+      usage (EXIT_FAILURE);
+    }
+
   if (ignore_missing && !do_check)
     {
       error (0, 0,
@@ -1035,73 +1655,40 @@ main (int argc, char **argv)
   if (!O_BINARY && binary < 0)
     binary = 0;
 
+  if (cache_file)
+    cache_load ();
+
   char **operand_lim = argv + argc;
   if (optind == argc)
     *operand_lim++ = bad_cast ("-");
 
-  for (char **operandp = argv + optind; operandp < operand_lim; operandp++)
-    {
-      char *file = *operandp;
-
-      if (do_check)
-        ok &= digest_check (file);
-      else
-        {
-          int file_is_binary = binary;
-          bool missing;
+  size_t n_operands = operand_lim - (argv + optind);
 
-          if (! digest_file (file, &file_is_binary, bin_buffer, &missing))
-            ok = false;
-          else
-            {
-              /* We don't really need to escape, and hence detect, the '\\'
-                 char, and not doing so should be both forwards and backwards
-                 compatible, since only escaped lines would have a '\\' char at
-                 the start.  However just in case users are directly comparing
-                 against old (hashed) outputs, in the presence of files
-                 containing '\\' characters, we decided to not simplify the
-                 output in this case.  */
-              bool needs_escape = (strchr (file, '\\') || strchr (file, '\n'))
-                                  && delim == '\n';
-
-              if (prefix_tag)
-                {
-                  if (needs_escape)
-                    putchar ('\\');
-
-#if HASH_ALGO_BLAKE2
-                  fputs (algorithm_out_string[b2_algorithm], stdout);
-                  if (b2_length < blake2_max_len[b2_algorithm] * 8)
-                    printf ("-%"PRIuMAX, b2_length);
-#else
-                  fputs (DIGEST_TYPE_STRING, stdout);
-#endif
-                  fputs (" (", stdout);
-                  print_filename (file, needs_escape);
-                  fputs (") = ", stdout);
-                }
-
-              /* Output a leading backslash if the file name contains
-                 a newline or backslash.  */
-              if (!prefix_tag && needs_escape)
-                putchar ('\\');
-
-              for (size_t i = 0; i < (digest_hex_bytes / 2); ++i)
-                printf ("%02x", bin_buffer[i]);
-
-              if (!prefix_tag)
-                {
-                  putchar (' ');
-
-                  putchar (file_is_binary ? '*' : ' ');
+  if (! do_check && 1 < nthreads && 1 < n_operands)
+    ok = digest_operands_parallel (argv + optind, n_operands,
+                                   binary, prefix_tag);
+  else
+    for (char **operandp = argv + optind; operandp < operand_lim; operandp++)
+      {
+        char *file = *operandp;
 
-                  print_filename (file, needs_escape);
-                }
+        if (do_check)
+          ok &= digest_check (file);
+        else
+          {
+            int file_is_binary = binary;
+            bool missing;
+
+            if (! digest_file (file, &file_is_binary, bin_buffer, &missing))
+              ok = false;
+            else
+              print_digest_line (file, file_is_binary, bin_buffer,
+                                 prefix_tag);
+          }
+      }
 
-              putchar (delim);
-            }
-        }
-    }
+  if (cache_file && cache_dirty && ! cache_save ())
+    ok = false;
 
   if (have_read_stdin && fclose (stdin) == EOF)
     die (EXIT_FAILURE, errno, _("standard input"));
@@ -0,0 +1,208 @@
+/* meta-pool.c -- apply per-file metadata changes from worker threads
+   Copyright (C) 2021 Free Software Foundation, Inc.
+
+   This program is free software: you can redistribute it and/or modify
+   it under the terms of the GNU General Public License as published by
+   the Free Software Foundation, either version 3 of the License, or
+   (at your option) any later version.
+
+   This program is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU General Public License for more details.
+
+   You should have received a copy of the GNU General Public License
+   along with this program.  If not, see <https://www.gnu.org/licenses/>.  */
+
+#include <config.h>
+#include <pthread.h>
+#include <sys/types.h>
+
+#include "system.h"
+#include "die.h"
+#include "error.h"
+#include "meta-pool.h"
+
+struct meta_pool
+{
+  pthread_mutex_t lock;
+  pthread_cond_t work_avail;	/* Signaled when a job is queued.  */
+  pthread_cond_t job_done;	/* Signaled when a job completes.  */
+  struct meta_job *head;	/* Oldest job not yet reported.  */
+  struct meta_job **tail;	/* Where to append the next job.  */
+  struct meta_job *unclaimed;	/* Oldest job no worker has taken.  */
+  int dup_fd;			/* Our duplicate of the jobs' directory
+                                   descriptor, or -1.  */
+  bool stop;
+  meta_apply_fn apply;
+  meta_report_fn report;
+  void *tool_data;
+  pthread_t *threads;
+  size_t n_threads;
+};
+
+static void *
+meta_pool_thread (void *arg)
+{
+  struct meta_pool *pool = arg;
+
+  pthread_mutex_lock (&pool->lock);
+  while (true)
+    {
+      if (pool->unclaimed)
+        {
+          struct meta_job *job = pool->unclaimed;
+          pool->unclaimed = job->next;
+          pthread_mutex_unlock (&pool->lock);
+
+          pool->apply (job, pool->tool_data);
+
+          pthread_mutex_lock (&pool->lock);
+          job->done = true;
+          pthread_cond_signal (&pool->job_done);
+        }
+      else if (pool->stop)
+        break;
+      else
+        pthread_cond_wait (&pool->work_avail, &pool->lock);
+    }
+  pthread_mutex_unlock (&pool->lock);
+
+  return NULL;
+}
+
+/* Start a pool of N_THREADS workers running APPLY, reporting each
+   outcome via REPORT; TOOL_DATA is passed to both callbacks.  */
+
+extern struct meta_pool *
+meta_pool_start (size_t n_threads, meta_apply_fn apply,
+                 meta_report_fn report, void *tool_data)
+{
+  struct meta_pool *pool = xmalloc (sizeof *pool);
+
+  pthread_mutex_init (&pool->lock, NULL);
+  pthread_cond_init (&pool->work_avail, NULL);
+  pthread_cond_init (&pool->job_done, NULL);
+  pool->head = NULL;
+  pool->tail = &pool->head;
+  pool->unclaimed = NULL;
+  pool->dup_fd = -1;
+  pool->stop = false;
+  pool->apply = apply;
+  pool->report = report;
+  pool->tool_data = tool_data;
+  pool->n_threads = n_threads;
+  pool->threads = xnmalloc (n_threads, sizeof *pool->threads);
+
+  for (size_t i = 0; i < n_threads; i++)
+    {
+      int err = pthread_create (&pool->threads[i], NULL,
+                                meta_pool_thread, pool);
+      if (err)
+        die (EXIT_FAILURE, err, _("failed to create worker thread"));
+    }
+
+  return pool;
+}
+
+extern void
+meta_pool_submit (struct meta_pool *pool, int dir_fd,
+                  char const *file, char const *file_full_name,
+                  void const *data, size_t data_size)
+{
+  struct meta_job *job = xmalloc (sizeof *job);
+  job->next = NULL;
+  job->file = xstrdup (file);
+  job->file_full_name = xstrdup (file_full_name);
+  job->data = data_size ? xmemdup (data, data_size) : NULL;
+  job->err = 0;
+  job->done = false;
+
+  pthread_mutex_lock (&pool->lock);
+
+  /* Borrowing DIR_FD would not be safe: fts may close it as soon as
+     the walk leaves the current directory, which can happen before
+     the caller sees the directory boundary.  Keep our own duplicate
+     for the lifetime of the batch instead.  */
+  if (dir_fd == AT_FDCWD)
+    job->dir_fd = AT_FDCWD;
+  else
+    {
+      if (pool->dup_fd < 0)
+        {
+          pool->dup_fd = fcntl (dir_fd, F_DUPFD_CLOEXEC, STDERR_FILENO + 1);
+          if (pool->dup_fd < 0)
+            die (EXIT_FAILURE, errno,
+                 _("failed to duplicate directory descriptor"));
+        }
+      job->dir_fd = pool->dup_fd;
+    }
+
+  *pool->tail = job;
+  pool->tail = &job->next;
+  if (! pool->unclaimed)
+    pool->unclaimed = job;
+  pthread_cond_signal (&pool->work_avail);
+  pthread_mutex_unlock (&pool->lock);
+}
+
+/* Wait for all queued jobs, reporting each in submission order.
+   Return true if every reported job was successful.  */
+
+extern bool
+meta_pool_drain (struct meta_pool *pool)
+{
+  bool ok = true;
+
+  pthread_mutex_lock (&pool->lock);
+  while (pool->head)
+    {
+      struct meta_job *job = pool->head;
+      while (! job->done)
+        pthread_cond_wait (&pool->job_done, &pool->lock);
+      pool->head = job->next;
+      pthread_mutex_unlock (&pool->lock);
+
+      ok &= pool->report (job, pool->tool_data);
+      free (job->data);
+      free (job->file_full_name);
+      free (job->file);
+      free (job);
+
+      pthread_mutex_lock (&pool->lock);
+    }
+  pool->tail = &pool->head;
+  if (0 <= pool->dup_fd)
+    {
+      close (pool->dup_fd);
+      pool->dup_fd = -1;
+    }
+  pthread_mutex_unlock (&pool->lock);
+
+  return ok;
+}
+
+/* Drain the pool, then join the workers and free all resources.
+   Return the result of the final drain.  */
+
+extern bool
+meta_pool_finish (struct meta_pool *pool)
+{
+  bool ok = meta_pool_drain (pool);
+
+  pthread_mutex_lock (&pool->lock);
+  pool->stop = true;
+  pthread_cond_broadcast (&pool->work_avail);
+  pthread_mutex_unlock (&pool->lock);
+
+  for (size_t i = 0; i < pool->n_threads; i++)
+    pthread_join (pool->threads[i], NULL);
+
+  pthread_mutex_destroy (&pool->lock);
+  pthread_cond_destroy (&pool->work_avail);
+  pthread_cond_destroy (&pool->job_done);
+  free (pool->threads);
+  free (pool);
+
+  return ok;
+}
@@ -0,0 +1,64 @@
+/* meta-pool.h -- apply per-file metadata changes from worker threads
+   Copyright (C) 2021 Free Software Foundation, Inc.
+
+   This program is free software: you can redistribute it and/or modify
+   it under the terms of the GNU General Public License as published by
+   the Free Software Foundation, either version 3 of the License, or
+   (at your option) any later version.
+
+   This program is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU General Public License for more details.
+
+   You should have received a copy of the GNU General Public License
+   along with this program.  If not, see <https://www.gnu.org/licenses/>.  */
+
+#ifndef META_POOL_H
+# define META_POOL_H
+
+/* A pool of worker threads that issue per-file metadata system calls
+   (chmod, chown, setfilecon, ...) on behalf of a single fts walk.
+   The walk itself stays on the submitting thread, which also emits
+   every diagnostic, so the workers never touch stdio or the shared
+   quoting buffers.  */
+
+/* One queued change.  The pool owns FILE and FILE_FULL_NAME.  */
+struct meta_job
+{
+  struct meta_job *next;	/* Next job in submission order.  */
+  char *file;			/* Name relative to DIR_FD.  */
+  char *file_full_name;		/* Name to use in diagnostics.  */
+  void *data;			/* Tool-specific request and result.  */
+  int dir_fd;			/* Directory the change is relative to.  */
+  int err;			/* errno from a failed change, else 0.  */
+  bool done;
+};
+
+/* Apply JOB's change.  This runs on a worker thread, so it must not
+   produce any output; record the outcome in JOB->err and in the tool
+   data at JOB->data instead.  */
+typedef void (*meta_apply_fn) (struct meta_job *job, void *tool_data);
+
+/* Report JOB's outcome.  This runs on the submitting thread, in
+   submission order.  Return true if the change counts as successful.  */
+typedef bool (*meta_report_fn) (struct meta_job *job, void *tool_data);
+
+struct meta_pool;
+
+struct meta_pool *meta_pool_start (size_t n_threads, meta_apply_fn apply,
+                                   meta_report_fn report, void *tool_data);
+
+/* Queue a change to FILE, relative to DIR_FD, copying DATA_SIZE bytes
+   of tool data from DATA.  All jobs submitted between two drains must
+   be relative to the same directory: the pool duplicates that
+   directory's descriptor, so the caller may invalidate DIR_FD once a
+   directory boundary forces a drain.  */
+void meta_pool_submit (struct meta_pool *pool, int dir_fd,
+                       char const *file, char const *file_full_name,
+                       void const *data, size_t data_size);
+
+bool meta_pool_drain (struct meta_pool *pool);
+bool meta_pool_finish (struct meta_pool *pool);
+
+#endif /* META_POOL_H */
@@ -19,6 +19,7 @@
 #include <config.h>
 #include <stdio.h>
 #include <getopt.h>
+#include <pthread.h>
 #include <sys/types.h>
 #include <selinux/label.h>
 
@@ -32,17 +33,29 @@
 #include "savewd.h"
 #include "selinux.h"
 #include "smack.h"
+#include "xdectoint.h"
 
 /* The official name of this program (e.g., no 'g' prefix).  */
 #define PROGRAM_NAME "mkdir"
 
 #define AUTHORS proper_name ("David MacKenzie")
 
+/* For long options that have no equivalent short option, use a
+   non-character as a pseudo short option, starting with CHAR_MAX + 1.  */
+enum
+{
+  THREADS_OPTION = CHAR_MAX + 1
+};
+
+/* Number of directory operands to create concurrently.  */
+static size_t nthreads = 1;
+
 static struct option const longopts[] =
 {
   {GETOPT_SELINUX_CONTEXT_OPTION_DECL},
   {"mode", required_argument, NULL, 'm'},
   {"parents", no_argument, NULL, 'p'},
+  {"threads", required_argument, NULL, THREADS_OPTION},
   {"verbose", no_argument, NULL, 'v'},
   {GETOPT_HELP_OPTION_DECL},
   {GETOPT_VERSION_OPTION_DECL},
@@ -67,6 +80,7 @@ Create the DIRECTORY(ies), if they do not already exist.\n\
   -m, --mode=MODE   set file mode (as in chmod), not a=rwx - umask\n\
   -p, --parents     no error if existing, make parent directories as needed,\n\
                     with their file modes unaffected by any -m option.\n\
+      --threads=N   create up to N DIRECTORY operands concurrently\n\
   -v, --verbose     print a message for each created directory\n\
 "), stdout);
       fputs (_("\
@@ -189,6 +203,174 @@ process_dir (char *dir, struct savewd *wd, void *options)
   return ret;
 }
 
+/*
+ * The --threads engine creates independent directory operands from a
+ * small pool of worker threads, for provisioning runs whose cost is
+ * pure mkdir latency, as on network file systems.  It cannot use the
+ * savewd machinery of the serial path: the working directory and the
+ * umask are process-wide state.  Instead each worker walks its
+ * operand's ancestors in place with full paths, and the umask is
+ * cleared before the workers start so the modes they pass to mkdir
+ * are already masked.  Operands needing per-directory security
+ * contexts or mode bits that mkdir cannot set stay on the serial
+ * path.
+ */
+
+/* A directory operand claimed by one of the worker threads.  */
+struct mkdir_job
+{
+  char *dir;
+  bool ok;
+};
+
+struct mkdir_pool
+{
+  struct mkdir_job *jobs;
+  size_t n_jobs;
+  size_t next_job;		/* First job not yet claimed */
+  struct mkdir_options const *o;
+  mode_t mode_self;		/* Mode for operands, umask applied */
+  mode_t mode_ancestor;		/* Mode for ancestors, umask applied */
+  pthread_mutex_t lock;		/* Claims the next job */
+  pthread_mutex_t output_lock;	/* Serializes quoting and messages */
+};
+
+/* Report that directory DIR was made, if requested.  */
+static void
+pool_announce_mkdir (struct mkdir_pool *pool, char const *dir)
+{
+  if (pool->o->created_directory_format)
+    {
+      pthread_mutex_lock (&pool->output_lock);
+      prog_fprintf (stdout, pool->o->created_directory_format, quoteaf (dir));
+      pthread_mutex_unlock (&pool->output_lock);
+    }
+}
+
+/* Report failure to make directory DIR for reason ERRNUM.  */
+static void
+pool_mkdir_error (struct mkdir_pool *pool, int errnum, char const *dir)
+{
+  pthread_mutex_lock (&pool->output_lock);
+  error (0, errnum, _("cannot create directory %s"), quoteaf (dir));
+  pthread_mutex_unlock (&pool->output_lock);
+}
+
+/* Create DIR and any missing ancestors, like 'mkdir -p', without
+   changing the working directory.  Ancestor prefixes are carved out
+   of DIR in place, which is writable operand storage owned by this
+   job.  Return true on success.  */
+static bool
+pool_make_dir_parents (struct mkdir_pool *pool, char *dir)
+{
+  char *p = dir + FILE_SYSTEM_PREFIX_LEN (dir);
+  while (ISSLASH (*p))
+    p++;
+
+  for (char *slash; (slash = strchr (p, '/')); )
+    {
+      char *rest = slash;
+      while (ISSLASH (*rest))
+        rest++;
+      if (! *rest)
+        break;			/* Only trailing slashes remain.  */
+      *slash = '\0';
+      if (mkdir (dir, pool->mode_ancestor) == 0)
+        pool_announce_mkdir (pool, dir);
+      *slash = '/';
+      p = rest;
+    }
+
+  if (mkdir (dir, pool->mode_self) == 0)
+    {
+      pool_announce_mkdir (pool, dir);
+      return true;
+    }
+
+  /* An existing directory is fine with --parents.  */
+  int mkdir_errno = errno;
+  struct stat st;
+  if (mkdir_errno == EEXIST && stat (dir, &st) == 0 && S_ISDIR (st.st_mode))
+    return true;
+  pool_mkdir_error (pool, mkdir_errno, dir);
+  return false;
+}
+
+static void *
+mkdir_pool_thread (void *arg)
+{
+  struct mkdir_pool *pool = arg;
+
+  while (true)
+    {
+      pthread_mutex_lock (&pool->lock);
+      size_t i = pool->next_job++;
+      pthread_mutex_unlock (&pool->lock);
+      if (pool->n_jobs <= i)
+        break;
+
+      struct mkdir_job *job = &pool->jobs[i];
+      if (pool->o->make_ancestor_function)
+        job->ok = pool_make_dir_parents (pool, job->dir);
+      else if (mkdir (job->dir, pool->mode_self) == 0)
+        {
+          pool_announce_mkdir (pool, job->dir);
+          job->ok = true;
+        }
+      else
+        pool_mkdir_error (pool, errno, job->dir);
+    }
+  return NULL;
+}
+
+/* Create the N_DIRS operands DIR, up to nthreads of them
+   concurrently, with options O.  Return the exit status.  */
+static int
+mkdirs_parallel (int n_dirs, char **dir, struct mkdir_options const *o)
+{
+  struct mkdir_pool pool;
+  int status = EXIT_SUCCESS;
+
+  pool.jobs = xnmalloc (n_dirs, sizeof *pool.jobs);
+  pool.n_jobs = n_dirs;
+  pool.next_job = 0;
+  pool.o = o;
+  pthread_mutex_init (&pool.lock, NULL);
+  pthread_mutex_init (&pool.output_lock, NULL);
+
+  /* Clear the umask so the workers need not touch process-wide
+     state; the modes below have it already applied.  */
+  mode_t umask_value = umask (0);
+  pool.mode_self = o->mode & ~umask_value;
+  pool.mode_ancestor = (o->make_ancestor_function
+                        ? S_IRWXUGO & ~o->umask_ancestor
+                        : 0);
+
+  for (int i = 0; i < n_dirs; i++)
+    {
+      pool.jobs[i].dir = dir[i];
+      pool.jobs[i].ok = false;
+    }
+
+  size_t n_workers = MIN (nthreads, (size_t) n_dirs);
+  pthread_t *threads = xnmalloc (n_workers, sizeof *threads);
+  for (size_t t = 0; t < n_workers; t++)
+    {
+      int err = pthread_create (&threads[t], NULL, mkdir_pool_thread, &pool);
+      if (err)
+        die (EXIT_FAILURE, err, _("failed to create directory thread"));
+    }
+  for (size_t t = 0; t < n_workers; t++)
+    pthread_join (threads[t], NULL);
+
+  for (int i = 0; i < n_dirs; i++)
+    if (! pool.jobs[i].ok)
+      status = EXIT_FAILURE;
+  free (threads);
+  free (pool.jobs);
+  return status;
+}
+
 int
 main (int argc, char **argv)
 {
@@ -221,6 +403,10 @@ main (int argc, char **argv)
         case 'm':
           specified_mode = optarg;
           break;
+        case THREADS_OPTION:
+          nthreads = xdectoumax (optarg, 1, SIZE_MAX, "",
+                                 _("invalid number of threads"), 0);
+          break;
         case 'v': /* --verbose  */
           options.created_directory_format = _("created directory %s");
           break;
@@ -305,6 +491,14 @@ main (int argc, char **argv)
       umask (options.umask_self);
     }
 
+  /* Security contexts are process-wide or need the serial ancestor
+     walk, and mode bits that mkdir cannot set need the chmod logic
+     of make_dir_parents; those stay on the serial path.  */
+  if (1 < nthreads && 1 < argc - optind
+      && ! options.set_security_context && ! scontext
+      && ! options.mode_bits && ! (options.mode & ~S_IRWXUGO))
+    return mkdirs_parallel (argc - optind, argv + optind, &options);
+
   return savewd_process_files (argc - optind, argv + optind,
                                process_dir, &options);
 }
@@ -27,7 +27,9 @@
 #include "error.h"
 #include "filenamecat.h"
 #include "quote.h"
+#include "randread.h"
 #include "tempname.h"
+#include "xdectoint.h"
 
 /* The official name of this program (e.g., no 'g' prefix).  */
 #define PROGRAM_NAME "mktemp"
@@ -47,6 +49,7 @@ enum
 
 static struct option const longopts[] =
 {
+  {"count", required_argument, NULL, 'n'},
   {"directory", no_argument, NULL, 'd'},
   {"quiet", no_argument, NULL, 'q'},
   {"dry-run", no_argument, NULL, 'u'},
@@ -76,6 +79,8 @@ Files are created u+rw, and directories u+rwx, minus umask restrictions.\n\
       fputs ("\n", stdout);
       fputs (_("\
   -d, --directory     create a directory, not a file\n\
+  -n, --count=COUNT   create COUNT files or directories in one run, printing\n\
+                        each resulting name followed by a NUL byte\n\
   -u, --dry-run       do not create anything; merely print a name (unsafe)\n\
   -q, --quiet         suppress diagnostics about file/dir-creation failure\n\
 "), stdout);
@@ -126,6 +131,129 @@ mkdtemp_len (char *tmpl, size_t suff_len, size_t x_len, bool dry_run)
                            x_len);
 }
 
+/* The characters gen_tempname substitutes for the X's.  */
+static char const template_chars[] =
+  "ABCDEFGHIJKLMNOPQRSTUVWXYZabcdefghijklmnopqrstuvwxyz0123456789";
+
+/* Buffered random bytes for batch mode, so each name costs a few
+   bytes of pooled entropy rather than its own system call.  */
+static struct randread_source *batch_rand;
+
+static unsigned char
+batch_random_byte (void)
+{
+  static unsigned char pool[4096];
+  static size_t used = sizeof pool;
+
+  if (used == sizeof pool)
+    {
+      randread (batch_rand, pool, sizeof pool);
+      used = 0;
+    }
+  return pool[used++];
+}
+
+/* Create COUNT names from TEMPLATE (in which the X_COUNT X's precede
+   the SUFFIX_LEN-byte suffix of the final component), printing each
+   resulting name followed by a NUL byte.  The containing directory is
+   opened once and each name is created relative to it, so a deep
+   template prefix is walked a single time rather than per name.
+   Return the exit status.  */
+
+static int
+batch_mktemp (char *template, size_t suffix_len, size_t x_count,
+              uintmax_t count, bool create_directory, bool dry_run,
+              bool suppress_file_err)
+{
+  enum { ALPHABET = sizeof template_chars - 1 };
+  /* Reject the few byte values past the last whole multiple of the
+     alphabet size, so every character is equally likely.  */
+  enum { REJECT_BOUND = (UCHAR_MAX + 1) - (UCHAR_MAX + 1) % ALPHABET };
+  /* As many new names as gen_tempname would try before giving up.  */
+  enum { MAX_ATTEMPTS = ALPHABET * ALPHABET * ALPHABET };
+
+  char *base = last_component (template);
+  int dfd = AT_FDCWD;
+
+  if (base != template)
+    {
+      char *dir = dir_name (template);
+      dfd = open (dir, O_RDONLY | O_DIRECTORY | O_CLOEXEC);
+      if (dfd < 0)
+        die (EXIT_FAILURE, errno, _("failed to open directory %s"),
+             quote (dir));
+      free (dir);
+    }
+
+  batch_rand = randread_new (NULL, x_count * MIN (count, 1024));
+  if (! batch_rand)
+    die (EXIT_FAILURE, errno, _("failed to initialize random source"));
+
+  char *xs = base + strlen (base) - suffix_len - x_count;
+
+  for (uintmax_t i = 0; i < count; i++)
+    {
+      unsigned int attempts = 0;
+
+      while (true)
+        {
+          for (size_t j = 0; j < x_count; j++)
+            {
+              unsigned char b;
+              do
+                b = batch_random_byte ();
+              while (REJECT_BOUND <= b);
+              xs[j] = template_chars[b % ALPHABET];
+            }
+
+          if (dry_run)
+            break;
+
+          if (create_directory)
+            {
+              if (mkdirat (dfd, base, S_IRWXU) == 0)
+                break;
+            }
+          else
+            {
+              int fd = openat (dfd, base, O_CREAT | O_EXCL | O_WRONLY,
+                               S_IRUSR | S_IWUSR);
+              if (0 <= fd)
+                {
+                  if (close (fd) != 0)
+                    {
+                      if (!suppress_file_err)
+                        error (0, errno,
+                               _("failed to create file via template %s"),
+                               quote (template));
+                      return EXIT_FAILURE;
+                    }
+                  break;
+                }
+            }
+
+          /* Only a name collision warrants another attempt.  */
+          if (errno != EEXIST || MAX_ATTEMPTS <= ++attempts)
+            {
+              if (!suppress_file_err)
+                error (0, errno,
+                       create_directory
+                       ? _("failed to create directory via template %s")
+                       : _("failed to create file via template %s"),
+                       quote (template));
+              return EXIT_FAILURE;
+            }
+        }
+
+      fputs (template, stdout);
+      putchar ('\0');
+    }
+
+  if (dfd != AT_FDCWD)
+    close (dfd);
+  return EXIT_SUCCESS;
+}
+
 /* True if we have already closed standard output.  */
 static bool stdout_closed;
 
@@ -156,6 +284,7 @@ main (int argc, char **argv)
   bool deprecated_t_option = false;
   bool create_directory = false;
   bool dry_run = false;
+  uintmax_t batch_count = 0;
   int status = EXIT_SUCCESS;
   size_t x_count;
   size_t suffix_len;
@@ -169,13 +298,17 @@ main (int argc, char **argv)
 
   atexit (maybe_close_stdout);
 
-  while ((c = getopt_long (argc, argv, "dp:qtuV", longopts, NULL)) != -1)
+  while ((c = getopt_long (argc, argv, "dn:p:qtuV", longopts, NULL)) != -1)
     {
       switch (c)
         {
         case 'd':
           create_directory = true;
           break;
+        case 'n':
+          batch_count = xdectoumax (optarg, 1, UINTMAX_MAX, "",
+                                    _("invalid count"), 0);
+          break;
         case 'p':
           dest_dir_arg = optarg;
           use_dest_dir = true;
@@ -299,6 +432,23 @@ main (int argc, char **argv)
       /* Note that suffix is now invalid.  */
     }
 
+  if (batch_count)
+    {
+      status = batch_mktemp (template, suffix_len, x_count, batch_count,
+                             create_directory, dry_run, suppress_file_err);
+      if (status == EXIT_SUCCESS
+          && ((stdout_closed = true), close_stream (stdout) != 0))
+        {
+          if (!suppress_file_err)
+            error (0, errno, _("write error"));
+          status = EXIT_FAILURE;
+        }
+#ifdef lint
+      free (template);
+#endif
+      return status;
+    }
+
   /* Make a copy to be used in case of diagnostic, since failing
      mkstemp may leave the buffer in an undefined state.  */
   dest_name = xstrdup (template);
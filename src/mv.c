@@ -34,6 +34,8 @@
 #include "renameatu.h"
 #include "root-dev-ino.h"
 #include "priv-set.h"
+#include "nproc.h"
+#include "xdectoint.h"
 
 /* The official name of this program (e.g., no 'g' prefix).  */
 #define PROGRAM_NAME "mv"
@@ -47,7 +49,8 @@
    non-character as a pseudo short option, starting with CHAR_MAX + 1.  */
 enum
 {
-  STRIP_TRAILING_SLASHES_OPTION = CHAR_MAX + 1
+  PARALLEL_OPTION = CHAR_MAX + 1,
+  STRIP_TRAILING_SLASHES_OPTION
 };
 
 /* Remove any trailing slashes from each SOURCE argument.  */
@@ -61,6 +64,7 @@ static struct option const long_options[] =
   {"interactive", no_argument, NULL, 'i'},
   {"no-clobber", no_argument, NULL, 'n'},
   {"no-target-directory", no_argument, NULL, 'T'},
+  {"parallel", optional_argument, NULL, PARALLEL_OPTION},
   {"strip-trailing-slashes", no_argument, NULL, STRIP_TRAILING_SLASHES_OPTION},
   {"suffix", required_argument, NULL, 'S'},
   {"target-directory", required_argument, NULL, 't'},
@@ -75,6 +79,7 @@ static void
 rm_option_init (struct rm_options *x)
 {
   x->ignore_missing_files = false;
+  x->inode_sort = false;
   x->remove_empty_directories = true;
   x->recursive = true;
   x->one_file_system = false;
@@ -85,6 +90,7 @@ rm_option_init (struct rm_options *x)
   x->stdin_tty = false;
 
   x->verbose = false;
+  x->nthreads = 1;
 
   /* Since this program may well have to process additional command
      line arguments after any call to 'rm', that function must preserve
@@ -311,6 +317,10 @@ Rename SOURCE to DEST, or move SOURCE(s) to DIRECTORY.\n\
 If you specify more than one of -i, -f, -n, only the final one takes effect.\n\
 "), stdout);
       fputs (_("\
+      --parallel[=N]           when moving between file systems, copy and\n\
+                                 unlink the regular files within each\n\
+                                 directory with up to N threads\n\
+                                 (default: number of processors)\n\
       --strip-trailing-slashes  remove any trailing slashes from each SOURCE\n\
                                  argument\n\
   -S, --suffix=SUFFIX          override the usual backup suffix\n\
@@ -380,6 +390,13 @@ main (int argc, char **argv)
         case 'n':
           x.interactive = I_ALWAYS_NO;
           break;
+        case PARALLEL_OPTION:
+          if (optarg)
+            x.nthreads = xdectoumax (optarg, 1, SIZE_MAX, "",
+                                     _("invalid number of threads"), 0);
+          else
+            x.nthreads = num_processors (NPROC_CURRENT_OVERRIDABLE);
+          break;
         case STRIP_TRAILING_SLASHES_OPTION:
           remove_trailing_slashes = true;
           break;
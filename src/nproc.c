@@ -32,6 +32,130 @@
 
 #define AUTHORS proper_name ("Giuseppe Scrivano")
 
+/* Mount point of the cgroup v2 unified hierarchy.  */
+#define CGROUP_ROOT "/sys/fs/cgroup"
+
+/* Read the contents of FILE into BUF, of size BUFSIZE, and
+   NUL-terminate it.  Return true if anything was read.  */
+
+static bool
+read_small_file (char const *file, char *buf, size_t bufsize)
+{
+  int fd = open (file, O_RDONLY);
+  if (fd < 0)
+    return false;
+  ssize_t n = read (fd, buf, bufsize - 1);
+  close (fd);
+  if (n <= 0)
+    return false;
+  buf[n] = '\0';
+  return true;
+}
+
+/* Return the number of CPUs in a cpuset list like "0-3,8,10-11",
+   or ULONG_MAX if the list cannot be parsed.  */
+
+static unsigned long
+count_cpuset_list (char const *s)
+{
+  unsigned long count = 0;
+
+  while (*s && *s != '\n')
+    {
+      char *end;
+      unsigned long lo = strtoul (s, &end, 10);
+      if (end == s)
+        return ULONG_MAX;
+      unsigned long hi = lo;
+      if (*end == '-')
+        {
+          s = end + 1;
+          hi = strtoul (s, &end, 10);
+          if (end == s || hi < lo)
+            return ULONG_MAX;
+        }
+      count += hi - lo + 1;
+      if (*end != ',')
+        break;
+      s = end + 1;
+    }
+
+  return count ? count : ULONG_MAX;
+}
+
+/* Return the number of CPUs this process may use according to the
+   cgroup v2 limits it runs under, rounding fractional CPU bandwidth
+   up, or ULONG_MAX if no limit applies or none can be determined.
+   Containers commonly leave the affinity mask covering every host
+   CPU while capping usage through cpu.max or a cpuset, and sizing
+   worker pools from the mask alone oversubscribes the cap.  */
+
+static unsigned long
+cgroup_cpu_limit (void)
+{
+  char buf[8192];
+  char cg[PATH_MAX];
+  unsigned long limit = ULONG_MAX;
+
+  if (! read_small_file ("/proc/self/cgroup", buf, sizeof buf))
+    return ULONG_MAX;
+
+  /* Find the v2 entry, "0::/path".  */
+  char *path = NULL;
+  for (char *line = buf; line; )
+    {
+      if (strncmp (line, "0::", 3) == 0)
+        {
+          path = line + 3;
+          break;
+        }
+      line = strchr (line, '\n');
+      if (line)
+        line++;
+    }
+  if (! path)
+    return ULONG_MAX;
+  size_t path_len = strcspn (path, "\n");
+  if (sizeof cg <= path_len)
+    return ULONG_MAX;
+  memcpy (cg, path, path_len);
+  cg[path_len] = '\0';
+
+  /* The effective limit is the tightest over our cgroup and all its
+     ancestors; controllers need not be enabled at every level.  */
+  for (;;)
+    {
+      char file[sizeof cg + sizeof CGROUP_ROOT + sizeof "/cpuset.cpus.effective"];
+
+      snprintf (file, sizeof file, "%s%s/cpu.max", CGROUP_ROOT, cg);
+      if (read_small_file (file, buf, sizeof buf)
+          && strncmp (buf, "max", 3) != 0)
+        {
+          char *end;
+          unsigned long quota = strtoul (buf, &end, 10);
+          unsigned long period = strtoul (end, NULL, 10);
+          if (end != buf && period)
+            {
+              unsigned long l = (quota + period - 1) / period;
+              limit = MIN (limit, MAX (l, 1));
+            }
+        }
+
+      snprintf (file, sizeof file, "%s%s/cpuset.cpus.effective", CGROUP_ROOT, cg);
+      if (read_small_file (file, buf, sizeof buf))
+        limit = MIN (limit, count_cpuset_list (buf));
+
+      char *slash = strrchr (cg, '/');
+      if (! slash)
+        break;
+      *slash = '\0';          /* Ends at "" for the root directory.  */
+      if (! cg[0] && ! slash[1])
+        break;
+    }
+
+  return limit;
+}
+
 enum
 {
   ALL_OPTION = CHAR_MAX + 1,
@@ -118,6 +242,19 @@ main (int argc, char **argv)
 
   nproc = num_processors (mode);
 
+  /* num_processors reports the affinity mask, which in a container
+     often covers every host CPU regardless of the cgroup limits
+     actually granted; clamp to those.  Explicit OMP_NUM_THREADS or
+     OMP_THREAD_LIMIT overrides have already been applied above and
+     are respected as given.  */
+  if (mode != NPROC_ALL
+      && ! getenv ("OMP_NUM_THREADS") && ! getenv ("OMP_THREAD_LIMIT"))
+    {
+      unsigned long limit = cgroup_cpu_limit ();
+      if (limit < nproc)
+        nproc = limit;
+    }
+
   if (ignore < nproc)
     nproc -= ignore;
   else
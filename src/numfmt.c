@@ -212,6 +212,31 @@ static int decimal_point_length;
 /* debugging for developers.  Enables devmsg().  */
 static bool dev_debug = false;
 
+/* Formatting decisions which depend only on the options, compiled once
+   by compile_format_program() and used for every value.  */
+static struct
+{
+  /* printf formats for double_to_human(): '%', optional grouping and
+     zero padding, then ".*Lf" without or with a scale suffix.  */
+  char unscaled_fmt[64];
+  char scaled_fmt[64];
+
+  /* True when integral values can be scaled and printed with integer
+     arithmetic alone: scaling to a power of 1024, with the default
+     precision and no grouping, zero padding or debug output.  */
+  bool integer_scale;
+} format_prog;
+
+/* True when the locale's blank characters are exactly space and tab,
+   so that field_sep() matches precisely the bytes in " \t\n".
+   Set by compile_field_program().  */
+static bool simple_blanks;
+
+/* The highest field number selected with --field, or UINTMAX_MAX for an
+   open-ended range.  Fields beyond it are copied through unconverted.
+   Set by compile_field_program().  */
+static uintmax_t max_field;
+
 
 static inline int
 default_scale_base (enum scale_type scale)
@@ -716,6 +741,92 @@ simple_strtod_fatal (enum simple_strtod_error err, char const *input_str)
     error (conv_exit_code, 0, gettext (msgid), quote (input_str));
 }
 
+/* Write the decimal digits of N at P; return the position past them.  */
+static char *
+emit_digits (char *p, uintmax_t n)
+{
+  return dectostr (p, n);
+}
+
+/* Bound on the values integer_to_human handles: below it the scaled
+   numerator N * 10 cannot overflow, and the long double arithmetic
+   being replaced is exact, so both produce the same digits.  */
+#define MAX_INTEGER_TO_HUMAN ((uintmax_t) 1 << 60)
+
+/* Format the integral value N into BUF as double_to_human would, with
+   integer arithmetic only.  The powers of 1024 divide exactly, so the
+   quotient and its rounding match the long double computation digit
+   for digit.  Only used when format_prog.integer_scale is set.  */
+static void
+integer_to_human (uintmax_t n, char *buf, enum scale_type scale,
+                  enum round_type round)
+{
+  unsigned int power = 0;
+  uintmax_t div = 1;
+  char *p = buf;
+
+  while (n / div >= 1024)
+    {
+      div *= 1024;
+      power++;
+    }
+
+  if (power == 0)
+    p = emit_digits (p, n);
+  else
+    {
+      /* Round N / DIV, in tenths while a decimal digit may be shown.  */
+      bool tenths = n < 10 * div;
+      uintmax_t num = tenths ? n * 10 : n;
+      uintmax_t q;
+
+      switch (round)
+        {
+        case round_ceiling:
+        case round_from_zero:
+          q = num / div + (num % div != 0);
+          break;
+
+        case round_floor:
+        case round_to_zero:
+          q = num / div;
+          break;
+
+        case round_nearest:
+        default:
+          q = (num + div / 2) / div;
+          break;
+        }
+
+      if (tenths && q < 100)
+        {
+          p = emit_digits (p, q / 10);
+          p = stpcpy (p, decimal_point);
+          *p++ = '0' + q % 10;
+        }
+      else
+        {
+          uintmax_t whole = tenths ? q / 10 : q;
+          if (whole >= 1024)
+            {
+              /* A "1023.x" was rounded up to the next power.  */
+              power++;
+              *p++ = '1';
+              p = stpcpy (p, decimal_point);
+              *p++ = '0';
+            }
+          else
+            p = emit_digits (p, whole);
+        }
+
+      p = stpcpy (p, suffix_power_char (power));
+      if (scale == scale_IEC_I)
+        *p++ = 'i';
+    }
+
+  *p = '\0';
+}
+
 /* Convert VAL to a human format string in BUF.  */
 static void
 double_to_human (long double val, int precision,
@@ -723,19 +834,14 @@ double_to_human (long double val, int precision,
                  enum scale_type scale, int group, enum round_type round)
 {
   int num_size;
-  char fmt[64];
-  verify (sizeof (fmt) > (INT_BUFSIZE_BOUND (zero_padding_width)
-                          + INT_BUFSIZE_BOUND (precision)
-                          + 10 /* for %.Lf  etc.  */));
-
-  char *pfmt = fmt;
-  *pfmt++ = '%';
-
-  if (group)
-    *pfmt++ = '\'';
 
-  if (zero_padding_width)
-    pfmt += snprintf (pfmt, sizeof (fmt) - 2, "0%ld", zero_padding_width);
+  if (format_prog.integer_scale
+      && 0 <= val && val < MAX_INTEGER_TO_HUMAN
+      && val == (long double) (uintmax_t) val)
+    {
+      integer_to_human (val, buf, scale, round);
+      return;
+    }
 
   devmsg ("double_to_human:\n");
 
@@ -749,9 +855,8 @@ double_to_human (long double val, int precision,
               "  no scaling, returning (grouped) value: %'.*Lf\n" :
               "  no scaling, returning value: %.*Lf\n", precision, val);
 
-      stpcpy (pfmt, ".*Lf");
-
-      num_size = snprintf (buf, buf_size, fmt, precision, val);
+      num_size = snprintf (buf, buf_size, format_prog.unscaled_fmt,
+                           precision, val);
       if (num_size < 0 || num_size >= (int) buf_size)
         die (EXIT_FAILURE, 0,
              _("failed to prepare value '%Lf' for printing"), val);
@@ -797,12 +902,10 @@ double_to_human (long double val, int precision,
 
   devmsg ("  after rounding, value=%Lf * %0.f ^ %u\n", val, scale_base, power);
 
-  stpcpy (pfmt, ".*Lf%s");
-
   int prec = user_precision == -1 ? show_decimal_point : user_precision;
 
   /* buf_size - 1 used here to ensure place for possible scale_IEC_I suffix.  */
-  num_size = snprintf (buf, buf_size - 1, fmt, prec, val,
+  num_size = snprintf (buf, buf_size - 1, format_prog.scaled_fmt, prec, val,
                        suffix_power_char (power));
   if (num_size < 0 || num_size >= (int) buf_size - 1)
     die (EXIT_FAILURE, 0,
@@ -1155,6 +1258,53 @@ parse_format_string (char const *fmt)
           quote_n (2, format_str_suffix ? format_str_suffix : ""));
 }
 
+/* Compile the formatting decisions which depend only on the options,
+   once they are all known, into format_prog.  */
+static void
+compile_format_program (void)
+{
+  verify (sizeof format_prog.scaled_fmt
+          > INT_BUFSIZE_BOUND (zero_padding_width) + 10 /* for %.Lf etc. */);
+
+  for (int scaled = 0; scaled < 2; scaled++)
+    {
+      char *pfmt = scaled ? format_prog.scaled_fmt : format_prog.unscaled_fmt;
+      *pfmt++ = '%';
+
+      if (grouping)
+        *pfmt++ = '\'';
+
+      if (zero_padding_width)
+        pfmt += snprintf (pfmt, sizeof format_prog.scaled_fmt - 2,
+                          "0%ld", zero_padding_width);
+
+      stpcpy (pfmt, scaled ? ".*Lf%s" : ".*Lf");
+    }
+
+  format_prog.integer_scale =
+    ((scale_to == scale_IEC || scale_to == scale_IEC_I)
+     && user_precision == -1 && !grouping && !zero_padding_width
+     && !dev_debug);
+}
+
+/* Compile the field selection decisions which depend only on the
+   options and the locale, so next_field() and process_line() can scan
+   lines with libc primitives instead of byte-at-a-time loops.  */
+static void
+compile_field_program (void)
+{
+  simple_blanks = true;
+  for (int i = 0; i <= UCHAR_MAX; i++)
+    if (!!isblank (i) != (i == ' ' || i == '\t'))
+      simple_blanks = false;
+
+  if (!frp)
+    max_field = 1;
+  else
+    for (struct field_range_pair *p = frp; p->lo != UINTMAX_MAX; p++)
+      max_field = MAX (max_field, p->hi);
+}
+
 /* Parse a numeric value (with optional suffix) from a string.
    Returns a long double value, with input precision.
 
@@ -1331,14 +1481,20 @@ next_field (char **line)
     {
       if (*field_start != delimiter)
         {
-          while (*field_end && *field_end != delimiter)
-            ++field_end;
+          field_end = strchr (field_start, delimiter);
+          if (!field_end)
+            field_end = field_start + strlen (field_start);
         }
       /* else empty field */
     }
-  else
+  else if (simple_blanks)
     {
       /* keep any space prefix in the returned field */
+      field_end += strspn (field_end, " \t\n");
+      field_end += strcspn (field_end, " \t\n");
+    }
+  else
+    {
       while (*field_end && field_sep (*field_end))
         ++field_end;
 
@@ -1405,6 +1561,29 @@ process_line (char *line, bool newline)
 
   while (true) {
     ++field;
+
+    if (max_field < field
+        && (delimiter != DELIMITER_DEFAULT || simple_blanks))
+      {
+        /* The remaining fields are all copied through unconverted,
+           except that in default delimiter mode the separator byte
+           after each field becomes a single space.  */
+        if (delimiter == DELIMITER_DEFAULT)
+          {
+            char *p = line;
+            while (true)
+              {
+                p += strspn (p, " \t\n");
+                p += strcspn (p, " \t\n");
+                if (!*p)
+                  break;
+                *p++ = ' ';
+              }
+          }
+        fputs (line, stdout);
+        break;
+      }
+
     next = next_field (&line);
 
     if (*line != '\0')
@@ -1593,6 +1772,9 @@ main (int argc, char **argv)
     }
 
 
+  compile_format_program ();
+  compile_field_program ();
+
   setup_padding_buffer (padding_width);
   auto_padding = (padding_width == 0 && delimiter == DELIMITER_DEFAULT);
 
@@ -21,6 +21,7 @@
 #include <stdio.h>
 #include <assert.h>
 #include <getopt.h>
+#include <pthread.h>
 #include <sys/types.h>
 #include "system.h"
 #include "argmatch.h"
@@ -30,6 +31,7 @@
 #include "quote.h"
 #include "stat-size.h"
 #include "xbinary-io.h"
+#include "xdectoint.h"
 #include "xprintf.h"
 #include "xstrtol.h"
 #include "xstrtol-error.h"
@@ -270,6 +272,9 @@ static enum size_spec fp_type_size[MAX_FP_TYPE_SIZE + 1];
 /* Use native endianess by default.  */
 static bool input_swap;
 
+/* Maximum number of threads formatting blocks of one seekable file.  */
+static size_t nthreads = 1;
+
 static char const short_options[] = "A:aBbcDdeFfHhIij:LlN:OoS:st:vw::Xx";
 
 /* For long options that have no equivalent short option, use a
@@ -278,6 +283,7 @@ enum
 {
   TRADITIONAL_OPTION = CHAR_MAX + 1,
   ENDIAN_OPTION,
+  THREADS_OPTION
 };
 
 enum endian_type
@@ -307,6 +313,7 @@ static struct option const long_options[] =
   {"traditional", no_argument, NULL, TRADITIONAL_OPTION},
   {"width", optional_argument, NULL, 'w'},
   {"endian", required_argument, NULL, ENDIAN_OPTION },
+  {"threads", required_argument, NULL, THREADS_OPTION},
 
   {GETOPT_HELP_OPTION_DECL},
   {GETOPT_VERSION_OPTION_DECL},
@@ -358,6 +365,8 @@ suffixes may be . for octal and b for multiply by 512.\n\
 \n\
                                 3 is implied when BYTES is not specified\n\
   -t, --format=TYPE           select output format or formats\n\
+      --threads=N             use up to N threads to format a seekable\n\
+                                file dumped with a single x1 or x4 spec\n\
   -v, --output-duplicates     do not use * to mark line suppression\n\
   -w[BYTES], --width[=BYTES]  output BYTES bytes per output line;\n\
                                 32 is implied when BYTES is not specified\n\
@@ -1118,11 +1127,14 @@ format_address_none (uintmax_t address _GL_UNUSED,
 {
 }
 
-static void
-format_address_std (uintmax_t address, char c)
+/* Format ADDRESS into BUF, which must hold MAX_ADDRESS_LENGTH + 2
+   bytes, followed by C and a terminating NUL.  Return a pointer to
+   the first character of the result, which ends where BUF ends.  */
+
+static char *
+format_address_buf (uintmax_t address, char c, char *buf)
 {
-  char buf[MAX_ADDRESS_LENGTH + 2];
-  char *p = buf + sizeof buf;
+  char *p = buf + MAX_ADDRESS_LENGTH + 2;
   char const *pbound;
 
   *--p = '\0';
@@ -1140,9 +1152,7 @@ format_address_std (uintmax_t address, char c)
       break;
 
     case 10:
-      do
-        *--p = '0' + (address % 10);
-      while ((address /= 10) != 0);
+      p = dectostr_r (address, p);
       break;
 
     case 16:
@@ -1155,7 +1165,14 @@ format_address_std (uintmax_t address, char c)
   while (pbound < p)
     *--p = '0';
 
-  fputs (p, stdout);
+  return p;
+}
+
+static void
+format_address_std (uintmax_t address, char c)
+{
+  char buf[MAX_ADDRESS_LENGTH + 2];
+  fputs (format_address_buf (address, c, buf), stdout);
 }
 
 static void
@@ -1174,6 +1191,114 @@ format_address_label (uintmax_t address, char c)
   format_address_paren (address + pseudo_offset, c);
 }
 
+/* Hex digit pairs and printable representations indexed by byte
+   value, and the assembled output line, for the table-driven
+   formatter below.  */
+static char hex_pairs[256][2];
+static char hex_print[256];
+static char *hex_line;
+
+/* An upper bound on the length of one formatted line.  */
+static size_t hex_line_size;
+
+/* Whether write_block may format with write_block_hex: one
+   hexadecimal x1 or x4 spec, unswapped input, and the standard or
+   empty address style.  */
+static bool hex_fast;
+
+/* Decide whether the fast formatter applies and set up its tables;
+   called once the locale, the specs and bytes_per_block are final.  */
+
+static void
+hex_fast_init (void)
+{
+  hex_fast = (n_specs == 1
+              && spec[0].fmt == HEXADECIMAL
+              && (spec[0].size == CHAR || spec[0].size == INT)
+              && ! input_swap
+              && (format_address == format_address_std
+                  || format_address == format_address_none));
+  if (! hex_fast)
+    return;
+
+  for (int i = 0; i < 256; i++)
+    {
+      hex_pairs[i][0] = "0123456789abcdef"[i >> 4];
+      hex_pairs[i][1] = "0123456789abcdef"[i & 15];
+      hex_print[i] = isprint (i) ? i : '.';
+    }
+
+  size_t fields = bytes_per_block / width_bytes[spec[0].size];
+  hex_line_size = (MAX_ADDRESS_LENGTH
+                   + (spec[0].field_width + 1) * fields
+                   + (spec[0].hexl_mode_trailer ? bytes_per_block + 4 : 0)
+                   + 2);
+  hex_line = xmalloc (hex_line_size);
+}
+
+/* Format the full block BLOCK at OFFSET into OUT as one line of
+   space-separated hexadecimal fields, assembled with the digit-pair
+   table instead of one xprintf call per field, and return the number
+   of bytes written, at most hex_line_size.  The layout matches the
+   generic path, which gives a single spec one column of padding per
+   field.  */
+
+static size_t
+hex_format_block (char *out, uintmax_t offset, char const *block)
+{
+  char addrbuf[MAX_ADDRESS_LENGTH + 2];
+  char *p = out;
+
+  if (format_address == format_address_std)
+    p = stpcpy (p, format_address_buf (offset, '\0', addrbuf));
+
+  if (spec[0].size == CHAR)
+    for (size_t i = 0; i < bytes_per_block; i++)
+      {
+        unsigned char b = block[i];
+        *p++ = ' ';
+        *p++ = hex_pairs[b][0];
+        *p++ = hex_pairs[b][1];
+      }
+  else
+    for (size_t i = 0; i < bytes_per_block; i += sizeof (unsigned int))
+      {
+        unsigned int v;
+        memcpy (&v, block + i, sizeof v);
+        *p++ = ' ';
+        for (int shift = CHAR_BIT * ((int) sizeof v - 1); 0 <= shift;
+             shift -= CHAR_BIT)
+          {
+            unsigned char b = v >> shift;
+            *p++ = hex_pairs[b][0];
+            *p++ = hex_pairs[b][1];
+          }
+      }
+
+  if (spec[0].hexl_mode_trailer)
+    {
+      *p++ = ' ';
+      *p++ = ' ';
+      *p++ = '>';
+      for (size_t i = 0; i < bytes_per_block; i++)
+        *p++ = hex_print[to_uchar (block[i])];
+      *p++ = '<';
+    }
+
+  *p++ = '\n';
+  return p - out;
+}
+
+/* Write the full block CURR_BLOCK at CURRENT_OFFSET with
+   hex_format_block.  */
+
+static void
+write_block_hex (uintmax_t current_offset, char const *curr_block)
+{
+  size_t len = hex_format_block (hex_line, current_offset, curr_block);
+  fwrite (hex_line, 1, len, stdout);
+}
+
 /* Write N_BYTES bytes from CURR_BLOCK to standard output once for each
    of the N_SPEC format specs.  CURRENT_OFFSET is the byte address of
    CURR_BLOCK in the concatenation of input files, and it is printed
@@ -1208,6 +1333,11 @@ write_block (uintmax_t current_offset, size_t n_bytes,
           prev_pair_equal = true;
         }
     }
+  else if (hex_fast && n_bytes == bytes_per_block)
+    {
+      prev_pair_equal = false;
+      write_block_hex (current_offset, curr_block);
+    }
   else
     {
       prev_pair_equal = false;
@@ -1359,6 +1489,230 @@ parse_old_offset (char const *s, uintmax_t *offset)
   return xstrtoumax (s, NULL, radix, offset, "Bb") == LONGINT_OK;
 }
 
+/* Input bytes formatted per --threads chunk, rounded down to a whole
+   number of blocks.  */
+enum { PARALLEL_CHUNK_SIZE = 4 * 1024 * 1024 };
+
+/* The output of one chunk, buffered until every earlier chunk has
+   been written.  */
+struct hex_chunk
+{
+  char *out;
+  size_t len;
+  bool filled;
+  bool ok;
+};
+
+/* State shared by the threads formatting the blocks of one file.
+   Workers claim consecutive chunk indexes under the mutex and park
+   their output in RING, a window of WINDOW chunks past the last one
+   the main thread has written; FILLED and DRAINED signal deposits
+   and flushes respectively.  */
+struct hex_pool
+{
+  pthread_mutex_t mutex;
+  pthread_cond_t filled;
+  pthread_cond_t drained;
+  int fd;
+  off_t pos;			/* file offset of the first block */
+  uintmax_t addr0;		/* printed address of the first block */
+  uintmax_t n_blocks;		/* full blocks to format */
+  size_t chunk_blocks;		/* blocks per chunk */
+  uintmax_t next;		/* next chunk index to claim */
+  uintmax_t flushed;		/* chunks already written out */
+  size_t window;
+  struct hex_chunk *ring;
+  bool stop;
+};
+
+/* Format chunks from *P until they run out or the main thread stops
+   the pool after a failed read.  */
+
+static void *
+hex_chunk_thread (void *arg)
+{
+  struct hex_pool *p = arg;
+  size_t bpb = bytes_per_block;
+  char *in = xnmalloc (p->chunk_blocks + 2, bpb);
+
+  while (true)
+    {
+      pthread_mutex_lock (&p->mutex);
+      while (! p->stop
+             && p->next * p->chunk_blocks < p->n_blocks
+             && p->window <= p->next - p->flushed)
+        pthread_cond_wait (&p->drained, &p->mutex);
+      if (p->stop || p->n_blocks <= p->next * p->chunk_blocks)
+        {
+          pthread_mutex_unlock (&p->mutex);
+          break;
+        }
+      uintmax_t ci = p->next++;
+      pthread_mutex_unlock (&p->mutex);
+
+      uintmax_t b0 = ci * p->chunk_blocks;
+      size_t nb = MIN ((uintmax_t) p->chunk_blocks, p->n_blocks - b0);
+
+      /* Also read up to two preceding blocks, which seed the
+         duplicate-block abbreviation state at the chunk boundary.  */
+      size_t lookback = MIN (b0, 2);
+      size_t want = (lookback + nb) * bpb;
+      off_t rpos = p->pos + (b0 - lookback) * bpb;
+      size_t got = 0;
+      bool ok = true;
+      while (got < want)
+        {
+          ssize_t n_read = pread (p->fd, in + got, want - got, rpos + got);
+          if (n_read < 0 && errno == EINTR)
+            continue;
+          if (n_read <= 0)	/* error, or the file shrank */
+            {
+              ok = false;
+              break;
+            }
+          got += n_read;
+        }
+
+      char *out = NULL;
+      size_t len = 0;
+      if (ok)
+        {
+          out = xnmalloc (nb, hex_line_size);
+          char const *blk = in + lookback * bpb;
+          bool prev_pair_equal = (lookback == 2
+                                  && memcmp (in, in + bpb, bpb) == 0);
+          for (size_t k = 0; k < nb; k++, blk += bpb)
+            {
+              if (abbreviate_duplicate_blocks
+                  && (0 < lookback || 0 < k)
+                  && memcmp (blk - bpb, blk, bpb) == 0)
+                {
+                  if (! prev_pair_equal)
+                    {
+                      out[len++] = '*';
+                      out[len++] = '\n';
+                      prev_pair_equal = true;
+                    }
+                }
+              else
+                {
+                  prev_pair_equal = false;
+                  len += hex_format_block (out + len,
+                                           p->addr0 + (b0 + k) * bpb, blk);
+                }
+            }
+        }
+
+      pthread_mutex_lock (&p->mutex);
+      struct hex_chunk *c = &p->ring[ci % p->window];
+      c->out = out;
+      c->len = len;
+      c->ok = ok;
+      c->filled = true;
+      pthread_cond_signal (&p->filled);
+      pthread_mutex_unlock (&p->mutex);
+    }
+
+  free (in);
+  return NULL;
+}
+
+/* With --threads, format the full blocks of the last remaining input
+   file with worker threads when the fast formatter applies and the
+   file is seekable, writing each chunk of output as soon as all of
+   its predecessors have been written.  Return the number of input
+   bytes consumed and leave the stream positioned after them, so the
+   loops in dump below handle whatever follows; return 0 when the
+   input is not eligible.  A failed read stops the pool after the
+   last good chunk, and rereading the failed region sequentially
+   produces the diagnostic.  */
+
+static uintmax_t
+dump_parallel (void)
+{
+  struct stat st;
+
+  if (*file_list != NULL)
+    return 0;
+
+  int fd = fileno (in_stream);
+  off_t pos = ftello (in_stream);
+  if (pos < 0 || fstat (fd, &st) != 0)
+    return 0;
+
+  /* As in skip, trust st_size only for regular files larger than
+     a block, to avoid proc-like file systems.  */
+  if (! usable_st_size (&st) || st.st_size <= ST_BLKSIZE (st))
+    return 0;
+
+  off_t end_pos = st.st_size;
+  if (limit_bytes_to_format && end_offset - n_bytes_to_skip < end_pos - pos)
+    end_pos = pos + (end_offset - n_bytes_to_skip);
+  if (end_pos - pos < (off_t) bytes_per_block)
+    return 0;
+
+  uintmax_t n_blocks = (end_pos - pos) / bytes_per_block;
+  size_t chunk_blocks = MAX (1, PARALLEL_CHUNK_SIZE / bytes_per_block);
+  uintmax_t n_chunks = (n_blocks - 1) / chunk_blocks + 1;
+  size_t nworkers = MIN (nthreads, n_chunks);
+  size_t window = nworkers + 2;
+
+  struct hex_pool pool = { PTHREAD_MUTEX_INITIALIZER, PTHREAD_COND_INITIALIZER,
+                           PTHREAD_COND_INITIALIZER, fd, pos, n_bytes_to_skip,
+                           n_blocks, chunk_blocks, 0, 0, window, NULL, false };
+  pool.ring = xcalloc (window, sizeof *pool.ring);
+
+  pthread_t *threads = xnmalloc (nworkers, sizeof *threads);
+  size_t started = 0;
+  for (size_t i = 0; i < nworkers; i++)
+    {
+      if (pthread_create (&threads[i], NULL, hex_chunk_thread, &pool) != 0)
+        break;
+      started++;
+    }
+
+  /* This thread writes the chunks out in order.  */
+  uintmax_t done_blocks = 0;
+  if (started != 0)
+    for (uintmax_t ci = 0; ci < n_chunks; ci++)
+      {
+        struct hex_chunk *c = &pool.ring[ci % window];
+        pthread_mutex_lock (&pool.mutex);
+        while (! c->filled)
+          pthread_cond_wait (&pool.filled, &pool.mutex);
+        char *out = c->out;
+        size_t len = c->len;
+        bool ok = c->ok;
+        c->filled = false;
+        c->out = NULL;
+        if (ok)
+          pool.flushed = ci + 1;
+        else
+          pool.stop = true;
+        pthread_cond_broadcast (&pool.drained);
+        pthread_mutex_unlock (&pool.mutex);
+        if (! ok)
+          break;
+        fwrite (out, 1, len, stdout);
+        free (out);
+        done_blocks = MIN (n_blocks, (ci + 1) * (uintmax_t) chunk_blocks);
+      }
+
+  for (size_t i = 0; i < started; i++)
+    pthread_join (threads[i], NULL);
+  free (threads);
+
+  for (size_t i = 0; i < window; i++)
+    if (pool.ring[i].filled)
+      free (pool.ring[i].out);
+  free (pool.ring);
+
+  uintmax_t done_bytes = done_blocks * bytes_per_block;
+  if (done_bytes != 0 && fseeko (in_stream, pos + done_bytes, SEEK_SET) != 0)
+    die (EXIT_FAILURE, errno, "%s", quotef (input_filename));
+  return done_bytes;
+}
+
 /* Read a chunk of size BYTES_PER_BLOCK from the input files, write the
    formatted block to standard output, and repeat until the specified
    maximum number of bytes has been read or until all input has been
@@ -1385,6 +1739,9 @@ dump (void)
 
   current_offset = n_bytes_to_skip;
 
+  if (1 < nthreads && hex_fast)
+    current_offset += dump_parallel ();
+
   if (limit_bytes_to_format)
     {
       while (1)
@@ -1715,6 +2072,11 @@ main (int argc, char **argv)
           traditional = true;
           break;
 
+        case THREADS_OPTION:
+          nthreads = xdectoumax (optarg, 1, SIZE_MAX, "",
+                                 _("invalid number of threads"), 0);
+          break;
+
         case ENDIAN_OPTION:
           switch (XARGMATCH ("--endian", optarg, endian_args, endian_types))
             {
@@ -1962,6 +2324,8 @@ main (int argc, char **argv)
       spec[i].pad_width = width_per_block - block_width;
     }
 
+  hex_fast_init ();
+
 #ifdef DEBUG
   printf ("lcm=%d, width_per_block=%"PRIuMAX"\n", l_c_m,
           (uintmax_t) width_per_block);
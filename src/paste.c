@@ -172,6 +172,34 @@ xputchar (char c)
     write_error ();
 }
 
+/* Size of the block buffer each input file is read through.  */
+enum { PASTE_BUFFER_SIZE = 32 * 1024 };
+
+/* Block-buffered input state for one file.  */
+struct input_buffer
+{
+  char *buf;			/* Block of input bytes.  */
+  char *pos;			/* Next unconsumed byte.  */
+  char *lim;			/* End of the valid bytes.  */
+  bool eof;			/* No more bytes after LIM.  */
+};
+
+/* Refill IB from STREAM if it has been drained.  Return the number of
+   buffered bytes remaining.  */
+
+static size_t
+ib_avail (struct input_buffer *ib, FILE *stream)
+{
+  if (ib->pos == ib->lim && !ib->eof)
+    {
+      size_t n_read = fread (ib->buf, 1, PASTE_BUFFER_SIZE, stream);
+      ib->pos = ib->buf;
+      ib->lim = ib->buf + n_read;
+      ib->eof = n_read < PASTE_BUFFER_SIZE;
+    }
+  return ib->lim - ib->pos;
+}
+
 /* Perform column paste on the NFILES files named in FNAMPTR.
    Return true if successful, false if one or more files could not be
    opened or read. */
@@ -190,6 +218,13 @@ paste_parallel (size_t nfiles, char **fnamptr)
      stream is closed.  */
   FILE **fileptr = xnmalloc (nfiles + 1, sizeof *fileptr);
 
+  /* Block buffers the streams are read through, so that each line
+     segment is located with memchr and written with one fwrite
+     instead of a character at a time.  Entries which both name
+     standard input share one buffer, since they share one stream.  */
+  struct input_buffer **ibuf = xnmalloc (nfiles, sizeof *ibuf);
+  struct input_buffer *stdin_buf = NULL;
+
   /* Number of files still open to process.  */
   size_t files_open;
 
@@ -216,6 +251,19 @@ paste_parallel (size_t nfiles, char **fnamptr)
             opened_stdin = true;
           fadvise (fileptr[files_open], FADVISE_SEQUENTIAL);
         }
+
+      if (fileptr[files_open] == stdin && stdin_buf)
+        ibuf[files_open] = stdin_buf;
+      else
+        {
+          struct input_buffer *ib = xmalloc (sizeof *ib);
+          ib->buf = xmalloc (PASTE_BUFFER_SIZE);
+          ib->pos = ib->lim = ib->buf;
+          ib->eof = false;
+          ibuf[files_open] = ib;
+          if (fileptr[files_open] == stdin)
+            stdin_buf = ib;
+        }
     }
 
   if (opened_stdin && have_read_stdin)
@@ -234,29 +282,39 @@ paste_parallel (size_t nfiles, char **fnamptr)
 
       for (size_t i = 0; i < nfiles && files_open; i++)
         {
-          int chr IF_LINT ( = 0);	/* Input character. */
           int err IF_LINT ( = 0);	/* Input errno value.  */
           bool sometodo = false;	/* Input chars to process.  */
 
           if (fileptr[i])
             {
-              chr = getc (fileptr[i]);
-              err = errno;
-              if (chr != EOF && delims_saved)
-                {
-                  if (fwrite (delbuf, 1, delims_saved, stdout) != delims_saved)
-                    write_error ();
-                  delims_saved = 0;
-                }
+              struct input_buffer *ib = ibuf[i];
 
-              while (chr != EOF)
+              while (true)
                 {
-                  sometodo = true;
-                  if (chr == line_delim)
-                    break;
-                  xputchar (chr);
-                  chr = getc (fileptr[i]);
+                  size_t avail = ib_avail (ib, fileptr[i]);
                   err = errno;
+                  if (avail == 0)
+                    break;
+
+                  if (!sometodo && delims_saved)
+                    {
+                      if (fwrite (delbuf, 1, delims_saved, stdout)
+                          != delims_saved)
+                        write_error ();
+                      delims_saved = 0;
+                    }
+                  sometodo = true;
+
+                  char *p = memchr (ib->pos, line_delim, avail);
+                  size_t n = (p ? p : ib->lim) - ib->pos;
+                  if (n && fwrite (ib->pos, 1, n, stdout) != n)
+                    write_error ();
+                  ib->pos += n;
+                  if (p)
+                    {
+                      ib->pos++;	/* Eat the line delimiter.  */
+                      break;
+                    }
                 }
             }
 
@@ -318,8 +376,6 @@ paste_parallel (size_t nfiles, char **fnamptr)
               /* Except for last file, replace last newline with delim. */
               if (i + 1 != nfiles)
                 {
-                  if (chr != line_delim && chr != EOF)
-                    xputchar (chr);
                   if (*delimptr != EMPTY_DELIM)
                     xputchar (*delimptr);
                   if (++delimptr == delim_end)
@@ -329,12 +385,23 @@ paste_parallel (size_t nfiles, char **fnamptr)
                 {
                   /* If the last line of the last file lacks a newline,
                      print one anyhow.  POSIX requires this.  */
-                  char c = (chr == EOF ? line_delim : chr);
-                  xputchar (c);
+                  xputchar (line_delim);
                 }
             }
         }
     }
+  for (size_t i = 0; i < nfiles; i++)
+    if (ibuf[i] != stdin_buf)
+      {
+        free (ibuf[i]->buf);
+        free (ibuf[i]);
+      }
+  if (stdin_buf)
+    {
+      free (stdin_buf->buf);
+      free (stdin_buf);
+    }
+  free (ibuf);
   free (fileptr);
   free (delbuf);
   return ok;
@@ -348,10 +415,13 @@ static bool
 paste_serial (size_t nfiles, char **fnamptr)
 {
   bool ok = true;	/* false if open or read errors occur. */
-  int charnew, charold; /* Current and previous char read. */
   char const *delimptr;	/* Current delimiter char. */
   FILE *fileptr;	/* Open for reading current file. */
 
+  /* Block buffer each file is read through, as in paste_parallel.  */
+  struct input_buffer ib;
+  ib.buf = xmalloc (PASTE_BUFFER_SIZE);
+
   for (; nfiles; nfiles--, fnamptr++)
     {
       int saved_errno;
@@ -375,40 +445,46 @@ paste_serial (size_t nfiles, char **fnamptr)
 
       delimptr = delims;	/* Set up for delimiter string. */
 
-      charold = getc (fileptr);
-      saved_errno = errno;
-      if (charold != EOF)
+      ib.pos = ib.lim = ib.buf;
+      ib.eof = false;
+
+      /* A line delimiter has been read but not yet output; it becomes
+         a column delimiter if more input follows, and otherwise is
+         kept as the terminator of the output line.  */
+      bool delim_pending = false;
+
+      while (true)
         {
-          /* 'charold' is set up.  Hit it!
-             Keep reading characters, stashing them in 'charnew';
-             output 'charold', converting to the appropriate delimiter
-             character if needed.  After the EOF, output 'charold'
-             if it's a newline; otherwise, output it and then a newline. */
+          size_t avail = ib_avail (&ib, fileptr);
+          saved_errno = errno;
+          if (avail == 0)
+            break;
 
-          while ((charnew = getc (fileptr)) != EOF)
+          if (delim_pending)
             {
-              /* Process the old character. */
-              if (charold == line_delim)
-                {
-                  if (*delimptr != EMPTY_DELIM)
-                    xputchar (*delimptr);
+              if (*delimptr != EMPTY_DELIM)
+                xputchar (*delimptr);
 
-                  if (++delimptr == delim_end)
-                    delimptr = delims;
-                }
-              else
-                xputchar (charold);
-
-              charold = charnew;
+              if (++delimptr == delim_end)
+                delimptr = delims;
+              delim_pending = false;
             }
-          saved_errno = errno;
 
-          /* Hit EOF.  Process that last character. */
-          xputchar (charold);
+          char *p = memchr (ib.pos, line_delim, avail);
+          size_t n = (p ? p : ib.lim) - ib.pos;
+          if (n && fwrite (ib.pos, 1, n, stdout) != n)
+            write_error ();
+          ib.pos += n;
+          if (p)
+            {
+              ib.pos++;		/* Eat the line delimiter.  */
+              delim_pending = true;
+            }
         }
 
-      if (charold != line_delim)
-        xputchar (line_delim);
+      /* Terminate the output line, either with the input's own
+         trailing delimiter or with one the input lacked.  */
+      xputchar (line_delim);
 
       if (ferror (fileptr))
         {
@@ -423,6 +499,7 @@ paste_serial (size_t nfiles, char **fnamptr)
           ok = false;
         }
     }
+  free (ib.buf);
   return ok;
 }
 
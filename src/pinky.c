@@ -29,6 +29,7 @@
 #include "error.h"
 #include "hard-locale.h"
 #include "readutmp.h"
+#include "utmp-map.h"
 
 /* The official name of this program (e.g., no 'g' prefix).  */
 #define PROGRAM_NAME "pinky"
@@ -464,12 +465,16 @@ short_pinky (char const *filename,
   size_t n_users;
   STRUCT_UTMP *utmp_buf = NULL;
 
-  if (read_utmp (filename, &n_users, &utmp_buf, 0) != 0)
+  bool mapped = utmp_map (filename, &n_users, &utmp_buf, 0) == 0;
+  if (! mapped && read_utmp (filename, &n_users, &utmp_buf, 0) != 0)
     die (EXIT_FAILURE, errno, "%s", quotef (filename));
 
   scan_entries (n_users, utmp_buf, argc_names, argv_names);
 
-  IF_LINT (free (utmp_buf));
+  if (mapped)
+    utmp_unmap ();
+  else
+    IF_LINT (free (utmp_buf));
 }
 
 static void
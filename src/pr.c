@@ -443,6 +443,7 @@ static void pad_down (unsigned int lines);
 static void read_rest_of_line (COLUMN *p);
 static void skip_read (COLUMN *p, int column_number);
 static void print_char (char c);
+static void print_stored_span (char const *first, char const *last);
 static void cleanup (void);
 static void print_sep_string (void);
 static void separator_string (char const *optarg_S);
@@ -724,6 +725,12 @@ static int header_width_available;
 
 static char *clump_buff;
 
+/* True for characters which char_to_clump() maps to themselves with a
+   width of one: printable characters other than tabs.  Lines consist
+   mostly of such characters, so read_line() handles them without
+   expanding a clump.  Initialized by init_parameters(). */
+static bool simple_clump[UCHAR_MAX + 1];
+
 /* True means we read the line no. lines_per_body in skip_read
    called by skip_to_page. That variable controls the coincidence of a
    "FF set by hand" and "full_page_printed", see above the definition of
@@ -1297,6 +1304,12 @@ init_parameters (int number_of_files)
      to expand a tab which is not an input_tab-char. */
   free (clump_buff);
   clump_buff = xmalloc (MAX (8, chars_per_input_tab));
+
+  for (int i = 0; i <= UCHAR_MAX; i++)
+    {
+      char c = i;
+      simple_clump[i] = c != input_tab_char && c != '\t' && isprint (i);
+    }
 }
 
 /* Open the necessary files,
@@ -2502,6 +2515,16 @@ read_line (COLUMN *p)
     {
       c = getc (p->fp);
 
+      if (0 <= c && simple_clump[c])
+        {
+          /* A simple character is its own clump of width one. */
+          if (truncate_lines && chars_per_column <= input_position)
+            return false;
+          ++input_position;
+          (p->char_func) (c);
+          continue;
+        }
+
       switch (c)
         {
         case '\n':
@@ -2591,8 +2614,7 @@ print_stored (COLUMN *p)
   if (use_col_separator)
     print_sep_string ();
 
-  while (first != last)
-    print_char (*first++);
+  print_stored_span (first, last);
 
   if (spaces_not_printed == 0)
     {
@@ -2604,6 +2626,47 @@ print_stored (COLUMN *p)
   return true;
 }
 
+/* Print the stored characters [FIRST, LAST) as print_char() would,
+   but a run at a time: without output tabification the whole span is
+   written at once, otherwise runs of spaces are only counted and runs
+   of printable characters are written together. */
+
+static void
+print_stored_span (char const *first, char const *last)
+{
+  if (!tabify_output)
+    {
+      fwrite (first, 1, last - first, stdout);
+      return;
+    }
+
+  while (first != last)
+    {
+      char const *run = first;
+
+      if (*first == ' ')
+        {
+          do
+            ++first;
+          while (first != last && *first == ' ');
+          spaces_not_printed += first - run;
+        }
+      else if (isprint (to_uchar (*first)))
+        {
+          do
+            ++first;
+          while (first != last && *first != ' '
+                 && isprint (to_uchar (*first)));
+          if (spaces_not_printed > 0)
+            print_white_space ();
+          fwrite (run, 1, first - run, stdout);
+          output_position += first - run;
+        }
+      else
+        print_char (*first++);
+    }
+}
+
 /* Convert a character to the proper format and return the number of
    characters in the resulting clump.  Increment input_position by
    the width of the clump.
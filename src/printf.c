@@ -59,6 +59,7 @@
 #include "die.h"
 #include "error.h"
 #include "quote.h"
+#include "repeat-fill.h"
 #include "unicodeio.h"
 #include "xprintf.h"
 
@@ -190,43 +191,31 @@ STRTOX (intmax_t,    vstrtoimax, strtoimax (s, &end, 0))
 STRTOX (uintmax_t,   vstrtoumax, strtoumax (s, &end, 0))
 STRTOX (long double, vstrtold,   cl_strtold (s, &end))
 
-/* Output a single-character \ escape.  */
+/* Decode a single-character \ escape; \c is handled by the callers.  */
 
-static void
-print_esc_char (char c)
+static char
+decode_esc_char (char c)
 {
   switch (c)
     {
     case 'a':			/* Alert. */
-      putchar ('\a');
-      break;
+      return '\a';
     case 'b':			/* Backspace. */
-      putchar ('\b');
-      break;
-    case 'c':			/* Cancel the rest of the output. */
-      exit (EXIT_SUCCESS);
-      break;
+      return '\b';
     case 'e':			/* Escape. */
-      putchar ('\x1B');
-      break;
+      return '\x1B';
     case 'f':			/* Form feed. */
-      putchar ('\f');
-      break;
+      return '\f';
     case 'n':			/* New line. */
-      putchar ('\n');
-      break;
+      return '\n';
     case 'r':			/* Carriage return. */
-      putchar ('\r');
-      break;
+      return '\r';
     case 't':			/* Horizontal tab. */
-      putchar ('\t');
-      break;
+      return '\t';
     case 'v':			/* Vertical tab. */
-      putchar ('\v');
-      break;
+      return '\v';
     default:
-      putchar (c);
-      break;
+      return c;
     }
 }
 
@@ -266,7 +255,11 @@ print_esc (char const *escstart, bool octal_0)
       putchar (esc_value);
     }
   else if (*p && strchr ("\"\\abcefnrtv", *p))
-    print_esc_char (*p++);
+    {
+      if (*p == 'c')		/* Cancel the rest of the output. */
+        exit (EXIT_SUCCESS);
+      putchar (decode_esc_char (*p++));
+    }
   else if (*p == 'u' || *p == 'U')
     {
       char esc_char = *p;
@@ -319,56 +312,84 @@ print_esc_string (char const *str)
       putchar (*str);
 }
 
-/* Evaluate a printf conversion specification.  START is the start of
-   the directive, LENGTH is its length, and CONVERSION specifies the
-   type of conversion.  LENGTH does not include any length modifier or
-   the conversion specifier itself.  FIELD_WIDTH and PRECISION are the
-   field width and precision for '*' values, if HAVE_FIELD_WIDTH and
-   HAVE_PRECISION are true, respectively.  ARGUMENT is the argument to
-   be formatted.  */
+/* One step of a compiled format.  */
 
-static void
-print_direc (char const *start, size_t length, char conversion,
-             bool have_field_width, int field_width,
-             bool have_precision, int precision,
-             char const *argument)
+enum direc_kind
+  {
+    DIREC_LITERAL,		/* Write LEN decoded bytes at TEXT.  */
+    DIREC_UNICODE,		/* Print the Unicode character UNI_VALUE.  */
+    DIREC_STOP,			/* \c: produce no further output.  */
+    DIREC_ESC_STRING,		/* %b: an argument with \ escapes interpreted.  */
+    DIREC_QUOTE,		/* %q: an argument quoted for shell reuse.  */
+    DIREC_CONV			/* A conversion handed to printf(3).  */
+  };
+
+struct direc
 {
-  char *p;		/* Null-terminated copy of % directive. */
+  enum direc_kind kind;
+  char const *text;		/* DIREC_LITERAL only.  */
+  size_t len;
+  unsigned int uni_value;	/* DIREC_UNICODE only.  */
+  char *fmt;			/* DIREC_CONV: the directive, with an
+				   intmax_t-wide length modifier and the
+				   conversion specifier appended.  */
+  char conversion;		/* DIREC_CONV: d, i, o, u, ...  */
+  bool field_star;		/* Field width comes from an argument.  */
+  bool prec_star;		/* Precision comes from an argument.  */
+};
+
+/* A format string compiled into a sequence of directives that can be
+   executed repeatedly without re-parsing the text.  */
+
+struct fmt_program
+{
+  struct direc *direcs;
+  size_t n_direcs;
+};
 
-  /* Create a null-terminated copy of the % directive, with an
-     intmax_t-wide length modifier substituted for any existing
-     integer length modifier.  */
-  {
-    char *q;
-    char const *length_modifier;
-    size_t length_modifier_len;
+/* Append a directive of kind KIND to PROG and return it.
+   *N_ALLOC tracks the allocated size of the directive array.  */
 
-    switch (conversion)
-      {
-      case 'd': case 'i': case 'o': case 'u': case 'x': case 'X':
-        length_modifier = PRIdMAX;
-        length_modifier_len = sizeof PRIdMAX - 2;
-        break;
-
-      case 'a': case 'e': case 'f': case 'g':
-      case 'A': case 'E': case 'F': case 'G':
-        length_modifier = "L";
-        length_modifier_len = 1;
-        break;
-
-      default:
-        length_modifier = start;  /* Any valid pointer will do.  */
-        length_modifier_len = 0;
-        break;
-      }
+static struct direc *
+new_direc (struct fmt_program *prog, size_t *n_alloc, enum direc_kind kind)
+{
+  if (prog->n_direcs == *n_alloc)
+    prog->direcs = x2nrealloc (prog->direcs, n_alloc, sizeof *prog->direcs);
+  struct direc *d = &prog->direcs[prog->n_direcs++];
+  memset (d, 0, sizeof *d);
+  d->kind = kind;
+  return d;
+}
+
+/* If bytes have accumulated between *LIT_START and LIT, turn them into
+   a literal directive in PROG and advance *LIT_START past them.  */
+
+static void
+close_literal (struct fmt_program *prog, size_t *n_alloc,
+               char const **lit_start, char const *lit)
+{
+  if (lit != *lit_start)
+    {
+      struct direc *d = new_direc (prog, n_alloc, DIREC_LITERAL);
+      d->text = *lit_start;
+      d->len = lit - *lit_start;
+      *lit_start = lit;
+    }
+}
 
-    p = xmalloc (length + length_modifier_len + 2);
-    q = mempcpy (p, start, length);
-    q = mempcpy (q, length_modifier, length_modifier_len);
-    *q++ = conversion;
-    *q = '\0';
-  }
+/* Evaluate a printf conversion specification.  P is the directive,
+   rebuilt by compile_format with an intmax_t-wide length modifier, and
+   CONVERSION specifies the type of conversion.  FIELD_WIDTH and
+   PRECISION are the field width and precision for '*' values, if
+   HAVE_FIELD_WIDTH and HAVE_PRECISION are true, respectively.
+   ARGUMENT is the argument to be formatted.  */
 
+static void
+print_direc (char const *p, char conversion,
+             bool have_field_width, int field_width,
+             bool have_precision, int precision,
+             char const *argument)
+{
   switch (conversion)
     {
     case 'd':
@@ -466,26 +487,32 @@ print_direc (char const *start, size_t length, char conversion,
         }
       break;
     }
-
-  free (p);
 }
 
-/* Print the text in FORMAT, using ARGV (with ARGC elements) for
-   arguments to any '%' directives.
-   Return the number of elements of ARGV used.  */
+/* Compile FORMAT into PROG: decode backslash escapes and fold '%%'
+   into literal runs, check each % directive once, and rebuild each
+   conversion with its length modifier, so executing the program never
+   re-parses the text.  Diagnostics for invalid directives and escapes
+   are therefore issued up front, before any output.  */
 
-static int
-print_formatted (char const *format, int argc, char **argv)
+static void
+compile_format (char const *format, struct fmt_program *prog)
 {
-  int save_argc = argc;		/* Preserve original value.  */
   char const *f;		/* Pointer into 'format'.  */
   char const *direc_start;	/* Start of % directive.  */
   size_t direc_length;		/* Length of % directive.  */
-  bool have_field_width;	/* True if FIELD_WIDTH is valid.  */
-  int field_width = 0;		/* Arg to first '*'.  */
-  bool have_precision;		/* True if PRECISION is valid.  */
-  int precision = 0;		/* Arg to second '*'.  */
+  bool field_star;		/* True if there is a '*' field width.  */
+  bool prec_star;		/* True if there is a '*' precision.  */
   char ok[UCHAR_MAX + 1];	/* ok['x'] is true if %x is allowed.  */
+  size_t n_alloc = 0;		/* Allocated size of the directive array.  */
+
+  /* Decoding escapes and '%%' only ever shrinks the text, so one
+     buffer the size of the format holds every literal run.  */
+  char *lit = xmalloc (strlen (format) + 1);
+  char const *lit_start = lit;
+
+  prog->direcs = NULL;
+  prog->n_direcs = 0;
 
   for (f = format; *f; ++f)
     {
@@ -494,34 +521,25 @@ print_formatted (char const *format, int argc, char **argv)
         case '%':
           direc_start = f++;
           direc_length = 1;
-          have_field_width = have_precision = false;
+          field_star = prec_star = false;
           if (*f == '%')
             {
-              putchar ('%');
+              *lit++ = '%';
               break;
             }
           if (*f == 'b')
             {
               /* FIXME: Field width and precision are not supported
                  for %b, even though POSIX requires it.  */
-              if (argc > 0)
-                {
-                  print_esc_string (*argv);
-                  ++argv;
-                  --argc;
-                }
+              close_literal (prog, &n_alloc, &lit_start, lit);
+              new_direc (prog, &n_alloc, DIREC_ESC_STRING);
               break;
             }
 
           if (*f == 'q')
             {
-              if (argc > 0)
-                {
-                  fputs (quotearg_style (shell_escape_quoting_style, *argv),
-                         stdout);
-                  ++argv;
-                  --argc;
-                }
+              close_literal (prog, &n_alloc, &lit_start, lit);
+              new_direc (prog, &n_alloc, DIREC_QUOTE);
               break;
             }
 
@@ -557,20 +575,7 @@ print_formatted (char const *format, int argc, char **argv)
             {
               ++f;
               ++direc_length;
-              if (argc > 0)
-                {
-                  intmax_t width = vstrtoimax (*argv);
-                  if (INT_MIN <= width && width <= INT_MAX)
-                    field_width = width;
-                  else
-                    die (EXIT_FAILURE, 0, _("invalid field width: %s"),
-                         quote (*argv));
-                  ++argv;
-                  --argc;
-                }
-              else
-                field_width = 0;
-              have_field_width = true;
+              field_star = true;
             }
           else
             while (ISDIGIT (*f))
@@ -587,27 +592,7 @@ print_formatted (char const *format, int argc, char **argv)
                 {
                   ++f;
                   ++direc_length;
-                  if (argc > 0)
-                    {
-                      intmax_t prec = vstrtoimax (*argv);
-                      if (prec < 0)
-                        {
-                          /* A negative precision is taken as if the
-                             precision were omitted, so -1 is safe
-                             here even if prec < INT_MIN.  */
-                          precision = -1;
-                        }
-                      else if (INT_MAX < prec)
-                        die (EXIT_FAILURE, 0, _("invalid precision: %s"),
-                             quote (*argv));
-                      else
-                        precision = prec;
-                      ++argv;
-                      --argc;
-                    }
-                  else
-                    precision = 0;
-                  have_precision = true;
+                  prec_star = true;
                 }
               else
                 while (ISDIGIT (*f))
@@ -629,18 +614,222 @@ print_formatted (char const *format, int argc, char **argv)
                    (int) (f + 1 - direc_start), direc_start);
           }
 
-          print_direc (direc_start, direc_length, *f,
-                       have_field_width, field_width,
-                       have_precision, precision,
-                       (argc <= 0 ? "" : (argc--, *argv++)));
+          close_literal (prog, &n_alloc, &lit_start, lit);
+          {
+            struct direc *d = new_direc (prog, &n_alloc, DIREC_CONV);
+            char *q;
+            char const *length_modifier;
+            size_t length_modifier_len;
+
+            d->conversion = *f;
+            d->field_star = field_star;
+            d->prec_star = prec_star;
+
+            /* Rebuild the % directive, with an intmax_t-wide length
+               modifier substituted for any existing integer length
+               modifier.  */
+            switch (*f)
+              {
+              case 'd': case 'i': case 'o': case 'u': case 'x': case 'X':
+                length_modifier = PRIdMAX;
+                length_modifier_len = sizeof PRIdMAX - 2;
+                break;
+
+              case 'a': case 'e': case 'f': case 'g':
+              case 'A': case 'E': case 'F': case 'G':
+                length_modifier = "L";
+                length_modifier_len = 1;
+                break;
+
+              default:
+                length_modifier = direc_start;  /* Any valid pointer.  */
+                length_modifier_len = 0;
+                break;
+              }
+
+            d->fmt = xmalloc (direc_length + length_modifier_len + 2);
+            q = mempcpy (d->fmt, direc_start, direc_length);
+            q = mempcpy (q, length_modifier, length_modifier_len);
+            *q++ = *f;
+            *q = '\0';
+          }
           break;
 
         case '\\':
-          f += print_esc (f, false);
+          {
+            /* Compile-time analogue of print_esc.  */
+            char const *p = f + 1;
+            int esc_value = 0;	/* Value of \nnn escape. */
+            int esc_length;	/* Length of \nnn escape. */
+
+            if (*p == 'x')
+              {
+                for (esc_length = 0, ++p;
+                     esc_length < 2 && isxdigit (to_uchar (*p));
+                     ++esc_length, ++p)
+                  esc_value = esc_value * 16 + hextobin (*p);
+                if (esc_length == 0)
+                  die (EXIT_FAILURE, 0,
+                       _("missing hexadecimal number in escape"));
+                *lit++ = esc_value;
+              }
+            else if (isodigit (*p))
+              {
+                for (esc_length = 0;
+                     esc_length < 3 && isodigit (*p);
+                     ++esc_length, ++p)
+                  esc_value = esc_value * 8 + octtobin (*p);
+                *lit++ = esc_value;
+              }
+            else if (*p && strchr ("\"\\abcefnrtv", *p))
+              {
+                if (*p == 'c')
+                  {
+                    /* Nothing after \c is ever output, and running the
+                       program stops here, so compilation can too.  */
+                    close_literal (prog, &n_alloc, &lit_start, lit);
+                    new_direc (prog, &n_alloc, DIREC_STOP);
+                    return;
+                  }
+                *lit++ = decode_esc_char (*p++);
+              }
+            else if (*p == 'u' || *p == 'U')
+              {
+                char esc_char = *p;
+                unsigned int uni_value;
+
+                uni_value = 0;
+                for (esc_length = (esc_char == 'u' ? 4 : 8), ++p;
+                     esc_length > 0;
+                     --esc_length, ++p)
+                  {
+                    if (! isxdigit (to_uchar (*p)))
+                      die (EXIT_FAILURE, 0,
+                           _("missing hexadecimal number in escape"));
+                    uni_value = uni_value * 16 + hextobin (*p);
+                  }
+
+                /* A universal character name shall not specify a character
+                   short identifier in the range 00000000 through 00000020,
+                   0000007F through 0000009F, or 0000D800 through 0000DFFF
+                   inclusive. A universal character name shall not designate
+                   a character in the required character set.  */
+                if ((uni_value <= 0x9f
+                     && uni_value != 0x24 && uni_value != 0x40
+                     && uni_value != 0x60)
+                    || (uni_value >= 0xd800 && uni_value <= 0xdfff))
+                  die (EXIT_FAILURE, 0,
+                       _("invalid universal character name \\%c%0*x"),
+                       esc_char, (esc_char == 'u' ? 4 : 8), uni_value);
+
+                close_literal (prog, &n_alloc, &lit_start, lit);
+                new_direc (prog, &n_alloc, DIREC_UNICODE)->uni_value
+                  = uni_value;
+              }
+            else
+              {
+                *lit++ = '\\';
+                if (*p)
+                  *lit++ = *p++;
+              }
+            f = p - 1;
+          }
           break;
 
         default:
-          putchar (*f);
+          *lit++ = *f;
+        }
+    }
+
+  close_literal (prog, &n_alloc, &lit_start, lit);
+}
+
+/* Execute one pass of the compiled program PROG, using ARGV (with ARGC
+   elements) for arguments to any '%' directives.
+   Return the number of elements of ARGV used.  */
+
+static int
+run_format (struct fmt_program const *prog, int argc, char **argv)
+{
+  int save_argc = argc;		/* Preserve original value.  */
+
+  for (size_t i = 0; i < prog->n_direcs; i++)
+    {
+      struct direc const *d = &prog->direcs[i];
+
+      switch (d->kind)
+        {
+        case DIREC_LITERAL:
+          fwrite (d->text, 1, d->len, stdout);
+          break;
+
+        case DIREC_UNICODE:
+          print_unicode_char (stdout, d->uni_value, 0);
+          break;
+
+        case DIREC_STOP:
+          exit (EXIT_SUCCESS);
+
+        case DIREC_ESC_STRING:
+          if (argc > 0)
+            {
+              print_esc_string (*argv);
+              ++argv;
+              --argc;
+            }
+          break;
+
+        case DIREC_QUOTE:
+          if (argc > 0)
+            {
+              fputs (quotearg_style (shell_escape_quoting_style, *argv),
+                     stdout);
+              ++argv;
+              --argc;
+            }
+          break;
+
+        case DIREC_CONV:
+          {
+            int field_width = 0;	/* Arg to first '*'.  */
+            int precision = 0;		/* Arg to second '*'.  */
+
+            if (d->field_star && argc > 0)
+              {
+                intmax_t width = vstrtoimax (*argv);
+                if (INT_MIN <= width && width <= INT_MAX)
+                  field_width = width;
+                else
+                  die (EXIT_FAILURE, 0, _("invalid field width: %s"),
+                       quote (*argv));
+                ++argv;
+                --argc;
+              }
+            if (d->prec_star && argc > 0)
+              {
+                intmax_t prec = vstrtoimax (*argv);
+                if (prec < 0)
+                  {
+                    /* A negative precision is taken as if the
+                       precision were omitted, so -1 is safe
+                       here even if prec < INT_MIN.  */
+                    precision = -1;
+                  }
+                else if (INT_MAX < prec)
+                  die (EXIT_FAILURE, 0, _("invalid precision: %s"),
+                       quote (*argv));
+                else
+                  precision = prec;
+                ++argv;
+                --argc;
+              }
+
+            print_direc (d->fmt, d->conversion,
+                         d->field_star, field_width,
+                         d->prec_star, precision,
+                         (argc <= 0 ? "" : (argc--, *argv++)));
+          }
+          break;
         }
     }
 
@@ -698,9 +887,22 @@ main (int argc, char **argv)
   argc -= 2;
   argv += 2;
 
+  /* When the format is reused for a run of arguments, give stdout a
+     buffer sized for the output pipe or device, so the run is written
+     in large blocks rather than one BUFSIZ flush at a time.  */
+  if (1 < argc)
+    {
+      size_t bufsize = repeat_fill_bufsize (STDOUT_FILENO);
+      if (BUFSIZ < bufsize)
+        setvbuf (stdout, NULL, _IOFBF, bufsize);
+    }
+
+  struct fmt_program prog;
+  compile_format (format, &prog);
+
   do
     {
-      args_used = print_formatted (format, argc, argv);
+      args_used = run_format (&prog, argc, argv);
       argc -= args_used;
       argv += args_used;
     }
@@ -0,0 +1,47 @@
+/* Static tracepoints for profiling live processes.
+   Copyright (C) 2021 Free Software Foundation, Inc.
+
+   This program is free software: you can redistribute it and/or modify
+   it under the terms of the GNU General Public License as published by
+   the Free Software Foundation, either version 3 of the License, or
+   (at your option) any later version.
+
+   This program is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU General Public License for more details.
+
+   You should have received a copy of the GNU General Public License
+   along with this program.  If not, see <https://www.gnu.org/licenses/>.  */
+
+/* USDT (user statically-defined tracing) probes at the hot phase
+   boundaries of selected tools, published under the "coreutils"
+   provider for bpftrace and systemtap.  An untraced probe compiles to
+   a single nop, so instrumented builds cost nothing until a tracer
+   attaches; where <sys/sdt.h> is unavailable the macros expand to
+   nothing at all.
+
+   Example, counting sort's buffer fills in a live process:
+
+     bpftrace -e 'usdt:/usr/bin/sort:coreutils:sort_fillbuf
+                    { @fills = count (); }' -p $(pgrep -x sort)  */
+
+#ifndef COREUTILS_PROBES_H
+# define COREUTILS_PROBES_H
+
+# if HAVE_SYS_SDT_H
+#  include <sys/sdt.h>
+#  define COREUTILS_PROBE(name) DTRACE_PROBE (coreutils, name)
+#  define COREUTILS_PROBE1(name, a1) DTRACE_PROBE1 (coreutils, name, a1)
+#  define COREUTILS_PROBE2(name, a1, a2) \
+     DTRACE_PROBE2 (coreutils, name, a1, a2)
+#  define COREUTILS_PROBE3(name, a1, a2, a3) \
+     DTRACE_PROBE3 (coreutils, name, a1, a2, a3)
+# else
+#  define COREUTILS_PROBE(name) ((void) 0)
+#  define COREUTILS_PROBE1(name, a1) ((void) 0)
+#  define COREUTILS_PROBE2(name, a1, a2) ((void) 0)
+#  define COREUTILS_PROBE3(name, a1, a2, a3) ((void) 0)
+# endif
+
+#endif
@@ -20,16 +20,21 @@
 #include <config.h>
 
 #include <getopt.h>
+#include <pthread.h>
+#include <stdalign.h>
 #include <sys/types.h>
+#include <sys/wait.h>
 #include "system.h"
 #include "die.h"
 #include <regex.h>
 #include "argmatch.h"
 #include "error.h"
 #include "fadvise.h"
+#include "filenamecat.h"
 #include "quote.h"
 #include "read-file.h"
 #include "stdio--.h"
+#include "xdectoint.h"
 #include "xstrtol.h"
 
 /* The official name of this program (e.g., no 'g' prefix).  */
@@ -85,6 +90,7 @@ static enum Format output_format = UNKNOWN_FORMAT;
                                 /* output format */
 
 static bool ignore_case = false;	/* fold lower to upper for sorting */
+static size_t nthreads = 1;	/* number of threads for sorting and output */
 static char const *break_file = NULL;	/* name of the 'Break chars' file */
 static char const *only_file = NULL;	/* name of the 'Only words' file */
 static char const *ignore_file = NULL;	/* name of the 'Ignore words' file */
@@ -240,6 +246,58 @@ static OCCURS *occurs_table[1];	/* all words retained from the read text */
 static size_t occurs_alloc[1];	/* allocated size of occurs_table */
 static ptrdiff_t number_of_occurs[1]; /* number of used slots in occurs_table */
 
+/* External-memory processing (--buffer-size).
+
+   When a memory bound is given, input files are not read whole into
+   memory.  Instead, the text is streamed through a window one line or
+   sentence at a time, and each occurrence is saved as a self-contained
+   record carrying a private copy of its context span.  Records
+   accumulate in a run of about the requested size; full runs are
+   sorted in memory and written to unlinked temporary files, which are
+   finally merged to produce output in the usual order.  Memory use is
+   then bounded by the run size plus one window, rather than by the
+   corpus.  */
+
+/* Memory bound for a spill run; 0 means keep everything in memory.  */
+static uintmax_t spill_buffer_size = 0;
+
+/* An occurrence record in a spill run, followed by its span text.
+   Offsets are relative to the span, except 'left' and 'right' which
+   keep their usual keyword-relative meaning.  */
+
+typedef struct
+  {
+    size_t span_size;		/* bytes of span text after this header */
+    ptrdiff_t key_off;		/* keyword offset in the span */
+    ptrdiff_t key_size;		/* keyword length */
+    ptrdiff_t left;		/* distance to left context start */
+    ptrdiff_t right;		/* distance to right context end */
+    intmax_t reference;		/* reference descriptor */
+    intmax_t sequence;		/* input order, stabilizing the sort */
+    int file_index;		/* corresponding file */
+  }
+SPILL_RECORD;
+
+static char *run_arena;		/* current run of serialized records */
+static size_t run_alloc;	/* allocated size of run_arena */
+static size_t run_used;		/* bytes used in run_arena */
+static ptrdiff_t *run_index;	/* arena offset of each record */
+static size_t run_index_alloc;	/* allocated length of run_index */
+static ptrdiff_t run_count;	/* number of records in the run */
+static FILE **run_files;	/* spilled, individually sorted runs */
+static int *run_levels;		/* how many merges each run went through */
+static size_t run_files_alloc;	/* allocated length of run_files */
+static ptrdiff_t n_run_files;	/* number of spilled runs */
+static intmax_t next_sequence;	/* input ordinal of the next occurrence */
+
+/* Line tracking state of the streamed scanner, persisting across
+   window refills within one input file.  */
+static char *scan_line_start;	/* start of the current input line */
+static char *scan_line_scan;	/* newlines scanned until this point */
+static ptrdiff_t scan_reference_length; /* length of reference in input mode */
+static intmax_t scan_pending_lines; /* newlines seen before the window but
+                                       not yet added to total_line_count */
+
 
 /* Communication among output routines.  */
 
@@ -623,6 +681,166 @@ search_table (WORD *word, WORD_TABLE *table)
   return false;
 }
 
+/* A parallel sort, used for large tables when --threads is given: the
+   elements are split into slices sorted concurrently, and the sorted
+   slices are then merged pairwise, also concurrently, akin to the
+   merge tree sort(1) builds.  The comparators here are pure functions
+   over read-only tables, so the worker threads need no locking.  */
+
+/* Tables below this many elements are sorted sequentially; such a
+   sort is too short for thread startup to pay off.  */
+enum { PARSORT_THRESHOLD = 16384 };
+
+struct sort_run
+  {
+    char *p;			/* first element of the run */
+    ptrdiff_t n;		/* number of elements */
+  };
+
+struct parsort_job
+  {
+    struct sort_run a;		/* slice to sort, or first run to merge */
+    struct sort_run b;		/* second run to merge; n == 0 when sorting */
+    char *dst;			/* where merged elements go */
+    size_t size;		/* size of one element */
+    int (*cmp) (const void *, const void *);
+    bool spawned;
+    pthread_t thread;
+  };
+
+static void *
+parsort_thread (void *job_arg)
+{
+  struct parsort_job *job = job_arg;
+  size_t size = job->size;
+
+  if (job->b.n == 0)
+    qsort (job->a.p, job->a.n, size, job->cmp);
+  else
+    {
+      char *a = job->a.p;
+      char *b = job->b.p;
+      char *dst = job->dst;
+      ptrdiff_t na = job->a.n;
+      ptrdiff_t nb = job->b.n;
+
+      while (na && nb)
+        {
+          if (job->cmp (a, b) <= 0)
+            {
+              memcpy (dst, a, size);
+              a += size;
+              na--;
+            }
+          else
+            {
+              memcpy (dst, b, size);
+              b += size;
+              nb--;
+            }
+          dst += size;
+        }
+      memcpy (dst, na ? a : b, (na ? na : nb) * size);
+    }
+
+  return NULL;
+}
+
+/* Run NJOBS jobs concurrently, the first on this thread.  If a worker
+   thread cannot be created its job simply runs here too.  */
+
+static void
+parsort_run_jobs (struct parsort_job *jobs, int njobs)
+{
+  for (int i = 1; i < njobs; i++)
+    {
+      jobs[i].spawned =
+        pthread_create (&jobs[i].thread, NULL, parsort_thread, &jobs[i]) == 0;
+      if (! jobs[i].spawned)
+        parsort_thread (&jobs[i]);
+    }
+  parsort_thread (&jobs[0]);
+  for (int i = 1; i < njobs; i++)
+    if (jobs[i].spawned)
+      pthread_join (jobs[i].thread, NULL);
+}
+
+/*---------------------------------------------------------------------.
+| Sort the N elements of SIZE bytes each at BASE with CMP, using up to |
+| nthreads threads when the table is large enough to make that pay.    |
+`---------------------------------------------------------------------*/
+
+static void
+sort_table (void *base, ptrdiff_t n, size_t size,
+            int (*cmp) (const void *, const void *))
+{
+  if (nthreads <= 1 || n < PARSORT_THRESHOLD)
+    {
+      qsort (base, n, size, cmp);
+      return;
+    }
+
+  int max_slices = MIN (nthreads, 64);
+  int nslices = 2;
+  while (nslices * 2 <= max_slices)
+    nslices *= 2;
+
+  char *scratch = xnmalloc (n, size);
+  struct parsort_job *jobs = xnmalloc (nslices, sizeof *jobs);
+  struct sort_run *runs = xnmalloc (nslices, sizeof *runs);
+
+  /* Sort the slices concurrently, in place.  */
+
+  ptrdiff_t lo = 0;
+  for (int i = 0; i < nslices; i++)
+    {
+      ptrdiff_t len = n / nslices + (i < n % nslices);
+      jobs[i].a = (struct sort_run) { (char *) base + lo * size, len };
+      jobs[i].b.n = 0;
+      jobs[i].size = size;
+      jobs[i].cmp = cmp;
+      runs[i] = jobs[i].a;
+      lo += len;
+    }
+  parsort_run_jobs (jobs, nslices);
+
+  /* Merge pairs of runs, alternating between SCRATCH and BASE so that
+     sources and destinations never overlap.  NSLICES is a power of
+     two, so every pass pairs all runs.  */
+
+  int nruns = nslices;
+  bool into_scratch = true;
+  while (1 < nruns)
+    {
+      char *dstbase = into_scratch ? scratch : base;
+      ptrdiff_t pos = 0;
+      int npairs = nruns / 2;
+
+      for (int i = 0; i < npairs; i++)
+        {
+          jobs[i].a = runs[2 * i];
+          jobs[i].b = runs[2 * i + 1];
+          jobs[i].dst = dstbase + pos * size;
+          jobs[i].size = size;
+          jobs[i].cmp = cmp;
+          runs[i] = (struct sort_run) { jobs[i].dst,
+                                        jobs[i].a.n + jobs[i].b.n };
+          pos += runs[i].n;
+        }
+      parsort_run_jobs (jobs, npairs);
+
+      nruns = npairs;
+      into_scratch = ! into_scratch;
+    }
+
+  if (runs[0].p != base)
+    memcpy (base, runs[0].p, n * size);
+
+  free (runs);
+  free (jobs);
+  free (scratch);
+}
+
 /*---------------------------------------------------------------------.
 | Sort the whole occurs table in memory.  Presumably, 'qsort' does not |
 | take intermediate copies or table elements, so the sort will be      |
@@ -635,8 +853,8 @@ sort_found_occurs (void)
 
   /* Only one language for the time being.  */
   if (number_of_occurs[0])
-    qsort (occurs_table[0], number_of_occurs[0], sizeof **occurs_table,
-           compare_occurs);
+    sort_table (occurs_table[0], number_of_occurs[0], sizeof **occurs_table,
+                compare_occurs);
 }
 
 /* Parameter files reading routines.  */
@@ -1011,6 +1229,507 @@ find_occurs_in_text (int file_index)
     }
 }
 
+/* External-memory processing.  */
+
+/* Directory in which to create spill files when TMPDIR is not set.  */
+#define DEFAULT_TMPDIR "/tmp"
+
+/*-------------------------------------------------------------------.
+| Open a stream on an anonymous temporary file in $TMPDIR.  The file |
+| is unlinked immediately, so no cleanup is needed.		     |
+`-------------------------------------------------------------------*/
+
+static FILE *
+open_spill_stream (void)
+{
+  char const *tmpdir = getenv ("TMPDIR");
+  char *name = file_name_concat (tmpdir ? tmpdir : DEFAULT_TMPDIR,
+                                 "ptxXXXXXX", NULL);
+  int fd = mkostemp (name, O_CLOEXEC);
+  if (fd < 0)
+    die (EXIT_FAILURE, errno, _("cannot create temporary file in %s"),
+         quoteaf (tmpdir ? tmpdir : DEFAULT_TMPDIR));
+  unlink (name);
+  free (name);
+  FILE *f = fdopen (fd, "w+");
+  if (! f)
+    die (EXIT_FAILURE, errno, _("cannot create temporary file in %s"),
+         quoteaf (tmpdir ? tmpdir : DEFAULT_TMPDIR));
+  return f;
+}
+
+/*--------------------------------------------------------------------.
+| Order two spilled records as compare_occurs orders OCCURS: by the   |
+| keyword, ties broken by input order, which the sequence number here |
+| stands in for since spilled keys have no common buffer.	      |
+`--------------------------------------------------------------------*/
+
+static int
+compare_spill_records (SPILL_RECORD const *first, char const *first_span,
+                       SPILL_RECORD const *second, char const *second_span)
+{
+  WORD first_key = { (char *) first_span + first->key_off, first->key_size };
+  WORD second_key = { (char *) second_span + second->key_off,
+                      second->key_size };
+  int value = compare_words (&first_key, &second_key);
+  return (value ? value
+          : first->sequence < second->sequence ? -1
+          : first->sequence > second->sequence);
+}
+
+/* qsort comparator over arena offsets for the records of one run.  */
+
+static int
+compare_run_entries (const void *void_first, const void *void_second)
+{
+  SPILL_RECORD const *first
+    = (SPILL_RECORD const *) (run_arena + *(ptrdiff_t const *) void_first);
+  SPILL_RECORD const *second
+    = (SPILL_RECORD const *) (run_arena + *(ptrdiff_t const *) void_second);
+  return compare_spill_records (first, (char const *) (first + 1),
+                                second, (char const *) (second + 1));
+}
+
+/* Maximum number of runs merged at once.  Spill files are anonymous,
+   so they can only live as open streams; whenever this many runs of
+   the same merge level accumulate, they are merged into one run of
+   the next level, keeping the number of open files logarithmic in the
+   number of runs and each record copied only once per level.  */
+enum { MAX_MERGE = 16 };
+
+static void merge_runs (ptrdiff_t first, ptrdiff_t count, FILE *out);
+
+/*----------------------------------------------------------------.
+| Sort the current run in memory and write it to a new temporary  |
+| file, releasing the arena for the next run.			  |
+`----------------------------------------------------------------*/
+
+static void
+flush_run (void)
+{
+  if (run_count == 0)
+    return;
+
+  sort_table (run_index, run_count, sizeof *run_index, compare_run_entries);
+
+  if (n_run_files == run_files_alloc)
+    {
+      size_t levels_alloc = run_files_alloc;
+      run_files = x2nrealloc (run_files, &run_files_alloc, sizeof *run_files);
+      run_levels = x2nrealloc (run_levels, &levels_alloc, sizeof *run_levels);
+    }
+  FILE *run = open_spill_stream ();
+
+  for (ptrdiff_t i = 0; i < run_count; i++)
+    {
+      SPILL_RECORD const *record
+        = (SPILL_RECORD const *) (run_arena + run_index[i]);
+      size_t size = sizeof *record + record->span_size;
+      if (fwrite (record, 1, size, run) != size)
+        die (EXIT_FAILURE, errno, _("write error"));
+    }
+
+  run_levels[n_run_files] = 0;
+  run_files[n_run_files++] = run;
+  run_used = 0;
+  run_count = 0;
+
+  while (MAX_MERGE <= n_run_files
+         && (run_levels[n_run_files - MAX_MERGE]
+             == run_levels[n_run_files - 1]))
+    {
+      FILE *merged = open_spill_stream ();
+      merge_runs (n_run_files - MAX_MERGE, MAX_MERGE, merged);
+      run_files[n_run_files - MAX_MERGE] = merged;
+      run_levels[n_run_files - MAX_MERGE]++;
+      n_run_files -= MAX_MERGE - 1;
+    }
+}
+
+/*--------------------------------------------------------------------.
+| Save one occurrence to the current run, together with a copy of its |
+| span [SPAN_START, SPAN_END), flushing the run first when adding the |
+| record would exceed the memory bound.				      |
+`--------------------------------------------------------------------*/
+
+static void
+spill_occurrence (int file_index, WORD const *key, char const *span_start,
+                  char const *span_end, char const *context_start,
+                  char const *context_end, intmax_t reference)
+{
+  size_t span_size = span_end - span_start;
+  size_t size = sizeof (SPILL_RECORD) + span_size;
+
+  /* Keep every record aligned within the arena.  */
+  size += -size % alignof (SPILL_RECORD);
+
+  if (! run_arena)
+    {
+      run_alloc = MAX (run_alloc, size);
+      run_arena = xmalloc (run_alloc);
+    }
+  else if (run_alloc - run_used < size)
+    {
+      flush_run ();
+      if (run_alloc < size)
+        {
+          free (run_arena);
+          run_alloc = size;
+          run_arena = xmalloc (run_alloc);
+        }
+    }
+
+  if (run_count == run_index_alloc)
+    run_index = x2nrealloc (run_index, &run_index_alloc, sizeof *run_index);
+  run_index[run_count++] = run_used;
+
+  SPILL_RECORD *record = (SPILL_RECORD *) (run_arena + run_used);
+  record->span_size = span_size;
+  record->key_off = key->start - span_start;
+  record->key_size = key->size;
+  record->left = context_start - key->start;
+  record->right = context_end - key->start;
+  record->reference = reference;
+  record->sequence = next_sequence++;
+  record->file_index = file_index;
+  memcpy (record + 1, span_start, span_size);
+  run_used += size;
+}
+
+/*---------------------------------------------------------------------.
+| Advance the streamed line tracking up to TARGET, before text ahead   |
+| of it is discarded from the window.  Newlines go into		       |
+| scan_pending_lines rather than total_line_count, so that they are    |
+| added only when a later keyword catches up with them, exactly as in  |
+| the unstreamed scanner; newlines trailing the last keyword of a file |
+| then never get counted, as before.  LIMIT bounds the window; when a  |
+| reference token after a newline reaches it and more input is coming, |
+| stop short so the token can be measured whole on the next refill.    |
+`---------------------------------------------------------------------*/
+
+static void
+advance_line_tracking (char *target, char *limit, bool at_eof)
+{
+  while (scan_line_scan < target)
+    if (*scan_line_scan == '\n')
+      {
+        if (! at_eof)
+          {
+            char *peek = scan_line_scan + 1;
+            SKIP_NON_WHITE (peek, limit);
+            if (peek == limit)
+              break;
+          }
+        scan_pending_lines++;
+        scan_line_scan++;
+        scan_line_start = scan_line_scan;
+        SKIP_NON_WHITE (scan_line_scan, limit);
+        scan_reference_length = scan_line_scan - scan_line_start;
+      }
+    else
+      scan_line_scan++;
+}
+
+/*---------------------------------------------------------------------.
+| Streamed counterpart of find_occurs_in_text.  Process the complete   |
+| lines or sentences within [START, END), spilling a record for each   |
+| keyword found, and return the end of the processed text.  When not   |
+| AT_EOF, an unterminated span at the end of the window is left for a  |
+| later call with more data.					       |
+`---------------------------------------------------------------------*/
+
+static char *
+scan_window (int file_index, char *start, char *end, bool at_eof)
+{
+  char *cursor;			/* for scanning the window */
+  char *scan;			/* for scanning the window also */
+  WORD possible_key;		/* possible key, to ease searches */
+
+  char *context_start;		/* start of left context */
+  char *context_end;		/* end of right context */
+  char *word_start;		/* start of word */
+  char *word_end;		/* end of word */
+  char *next_context_start;	/* next start of left context */
+
+  for (cursor = start; cursor < end; cursor = next_context_start)
+    {
+      context_start = cursor;
+      next_context_start = end;
+
+      /* Delimit the next line or sentence as in find_occurs_in_text,
+         but refuse to guess at an incomplete one: without a separator
+         match wholly inside the window, or with a match whose
+         separator touches the end of the window and so might extend,
+         wait for more input.  */
+
+      if (context_regex.string)
+        switch (re_search (&context_regex.pattern, cursor, end - cursor,
+                           0, end - cursor, &context_regs))
+          {
+          case -2:
+            matcher_error ();
+
+          case -1:
+            if (! at_eof)
+              return cursor;
+            break;
+
+          case 0:
+            die (EXIT_FAILURE, 0,
+                 _("error: regular expression has a match of length zero: %s"),
+                 quote (context_regex.string));
+
+          default:
+            if (! at_eof && cursor + context_regs.end[0] == end)
+              return cursor;
+            next_context_start = cursor + context_regs.end[0];
+            break;
+          }
+      else if (! at_eof)
+        return cursor;
+
+      context_end = next_context_start;
+      SKIP_WHITE_BACKWARDS (context_end, context_start);
+
+      /* Read and process a single line or sentence, one word at a
+         time, as in find_occurs_in_text, except that each kept word
+         becomes a spilled record instead of an OCCURS entry.  */
+
+      while (1)
+        {
+          if (word_regex.string)
+            {
+              regoff_t r = re_search (&word_regex.pattern, cursor,
+                                      context_end - cursor,
+                                      0, context_end - cursor, &word_regs);
+              if (r == -2)
+                matcher_error ();
+              if (r == -1)
+                break;
+              word_start = cursor + word_regs.start[0];
+              word_end = cursor + word_regs.end[0];
+            }
+          else
+            {
+              scan = cursor;
+              while (scan < context_end
+                     && !word_fastmap[to_uchar (*scan)])
+                scan++;
+
+              if (scan == context_end)
+                break;
+
+              word_start = scan;
+
+              while (scan < context_end
+                     && word_fastmap[to_uchar (*scan)])
+                scan++;
+
+              word_end = scan;
+            }
+
+          cursor = word_start;
+
+          if (word_end == word_start)
+            {
+              cursor++;
+              continue;
+            }
+
+          possible_key.start = cursor;
+          possible_key.size = word_end - word_start;
+          cursor += possible_key.size;
+
+          if (possible_key.size > maximum_word_length)
+            maximum_word_length = possible_key.size;
+
+          /* Catch the line tracking up to this word.  Newlines counted
+             while sliding the window are owed to total_line_count and
+             are paid back here, at the same moment the unstreamed
+             scanner would have counted them.  */
+
+          if (input_reference)
+            {
+              total_line_count += scan_pending_lines;
+              scan_pending_lines = 0;
+              while (scan_line_scan < possible_key.start)
+                if (*scan_line_scan == '\n')
+                  {
+                    total_line_count++;
+                    scan_line_scan++;
+                    scan_line_start = scan_line_scan;
+                    SKIP_NON_WHITE (scan_line_scan, end);
+                    scan_reference_length = scan_line_scan - scan_line_start;
+                  }
+                else
+                  scan_line_scan++;
+              if (scan_line_scan > possible_key.start)
+                continue;
+            }
+
+          if (ignore_file && search_table (&possible_key, &ignore_table))
+            continue;
+          if (only_file && !search_table (&possible_key, &only_table))
+            continue;
+
+          intmax_t reference = 0;
+
+          if (auto_reference)
+            {
+              total_line_count += scan_pending_lines;
+              scan_pending_lines = 0;
+              while (scan_line_scan < possible_key.start)
+                if (*scan_line_scan == '\n')
+                  {
+                    total_line_count++;
+                    scan_line_scan++;
+                    scan_line_start = scan_line_scan;
+                    SKIP_NON_WHITE (scan_line_scan, end);
+                  }
+                else
+                  scan_line_scan++;
+
+              reference = total_line_count;
+            }
+          else if (input_reference)
+            {
+              reference = scan_line_start - possible_key.start;
+              if (scan_reference_length > reference_max_width)
+                reference_max_width = scan_reference_length;
+            }
+
+          if (input_reference && scan_line_start == context_start)
+            {
+              SKIP_NON_WHITE (context_start, context_end);
+              SKIP_WHITE (context_start, context_end);
+            }
+
+          /* The span must cover everything the output routines may
+             look at: the context, and in input reference mode also
+             the reference at the start of the line, which may lie
+             before the context.  */
+
+          char *span_start = context_start;
+          if (input_reference && scan_line_start < span_start)
+            span_start = scan_line_start;
+
+          spill_occurrence (file_index, &possible_key, span_start,
+                            context_end, context_start, context_end,
+                            reference);
+        }
+    }
+
+  return end;
+}
+
+/*---------------------------------------------------------------------.
+| Study one input file through a sliding window, spilling occurrence   |
+| records instead of keeping the text.  The window retains unprocessed |
+| text and, when references are in use, the beginning of the current   |
+| line; it grows only when a single line or sentence outgrows it.      |
+`---------------------------------------------------------------------*/
+
+static void
+study_file_streamed (int file_index)
+{
+  char const *file_name = input_file_name[file_index];
+  bool using_stdin = !file_name || !*file_name || STREQ (file_name, "-");
+  FILE *fp = using_stdin ? stdin : fopen (file_name, "r");
+  if (! fp)
+    die (EXIT_FAILURE, errno, "%s", quotef (file_name));
+  fadvise (fp, FADVISE_SEQUENTIAL);
+
+  size_t window_alloc = 128 * 1024;
+  char *window = xmalloc (window_alloc);
+  size_t fill = 0;
+  char *unprocessed = window;
+  bool at_eof = false;
+  bool initial_skip_done = ! input_reference;
+
+  scan_line_start = window;
+  scan_line_scan = window;
+  scan_reference_length = 0;
+  scan_pending_lines = 0;
+
+  while (true)
+    {
+      if (! at_eof)
+        {
+          size_t n_read = fread (window + fill, 1, window_alloc - fill, fp);
+          if (n_read == 0)
+            {
+              if (ferror (fp))
+                die (EXIT_FAILURE, errno, "%s",
+                     quotef (using_stdin ? "-" : file_name));
+              at_eof = true;
+            }
+          fill += n_read;
+        }
+
+      char *end = window + fill;
+
+      /* In input reference mode, skip the very first reference before
+         scanning anything, as find_occurs_in_text does.  Wait until
+         the token is known to be complete.  */
+
+      if (! initial_skip_done)
+        {
+          SKIP_NON_WHITE (scan_line_scan, end);
+          if (scan_line_scan < end || at_eof)
+            {
+              scan_reference_length = scan_line_scan - scan_line_start;
+              SKIP_WHITE (scan_line_scan, end);
+              initial_skip_done = true;
+            }
+          else
+            scan_line_scan = scan_line_start;
+        }
+
+      if (initial_skip_done)
+        unprocessed = scan_window (file_index, unprocessed, end, at_eof);
+
+      if (at_eof)
+        break;
+
+      /* Slide the window past the processed text, retaining the
+         current line when line tracking needs it.  */
+
+      char *keep = unprocessed;
+      if (auto_reference || input_reference)
+        {
+          advance_line_tracking (unprocessed, end, false);
+          if (scan_line_start < keep)
+            keep = scan_line_start;
+        }
+
+      if (window < keep)
+        {
+          size_t delta = keep - window;
+          memmove (window, keep, fill - delta);
+          fill -= delta;
+          unprocessed -= delta;
+          scan_line_start -= delta;
+          scan_line_scan -= delta;
+        }
+      else if (fill == window_alloc)
+        {
+          /* A single line or sentence outgrew the window.  */
+          size_t unprocessed_offset = unprocessed - window;
+          size_t line_start_offset = scan_line_start - window;
+          size_t line_scan_offset = scan_line_scan - window;
+          window_alloc *= 2;
+          window = xrealloc (window, window_alloc);
+          unprocessed = window + unprocessed_offset;
+          scan_line_start = window + line_start_offset;
+          scan_line_scan = window + line_scan_offset;
+        }
+    }
+
+  free (window);
+  if (! using_stdin)
+    fclose (fp);
+}
+
 /* Formatting and actual output - service routines.  */
 
 /*-----------------------------------------.
@@ -1634,21 +2353,48 @@ output_one_dumb_line (void)
   putchar ('\n');
 }
 
-/*------------------------------------------------------------------------.
-| Scan the whole occurs table and, for each entry, output one line in the |
-| appropriate format.							  |
-`------------------------------------------------------------------------*/
+/*--------------------------------------------------------------------.
+| Output one line for the given keyword occurrence, in the selected   |
+| format.							      |
+`--------------------------------------------------------------------*/
 
 static void
-generate_all_output (void)
+output_one_line (OCCURS *occurs)
 {
-  ptrdiff_t occurs_index;	/* index of keyword entry being processed */
-  OCCURS *occurs_cursor;	/* current keyword entry being processed */
+  /* Compute the exact size of every field and whenever truncation flags
+     are present or not.  */
+
+  define_all_fields (occurs);
+
+  /* Produce one output line according to selected format.  */
+
+  switch (output_format)
+    {
+    case UNKNOWN_FORMAT:
+      /* Should never happen.  */
 
-  /* The following assignments are useful to provide default values in case
-     line contexts or references are not used, in which case these variables
-     would never be computed.  */
+    case DUMB_FORMAT:
+      output_one_dumb_line ();
+      break;
 
+    case ROFF_FORMAT:
+      output_one_roff_line ();
+      break;
+
+    case TEX_FORMAT:
+      output_one_tex_line ();
+      break;
+    }
+}
+
+/*--------------------------------------------------------------------.
+| Provide default values for the fields which are computed only when  |
+| line contexts or references are in use.			      |
+`--------------------------------------------------------------------*/
+
+static void
+initialize_output_fields (void)
+{
   tail.start = NULL;
   tail.end = NULL;
   tail_truncation = false;
@@ -1656,42 +2402,276 @@ generate_all_output (void)
   head.start = NULL;
   head.end = NULL;
   head_truncation = false;
+}
 
-  /* Loop over all keyword occurrences.  */
+/*--------------------------------------------------------------------.
+| Output one line for each of the sorted occurrences with an index in |
+| [LO, HI).							      |
+`--------------------------------------------------------------------*/
 
-  occurs_cursor = occurs_table[0];
+static void
+output_occurs_range (ptrdiff_t lo, ptrdiff_t hi)
+{
+  initialize_output_fields ();
+
+  for (ptrdiff_t occurs_index = lo; occurs_index < hi; occurs_index++)
+    output_one_line (occurs_table[0] + occurs_index);
+}
+
+/*------------------------------------------------------------------------.
+| Scan the whole occurs table and, for each entry, output one line in the |
+| appropriate format.							  |
+`------------------------------------------------------------------------*/
+
+static void
+generate_all_output (void)
+{
+  output_occurs_range (0, number_of_occurs[0]);
+}
+
+/* Minimum occurrences per output worker; with fewer, formatting is
+   too short for process startup to pay off.  */
+enum { OUTPUT_SHARD_THRESHOLD = 4096 };
 
-  for (occurs_index = 0; occurs_index < number_of_occurs[0]; occurs_index++)
+/*---------------------------------------------------------------------.
+| Like generate_all_output, but with the occurs table divided into up  |
+| to nthreads shards formatted concurrently.  Formatting builds on a   |
+| lot of global state, so each shard is produced by a forked child     |
+| writing to an anonymous temporary file, which the parent then	       |
+| concatenates in order; the output bytes are exactly those of the     |
+| sequential path.						       |
+`---------------------------------------------------------------------*/
+
+static void
+generate_all_output_sharded (void)
+{
+  ptrdiff_t n = number_of_occurs[0];
+  ptrdiff_t workers = MIN ((uintmax_t) nthreads,
+                           (uintmax_t) (n / OUTPUT_SHARD_THRESHOLD));
+
+  if (workers < 2)
     {
-      /* Compute the exact size of every field and whenever truncation flags
-         are present or not.  */
+      generate_all_output ();
+      return;
+    }
 
-      define_all_fields (occurs_cursor);
+  FILE **shard_file = xnmalloc (workers, sizeof *shard_file);
+  pid_t *pids = xnmalloc (workers, sizeof *pids);
 
-      /* Produce one output line according to selected format.  */
+  /* Flush before forking, so no pending bytes are duplicated into
+     the children.  */
 
-      switch (output_format)
+  if (fflush (stdout) != 0)
+    die (EXIT_FAILURE, errno, _("write error"));
+
+  ptrdiff_t lo = 0;
+  for (ptrdiff_t w = 0; w < workers; w++)
+    {
+      ptrdiff_t len = n / workers + (w < n % workers);
+
+      shard_file[w] = open_spill_stream ();
+      pids[w] = fork ();
+      if (pids[w] < 0)
+        die (EXIT_FAILURE, errno, _("fork system call failed"));
+
+      if (pids[w] == 0)
         {
-        case UNKNOWN_FORMAT:
-          /* Should never happen.  */
+          /* Child: standard output goes to the shard file, and exiting
+             flushes it there.  */
 
-        case DUMB_FORMAT:
-          output_one_dumb_line ();
-          break;
+          if (dup2 (fileno (shard_file[w]), STDOUT_FILENO) < 0)
+            die (EXIT_FAILURE, errno, _("write error"));
+          output_occurs_range (lo, lo + len);
+          exit (EXIT_SUCCESS);
+        }
 
-        case ROFF_FORMAT:
-          output_one_roff_line ();
-          break;
+      lo += len;
+    }
 
-        case TEX_FORMAT:
-          output_one_tex_line ();
-          break;
+  for (ptrdiff_t w = 0; w < workers; w++)
+    {
+      int status;
+      while (waitpid (pids[w], &status, 0) < 0)
+        if (errno != EINTR)
+          die (EXIT_FAILURE, errno, _("waiting for child process"));
+      if (! WIFEXITED (status) || WEXITSTATUS (status) != 0)
+        exit (WIFEXITED (status) ? WEXITSTATUS (status) : EXIT_FAILURE);
+
+      FILE *f = shard_file[w];
+      char buf[BUFSIZ];
+      size_t got;
+
+      if (fseeko (f, 0, SEEK_SET) != 0)
+        die (EXIT_FAILURE, errno, _("read error"));
+      while ((got = fread (buf, 1, sizeof buf, f)) > 0)
+        if (fwrite (buf, 1, got, stdout) != got)
+          die (EXIT_FAILURE, errno, _("write error"));
+      if (ferror (f))
+        die (EXIT_FAILURE, errno, _("read error"));
+      fclose (f);
+    }
+
+  free (pids);
+  free (shard_file);
+}
+
+/*--------------------------------------------------------------------.
+| Output one spilled record.  Its private copy of the context span    |
+| temporarily stands in for the text buffer of the originating file,  |
+| and offsets are turned back into an OCCURS for the regular output   |
+| routines.							      |
+`--------------------------------------------------------------------*/
+
+static void
+output_spilled_record (SPILL_RECORD const *record, char *span)
+{
+  OCCURS occurs;
+
+  text_buffers[record->file_index].start = span;
+  text_buffers[record->file_index].end = span + record->span_size;
+
+  occurs.key.start = span + record->key_off;
+  occurs.key.size = record->key_size;
+  occurs.left = record->left;
+  occurs.right = record->right;
+  occurs.reference = record->reference;
+  occurs.file_index = record->file_index;
+
+  output_one_line (&occurs);
+}
+
+/* Head of one run during the merge phase.  */
+
+typedef struct
+  {
+    FILE *stream;		/* run file, positioned at the next record */
+    SPILL_RECORD record;	/* current record of this run */
+    char *span;			/* span of the current record */
+    size_t span_alloc;		/* allocated size of SPAN */
+    bool exhausted;		/* no records left in this run */
+  }
+RUN_HEAD;
+
+/*--------------------------------------------------.
+| Read the next record of a run, if there is one.   |
+`--------------------------------------------------*/
+
+static void
+read_run_record (RUN_HEAD *run)
+{
+  size_t n_read = fread (&run->record, 1, sizeof run->record, run->stream);
+  if (n_read == 0 && feof (run->stream))
+    {
+      run->exhausted = true;
+      return;
+    }
+  if (n_read != sizeof run->record)
+    die (EXIT_FAILURE, errno, _("read error"));
+
+  if (run->span_alloc < run->record.span_size)
+    {
+      free (run->span);
+      run->span_alloc = run->record.span_size;
+      run->span = xmalloc (run->span_alloc);
+    }
+  if (fread (run->span, 1, run->record.span_size, run->stream)
+      != run->record.span_size)
+    die (EXIT_FAILURE, errno, _("read error"));
+}
+
+/*---------------------------------------------------------------------.
+| Merge COUNT sorted runs, starting at FIRST in the run file table.    |
+| When OUT is null, output one line per record; otherwise write the    |
+| records, still serialized, to OUT, forming a larger sorted run.      |
+| The merged run files are closed.				       |
+`---------------------------------------------------------------------*/
+
+static void
+merge_runs (ptrdiff_t first, ptrdiff_t count, FILE *out)
+{
+  RUN_HEAD *heads = xnmalloc (count, sizeof *heads);
+
+  for (ptrdiff_t i = 0; i < count; i++)
+    {
+      heads[i].stream = run_files[first + i];
+      heads[i].span = NULL;
+      heads[i].span_alloc = 0;
+      heads[i].exhausted = false;
+      if (fseeko (heads[i].stream, 0, SEEK_SET) != 0)
+        die (EXIT_FAILURE, errno, _("read error"));
+      read_run_record (&heads[i]);
+    }
+
+  /* The number of runs is small, so a plain linear scan for the
+     smallest head is good enough.  */
+
+  while (true)
+    {
+      RUN_HEAD *smallest = NULL;
+      for (ptrdiff_t i = 0; i < count; i++)
+        if (! heads[i].exhausted
+            && (! smallest
+                || (compare_spill_records (&heads[i].record, heads[i].span,
+                                           &smallest->record, smallest->span)
+                    < 0)))
+          smallest = &heads[i];
+
+      if (! smallest)
+        break;
+
+      if (out)
+        {
+          if (fwrite (&smallest->record, 1, sizeof smallest->record, out)
+              != sizeof smallest->record
+              || (fwrite (smallest->span, 1, smallest->record.span_size, out)
+                  != smallest->record.span_size))
+            die (EXIT_FAILURE, errno, _("write error"));
         }
+      else
+        output_spilled_record (&smallest->record, smallest->span);
 
-      /* Advance the cursor into the occurs table.  */
+      read_run_record (smallest);
+    }
 
-      occurs_cursor++;
+  for (ptrdiff_t i = 0; i < count; i++)
+    {
+      free (heads[i].span);
+      fclose (heads[i].stream);
     }
+  free (heads);
+}
+
+/*---------------------------------------------------------------------.
+| Merge the sorted runs and output one line per record, in the order   |
+| sort_found_occurs would have produced.  When everything fit in a     |
+| single run, sort and output it straight from memory, without any     |
+| temporary file.						       |
+`---------------------------------------------------------------------*/
+
+static void
+merge_and_output (void)
+{
+  initialize_output_fields ();
+
+  if (n_run_files == 0)
+    {
+      sort_table (run_index, run_count, sizeof *run_index,
+                  compare_run_entries);
+      for (ptrdiff_t i = 0; i < run_count; i++)
+        {
+          SPILL_RECORD *record
+            = (SPILL_RECORD *) (run_arena + run_index[i]);
+          output_spilled_record (record, (char *) (record + 1));
+        }
+      return;
+    }
+
+  /* Spill the last, partial run.  All the remaining runs are already
+     open, at most MAX_MERGE - 1 per merge level, so merging them all
+     at once costs nothing more in open files.  */
+
+  flush_run ();
+  merge_runs (0, n_run_files, NULL);
 }
 
 /* Option decoding and main program.  */
@@ -1736,6 +2716,10 @@ Output a permuted index, including context, of the words in the input files.\n\
       fputs (_("\
   -W, --word-regexp=REGEXP       use REGEXP to match each keyword\n\
   -b, --break-file=FILE          word break characters in this FILE\n\
+      --buffer-size=SIZE         index inputs larger than SIZE via temporary\n\
+                                 files, keeping about SIZE bytes in memory\n\
+      --threads=N                use up to N threads to sort keywords and\n\
+                                 format output\n\
   -f, --ignore-case              fold lower case to upper case for sorting\n\
   -g, --gap-size=NUMBER          gap size in columns between output fields\n\
   -i, --ignore-file=FILE         read ignore word list from FILE\n\
@@ -1763,6 +2747,7 @@ static struct option const long_options[] =
 {
   {"auto-reference", no_argument, NULL, 'A'},
   {"break-file", required_argument, NULL, 'b'},
+  {"buffer-size", required_argument, NULL, 11},
   {"flag-truncation", required_argument, NULL, 'F'},
   {"ignore-case", no_argument, NULL, 'f'},
   {"gap-size", required_argument, NULL, 'g'},
@@ -1773,6 +2758,7 @@ static struct option const long_options[] =
   {"right-side-refs", no_argument, NULL, 'R'},
   {"format", required_argument, NULL, 10},
   {"sentence-regexp", required_argument, NULL, 'S'},
+  {"threads", required_argument, NULL, 12},
   {"traditional", no_argument, NULL, 'G'},
   {"typeset-mode", no_argument, NULL, 't'},
   {"width", required_argument, NULL, 'w'},
@@ -1910,6 +2896,16 @@ main (int argc, char **argv)
                                      format_args, format_vals);
           break;
 
+        case 11:
+          spill_buffer_size = xdectoumax (optarg, 1, OFF_T_MAX, "EGkKMmPTYZ0",
+                                          _("invalid buffer size"), 0);
+          break;
+
+        case 12:
+          nthreads = xdectoumax (optarg, 1, SIZE_MAX, "",
+                                 _("invalid number of threads"), 0);
+          break;
+
         case_GETOPT_HELP_CHAR;
 
         case_GETOPT_VERSION_CHAR (PROGRAM_NAME, AUTHORS);
@@ -2020,6 +3016,33 @@ main (int argc, char **argv)
   maximum_word_length = 0;
   reference_max_width = 0;
 
+  if (spill_buffer_size)
+    {
+
+      /* External-memory mode: stream each file through a window,
+         spilling sorted runs of occurrences, then merge the runs.  */
+
+      run_alloc = MIN (spill_buffer_size, SIZE_MAX);
+
+      for (file_index = 0; file_index < number_input_files; file_index++)
+        {
+          study_file_streamed (file_index);
+
+          /* Maintain for each file how many lines has been read so far
+             when its end is reached.  Incrementing the count first is a
+             simple kludge to handle a possible incomplete line at end of
+             file.  */
+
+          total_line_count++;
+          file_line_count[file_index] = total_line_count;
+        }
+
+      fix_output_parameters ();
+      merge_and_output ();
+
+      return EXIT_SUCCESS;
+    }
+
   for (file_index = 0; file_index < number_input_files; file_index++)
     {
       BLOCK *text_buffer = text_buffers + file_index;
@@ -2041,7 +3064,10 @@ main (int argc, char **argv)
 
   sort_found_occurs ();
   fix_output_parameters ();
-  generate_all_output ();
+  if (1 < nthreads)
+    generate_all_output_sharded ();
+  else
+    generate_all_output ();
 
   /* All done.  */
 
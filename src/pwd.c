@@ -138,20 +138,24 @@ nth_parent (size_t n)
   return buf;
 }
 
-/* Determine the basename of the current directory, where DOT_SB is the
-   result of lstat'ing "." and prepend that to the file name in *FILE_NAME.
-   Find the directory entry in '..' that matches the dev/i-node of DOT_SB.
-   Upon success, update *DOT_SB with stat information of '..', chdir to '..',
-   and prepend "/basename" to FILE_NAME.
+/* Determine the basename of the directory open on DOT_FD, where DOT_SB
+   is the result of stat'ing it, and prepend that to the file name in
+   *FILE_NAME.  Find the directory entry in '..' that matches the
+   dev/i-node of DOT_SB.  Upon success, update *DOT_SB with stat
+   information of '..', prepend "/basename" to FILE_NAME, and return a
+   directory stream open on '..'; the caller uses its descriptor to
+   resolve the next level and eventually closes it.  The walk is done
+   entirely with descriptor-relative calls, so the working directory is
+   left alone and each component is resolved exactly once.
    Otherwise, exit with a diagnostic.
-   PARENT_HEIGHT is the number of levels '..' is above the starting directory.
-   The first time this function is called (from the initial directory),
-   PARENT_HEIGHT is 1.  This is solely for diagnostics.
+   PARENT_HEIGHT is the number of levels '..' is above the starting
+   directory.  The first time this function is called (from the initial
+   directory), PARENT_HEIGHT is 1.  This is solely for diagnostics.
    Exit nonzero upon error.  */
 
-static void
-find_dir_entry (struct stat *dot_sb, struct file_name *file_name,
-                size_t parent_height)
+static DIR *
+find_dir_entry (int dot_fd, struct stat *dot_sb,
+                struct file_name *file_name, size_t parent_height)
 {
   DIR *dirp;
   int fd;
@@ -159,17 +163,12 @@ find_dir_entry (struct stat *dot_sb, struct file_name *file_name,
   bool use_lstat;
   bool found;
 
-  dirp = opendir ("..");
-  if (dirp == NULL)
+  fd = openat (dot_fd, "..", O_RDONLY | O_DIRECTORY | O_CLOEXEC);
+  if (fd < 0 || (dirp = fdopendir (fd)) == NULL)
     die (EXIT_FAILURE, errno, _("cannot open directory %s"),
          quote (nth_parent (parent_height)));
 
-  fd = dirfd (dirp);
-  if ((0 <= fd ? fchdir (fd) : chdir ("..")) < 0)
-    die (EXIT_FAILURE, errno, _("failed to chdir to %s"),
-         quote (nth_parent (parent_height)));
-
-  if ((0 <= fd ? fstat (fd, &parent_sb) : stat (".", &parent_sb)) < 0)
+  if (fstat (fd, &parent_sb) < 0)
     die (EXIT_FAILURE, errno, _("failed to stat %s"),
          quote (nth_parent (parent_height)));
 
@@ -204,7 +203,7 @@ find_dir_entry (struct stat *dot_sb, struct file_name *file_name,
 
       if (ino == NOT_AN_INODE_NUMBER || use_lstat)
         {
-          if (lstat (dp->d_name, &ent_sb) < 0)
+          if (fstatat (fd, dp->d_name, &ent_sb, AT_SYMLINK_NOFOLLOW) < 0)
             {
               /* Skip any entry we can't stat.  */
               continue;
@@ -225,13 +224,9 @@ find_dir_entry (struct stat *dot_sb, struct file_name *file_name,
         }
     }
 
-  if (dirp == NULL || closedir (dirp) != 0)
-    {
-      /* Note that this diagnostic serves for both readdir
-         and closedir failures.  */
-      die (EXIT_FAILURE, errno, _("reading directory %s"),
-           quote (nth_parent (parent_height)));
-    }
+  if (dirp == NULL)
+    die (EXIT_FAILURE, errno, _("reading directory %s"),
+         quote (nth_parent (parent_height)));
 
   if ( ! found)
     die (EXIT_FAILURE, 0,
@@ -239,6 +234,7 @@ find_dir_entry (struct stat *dot_sb, struct file_name *file_name,
          quote (nth_parent (parent_height)));
 
   *dot_sb = parent_sb;
+  return dirp;
 }
 
 /* Construct the full, absolute name of the current working
@@ -271,12 +267,15 @@ robust_getcwd (struct file_name *file_name)
   struct dev_ino dev_ino_buf;
   struct dev_ino *root_dev_ino = get_root_dev_ino (&dev_ino_buf);
   struct stat dot_sb;
+  int dot_fd;
+  DIR *dot_dirp = NULL;
 
   if (root_dev_ino == NULL)
     die (EXIT_FAILURE, errno, _("failed to get attributes of %s"),
          quoteaf ("/"));
 
-  if (stat (".", &dot_sb) < 0)
+  dot_fd = open (".", O_RDONLY | O_DIRECTORY | O_CLOEXEC);
+  if (dot_fd < 0 || fstat (dot_fd, &dot_sb) < 0)
     die (EXIT_FAILURE, errno, _("failed to stat %s"), quoteaf ("."));
 
   while (1)
@@ -285,9 +284,24 @@ robust_getcwd (struct file_name *file_name)
       if (SAME_INODE (dot_sb, *root_dev_ino))
         break;
 
-      find_dir_entry (&dot_sb, file_name, height++);
+      DIR *parent_dirp = find_dir_entry (dot_fd, &dot_sb, file_name,
+                                         height++);
+
+      /* Close the level just resolved only after its parent is open,
+         since the parent was opened relative to it.  */
+      if (dot_dirp)
+        closedir (dot_dirp);
+      else
+        close (dot_fd);
+      dot_dirp = parent_dirp;
+      dot_fd = dirfd (dot_dirp);
     }
 
+  if (dot_dirp)
+    closedir (dot_dirp);
+  else
+    close (dot_fd);
+
   /* See if a leading slash is needed; file_name_prepend adds one.  */
   if (file_name->start[0] == '\0')
     file_name_prepend (file_name, "", 0);
@@ -24,7 +24,6 @@
 #include "system.h"
 #include "canonicalize.h"
 #include "error.h"
-#include "areadlink.h"
 
 /* The official name of this program (e.g., no 'g' prefix).  */
 #define PROGRAM_NAME "readlink"
@@ -37,6 +36,34 @@ static bool no_newline;
 /* If true, report error messages.  */
 static bool verbose;
 
+/* Read the value of the symbolic link FNAME into a buffer that is
+   reused across operands, growing it as needed.  Return the
+   NUL-terminated value, or NULL (setting errno) upon error.  Multi-file
+   invocations thereby avoid a malloc/free round trip per operand.  */
+static char *
+readlink_reuse (char const *fname)
+{
+  static char *buf;
+  static size_t buf_len;
+
+  if (buf_len == 0)
+    buf = X2REALLOC (buf, &buf_len);
+
+  while (true)
+    {
+      ssize_t len = readlink (fname, buf, buf_len);
+      if (len < 0)
+        return NULL;
+      if ((size_t) len < buf_len)
+        {
+          buf[len] = '\0';
+          return buf;
+        }
+      /* The value may have been truncated; retry with a bigger buffer.  */
+      buf = X2REALLOC (buf, &buf_len);
+    }
+}
+
 static struct option const longopts[] =
 {
   {"canonicalize", no_argument, NULL, 'f'},
@@ -158,13 +185,14 @@ main (int argc, char **argv)
       char const *fname = argv[optind];
       char *value = (can_mode != -1
                      ? canonicalize_filename_mode (fname, can_mode)
-                     : areadlink_with_size (fname, 63));
+                     : readlink_reuse (fname));
       if (value)
         {
           fputs (value, stdout);
           if (! no_newline)
             putchar (use_nuls ? '\0' : '\n');
-          free (value);
+          if (can_mode != -1)
+            free (value);
         }
       else
         {
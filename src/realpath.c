@@ -17,15 +17,19 @@
 /* Written by Pádraig Brady.  */
 
 #include <config.h>
+#include <assert.h>
 #include <getopt.h>
 #include <stdio.h>
 #include <sys/types.h>
 
 #include "system.h"
+#include "argv-iter.h"
 #include "canonicalize.h"
 #include "die.h"
 #include "error.h"
+#include "hash.h"
 #include "relpath.h"
+#include "xstrndup.h"
 
 /* The official name of this program (e.g., no 'g' prefix).  */
 #define PROGRAM_NAME "realpath"
@@ -34,7 +38,8 @@
 
 enum
 {
-  RELATIVE_TO_OPTION = CHAR_MAX + 1,
+  FILES0_FROM_OPTION = CHAR_MAX + 1,
+  RELATIVE_TO_OPTION,
   RELATIVE_BASE_OPTION
 };
 
@@ -48,6 +53,7 @@ static struct option const longopts[] =
 {
   {"canonicalize-existing", no_argument, NULL, 'e'},
   {"canonicalize-missing", no_argument, NULL, 'm'},
+  {"files0-from", required_argument, NULL, FILES0_FROM_OPTION},
   {"relative-to", required_argument, NULL, RELATIVE_TO_OPTION},
   {"relative-base", required_argument, NULL, RELATIVE_BASE_OPTION},
   {"quiet", no_argument, NULL, 'q'},
@@ -68,7 +74,10 @@ usage (int status)
     emit_try_help ();
   else
     {
-      printf (_("Usage: %s [OPTION]... FILE...\n"), program_name);
+      printf (_("\
+Usage: %s [OPTION]... FILE...\n\
+  or:  %s [OPTION]... --files0-from=F\n\
+"), program_name, program_name);
       fputs (_("\
 Print the resolved absolute file name;\n\
 all but the last component must exist\n\
@@ -78,6 +87,9 @@ all but the last component must exist\n\
   -e, --canonicalize-existing  all components of the path must exist\n\
   -m, --canonicalize-missing   no path components need exist or be a directory\
 \n\
+      --files0-from=F          resolve the NUL-terminated file names\n\
+                                 specified in file F;\n\
+                                 if F is -, then read names from standard input\n\
   -L, --logical                resolve '..' components before symlinks\n\
   -P, --physical               resolve symlinks as encountered (default)\n\
   -q, --quiet                  suppress most error messages\n\
@@ -109,6 +121,136 @@ realpath_canon (char const *fname, int can_mode)
   return can_fname;
 }
 
+/* Cache of canonicalized directories, keyed on the directory text of
+   earlier operands, so operands sharing a parent directory need not
+   re-walk it component by component.  Entries are revalidated with one
+   stat() comparing device and inode before being trusted.  */
+
+struct dir_cache_entry
+{
+  char *dir;			/* Directory as written (hash key).  */
+  char *canon;			/* Its canonical form.  */
+  dev_t dev;
+  ino_t ino;
+};
+
+static Hash_table *dir_cache;
+
+static size_t
+dir_cache_hasher (void const *x, size_t table_size)
+{
+  struct dir_cache_entry const *e = x;
+  size_t h = 0;
+  for (char const *p = e->dir; *p; p++)
+    h = h * 31 + to_uchar (*p);
+  return h % table_size;
+}
+
+static bool
+dir_cache_comparator (void const *x, void const *y)
+{
+  struct dir_cache_entry const *a = x;
+  struct dir_cache_entry const *b = y;
+  return STREQ (a->dir, b->dir);
+}
+
+/* Return the canonical form of FNAME as realpath_canon would, but
+   resolve the directory part through DIR_CACHE where possible, so a
+   hit costs one revalidating stat() instead of an lstat() and
+   readlink() walk of every shared ancestor.  Only physical resolution
+   of existing parents is cacheable; other modes, and operands the
+   cache cannot represent, fall through to realpath_canon.  */
+
+static char *
+canonicalize_cached (char const *fname, int can_mode)
+{
+  if (logical || (can_mode & CAN_NOLINKS)
+      || (can_mode & CAN_MODE_MASK) == CAN_MISSING || !dir_cache)
+    return realpath_canon (fname, can_mode);
+
+  /* Split FNAME into directory and final component, falling back for
+     shapes where the split does not mirror canonicalization: an empty
+     or trailing-slash final component, or one of '.' and '..'.  */
+  size_t dlen = dir_len (fname);
+  char const *base = fname + dlen;
+  while (ISSLASH (*base))
+    base++;
+  size_t blen = strlen (base);
+  if (blen == 0 || ISSLASH (base[blen - 1])
+      || STREQ (base, ".") || STREQ (base, ".."))
+    return realpath_canon (fname, can_mode);
+
+  char *dir = dlen ? xstrndup (fname, dlen) : xstrdup (".");
+  struct dir_cache_entry key;
+  key.dir = dir;
+  struct dir_cache_entry *ent = hash_lookup (dir_cache, &key);
+
+  struct stat dir_st;
+  if (ent)
+    {
+      if (stat (dir, &dir_st) != 0
+          || dir_st.st_dev != ent->dev || dir_st.st_ino != ent->ino)
+        {
+          /* The directory was replaced since it was cached.  */
+          hash_delete (dir_cache, ent);
+          free (ent->dir);
+          free (ent->canon);
+          free (ent);
+          ent = NULL;
+        }
+    }
+
+  if (!ent)
+    {
+      char *canon = canonicalize_filename_mode (dir, CAN_EXISTING);
+      if (!canon || stat (dir, &dir_st) != 0)
+        {
+          /* Let the uncached path produce the proper diagnostic.  */
+          free (canon);
+          free (dir);
+          return realpath_canon (fname, can_mode);
+        }
+      ent = xmalloc (sizeof *ent);
+      ent->dir = dir;
+      ent->canon = canon;
+      ent->dev = dir_st.st_dev;
+      ent->ino = dir_st.st_ino;
+      if (hash_insert (dir_cache, ent) == NULL)
+        xalloc_die ();
+    }
+  else
+    free (dir);
+
+  /* Join the canonical directory with the final component.  */
+  size_t clen = strlen (ent->canon);
+  char *can_fname = xmalloc (clen + blen + 2);
+  char *p = stpcpy (can_fname, ent->canon);
+  if (p[-1] != '/')
+    *p++ = '/';
+  p = stpcpy (p, base);
+
+  struct stat st;
+  if (lstat (can_fname, &st) == 0)
+    {
+      if (S_ISLNK (st.st_mode))
+        {
+          /* The final component is a symlink; resolve it the long way,
+             starting from the already canonical parent.  */
+          char *resolved = realpath_canon (can_fname, can_mode);
+          free (can_fname);
+          return resolved;
+        }
+      return can_fname;
+    }
+  if (errno == ENOENT && (can_mode & CAN_MODE_MASK) == CAN_ALL_BUT_LAST)
+    return can_fname;
+
+  int saved_errno = errno;
+  free (can_fname);
+  errno = saved_errno;
+  return NULL;
+}
+
 /* Test whether canonical prefix is parent or match of path.  */
 static bool _GL_ATTRIBUTE_PURE
 path_prefix (char const *prefix, char const *path)
@@ -149,7 +291,7 @@ isdir (char const *path)
 static bool
 process_path (char const *fname, int can_mode)
 {
-  char *can_fname = realpath_canon (fname, can_mode);
+  char *can_fname = canonicalize_cached (fname, can_mode);
   if (!can_fname)
     {
       if (verbose)
@@ -176,6 +318,7 @@ main (int argc, char **argv)
   int can_mode = CAN_ALL_BUT_LAST;
   char const *relative_to = NULL;
   char const *relative_base = NULL;
+  char const *files_from = NULL;
 
   initialize_main (&argc, &argv);
   set_program_name (argv[0]);
@@ -218,6 +361,9 @@ main (int argc, char **argv)
         case 'z':
           use_nuls = true;
           break;
+        case FILES0_FROM_OPTION:
+          files_from = optarg;
+          break;
         case RELATIVE_TO_OPTION:
           relative_to = optarg;
           break;
@@ -231,11 +377,37 @@ main (int argc, char **argv)
         }
     }
 
-  if (optind >= argc)
+  struct argv_iterator *ai;
+  if (files_from)
     {
-      error (0, 0, _("missing operand"));
-      usage (EXIT_FAILURE);
+      /* When using --files0-from=F, you may not specify any files
+         on the command-line.  */
+      if (optind < argc)
+        {
+          error (0, 0, _("extra operand %s"), quote (argv[optind]));
+          fprintf (stderr, "%s\n",
+                   _("file operands cannot be combined with --files0-from"));
+          usage (EXIT_FAILURE);
+        }
+
+      if (! (STREQ (files_from, "-") || freopen (files_from, "r", stdin)))
+        die (EXIT_FAILURE, errno, _("cannot open %s for reading"),
+             quoteaf (files_from));
+
+      ai = argv_iter_init_stream (stdin);
     }
+  else
+    {
+      if (optind >= argc)
+        {
+          error (0, 0, _("missing operand"));
+          usage (EXIT_FAILURE);
+        }
+
+      ai = argv_iter_init_argv (argv + optind);
+    }
+  if (!ai)
+    xalloc_die ();
 
   if (relative_base && !relative_to)
     relative_to = relative_base;
@@ -270,8 +442,43 @@ main (int argc, char **argv)
         }
     }
 
-  for (; optind < argc; ++optind)
-    ok &= process_path (argv[optind], can_mode);
+  dir_cache = hash_initialize (17, NULL, dir_cache_hasher,
+                               dir_cache_comparator, NULL);
+
+  while (true)
+    {
+      enum argv_iter_err ai_err;
+      char *file_name = argv_iter (ai, &ai_err);
+      if (!file_name)
+        {
+          if (ai_err == AI_ERR_EOF)
+            break;
+          switch (ai_err)
+            {
+            case AI_ERR_READ:
+              error (0, errno, _("%s: read error"), quotef (files_from));
+              ok = false;
+              break;
+            case AI_ERR_MEM:
+              xalloc_die ();
+            default:
+              assert (!"unexpected error code from argv_iter");
+            }
+          break;
+        }
+      if (files_from && STREQ (files_from, "-") && STREQ (file_name, "-"))
+        {
+          /* Give a better diagnostic in an unusual case:
+             printf - | realpath --files0-from=- */
+          error (0, 0, _("when reading file names from stdin, "
+                         "no file name of %s allowed"),
+                 quoteaf (file_name));
+          ok = false;
+          continue;
+        }
+      ok &= process_path (file_name, can_mode);
+    }
+  argv_iter_free (ai);
 
   return ok ? EXIT_SUCCESS : EXIT_FAILURE;
 }
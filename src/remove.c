@@ -17,6 +17,7 @@
 /* Extracted from rm.c, librarified, then rewritten twice by Jim Meyering.  */
 
 #include <config.h>
+#include <pthread.h>
 #include <stdio.h>
 #include <sys/types.h>
 #include <assert.h>
@@ -26,6 +27,7 @@
 #include "file-type.h"
 #include "filenamecat.h"
 #include "ignore-value.h"
+#include "probes.h"
 #include "remove.h"
 #include "root-dev-ino.h"
 #include "write-any-file.h"
@@ -51,7 +53,11 @@ enum Prompt_action
 
 /* D_TYPE(D) is the type of directory entry D if known, DT_UNKNOWN
    otherwise.  */
-#if ! HAVE_STRUCT_DIRENT_D_TYPE
+#if HAVE_STRUCT_DIRENT_D_TYPE
+# define D_TYPE(d) ((d)->d_type)
+#else
+# define D_TYPE(d) DT_UNKNOWN
+
 /* Any int values will do here, so long as they're distinct.
    Undef any existing macros out of the way.  */
 # undef DT_UNKNOWN
@@ -369,6 +375,8 @@ excise (FTS *fts, FTSENT *ent, struct rm_options const *x, bool is_dir)
   int flag = is_dir ? AT_REMOVEDIR : 0;
   if (unlinkat (fts->fts_cwd_fd, ent->fts_accpath, flag) == 0)
     {
+      if (is_dir)
+        COREUTILS_PROBE1 (rm_dir_done, ent->fts_path);
       if (x->verbose)
         {
           printf ((is_dir
@@ -408,6 +416,156 @@ excise (FTS *fts, FTSENT *ent, struct rm_options const *x, bool is_dir)
   return RM_ERROR;
 }
 
+/* Whether the non-directory entries of directories may be unlinked in
+   bulk, ahead of the traversal: only in recursive runs that cannot
+   prompt, so that skipping the per-entry prompt logic cannot change
+   behavior.  The bulk pass unlinks in readdir order, just as the
+   traversal would, so --verbose output is unchanged too (unless
+   --parallel workers reorder it).  --one-file-system needs no check
+   here: preunlink_entries verifies the device of each directory it
+   opens, so the pass stays within the boundary the option promises
+   even though fts reports a mount point once before refusing to
+   descend.  */
+static bool
+bulk_unlink_ok (struct rm_options const *x)
+{
+  return (x->recursive
+          && (x->interactive == RMI_NEVER
+              || (x->interactive == RMI_SOMETIMES && ! x->stdin_tty)));
+}
+
+/* A worker pool unlinking the non-directory entries of one directory.
+   Failures are not diagnosed here: an entry that cannot be unlinked is
+   simply left in place for the ordinary traversal, which prompts and
+   reports as usual.  */
+struct unlink_pool
+{
+  pthread_mutex_t lock;
+  int dirfd;
+  char **names;			/* Entry names, relative to DIRFD.  */
+  size_t n_names;
+  size_t next;			/* Index of the next unclaimed entry.  */
+  char const *dir_path;		/* The directory, for --verbose.  */
+  bool verbose;
+};
+
+/* Claim entries from POOL_ARG and unlink each until none remain.  */
+static void *
+unlink_thread (void *pool_arg)
+{
+  struct unlink_pool *pool = pool_arg;
+
+  while (true)
+    {
+      pthread_mutex_lock (&pool->lock);
+      size_t i = pool->next;
+      if (i < pool->n_names)
+        pool->next++;
+      pthread_mutex_unlock (&pool->lock);
+      if (pool->n_names <= i)
+        return NULL;
+
+      if (unlinkat (pool->dirfd, pool->names[i], 0) == 0 && pool->verbose)
+        {
+          char *full_name = file_name_concat (pool->dir_path,
+                                              pool->names[i], NULL);
+          /* quoteaf uses static storage, so quote and print under the
+             lock; entries may be reported in any order.  */
+          pthread_mutex_lock (&pool->lock);
+          printf (_("removed %s\n"), quoteaf (full_name));
+          pthread_mutex_unlock (&pool->lock);
+          free (full_name);
+        }
+    }
+}
+
+/* Unlink the non-directory entries of the directory ENT, which the
+   traversal is about to descend into, in one pass over its contents --
+   with up to X->nthreads threads under --parallel.  This saves the
+   per-entry cost of the traversal machinery for the common bulk of a
+   tree.  The traversal then sees only what remains: subdirectories,
+   entries of unknown type, and any entry that could not be unlinked
+   here.  */
+static void
+preunlink_entries (FTS *fts, FTSENT *ent, struct rm_options const *x)
+{
+  int dirfd = openat (fts->fts_cwd_fd, ent->fts_accpath,
+                      O_RDONLY | O_DIRECTORY | O_NOFOLLOW);
+  if (dirfd < 0)
+    return;
+
+  /* With --one-file-system, fts reports a mount point at FTS_D and
+     only refuses to descend afterward, so never touch the entries of
+     a directory on another device; the FTS_DP handling diagnoses and
+     skips it.  fstat the descriptor actually opened, not fts_statp,
+     lest a mount race between fts's stat and our open slip through.  */
+  if (x->one_file_system)
+    {
+      struct stat st;
+      if (fstat (dirfd, &st) != 0 || st.st_dev != fts->fts_dev)
+        {
+          close (dirfd);
+          return;
+        }
+    }
+
+  DIR *dirp = fdopendir (dirfd);
+  if (! dirp)
+    {
+      close (dirfd);
+      return;
+    }
+
+  char **names = NULL;
+  size_t n_names = 0;
+  size_t n_alloc = 0;
+  struct dirent const *dp;
+  while ((dp = readdir (dirp)))
+    {
+      if (D_TYPE (dp) == DT_DIR || D_TYPE (dp) == DT_UNKNOWN
+          || dot_or_dotdot (dp->d_name))
+        continue;
+      if (n_names == n_alloc)
+        names = x2nrealloc (names, &n_alloc, sizeof *names);
+      names[n_names++] = xstrdup (dp->d_name);
+    }
+
+  if (n_names)
+    {
+      struct unlink_pool pool;
+      pool.dirfd = dirfd;
+      pool.names = names;
+      pool.n_names = n_names;
+      pool.next = 0;
+      pool.dir_path = ent->fts_path;
+      pool.verbose = x->verbose;
+      pthread_mutex_init (&pool.lock, NULL);
+
+      /* Spawn up to nthreads workers, counting this thread, which
+         joins in below; if thread creation fails, the survivors and
+         this thread simply drain the whole queue.  */
+      size_t nworkers = MIN (x->nthreads, n_names) - 1;
+      pthread_t *threads = xnmalloc (nworkers, sizeof *threads);
+      size_t nstarted = 0;
+      while (nstarted < nworkers
+             && pthread_create (&threads[nstarted], NULL,
+                                unlink_thread, &pool) == 0)
+        nstarted++;
+
+      unlink_thread (&pool);
+
+      for (size_t i = 0; i < nstarted; i++)
+        pthread_join (threads[i], NULL);
+      free (threads);
+      pthread_mutex_destroy (&pool.lock);
+
+      for (size_t i = 0; i < n_names; i++)
+        free (names[i]);
+    }
+  free (names);
+  closedir (dirp);
+}
+
 /* This function is called once for every file system object that fts
    encounters.  fts performs a depth-first traversal.
    A directory is usually processed twice, first with fts_info == FTS_D,
@@ -509,6 +667,8 @@ rm_fts (FTS *fts, FTSENT *ent, struct rm_options const *x)
             if (s == RM_OK)
               fts_skip_tree (fts, ent);
           }
+        else if (s == RM_OK && bulk_unlink_ok (x))
+          preunlink_entries (fts, ent, x);
 
         if (s != RM_OK)
           {
@@ -588,7 +748,8 @@ rm (char *const *file, struct rm_options const *x)
       if (x->one_file_system)
         bit_flags |= FTS_XDEV;
 
-      FTS *fts = xfts_open (file, bit_flags, NULL);
+      FTS *fts = xfts_open (file, bit_flags,
+                            x->inode_sort ? xfts_compare_ino : NULL);
 
       while (1)
         {
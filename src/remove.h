@@ -34,6 +34,9 @@ struct rm_options
   /* If true, ignore nonexistent files.  */
   bool ignore_missing_files;
 
+  /* If true, visit each directory's entries in inode order.  */
+  bool inode_sort;
+
   /* If true, query the user about whether to remove each file.  */
   enum rm_interactive interactive;
 
@@ -66,6 +69,11 @@ struct rm_options
   /* If true, display the name of each file removed.  */
   bool verbose;
 
+  /* With --recursive, unlink the non-directory entries of each
+     directory with up to this many worker threads (rm --parallel).
+     1 means remove every entry on the main thread.  */
+  size_t nthreads;
+
   /* If true, treat the failure by the rm function to restore the
      current working directory as a fatal error.  I.e., if this field
      is true and the rm function cannot restore cwd, it must exit with
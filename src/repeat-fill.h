@@ -0,0 +1,56 @@
+/* Buffer sizing and filling for repeatedly written output
+   Copyright (C) 2026 Free Software Foundation, Inc.
+
+   This program is free software: you can redistribute it and/or modify
+   it under the terms of the GNU General Public License as published by
+   the Free Software Foundation, either version 3 of the License, or
+   (at your option) any later version.
+
+   This program is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU General Public License for more details.
+
+   You should have received a copy of the GNU General Public License
+   along with this program.  If not, see <https://www.gnu.org/licenses/>.  */
+
+/* Include this file _after_ system headers if possible.  */
+
+#include "ioblksize.h"
+
+/* Return the buffer size to use for output written repeatedly to FD:
+   at least io_blksize() for the underlying device, and when FD is a
+   pipe whose capacity can be determined, no smaller than that
+   capacity, so that a drained pipe is refilled with one write.  */
+static inline size_t
+repeat_fill_bufsize (int fd)
+{
+  struct stat st;
+  if (fstat (fd, &st) < 0)
+    return IO_BUFSIZE;
+  size_t blksize = io_blksize (st);
+#ifdef F_GETPIPE_SZ
+  if (S_ISFIFO (st.st_mode))
+    {
+      int pipe_sz = fcntl (fd, F_GETPIPE_SZ);
+      if (0 < pipe_sz)
+        blksize = MAX (blksize, (size_t) pipe_sz);
+    }
+#endif
+  return blksize;
+}
+
+/* BUF, of size BUFALLOC, starts with one copy of a repeating unit of
+   BUFUSED bytes.  Replicate the unit into the rest of BUF as often as
+   it fits, and return the number of bytes then in use.  */
+static inline size_t
+repeat_fill (char *buf, size_t bufused, size_t bufalloc)
+{
+  size_t copysize = bufused;
+  for (size_t copies = bufalloc / copysize; --copies; )
+    {
+      memcpy (buf + bufused, buf, copysize);
+      bufused += copysize;
+    }
+  return bufused;
+}
@@ -30,6 +30,7 @@
 #include "error.h"
 #include "remove.h"
 #include "root-dev-ino.h"
+#include "xdectoint.h"
 #include "yesno.h"
 #include "priv-set.h"
 
@@ -46,9 +47,11 @@
    non-character as a pseudo short option, starting with CHAR_MAX + 1.  */
 enum
 {
-  INTERACTIVE_OPTION = CHAR_MAX + 1,
+  INODE_SORT_OPTION = CHAR_MAX + 1,
+  INTERACTIVE_OPTION,
   ONE_FILE_SYSTEM,
   NO_PRESERVE_ROOT,
+  PARALLEL_OPTION,
   PRESERVE_ROOT,
   PRESUME_INPUT_TTY_OPTION
 };
@@ -63,10 +66,12 @@ enum interactive_type
 static struct option const long_opts[] =
 {
   {"force", no_argument, NULL, 'f'},
+  {"inode-sort", no_argument, NULL, INODE_SORT_OPTION},
   {"interactive", optional_argument, NULL, INTERACTIVE_OPTION},
 
   {"one-file-system", no_argument, NULL, ONE_FILE_SYSTEM},
   {"no-preserve-root", no_argument, NULL, NO_PRESERVE_ROOT},
+  {"parallel", required_argument, NULL, PARALLEL_OPTION},
   {"preserve-root", optional_argument, NULL, PRESERVE_ROOT},
 
   /* This is solely for testing.  Do not document.  */
@@ -136,6 +141,10 @@ Remove (unlink) the FILE(s).\n\
 \n\
   -f, --force           ignore nonexistent files and arguments, never prompt\n\
   -i                    prompt before every removal\n\
+"), stdout);
+      fputs (_("\
+      --inode-sort      with -r, process each directory's entries in\n\
+                          inode order\n\
 "), stdout);
       fputs (_("\
   -I                    prompt once before removing more than three files, or\n\
@@ -148,6 +157,10 @@ Remove (unlink) the FILE(s).\n\
       --one-file-system  when removing a hierarchy recursively, skip any\n\
                           directory that is on a file system different from\n\
                           that of the corresponding command line argument\n\
+"), stdout);
+      fputs (_("\
+      --parallel=N      with -r, unlink the files within each directory\n\
+                          with up to N threads\n\
 "), stdout);
       fputs (_("\
       --no-preserve-root  do not treat '/' specially\n\
@@ -191,6 +204,7 @@ static void
 rm_option_init (struct rm_options *x)
 {
   x->ignore_missing_files = false;
+  x->inode_sort = false;
   x->interactive = RMI_SOMETIMES;
   x->one_file_system = false;
   x->remove_empty_directories = false;
@@ -199,6 +213,7 @@ rm_option_init (struct rm_options *x)
   x->preserve_all_root = false;
   x->stdin_tty = isatty (STDIN_FILENO);
   x->verbose = false;
+  x->nthreads = 1;
 
   /* Since this program exits immediately after calling 'rm', rm need not
      expend unnecessary effort to preserve the initial working directory.  */
@@ -257,6 +272,15 @@ main (int argc, char **argv)
           x.recursive = true;
           break;
 
+        case PARALLEL_OPTION:
+          x.nthreads = xdectoumax (optarg, 1, SIZE_MAX, "",
+                                   _("invalid number of threads"), 0);
+          break;
+
+        case INODE_SORT_OPTION:
+          x.inode_sort = true;
+          break;
+
         case INTERACTIVE_OPTION:
           {
             int i;
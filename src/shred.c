@@ -76,6 +76,7 @@
 #include <config.h>
 
 #include <getopt.h>
+#include <pthread.h>
 #include <stdio.h>
 #include <assert.h>
 #include <setjmp.h>
@@ -96,6 +97,11 @@
 #include "renameatu.h"
 #include "stat-size.h"
 
+#if USE_AVX2_CHACHA
+# include <cpuid.h>
+# include "chacha-simd.h"
+#endif
+
 /* Default number of times to overwrite.  */
 enum { DEFAULT_PASSES = 3 };
 
@@ -142,9 +148,13 @@ struct Options
    non-character as a pseudo short option, starting with CHAR_MAX + 1.  */
 enum
 {
-  RANDOM_SOURCE_OPTION = CHAR_MAX + 1
+  RANDOM_SOURCE_OPTION = CHAR_MAX + 1,
+  THREADS_OPTION
 };
 
+/* Number of files to wipe concurrently.  */
+static size_t nthreads = 1;
+
 static struct option const long_opts[] =
 {
   {"exact", no_argument, NULL, 'x'},
@@ -153,6 +163,7 @@ static struct option const long_opts[] =
   {"size", required_argument, NULL, 's'},
   {"random-source", required_argument, NULL, RANDOM_SOURCE_OPTION},
   {"remove", optional_argument, NULL, 'u'},
+  {"threads", required_argument, NULL, THREADS_OPTION},
   {"verbose", no_argument, NULL, 'v'},
   {"zero", no_argument, NULL, 'z'},
   {GETOPT_HELP_OPTION_DECL},
@@ -188,6 +199,7 @@ If FILE is -, shred standard output.\n\
       fputs (_("\
   -u             deallocate and remove file after overwriting\n\
       --remove[=HOW]  like -u but give control on HOW to delete;  See below\n\
+      --threads=N  wipe up to N FILEs concurrently\n\
   -v, --verbose  show progress\n\
   -x, --exact    do not round file sizes up to the next full block;\n\
                    this is the default for non-regular files\n\
@@ -382,6 +394,244 @@ known (off_t size)
   return 0 <= size;
 }
 
+/*
+ * Random passes are written from a ChaCha keystream, keyed for each
+ * pass from the randomness source.  Expanding a small seed this way
+ * is much faster than pulling every output byte from the source's
+ * own generator, and lets large buffers be filled in counter mode.
+ * The state is the usual 16 words: four constants, eight words of
+ * key, a 64-bit block counter, and a 64-bit nonce.
+ */
+enum { CHACHA_STATE_WORDS = 16 };
+enum { CHACHA_BLOCK_SIZE = 64 };
+
+#if USE_AVX2_CHACHA
+/* Whether the CPU supports the AVX2 keystream kernel;
+   -1 before the first probe.  */
+static int have_avx2 = -1;
+
+static int
+avx2_supported (void)
+{
+  unsigned int eax = 0, ebx = 0, ecx = 0, edx = 0;
+
+  if (!__get_cpuid_count (7, 0, &eax, &ebx, &ecx, &edx))
+    return 0;
+
+  return (ebx & bit_AVX2) != 0;
+}
+#endif
+
+/* Read the little-endian word at P.  */
+static uint32_t
+le32get (unsigned char const *p)
+{
+  return p[0] | (uint32_t) p[1] << 8
+         | (uint32_t) p[2] << 16 | (uint32_t) p[3] << 24;
+}
+
+/* Serializes the shared randomness source across wipe threads.  */
+static pthread_mutex_t rand_lock = PTHREAD_MUTEX_INITIALIZER;
+
+/* Key a fresh ChaCha STATE from the randomness source S.  */
+static void
+chacha_init (uint32_t *state, struct randread_source *s)
+{
+  unsigned char seed[40];
+
+  pthread_mutex_lock (&rand_lock);
+  randread (s, seed, sizeof seed);
+  pthread_mutex_unlock (&rand_lock);
+  state[0] = 0x61707865;
+  state[1] = 0x3320646e;
+  state[2] = 0x79622d32;
+  state[3] = 0x6b206574;
+  for (int i = 0; i < 8; i++)
+    state[4 + i] = le32get (seed + 4 * i);
+  state[12] = 0;
+  state[13] = 0;
+  state[14] = le32get (seed + 32);
+  state[15] = le32get (seed + 36);
+}
+
+/* Write one 64-byte keystream block for STATE to OUT,
+   leaving the block counter unchanged.  */
+static void
+chacha_block (uint32_t const *state, unsigned char *out)
+{
+  uint32_t x[CHACHA_STATE_WORDS];
+  memcpy (x, state, sizeof x);
+
+#define CHACHA_ROL(v, n) (((v) << (n)) | ((v) >> (32 - (n))))
+#define CHACHA_QROUND(a, b, c, d)                       \
+  do                                                    \
+    {                                                   \
+      x[a] += x[b]; x[d] = CHACHA_ROL (x[d] ^ x[a], 16);\
+      x[c] += x[d]; x[b] = CHACHA_ROL (x[b] ^ x[c], 12);\
+      x[a] += x[b]; x[d] = CHACHA_ROL (x[d] ^ x[a], 8); \
+      x[c] += x[d]; x[b] = CHACHA_ROL (x[b] ^ x[c], 7); \
+    }                                                   \
+  while (0)
+
+  for (int r = 0; r < 20; r += 2)
+    {
+      CHACHA_QROUND (0, 4, 8, 12);
+      CHACHA_QROUND (1, 5, 9, 13);
+      CHACHA_QROUND (2, 6, 10, 14);
+      CHACHA_QROUND (3, 7, 11, 15);
+      CHACHA_QROUND (0, 5, 10, 15);
+      CHACHA_QROUND (1, 6, 11, 12);
+      CHACHA_QROUND (2, 7, 8, 13);
+      CHACHA_QROUND (3, 4, 9, 14);
+    }
+
+  for (int i = 0; i < CHACHA_STATE_WORDS; i++)
+    {
+      uint32_t v = x[i] + state[i];
+      out[4 * i] = v;
+      out[4 * i + 1] = v >> 8;
+      out[4 * i + 2] = v >> 16;
+      out[4 * i + 3] = v >> 24;
+    }
+}
+
+/* Fill BUF with NBLOCKS keystream blocks from STATE,
+   advancing its block counter.  */
+static void
+chacha_fill (uint32_t *state, unsigned char *buf, size_t nblocks)
+{
+  uint64_t ctr = state[12] | ((uint64_t) state[13] << 32);
+
+#if USE_AVX2_CHACHA
+  if (have_avx2 < 0)
+    have_avx2 = avx2_supported ();
+
+  if (have_avx2)
+    {
+      size_t n = nblocks & ~(size_t) 1;
+      chacha_blocks_avx2 (state, n, buf);
+      buf += n * CHACHA_BLOCK_SIZE;
+      nblocks -= n;
+      ctr += n;
+      state[12] = ctr;
+      state[13] = ctr >> 32;
+    }
+#endif
+
+  for (; nblocks; nblocks--, ctr++, buf += CHACHA_BLOCK_SIZE)
+    {
+      state[12] = ctr;
+      state[13] = ctr >> 32;
+      chacha_block (state, buf);
+    }
+  state[12] = ctr;
+  state[13] = ctr >> 32;
+}
+
+/*
+ * Double-buffered keystream production for random passes: a filler
+ * thread generates the next buffer of random data while the previous
+ * one drains to the device, so generation overlaps the writes instead
+ * of alternating with them.
+ */
+struct keystream_gen
+{
+  uint32_t state[CHACHA_STATE_WORDS];	/* Owned by the filler thread */
+  void *mem[2];				/* Buffer allocations */
+  unsigned char *buf[2];		/* Their page-aligned starts */
+  size_t nblocks;			/* Keystream blocks per refill */
+  bool ready[2];			/* Whether buf[i] holds fresh data */
+  bool done;				/* Tell the filler to exit */
+  int cur;				/* Next buffer for the consumer */
+  pthread_mutex_t lock;
+  pthread_cond_t change;
+  pthread_t thread;
+};
+
+static void *
+keystream_gen_thread (void *arg)
+{
+  struct keystream_gen *g = arg;
+  int i = 0;
+
+  pthread_mutex_lock (&g->lock);
+  while (! g->done)
+    {
+      if (g->ready[i])
+        {
+          pthread_cond_wait (&g->change, &g->lock);
+          continue;
+        }
+      pthread_mutex_unlock (&g->lock);
+      chacha_fill (g->state, g->buf[i], g->nblocks);
+      pthread_mutex_lock (&g->lock);
+      g->ready[i] = true;
+      pthread_cond_signal (&g->change);
+      i = !i;
+    }
+  pthread_mutex_unlock (&g->lock);
+  return NULL;
+}
+
+/* Key G from S and start its filler thread, with two buffers of
+   BUFSIZE bytes aligned to PAGE_SIZE for direct I/O.  */
+static void
+keystream_gen_start (struct keystream_gen *g, struct randread_source *s,
+                     size_t bufsize, size_t page_size)
+{
+  chacha_init (g->state, s);
+  for (int i = 0; i < 2; i++)
+    {
+      g->mem[i] = xmalloc (page_size - 1 + bufsize);
+      g->buf[i] = ptr_align (g->mem[i], page_size);
+      g->ready[i] = false;
+    }
+  g->nblocks = bufsize / CHACHA_BLOCK_SIZE;
+  g->done = false;
+  g->cur = 0;
+  pthread_mutex_init (&g->lock, NULL);
+  pthread_cond_init (&g->change, NULL);
+  int err = pthread_create (&g->thread, NULL, keystream_gen_thread, g);
+  if (err)
+    die (EXIT_FAILURE, err, _("failed to create keystream thread"));
+}
+
+/* Return the next full buffer of keystream, waiting for the filler
+   to finish it if need be.  */
+static unsigned char *
+keystream_gen_claim (struct keystream_gen *g)
+{
+  pthread_mutex_lock (&g->lock);
+  while (! g->ready[g->cur])
+    pthread_cond_wait (&g->change, &g->lock);
+  pthread_mutex_unlock (&g->lock);
+  return g->buf[g->cur];
+}
+
+/* Hand the claimed buffer back to the filler for a refill.  */
+static void
+keystream_gen_release (struct keystream_gen *g)
+{
+  pthread_mutex_lock (&g->lock);
+  g->ready[g->cur] = false;
+  g->cur = !g->cur;
+  pthread_cond_signal (&g->change);
+  pthread_mutex_unlock (&g->lock);
+}
+
+/* Stop G's filler thread and free its buffers.  */
+static void
+keystream_gen_stop (struct keystream_gen *g)
+{
+  pthread_mutex_lock (&g->lock);
+  g->done = true;
+  pthread_cond_signal (&g->change);
+  pthread_mutex_unlock (&g->lock);
+  pthread_join (g->thread, NULL);
+  free (g->mem[0]);
+  free (g->mem[1]);
+}
+
 /*
  * Do pass number K of N, writing *SIZEP bytes of the given pattern TYPE
  * to the file descriptor FD.  K and N are passed in only for verbose
@@ -409,16 +659,22 @@ dopass (int fd, struct stat const *st, char const *qname, off_t *sizep,
   size_t page_size = getpagesize ();
 #define PERIODIC_OUTPUT_SIZE (60 * 1024)
 #define NONPERIODIC_OUTPUT_SIZE (64 * 1024)
+#define RANDOM_OUTPUT_SIZE (1024 * 1024)
   verify (PERIODIC_OUTPUT_SIZE % 3 == 0);
-  size_t output_size = periodic_pattern (type)
-                       ? PERIODIC_OUTPUT_SIZE : NONPERIODIC_OUTPUT_SIZE;
+  verify (RANDOM_OUTPUT_SIZE % CHACHA_BLOCK_SIZE == 0);
+  size_t output_size = (periodic_pattern (type) ? PERIODIC_OUTPUT_SIZE
+                        : type < 0 ? RANDOM_OUTPUT_SIZE
+                        : NONPERIODIC_OUTPUT_SIZE);
 #define PAGE_ALIGN_SLOP (page_size - 1)                /* So directio works */
 #define FILLPATTERN_SIZE (((output_size + 2) / 3) * 3) /* Multiple of 3 */
 #define PATTERNBUF_SIZE (PAGE_ALIGN_SLOP + FILLPATTERN_SIZE)
-  void *fill_pattern_mem = xmalloc (PATTERNBUF_SIZE);
-  unsigned char *pbuf = ptr_align (fill_pattern_mem, page_size);
+  void *fill_pattern_mem = type < 0 ? NULL : xmalloc (PATTERNBUF_SIZE);
+  unsigned char *pbuf =
+    fill_pattern_mem ? ptr_align (fill_pattern_mem, page_size) : NULL;
 
   char pass_string[PASS_NAME_SIZE];	/* Name of current pass */
+  struct keystream_gen gen;		/* Random pass keystream filler */
+  bool gen_running = false;
   bool write_error = false;
   bool other_error = false;
 
@@ -449,6 +705,8 @@ dopass (int fd, struct stat const *st, char const *qname, off_t *sizep,
     }
   else
     {
+      keystream_gen_start (&gen, s, output_size, page_size);
+      gen_running = true;
       passname (0, pass_string);
     }
 
@@ -473,12 +731,15 @@ dopass (int fd, struct stat const *st, char const *qname, off_t *sizep,
           if (!lim)
             break;
         }
+      /* A short final LIM writes a prefix of the full buffer;
+         the rest of its keystream is simply discarded.  */
+      unsigned char *wbuf = pbuf;
       if (type < 0)
-        randread (s, pbuf, lim);
+        wbuf = keystream_gen_claim (&gen);
       /* Loop to retry partial writes. */
       for (soff = 0; soff < lim; soff += ssize)
         {
-          ssize = write (fd, pbuf + soff, lim - soff);
+          ssize = write (fd, wbuf + soff, lim - soff);
           if (0 < ssize)
             assume (ssize <= lim - soff);
           else
@@ -516,6 +777,7 @@ dopass (int fd, struct stat const *st, char const *qname, off_t *sizep,
                      also enables direct I/O on some (file) systems.  */
                   verify (PERIODIC_OUTPUT_SIZE % SECTOR_SIZE == 0);
                   verify (NONPERIODIC_OUTPUT_SIZE % SECTOR_SIZE == 0);
+                  verify (RANDOM_OUTPUT_SIZE % SECTOR_SIZE == 0);
                   if (errnum == EIO && known (size)
                       && (soff | SECTOR_MASK) < lim)
                     {
@@ -535,6 +797,9 @@ dopass (int fd, struct stat const *st, char const *qname, off_t *sizep,
             }
         }
 
+      if (type < 0)
+        keystream_gen_release (&gen);
+
       /* Okay, we have written "soff" bytes. */
 
       if (OFF_T_MAX - offset < soff)
@@ -620,6 +885,8 @@ dopass (int fd, struct stat const *st, char const *qname, off_t *sizep,
     }
 
 free_pattern_mem:
+  if (gen_running)
+    keystream_gen_stop (&gen);
   free (fill_pattern_mem);
 
   return other_error ? -1 : write_error;
@@ -899,7 +1166,9 @@ do_wipefd (int fd, char const *qname, struct randint_source *s,
     i_size = st.st_size;
 
   /* Schedule the passes in random order. */
+  pthread_mutex_lock (&rand_lock);
   genpattern (passarray, flags->n_iterations, s);
+  pthread_mutex_unlock (&rand_lock);
 
   rs = randint_get_source (s);
 
@@ -1041,13 +1310,27 @@ incname (char *name, size_t len)
  * This is fairly significantly Unix-specific.  Of course, on any
  * file system with synchronous metadata updates, this is unnecessary.
  */
+
+/* Thread-safe variant of quotef: quotearg keeps per-slot state, so
+   serialize it and return a copy.  */
+static pthread_mutex_t quote_lock = PTHREAD_MUTEX_INITIALIZER;
+
+static char *
+quotef_dup (char const *name)
+{
+  pthread_mutex_lock (&quote_lock);
+  char *q = xstrdup (quotef (name));
+  pthread_mutex_unlock (&quote_lock);
+  return q;
+}
+
 static bool
 wipename (char *oldname, char const *qoldname, struct Options const *flags)
 {
   char *newname = xstrdup (oldname);
   char *base = last_component (newname);
   char *dir = dir_name (newname);
-  char *qdir = xstrdup (quotef (dir));
+  char *qdir = quotef_dup (dir);
   bool first = true;
   bool ok = true;
   int dir_fd = -1;
@@ -1165,6 +1448,88 @@ clear_random_data (void)
   randint_all_free (randint_source);
 }
 
+/* A file operand claimed by one of the wipe worker threads.  */
+struct wipe_job
+{
+  char *file;
+  char *qname;
+  bool ok;
+};
+
+struct wipe_pool
+{
+  struct wipe_job *jobs;
+  size_t n_jobs;
+  size_t next_job;		/* First job not yet claimed */
+  struct Options const *flags;
+  pthread_mutex_t lock;
+};
+
+static void *
+wipe_pool_thread (void *arg)
+{
+  struct wipe_pool *pool = arg;
+
+  while (true)
+    {
+      pthread_mutex_lock (&pool->lock);
+      size_t i = pool->next_job++;
+      pthread_mutex_unlock (&pool->lock);
+      if (pool->n_jobs <= i)
+        break;
+
+      struct wipe_job *job = &pool->jobs[i];
+      if (STREQ (job->file, "-"))
+        job->ok = wipefd (STDOUT_FILENO, job->qname, randint_source,
+                          pool->flags);
+      else
+        job->ok = wipefile (job->file, job->qname, randint_source,
+                            pool->flags);
+    }
+  return NULL;
+}
+
+/* Wipe the N_FILES operands FILE, up to nthreads of them
+   concurrently.  Return true if all of them succeeded.  */
+static bool
+wipe_files_parallel (char **file, int n_files, struct Options const *flags)
+{
+  struct wipe_pool pool;
+  bool ok = true;
+
+  pool.jobs = xnmalloc (n_files, sizeof *pool.jobs);
+  pool.n_jobs = n_files;
+  pool.next_job = 0;
+  pool.flags = flags;
+  pthread_mutex_init (&pool.lock, NULL);
+
+  for (int i = 0; i < n_files; i++)
+    {
+      pool.jobs[i].file = file[i];
+      pool.jobs[i].qname = quotef_dup (file[i]);
+      pool.jobs[i].ok = false;
+    }
+
+  size_t n_workers = MIN (nthreads, (size_t) n_files);
+  pthread_t *threads = xnmalloc (n_workers, sizeof *threads);
+  for (size_t t = 0; t < n_workers; t++)
+    {
+      int err = pthread_create (&threads[t], NULL, wipe_pool_thread, &pool);
+      if (err)
+        die (EXIT_FAILURE, err, _("failed to create wipe thread"));
+    }
+  for (size_t t = 0; t < n_workers; t++)
+    pthread_join (threads[t], NULL);
+
+  for (int i = 0; i < n_files; i++)
+    {
+      ok &= pool.jobs[i].ok;
+      free (pool.jobs[i].qname);
+    }
+  free (threads);
+  free (pool.jobs);
+  return ok;
+}
 
 int
 main (int argc, char **argv)
@@ -1222,6 +1587,11 @@ main (int argc, char **argv)
                                    _("invalid file size"), 0);
           break;
 
+        case THREADS_OPTION:
+          nthreads = xdectoumax (optarg, 1, SIZE_MAX, "",
+                                 _("invalid number of threads"), 0);
+          break;
+
         case 'v':
           flags.verbose = true;
           break;
@@ -1258,20 +1628,23 @@ main (int argc, char **argv)
          quotef (random_source ? random_source : "getrandom"));
   atexit (clear_random_data);
 
-  for (i = 0; i < n_files; i++)
-    {
-      char *qname = xstrdup (quotef (file[i]));
-      if (STREQ (file[i], "-"))
-        {
-          ok &= wipefd (STDOUT_FILENO, qname, randint_source, &flags);
-        }
-      else
-        {
-          /* Plain filename - Note that this overwrites *argv! */
-          ok &= wipefile (file[i], qname, randint_source, &flags);
-        }
-      free (qname);
-    }
+  if (1 < nthreads && 1 < n_files)
+    ok = wipe_files_parallel (file, n_files, &flags);
+  else
+    for (i = 0; i < n_files; i++)
+      {
+        char *qname = xstrdup (quotef (file[i]));
+        if (STREQ (file[i], "-"))
+          {
+            ok &= wipefd (STDOUT_FILENO, qname, randint_source, &flags);
+          }
+        else
+          {
+            /* Plain filename - Note that this overwrites *argv! */
+            ok &= wipefile (file[i], qname, randint_source, &flags);
+          }
+        free (qname);
+      }
 
   return ok ? EXIT_SUCCESS : EXIT_FAILURE;
 }
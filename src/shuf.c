@@ -25,8 +25,12 @@
 #include "die.h"
 #include "error.h"
 #include "fadvise.h"
+#include "filenamecat.h"
+#include "freadptr.h"
+#include "freadseek.h"
 #include "getopt.h"
 #include "linebuffer.h"
+#include "linebuffer-prefixed.h"
 #include "quote.h"
 #include "randint.h"
 #include "randperm.h"
@@ -51,6 +55,13 @@ enum { RESERVOIR_LINES_INCREMENT = 1024 };
      $ for p in $(seq 7); do time shuf -n10 10p$p.in >/dev/null; done  .*/
 enum { RESERVOIR_MIN_INPUT = 8192 * 1024 };
 
+/* For external shuffling, distribute input lines over at most this
+   many temporary spill files.  */
+enum { EXTERNAL_SHUFFLE_MAX_BUCKETS = 256 };
+
+/* Directory in which to create spill files when TMPDIR is not set.  */
+#define DEFAULT_TMPDIR "/tmp"
+
 
 void
 usage (int status)
@@ -79,9 +90,14 @@ Write a random permutation of the input lines to standard output.\n\
   -o, --output=FILE         write result to FILE instead of standard output\n\
       --random-source=FILE  get random bytes from FILE\n\
   -r, --repeat              output lines can be repeated\n\
+  -S, --buffer-size=SIZE    shuffle inputs larger than SIZE via temporary\n\
+                              files, keeping about SIZE bytes in memory\n\
 "), stdout);
       fputs (_("\
   -z, --zero-terminated     line delimiter is NUL, not newline\n\
+      --length-prefixed     read and write length-prefixed binary records\n\
+                              (a varint byte count, then the payload)\n\
+                              instead of delimited lines\n\
 "), stdout);
       fputs (HELP_OPTION_DESCRIPTION, stdout);
       fputs (VERSION_OPTION_DESCRIPTION, stdout);
@@ -95,9 +111,15 @@ Write a random permutation of the input lines to standard output.\n\
    non-character as a pseudo short option, starting with CHAR_MAX + 1.  */
 enum
 {
-  RANDOM_SOURCE_OPTION = CHAR_MAX + 1
+  LENGTH_PREFIXED_OPTION = CHAR_MAX + 1,
+  RANDOM_SOURCE_OPTION
 };
 
+/* If true, lines are length-prefixed binary records rather than
+   delimited text; see varint.h for the format.  In memory each record
+   keeps its prefix, so it can be written back out verbatim.  */
+static bool length_prefixed;
+
 static struct option const long_opts[] =
 {
   {"echo", no_argument, NULL, 'e'},
@@ -106,7 +128,9 @@ static struct option const long_opts[] =
   {"output", required_argument, NULL, 'o'},
   {"random-source", required_argument, NULL, RANDOM_SOURCE_OPTION},
   {"repeat", no_argument, NULL, 'r'},
+  {"buffer-size", required_argument, NULL, 'S'},
   {"zero-terminated", no_argument, NULL, 'z'},
+  {"length-prefixed", no_argument, NULL, LENGTH_PREFIXED_OPTION},
   {GETOPT_HELP_OPTION_DECL},
   {GETOPT_VERSION_OPTION_DECL},
   {0, 0, 0, 0},
@@ -116,7 +140,7 @@ static void
 input_from_argv (char **operand, int n_operands, char eolbyte)
 {
   char *p;
-  size_t size = n_operands;
+  size_t size = n_operands * (length_prefixed ? VARINT_BYTES_BOUND : 1);
   int i;
 
   for (i = 0; i < n_operands; i++)
@@ -125,10 +149,20 @@ input_from_argv (char **operand, int n_operands, char eolbyte)
 
   for (i = 0; i < n_operands; i++)
     {
-      char *p1 = stpcpy (p, operand[i]);
+      char *p1;
+      if (length_prefixed)
+        {
+          size_t len = strlen (operand[i]);
+          p1 = p + varint_encode (p, len);
+          p1 = mempcpy (p1, operand[i], len);
+        }
+      else
+        {
+          p1 = stpcpy (p, operand[i]);
+          *p1++ = eolbyte;
+        }
       operand[i] = p;
       p = p1;
-      *p++ = eolbyte;
     }
 
   operand[n_operands] = p;
@@ -144,6 +178,23 @@ next_line (char *line, char eolbyte, size_t n)
   return p + 1;
 }
 
+/* Return the start of the record after the length-prefixed record at
+   REC, which must end by LIM; diagnose and exit if the record is
+   malformed or runs past LIM.  */
+
+static char *
+next_record (char *rec, char const *lim)
+{
+  uintmax_t len;
+  size_t n = varint_decode (rec, lim - rec, &len);
+
+  if (n == SIZE_MAX)
+    die (EXIT_FAILURE, 0, _("invalid record length prefix"));
+  if (n == 0 || (uintmax_t) (lim - rec - n) < len)
+    die (EXIT_FAILURE, 0, _("truncated length-prefixed record"));
+  return rec + n + len;
+}
+
 /* Return the size of the input if possible or OFF_T_MAX if not.  */
 
 static off_t
@@ -168,6 +219,124 @@ input_size (void)
   return file_size;
 }
 
+/* Discard one line (delimited by EOLBYTE) from IN without copying it,
+   scanning the stdio buffer in place where possible.  Return true if a
+   line (possibly lacking a trailing EOLBYTE at EOF) was consumed.  */
+
+static bool
+skip_line_delim (FILE *in, char eolbyte)
+{
+  bool any = false;
+
+  while (true)
+    {
+      size_t avail;
+      char const *p = freadptr (in, &avail);
+      if (! p)
+        {
+          /* The buffer is empty (or IN is unbuffered); refill via getc.  */
+          int c = getc (in);
+          if (c == EOF)
+            return any;
+          any = true;
+          if (c == eolbyte)
+            return true;
+          continue;
+        }
+
+      char const *eol = memchr (p, eolbyte, avail);
+      size_t n = eol ? eol - p + 1 : avail;
+      if (freadseek (in, n) != 0)
+        return false;
+      any = true;
+      if (eol)
+        return true;
+    }
+}
+
+/* Discard one length-prefixed record from IN without copying its
+   payload anywhere.  Return true if a record was consumed; diagnose
+   and exit if the input ends mid-record.  */
+
+static bool
+skip_record_prefixed (FILE *in)
+{
+  char prefix[VARINT_BYTES_BOUND];
+  size_t navail = 0;
+  uintmax_t len;
+  size_t n;
+
+  do
+    {
+      int c = getc (in);
+      if (c == EOF)
+        {
+          if (navail == 0 || ferror (in))
+            return false;
+          die (EXIT_FAILURE, 0, _("truncated length-prefixed record"));
+        }
+      prefix[navail++] = c;
+      n = varint_decode (prefix, navail, &len);
+      if (n == SIZE_MAX || (navail == sizeof prefix && n == 0))
+        die (EXIT_FAILURE, 0, _("invalid record length prefix"));
+    }
+  while (n == 0);
+
+  while (len)
+    {
+      size_t avail;
+      char const *p = freadptr (in, &avail);
+      if (! p)
+        {
+          if (getc (in) == EOF)
+            {
+              if (ferror (in))
+                return false;
+              die (EXIT_FAILURE, 0, _("truncated length-prefixed record"));
+            }
+          len--;
+          continue;
+        }
+
+      size_t skip = MIN (avail, len);
+      if (freadseek (in, skip) != 0)
+        return false;
+      len -= skip;
+    }
+
+  return true;
+}
+
+/* Read the next line or record of IN into LB, returning NULL at end
+   of input or on error, as readlinebuffer_delim does.  */
+
+static struct linebuffer *
+read_line (struct linebuffer *lb, FILE *in, char eolbyte)
+{
+  return (length_prefixed
+          ? readlinebuffer_prefixed (lb, in)
+          : readlinebuffer_delim (lb, in, eolbyte));
+}
+
+/* Write the LENGTH-byte line in BUFFER, whose last byte is the
+   delimiter (or its stand-in NUL with --length-prefixed), to OUT,
+   reframing it with a length prefix in the latter case.  Return 0
+   upon success, -1 on write failure.  */
+
+static int
+write_line_record (char const *buffer, size_t length, FILE *out)
+{
+  if (length_prefixed)
+    {
+      char prefix[VARINT_BYTES_BOUND];
+      size_t n = varint_encode (prefix, length - 1);
+      if (fwrite (prefix, sizeof (char), n, out) != n)
+        return -1;
+      length--;
+    }
+  return fwrite (buffer, sizeof (char), length, out) == length ? 0 : -1;
+}
+
 /* Read all lines and store up to K permuted lines in *OUT_RSRV.
    Return the number of lines read, up to a maximum of K.  */
 
@@ -185,8 +354,7 @@ read_input_reservoir_sampling (FILE *in, char eolbyte, size_t k,
 
   /* Fill the first K lines, directly into the reservoir.  */
   while (n_lines < k
-         && (line =
-             readlinebuffer_delim (&rsrv[n_lines], in, eolbyte)) != NULL)
+         && (line = read_line (&rsrv[n_lines], in, eolbyte)) != NULL)
     {
       n_lines++;
 
@@ -203,29 +371,28 @@ read_input_reservoir_sampling (FILE *in, char eolbyte, size_t k,
   /* last line wasn't NULL - so there may be more lines to read.  */
   if (line != NULL)
     {
-      struct linebuffer dummy;
-      initbuffer (&dummy);  /* space for lines not put in reservoir.  */
-
       /* Choose the fate of the next line, with decreasing probability (as
          n_lines increases in size).
 
-         If the line will be used, store it directly in the reservoir.
-         Otherwise, store it in dummy space.
-
-         With 'struct linebuffer', storing into existing buffer will reduce
-         re-allocations (will only re-allocate if the new line is longer than
-         the currently allocated space).  */
+         If the line will be used, read it directly into the reservoir;
+         since an existing 'struct linebuffer' is reused, this re-allocates
+         only if the new line is longer than the currently allocated space.
+         Otherwise just discard the line's bytes in place, without copying
+         them anywhere.  */
+      bool more;
       do
         {
           randint j = randint_choose (s, n_lines + 1);  /* 0 .. n_lines.  */
-          line = (j < k) ? (&rsrv[j]) : (&dummy);
+          more = (j < k
+                  ? read_line (&rsrv[j], in, eolbyte) != NULL
+                  : length_prefixed
+                  ? skip_record_prefixed (in)
+                  : skip_line_delim (in, eolbyte));
         }
-      while (readlinebuffer_delim (line, in, eolbyte) != NULL && n_lines++);
+      while (more && n_lines++);
 
       if (! n_lines)
         die (EXIT_FAILURE, EOVERFLOW, _("too many input lines"));
-
-      freebuffer (&dummy);
     }
 
   /* no more input lines, or an input error.  */
@@ -243,7 +410,7 @@ write_permuted_output_reservoir (size_t n_lines, struct linebuffer *lines,
   for (size_t i = 0; i < n_lines; i++)
     {
       const struct linebuffer *p = &lines[permutation[i]];
-      if (fwrite (p->buffer, sizeof (char), p->length, stdout) != p->length)
+      if (write_line_record (p->buffer, p->length, stdout) != 0)
         return -1;
     }
 
@@ -252,9 +419,10 @@ write_permuted_output_reservoir (size_t n_lines, struct linebuffer *lines,
 
 /* Read data from file IN.  Input lines are delimited by EOLBYTE;
    silently append a trailing EOLBYTE if the file ends in some other
-   byte.  Store a pointer to the resulting array of lines into *PLINE.
-   Return the number of lines read.  Report an error and exit on
-   failure.  */
+   byte.  With --length-prefixed, records are located by decoding
+   their prefixes instead, and keep them.  Store a pointer to the
+   resulting array of lines into *PLINE.  Return the number of lines
+   read.  Report an error and exit on failure.  */
 
 static size_t
 read_input (FILE *in, char eolbyte, char ***pline)
@@ -278,24 +446,52 @@ read_input (FILE *in, char eolbyte, char ***pline)
   if (!(buf = fread_file (in, 0, &used)))
     die (EXIT_FAILURE, errno, _("read error"));
 
-  if (used && buf[used - 1] != eolbyte)
+  if (used && ! length_prefixed && buf[used - 1] != eolbyte)
     buf[used++] = eolbyte;
 
   lim = buf + used;
 
   n_lines = 0;
-  for (p = buf; p < lim; p = next_line (p, eolbyte, lim - p))
+  for (p = buf; p < lim;
+       p = (length_prefixed
+            ? next_record (p, lim)
+            : next_line (p, eolbyte, lim - p)))
     n_lines++;
 
   *pline = line = xnmalloc (n_lines + 1, sizeof *line);
 
   line[0] = p = buf;
   for (size_t i = 1; i <= n_lines; i++)
-    line[i] = p = next_line (p, eolbyte, lim - p);
+    line[i] = p = (length_prefixed
+                   ? next_record (p, lim)
+                   : next_line (p, eolbyte, lim - p));
 
   return n_lines;
 }
 
+/* For permuted output, gather short lines into a buffer of this size
+   rather than issuing one stdio call per line.  */
+enum { SHUF_OUTPUT_BUFSIZE = 64 * 1024 };
+
+/* Append the LEN bytes at P to the OUT_BUF_SIZE-byte gather buffer
+   OUTBUF holding *FILL bytes, flushing OUTBUF to stdout as needed.
+   Return 0 upon success, -1 on write failure.  */
+static int
+write_buffered_line (char const *p, size_t len, char *outbuf, size_t *fill)
+{
+  if (SHUF_OUTPUT_BUFSIZE - *fill < len)
+    {
+      if (fwrite (outbuf, sizeof *outbuf, *fill, stdout) != *fill)
+        return -1;
+      *fill = 0;
+      if (SHUF_OUTPUT_BUFSIZE < len)
+        return fwrite (p, sizeof *p, len, stdout) == len ? 0 : -1;
+    }
+  memcpy (outbuf + *fill, p, len);
+  *fill += len;
+  return 0;
+}
+
 /* Output N_LINES lines to stdout from LINE array,
    chosen by the indices in PERMUTATION.
    PERMUTATION and LINE must have at least N_LINES elements.
@@ -304,17 +500,135 @@ static int
 write_permuted_lines (size_t n_lines, char *const *line,
                       size_t const *permutation)
 {
+  static char outbuf[SHUF_OUTPUT_BUFSIZE];
+  size_t fill = 0;
+
   for (size_t i = 0; i < n_lines; i++)
     {
       char *const *p = line + permutation[i];
-      size_t len = p[1] - p[0];
-      if (fwrite (p[0], sizeof *p[0], len, stdout) != len)
+      if (write_buffered_line (p[0], p[1] - p[0], outbuf, &fill) != 0)
         return -1;
     }
 
+  if (fill && fwrite (outbuf, sizeof *outbuf, fill, stdout) != fill)
+    return -1;
+
   return 0;
 }
 
+/* Open a stream on an anonymous temporary file in $TMPDIR.
+   The file is unlinked immediately, so no cleanup is needed.  */
+
+static FILE *
+open_spill_stream (void)
+{
+  char const *tmpdir = getenv ("TMPDIR");
+  char *name = file_name_concat (tmpdir ? tmpdir : DEFAULT_TMPDIR,
+                                 "shufXXXXXX", NULL);
+  int fd = mkostemp (name, O_CLOEXEC);
+  if (fd < 0)
+    die (EXIT_FAILURE, errno, _("cannot create temporary file in %s"),
+         quoteaf (tmpdir ? tmpdir : DEFAULT_TMPDIR));
+  unlink (name);
+  free (name);
+  FILE *f = fdopen (fd, "w+");
+  if (! f)
+    die (EXIT_FAILURE, errno, _("cannot create temporary file in %s"),
+         quoteaf (tmpdir ? tmpdir : DEFAULT_TMPDIR));
+  return f;
+}
+
+/* Distribute the lines of IN (delimited by EOLBYTE) over temporary
+   bucket files, each line going to a bucket chosen uniformly via S.
+   Aim for an expected bucket size of about MEM_LIMIT / 2 bytes when
+   the input size is known.  Store the array of bucket streams in
+   *PBUCKET and return the number of buckets.
+
+   Writing the buckets out in order, each internally shuffled, yields
+   a uniformly random permutation of the whole input: the scheme is
+   equivalent to tagging every line with an independent uniform random
+   key (bucket index as high bits, within-bucket order as a uniform
+   tie-break) and sorting by that key.  */
+
+static size_t
+spill_input_to_buckets (FILE *in, char eolbyte, off_t mem_limit,
+                        struct randint_source *s, FILE ***pbucket)
+{
+  size_t n_buckets = EXTERNAL_SHUFFLE_MAX_BUCKETS;
+  off_t size = input_size ();
+  if (size != OFF_T_MAX
+      && size / mem_limit < (EXTERNAL_SHUFFLE_MAX_BUCKETS - 2) / 2)
+    n_buckets = size / mem_limit * 2 + 2;
+
+  FILE **bucket = xnmalloc (n_buckets, sizeof *bucket);
+  for (size_t i = 0; i < n_buckets; i++)
+    bucket[i] = open_spill_stream ();
+
+  struct linebuffer lb;
+  initbuffer (&lb);
+  while (read_line (&lb, in, eolbyte) != NULL)
+    {
+      randint j = randint_choose (s, n_buckets);
+      if (write_line_record (lb.buffer, lb.length, bucket[j]) != 0)
+        die (EXIT_FAILURE, errno, _("write error"));
+    }
+  if (ferror (in))
+    die (EXIT_FAILURE, errno, _("read error"));
+  freebuffer (&lb);
+
+  *pbucket = bucket;
+  return n_buckets;
+}
+
+/* Read back the N_BUCKETS spill files in BUCKET in order, shuffling
+   each in memory via S and writing it to stdout.  Return 0 upon
+   success, -1 on write failure.  */
+
+static int
+write_permuted_buckets (size_t n_buckets, FILE **bucket, char eolbyte,
+                        struct randint_source *s)
+{
+  for (size_t i = 0; i < n_buckets; i++)
+    {
+      char **lines;
+
+      rewind (bucket[i]);
+      size_t n = read_input (bucket[i], eolbyte, &lines);
+      size_t *permutation = randperm_new (s, n, n);
+
+      if (write_permuted_lines (n, lines, permutation) != 0)
+        return -1;
+
+      free (permutation);
+      free (lines[0]);
+      free (lines);
+      if (fclose (bucket[i]) != 0)
+        die (EXIT_FAILURE, errno, _("read error"));
+    }
+
+  free (bucket);
+  return 0;
+}
+
+/* Output the number N followed by EOLBYTE, or framed as a
+   length-prefixed record.  Return 0 upon success, -1 on failure.  */
+static int
+write_number (unsigned long int n, char eolbyte)
+{
+  if (length_prefixed)
+    {
+      char numbuf[INT_BUFSIZE_BOUND (unsigned long int)];
+      int numlen = snprintf (numbuf, sizeof numbuf, "%lu", n);
+      char prefix[VARINT_BYTES_BOUND];
+      size_t pn = varint_encode (prefix, numlen);
+      return (fwrite (prefix, sizeof (char), pn, stdout) == pn
+              && fwrite (numbuf, sizeof (char), numlen, stdout) == (size_t) numlen
+              ? 0 : -1);
+    }
+
+  return printf ("%lu%c", n, eolbyte) < 0 ? -1 : 0;
+}
+
 /* Output N_LINES of numbers to stdout, from PERMUTATION array.
    PERMUTATION must have at least N_LINES elements.  */
 static int
@@ -323,8 +637,7 @@ write_permuted_numbers (size_t n_lines, size_t lo_input,
 {
   for (size_t i = 0; i < n_lines; i++)
     {
-      unsigned long int n = lo_input + permutation[i];
-      if (printf ("%lu%c", n, eolbyte) < 0)
+      if (write_number (lo_input + permutation[i], eolbyte) != 0)
         return -1;
     }
 
@@ -342,7 +655,7 @@ write_random_numbers (struct randint_source *s, size_t count,
   for (size_t i = 0; i < count; i++)
     {
       unsigned long int j = lo_input + randint_choose (s, range);
-      if (printf ("%lu%c", j, eolbyte) < 0)
+      if (write_number (j, eolbyte) != 0)
         return -1;
     }
 
@@ -356,15 +669,20 @@ static int
 write_random_lines (struct randint_source *s, size_t count,
                     char *const *lines, size_t n_lines)
 {
+  static char outbuf[SHUF_OUTPUT_BUFSIZE];
+  size_t fill = 0;
+
   for (size_t i = 0; i < count; i++)
     {
       const randint j = randint_choose (s, n_lines);
       char *const *p = lines + j;
-      size_t len = p[1] - p[0];
-      if (fwrite (p[0], sizeof *p[0], len, stdout) != len)
+      if (write_buffered_line (p[0], p[1] - p[0], outbuf, &fill) != 0)
         return -1;
     }
 
+  if (fill && fwrite (outbuf, sizeof *outbuf, fill, stdout) != fill)
+    return -1;
+
   return 0;
 }
 
@@ -381,6 +699,10 @@ main (int argc, char **argv)
   char eolbyte = '\n';
   char **input_lines = NULL;
   bool use_reservoir_sampling = false;
+  bool use_external_shuffle = false;
+  off_t shuffle_mem_limit = 0;
+  FILE **buckets = NULL;
+  size_t n_buckets = 0;
   bool repeat = false;
 
   int optc;
@@ -401,7 +723,7 @@ main (int argc, char **argv)
 
   atexit (close_stdout);
 
-  while ((optc = getopt_long (argc, argv, "ei:n:o:rz", long_opts, NULL)) != -1)
+  while ((optc = getopt_long (argc, argv, "ei:n:o:rS:z", long_opts, NULL)) != -1)
     switch (optc)
       {
       case 'e':
@@ -467,10 +789,19 @@ main (int argc, char **argv)
         repeat = true;
         break;
 
+      case 'S':
+        shuffle_mem_limit = xdectoumax (optarg, 1, OFF_T_MAX, "EGkKMmPTYZ0",
+                                        _("invalid buffer size"), 0);
+        break;
+
       case 'z':
         eolbyte = '\0';
         break;
 
+      case LENGTH_PREFIXED_OPTION:
+        length_prefixed = true;
+        break;
+
       case_GETOPT_HELP_CHAR;
       case_GETOPT_VERSION_CHAR (PROGRAM_NAME, AUTHORS);
       default:
@@ -519,8 +850,14 @@ main (int argc, char **argv)
 
       fadvise (stdin, FADVISE_SEQUENTIAL);
 
-      if (repeat || head_lines == SIZE_MAX
-          || input_size () <= RESERVOIR_MIN_INPUT)
+      if (! repeat && head_lines == SIZE_MAX
+          && shuffle_mem_limit && shuffle_mem_limit < input_size ())
+        {
+          use_external_shuffle = true;
+          n_lines = SIZE_MAX;   /* unknown number of input lines, for now.  */
+        }
+      else if (repeat || head_lines == SIZE_MAX
+               || input_size () <= RESERVOIR_MIN_INPUT)
         {
           n_lines = read_input (stdin, eolbyte, &input_lines);
           line = input_lines;
@@ -537,7 +874,8 @@ main (int argc, char **argv)
   size_t ahead_lines = repeat || head_lines < n_lines ? head_lines : n_lines;
 
   randint_source = randint_all_new (random_source,
-                                    (use_reservoir_sampling || repeat
+                                    (use_reservoir_sampling
+                                     || use_external_shuffle || repeat
                                      ? SIZE_MAX
                                      : randperm_bound (ahead_lines, n_lines)));
   if (! randint_source)
@@ -552,6 +890,11 @@ main (int argc, char **argv)
                                                randint_source, &reservoir);
       ahead_lines = n_lines;
     }
+  else if (use_external_shuffle)
+    /* Distribute the input over spill files now, while stdin is still
+       open; the buckets are shuffled and output below.  */
+    n_buckets = spill_input_to_buckets (stdin, eolbyte, shuffle_mem_limit,
+                                        randint_source, &buckets);
 
   /* Close stdin now, rather than earlier, so that randint_all_new
      doesn't have to worry about opening something other than
@@ -559,7 +902,7 @@ main (int argc, char **argv)
   if (! (head_lines == 0 || echo || input_range || fclose (stdin) == 0))
     die (EXIT_FAILURE, errno, _("read error"));
 
-  if (!repeat)
+  if (!repeat && !use_external_shuffle)
     permutation = randperm_new (randint_source, ahead_lines, n_lines);
 
   if (outfile && ! freopen (outfile, "w", stdout))
@@ -583,7 +926,10 @@ main (int argc, char **argv)
     }
   else
     {
-      if (use_reservoir_sampling)
+      if (use_external_shuffle)
+        i = write_permuted_buckets (n_buckets, buckets, eolbyte,
+                                    randint_source);
+      else if (use_reservoir_sampling)
         i = write_permuted_output_reservoir (n_lines, reservoir, permutation);
       else if (input_range)
         i = write_permuted_numbers (ahead_lines, lo_input,
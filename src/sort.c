@@ -24,13 +24,18 @@
 
 #include <getopt.h>
 #include <pthread.h>
+#include <sched.h>
 #include <sys/resource.h>
 #include <sys/types.h>
+#if HAVE_MMAP
+# include <sys/mman.h>
+#endif
 #include <sys/wait.h>
 #include <signal.h>
 #include <assert.h>
 #include "system.h"
 #include "argmatch.h"
+#include "dec-input.h"
 #include "die.h"
 #include "error.h"
 #include "fadvise.h"
@@ -45,11 +50,14 @@
 #include "nproc.h"
 #include "physmem.h"
 #include "posixver.h"
+#include "probes.h"
 #include "quote.h"
 #include "randread.h"
 #include "readtokens0.h"
+#include "stdbuf-policy.h"
 #include "stdlib--.h"
 #include "strnumcmp.h"
+#include "varint.h"
 #include "xmemcoll.h"
 #include "xnanosleep.h"
 #include "xstrtol.h"
@@ -83,6 +91,10 @@ struct rlimit { size_t rlim_cur; };
 # endif
 #endif
 
+#ifndef SA_RESTART
+# define SA_RESTART 0
+#endif
+
 #if !defined OPEN_MAX && defined NR_OPEN
 # define OPEN_MAX NR_OPEN
 #endif
@@ -171,6 +183,14 @@ enum blanktype { bl_start, bl_end, bl_both };
 /* The character marking end of line. Default to \n. */
 static char eolchar = '\n';
 
+/* If true, lines are length-prefixed binary records rather than
+   delimited text: on input each record is a varint byte count
+   followed by that many payload bytes, and output is framed the same
+   way.  The payload is held in core with an appended NUL, like a
+   delimited line, so keys and comparisons work unchanged, though
+   collating locales compare only up to an embedded NUL.  */
+static bool length_prefixed;
+
 /* Lines are held in core as counted strings. */
 struct line
 {
@@ -178,6 +198,8 @@ struct line
   size_t length;		/* Length including final newline. */
   char *keybeg;			/* Start of first key. */
   char *keylim;			/* Limit of first key. */
+  uintmax_t numkey;		/* Order-preserving binary prefix of a
+                                   numeric key; see use_numkeys.  */
 };
 
 /* Input buffers. */
@@ -194,6 +216,8 @@ struct buffer
   size_t left;			/* Number of bytes left from previous reads. */
   size_t line_bytes;		/* Number of bytes to reserve for each line. */
   bool eof;			/* An EOF has been read.  */
+  char *map;			/* Memory-mapped input text, or NULL.  */
+  size_t mapsize;		/* Number of bytes mapped.  */
 };
 
 /* Sort key.  */
@@ -350,6 +374,18 @@ static int tab = TAB_DEFAULT;
    Only the last of a sequence of equal lines will be output. */
 static bool unique;
 
+/* Name of the file recording how far a -c/-C check got, or NULL if
+   every check starts from the beginning of the input.  */
+static char const *check_state_file;
+
+/* If nonzero, output only this many lines, selected with a bounded
+   heap instead of a full sort.  */
+static size_t top_lines;
+
+/* Flag to output distinct lines in input order, via a hash table
+   instead of a sort.  */
+static bool hash_unique;
+
 /* Nonzero if any of the input files are the standard input. */
 static bool have_read_stdin;
 
@@ -359,13 +395,65 @@ static struct keyfield *keylist;
 /* Program used to (de)compress temp files.  Must accept -d.  */
 static char const *compress_program;
 
+/* If true, compress temporary files in-process (--compress-temps),
+   avoiding a subprocess and two pipe copies per temp file.  */
+static bool compress_temps;
+
+/* If true, pin each --parallel worker thread to its own processor
+   (--cpu-affinity), so a thread's working set stays in one cache and,
+   on multi-socket machines, on one memory node.  */
+static bool cpu_affinity;
+
+/* If true, filter compressed inputs, recognized by their magic
+   bytes, through the matching decompressor (--decompress).  */
+static bool decompress_input;
+
 /* Annotate the output with extra info to aid the user.  */
 static bool debug;
 
+/* Report statistics about the run on stderr (--stats).  */
+static bool stats;
+
+/* Counters for --stats.  Input is read and temporary files are
+   created and merged only from the main thread, so these need no
+   locking even with --parallel.  */
+static struct
+{
+  uintmax_t bytes_read;		/* Bytes of input consumed.  */
+  uintmax_t lines_read;		/* Lines of input consumed.  */
+  uintmax_t temp_files;		/* Temporary files created.  */
+  uintmax_t merges;		/* File merge passes performed.  */
+  size_t max_merge_fanin;	/* Most files merged in one pass.  */
+} sort_stats;
+
+/* Nonzero when SIGUSR1 has requested an interim statistics report.  */
+static sig_atomic_t volatile stats_requested;
+
 /* Maximum number of files to merge in one go.  If more than this
    number are present, temp files will be used. */
 static unsigned int nmerge = NMERGE_DEFAULT;
 
+/* Handle SIGUSR1 by requesting an interim --stats report, which the
+   main loop prints at the next input refill.  */
+
+static void
+stats_sighandler (int sig)
+{
+  stats_requested = 1;
+}
+
+/* Report the statistics accumulated so far on stderr.  */
+
+static void
+stats_report (void)
+{
+  error (0, 0, _("%ju bytes, %ju lines read"),
+         sort_stats.bytes_read, sort_stats.lines_read);
+  error (0, 0, _("%ju temporary files written, %ju merges, %zu max fan-in"),
+         sort_stats.temp_files, sort_stats.merges,
+         sort_stats.max_merge_fanin);
+}
+
 /* Output an error to stderr and exit using async-signal-safe routines.
    This can be used safely from signal handlers,
    and between fork and exec of multithreaded processes.  */
@@ -468,24 +556,42 @@ Other options:\n\
   -c, --check, --check=diagnose-first  check for sorted input; do not sort\n\
   -C, --check=quiet, --check=silent  like -c, but do not report first bad line\
 \n\
+      --check-state=FILE  with -c or -C, record in FILE how far the input was\n\
+                            verified, and resume from there when the input\n\
+                            has only grown since the previous check\n\
       --compress-program=PROG  compress temporaries with PROG;\n\
                               decompress them with PROG -d\n\
+      --compress-temps      compress temporaries in-process,\n\
+                              without running an external program\n\
+      --cpu-affinity        pin each thread of --parallel to its own\n\
+                              processor, for reproducible memory locality\n\
 "), stdout);
       fputs (_("\
       --debug               annotate the part of the line used to sort,\n\
                               and warn about questionable usage to stderr\n\
+      --decompress          filter inputs recognized as compressed by their\n\
+                              magic bytes through the matching decompressor\n\
       --files0-from=F       read input from the files specified by\n\
                             NUL-terminated names in file F;\n\
                             If F is - then read names from standard input\n\
+      --hash-unique         output distinct lines in input order, using a\n\
+                              hash table instead of sorting\n\
 "), stdout);
       fputs (_("\
   -k, --key=KEYDEF          sort via a key; KEYDEF gives location and type\n\
+      --length-prefixed     read and write length-prefixed binary records,\n\
+                              each a count of payload bytes (base 128,\n\
+                              little endian, high bit set on all count\n\
+                              bytes but the last) followed by the payload,\n\
+                              instead of delimited lines\n\
   -m, --merge               merge already sorted files; do not sort\n\
 "), stdout);
       fputs (_("\
   -o, --output=FILE         write result to FILE instead of standard output\n\
   -s, --stable              stabilize sort by disabling last-resort comparison\
 \n\
+      --stats               report statistics on stderr at exit;\n\
+                              SIGUSR1 requests an interim report\n\
   -S, --buffer-size=SIZE    use SIZE for main memory buffer\n\
 "), stdout);
       printf (_("\
@@ -493,6 +599,9 @@ Other options:\n\
   -T, --temporary-directory=DIR  use DIR for temporaries, not $TMPDIR or %s;\n\
                               multiple options specify multiple directories\n\
       --parallel=N          change the number of sorts run concurrently to N\n\
+      --top=K               output only the first K lines of the sorted\n\
+                              result, keeping just K lines in memory and\n\
+                              never writing temporary files\n\
   -u, --unique              with -c, check for strict ordering;\n\
                               without -c, output only the first of an equal run\
 \n\
@@ -534,12 +643,20 @@ native byte values.\n\
 enum
 {
   CHECK_OPTION = CHAR_MAX + 1,
+  CHECK_STATE_OPTION,
   COMPRESS_PROGRAM_OPTION,
+  COMPRESS_TEMPS_OPTION,
+  CPU_AFFINITY_OPTION,
   DEBUG_PROGRAM_OPTION,
+  DECOMPRESS_OPTION,
   FILES0_FROM_OPTION,
+  HASH_UNIQUE_OPTION,
+  LENGTH_PREFIXED_OPTION,
   NMERGE_OPTION,
   RANDOM_SOURCE_OPTION,
   SORT_OPTION,
+  STATS_OPTION,
+  TOP_OPTION,
   PARALLEL_OPTION
 };
 
@@ -549,14 +666,20 @@ static struct option const long_options[] =
 {
   {"ignore-leading-blanks", no_argument, NULL, 'b'},
   {"check", optional_argument, NULL, CHECK_OPTION},
+  {"check-state", required_argument, NULL, CHECK_STATE_OPTION},
   {"compress-program", required_argument, NULL, COMPRESS_PROGRAM_OPTION},
+  {"compress-temps", no_argument, NULL, COMPRESS_TEMPS_OPTION},
+  {"cpu-affinity", no_argument, NULL, CPU_AFFINITY_OPTION},
   {"debug", no_argument, NULL, DEBUG_PROGRAM_OPTION},
+  {"decompress", no_argument, NULL, DECOMPRESS_OPTION},
   {"dictionary-order", no_argument, NULL, 'd'},
   {"ignore-case", no_argument, NULL, 'f'},
   {"files0-from", required_argument, NULL, FILES0_FROM_OPTION},
   {"general-numeric-sort", no_argument, NULL, 'g'},
+  {"hash-unique", no_argument, NULL, HASH_UNIQUE_OPTION},
   {"ignore-nonprinting", no_argument, NULL, 'i'},
   {"key", required_argument, NULL, 'k'},
+  {"length-prefixed", no_argument, NULL, LENGTH_PREFIXED_OPTION},
   {"merge", no_argument, NULL, 'm'},
   {"month-sort", no_argument, NULL, 'M'},
   {"numeric-sort", no_argument, NULL, 'n'},
@@ -568,10 +691,12 @@ static struct option const long_options[] =
   {"output", required_argument, NULL, 'o'},
   {"reverse", no_argument, NULL, 'r'},
   {"stable", no_argument, NULL, 's'},
+  {"stats", no_argument, NULL, STATS_OPTION},
   {"batch-size", required_argument, NULL, NMERGE_OPTION},
   {"buffer-size", required_argument, NULL, 'S'},
   {"field-separator", required_argument, NULL, 't'},
   {"temporary-directory", required_argument, NULL, 'T'},
+  {"top", required_argument, NULL, TOP_OPTION},
   {"unique", no_argument, NULL, 'u'},
   {"zero-terminated", no_argument, NULL, 'z'},
   {"parallel", required_argument, NULL, PARALLEL_OPTION},
@@ -648,10 +773,11 @@ cs_leave (struct cs_status const *status)
     }
 }
 
-/* Possible states for a temp file.  If compressed, the file's status
-   is unreaped or reaped, depending on whether 'sort' has waited for
-   the subprocess to finish.  */
-enum { UNCOMPRESSED, UNREAPED, REAPED };
+/* Possible states for a temp file.  If compressed by a subprocess,
+   the file's status is unreaped or reaped, depending on whether
+   'sort' has waited for the subprocess to finish.  A temp file
+   compressed in-process (--compress-temps) is INTERNAL.  */
+enum { UNCOMPRESSED, UNREAPED, REAPED, INTERNAL };
 
 /* The list of temporary files. */
 struct tempnode
@@ -664,6 +790,13 @@ struct tempnode
 static struct tempnode *volatile temphead;
 static struct tempnode *volatile *temptail = &temphead;
 
+/* Serialize access to the temp file list and the subprocess table
+   when merges run on multiple threads.  It is locked only at the
+   points where a merge thread enters that shared state
+   (create_temp_file, open_temp, zaptemp); protection against signal
+   handlers is separate, via cs_enter/cs_leave.  */
+static pthread_mutex_t temphead_lock = PTHREAD_MUTEX_INITIALIZER;
+
 /* A file to be sorted.  */
 struct sortfile
 {
@@ -859,15 +992,19 @@ create_temp_file (int *pfd, bool survive_fd_exhaustion)
     temp_dir_index = 0;
 
   /* Create the temporary file in a critical section, to avoid races.  */
+  pthread_mutex_lock (&temphead_lock);
   cs_enter (&cs);
   fd = mkostemp (file, O_CLOEXEC);
   if (0 <= fd)
     {
       *temptail = node;
       temptail = &node->next;
+      if (stats)
+        sort_stats.temp_files++;
     }
   saved_errno = errno;
   cs_leave (&cs);
+  pthread_mutex_unlock (&temphead_lock);
   errno = saved_errno;
 
   if (fd < 0)
@@ -1012,8 +1149,14 @@ xfclose (FILE *fp, char const *file)
       break;
 
     default:
-      if (fclose (fp) != 0)
-        sort_die (_("close failed"), file);
+      {
+        int fd = fileno (fp);
+        if (fclose (fp) != 0)
+          sort_die (_("close failed"), file);
+        if (! dec_input_reap (fd))
+          die (SORT_FAILURE, 0, _("%s: decompression failed"),
+               quotef (file));
+      }
       break;
     }
 }
@@ -1031,6 +1174,394 @@ move_fd (int oldfd, int newfd)
     }
 }
 
+#if HAVE_FOPENCOOKIE
+
+/* In-process streaming compression for temporary files
+   (--compress-temps).  A fixed-width (12-bit) LZW codec, framed by a
+   magic header, layered over the temp file descriptor with
+   fopencookie.  The format is private to a single sort run.  */
+
+enum
+  {
+    TCODEC_BITS = 12,
+    TCODEC_NCODES = 1 << TCODEC_BITS,
+    TCODEC_CLEAR = 256,		/* Reset the dictionary.  */
+    TCODEC_STOP = 257,		/* End of stream.  */
+    TCODEC_FIRST = 258,		/* First dynamically assigned code.  */
+    TCODEC_HASH_SIZE = 1 << (TCODEC_BITS + 1),
+    TCODEC_BUFSIZE = 65536
+  };
+
+static char const tcodec_magic[8] = "\0sortT1\n";
+
+/* Shared state for one compressed temp stream.  */
+struct tcodec
+{
+  int fd;			/* Underlying temp file descriptor.  */
+
+  /* Bit-level I/O, least significant bits first.  */
+  unsigned int bitbuf;
+  int bitcount;
+
+  /* Buffered underlying I/O.  */
+  unsigned char buf[TCODEC_BUFSIZE];
+  size_t buflen;		/* Bytes used (write) or available (read).  */
+  size_t bufpos;		/* Read position.  */
+
+  /* Encoder: open-addressed map from (prefix code, byte) to code.
+     Keys are stored biased by 1 so that zero means an empty slot.  */
+  unsigned int *ekey;
+  unsigned short *eval;
+
+  /* Decoder dictionary and expansion stack.  */
+  unsigned short *dprefix;
+  unsigned char *dsuffix;
+  unsigned char *dstack;
+  size_t dstacklen;
+
+  int prev;			/* Current encoder/decoder prefix code.  */
+  unsigned int next_code;	/* Next code to assign.  */
+  bool at_eof;			/* Decoder saw the stop code.  */
+};
+
+/* Flush the write buffer of T.  Return true on success.  */
+
+static bool
+tcodec_flush (struct tcodec *t)
+{
+  size_t done = 0;
+  while (done < t->buflen)
+    {
+      ssize_t n = write (t->fd, t->buf + done, t->buflen - done);
+      if (n < 0)
+        {
+          if (errno == EINTR)
+            continue;
+          return false;
+        }
+      done += n;
+    }
+  t->buflen = 0;
+  return true;
+}
+
+/* Append one output byte on the write side of T.  */
+
+static bool
+tcodec_putbyte (struct tcodec *t, unsigned char c)
+{
+  if (t->buflen == TCODEC_BUFSIZE && ! tcodec_flush (t))
+    return false;
+  t->buf[t->buflen++] = c;
+  return true;
+}
+
+/* Emit CODE into the compressed bit stream of T.  */
+
+static bool
+tcodec_putcode (struct tcodec *t, unsigned int code)
+{
+  t->bitbuf |= code << t->bitcount;
+  t->bitcount += TCODEC_BITS;
+  while (8 <= t->bitcount)
+    {
+      if (! tcodec_putbyte (t, t->bitbuf & 0xff))
+        return false;
+      t->bitbuf >>= 8;
+      t->bitcount -= 8;
+    }
+  return true;
+}
+
+/* Reset the encoder dictionary of T.  */
+
+static void
+tcodec_clear_dict (struct tcodec *t)
+{
+  memset (t->ekey, 0, TCODEC_HASH_SIZE * sizeof *t->ekey);
+  t->next_code = TCODEC_FIRST;
+}
+
+/* Compress SIZE bytes from BUF into T.  Return SIZE, or -1 on error.  */
+
+static ssize_t
+tcodec_write (void *cookie, char const *buf, size_t size)
+{
+  struct tcodec *t = cookie;
+
+  for (size_t i = 0; i < size; i++)
+    {
+      unsigned char c = buf[i];
+
+      if (t->prev < 0)
+        {
+          t->prev = c;
+          continue;
+        }
+
+      /* Look up (prev, c).  */
+      unsigned int key = ((unsigned int) t->prev << 8 | c) + 1;
+      size_t h = (key * 2654435761u) & (TCODEC_HASH_SIZE - 1);
+      while (t->ekey[h] && t->ekey[h] != key)
+        h = (h + 1) & (TCODEC_HASH_SIZE - 1);
+
+      if (t->ekey[h] == key)
+        {
+          t->prev = t->eval[h];
+          continue;
+        }
+
+      if (! tcodec_putcode (t, t->prev))
+        return -1;
+
+      if (t->next_code < TCODEC_NCODES)
+        {
+          t->ekey[h] = key;
+          t->eval[h] = t->next_code++;
+        }
+      else
+        {
+          if (! tcodec_putcode (t, TCODEC_CLEAR))
+            return -1;
+          tcodec_clear_dict (t);
+        }
+      t->prev = c;
+    }
+
+  return size;
+}
+
+/* Finish the compressed stream of T and release it.
+   Return 0 on success, EOF on failure.  */
+
+static int
+tcodec_close_write (void *cookie)
+{
+  struct tcodec *t = cookie;
+  bool ok = true;
+
+  if (0 <= t->prev)
+    ok &= tcodec_putcode (t, t->prev);
+  ok &= tcodec_putcode (t, TCODEC_STOP);
+  if (t->bitcount && ok)
+    ok &= tcodec_putbyte (t, t->bitbuf & 0xff);
+  ok &= tcodec_flush (t);
+  ok &= close (t->fd) == 0;
+
+  free (t->ekey);
+  free (t->eval);
+  free (t);
+  return ok ? 0 : EOF;
+}
+
+/* Refill the read buffer of T.  Return true if any input is buffered,
+   false on EOF or error (with errno set on error, 0 on EOF).  */
+
+static bool
+tcodec_fill (struct tcodec *t)
+{
+  while (true)
+    {
+      ssize_t n = read (t->fd, t->buf, TCODEC_BUFSIZE);
+      if (0 < n)
+        {
+          t->buflen = n;
+          t->bufpos = 0;
+          return true;
+        }
+      if (n == 0)
+        {
+          errno = 0;
+          return false;
+        }
+      if (errno != EINTR)
+        return false;
+    }
+}
+
+/* Read the next code from T into *CODE.  Return false at end of input.  */
+
+static bool
+tcodec_getcode (struct tcodec *t, unsigned int *code)
+{
+  while (t->bitcount < TCODEC_BITS)
+    {
+      if (t->bufpos == t->buflen && ! tcodec_fill (t))
+        return false;
+      t->bitbuf |= (unsigned int) t->buf[t->bufpos++] << t->bitcount;
+      t->bitcount += 8;
+    }
+  *code = t->bitbuf & (TCODEC_NCODES - 1);
+  t->bitbuf >>= TCODEC_BITS;
+  t->bitcount -= TCODEC_BITS;
+  return true;
+}
+
+/* Decompress up to SIZE bytes from T into BUF.
+   Return the number of bytes produced, 0 at end of stream, -1 on a
+   corrupt stream (with errno set to EIO) or on a read error.  */
+
+static ssize_t
+tcodec_read (void *cookie, char *buf, size_t size)
+{
+  struct tcodec *t = cookie;
+  size_t produced = 0;
+
+  while (produced < size)
+    {
+      /* Drain any pending expansion first.  */
+      while (t->dstacklen && produced < size)
+        buf[produced++] = t->dstack[--t->dstacklen];
+      if (produced == size || t->at_eof)
+        break;
+
+      unsigned int code;
+      if (! tcodec_getcode (t, &code))
+        {
+          if (errno)
+            return -1;
+          /* Truncated stream: treat like corruption.  */
+          errno = EIO;
+          return produced ? (ssize_t) produced : -1;
+        }
+
+      if (code == TCODEC_STOP)
+        {
+          t->at_eof = true;
+          break;
+        }
+      if (code == TCODEC_CLEAR)
+        {
+          t->next_code = TCODEC_FIRST;
+          t->prev = -1;
+          continue;
+        }
+
+      unsigned int incode = code;
+      size_t stackbase = t->dstacklen;
+
+      if (t->next_code <= code)
+        {
+          /* The KwKwK case: CODE is the one about to be assigned.  */
+          if (code != t->next_code || t->prev < 0)
+            {
+              errno = EIO;
+              return -1;
+            }
+          code = t->prev;
+          /* The expansion ends with its own first byte; reserve the
+             slot and fill it below once that byte is known.  */
+          t->dstack[t->dstacklen++] = 0;
+        }
+
+      while (TCODEC_FIRST <= code)
+        {
+          t->dstack[t->dstacklen++] = t->dsuffix[code];
+          code = t->dprefix[code];
+        }
+      t->dstack[t->dstacklen++] = code;
+
+      if (t->next_code <= incode)
+        t->dstack[stackbase] = code;
+
+      if (0 <= t->prev && t->next_code < TCODEC_NCODES)
+        {
+          t->dprefix[t->next_code] = t->prev;
+          t->dsuffix[t->next_code] = code;
+          t->next_code++;
+        }
+      t->prev = incode;
+    }
+
+  return produced;
+}
+
+/* Release the read side of T.  */
+
+static int
+tcodec_close_read (void *cookie)
+{
+  struct tcodec *t = cookie;
+  int r = close (t->fd);
+  free (t->dprefix);
+  free (t->dsuffix);
+  free (t->dstack);
+  free (t);
+  return r == 0 ? 0 : EOF;
+}
+
+/* Allocate common codec state over FD.  */
+
+static struct tcodec *
+tcodec_new (int fd)
+{
+  struct tcodec *t = xcalloc (1, sizeof *t);
+  t->fd = fd;
+  t->prev = -1;
+  t->next_code = TCODEC_FIRST;
+  return t;
+}
+
+/* Return a stream compressing writes onto FD, or NULL on failure.  */
+
+static FILE *
+tcodec_open_write (int fd)
+{
+  struct tcodec *t = tcodec_new (fd);
+  t->ekey = xcalloc (TCODEC_HASH_SIZE, sizeof *t->ekey);
+  t->eval = xnmalloc (TCODEC_HASH_SIZE, sizeof *t->eval);
+  memcpy (t->buf, tcodec_magic, sizeof tcodec_magic);
+  t->buflen = sizeof tcodec_magic;
+
+  cookie_io_functions_t io = { .write = tcodec_write,
+                               .close = tcodec_close_write };
+  FILE *fp = fopencookie (t, "w", io);
+  if (! fp)
+    {
+      free (t->ekey);
+      free (t->eval);
+      free (t);
+    }
+  return fp;
+}
+
+/* Return a stream decompressing reads from FD, or NULL on failure,
+   e.g. if FD does not start with the codec magic.  */
+
+static FILE *
+tcodec_open_read (int fd)
+{
+  struct tcodec *t = tcodec_new (fd);
+  t->dprefix = xnmalloc (TCODEC_NCODES, sizeof *t->dprefix);
+  t->dsuffix = xmalloc (TCODEC_NCODES);
+  /* Worst-case expansion of one code, plus the KwKwK slot.  */
+  t->dstack = xmalloc (TCODEC_NCODES + 1);
+
+  char magic[sizeof tcodec_magic];
+  ssize_t n = read (fd, magic, sizeof magic);
+  FILE *fp = NULL;
+  if (n == sizeof magic && memcmp (magic, tcodec_magic, sizeof magic) == 0)
+    {
+      cookie_io_functions_t io = { .read = tcodec_read,
+                                   .close = tcodec_close_read };
+      fp = fopencookie (t, "r", io);
+    }
+  else
+    errno = EIO;
+  if (! fp)
+    {
+      int saved_errno = errno;
+      free (t->dprefix);
+      free (t->dsuffix);
+      free (t->dstack);
+      free (t);
+      errno = saved_errno;
+    }
+  return fp;
+}
+
+#endif /* HAVE_FOPENCOOKIE */
+
 /* Fork a child process for piping to and do common cleanup.  The
    TRIES parameter specifies how many times to try to fork before
    giving up.  Return the PID of the child, or -1 (setting errno)
@@ -1127,6 +1658,7 @@ maybe_create_temp (FILE **pfp, bool survive_fd_exhaustion)
     {
       int pipefds[2];
 
+      pthread_mutex_lock (&temphead_lock);
       node->pid = pipe_fork (pipefds, MAX_FORK_TRIES_COMPRESS);
       if (0 < node->pid)
         {
@@ -1148,7 +1680,18 @@ maybe_create_temp (FILE **pfp, bool survive_fd_exhaustion)
 
           async_safe_die (errno, "couldn't execute compress program");
         }
+      pthread_mutex_unlock (&temphead_lock);
+    }
+#if HAVE_FOPENCOOKIE
+  else if (compress_temps)
+    {
+      node->state = INTERNAL;
+      *pfp = tcodec_open_write (tempfd);
+      if (! *pfp)
+        sort_die (_("couldn't create temporary file"), node->name);
+      return node;
     }
+#endif
 
   *pfp = fdopen (tempfd, "w");
   if (! *pfp)
@@ -1178,12 +1721,36 @@ open_temp (struct tempnode *temp)
   int tempfd, pipefds[2];
   FILE *fp = NULL;
 
+#if HAVE_FOPENCOOKIE
+  if (temp->state == INTERNAL)
+    {
+      tempfd = open (temp->name, O_RDONLY);
+      if (tempfd < 0)
+        return NULL;
+      fp = tcodec_open_read (tempfd);
+      if (! fp)
+        {
+          int saved_errno = errno;
+          close (tempfd);
+          errno = saved_errno;
+        }
+      return fp;
+    }
+#endif
+
+  pthread_mutex_lock (&temphead_lock);
+
   if (temp->state == UNREAPED)
     wait_proc (temp->pid);
 
   tempfd = open (temp->name, O_RDONLY);
   if (tempfd < 0)
-    return NULL;
+    {
+      int saved_errno = errno;
+      pthread_mutex_unlock (&temphead_lock);
+      errno = saved_errno;
+      return NULL;
+    }
 
   pid_t child = pipe_fork (pipefds, MAX_FORK_TRIES_DECOMPRESS);
 
@@ -1224,6 +1791,12 @@ open_temp (struct tempnode *temp)
       break;
     }
 
+  {
+    int saved_errno = errno;
+    pthread_mutex_unlock (&temphead_lock);
+    errno = saved_errno;
+  }
+
   return fp;
 }
 
@@ -1249,6 +1822,8 @@ zaptemp (char const *name)
   int unlink_errno = 0;
   struct cs_status cs;
 
+  pthread_mutex_lock (&temphead_lock);
+
   for (pnode = &temphead; (node = *pnode)->name != name; pnode = &node->next)
     continue;
 
@@ -1263,10 +1838,13 @@ zaptemp (char const *name)
   *pnode = next;
   cs_leave (&cs);
 
-  if (unlink_status != 0)
-    error (0, unlink_errno, _("warning: cannot remove: %s"), quotef (name));
   if (! next)
     temptail = pnode;
+
+  pthread_mutex_unlock (&temphead_lock);
+
+  if (unlink_status != 0)
+    error (0, unlink_errno, _("warning: cannot remove: %s"), quotef (name));
   free (node);
 }
 
@@ -1595,6 +2173,32 @@ initbuf (struct buffer *buf, size_t line_bytes, size_t alloc)
   buf->alloc = alloc;
   buf->used = buf->left = buf->nlines = 0;
   buf->eof = false;
+  buf->map = NULL;
+  buf->mapsize = 0;
+}
+
+/* Release any input mapping of BUF.  */
+
+static void
+unmapbuf (struct buffer *buf)
+{
+#if HAVE_MMAP
+  if (buf->map)
+    {
+      munmap (buf->map, buf->mapsize);
+      buf->map = NULL;
+      buf->mapsize = 0;
+    }
+#endif
+}
+
+/* Release the resources of BUF.  */
+
+static void
+freebuf (struct buffer *buf)
+{
+  unmapbuf (buf);
+  free (buf->buf);
 }
 
 /* Return one past the limit of the line array.  */
@@ -1750,40 +2354,468 @@ limfield (struct line const *line, struct keyfield const *key)
   return ptr;
 }
 
-/* Fill BUF reading from FP, moving buf->left bytes from the end
-   of buf->buf to the beginning first.  If EOF is reached and the
-   file wasn't terminated by a newline, supply one.  Set up BUF's line
-   table too.  FILE is the name of the file corresponding to FP.
-   Return true if some input was read.  */
-
-static bool
-fillbuf (struct buffer *buf, FILE *fp, char const *file)
+/* If true, each input line carries a binary prefix key, decoded once
+   at input scan time, that orders consistently with the single
+   numeric sort key (-n or -g); most comparisons then reduce to one
+   branchless integer compare, instead of reparsing the key's digits.
+   Cleared (sticky) as soon as a line is seen that the encoders below
+   cannot mirror faithfully; clearing at any point is safe, since the
+   prefix keys only ever defer to the exact comparators on ties.  */
+static bool use_numkeys;
+static bool numkeys_general;	/* Encode for -g rather than -n.  */
+static bool numkeys_collate;	/* Encode a collating transform prefix.  */
+static bool numkeys_reverse;	/* The key is reversed.  */
+
+/* Number of leading significant decimal digits packed into a prefix
+   key; 10^13 fits in 44 bits.  */
+enum { NUMKEY_DIGITS = 13 };
+
+/* Encode the -n style number in [TEXT, LIM) into an order-preserving
+   64-bit key: a sign, the count of integer-part digits, and the first
+   NUMKEY_DIGITS significant digits.  Two keys compare consistently
+   with numcompare wherever they differ.  */
+
+static uintmax_t
+numeric_prefix_key (char const *text, char const *lim)
 {
-  struct keyfield const *key = keylist;
-  char eol = eolchar;
-  size_t line_bytes = buf->line_bytes;
-  size_t mergesize = merge_buffer_size - MIN_MERGE_BUFFER_SIZE;
+  unsigned char const *p = (unsigned char const *) text;
+  unsigned char const *plim = (unsigned char const *) lim;
+  uintmax_t prefix = 0;
+  uintmax_t intlen = 0;
+  int ndigits = 0;
+  bool neg = false;
+
+  while (p < plim && blanks[*p])
+    p++;
+  if (p < plim && *p == '-')
+    {
+      neg = true;
+      p++;
+      if (p < plim && *p == '-')
+        {
+          /* Leave repeated signs to the exact comparator.  */
+          use_numkeys = false;
+          return 0;
+        }
+    }
 
-  if (buf->eof)
-    return false;
+  while (p < plim && *p == '0')
+    p++;
 
-  if (buf->used != buf->left)
+  for (; p < plim && ISDIGIT (*p); p++)
     {
-      memmove (buf->buf, buf->buf + buf->used - buf->left, buf->left);
-      buf->used = buf->left;
-      buf->nlines = 0;
+      intlen++;
+      if (ndigits < NUMKEY_DIGITS)
+        {
+          prefix = prefix * 10 + (*p - '0');
+          ndigits++;
+        }
     }
 
-  while (true)
+  if (p < plim && *p == decimal_point)
+    for (p++; p < plim && ISDIGIT (*p) && ndigits < NUMKEY_DIGITS; p++)
+      {
+        prefix = prefix * 10 + (*p - '0');
+        ndigits++;
+      }
+
+  /* Left-align the significant digits, so that e.g. ".05" < ".5".
+     Anything past the number is irrelevant to numcompare too.  */
+  while (ndigits < NUMKEY_DIGITS)
     {
-      char *ptr = buf->buf + buf->used;
-      struct line *linelim = buffer_linelim (buf);
-      struct line *line = linelim - buf->nlines;
-      size_t avail = (char *) linelim - buf->nlines * line_bytes - ptr;
-      char *line_start = buf->nlines ? line->text + line->length : buf->buf;
+      prefix *= 10;
+      ndigits++;
+    }
 
-      while (line_bytes + 1 < avail)
-        {
+  uintmax_t magnitude = (MIN (intlen, (uintmax_t) 0x3ffff) << 44) | prefix;
+  uintmax_t mid = (uintmax_t) 1 << 63;
+  return neg ? mid - magnitude : mid + magnitude;
+}
+
+/* Encode the -g style number in [TEXT, LIM) into an order-preserving
+   64-bit key: a class (conversion errors, then NaNs, then numbers,
+   as general_numcompare orders them) and the number's value rounded
+   to double.  Two keys compare consistently with general_numcompare
+   wherever they differ.  */
+
+static uintmax_t
+general_prefix_key (char const *text, char const *lim)
+{
+  char copy[64];
+  size_t len = lim - text;
+  uintmax_t cls;
+  uintmax_t bits = 0;
+
+  if (lim < text)
+    len = 0;
+  if (sizeof copy <= len)
+    {
+      /* An outlandishly long key; leave it to the exact comparator.  */
+      use_numkeys = false;
+      return 0;
+    }
+  memcpy (copy, text, len);
+  copy[len] = '\0';
+
+  char *end;
+  long double val = strtold (copy, &end);
+  if (end == copy)
+    cls = 0;
+  else if (val != val)
+    cls = 1;
+  else
+    {
+      cls = 2;
+      double d = val;
+      if (d == 0)
+        d = 0;			/* Canonicalize -0, as -0 == +0 here.  */
+      memcpy (&bits, &d, sizeof d);
+      uintmax_t sign = (uintmax_t) 1 << 63;
+      bits = bits & sign ? ~bits : bits | sign;
+    }
+
+  return cls << 62 | bits >> 2;
+}
+
+/* Encode the collating transform of [TEXT, LIM) into an
+   order-preserving 64-bit key: the first 8 transformed bytes,
+   big-endian, zero padded.  Transforms contain no embedded NULs, so
+   the zero pad orders shorter transforms first, just as the strcmp
+   underlying strcoll does.  Two keys compare consistently with
+   xmemcoll0 wherever they differ.  */
+
+static uintmax_t
+collate_prefix_key (char const *text, char const *lim)
+{
+  char copy[128];
+  char xfrm[1024];
+  size_t len = lim - text;
+  char const *s;
+
+  if (lim < text)
+    len = 0;
+  if (*lim == '\0')
+    s = text;			/* Already terminated in place.  */
+  else if (len < sizeof copy)
+    {
+      memcpy (copy, text, len);
+      copy[len] = '\0';
+      s = copy;
+    }
+  else
+    {
+      /* An outlandishly long key; leave it to the exact comparator.  */
+      use_numkeys = false;
+      return 0;
+    }
+
+  size_t n = strxfrm (xfrm, s, sizeof xfrm);
+  if (sizeof xfrm <= n)
+    {
+      use_numkeys = false;
+      return 0;
+    }
+
+  uintmax_t k = 0;
+  size_t take = MIN (n, sizeof k);
+  for (size_t i = 0; i < take; i++)
+    k = k << 8 | to_uchar (xfrm[i]);
+  k <<= 8 * (sizeof k - take);
+  return k;
+}
+
+/* Precompute the first-key positions (and any binary prefix key) of
+   LINE, whose text has just been NUL-delimited; P points at the
+   terminating NUL.  */
+
+static void
+line_record_key (struct line *line, struct keyfield const *key, char *p)
+{
+  line->keylim = (key->eword == SIZE_MAX
+                  ? p
+                  : limfield (line, key));
+
+  if (key->sword != SIZE_MAX)
+    line->keybeg = begfield (line, key);
+  else
+    {
+      char *line_start = line->text;
+      if (key->skipsblanks)
+        while (blanks[to_uchar (*line_start)])
+          line_start++;
+      line->keybeg = line_start;
+    }
+
+  if (use_numkeys)
+    line->numkey = (numkeys_collate
+                    ? collate_prefix_key (line->keybeg, line->keylim)
+                    : numkeys_general
+                    ? general_prefix_key (line->keybeg, line->keylim)
+                    : numeric_prefix_key (line->keybeg, line->keylim));
+}
+
+#if HAVE_MMAP
+
+/* Try to fill BUF by mapping the rest of the regular file FP into
+   memory and recording its lines in place, so the text is not copied
+   through a read buffer; delimiting lines with NUL then dirties the
+   private mapping one page at a time instead.  This requires the
+   whole remainder to be processed as one buffer, its line table to
+   fit in BUF's existing allocation, and the file to end with the
+   line delimiter, since the mapping cannot be grown to supply one.
+   Return true if BUF was filled this way.  */
+
+static bool
+fillbuf_mmap (struct buffer *buf, FILE *fp)
+{
+  struct stat st;
+  int fd = fileno (fp);
+
+  if (buf->left || buf->map)
+    return false;
+  if (fstat (fd, &st) != 0 || ! S_ISREG (st.st_mode) || st.st_size == 0)
+    return false;
+  if (ftello (fp) != 0)
+    return false;
+
+  size_t size = st.st_size;
+  if ((off_t) size != st.st_size)
+    return false;
+
+  char lastbyte;
+  if (pread (fd, &lastbyte, 1, st.st_size - 1) != 1
+      || lastbyte != eolchar)
+    return false;
+
+  char *map = mmap (NULL, size, PROT_READ | PROT_WRITE, MAP_PRIVATE, fd, 0);
+  if (map == MAP_FAILED)
+    return false;
+
+  /* Count the lines, and make sure their table fits.  */
+  size_t nlines = 0;
+  char eol = eolchar;
+  char *mapend = map + size;
+  for (char *p = map; (p = memchr (p, eol, mapend - p)); p++)
+    nlines++;
+  if (buf->alloc / sizeof (struct line) < nlines)
+    {
+      munmap (map, size);
+      return false;
+    }
+
+  struct keyfield const *key = keylist;
+  struct line *line = buffer_linelim (buf);
+  size_t mergesize = merge_buffer_size - MIN_MERGE_BUFFER_SIZE;
+  char *line_start = map;
+  char *p;
+  while ((p = memchr (line_start, eol, mapend - line_start)))
+    {
+      *p = '\0';
+      line--;
+      line->text = line_start;
+      line->length = p + 1 - line_start;
+      mergesize = MAX (mergesize, line->length);
+      if (key)
+        line_record_key (line, key, p);
+      else if (use_numkeys)
+        line->numkey = collate_prefix_key (line->text, p);
+      line_start = p + 1;
+    }
+
+  buf->map = map;
+  buf->mapsize = size;
+  buf->nlines = nlines;
+  buf->used = buf->left = 0;
+  buf->eof = true;
+  merge_buffer_size = mergesize + MIN_MERGE_BUFFER_SIZE;
+  return true;
+}
+
+#endif /* HAVE_MMAP */
+
+/* Fill BUF reading length-prefixed records from FP; the analogue of
+   fillbuf below for --length-prefixed input, it decodes each record's
+   length instead of scanning for a delimiter byte.  A record's
+   payload is slid down over its own prefix, which leaves room to
+   append the NUL that the rest of sort expects in place of a line's
+   delimiter.  A record split across reads is carried over in
+   buf->left and redecoded, just as a partial line is.  FILE is the
+   name of the file corresponding to FP.  Return true if some input
+   was read.  */
+
+static bool
+fillbuf_prefixed (struct buffer *buf, FILE *fp, char const *file)
+{
+  struct keyfield const *key = keylist;
+  size_t line_bytes = buf->line_bytes;
+  size_t mergesize = merge_buffer_size - MIN_MERGE_BUFFER_SIZE;
+
+  if (buf->used != buf->left)
+    {
+      memmove (buf->buf, buf->buf + buf->used - buf->left, buf->left);
+      buf->used = buf->left;
+      buf->nlines = 0;
+    }
+
+  /* The start of the first not yet decoded record.  */
+  char *rec = buf->buf;
+
+  while (true)
+    {
+      char *ptr = buf->buf + buf->used;
+      struct line *linelim = buffer_linelim (buf);
+      struct line *line = linelim - buf->nlines;
+      size_t avail = (char *) linelim - buf->nlines * line_bytes - ptr;
+
+      while (line_bytes + 1 < avail)
+        {
+          /* As in fillbuf, leave room for the line array in the worst
+             case, here a stream of one-byte empty records.  */
+          size_t readsize = (avail - 1) / (line_bytes + 1);
+          size_t bytes_read = fread (ptr, 1, readsize, fp);
+          char *ptrlim = ptr + bytes_read;
+          avail -= bytes_read;
+          if (stats)
+            sort_stats.bytes_read += bytes_read;
+
+          if (bytes_read != readsize)
+            {
+              if (ferror (fp))
+                sort_die (_("read failed"), file);
+              if (feof (fp))
+                {
+                  buf->eof = true;
+                  if (buf->buf == ptrlim)
+                    return false;
+                }
+            }
+
+          /* Decode and record each complete record just read.  */
+          while (rec < ptrlim)
+            {
+              uintmax_t len;
+              size_t n = varint_decode (rec, ptrlim - rec, &len);
+
+              if (n == SIZE_MAX || (n != 0 && SIZE_MAX - 1 < len))
+                die (SORT_FAILURE, 0, _("%s: invalid record length prefix"),
+                     quotef (file));
+              if (n == 0 || (uintmax_t) (ptrlim - rec - n) < len)
+                {
+                  /* An incomplete record; redecode it after the next
+                     read, unless no more input is coming.  */
+                  if (buf->eof)
+                    die (SORT_FAILURE, 0,
+                         _("%s: truncated length-prefixed record"),
+                         quotef (file));
+                  break;
+                }
+
+              /* Slide the payload down over its prefix, leaving room
+                 to NUL-terminate it as for a delimited line.  */
+              memmove (rec, rec + n, len);
+              rec[len] = '\0';
+              line--;
+              line->text = rec;
+              line->length = len + 1;
+              mergesize = MAX (mergesize, line->length);
+              avail -= line_bytes;
+
+              if (key)
+                line_record_key (line, key, rec + len);
+              else if (use_numkeys)
+                line->numkey = collate_prefix_key (line->text, rec + len);
+
+              rec += n + len;
+            }
+
+          ptr = ptrlim;
+          if (buf->eof)
+            break;
+        }
+
+      buf->used = ptr - buf->buf;
+      buf->nlines = buffer_linelim (buf) - line;
+      if (buf->nlines != 0)
+        {
+          buf->left = ptr - rec;
+          merge_buffer_size = mergesize + MIN_MERGE_BUFFER_SIZE;
+          if (stats)
+            sort_stats.lines_read += buf->nlines;
+          return true;
+        }
+
+      if (buf->eof)
+        return false;
+
+      {
+        /* The current record is too long to fit in the buffer.
+           Increase the buffer size and try again, keeping it properly
+           aligned.  */
+        size_t line_alloc = buf->alloc / sizeof (struct line);
+        buf->buf = x2nrealloc (buf->buf, &line_alloc, sizeof (struct line));
+        buf->alloc = line_alloc * sizeof (struct line);
+        rec = buf->buf;		/* No record was decoded, so none moved.  */
+      }
+    }
+}
+
+/* Fill BUF reading from FP, moving buf->left bytes from the end
+   of buf->buf to the beginning first.  If EOF is reached and the
+   file wasn't terminated by a newline, supply one.  Set up BUF's line
+   table too.  FILE is the name of the file corresponding to FP.
+   Return true if some input was read.  */
+
+static bool
+fillbuf (struct buffer *buf, FILE *fp, char const *file)
+{
+  struct keyfield const *key = keylist;
+  char eol = eolchar;
+  size_t line_bytes = buf->line_bytes;
+  size_t mergesize = merge_buffer_size - MIN_MERGE_BUFFER_SIZE;
+
+  COREUTILS_PROBE1 (sort_fillbuf, file);
+
+  if (stats_requested)
+    {
+      stats_requested = 0;
+      stats_report ();
+    }
+
+  if (buf->eof)
+    return false;
+
+  if (length_prefixed)
+    return fillbuf_prefixed (buf, fp, file);
+
+#if HAVE_MMAP
+  if (fillbuf_mmap (buf, fp))
+    {
+      if (stats)
+        {
+          sort_stats.bytes_read += buf->mapsize;
+          sort_stats.lines_read += buf->nlines;
+        }
+      return true;
+    }
+#endif
+
+  if (buf->used != buf->left)
+    {
+      memmove (buf->buf, buf->buf + buf->used - buf->left, buf->left);
+      buf->used = buf->left;
+      buf->nlines = 0;
+    }
+
+  while (true)
+    {
+      char *ptr = buf->buf + buf->used;
+      struct line *linelim = buffer_linelim (buf);
+      struct line *line = linelim - buf->nlines;
+      size_t avail = (char *) linelim - buf->nlines * line_bytes - ptr;
+      char *line_start = buf->nlines ? line->text + line->length : buf->buf;
+
+      while (line_bytes + 1 < avail)
+        {
           /* Read as many bytes as possible, but do not read so many
              bytes that there might not be enough room for the
              corresponding line array.  The worst case is when the
@@ -1794,6 +2826,8 @@ fillbuf (struct buffer *buf, FILE *fp, char const *file)
           char *ptrlim = ptr + bytes_read;
           char *p;
           avail -= bytes_read;
+          if (stats)
+            sort_stats.bytes_read += bytes_read;
 
           if (bytes_read != readsize)
             {
@@ -1827,20 +2861,10 @@ fillbuf (struct buffer *buf, FILE *fp, char const *file)
                 {
                   /* Precompute the position of the first key for
                      efficiency.  */
-                  line->keylim = (key->eword == SIZE_MAX
-                                  ? p
-                                  : limfield (line, key));
-
-                  if (key->sword != SIZE_MAX)
-                    line->keybeg = begfield (line, key);
-                  else
-                    {
-                      if (key->skipsblanks)
-                        while (blanks[to_uchar (*line_start)])
-                          line_start++;
-                      line->keybeg = line_start;
-                    }
+                  line_record_key (line, key, p);
                 }
+              else if (use_numkeys)
+                line->numkey = collate_prefix_key (line->text, p);
 
               line_start = ptr;
             }
@@ -1856,6 +2880,8 @@ fillbuf (struct buffer *buf, FILE *fp, char const *file)
         {
           buf->left = ptr - line_start;
           merge_buffer_size = mergesize + MIN_MERGE_BUFFER_SIZE;
+          if (stats)
+            sort_stats.lines_read += buf->nlines;
           return true;
         }
 
@@ -2742,6 +3768,14 @@ compare (struct line const *a, struct line const *b)
      and unadorned sort -r. */
   if (keylist)
     {
+      if (use_numkeys)
+        {
+          /* The precomputed prefix keys decide most comparisons with
+             a single branchless compare; ties defer to keycompare.  */
+          diff = (b->numkey < a->numkey) - (a->numkey < b->numkey);
+          if (diff)
+            return numkeys_reverse ? -diff : diff;
+        }
       diff = keycompare (a, b);
       if (diff || unique || stable)
         return diff;
@@ -2749,6 +3783,12 @@ compare (struct line const *a, struct line const *b)
 
   /* If the keys all compare equal (or no keys were specified)
      fall through to the default comparison.  */
+  if (use_numkeys && !keylist)
+    {
+      diff = (b->numkey < a->numkey) - (a->numkey < b->numkey);
+      if (diff)
+        return reverse ? -diff : diff;
+    }
   alen = a->length - 1, blen = b->length - 1;
 
   if (alen == 0)
@@ -2799,6 +3839,14 @@ write_line (struct line const *line, FILE *fp, char const *output_file)
 
       debug_line (line);
     }
+  else if (length_prefixed)
+    {
+      char prefix[VARINT_BYTES_BOUND];
+      size_t n = varint_encode (prefix, n_bytes - 1);
+      if (fwrite (prefix, 1, n, fp) != n
+          || fwrite (buf, 1, n_bytes - 1, fp) != n_bytes - 1)
+        sort_die (_("write failed"), output_file);
+    }
   else
     {
       ebuf[-1] = eolchar;
@@ -2808,6 +3856,169 @@ write_line (struct line const *line, FILE *fp, char const *output_file)
     }
 }
 
+/* Identifies the --check-state format and the running architecture.  */
+static char const check_state_magic[] = "GNU sort check state 1\n";
+
+/* Fixed part of a --check-state file; the bytes of the trailing
+   verified line follow, with its delimiter replaced by NUL.  */
+struct check_state
+{
+  dev_t dev;			/* Identity of the checked file.  */
+  ino_t ino;
+  off_t offset;			/* Bytes verified to be in order.  */
+  uintmax_t line_number;	/* Lines in those bytes.  */
+  uint32_t opts;		/* Digest of ordering-relevant settings.  */
+  size_t last_length;		/* Length of the trailing verified line,
+                                   delimiter included.  */
+};
+
+/* Mix the N bytes at P into the settings digest H and return the
+   result.  */
+
+static uint32_t
+check_state_digest (uint32_t h, void const *p, size_t n)
+{
+  char const *s = p;
+  while (n--)
+    h = h * 33 ^ to_uchar (*s++);
+  return h;
+}
+
+/* Return a digest of every setting that can change the line order
+   -c/-C accepts, so that state recorded under one invocation is not
+   trusted by an invocation that compares differently.  */
+
+static uint32_t
+check_state_opts (void)
+{
+  uint32_t h = 5381;
+  char flags[4] = { eolchar, unique, stable, reverse };
+  h = check_state_digest (h, flags, sizeof flags);
+  h = check_state_digest (h, &tab, sizeof tab);
+  if (hard_LC_COLLATE)
+    {
+      char const *loc = setlocale (LC_COLLATE, NULL);
+      h = check_state_digest (h, loc, strlen (loc));
+    }
+
+  for (struct keyfield const *key = keylist; key; key = key->next)
+    {
+      size_t words[4] = { key->sword, key->schar, key->eword, key->echar };
+      h = check_state_digest (h, words, sizeof words);
+      char kflags[10] =
+        {
+          key->ignore == nondictionary ? 1 : key->ignore ? 2 : 0,
+          !! key->translate, key->skipsblanks, key->skipeblanks,
+          key->numeric, key->general_numeric, key->human_numeric,
+          key->month, key->reverse, key->version
+        };
+      h = check_state_digest (h, kflags, sizeof kflags);
+    }
+
+  return h;
+}
+
+/* Try to resume checking FP from the state in check_state_file.  The
+   state must name the same file as *INSTAT, match the settings digest
+   OPTS, and cover no more than the file's current size, and the bytes
+   just before the recorded offset must still hold the recorded
+   trailing line; if so the verified prefix is assumed unchanged, as
+   with an append-only file.  On success, seek FP to the verified
+   offset, load the trailing line into TEMP with its first-key
+   positions recomputed, set *ALLOC to its allocation and *LINE_NUMBER
+   to the verified line count, and return true.  On failure leave FP
+   positioned at the beginning.  */
+
+static bool
+check_state_resume (FILE *fp, struct stat const *instat, uint32_t opts,
+                    struct line *temp, size_t *alloc,
+                    uintmax_t *line_number)
+{
+  FILE *sf = fopen (check_state_file, "rb");
+  if (! sf)
+    return false;
+
+  bool ok = false;
+  char magic[sizeof check_state_magic - 1];
+  struct check_state st;
+  char *last = NULL;
+
+  if (fread (magic, 1, sizeof magic, sf) == sizeof magic
+      && memcmp (magic, check_state_magic, sizeof magic) == 0
+      && fread (&st, sizeof st, 1, sf) == 1
+      && st.dev == instat->st_dev && st.ino == instat->st_ino
+      && st.opts == opts
+      && 0 < st.last_length && st.last_length <= st.offset
+      && st.offset <= instat->st_size)
+    {
+      last = xmalloc (st.last_length);
+      if (fread (last, 1, st.last_length, sf) == st.last_length)
+        {
+          char *probe = xmalloc (st.last_length);
+          if (fseeko (fp, st.offset - st.last_length, SEEK_SET) == 0
+              && fread (probe, 1, st.last_length, fp) == st.last_length
+              && memcmp (probe, last, st.last_length - 1) == 0
+              && probe[st.last_length - 1] == eolchar)
+            ok = true;
+          free (probe);
+        }
+    }
+  fclose (sf);
+
+  if (! ok)
+    {
+      free (last);
+      if (fseeko (fp, 0, SEEK_SET) != 0)
+        die (SORT_FAILURE, errno, _("cannot seek in input"));
+      return false;
+    }
+
+  free (temp->text);
+  temp->text = last;
+  temp->length = st.last_length;
+  temp->text[st.last_length - 1] = '\0';
+  *alloc = st.last_length;
+  if (keylist)
+    line_record_key (temp, keylist, temp->text + st.last_length - 1);
+  *line_number = st.line_number;
+  return true;
+}
+
+/* Record in check_state_file that the first OFFSET bytes of the input
+   identified by *INSTAT, comprising LINE_NUMBER lines and ending with
+   the line in TEMP, are in order under the settings digest OPTS.  */
+
+static void
+check_state_save (struct stat const *instat, uint32_t opts,
+                  off_t offset, uintmax_t line_number,
+                  struct line const *temp)
+{
+  FILE *sf = fopen (check_state_file, "wb");
+  if (! sf)
+    {
+      error (0, errno, _("cannot create %s"), quoteaf (check_state_file));
+      return;
+    }
+
+  struct check_state st;
+  memset (&st, 0, sizeof st);
+  st.dev = instat->st_dev;
+  st.ino = instat->st_ino;
+  st.offset = offset;
+  st.line_number = line_number;
+  st.opts = opts;
+  st.last_length = temp->length;
+
+  fwrite (check_state_magic, 1, sizeof check_state_magic - 1, sf);
+  fwrite (&st, sizeof st, 1, sf);
+  fwrite (temp->text, 1, temp->length, sf);
+  bool ok = ! ferror (sf);
+  if (fclose (sf) != 0)
+    ok = false;
+  if (! ok)
+    error (0, errno, _("error writing %s"), quoteaf (check_state_file));
+}
+
 /* Check that the lines read from FILE_NAME come in order.  Return
    true if they are in order.  If CHECKONLY == 'c', also print a
    diagnostic (FILE_NAME, line number, contents of line) to stderr if
@@ -2817,6 +4028,8 @@ static bool
 check (char const *file_name, char checkonly)
 {
   FILE *fp = xfopen (file_name, "r");
+  if (decompress_input)
+    fp = dec_input_stream (fp, file_name, SORT_FAILURE);
   struct buffer buf;		/* Input buffer. */
   struct line temp;		/* Copy of previous line. */
   size_t alloc = 0;
@@ -2825,10 +4038,29 @@ check (char const *file_name, char checkonly)
   bool nonunique = ! unique;
   bool ordered = true;
 
+  /* Identity of the input when --check-state applies to it; only a
+     regular file's progress can be recorded.  */
+  struct stat instat;
+  bool resumable = false;
+  uint32_t opts = 0;
+  off_t nbytes = 0;
+
+  if (check_state_file
+      && fstat (fileno (fp), &instat) == 0
+      && S_ISREG (instat.st_mode))
+    {
+      resumable = true;
+      opts = check_state_opts ();
+    }
+
   initbuf (&buf, sizeof (struct line),
            MAX (merge_buffer_size, sort_size));
   temp.text = NULL;
 
+  if (resumable
+      && check_state_resume (fp, &instat, opts, &temp, &alloc, &line_number))
+    nbytes = ftello (fp);
+
   while (fillbuf (&buf, fp, file_name))
     {
       struct line const *line = buffer_linelim (&buf);
@@ -2863,6 +4095,9 @@ check (char const *file_name, char checkonly)
           goto found_disorder;
 
       line_number += buf.nlines;
+      if (resumable)
+        for (struct line const *l = linebase; l < buffer_linelim (&buf); l++)
+          nbytes += l->length;
 
       /* Save the last line of the buffer.  */
       if (alloc < line->length)
@@ -2887,11 +4122,15 @@ check (char const *file_name, char checkonly)
         {
           temp.keybeg = temp.text + (line->keybeg - line->text);
           temp.keylim = temp.text + (line->keylim - line->text);
+          temp.numkey = line->numkey;
         }
     }
 
+  if (resumable && ordered && temp.text)
+    check_state_save (&instat, opts, nbytes, line_number, &temp);
+
   xfclose (fp, file_name);
-  free (buf.buf);
+  freebuf (&buf);
   free (temp.text);
   return ordered;
 }
@@ -2915,6 +4154,9 @@ open_input_files (struct sortfile *files, size_t nfiles, FILE ***pfps)
                 : stream_open (files[i].name, "r"));
       if (!fps[i])
         break;
+      /* Temporaries hold already-decompressed data.  */
+      if (decompress_input && ! files[i].temp)
+        fps[i] = dec_input_stream (fps[i], files[i].name, SORT_FAILURE);
     }
 
   return i;
@@ -2952,6 +4194,15 @@ mergefps (struct sortfile *files, size_t ntemps, size_t nfiles,
   struct keyfield const *key = keylist;
   saved.text = NULL;
 
+  COREUTILS_PROBE2 (sort_mergefps, nfiles, ntemps);
+
+  if (stats)
+    {
+      sort_stats.merges++;
+      if (sort_stats.max_merge_fanin < nfiles)
+        sort_stats.max_merge_fanin = nfiles;
+    }
+
   /* Read initial lines from each input file. */
   for (i = 0; i < nfiles; )
     {
@@ -2973,7 +4224,7 @@ mergefps (struct sortfile *files, size_t ntemps, size_t nfiles,
               ntemps--;
               zaptemp (files[i].name);
             }
-          free (buffer[i].buf);
+          freebuf (&buffer[i]);
           --nfiles;
           for (j = i; j < nfiles; ++j)
             {
@@ -3030,6 +4281,7 @@ mergefps (struct sortfile *files, size_t ntemps, size_t nfiles,
                     saved.text + (smallest->keybeg - smallest->text);
                   saved.keylim =
                     saved.text + (smallest->keylim - smallest->text);
+                  saved.numkey = smallest->numkey;
                 }
             }
         }
@@ -3060,7 +4312,7 @@ mergefps (struct sortfile *files, size_t ntemps, size_t nfiles,
                   ntemps--;
                   zaptemp (files[ord[0]].name);
                 }
-              free (buffer[ord[0]].buf);
+              freebuf (&buffer[ord[0]]);
               for (i = ord[0]; i < nfiles; ++i)
                 {
                   fps[i] = fps[i + 1];
@@ -3139,6 +4391,148 @@ mergefiles (struct sortfile *files, size_t ntemps, size_t nfiles,
   return nopened;
 }
 
+/* A unit of work for one thread of a multithreaded merge pass:
+   merge COUNT input files, the first NTEMPS of which are
+   temporaries, into the temporary file TEMP.  */
+
+struct merge_group
+{
+  struct sortfile *files;	/* First input file of this group.  */
+  size_t ntemps;		/* Leading temp files in this group.  */
+  size_t count;			/* Number of input files.  */
+  struct tempnode *temp;	/* Output temporary file.  */
+  FILE *tfp;			/* Stream open on TEMP.  */
+  size_t num_merged;		/* Files actually merged; set on exit.  */
+  pthread_t thread;		/* Thread running this group, if any.  */
+  bool threaded;		/* Whether THREAD was created.  */
+};
+
+/* Thread start routine that merges one group of input files.  */
+
+static void *
+merge_group_thread (void *arg)
+{
+  struct merge_group *group = arg;
+  group->num_merged = mergefiles (group->files, group->ntemps, group->count,
+                                  group->tfp, group->temp->name);
+  return NULL;
+}
+
+/* GROUP merged fewer files than requested, because descriptors ran
+   out while other groups were active.  Sequentially merge its output
+   together with the files left over into a fresh temporary, so that
+   the result is equivalent to a full merge of the group.  The output
+   precedes the leftovers, and the leftovers keep their input order,
+   so stability is preserved.  */
+
+static void
+merge_group_fixup (struct merge_group *group)
+{
+  size_t nleft = group->count - group->num_merged;
+  size_t nsub = nleft + 1;
+  struct sortfile *sub = xnmalloc (nsub, sizeof *sub);
+  size_t subtemps = 1 + (group->num_merged < group->ntemps
+                         ? group->ntemps - group->num_merged
+                         : 0);
+
+  sub[0].name = group->temp->name;
+  sub[0].temp = group->temp;
+  memcpy (&sub[1], &group->files[group->num_merged], nleft * sizeof *sub);
+
+  while (true)
+    {
+      FILE *tfp;
+      struct tempnode *temp = create_temp (&tfp);
+      size_t num_merged = mergefiles (sub, MIN (subtemps, nsub), nsub,
+                                      tfp, temp->name);
+      size_t left = nsub - num_merged;
+      group->temp = temp;
+      if (left == 0)
+        break;
+      memmove (&sub[1], &sub[num_merged], left * sizeof *sub);
+      sub[0].name = temp->name;
+      sub[0].temp = temp;
+      subtemps = 1 + (num_merged < subtemps ? subtemps - num_merged : 0);
+      nsub = left + 1;
+    }
+
+  free (sub);
+}
+
+/* Perform one intermediate merge pass over FILES using up to
+   NTHREADS threads.  NGROUPS full NMERGE-sized groups are merged,
+   each into its own temporary file.  The resulting temporaries are
+   stored into FILES[0 .. NGROUPS-1] in group order, so stability is
+   not affected.  *PNTEMPS is decremented by the number of input
+   temporaries consumed.  Return the number of input files consumed,
+   i.e. NGROUPS * NMERGE.  */
+
+static size_t
+merge_pass_parallel (struct sortfile *files, size_t *pntemps,
+                     size_t ngroups, size_t nthreads)
+{
+  struct merge_group *groups = xnmalloc (ngroups, sizeof *groups);
+  size_t remaining_temps = *pntemps;
+  struct rlimit rlimit;
+
+  /* Each active group holds NMERGE input streams and one output
+     stream open, so bound the number of simultaneously active groups
+     by what RLIMIT_NOFILE allows, leaving the usual 3 spare.  */
+  size_t max_active = MIN (nthreads, ngroups);
+  if (getrlimit (RLIMIT_NOFILE, &rlimit) == 0)
+    {
+      size_t fd_budget = (rlimit.rlim_cur <= 3 + nmerge + 1
+                          ? 1
+                          : (rlimit.rlim_cur - 3) / (nmerge + 1));
+      max_active = MIN (max_active, MAX (fd_budget, 1));
+    }
+
+  for (size_t g = 0; g < ngroups; )
+    {
+      size_t batch = MIN (max_active, ngroups - g);
+      size_t i;
+
+      for (i = 0; i < batch; i++)
+        {
+          struct merge_group *group = &groups[g + i];
+          group->files = &files[(g + i) * nmerge];
+          group->ntemps = MIN (remaining_temps, nmerge);
+          remaining_temps -= group->ntemps;
+          group->count = nmerge;
+          group->temp = create_temp (&group->tfp);
+          group->num_merged = 0;
+          group->threaded =
+            (i + 1 < batch
+             && pthread_create (&group->thread, NULL,
+                                merge_group_thread, group) == 0);
+          /* Merge the last group of the batch (and any group whose
+             thread could not be created) in this thread.  */
+          if (! group->threaded)
+            merge_group_thread (group);
+        }
+
+      for (i = 0; i < batch; i++)
+        if (groups[g + i].threaded)
+          pthread_join (groups[g + i].thread, NULL);
+
+      for (i = 0; i < batch; i++)
+        if (groups[g + i].num_merged < groups[g + i].count)
+          merge_group_fixup (&groups[g + i]);
+
+      g += batch;
+    }
+
+  for (size_t g = 0; g < ngroups; g++)
+    {
+      files[g].name = groups[g].temp->name;
+      files[g].temp = groups[g].temp;
+    }
+
+  *pntemps = remaining_temps;
+  free (groups);
+  return ngroups * nmerge;
+}
+
 /* Merge into T (of size NLINES) the two sorted arrays of lines
    LO (with NLINES / 2 members), and
    T - (NLINES / 2) (with NLINES - NLINES / 2 members).
@@ -3435,6 +4829,110 @@ write_unique (struct line const *line, FILE *tfp, char const *temp_output)
   write_line (line, tfp, temp_output);
 }
 
+/* Number of lines below which comparison sorting in cache beats
+   making eight counting-sort passes over the line array.  */
+enum { RADIX_SORT_THRESHOLD = 1024 };
+
+/* If every line carries a binary prefix key, sort LINES (a reversed
+   array of NLINES lines, as for sequential_sort) with a stable
+   least-significant-byte radix sort on those keys, resolve runs of
+   equal keys with the exact comparator, and write the result to TFP
+   as write_unique does.  Return false without doing anything if the
+   keys are unavailable, NLINES is too small to profit, or scratch
+   memory cannot be had; the caller then falls back to comparison
+   sorting.  TEMP_OUTPUT is the name of TFP, or is null if TFP is
+   standard output.  */
+
+static bool
+sortlines_radix (struct line *restrict lines, size_t nlines,
+                 FILE *tfp, char const *temp_output)
+{
+  if (! use_numkeys || nlines < RADIX_SORT_THRESHOLD)
+    return false;
+
+  /* Prefix keys order lines ascending; complementing them makes the
+     same passes produce descending order, matching what compare does
+     when the sort is reversed.  */
+  uintmax_t flip = ((keylist ? numkeys_reverse : reverse)
+                    ? UINTMAX_MAX : 0);
+
+  struct line *base = lines - nlines;
+  struct line *scratch = malloc (nlines * sizeof *scratch);
+  if (! scratch)
+    return false;
+
+  /* Put BASE in input order; the reversed layout would only
+     complicate the counting-sort passes.  */
+  for (size_t lo = 0, hi = nlines - 1; lo < hi; lo++, hi--)
+    {
+      struct line t = base[lo];
+      base[lo] = base[hi];
+      base[hi] = t;
+    }
+
+  /* Eight stable counting-sort passes, least significant byte first,
+     ping-ponging between BASE and SCRATCH.  Passes whose byte is
+     constant across all keys are skipped.  */
+  struct line *src = base;
+  struct line *dst = scratch;
+  for (int shift = 0; shift < 64; shift += 8)
+    {
+      size_t count[256] = { 0 };
+      for (size_t i = 0; i < nlines; i++)
+        count[(src[i].numkey ^ flip) >> shift & 0xff]++;
+
+      int byte = (src[0].numkey ^ flip) >> shift & 0xff;
+      if (count[byte] == nlines)
+        continue;
+
+      size_t pos = 0;
+      for (int b = 0; b < 256; b++)
+        {
+          size_t c = count[b];
+          count[b] = pos;
+          pos += c;
+        }
+      for (size_t i = 0; i < nlines; i++)
+        dst[count[(src[i].numkey ^ flip) >> shift & 0xff]++] = src[i];
+
+      struct line *t = src;
+      src = dst;
+      dst = t;
+    }
+  if (src != base)
+    memcpy (base, src, nlines * sizeof *base);
+
+  /* Lines with equal prefix keys are still in input order; sort each
+     such run exactly.  The run is reversed into sequential_sort's
+     layout, sorted into SCRATCH, and copied back in output order.  */
+  for (size_t i = 0; i < nlines; )
+    {
+      size_t j = i + 1;
+      while (j < nlines && base[j].numkey == base[i].numkey)
+        j++;
+      size_t run = j - i;
+      if (1 < run)
+        {
+          for (size_t lo = i, hi = j - 1; lo < hi; lo++, hi--)
+            {
+              struct line t = base[lo];
+              base[lo] = base[hi];
+              base[hi] = t;
+            }
+          sequential_sort (base + j, run, scratch + run, true);
+          for (size_t k = 0; k < run; k++)
+            base[i + k] = scratch[run - 1 - k];
+        }
+      i = j;
+    }
+
+  free (scratch);
+
+  for (size_t i = 0; i < nlines; i++)
+    write_unique (&base[i], tfp, temp_output);
+  return true;
+}
+
 /* Merge the lines currently available to a NODE in the binary
    merge tree.  Merge a number of lines appropriate for this merge
    level, assuming TOTAL_LINES is the total number of lines.
@@ -3576,6 +5074,55 @@ static void sortlines (struct line *restrict, size_t, size_t,
                        struct merge_node *, struct merge_node_queue *,
                        FILE *, char const *);
 
+#ifdef CPU_SETSIZE
+
+/* Processors available to this process, gathered once at startup;
+   with --cpu-affinity, the main thread and each merge worker are
+   pinned to one of them round-robin.  */
+static int *avail_cpus;
+static size_t n_avail_cpus;
+static size_t next_cpu;
+static pthread_mutex_t cpu_lock = PTHREAD_MUTEX_INITIALIZER;
+
+static void
+init_cpu_affinity (void)
+{
+  cpu_set_t set;
+  if (sched_getaffinity (0, sizeof set, &set) != 0)
+    return;
+  avail_cpus = xnmalloc (CPU_SETSIZE, sizeof *avail_cpus);
+  for (int i = 0; i < CPU_SETSIZE; i++)
+    if (CPU_ISSET (i, &set))
+      avail_cpus[n_avail_cpus++] = i;
+  if (! n_avail_cpus)
+    {
+      free (avail_cpus);
+      avail_cpus = NULL;
+    }
+}
+
+/* Pin the calling thread to the next available processor.  Failure
+   is ignored: pinning only makes placement deterministic, it is not
+   needed for correctness.  */
+
+static void
+pin_to_next_cpu (void)
+{
+  if (! avail_cpus)
+    return;
+
+  pthread_mutex_lock (&cpu_lock);
+  int cpu = avail_cpus[next_cpu++ % n_avail_cpus];
+  pthread_mutex_unlock (&cpu_lock);
+
+  cpu_set_t set;
+  CPU_ZERO (&set);
+  CPU_SET (cpu, &set);
+  ignore_value (pthread_setaffinity_np (pthread_self (), sizeof set, &set));
+}
+
+#endif
+
 /* Thread arguments for sortlines_thread. */
 
 struct thread_args
@@ -3610,6 +5157,10 @@ static void *
 sortlines_thread (void *data)
 {
   struct thread_args const *args = data;
+#ifdef CPU_SETSIZE
+  if (cpu_affinity)
+    pin_to_next_cpu ();
+#endif
   sortlines (args->lines, args->nthreads, args->total_lines,
              args->node, args->queue, args->tfp,
              args->output_temp);
@@ -3647,6 +5198,8 @@ sortlines (struct line *restrict lines, size_t nthreads,
 {
   size_t nlines = node->nlo + node->nhi;
 
+  COREUTILS_PROBE2 (sort_sortlines, nlines, nthreads);
+
   /* Calculate thread arguments. */
   size_t lo_threads = nthreads / 2;
   size_t hi_threads = nthreads - lo_threads;
@@ -3785,11 +5338,12 @@ check_output (char const *outfile)
 /* Merge the input FILES.  NTEMPS is the number of files at the
    start of FILES that are temporary; it is zero at the top level.
    NFILES is the total number of files.  Put the output in
-   OUTPUT_FILE; a null OUTPUT_FILE stands for standard output.  */
+   OUTPUT_FILE; a null OUTPUT_FILE stands for standard output.
+   Use up to NTHREADS threads for the intermediate merge passes.  */
 
 static void
 merge (struct sortfile *files, size_t ntemps, size_t nfiles,
-       char const *output_file)
+       char const *output_file, size_t nthreads)
 {
   while (nmerge < nfiles)
     {
@@ -3808,18 +5362,27 @@ merge (struct sortfile *files, size_t ntemps, size_t nfiles,
 
       /* Do as many NMERGE-size merges as possible. In the case that
          nmerge is bogus, increment by the maximum number of file
-         descriptors allowed.  */
-      for (out = in = 0; nmerge <= nfiles - in; out++)
+         descriptors allowed.  The full-sized groups of a pass read
+         and write disjoint sets of files, so when multiple threads
+         were requested, merge the groups concurrently.  */
+      size_t full_groups = nfiles / nmerge;
+      if (1 < nthreads && 1 < full_groups)
         {
-          FILE *tfp;
-          struct tempnode *temp = create_temp (&tfp);
-          size_t num_merged = mergefiles (&files[in], MIN (ntemps, nmerge),
-                                          nmerge, tfp, temp->name);
-          ntemps -= MIN (ntemps, num_merged);
-          files[out].name = temp->name;
-          files[out].temp = temp;
-          in += num_merged;
+          in = merge_pass_parallel (files, &ntemps, full_groups, nthreads);
+          out = full_groups;
         }
+      else
+        for (out = in = 0; nmerge <= nfiles - in; out++)
+          {
+            FILE *tfp;
+            struct tempnode *temp = create_temp (&tfp);
+            size_t num_merged = mergefiles (&files[in], MIN (ntemps, nmerge),
+                                            nmerge, tfp, temp->name);
+            ntemps -= MIN (ntemps, num_merged);
+            files[out].name = temp->name;
+            files[out].temp = temp;
+            in += num_merged;
+          }
 
       remainder = nfiles - in;
       cheap_slots = nmerge - out % nmerge;
@@ -3901,6 +5464,296 @@ merge (struct sortfile *files, size_t ntemps, size_t nfiles,
     }
 }
 
+/* Compare entries I and J of HEAP, breaking ties by the input
+   sequence numbers SEQ so that the selection is stable.  */
+
+static int
+top_compare (struct line const *heap, size_t const *seq, size_t i, size_t j)
+{
+  int cmp = compare (&heap[i], &heap[j]);
+  if (cmp)
+    return cmp;
+  return seq[i] < seq[j] ? -1 : seq[j] < seq[i];
+}
+
+/* Swap entries I and J of HEAP and SEQ.  */
+
+static void
+top_swap (struct line *heap, size_t *seq, size_t i, size_t j)
+{
+  struct line tmp = heap[i];
+  heap[i] = heap[j];
+  heap[j] = tmp;
+  size_t stmp = seq[i];
+  seq[i] = seq[j];
+  seq[j] = stmp;
+}
+
+/* Restore the heap property of the first NHEAP entries of HEAP,
+   whose root may be out of place.  The heap keeps the line that would
+   be output last at its root.  */
+
+static void
+top_sift_down (struct line *heap, size_t *seq, size_t nheap, size_t i)
+{
+  while (true)
+    {
+      size_t left = 2 * i + 1;
+      size_t right = left + 1;
+      size_t biggest = i;
+      if (left < nheap && 0 < top_compare (heap, seq, left, biggest))
+        biggest = left;
+      if (right < nheap && 0 < top_compare (heap, seq, right, biggest))
+        biggest = right;
+      if (biggest == i)
+        break;
+      top_swap (heap, seq, i, biggest);
+      i = biggest;
+    }
+}
+
+/* Restore the heap property of HEAP after placing a new entry at
+   index I.  */
+
+static void
+top_sift_up (struct line *heap, size_t *seq, size_t i)
+{
+  while (i && 0 < top_compare (heap, seq, i, (i - 1) / 2))
+    {
+      top_swap (heap, seq, i, (i - 1) / 2);
+      i = (i - 1) / 2;
+    }
+}
+
+/* Store a copy of LINE, whose text lives in a transient input buffer,
+   in *DST, whose previous text (if any) is freed.  */
+
+static void
+top_copy_line (struct line *dst, struct line const *line)
+{
+  free (dst->text);
+  dst->text = xmemdup (line->text, line->length);
+  dst->length = line->length;
+  if (keylist)
+    {
+      dst->keybeg = dst->text + (line->keybeg - line->text);
+      dst->keylim = dst->text + (line->keylim - line->text);
+    }
+  dst->numkey = line->numkey;
+}
+
+/* Write the first TOP_LINES lines of the sorted NFILES FILES onto
+   OUTPUT_FILE, streaming the input through a bounded heap of that
+   many lines instead of sorting everything; nothing is spilled to
+   temporary files.  Once the heap is full, each further input line
+   costs one comparison against the worst retained line.  */
+
+static void
+sort_top (char *const *files, size_t nfiles, char const *output_file)
+{
+  struct line *heap = NULL;
+  size_t *seq = NULL;
+  size_t nheap = 0;
+  size_t heap_alloc = 0;
+  size_t nseen = 0;
+  struct buffer buf;
+
+  initbuf (&buf, sizeof (struct line),
+           MAX (merge_buffer_size, sort_size));
+
+  for (; nfiles; files++, nfiles--)
+    {
+      char const *file = *files;
+      FILE *fp = xfopen (file, "r");
+      if (decompress_input)
+        fp = dec_input_stream (fp, file, SORT_FAILURE);
+      buf.eof = false;
+
+      while (fillbuf (&buf, fp, file))
+        {
+          struct line const *linebase = buffer_linelim (&buf) - buf.nlines;
+
+          /* The line table runs backward through the buffer.  */
+          for (struct line const *line = buffer_linelim (&buf) - 1;
+               linebase <= line; line--)
+            {
+              bool full = top_lines <= nheap;
+              nseen++;
+
+              /* A line no better than the worst retained one cannot
+                 make the output: on a tie the retained line wins, as
+                 it came first.  */
+              if (full && 0 <= compare (line, &heap[0]))
+                continue;
+
+              if (unique)
+                {
+                  /* Keep only distinct lines, as a full sort -u
+                     would.  */
+                  size_t i;
+                  for (i = 0; i < nheap; i++)
+                    if (! compare (line, &heap[i]))
+                      break;
+                  if (i < nheap)
+                    continue;
+                }
+
+              if (full)
+                {
+                  top_copy_line (&heap[0], line);
+                  seq[0] = nseen;
+                  top_sift_down (heap, seq, nheap, 0);
+                }
+              else
+                {
+                  if (nheap == heap_alloc)
+                    {
+                      heap = x2nrealloc (heap, &heap_alloc, sizeof *heap);
+                      seq = xnrealloc (seq, heap_alloc, sizeof *seq);
+                    }
+                  heap[nheap].text = NULL;
+                  top_copy_line (&heap[nheap], line);
+                  seq[nheap] = nseen;
+                  top_sift_up (heap, seq, nheap++);
+                }
+            }
+        }
+
+      xfclose (fp, file);
+      unmapbuf (&buf);
+    }
+
+  freebuf (&buf);
+
+  /* Heapsort the retained lines into output order.  */
+  for (size_t i = nheap; 1 < i; )
+    {
+      i--;
+      top_swap (heap, seq, 0, i);
+      top_sift_down (heap, seq, i, 0);
+    }
+
+  saved_line.text = NULL;
+  FILE *tfp = xfopen (output_file, "w");
+  for (size_t i = 0; i < nheap; i++)
+    write_unique (&heap[i], tfp, output_file);
+  xfclose (tfp, output_file);
+
+  for (size_t i = 0; i < nheap; i++)
+    free (heap[i].text);
+  free (heap);
+  free (seq);
+}
+
+/* A distinct input line retained by --hash-unique.  */
+
+struct uniq_line
+{
+  char *text;
+  size_t length;
+};
+
+static size_t
+uniq_line_hash (void const *x, size_t table_size)
+{
+  struct uniq_line const *u = x;
+  size_t h = 0;
+
+  /* FNV-1a over the line bytes.  */
+  for (size_t i = 0; i < u->length; i++)
+    h = (h ^ to_uchar (u->text[i])) * 16777619;
+
+  return h % table_size;
+}
+
+static bool
+uniq_line_compare (void const *x, void const *y)
+{
+  struct uniq_line const *a = x;
+  struct uniq_line const *b = y;
+  return a->length == b->length && memcmp (a->text, b->text, a->length) == 0;
+}
+
+/* Write the distinct lines of the NFILES FILES onto OUTPUT_FILE in
+   order of first occurrence, comparing lines byte for byte with a
+   hash table instead of sorting.  A single pass suffices, and memory
+   use is proportional to the distinct lines rather than the input.  */
+
+static void
+sort_hash_unique (char *const *files, size_t nfiles, char const *output_file)
+{
+  struct uniq_line **order = NULL;
+  size_t norder = 0;
+  size_t order_alloc = 0;
+  struct buffer buf;
+
+  Hash_table *table = hash_initialize (61, NULL, uniq_line_hash,
+                                       uniq_line_compare, NULL);
+  if (! table)
+    xalloc_die ();
+
+  initbuf (&buf, sizeof (struct line),
+           MAX (merge_buffer_size, sort_size));
+
+  for (; nfiles; files++, nfiles--)
+    {
+      char const *file = *files;
+      FILE *fp = xfopen (file, "r");
+      if (decompress_input)
+        fp = dec_input_stream (fp, file, SORT_FAILURE);
+      buf.eof = false;
+
+      while (fillbuf (&buf, fp, file))
+        {
+          struct line const *linebase = buffer_linelim (&buf) - buf.nlines;
+
+          /* The line table runs backward through the buffer.  */
+          for (struct line const *line = buffer_linelim (&buf) - 1;
+               linebase <= line; line--)
+            {
+              struct uniq_line probe;
+              probe.text = line->text;
+              probe.length = line->length;
+              if (hash_lookup (table, &probe))
+                continue;
+
+              struct uniq_line *u = xmalloc (sizeof *u);
+              u->text = xmemdup (line->text, line->length);
+              u->length = line->length;
+              if (! hash_insert (table, u))
+                xalloc_die ();
+              if (norder == order_alloc)
+                order = x2nrealloc (order, &order_alloc, sizeof *order);
+              order[norder++] = u;
+            }
+        }
+
+      xfclose (fp, file);
+      unmapbuf (&buf);
+    }
+
+  freebuf (&buf);
+  hash_free (table);
+
+  FILE *tfp = xfopen (output_file, "w");
+  for (size_t i = 0; i < norder; i++)
+    {
+      struct line out;
+      memset (&out, 0, sizeof out);
+      out.text = order[i]->text;
+      out.length = order[i]->length;
+      write_line (&out, tfp, output_file);
+    }
+  xfclose (tfp, output_file);
+
+  for (size_t i = 0; i < norder; i++)
+    {
+      free (order[i]->text);
+      free (order[i]);
+    }
+  free (order);
+}
+
 /* Sort NFILES FILES onto OUTPUT_FILE.  Use at most NTHREADS threads.  */
 
 static void
@@ -3919,6 +5772,8 @@ sort (char *const *files, size_t nfiles, char const *output_file,
       char const *temp_output;
       char const *file = *files;
       FILE *fp = xfopen (file, "r");
+      if (decompress_input)
+        fp = dec_input_stream (fp, file, SORT_FAILURE);
       FILE *tfp;
 
       size_t bytes_per_line;
@@ -3948,7 +5803,7 @@ sort (char *const *files, size_t nfiles, char const *output_file,
         {
           struct line *line;
 
-          if (buf.eof && nfiles
+          if (buf.eof && nfiles && !buf.map
               && (bytes_per_line + 1
                   < (buf.alloc - buf.used - bytes_per_line * buf.nlines)))
             {
@@ -3973,7 +5828,9 @@ sort (char *const *files, size_t nfiles, char const *output_file,
               ++ntemps;
               temp_output = create_temp (&tfp)->name;
             }
-          if (1 < buf.nlines)
+          if (buf.nlines <= 1)
+            write_unique (line - 1, tfp, temp_output);
+          else if (! sortlines_radix (line, buf.nlines, tfp, temp_output))
             {
               struct merge_node_queue queue;
               queue_init (&queue, nthreads);
@@ -3988,8 +5845,6 @@ sort (char *const *files, size_t nfiles, char const *output_file,
               queue_destroy (&queue);
 #endif
             }
-          else
-            write_unique (line - 1, tfp, temp_output);
 
           xfclose (tfp, temp_output);
 
@@ -3997,10 +5852,11 @@ sort (char *const *files, size_t nfiles, char const *output_file,
             goto finish;
         }
       xfclose (fp, file);
+      unmapbuf (&buf);
     }
 
  finish:
-  free (buf.buf);
+  freebuf (&buf);
 
   if (! output_file_created)
     {
@@ -4012,7 +5868,7 @@ sort (char *const *files, size_t nfiles, char const *output_file,
           tempfiles[i].temp = node;
           node = node->next;
         }
-      merge (tempfiles, ntemps, ntemps, output_file);
+      merge (tempfiles, ntemps, ntemps, output_file, nthreads);
       free (tempfiles);
     }
 
@@ -4223,6 +6079,10 @@ main (int argc, char **argv)
 
   initialize_exit_failure (SORT_FAILURE);
 
+  /* Output goes to stdout even with -o (stream_open dups over it),
+     so the requested buffering policy applies in every case.  */
+  stdbuf_policy_apply_stdout ();
+
   hard_LC_COLLATE = hard_locale (LC_COLLATE);
 #if HAVE_NL_LANGINFO
   hard_LC_TIME = hard_locale (LC_TIME);
@@ -4424,20 +6284,64 @@ main (int argc, char **argv)
           checkonly = c;
           break;
 
+        case CHECK_STATE_OPTION:
+          check_state_file = optarg;
+          break;
+
         case COMPRESS_PROGRAM_OPTION:
           if (compress_program && !STREQ (compress_program, optarg))
             die (SORT_FAILURE, 0, _("multiple compress programs specified"));
+          if (compress_temps)
+            die (SORT_FAILURE, 0, _("--compress-program and --compress-temps"
+                                    " are incompatible"));
           compress_program = optarg;
           break;
 
+        case COMPRESS_TEMPS_OPTION:
+#if HAVE_FOPENCOOKIE
+          if (compress_program)
+            die (SORT_FAILURE, 0, _("--compress-program and --compress-temps"
+                                    " are incompatible"));
+          compress_temps = true;
+#else
+          die (SORT_FAILURE, 0,
+               _("--compress-temps is not supported on this system"));
+#endif
+          break;
+
+        case CPU_AFFINITY_OPTION:
+#ifdef CPU_SETSIZE
+          cpu_affinity = true;
+#else
+          die (SORT_FAILURE, 0,
+               _("--cpu-affinity is not supported on this system"));
+#endif
+          break;
+
         case DEBUG_PROGRAM_OPTION:
           debug = true;
           break;
 
+        case DECOMPRESS_OPTION:
+          decompress_input = true;
+          break;
+
+        case STATS_OPTION:
+          stats = true;
+          break;
+
         case FILES0_FROM_OPTION:
           files_from = optarg;
           break;
 
+        case HASH_UNIQUE_OPTION:
+          hash_unique = true;
+          break;
+
+        case LENGTH_PREFIXED_OPTION:
+          length_prefixed = true;
+          break;
+
         case 'k':
           key = key_init (&key_buf);
 
@@ -4550,6 +6454,20 @@ main (int argc, char **argv)
           nthreads = specify_nthreads (oi, c, optarg);
           break;
 
+        case TOP_OPTION:
+          {
+            uintmax_t n;
+            enum strtol_error e = xstrtoumax (optarg, NULL, 10, &n, "");
+            if (e == LONGINT_OVERFLOW || (e == LONGINT_OK && SIZE_MAX < n))
+              n = SIZE_MAX;
+            else if (e != LONGINT_OK)
+              xstrtol_fatal (e, oi, c, long_options, optarg);
+            if (n == 0)
+              die (SORT_FAILURE, 0, _("number of top lines must be nonzero"));
+            top_lines = n;
+          }
+          break;
+
         case 'u':
           unique = true;
           break;
@@ -4696,6 +6614,35 @@ main (int argc, char **argv)
 
   reverse = gkey.reverse;
 
+  /* With a single plain key, encode each line's key once at input
+     time into a binary prefix key compared with a single integer
+     compare.  -n and -g keys are decoded numerically; plain text
+     keys, and whole-line comparisons with no keys at all, cache the
+     head of their collating transform when collation is expensive.  */
+  if (keylist && !keylist->next
+      && !keylist->ignore && !keylist->translate
+      && !keylist->month && !keylist->random
+      && !keylist->human_numeric && !keylist->version)
+    {
+      if (keylist->general_numeric
+          || (keylist->numeric && thousands_sep < 0))
+        {
+          use_numkeys = true;
+          numkeys_general = keylist->general_numeric;
+        }
+      else if (!keylist->numeric && hard_LC_COLLATE)
+        {
+          use_numkeys = true;
+          numkeys_collate = true;
+        }
+      numkeys_reverse = keylist->reverse;
+    }
+  else if (!keylist && hard_LC_COLLATE)
+    {
+      use_numkeys = true;
+      numkeys_collate = true;
+    }
+
   if (need_random)
     random_md5_state_init (random_source);
 
@@ -4718,12 +6665,62 @@ main (int argc, char **argv)
   if (0 < sort_size)
     sort_size = MAX (sort_size, MIN_SORT_SIZE);
 
+  if (stats)
+    {
+      /* Let SIGUSR1 request an interim report; restart interrupted
+         reads so the signal does not perturb the run.  */
+#if SA_NOCLDSTOP
+      struct sigaction act;
+      sigemptyset (&act.sa_mask);
+      act.sa_handler = stats_sighandler;
+      act.sa_flags = SA_RESTART;
+      sigaction (SIGUSR1, &act, NULL);
+#else
+      signal (SIGUSR1, stats_sighandler);
+#endif
+    }
+
+  if (check_state_file && ! checkonly)
+    die (SORT_FAILURE, 0, _("--check-state requires -c or -C"));
+
+  if (top_lines)
+    {
+      if (checkonly)
+        die (SORT_FAILURE, 0, _("options '-%c' and '--top' are incompatible"),
+             checkonly);
+      if (mergeonly)
+        die (SORT_FAILURE, 0, _("options '-m' and '--top' are incompatible"));
+    }
+
+  if (hash_unique)
+    {
+      if (keylist || reverse)
+        die (SORT_FAILURE, 0,
+             _("--hash-unique is incompatible with ordering options"));
+      if (checkonly)
+        die (SORT_FAILURE, 0,
+             _("options '-%c' and '--hash-unique' are incompatible"),
+             checkonly);
+      if (mergeonly)
+        die (SORT_FAILURE, 0,
+             _("options '-m' and '--hash-unique' are incompatible"));
+      if (top_lines)
+        die (SORT_FAILURE, 0,
+             _("options '--top' and '--hash-unique' are incompatible"));
+    }
+
   if (checkonly)
     {
       if (nfiles > 1)
         die (SORT_FAILURE, 0, _("extra operand %s not allowed with -%c"),
              quoteaf (files[1]), checkonly);
 
+      /* Random hashing is salted per run, so recorded progress could
+         not be trusted by a later invocation.  */
+      if (check_state_file && need_random)
+        die (SORT_FAILURE, 0,
+             _("--check-state is incompatible with random sorting"));
+
       if (outfile)
         {
           static char opts[] = {0, 'o', 0};
@@ -4733,7 +6730,10 @@ main (int argc, char **argv)
 
       /* POSIX requires that sort return 1 IFF invoked with -c or -C and the
          input is not properly sorted.  */
-      return check (files[0], checkonly) ? EXIT_SUCCESS : SORT_OUT_OF_ORDER;
+      bool ordered = check (files[0], checkonly);
+      if (stats)
+        stats_report ();
+      return ordered ? EXIT_SUCCESS : SORT_OUT_OF_ORDER;
     }
 
   /* Check all inputs are accessible, or exit immediately.  */
@@ -4742,6 +6742,25 @@ main (int argc, char **argv)
   /* Check output is writable, or exit immediately.  */
   check_output (outfile);
 
+  if (!nthreads)
+    {
+      unsigned long int np = num_processors (NPROC_CURRENT_OVERRIDABLE);
+      nthreads = MIN (np, DEFAULT_MAX_THREADS);
+    }
+
+  /* Avoid integer overflow later.  */
+  size_t nthreads_max = SIZE_MAX / (2 * sizeof (struct merge_node));
+  nthreads = MIN (nthreads, nthreads_max);
+
+#ifdef CPU_SETSIZE
+  if (cpu_affinity)
+    {
+      init_cpu_affinity ();
+      /* The main thread participates in the merge too.  */
+      pin_to_next_cpu ();
+    }
+#endif
+
   if (mergeonly)
     {
       struct sortfile *sortfiles = xcalloc (nfiles, sizeof *sortfiles);
@@ -4749,23 +6768,15 @@ main (int argc, char **argv)
       for (size_t i = 0; i < nfiles; ++i)
         sortfiles[i].name = files[i];
 
-      merge (sortfiles, 0, nfiles, outfile);
+      merge (sortfiles, 0, nfiles, outfile, nthreads);
       IF_LINT (free (sortfiles));
     }
+  else if (hash_unique)
+    sort_hash_unique (files, nfiles, outfile);
+  else if (top_lines)
+    sort_top (files, nfiles, outfile);
   else
-    {
-      if (!nthreads)
-        {
-          unsigned long int np = num_processors (NPROC_CURRENT_OVERRIDABLE);
-          nthreads = MIN (np, DEFAULT_MAX_THREADS);
-        }
-
-      /* Avoid integer overflow later.  */
-      size_t nthreads_max = SIZE_MAX / (2 * sizeof (struct merge_node));
-      nthreads = MIN (nthreads, nthreads_max);
-
-      sort (files, nfiles, outfile, nthreads);
-    }
+    sort (files, nfiles, outfile, nthreads);
 
 #ifdef lint
   if (files_from)
@@ -4777,5 +6788,8 @@ main (int argc, char **argv)
   if (have_read_stdin && fclose (stdin) == EOF)
     sort_die (_("close failed"), "-");
 
+  if (stats)
+    stats_report ();
+
   return EXIT_SUCCESS;
 }
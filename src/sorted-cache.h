@@ -0,0 +1,173 @@
+/* Remember input files already verified to be sorted.
+   Copyright (C) 2021 Free Software Foundation, Inc.
+
+   This program is free software: you can redistribute it and/or modify
+   it under the terms of the GNU General Public License as published by
+   the Free Software Foundation, either version 3 of the License, or
+   (at your option) any later version.
+
+   This program is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU General Public License for more details.
+
+   You should have received a copy of the GNU General Public License
+   along with this program.  If not, see <https://www.gnu.org/licenses/>.  */
+
+/* comm and join can verify that each input is sorted, at the cost of
+   one extra comparison per input line.  Pipelines that combine the
+   same artifacts repeatedly pay that cost on every run.  These
+   helpers maintain a small index of files whose order has been fully
+   verified, keyed by file identity (device and inode) and guarded by
+   size, last modification time, and a digest of the settings that
+   affect the comparison; a hit lets a later run skip the per-line
+   order checks for that file.
+
+   The index format follows the du --cache format: a magic string, the
+   record size, then raw records, so an index written by a different
+   build is simply ignored and rebuilt.  */
+
+#include <stdint.h>
+
+#include "stat-time.h"
+#include "xalloc.h"
+
+/* Identifies the index format and the running architecture.  */
+static char const sorted_cache_magic[] = "GNU sorted cache 1\n";
+
+/* One verified file.  */
+struct sorted_cache_ent
+{
+  dev_t dev;
+  ino_t ino;
+  off_t size;
+  struct timespec mtime;
+  uint32_t opts;                /* Digest of order-relevant settings.  */
+};
+
+/* Mix the NUL-terminated string S into the settings digest H
+   and return the result.  */
+
+static uint32_t
+sorted_cache_digest (uint32_t h, char const *s)
+{
+  for (; *s; s++)
+    h = h * 33 ^ to_uchar (*s);
+  return h;
+}
+
+/* Read the entries of the index stream F into a buffer to be freed by
+   the caller, storing their number in *N.  Return NULL (with *N == 0)
+   if F does not hold a usable index.  */
+
+static struct sorted_cache_ent *
+sorted_cache_read (FILE *f, size_t *n)
+{
+  struct sorted_cache_ent *ents = NULL;
+  size_t n_ents = 0;
+  size_t n_alloc = 0;
+  char magic[sizeof sorted_cache_magic - 1];
+  uintmax_t recsize;
+
+  if (fread (magic, 1, sizeof magic, f) == sizeof magic
+      && memcmp (magic, sorted_cache_magic, sizeof magic) == 0
+      && fread (&recsize, sizeof recsize, 1, f) == 1
+      && recsize == sizeof *ents)
+    {
+      while (true)
+        {
+          if (n_ents == n_alloc)
+            ents = x2nrealloc (ents, &n_alloc, sizeof *ents);
+          if (fread (&ents[n_ents], sizeof *ents, 1, f) != 1)
+            break;
+          n_ents++;
+        }
+    }
+
+  *n = n_ents;
+  return ents;
+}
+
+/* Return true if the index file CACHE records the file *ST, with its
+   current size and modification time, as verified sorted under the
+   settings digest OPTS.  A missing or unusable index is simply a
+   miss.  */
+
+static bool
+sorted_cache_lookup (char const *cache, struct stat const *st, uint32_t opts)
+{
+  FILE *f = fopen (cache, "rb");
+  if (! f)
+    return false;
+
+  size_t n_ents;
+  struct sorted_cache_ent *ents = sorted_cache_read (f, &n_ents);
+  bool hit = false;
+
+  for (size_t i = 0; i < n_ents; i++)
+    if (ents[i].dev == st->st_dev && ents[i].ino == st->st_ino
+        && ents[i].opts == opts)
+      {
+        struct timespec mtime = get_stat_mtime (st);
+        hit = (ents[i].size == st->st_size
+               && ents[i].mtime.tv_sec == mtime.tv_sec
+               && ents[i].mtime.tv_nsec == mtime.tv_nsec);
+        break;
+      }
+
+  free (ents);
+  fclose (f);
+  return hit;
+}
+
+/* Record in the index file CACHE that the file *ST, as currently
+   sized and timestamped, has been verified sorted under the settings
+   digest OPTS, replacing any previous record for the same file and
+   settings.  Return true on success.  */
+
+static bool
+sorted_cache_note (char const *cache, struct stat const *st, uint32_t opts)
+{
+  struct sorted_cache_ent *ents = NULL;
+  size_t n_ents = 0;
+
+  FILE *f = fopen (cache, "rb");
+  if (f)
+    {
+      ents = sorted_cache_read (f, &n_ents);
+      fclose (f);
+    }
+
+  size_t i;
+  for (i = 0; i < n_ents; i++)
+    if (ents[i].dev == st->st_dev && ents[i].ino == st->st_ino
+        && ents[i].opts == opts)
+      break;
+  if (i == n_ents)
+    {
+      ents = xnrealloc (ents, n_ents + 1, sizeof *ents);
+      n_ents++;
+    }
+
+  /* Zero the entry first so that padding bytes have a fixed value.  */
+  memset (&ents[i], 0, sizeof ents[i]);
+  ents[i].dev = st->st_dev;
+  ents[i].ino = st->st_ino;
+  ents[i].size = st->st_size;
+  ents[i].mtime = get_stat_mtime (st);
+  ents[i].opts = opts;
+
+  bool ok = false;
+  f = fopen (cache, "wb");
+  if (f)
+    {
+      uintmax_t recsize = sizeof *ents;
+      fwrite (sorted_cache_magic, 1, sizeof sorted_cache_magic - 1, f);
+      fwrite (&recsize, sizeof recsize, 1, f);
+      fwrite (ents, sizeof *ents, n_ents, f);
+      ok = ! ferror (f) && fclose (f) == 0;
+    }
+
+  free (ents);
+  return ok;
+}
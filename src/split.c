@@ -35,6 +35,7 @@
 #include "fcntl--.h"
 #include "full-write.h"
 #include "ioblksize.h"
+#include "linescan.h"
 #include "quote.h"
 #include "safe-read.h"
 #include "sig2str.h"
@@ -55,6 +56,26 @@ static char const *filter_command;
 /* Process ID of the filter.  */
 static int filter_pid;
 
+/* Process ID of the chunk feeder writing into the current filter's
+   pipe, or 0 when the parent feeds the filter itself.  */
+static pid_t feeder_pid;
+
+/* Maximum number of filter processes to run concurrently.  With the
+   default of 1, each filter is waited for before the next starts.  */
+static size_t filter_jobs = 1;
+
+/* Filter processes whose input pipes have been closed but that have
+   not yet been reaped, oldest first.  */
+struct pending_filter
+{
+  pid_t pid;
+  pid_t feeder;		/* Feeder process, or 0.  */
+  char *name;
+};
+static struct pending_filter *pending_filters;
+static size_t pending_filters_alloc;
+static size_t n_pending_filters;
+
 /* Array of open pipes.  */
 static int *open_pipes;
 static size_t open_pipes_alloc;
@@ -143,6 +164,7 @@ static struct option const longopts[] =
   {"numeric-suffixes", optional_argument, NULL, 'd'},
   {"hex-suffixes", optional_argument, NULL, 'x'},
   {"filter", required_argument, NULL, FILTER_OPTION},
+  {"jobs", required_argument, NULL, 'j'},
   {"verbose", no_argument, NULL, VERBOSE_OPTION},
   {"separator", required_argument, NULL, 't'},
   {"-io-blksize", required_argument, NULL,
@@ -247,6 +269,8 @@ default size is 1000 lines, and default PREFIX is 'x'.\n\
       --hex-suffixes[=FROM]  same as -x, but allow setting the start value\n\
   -e, --elide-empty-files  do not generate empty output files with '-n'\n\
       --filter=COMMAND    write to shell COMMAND; file name is $FILE\n\
+  -j, --jobs=N            with --filter, let up to N filter processes\n\
+                            run concurrently\n\
   -l, --lines=NUMBER      put NUMBER lines/records per output file\n\
   -n, --number=CHUNKS     generate CHUNKS output files; see explanation below\n\
   -t, --separator=SEP     use SEP instead of newline as the record separator;\n\
@@ -532,6 +556,77 @@ create (char const *name)
     }
 }
 
+/* Wait for the filter process PID, which was writing NAME, and
+   diagnose its exit status.  */
+static void
+wait_filter (pid_t pid, char const *name)
+{
+  int wstatus = 0;
+  if (waitpid (pid, &wstatus, 0) == -1 && errno != ECHILD)
+    die (EXIT_FAILURE, errno, _("waiting for child process"));
+  if (WIFSIGNALED (wstatus))
+    {
+      int sig = WTERMSIG (wstatus);
+      if (sig != SIGPIPE)
+        {
+          char signame[MAX (SIG2STR_MAX, INT_BUFSIZE_BOUND (int))];
+          if (sig2str (sig, signame) != 0)
+            sprintf (signame, "%d", sig);
+          error (sig + 128, 0,
+                 _("with FILE=%s, signal %s from command: %s"),
+                 quotef (name), signame, filter_command);
+        }
+    }
+  else if (WIFEXITED (wstatus))
+    {
+      int ex = WEXITSTATUS (wstatus);
+      if (ex != 0)
+        error (ex, 0, _("with FILE=%s, exit %d from command: %s"),
+               quotef (name), ex, filter_command);
+    }
+  else
+    {
+      /* shouldn't happen.  */
+      die (EXIT_FAILURE, 0,
+           _("unknown status from command (0x%X)"), wstatus + 0u);
+    }
+}
+
+/* Wait for the feeder process PID, which was reading a chunk of the
+   input.  It issues its own diagnostics, so just propagate a failing
+   exit status.  */
+static void
+wait_feeder (pid_t pid)
+{
+  int wstatus = 0;
+  if (waitpid (pid, &wstatus, 0) == -1 && errno != ECHILD)
+    die (EXIT_FAILURE, errno, _("waiting for child process"));
+  if (WIFEXITED (wstatus) && WEXITSTATUS (wstatus) != 0)
+    exit (WEXITSTATUS (wstatus));
+  if (WIFSIGNALED (wstatus) && WTERMSIG (wstatus) != SIGPIPE)
+    die (EXIT_FAILURE, 0, _("input feeding process killed"));
+}
+
+/* Reap the oldest unreaped filter process.  */
+static void
+reap_oldest_filter (void)
+{
+  if (pending_filters[0].feeder)
+    wait_feeder (pending_filters[0].feeder);
+  wait_filter (pending_filters[0].pid, pending_filters[0].name);
+  free (pending_filters[0].name);
+  memmove (pending_filters, pending_filters + 1,
+           --n_pending_filters * sizeof *pending_filters);
+}
+
+/* Reap all unreaped filter processes.  */
+static void
+wait_all_filters (void)
+{
+  while (n_pending_filters)
+    reap_oldest_filter ();
+}
+
 /* Close the output file, and do any associated cleanup.
    If FP and FD are both specified, they refer to the same open file;
    in this case FP is closed, but FD is still used in cleanup.  */
@@ -556,35 +651,28 @@ closeout (FILE *fp, int fd, pid_t pid, char const *name)
     }
   if (pid > 0)
     {
-      int wstatus = 0;
-      if (waitpid (pid, &wstatus, 0) == -1 && errno != ECHILD)
-        die (EXIT_FAILURE, errno, _("waiting for child process"));
-      if (WIFSIGNALED (wstatus))
-        {
-          int sig = WTERMSIG (wstatus);
-          if (sig != SIGPIPE)
-            {
-              char signame[MAX (SIG2STR_MAX, INT_BUFSIZE_BOUND (int))];
-              if (sig2str (sig, signame) != 0)
-                sprintf (signame, "%d", sig);
-              error (sig + 128, 0,
-                     _("with FILE=%s, signal %s from command: %s"),
-                     quotef (name), signame, filter_command);
-            }
-        }
-      else if (WIFEXITED (wstatus))
+      if (filter_jobs <= 1)
         {
-          int ex = WEXITSTATUS (wstatus);
-          if (ex != 0)
-            error (ex, 0, _("with FILE=%s, exit %d from command: %s"),
-                   quotef (name), ex, filter_command);
+          if (feeder_pid)
+            wait_feeder (feeder_pid);
+          wait_filter (pid, name);
         }
       else
         {
-          /* shouldn't happen.  */
-          die (EXIT_FAILURE, 0,
-               _("unknown status from command (0x%X)"), wstatus + 0u);
+          /* Let the filter drain in the background while the next
+             piece is written, bounding the number in flight.  */
+          if (n_pending_filters == pending_filters_alloc)
+            pending_filters = x2nrealloc (pending_filters,
+                                          &pending_filters_alloc,
+                                          sizeof *pending_filters);
+          pending_filters[n_pending_filters].pid = pid;
+          pending_filters[n_pending_filters].feeder = feeder_pid;
+          pending_filters[n_pending_filters].name = xstrdup (name);
+          n_pending_filters++;
+          while (filter_jobs <= n_pending_filters)
+            reap_oldest_filter ();
         }
+      feeder_pid = 0;
     }
 }
 
@@ -630,9 +718,81 @@ bytes_split (uintmax_t n_bytes, char *buf, size_t bufsize, size_t initial_read,
   bool filter_ok = true;
   uintmax_t to_write = n_bytes;
   uintmax_t opened = 0;
-  bool eof;
+  bool eof = false;
+
+  /* For a regular file with no filter, try to move whole pieces with
+     copy_file_range: the data then stays within the kernel, and file
+     systems with reflink support can share the extents instead of
+     copying them.  Fall back on buffered copying, mid piece if need
+     be, as soon as the call does not work.  */
+  if (! filter_command && initial_read == SIZE_MAX
+      && S_ISREG (in_stat_buf.st_mode))
+    {
+      bool cfr_ok = true;
+      while (cfr_ok && ! eof)
+        {
+          /* Find out whether any input remains, without reading it;
+             do not create an output file for an exhausted input.  */
+          off_t cur = lseek (STDIN_FILENO, 0, SEEK_CUR);
+          off_t end = lseek (STDIN_FILENO, 0, SEEK_END);
+          if (cur < 0 || end < 0
+              || (cur != end && lseek (STDIN_FILENO, cur, SEEK_SET) < 0))
+            break;
+          if (end <= cur)
+            {
+              eof = true;
+              break;
+            }
 
-  do
+          closeout (NULL, output_desc, filter_pid, outfile);
+          next_file_name ();
+          output_desc = create (outfile);
+          if (output_desc < 0)
+            die (EXIT_FAILURE, errno, "%s", quotef (outfile));
+          opened++;
+          new_file_flag = false;
+          to_write = n_bytes;
+
+          while (to_write)
+            {
+              /* Copy at most COPY_MAX bytes at a time; this is min
+                 (PTRDIFF_MAX, SIZE_MAX) truncated to a value that is
+                 surely aligned well.  */
+              ssize_t ssize_max = TYPE_MAXIMUM (ssize_t);
+              ptrdiff_t copy_max = MIN (ssize_max, SIZE_MAX) >> 30 << 30;
+              ssize_t n_copied = copy_file_range (STDIN_FILENO, NULL,
+                                                  output_desc, NULL,
+                                                  MIN (to_write, copy_max), 0);
+              if (n_copied == 0)
+                {
+                  /* The file was truncated after the seek above, or
+                     this is a file where copy_file_range reads
+                     nothing; let the buffered loop decide whether
+                     this is EOF.  */
+                  cfr_ok = false;
+                  break;
+                }
+              if (n_copied < 0)
+                {
+                  if (errno == ENOSYS || errno == EINVAL
+                      || errno == EBADF || errno == EXDEV)
+                    {
+                      cfr_ok = false;
+                      break;
+                    }
+                  if (errno == EINTR)
+                    continue;
+                  die (EXIT_FAILURE, errno, "%s", quotef (outfile));
+                }
+              to_write -= n_copied;
+            }
+        }
+      /* When copy_file_range stopped mid piece, TO_WRITE and
+         NEW_FILE_FLAG carry over and the loop below resumes where it
+         left off.  */
+    }
+
+  while (! eof)
     {
       if (initial_read != SIZE_MAX)
         {
@@ -686,7 +846,6 @@ bytes_split (uintmax_t n_bytes, char *buf, size_t bufsize, size_t initial_read,
           to_write -= n_read;
         }
     }
-  while (! eof);
 
   /* Ensure NUMBER files are created, which truncates
      any existing files or notifies any consumers on fifos.
@@ -695,6 +854,86 @@ bytes_split (uintmax_t n_bytes, char *buf, size_t bufsize, size_t initial_read,
     cwrite (true, NULL, 0);
 }
 
+/* Split a seekable input of FILE_SIZE bytes into N chunks fed to
+   filter processes, forking for each chunk a feeder that preads the
+   chunk's extent and writes it into that filter's pipe.  The chunk
+   extents are computable up front, so unlike the sequential path,
+   where every byte passes through the parent in order, up to
+   --jobs filters consume their input concurrently.  INITIAL_READ
+   input bytes have already been read; BUFSIZE is the I/O buffer
+   size.  Chunk boundaries and contents are exactly those of
+   bytes_split (FILE_SIZE / N, ..., N).  */
+
+static void
+bytes_chunk_filter_parallel (uintmax_t n, size_t bufsize, size_t initial_read,
+                             off_t file_size)
+{
+  uintmax_t chunk_size = file_size / n;
+
+  /* Absolute offset where the data to split begins, and where it
+     really ends; FILE_SIZE may exceed the latter, as it is raised to
+     N so that empty chunk files are still created.  */
+  off_t cur = lseek (STDIN_FILENO, 0, SEEK_CUR);
+  if (cur < 0)
+    die (EXIT_FAILURE, errno, "%s", quotef (infile));
+  off_t begin = cur - initial_read;
+  off_t real_end = lseek (STDIN_FILENO, 0, SEEK_END);
+  if (real_end < 0)
+    die (EXIT_FAILURE, errno, "%s", quotef (infile));
+  real_end = MAX (begin, real_end);
+
+  for (uintmax_t i = 0; i < n; i++)
+    {
+      off_t start = begin + chunk_size * i;
+      off_t end = i + 1 == n ? real_end : MIN (start + chunk_size, real_end);
+      end = MAX (start, end);
+
+      if (elide_empty_files && real_end <= start)
+        continue;
+
+      closeout (NULL, output_desc, filter_pid, outfile);
+      next_file_name ();
+      output_desc = create (outfile);
+      if (output_desc < 0)
+        die (EXIT_FAILURE, errno, "%s", quotef (outfile));
+
+      /* Messages buffered before the fork must not be flushed twice.  */
+      if (fflush (stdout) != 0)
+        die (EXIT_FAILURE, errno, _("write error"));
+
+      pid_t child_pid = fork ();
+      if (child_pid == 0)
+        {
+          /* Feed [START, END) to the filter and exit.  Close the
+             other filters' pipes, so each sees EOF when its own
+             feeder is done.  */
+          for (int j = 0; j < n_open_pipes; j++)
+            if (open_pipes[j] != output_desc)
+              close (open_pipes[j]);
+
+          char *fbuf = xmalloc (bufsize);
+          for (off_t pos = start; pos < end; )
+            {
+              size_t n_to_read = MIN (end - pos, bufsize);
+              ssize_t n_read = pread (STDIN_FILENO, fbuf, n_to_read, pos);
+              if (n_read < 0)
+                die (EXIT_FAILURE, errno, "%s", quotef (infile));
+              if (n_read == 0)
+                break;		/* The input shrank meanwhile.  */
+              if (full_write (output_desc, fbuf, n_read) != n_read
+                  && ! ignorable (errno))
+                die (EXIT_FAILURE, errno, "%s", quotef (outfile));
+              pos += n_read;
+            }
+          IF_LINT (free (fbuf));
+          _exit (EXIT_SUCCESS);
+        }
+      if (child_pid == -1)
+        die (EXIT_FAILURE, errno, _("fork system call failed"));
+      feeder_pid = child_pid;
+    }
+}
+
 /* Split into pieces of exactly N_LINES lines.
    Use buffer BUF, whose size is BUFSIZE.  */
 
@@ -702,7 +941,7 @@ static void
 lines_split (uintmax_t n_lines, char *buf, size_t bufsize)
 {
   size_t n_read;
-  char *bp, *bp_out, *eob;
+  char const *bp, *bp_out, *eob;
   bool new_file_flag = true;
   uintmax_t n = 0;
 
@@ -713,29 +952,26 @@ lines_split (uintmax_t n_lines, char *buf, size_t bufsize)
         die (EXIT_FAILURE, errno, "%s", quotef (infile));
       bp = bp_out = buf;
       eob = bp + n_read;
-      *eob = eolchar;
-      while (true)
+      while (bp != eob)
         {
-          bp = memchr (bp, eolchar, eob - bp + 1);
-          if (bp == eob)
+          /* Locate the end of the current piece within this buffer.  */
+          uintmax_t rem = n_lines - n;
+          char const *piece_end = skip_delims (bp, eob - bp, eolchar, &rem);
+          if (! piece_end)
             {
-              if (eob != bp_out) /* do not write 0 bytes! */
-                {
-                  size_t len = eob - bp_out;
-                  cwrite (new_file_flag, bp_out, len);
-                  new_file_flag = false;
-                }
+              /* The piece continues beyond this buffer; write out
+                 what we have and note how many lines it held.  */
+              n = n_lines - rem;
+              cwrite (new_file_flag, bp_out, eob - bp_out);
+              new_file_flag = false;
               break;
             }
 
-          ++bp;
-          if (++n >= n_lines)
-            {
-              cwrite (new_file_flag, bp_out, bp - bp_out);
-              bp_out = bp;
-              new_file_flag = true;
-              n = 0;
-            }
+          bp = piece_end;
+          cwrite (new_file_flag, bp_out, bp - bp_out);
+          bp_out = bp;
+          new_file_flag = true;
+          n = 0;
         }
     }
   while (n_read);
@@ -980,6 +1216,102 @@ lines_chunk_split (uintmax_t k, uintmax_t n, char *buf, size_t bufsize,
     cwrite (true, NULL, 0);
 }
 
+/* Return the offset just past the first EOLCHAR at or after offset POS
+   in the regular file open on standard input, whose size is FILE_SIZE,
+   or FILE_SIZE if there is none.  Use the buffer BUF of size BUFSIZE
+   for the scan.  */
+
+static off_t
+next_line_start (char *buf, size_t bufsize, off_t pos, off_t file_size)
+{
+  while (pos < file_size)
+    {
+      if (lseek (STDIN_FILENO, pos, SEEK_SET) < 0)
+        die (EXIT_FAILURE, errno, "%s", quotef (infile));
+      size_t n_read = safe_read (STDIN_FILENO, buf, bufsize);
+      if (n_read == SAFE_READ_ERROR)
+        die (EXIT_FAILURE, errno, "%s", quotef (infile));
+      if (n_read == 0)
+        break; /* The file was truncated since it was stated.  */
+      n_read = MIN (n_read, file_size - pos);
+      char *p = memchr (buf, eolchar, n_read);
+      if (p)
+        return pos + (p - buf) + 1;
+      pos += n_read;
+    }
+  return file_size;
+}
+
+/* -n l/K/N: Extract the lines of the Kth of N chunks from the regular
+   file on standard input.  This is equivalent to lines_chunk_split
+   with K nonzero, but instead of streaming the chunk through the
+   user-space buffer, it locates the bounding line starts and moves
+   the span with copy_file_range, falling back on buffered copying
+   when that is not supported.  */
+
+static void
+lines_chunk_extract (uintmax_t k, uintmax_t n, char *buf, size_t bufsize,
+                     off_t file_size)
+{
+  assert (k && n && k <= n && n <= file_size);
+
+  off_t chunk_size = file_size / n;
+  off_t start = (k - 1) * chunk_size;
+  off_t end = (k == n) ? file_size : k * chunk_size;
+
+  /* A line belongs to the partition its first byte falls in, so the
+     output starts at the first line start at or after START, and runs
+     to the first line start at or after END.  A line long enough to
+     span the whole partition leaves the output empty.  */
+  off_t a = start == 0 ? 0 : next_line_start (buf, bufsize, start - 1,
+                                              file_size);
+  off_t b = (k == n) ? file_size
+    : MAX (a, next_line_start (buf, bufsize, end - 1, file_size));
+
+  off_t off_in = a;
+  while (off_in < b)
+    {
+      /* Copy at most COPY_MAX bytes at a time; this is min
+         (PTRDIFF_MAX, SIZE_MAX) truncated to a value that is
+         surely aligned well.  */
+      ssize_t ssize_max = TYPE_MAXIMUM (ssize_t);
+      ptrdiff_t copy_max = MIN (ssize_max, SIZE_MAX) >> 30 << 30;
+      ssize_t n_copied = copy_file_range (STDIN_FILENO, &off_in,
+                                          STDOUT_FILENO, NULL,
+                                          MIN (b - off_in, copy_max), 0);
+      if (n_copied == 0)
+        return; /* The file was truncated since it was stated.  */
+      if (n_copied < 0)
+        {
+          if (errno == ENOSYS || errno == EINVAL
+              || errno == EBADF || errno == EXDEV)
+            break;
+          if (errno == EINTR)
+            continue;
+          die (EXIT_FAILURE, errno, "%s", _("write error"));
+        }
+    }
+
+  if (off_in < b)
+    {
+      /* Buffered fallback; still seek-and-copy rather than a scan.  */
+      if (lseek (STDIN_FILENO, off_in, SEEK_SET) < 0)
+        die (EXIT_FAILURE, errno, "%s", quotef (infile));
+      while (off_in < b)
+        {
+          size_t n_read = safe_read (STDIN_FILENO, buf,
+                                     MIN (bufsize, b - off_in));
+          if (n_read == SAFE_READ_ERROR)
+            die (EXIT_FAILURE, errno, "%s", quotef (infile));
+          if (n_read == 0)
+            break;
+          if (full_write (STDOUT_FILENO, buf, n_read) != n_read)
+            die (EXIT_FAILURE, errno, "%s", _("write error"));
+          off_in += n_read;
+        }
+    }
+}
+
 /* -n K/N: Extract Kth of N chunks.  */
 
 static void
@@ -1326,7 +1658,7 @@ main (int argc, char **argv)
       int this_optind = optind ? optind : 1;
       char *slash;
 
-      c = getopt_long (argc, argv, "0123456789C:a:b:del:n:t:ux",
+      c = getopt_long (argc, argv, "0123456789C:a:b:dej:l:n:t:ux",
                        longopts, NULL);
       if (c == -1)
         break;
@@ -1360,6 +1692,11 @@ main (int argc, char **argv)
                                 _("invalid number of bytes"), 0);
           break;
 
+        case 'j':
+          filter_jobs = xdectoumax (optarg, 1, SIZE_MAX, "",
+                                    _("invalid number of jobs"), 0);
+          break;
+
         case 'l':
           if (split_type != type_undef)
             FAIL_ONLY_ONE_WAY ();
@@ -1523,6 +1860,12 @@ main (int argc, char **argv)
       usage (EXIT_FAILURE);
     }
 
+  if (1 < filter_jobs && ! filter_command)
+    {
+      error (0, 0, _("--jobs is meaningful only with --filter"));
+      usage (EXIT_FAILURE);
+    }
+
   /* Handle default case.  */
   if (split_type == type_undef)
     {
@@ -1636,16 +1979,30 @@ main (int argc, char **argv)
 
     case type_chunk_bytes:
       if (k_units == 0)
-        bytes_split (file_size / n_units, buf, in_blk_size, initial_read,
-                     n_units);
+        {
+          /* With several filter jobs over a seekable input, the chunk
+             extents are known up front, so the filters can be fed
+             concurrently from independent preads instead of in turn
+             through the parent.  */
+          if (filter_command && 1 < filter_jobs
+              && S_ISREG (in_stat_buf.st_mode))
+            bytes_chunk_filter_parallel (n_units, in_blk_size, initial_read,
+                                         file_size);
+          else
+            bytes_split (file_size / n_units, buf, in_blk_size, initial_read,
+                         n_units);
+        }
       else
         bytes_chunk_extract (k_units, n_units, buf, in_blk_size, initial_read,
                              file_size);
       break;
 
     case type_chunk_lines:
-      lines_chunk_split (k_units, n_units, buf, in_blk_size, initial_read,
-                         file_size);
+      if (k_units && S_ISREG (in_stat_buf.st_mode))
+        lines_chunk_extract (k_units, n_units, buf, in_blk_size, file_size);
+      else
+        lines_chunk_split (k_units, n_units, buf, in_blk_size, initial_read,
+                           file_size);
       break;
 
     case type_rr:
@@ -1663,6 +2020,7 @@ main (int argc, char **argv)
   if (close (STDIN_FILENO) != 0)
     die (EXIT_FAILURE, errno, "%s", quotef (infile));
   closeout (NULL, output_desc, filter_pid, outfile);
+  wait_all_filters ();
 
   return EXIT_SUCCESS;
 }
@@ -28,6 +28,7 @@
 # define USE_STATVFS 0
 #endif
 
+#include <assert.h>
 #include <stddef.h>
 #include <stdio.h>
 #include <stdalign.h>
@@ -60,6 +61,7 @@
 
 #include "areadlink.h"
 #include "argmatch.h"
+#include "argv-iter.h"
 #include "die.h"
 #include "error.h"
 #include "file-type.h"
@@ -198,7 +200,8 @@ static char const fmt_terse_selinux[] = "%n %s %b %f %u %g %D %i %h %t %T"
 
 enum
 {
-  PRINTF_OPTION = CHAR_MAX + 1
+  PRINTF_OPTION = CHAR_MAX + 1,
+  FILES0_FROM_OPTION
 };
 
 enum cached_mode
@@ -224,6 +227,7 @@ static struct option const long_options[] =
   {"file-system", no_argument, NULL, 'f'},
   {"format", required_argument, NULL, 'c'},
   {"printf", required_argument, NULL, PRINTF_OPTION},
+  {"files0-from", required_argument, NULL, FILES0_FROM_OPTION},
   {"terse", no_argument, NULL, 't'},
   {"cached", required_argument, NULL, 0},
   {GETOPT_HELP_OPTION_DECL},
@@ -1062,10 +1066,10 @@ getenv_quoting_style (void)
 /* Equivalent to quotearg(), but explicit to avoid syntax checks.  */
 #define quoteN(x) quotearg_style (get_quoting_style (NULL), x)
 
-/* Output a single-character \ escape.  */
+/* Decode a single-character \ escape.  */
 
-static void
-print_esc_char (char c)
+static char
+decode_esc_char (char c)
 {
   switch (c)
     {
@@ -1100,7 +1104,7 @@ print_esc_char (char c)
       error (0, 0, _("warning: unrecognized escape '\\%c'"), c);
       break;
     }
-  putchar (c);
+  return c;
 }
 
 static size_t _GL_ATTRIBUTE_PURE
@@ -1114,28 +1118,57 @@ format_code_offset (char const* directive)
   return fmt_char - directive;
 }
 
-/* Print the information specified by the format string, FORMAT,
-   calling PRINT_FUNC for each %-directive encountered.
-   Return zero upon success, nonzero upon failure.  */
-static bool ATTRIBUTE_WARN_UNUSED_RESULT
-print_it (char const *format, int fd, char const *filename,
-          bool (*print_func) (char *, size_t, unsigned int,
-                              int, char const *, void const *),
-          void const *data)
+/* One step of a compiled format string: LITERAL_LEN bytes to copy
+   verbatim, then, if DIRECTIVE is non-null, a %-directive to
+   interpret.  DIRECTIVE has room for the longer printf conversion
+   appended by the print functions.  */
+/* Room to grow a directive when printing it: we convert the stat '%s'
+   format string to the longer printf '%llu' one.  */
+enum
+  {
+    MAX_ADDITIONAL_BYTES =
+      (MAX (sizeof PRIdMAX,
+            MAX (sizeof PRIoMAX, MAX (sizeof PRIuMAX, sizeof PRIxMAX)))
+       - 1)
+  };
+
+struct fmt_segment
 {
-  bool fail = false;
+  char const *literal;
+  size_t literal_len;
+  char const *directive;
+  size_t prefix_len;
+  unsigned char m;
+};
+
+struct compiled_fmt
+{
+  struct fmt_segment *segments;
+  size_t n_segments;
+  char *scratch;		/* Working space for one directive.  */
+  char const *source;		/* The original format string.  */
+};
+
+/* Compile the format string FORMAT into CF, so that printing a file
+   need not re-interpret the format: backslash escapes are decoded
+   once, literal runs are gathered, and each %-directive gets its own
+   reusable buffer.  Diagnoses invalid directives fatally, and bad
+   escapes with a one-time warning, as interpreting per file would.  */
+static void
+compile_fmt (char const *format, struct compiled_fmt *cf)
+{
+  cf->source = format;
+  cf->segments = NULL;
+  cf->n_segments = 0;
+  size_t n_alloc = 0;
+  size_t max_prefix_len = 0;
+
+  /* Decoded literal bytes never outnumber the format's own, so one
+     buffer sized for the whole format holds all literal runs.  */
+  char *lit = xmalloc (strlen (format) + 1);
+  char *lit_cur = lit;
+  char const *lit_start = lit;
 
-  /* Add 2 to accommodate our conversion of the stat '%s' format string
-     to the longer printf '%llu' one.  */
-  enum
-    {
-      MAX_ADDITIONAL_BYTES =
-        (MAX (sizeof PRIdMAX,
-              MAX (sizeof PRIoMAX, MAX (sizeof PRIuMAX, sizeof PRIxMAX)))
-         - 1)
-    };
-  size_t n_alloc = strlen (format) + MAX_ADDITIONAL_BYTES + 1;
-  char *dest = xmalloc (n_alloc);
   char const *b;
   for (b = format; *b; b++)
     {
@@ -1145,7 +1178,6 @@ print_it (char const *format, int fd, char const *filename,
           {
             size_t len = format_code_offset (b);
             char const *fmt_char = b + len;
-            memcpy (dest, b, len);
             b += len;
 
             switch (*fmt_char)
@@ -1156,17 +1188,30 @@ print_it (char const *format, int fd, char const *filename,
               case '%':
                 if (1 < len)
                   {
-                    dest[len] = *fmt_char;
-                    dest[len + 1] = '\0';
+                    char *bad = xmalloc (len + 2);
+                    memcpy (bad, fmt_char - len, len);
+                    bad[len] = *fmt_char;
+                    bad[len + 1] = '\0';
                     die (EXIT_FAILURE, 0, _("%s: invalid directive"),
-                         quote (dest));
+                         quote (bad));
                   }
-                putchar ('%');
+                *lit_cur++ = '%';
                 break;
               default:
-                fail |= print_func (dest, len, to_uchar (*fmt_char),
-                                    fd, filename, data);
-                break;
+                {
+                  if (cf->n_segments == n_alloc)
+                    cf->segments = x2nrealloc (cf->segments, &n_alloc,
+                                               sizeof *cf->segments);
+                  struct fmt_segment *seg = &cf->segments[cf->n_segments++];
+                  seg->literal = lit_start;
+                  seg->literal_len = lit_cur - lit_start;
+                  lit_start = lit_cur;
+                  seg->directive = fmt_char - len;
+                  seg->prefix_len = len;
+                  seg->m = to_uchar (*fmt_char);
+                  max_prefix_len = MAX (max_prefix_len, len);
+                  break;
+                }
               }
             break;
           }
@@ -1174,7 +1219,7 @@ print_it (char const *format, int fd, char const *filename,
         case '\\':
           if ( ! interpret_backslash_escapes)
             {
-              putchar ('\\');
+              *lit_cur++ = '\\';
               break;
             }
           ++b;
@@ -1187,7 +1232,7 @@ print_it (char const *format, int fd, char const *filename,
                 {
                   esc_value = esc_value * 8 + octtobin (*b);
                 }
-              putchar (esc_value);
+              *lit_cur++ = esc_value;
               --b;
             }
           else if (*b == 'x' && isxdigit (to_uchar (b[1])))
@@ -1201,27 +1246,70 @@ print_it (char const *format, int fd, char const *filename,
                   ++b;
                   esc_value = esc_value * 16 + hextobin (*b);
                 }
-              putchar (esc_value);
+              *lit_cur++ = esc_value;
             }
           else if (*b == '\0')
             {
               error (0, 0, _("warning: backslash at end of format"));
-              putchar ('\\');
+              *lit_cur++ = '\\';
               /* Arrange to exit the loop.  */
               --b;
             }
           else
             {
-              print_esc_char (*b);
+              *lit_cur++ = decode_esc_char (*b);
             }
           break;
 
         default:
-          putchar (*b);
+          *lit_cur++ = *b;
           break;
         }
     }
-  free (dest);
+
+  /* A trailing literal run, and the degenerate all-literal format.  */
+  if (lit_start < lit_cur || cf->n_segments == 0)
+    {
+      if (cf->n_segments == n_alloc)
+        cf->segments = x2nrealloc (cf->segments, &n_alloc,
+                                   sizeof *cf->segments);
+      struct fmt_segment *seg = &cf->segments[cf->n_segments++];
+      seg->literal = lit_start;
+      seg->literal_len = lit_cur - lit_start;
+      seg->directive = NULL;
+      seg->prefix_len = 0;
+      seg->m = 0;
+    }
+
+  cf->scratch = xmalloc (max_prefix_len + MAX_ADDITIONAL_BYTES + 1);
+}
+
+/* Print the information specified by the compiled format CF, calling
+   PRINT_FUNC for each %-directive.
+   Return zero upon success, nonzero upon failure.  */
+static bool ATTRIBUTE_WARN_UNUSED_RESULT
+print_compiled (struct compiled_fmt const *cf, int fd, char const *filename,
+                bool (*print_func) (char *, size_t, unsigned int,
+                                    int, char const *, void const *),
+                void const *data)
+{
+  bool fail = false;
+
+  for (size_t i = 0; i < cf->n_segments; i++)
+    {
+      struct fmt_segment const *seg = &cf->segments[i];
+      if (seg->literal_len)
+        fwrite (seg->literal, 1, seg->literal_len, stdout);
+      if (seg->directive)
+        {
+          /* PRINT_FUNC rewrites the directive in place (make_format),
+             so hand it a fresh copy for each file.  */
+          memcpy (cf->scratch, seg->directive, seg->prefix_len);
+          cf->scratch[seg->prefix_len] = '\0';
+          fail |= print_func (cf->scratch, seg->prefix_len, seg->m,
+                              fd, filename, data);
+        }
+    }
 
   fputs (trailing_delim, stdout);
 
@@ -1230,7 +1318,7 @@ print_it (char const *format, int fd, char const *filename,
 
 /* Stat the file system and print what we find.  */
 static bool ATTRIBUTE_WARN_UNUSED_RESULT
-do_statfs (char const *filename, char const *format)
+do_statfs (char const *filename, struct compiled_fmt const *fmt)
 {
   STRUCT_STATVFS statfsbuf;
 
@@ -1248,7 +1336,7 @@ do_statfs (char const *filename, char const *format)
       return false;
     }
 
-  bool fail = print_it (format, -1, filename, print_statfs, &statfsbuf);
+  bool fail = print_compiled (fmt, -1, filename, print_statfs, &statfsbuf);
   return ! fail;
 }
 
@@ -1337,7 +1425,8 @@ format_to_mask (char const *format)
 
 /* statx the file and print what we find */
 static bool ATTRIBUTE_WARN_UNUSED_RESULT
-do_stat (char const *filename, char const *format, char const *format2)
+do_stat (char const *filename, struct compiled_fmt const *fmt,
+         struct compiled_fmt const *fmt2)
 {
   int fd = STREQ (filename, "-") ? 0 : AT_FDCWD;
   int flags = 0;
@@ -1363,7 +1452,16 @@ do_stat (char const *filename, char const *format, char const *format2)
   else if (force_sync)
     flags |= AT_STATX_FORCE_SYNC;
 
-  fd = statx (fd, pathname, flags, format_to_mask (format), &stx);
+  /* The mask depends only on the format, so compute it just once.  */
+  static unsigned int mask;
+  static bool mask_known;
+  if (! mask_known)
+    {
+      mask = format_to_mask (fmt->source);
+      mask_known = true;
+    }
+
+  fd = statx (fd, pathname, flags, mask, &stx);
   if (fd < 0)
     {
       if (flags & AT_EMPTY_PATH)
@@ -1374,13 +1472,13 @@ do_stat (char const *filename, char const *format, char const *format2)
     }
 
   if (S_ISBLK (stx.stx_mode) || S_ISCHR (stx.stx_mode))
-    format = format2;
+    fmt = fmt2;
 
   statx_to_stat (&stx, &st);
   if (stx.stx_mask & STATX_BTIME)
     pa.btime = statx_timestamp_to_timespec (stx.stx_btime);
 
-  bool fail = print_it (format, fd, filename, print_stat, &pa);
+  bool fail = print_compiled (fmt, fd, filename, print_stat, &pa);
   return ! fail;
 }
 
@@ -1421,8 +1519,8 @@ get_birthtime (int fd, char const *filename, struct stat const *st)
 
 /* stat the file and print what we find */
 static bool ATTRIBUTE_WARN_UNUSED_RESULT
-do_stat (char const *filename, char const *format,
-         char const *format2)
+do_stat (char const *filename, struct compiled_fmt const *fmt,
+         struct compiled_fmt const *fmt2)
 {
   int fd = STREQ (filename, "-") ? 0 : -1;
   struct stat statbuf;
@@ -1450,9 +1548,9 @@ do_stat (char const *filename, char const *format,
     }
 
   if (S_ISBLK (statbuf.st_mode) || S_ISCHR (statbuf.st_mode))
-    format = format2;
+    fmt = fmt2;
 
-  bool fail = print_it (format, fd, filename, print_stat, &pa);
+  bool fail = print_compiled (fmt, fd, filename, print_stat, &pa);
   return ! fail;
 }
 #endif /* USE_STATX */
@@ -1696,7 +1794,10 @@ usage (int status)
     emit_try_help ();
   else
     {
-      printf (_("Usage: %s [OPTION]... FILE...\n"), program_name);
+      printf (_("\
+Usage: %s [OPTION]... FILE...\n\
+  or:  %s [OPTION]... --files0-from=F\n\
+"), program_name, program_name);
       fputs (_("\
 Display file or file system status.\n\
 "), stdout);
@@ -1714,6 +1815,9 @@ Display file or file system status.\n\
       fputs (_("\
   -c  --format=FORMAT   use the specified FORMAT instead of the default;\n\
                           output a newline after each use of FORMAT\n\
+      --files0-from=F   display status of the NUL-terminated file names\n\
+                          specified in file F;\n\
+                          if F is -, then read names from standard input\n\
       --printf=FORMAT   like --format, but interpret backslash escapes,\n\
                           and do not output a mandatory trailing newline;\n\
                           if you want a newline, include \\n in FORMAT\n\
@@ -1820,6 +1924,7 @@ main (int argc, char *argv[])
   bool terse = false;
   char *format = NULL;
   char *format2;
+  char *files_from = NULL;
   bool ok = true;
 
   initialize_main (&argc, &argv);
@@ -1862,6 +1967,10 @@ main (int argc, char *argv[])
           terse = true;
           break;
 
+        case FILES0_FROM_OPTION:
+          files_from = optarg;
+          break;
+
         case 0:
           switch (XARGMATCH ("--cached", optarg, cached_args, cached_modes))
             {
@@ -1888,11 +1997,37 @@ main (int argc, char *argv[])
         }
     }
 
-  if (argc == optind)
+  struct argv_iterator *ai;
+  if (files_from)
     {
-      error (0, 0, _("missing operand"));
-      usage (EXIT_FAILURE);
+      /* When using --files0-from=F, you may not specify any files
+         on the command-line.  */
+      if (optind < argc)
+        {
+          error (0, 0, _("extra operand %s"), quote (argv[optind]));
+          fprintf (stderr, "%s\n",
+                   _("file operands cannot be combined with --files0-from"));
+          usage (EXIT_FAILURE);
+        }
+
+      if (! (STREQ (files_from, "-") || freopen (files_from, "r", stdin)))
+        die (EXIT_FAILURE, errno, _("cannot open %s for reading"),
+             quoteaf (files_from));
+
+      ai = argv_iter_init_stream (stdin);
+    }
+  else
+    {
+      if (argc == optind)
+        {
+          error (0, 0, _("missing operand"));
+          usage (EXIT_FAILURE);
+        }
+
+      ai = argv_iter_init_argv (argv + optind);
     }
+  if (!ai)
+    xalloc_die ();
 
   if (format)
     {
@@ -1906,10 +2041,50 @@ main (int argc, char *argv[])
       format2 = default_format (fs, terse, /* device= */ true);
     }
 
-  for (int i = optind; i < argc; i++)
-    ok &= (fs
-           ? do_statfs (argv[i], format)
-           : do_stat (argv[i], format, format2));
+  static struct compiled_fmt cfmt;
+  static struct compiled_fmt cfmt2;
+  compile_fmt (format, &cfmt);
+  if (format2 == format)
+    cfmt2 = cfmt;
+  else
+    compile_fmt (format2, &cfmt2);
+
+  while (true)
+    {
+      enum argv_iter_err ai_err;
+      char *file_name = argv_iter (ai, &ai_err);
+      if (!file_name)
+        {
+          if (ai_err == AI_ERR_EOF)
+            break;
+          switch (ai_err)
+            {
+            case AI_ERR_READ:
+              error (0, errno, _("%s: read error"), quotef (files_from));
+              ok = false;
+              break;
+            case AI_ERR_MEM:
+              xalloc_die ();
+            default:
+              assert (!"unexpected error code from argv_iter");
+            }
+          break;
+        }
+      if (files_from && STREQ (files_from, "-") && STREQ (file_name, "-"))
+        {
+          /* Give a better diagnostic in an unusual case:
+             printf - | stat --files0-from=- */
+          error (0, 0, _("when reading file names from stdin, "
+                         "no file name of %s allowed"),
+                 quoteaf (file_name));
+          ok = false;
+          continue;
+        }
+      ok &= (fs
+             ? do_statfs (file_name, &cfmt)
+             : do_stat (file_name, &cfmt, &cfmt2));
+    }
+  argv_iter_free (ai);
 
   return ok ? EXIT_SUCCESS : EXIT_FAILURE;
 }
@@ -0,0 +1,92 @@
+/* stdbuf-policy.c -- honor the stdbuf buffering protocol natively
+
+   Copyright (C) 2021 Free Software Foundation, Inc.
+
+   This program is free software: you can redistribute it and/or modify
+   it under the terms of the GNU General Public License as published by
+   the Free Software Foundation, either version 3 of the License, or
+   (at your option) any later version.
+
+   This program is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU General Public License for more details.
+
+   You should have received a copy of the GNU General Public License
+   along with this program.  If not, see <https://www.gnu.org/licenses/>.  */
+
+/* stdbuf(1) adjusts the stdio buffering of an arbitrary command by
+   preloading libstdbuf via LD_PRELOAD, which does not work for
+   statically linked binaries and pays dynamic-loader overhead on
+   every exec.  Tools that link this module instead read the same
+   _STDBUF_O environment variable themselves, so a caller (or a
+   pipeline supervisor) can request a buffering policy directly,
+   whether or not it goes through stdbuf.  The variable's value is
+   stdbuf's: "0" for unbuffered, "L" for line buffered, or a positive
+   byte count for a fully buffered stream of that size.  */
+
+#include <config.h>
+#include <stdio.h>
+
+#include "system.h"
+#include "error.h"
+#include "quote.h"
+#include "stdbuf-policy.h"
+
+/* If _STDBUF_O requests a full buffer of an explicit size, return
+   that size; otherwise return FALLBACK.  This form is for tools that
+   write to their output descriptor directly and only care about the
+   block size, not the stdio buffering mode.  */
+
+size_t
+stdbuf_policy_output_size (size_t fallback)
+{
+  char const *spec = getenv ("_STDBUF_O");
+  if (spec && *spec && *spec != '0' && *spec != 'L')
+    {
+      char *spec_end;
+      uintmax_t size = strtoumax (spec, &spec_end, 10);
+      if (0 < size && size <= SIZE_MAX && !*spec_end)
+        return size;
+      error (0, 0, _("ignoring invalid buffering mode %s"), quote (spec));
+    }
+  return fallback;
+}
+
+/* Apply the buffering mode requested by _STDBUF_O to stdout.
+   Must be called before anything is written to stdout.  Like
+   libstdbuf, an unusable request is diagnosed and ignored.  */
+
+void
+stdbuf_policy_apply_stdout (void)
+{
+  char const *spec = getenv ("_STDBUF_O");
+  if (!spec || !*spec)
+    return;
+
+  if (*spec == '0')
+    setvbuf (stdout, NULL, _IONBF, 0);
+  else if (*spec == 'L')
+    setvbuf (stdout, NULL, _IOLBF, 0);
+  else
+    {
+      size_t size = stdbuf_policy_output_size (0);
+      if (size == 0)
+        return;
+
+      /* Allocate the buffer ourselves: glibc ignores a NULL buffer
+         combined with a nonzero size.  It is freed by fclose.  */
+      char *buf = malloc (size);
+      if (!buf)
+        {
+          error (0, 0,
+                 _("failed to allocate a %s byte stdio buffer"), spec);
+          return;
+        }
+      if (setvbuf (stdout, buf, _IOFBF, size) != 0)
+        {
+          error (0, errno, _("could not set buffering of standard output"));
+          free (buf);
+        }
+    }
+}
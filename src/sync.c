@@ -37,6 +37,10 @@
 # define HAVE_SYNCFS 0
 #endif
 
+#ifndef HAVE_SYNC_FILE_RANGE
+# define HAVE_SYNC_FILE_RANGE 0
+#endif
+
 enum sync_mode
 {
   MODE_FILE,
@@ -84,13 +88,22 @@ or their containing file systems.\n\
   exit (status);
 }
 
-/* Sync the specified FILE, or file systems associated with FILE.
-   Return 1 on success.  */
+/* A file argument and the descriptor opened for it.  */
 
-static bool
-sync_arg (enum sync_mode mode, char const *file)
+struct sync_file
+{
+  char const *file;
+  int fd;			/* -1 if the open failed.  */
+  dev_t dev;			/* Containing device, if DEV_KNOWN.  */
+  bool dev_known;
+};
+
+/* Open the specified FILE for syncing, and diagnose failure.
+   Return the file descriptor, or -1 on error.  */
+
+static int
+open_arg (enum sync_mode mode, char const *file)
 {
-  bool ret = true;
   int open_flags = O_RDONLY | O_NONBLOCK;
   int fd;
 
@@ -113,7 +126,7 @@ sync_arg (enum sync_mode mode, char const *file)
       if (fd < 0)
         {
           error (0, rd_errno, _("error opening %s"), quoteaf (file));
-          return false;
+          return -1;
         }
     }
 
@@ -125,41 +138,75 @@ sync_arg (enum sync_mode mode, char const *file)
     {
       error (0, errno, _("couldn't reset non-blocking mode %s"),
              quoteaf (file));
-      ret = false;
+      if (close (fd) < 0)
+        error (0, errno, _("failed to close %s"), quoteaf (file));
+      return -1;
     }
 
-  if (ret == true)
-    {
-      int sync_status = -1;
+  return fd;
+}
+
+/* Sync F->fd, previously opened for F->file, and close it.
+   With MODE_FILE_SYSTEM, skip the sync if FILES[0 .. I-1] shows an
+   earlier argument already synced the containing file system.
+   Return 1 on success.  */
+
+static bool
+sync_arg (enum sync_mode mode, struct sync_file *files, int i)
+{
+  struct sync_file *f = &files[i];
+  char const *file = f->file;
+  bool ret = true;
+  int sync_status = -1;
+  bool skip = false;
 
-      switch (mode)
+  if (mode == MODE_FILE_SYSTEM)
+    {
+      /* One syncfs covers every argument on the same device.  */
+      struct stat st;
+      if (fstat (f->fd, &st) == 0)
         {
-        case MODE_DATA:
-          sync_status = fdatasync (fd);
-          break;
+          f->dev = st.st_dev;
+          f->dev_known = true;
+          for (int j = 0; j < i; j++)
+            if (files[j].dev_known && files[j].dev == f->dev)
+              {
+                skip = true;
+                break;
+              }
+        }
+    }
 
-        case MODE_FILE:
-          sync_status = fsync (fd);
-          break;
+  if (skip)
+    sync_status = 0;
+  else
+    switch (mode)
+      {
+      case MODE_DATA:
+        sync_status = fdatasync (f->fd);
+        break;
+
+      case MODE_FILE:
+        sync_status = fsync (f->fd);
+        break;
 
 #if HAVE_SYNCFS
-        case MODE_FILE_SYSTEM:
-          sync_status = syncfs (fd);
-          break;
+      case MODE_FILE_SYSTEM:
+        sync_status = syncfs (f->fd);
+        break;
 #endif
 
-        default:
-          assert ("invalid sync_mode");
-        }
+      default:
+        assert ("invalid sync_mode");
+      }
 
-      if (sync_status < 0)
-        {
-          error (0, errno, _("error syncing %s"), quoteaf (file));
-          ret = false;
-        }
+  if (sync_status < 0)
+    {
+      error (0, errno, _("error syncing %s"), quoteaf (file));
+      ret = false;
     }
 
-  if (close (fd) < 0)
+  if (close (f->fd) < 0)
     {
       error (0, errno, _("failed to close %s"), quoteaf (file));
       ret = false;
@@ -231,8 +278,36 @@ main (int argc, char **argv)
     sync ();
   else
     {
-      for (; optind < argc; optind++)
-        ok &= sync_arg (mode, argv[optind]);
+      int nfiles = argc - optind;
+      struct sync_file *files = xnmalloc (nfiles, sizeof *files);
+
+      /* Open every argument up front, so writeback of each can be
+         started before blocking on any one of them.  */
+      for (int i = 0; i < nfiles; i++)
+        {
+          files[i].file = argv[optind + i];
+          files[i].fd = open_arg (mode, files[i].file);
+          files[i].dev_known = false;
+          if (files[i].fd < 0)
+            ok = false;
+        }
+
+#if HAVE_SYNC_FILE_RANGE
+      /* Ask the kernel to start writing out each file's dirty pages
+         before waiting on any of them, so one slow device does not
+         serialize the flushes of the others.  This is advisory; any
+         errors are reported by the blocking calls below.  */
+      if (mode != MODE_FILE_SYSTEM && 1 < nfiles)
+        for (int i = 0; i < nfiles; i++)
+          if (0 <= files[i].fd)
+            sync_file_range (files[i].fd, 0, 0, SYNC_FILE_RANGE_WRITE);
+#endif
+
+      for (int i = 0; i < nfiles; i++)
+        if (0 <= files[i].fd)
+          ok &= sync_arg (mode, files, i);
+
+      free (files);
     }
 
   return ok ? EXIT_SUCCESS : EXIT_FAILURE;
@@ -177,6 +177,21 @@ field_sep (unsigned char ch)
 #define _(msgid) gettext (msgid)
 #define N_(msgid) msgid
 
+/* Set up the locale and the message catalog, as main traditionally
+   does before parsing options.  Byte-oriented applets whose normal
+   output never consults locale data may instead call this lazily,
+   just before printing a translatable message, so that their hot
+   paths skip loading locale tables entirely; see echo.c.  The
+   function is idempotent, so diagnostic paths can call it without
+   worrying whether main already did.  */
+static inline void
+initialize_locale (void)
+{
+  setlocale (LC_ALL, "");
+  bindtextdomain (PACKAGE, LOCALEDIR);
+  textdomain (PACKAGE);
+}
+
 /* Return a value that pluralizes the same way that N does, in all
    languages we know of.  */
 static inline unsigned long int
@@ -700,6 +715,71 @@ bad_cast (char const *s)
   return (char *) s;
 }
 
+/* Fast decimal conversion, shared by the number-heavy tools, which
+   otherwise each hand-roll a digit-at-a-time loop.  The pair table
+   halves the divisions: every two digits cost one division and one
+   two-byte copy.  */
+
+static char const decimal_pairs[100][2] =
+  {
+    "00", "01", "02", "03", "04", "05", "06", "07", "08", "09",
+    "10", "11", "12", "13", "14", "15", "16", "17", "18", "19",
+    "20", "21", "22", "23", "24", "25", "26", "27", "28", "29",
+    "30", "31", "32", "33", "34", "35", "36", "37", "38", "39",
+    "40", "41", "42", "43", "44", "45", "46", "47", "48", "49",
+    "50", "51", "52", "53", "54", "55", "56", "57", "58", "59",
+    "60", "61", "62", "63", "64", "65", "66", "67", "68", "69",
+    "70", "71", "72", "73", "74", "75", "76", "77", "78", "79",
+    "80", "81", "82", "83", "84", "85", "86", "87", "88", "89",
+    "90", "91", "92", "93", "94", "95", "96", "97", "98", "99"
+  };
+
+/* Write the decimal digits of N ending just before END, without a
+   terminating NUL, and return a pointer to the first digit.  END must
+   have at least INT_BUFSIZE_BOUND (uintmax_t) bytes of room below it.  */
+static inline char *
+dectostr_r (uintmax_t n, char *end)
+{
+  while (100 <= n)
+    {
+      end -= 2;
+      memcpy (end, decimal_pairs[n % 100], 2);
+      n /= 100;
+    }
+  if (10 <= n)
+    {
+      end -= 2;
+      memcpy (end, decimal_pairs[n], 2);
+    }
+  else
+    *--end = '0' + n;
+  return end;
+}
+
+/* Write the decimal digits of N at P; return the position past them.  */
+static inline char *
+dectostr (char *p, uintmax_t n)
+{
+  char tmp[INT_BUFSIZE_BOUND (uintmax_t)];
+  char *start = dectostr_r (n, tmp + sizeof tmp);
+  size_t len = tmp + sizeof tmp - start;
+  memcpy (p, start, len);
+  return p + len;
+}
+
+/* Accumulate the run of decimal digits at P into *N, wrapping on
+   overflow as the callers' previous open-coded loops did, and return
+   the position past the digits.  */
+static inline char const *
+decparse (char const *p, uintmax_t *n)
+{
+  uintmax_t v = 0;
+  while ('0' <= *p && *p <= '9')
+    v = 10 * v + (*p++ - '0');
+  *n = v;
+  return p;
+}
+
 /* Return a boolean indicating whether SB->st_size is defined.  */
 static inline bool
 usable_st_size (struct stat const *sb)
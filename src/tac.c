@@ -39,6 +39,9 @@ tac -r -s '.\|
 #include <stdio.h>
 #include <getopt.h>
 #include <sys/types.h>
+#if HAVE_MMAP
+# include <sys/mman.h>
+#endif
 #include "system.h"
 
 #include <regex.h>
@@ -46,6 +49,7 @@ tac -r -s '.\|
 #include "die.h"
 #include "error.h"
 #include "filenamecat.h"
+#include "physmem.h"
 #include "safe-read.h"
 #include "stdlib--.h"
 #include "xbinary-io.h"
@@ -185,6 +189,111 @@ output (char const *start, char const *past_end)
   bytes_in_buffer += bytes_to_add;
 }
 
+/* Print in reverse the records in the SIZE bytes of BUF, scanning
+   backward for the fixed-string separator with memrchr.  The records
+   found are the same ones tac_seekable finds: the rightmost separator
+   match is taken first, and successive matches may not overlap.  If
+   WHOLE_FILE, BUF holds the whole input.  Otherwise leave the first
+   (lowest) record unprinted and return the number of leading bytes it
+   occupies, so the caller can complete it with the data that precedes
+   BUF; return 0 when WHOLE_FILE.  */
+
+static size_t
+tac_buffer (char const *buf, size_t size, bool whole_file)
+{
+  char first_char = *separator;
+  char const *past_end = buf + size;	/* One past the unprinted data.  */
+  char const *scan_end = past_end;	/* Matches must end at or before.  */
+  bool first_time = true;
+  size_t unprinted = 0;
+
+  while (true)
+    {
+      /* Find the rightmost match of 'separator' ending at or before
+         SCAN_END.  NSEARCH counts the candidate starting positions.  */
+      size_t nsearch = (match_length <= (size_t) (scan_end - buf)
+                        ? scan_end - buf - match_length + 1
+                        : 0);
+      char const *match_start = NULL;
+      while (nsearch)
+        {
+          char const *p = memrchr (buf, first_char, nsearch);
+          if (! p)
+            break;
+          if (match_length == 1
+              || memcmp (p + 1, separator + 1, match_length - 1) == 0)
+            {
+              match_start = p;
+              break;
+            }
+          nsearch = p - buf;
+        }
+
+      if (! match_start)
+        {
+          /* No match in the rest of the buffer.  */
+          if (whole_file)
+            output (buf, past_end);
+          else
+            unprinted = past_end - buf;
+          break;
+        }
+
+      if (separator_ends_record)
+        {
+          char const *match_end = match_start + match_length;
+
+          /* If this match of 'separator' isn't at the end of the
+             file, print the record. */
+          if (!first_time || match_end != past_end)
+            output (match_end, past_end);
+          past_end = match_end;
+          first_time = false;
+        }
+      else
+        {
+          output (match_start, past_end);
+          past_end = match_start;
+        }
+
+      scan_end = match_start;
+    }
+
+  return unprinted;
+}
+
+#if HAVE_MMAP
+
+/* Try to print in reverse the regular file of FILE_SIZE bytes open on
+   descriptor FD by mapping it into memory and scanning it backward,
+   so no data is seeked over or copied through 'G_buffer'.  Only
+   usable for fixed-string separators.  Return true if the file was
+   printed this way; returning false means the caller should fall
+   back on tac_seekable.  */
+
+static bool
+tac_mmap (int fd, off_t file_size)
+{
+  struct stat st;
+
+  if (fstat (fd, &st) != 0 || ! S_ISREG (st.st_mode))
+    return false;
+
+  size_t size = file_size;
+  if ((off_t) size != file_size)
+    return false;
+
+  char *map = mmap (NULL, size, PROT_READ, MAP_PRIVATE, fd, 0);
+  if (map == MAP_FAILED)
+    return false;
+
+  tac_buffer (map, size, true);
+  munmap (map, size);
+  return true;
+}
+
+#endif /* HAVE_MMAP */
+
 /* Print in reverse the file open on descriptor FD for reading FILE.
    The file is already positioned at FILE_POS, which should be near its end.
    Return true if successful.  */
@@ -539,6 +648,96 @@ copy_to_temp (FILE **g_tmp, char **g_tempfile, int input_fd, char const *file)
   return bytes_copied;
 }
 
+/* Print in reverse the nonseekable input on descriptor INPUT_FD
+   (corresponding to the named FILE), buffering it in memory and
+   spilling full buffers to a temporary file only when the input
+   outgrows half of available memory.  Streams that fit are reversed
+   without touching the disk; for larger streams only the overflow
+   reaches the temporary file, and the in-memory tail is printed
+   directly with its first record appended to the temporary file so
+   tac_seekable can complete it.  Only usable for fixed-string
+   separators.  Return true if successful.  */
+
+static bool
+tac_pipe_spill (int input_fd, char const *file)
+{
+  size_t limit = MAX (read_size, MIN (SIZE_MAX / 2,
+                                      physmem_available () / 2));
+  size_t alloc = read_size;
+  size_t used = 0;
+  char *buf = malloc (alloc);
+  FILE *tmp = NULL;
+  char *tmp_file;
+  off_t spilled = 0;
+
+  if (! buf)
+    xalloc_die ();
+
+  while (true)
+    {
+      if (used == alloc)
+        {
+          char *newbuf;
+          if (alloc < limit
+              && (newbuf = realloc (buf, MIN (limit, 2 * alloc))))
+            {
+              buf = newbuf;
+              alloc = MIN (limit, 2 * alloc);
+            }
+          else
+            {
+              /* Buffer full (or cannot grow); spill it to the
+                 temporary file and refill it from the start.  */
+              if (!tmp && !temp_stream (&tmp, &tmp_file))
+                {
+                  free (buf);
+                  return false;
+                }
+              if (fwrite (buf, 1, used, tmp) != used)
+                {
+                  error (0, errno, _("%s: write error"), quotef (tmp_file));
+                  free (buf);
+                  return false;
+                }
+              spilled += used;
+              used = 0;
+            }
+        }
+
+      size_t bytes_read = safe_read (input_fd, buf + used, alloc - used);
+      if (bytes_read == 0)
+        break;
+      if (bytes_read == SAFE_READ_ERROR)
+        {
+          error (0, errno, _("%s: read error"), quotef (file));
+          free (buf);
+          return false;
+        }
+      used += bytes_read;
+    }
+
+  bool ok = true;
+  if (! tmp)
+    tac_buffer (buf, used, true);
+  else
+    {
+      /* Print the buffered records, and complete the one truncated at
+         the spill boundary by appending its in-memory bytes to the
+         spilled data.  */
+      size_t unprinted = tac_buffer (buf, used, false);
+      if (fwrite (buf, 1, unprinted, tmp) != unprinted
+          || fflush (tmp) != 0)
+        {
+          error (0, errno, _("%s: write error"), quotef (tmp_file));
+          ok = false;
+        }
+      else
+        ok = tac_seekable (fileno (tmp), tmp_file, spilled + unprinted);
+    }
+  free (buf);
+  return ok;
+}
+
 /* Copy INPUT_FD to a temporary, then tac that file.
    Return true if successful.  */
 
@@ -547,6 +746,10 @@ tac_nonseekable (int input_fd, char const *file)
 {
   FILE *tmp_stream;
   char *tmp_file;
+
+  if (sentinel_length)
+    return tac_pipe_spill (input_fd, file);
+
   off_t bytes_copied = copy_to_temp (&tmp_stream, &tmp_file, input_fd, file);
   if (bytes_copied < 0)
     return false;
@@ -587,9 +790,14 @@ tac_file (char const *filename)
 
   file_size = lseek (fd, 0, SEEK_END);
 
-  ok = (file_size < 0 || isatty (fd)
-        ? tac_nonseekable (fd, filename)
-        : tac_seekable (fd, filename, file_size));
+  if (file_size < 0 || isatty (fd))
+    ok = tac_nonseekable (fd, filename);
+#if HAVE_MMAP
+  else if (sentinel_length && 0 < file_size && tac_mmap (fd, file_size))
+    ok = true;
+#endif
+  else
+    ok = tac_seekable (fd, filename, file_size);
 
   if (!is_stdin && close (fd) != 0)
     {
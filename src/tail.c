@@ -42,11 +42,14 @@
 #include "error.h"
 #include "fcntl--.h"
 #include "isapipe.h"
+#include "linescan.h"
 #include "posixver.h"
+#include "probes.h"
 #include "quote.h"
 #include "safe-read.h"
 #include "stat-size.h"
 #include "stat-time.h"
+#include "stdbuf-policy.h"
 #include "xbinary-io.h"
 #include "xdectoint.h"
 #include "xnanosleep.h"
@@ -148,6 +151,15 @@ struct File_spec
   /* 1 if O_NONBLOCK is clear, 0 if set, -1 if not known.  */
   int blocking;
 
+  /* Descriptor on the directory containing NAME, or -1.  It is opened
+     once when following by name, so that recheck() can reopen a rotated
+     file with openat, resolving only the base name instead of walking
+     the whole path on every check.  */
+  int parent_fd;
+
+  /* Offset in NAME of the basename part.  */
+  size_t basename_start;
+
 #if HAVE_INOTIFY
   /* The watch descriptor used by inotify.  */
   int wd;
@@ -156,12 +168,20 @@ struct File_spec
    * when Follow_name is used.  */
   int parent_wd;
 
-  /* Offset in NAME of the basename part.  */
-  size_t basename_start;
+  /* Whether events were received for this file in the current batch,
+     and new data is yet to be output.  */
+  bool dirty;
 #endif
 
   /* See description of DEFAULT_MAX_N_... below.  */
   uintmax_t n_unchanged_stats;
+
+  /* Number of poll intervals tail_forever currently skips between
+     checks of this file, and how many intervals remain before the
+     next check.  Grown while the file is idle, up to a cap, and
+     reset as soon as it changes.  */
+  size_t check_backoff;
+  size_t check_skip;
 };
 
 /* Keep trying to open a file even if it is inaccessible when tail starts
@@ -403,6 +423,8 @@ record_open_fd (struct File_spec *f, int fd,
   f->mode = st->st_mode;
   f->blocking = blocking;
   f->n_unchanged_stats = 0;
+  f->check_backoff = 0;
+  f->check_skip = 0;
   f->ignore = false;
 }
 
@@ -440,6 +462,45 @@ xwrite_stdout (char const *buffer, size_t n_bytes)
     }
 }
 
+#ifdef SPLICE_F_MOVE
+/* Try to move at most N_BYTES from FD to standard output with
+   splice, which the kernel satisfies without copying the data
+   through user space whenever either side is a pipe.  Set *N_MOVED
+   to the number of bytes moved.  Return true when done, that is
+   when N_BYTES were moved or end of file was reached; return false
+   when splice cannot proceed, in which case the caller should copy
+   the rest through a buffer.  */
+
+static bool
+splice_to_stdout (int fd, uintmax_t n_bytes, uintmax_t *n_moved)
+{
+  *n_moved = 0;
+
+  /* Keep raw writes ordered after anything stdio has buffered.  */
+  if (fflush (stdout) != 0)
+    die (EXIT_FAILURE, errno, _("error writing %s"),
+         quoteaf ("standard output"));
+
+  while (*n_moved < n_bytes)
+    {
+      size_t n = MIN (n_bytes - *n_moved, (uintmax_t) SSIZE_MAX);
+      ssize_t spliced = splice (fd, NULL, STDOUT_FILENO, NULL, n,
+                                SPLICE_F_MOVE | SPLICE_F_MORE);
+      if (spliced == 0)
+        return true;
+      if (spliced < 0)
+        {
+          if (errno == EINTR)
+            continue;
+          return false;
+        }
+      *n_moved += spliced;
+    }
+
+  return true;
+}
+#endif
+
 /* Read and output N_BYTES of file PRETTY_FILENAME starting at the current
    position in FD.  If N_BYTES is COPY_TO_EOF, then copy until end of file.
    If N_BYTES is COPY_A_BUFFER, then copy at most one buffer's worth.
@@ -453,6 +514,23 @@ dump_remainder (bool want_header, char const *pretty_filename, int fd,
   uintmax_t n_remaining = n_bytes;
 
   n_written = 0;
+
+#ifdef SPLICE_F_MOVE
+  /* With no header pending, the bytes pass through unmodified, so
+     try to move them with splice; fall back on buffered copying from
+     wherever splice stops.  */
+  if (! want_header && n_bytes != COPY_A_BUFFER)
+    {
+      uintmax_t n_spliced;
+      bool done = splice_to_stdout (fd, n_bytes, &n_spliced);
+      n_written += n_spliced;
+      if (done)
+        return n_written;
+      if (n_bytes != COPY_TO_EOF)
+        n_remaining -= n_spliced;
+    }
+#endif
+
   while (1)
     {
       char buffer[BUFSIZ];
@@ -522,10 +600,15 @@ xlseek (int fd, off_t offset, int whence, char const *filename)
   exit (EXIT_FAILURE);
 }
 
+/* How much file_lines reads at a time while seeking backward.  Large
+   aligned reads keep the syscall count low when the last lines are
+   far from EOF, e.g. with long lines or a large -n.  */
+enum { FILE_LINES_BUFLEN = 128 * 1024 };
+
 /* Print the last N_LINES lines from the end of file FD.
-   Go backward through the file, reading 'BUFSIZ' bytes at a time (except
-   probably the first), until we hit the start of the file or have
-   read NUMBER newlines.
+   Go backward through the file, reading FILE_LINES_BUFLEN bytes at a
+   time (except probably the first), until we hit the start of the
+   file or have read NUMBER newlines.
    START_POS is the starting position of the read pointer for the file
    associated with FD (may be nonzero).
    END_POS is the file offset of EOF (one larger than offset of last byte).
@@ -535,27 +618,32 @@ static bool
 file_lines (char const *pretty_filename, int fd, uintmax_t n_lines,
             off_t start_pos, off_t end_pos, uintmax_t *read_pos)
 {
-  char buffer[BUFSIZ];
+  char *buffer;
   size_t bytes_read;
   off_t pos = end_pos;
+  bool ok = true;
 
   if (n_lines == 0)
     return true;
 
+  buffer = xmalloc (FILE_LINES_BUFLEN);
+
   /* Set 'bytes_read' to the size of the last, probably partial, buffer;
-     0 < 'bytes_read' <= 'BUFSIZ'.  */
-  bytes_read = (pos - start_pos) % BUFSIZ;
+     0 < 'bytes_read' <= 'FILE_LINES_BUFLEN'.  */
+  bytes_read = (pos - start_pos) % FILE_LINES_BUFLEN;
   if (bytes_read == 0)
-    bytes_read = BUFSIZ;
-  /* Make 'pos' a multiple of 'BUFSIZ' (0 if the file is short), so that all
-     reads will be on block boundaries, which might increase efficiency.  */
+    bytes_read = FILE_LINES_BUFLEN;
+  /* Make 'pos' a multiple of 'FILE_LINES_BUFLEN' (0 if the file is short),
+     so that all reads will be on block boundaries, which might increase
+     efficiency.  */
   pos -= bytes_read;
   xlseek (fd, pos, SEEK_SET, pretty_filename);
   bytes_read = safe_read (fd, buffer, bytes_read);
   if (bytes_read == SAFE_READ_ERROR)
     {
       error (0, errno, _("error reading %s"), quoteaf (pretty_filename));
-      return false;
+      ok = false;
+      goto free_buffer;
     }
   *read_pos = pos + bytes_read;
 
@@ -567,24 +655,18 @@ file_lines (char const *pretty_filename, int fd, uintmax_t n_lines,
     {
       /* Scan backward, counting the newlines in this bufferfull.  */
 
-      size_t n = bytes_read;
-      while (n)
+      char const *nl = rskip_delims (buffer, bytes_read, line_end, &n_lines);
+      if (nl)
         {
-          char const *nl;
-          nl = memrchr (buffer, line_end, n);
-          if (nl == NULL)
-            break;
-          n = nl - buffer;
-          if (n_lines-- == 0)
-            {
-              /* If this newline isn't the last character in the buffer,
-                 output the part that is after it.  */
-              if (n != bytes_read - 1)
-                xwrite_stdout (nl + 1, bytes_read - (n + 1));
-              *read_pos += dump_remainder (false, pretty_filename, fd,
-                                           end_pos - (pos + bytes_read));
-              return true;
-            }
+          size_t n = nl - buffer;
+
+          /* If this newline isn't the last character in the buffer,
+             output the part that is after it.  */
+          if (n != bytes_read - 1)
+            xwrite_stdout (nl + 1, bytes_read - (n + 1));
+          *read_pos += dump_remainder (false, pretty_filename, fd,
+                                       end_pos - (pos + bytes_read));
+          goto free_buffer;
         }
 
       /* Not enough newlines in that bufferfull.  */
@@ -595,23 +677,26 @@ file_lines (char const *pretty_filename, int fd, uintmax_t n_lines,
           xlseek (fd, start_pos, SEEK_SET, pretty_filename);
           *read_pos = start_pos + dump_remainder (false, pretty_filename, fd,
                                                   end_pos);
-          return true;
+          goto free_buffer;
         }
-      pos -= BUFSIZ;
+      pos -= FILE_LINES_BUFLEN;
       xlseek (fd, pos, SEEK_SET, pretty_filename);
 
-      bytes_read = safe_read (fd, buffer, BUFSIZ);
+      bytes_read = safe_read (fd, buffer, FILE_LINES_BUFLEN);
       if (bytes_read == SAFE_READ_ERROR)
         {
           error (0, errno, _("error reading %s"), quoteaf (pretty_filename));
-          return false;
+          ok = false;
+          goto free_buffer;
         }
 
       *read_pos = pos + bytes_read;
     }
   while (bytes_read > 0);
 
-  return true;
+free_buffer:
+  free (buffer);
+  return ok;
 }
 
 /* Print the last N_LINES lines from the end of the standard input,
@@ -633,6 +718,7 @@ pipe_lines (char const *pretty_filename, int fd, uintmax_t n_lines,
   typedef struct linebuffer LBUFFER;
   LBUFFER *first, *last, *tmp;
   size_t total_lines = 0;	/* Total number of newlines in all buffers.  */
+  bool long_lines = false;	/* Line length heuristic for count_delims.  */
   bool ok = true;
   size_t n_read;		/* Size in bytes of most recent read */
 
@@ -653,15 +739,7 @@ pipe_lines (char const *pretty_filename, int fd, uintmax_t n_lines,
       tmp->next = NULL;
 
       /* Count the number of newlines just read.  */
-      {
-        char const *buffer_end = tmp->buffer + n_read;
-        char const *p = tmp->buffer;
-        while ((p = memchr (p, line_end, buffer_end - p)))
-          {
-            ++p;
-            ++tmp->nlines;
-          }
-      }
+      tmp->nlines = count_delims (tmp->buffer, n_read, line_end, &long_lines);
       total_lines += tmp->nlines;
 
       /* If there is enough room in the last buffer read, just append the new
@@ -729,13 +807,9 @@ pipe_lines (char const *pretty_filename, int fd, uintmax_t n_lines,
       {
         /* Skip 'total_lines' - 'n_lines' newlines.  We made sure that
            'total_lines' - 'n_lines' <= 'tmp->nlines'.  */
-        size_t j;
-        for (j = total_lines - n_lines; j; --j)
-          {
-            beg = memchr (beg, line_end, buffer_end - beg);
-            assert (beg);
-            ++beg;
-          }
+        uintmax_t j = total_lines - n_lines;
+        beg = skip_delims (beg, buffer_end - beg, line_end, &j);
+        assert (beg);
       }
 
     xwrite_stdout (beg, buffer_end - beg);
@@ -917,16 +991,12 @@ start_lines (char const *pretty_filename, int fd, uintmax_t n_lines,
 
       *read_pos += bytes_read;
 
-      char *p = buffer;
-      while ((p = memchr (p, line_end, buffer_end - p)))
+      char const *p = skip_delims (buffer, bytes_read, line_end, &n_lines);
+      if (p)
         {
-          ++p;
-          if (--n_lines == 0)
-            {
-              if (p < buffer_end)
-                xwrite_stdout (p, buffer_end - p);
-              return 0;
-            }
+          if (p < buffer_end)
+            xwrite_stdout (p, buffer_end - p);
+          return 0;
         }
     }
 }
@@ -974,6 +1044,46 @@ fremote (int fd, char const *name)
   return remote;
 }
 
+/* Open and cache a descriptor on the directory containing F->name,
+   recording the offset of the base name as a side effect.  Failure is
+   not fatal: F->parent_fd is left at -1 and recheck() falls back to
+   resolving the full path.  */
+
+static void
+open_parent_dir (struct File_spec *f)
+{
+  size_t dirlen = dir_len (f->name);
+  char prev = f->name[dirlen];
+  f->basename_start = last_component (f->name) - f->name;
+  f->name[dirlen] = '\0';
+  f->parent_fd = open (dirlen ? f->name : ".", O_RDONLY | O_DIRECTORY);
+  f->name[dirlen] = prev;
+}
+
+/* Open F->name with FLAGS for recheck(), resolving only its base name
+   against the cached parent directory descriptor when one is available.
+   When the cached directory no longer yields the name (e.g. it was
+   itself removed or replaced), refresh the cache and retry once, so a
+   recreated directory is picked up just as a full path walk would.  */
+
+static int
+recheck_open (struct File_spec *f, int flags)
+{
+  if (f->parent_fd < 0)
+    return open (f->name, flags);
+
+  int fd = openat (f->parent_fd, f->name + f->basename_start, flags);
+  if (fd < 0)
+    {
+      close (f->parent_fd);
+      open_parent_dir (f);
+      fd = (0 <= f->parent_fd
+            ? openat (f->parent_fd, f->name + f->basename_start, flags)
+            : open (f->name, flags));
+    }
+  return fd;
+}
+
 /* open/fstat F->name and handle changes.  */
 static void
 recheck (struct File_spec *f, bool blocking)
@@ -986,7 +1096,7 @@ recheck (struct File_spec *f, bool blocking)
   bool new_file;
   int fd = (is_stdin
             ? STDIN_FILENO
-            : open (f->name, O_RDONLY | (blocking ? 0 : O_NONBLOCK)));
+            : recheck_open (f, O_RDONLY | (blocking ? 0 : O_NONBLOCK)));
 
   assert (valid_file_spec (f));
 
@@ -994,7 +1104,11 @@ recheck (struct File_spec *f, bool blocking)
      then mark the file as not tailable.  */
   f->tailable = !(reopen_inaccessible_files && fd == -1);
 
-  if (! disable_inotify && ! lstat (f->name, &new_stats)
+  if (! disable_inotify
+      && ! (0 <= f->parent_fd
+            ? fstatat (f->parent_fd, f->name + f->basename_start,
+                       &new_stats, AT_SYMLINK_NOFOLLOW)
+            : lstat (f->name, &new_stats))
       && S_ISLNK (new_stats.st_mode))
     {
       /* Diagnose the edge case where a regular file is changed
@@ -1143,10 +1257,28 @@ any_live_files (const struct File_spec *f, size_t n_files)
   return false;
 }
 
+/* Cap on the number of poll intervals skipped between checks of an
+   idle file in tail_forever.  This bounds both the steady-state stat
+   rate for quiet files and the added latency once they change.  */
+enum { MAX_CHECK_BACKOFF = 8 };
+
+/* Double F's polling backoff, up to MAX_CHECK_BACKOFF, and schedule
+   its next check accordingly.  Called when a check found no change.  */
+
+static void
+backoff_check (struct File_spec *f)
+{
+  f->check_backoff = MIN (2 * f->check_backoff + 1,
+                          (size_t) MAX_CHECK_BACKOFF);
+  f->check_skip = f->check_backoff;
+}
+
 /* Tail N_FILES files forever, or until killed.
    The pertinent information for each file is stored in an entry of F.
    Loop over each of them, doing an fstat to see if they have changed size,
    and an occasional open/fstat to see if any dev/ino pair has changed.
+   Idle files are checked at adaptively longer intervals, so that many
+   quiet files cost few system calls per iteration.
    If none of them have changed size in one iteration, sleep for a
    while and try again.  Continue until the user interrupts us.  */
 
@@ -1161,6 +1293,12 @@ tail_forever (struct File_spec *f, size_t n_files, double sleep_interval)
 
   last = n_files - 1;
 
+  for (size_t i = 0; i < n_files; i++)
+    {
+      f[i].check_backoff = 0;
+      f[i].check_skip = 0;
+    }
+
   while (1)
     {
       size_t i;
@@ -1177,9 +1315,17 @@ tail_forever (struct File_spec *f, size_t n_files, double sleep_interval)
           if (f[i].ignore)
             continue;
 
+          if (f[i].check_skip)
+            {
+              f[i].check_skip--;
+              continue;
+            }
+
           if (f[i].fd < 0)
             {
               recheck (&f[i], blocking);
+              if (f[i].fd < 0)
+                backoff_check (&f[i]);
               continue;
             }
 
@@ -1225,6 +1371,7 @@ tail_forever (struct File_spec *f, size_t n_files, double sleep_interval)
                   && (! S_ISREG (stats.st_mode) || f[i].size == stats.st_size)
                   && timespec_cmp (f[i].mtime, get_stat_mtime (&stats)) == 0)
                 {
+                  backoff_check (&f[i]);
                   if ((max_n_unchanged_stats_between_opens
                        <= f[i].n_unchanged_stats++)
                       && follow_mode == Follow_name)
@@ -1241,8 +1388,9 @@ tail_forever (struct File_spec *f, size_t n_files, double sleep_interval)
               f[i].mtime = get_stat_mtime (&stats);
               f[i].mode = stats.st_mode;
 
-              /* reset counter */
+              /* reset counters */
               f[i].n_unchanged_stats = 0;
+              f[i].check_backoff = 0;
 
               /* XXX: This is only a heuristic, as the file may have also
                  been truncated and written to if st_size >= size
@@ -1397,7 +1545,9 @@ wd_comparator (const void *e1, const void *e2)
 }
 
 /* Output (new) data for FSPEC->fd.
-   PREV_FSPEC records the last File_spec for which we output.  */
+   PREV_FSPEC records the last File_spec for which we output.
+   Our caller is responsible for flushing stdout once it has
+   processed all files with pending events.  */
 static void
 check_fspec (struct File_spec *fspec, struct File_spec **prev_fspec)
 {
@@ -1439,10 +1589,21 @@ check_fspec (struct File_spec *fspec, struct File_spec **prev_fspec)
   fspec->size += bytes_read;
 
   if (bytes_read)
+    *prev_fspec = fspec;
+}
+
+/* If FSPEC has batched events whose data is yet to be output, output
+   it now and drop it from the N_DIRTY count.  Used before operations
+   that may close or replace FSPEC->fd.  */
+static void
+flush_dirty_fspec (struct File_spec *fspec, struct File_spec **prev_fspec,
+                   size_t *n_dirty)
+{
+  if (fspec->dirty)
     {
-      *prev_fspec = fspec;
-      if (fflush (stdout) != 0)
-        die (EXIT_FAILURE, errno, _("write error"));
+      fspec->dirty = false;
+      (*n_dirty)--;
+      check_fspec (fspec, prev_fspec);
     }
 }
 
@@ -1474,6 +1635,10 @@ tail_forever_inotify (int wd, struct File_spec *f, size_t n_files,
   size_t evbuf_off = 0;
   size_t len = 0;
 
+  /* Number of files with events seen in the current batch whose new
+     data has not been output yet.  */
+  size_t n_dirty = 0;
+
   wd_to_name = hash_initialize (n_files, NULL, wd_hasher, wd_comparator, NULL);
   if (! wd_to_name)
     xalloc_die ();
@@ -1491,6 +1656,8 @@ tail_forever_inotify (int wd, struct File_spec *f, size_t n_files,
   size_t i;
   for (i = 0; i < n_files; i++)
     {
+      f[i].dirty = false;
+
       if (!f[i].ignore)
         {
           size_t fnlen = strlen (f[i].name);
@@ -1606,6 +1773,9 @@ tail_forever_inotify (int wd, struct File_spec *f, size_t n_files,
         }
     }
 
+  if (fflush (stdout) != 0)
+    die (EXIT_FAILURE, errno, _("write error"));
+
   evlen += sizeof (struct inotify_event) + 1;
   evbuf = xmalloc (evlen);
 
@@ -1629,6 +1799,25 @@ tail_forever_inotify (int wd, struct File_spec *f, size_t n_files,
           return false;
         }
 
+      /* All queued events have been processed; now output the new
+         data once per modified file rather than once per event, and
+         flush it before possibly blocking below.  With many actively
+         written files this coalescing is what keeps the CPU cost
+         proportional to the data rather than to the event count.  */
+      if (n_dirty && len <= evbuf_off)
+        {
+          for (i = 0; n_dirty && i < n_files; i++)
+            if (f[i].dirty)
+              {
+                f[i].dirty = false;
+                n_dirty--;
+                check_fspec (&f[i], &prev_fspec);
+              }
+
+          if (fflush (stdout) != 0)
+            die (EXIT_FAILURE, errno, _("write error"));
+        }
+
       /* When watching a PID, ensure that a read from WD will not block
          indefinitely.  */
       while (len <= evbuf_off)
@@ -1693,6 +1882,8 @@ tail_forever_inotify (int wd, struct File_spec *f, size_t n_files,
 
           if (len == 0 || len == SAFE_READ_ERROR)
             die (EXIT_FAILURE, errno, _("error reading inotify event"));
+
+          COREUTILS_PROBE1 (tail_inotify_wakeup, len);
         }
 
       void_ev = evbuf + evbuf_off;
@@ -1785,6 +1976,7 @@ tail_forever_inotify (int wd, struct File_spec *f, size_t n_files,
               struct File_spec *prev = hash_remove (wd_to_name, fspec);
               if (prev && prev != fspec)
                 {
+                  flush_dirty_fspec (prev, &prev_fspec, &n_dirty);
                   if (follow_mode == Follow_name)
                     recheck (prev, false);
                   prev->wd = -1;
@@ -1796,7 +1988,10 @@ tail_forever_inotify (int wd, struct File_spec *f, size_t n_files,
             }
 
           if (follow_mode == Follow_name)
-            recheck (fspec, false);
+            {
+              flush_dirty_fspec (fspec, &prev_fspec, &n_dirty);
+              recheck (fspec, false);
+            }
         }
       else
         {
@@ -1810,6 +2005,10 @@ tail_forever_inotify (int wd, struct File_spec *f, size_t n_files,
 
       if (ev->mask & (IN_ATTRIB | IN_DELETE | IN_DELETE_SELF | IN_MOVE_SELF))
         {
+          /* Output any data batched for this file before recheck()
+             below possibly closes or replaces its descriptor.  */
+          flush_dirty_fspec (fspec, &prev_fspec, &n_dirty);
+
           /* Note for IN_MOVE_SELF (the file we're watching has
              been clobbered via a rename) we leave the watch
              in place since it may still be part of the set
@@ -1832,7 +2031,15 @@ tail_forever_inotify (int wd, struct File_spec *f, size_t n_files,
 
           continue;
         }
-      check_fspec (fspec, &prev_fspec);
+
+      /* Just mark the file; it is checked once the batch is drained,
+         so that a burst of events costs one fstat and dump, not one
+         per event.  */
+      if (! fspec->dirty)
+        {
+          fspec->dirty = true;
+          n_dirty++;
+        }
     }
 }
 #endif
@@ -2355,6 +2562,8 @@ main (int argc, char **argv)
 
   atexit (close_stdout);
 
+  stdbuf_policy_apply_stdout ();
+
   have_read_stdin = false;
 
   count_lines = true;
@@ -2423,7 +2632,12 @@ main (int argc, char **argv)
 
   F = xnmalloc (n_files, sizeof *F);
   for (i = 0; i < n_files; i++)
-    F[i].name = file[i];
+    {
+      F[i].name = file[i];
+      F[i].parent_fd = -1;
+      if (forever && follow_mode == Follow_name && ! STREQ (file[i], "-"))
+        open_parent_dir (&F[i]);
+    }
 
   if (header_mode == always
       || (header_mode == multiple_files && n_files > 1))
@@ -20,6 +20,7 @@
 #include <sys/types.h>
 #include <signal.h>
 #include <getopt.h>
+#include <pthread.h>
 
 #include "system.h"
 #include "argmatch.h"
@@ -28,6 +29,7 @@
 #include "fadvise.h"
 #include "stdio--.h"
 #include "xbinary-io.h"
+#include "xdectoint.h"
 
 /* The official name of this program (e.g., no 'g' prefix).  */
 #define PROGRAM_NAME "tee"
@@ -38,6 +40,7 @@
   proper_name ("David MacKenzie")
 
 static bool tee_files (int nfiles, char **files);
+static bool tee_files_buffered (int nfiles, char **files);
 
 /* If true, append to output files rather than truncating them. */
 static bool append;
@@ -56,9 +59,31 @@ enum output_error
 
 static enum output_error output_error;
 
+/* With --buffer-size, the capacity of each output's buffer, drained
+   by a thread per output; 0 for the default mode, where each input
+   block is written to every output in turn.  */
+static size_t buffer_size;
+
+enum buffer_full
+  {
+    buffer_full_block,         /* wait until the buffer drains.  */
+    buffer_full_drop           /* discard data not fitting the buffer.  */
+  };
+
+/* With --buffer-size, what to do when an output's buffer is full.  */
+static enum buffer_full buffer_full = buffer_full_block;
+
+enum
+{
+  BUFFER_FULL_OPTION = CHAR_MAX + 1,
+  BUFFER_SIZE_OPTION
+};
+
 static struct option const long_options[] =
 {
   {"append", no_argument, NULL, 'a'},
+  {"buffer-full", required_argument, NULL, BUFFER_FULL_OPTION},
+  {"buffer-size", required_argument, NULL, BUFFER_SIZE_OPTION},
   {"ignore-interrupts", no_argument, NULL, 'i'},
   {"output-error", optional_argument, NULL, 'p'},
   {GETOPT_HELP_OPTION_DECL},
@@ -77,6 +102,16 @@ static enum output_error const output_error_types[] =
 };
 ARGMATCH_VERIFY (output_error_args, output_error_types);
 
+static char const *const buffer_full_args[] =
+{
+  "block", "drop", NULL
+};
+static enum buffer_full const buffer_full_types[] =
+{
+  buffer_full_block, buffer_full_drop
+};
+ARGMATCH_VERIFY (buffer_full_args, buffer_full_types);
+
 void
 usage (int status)
 {
@@ -90,6 +125,13 @@ Copy standard input to each FILE, and also to standard output.\n\
 \n\
   -a, --append              append to the given FILEs, do not overwrite\n\
   -i, --ignore-interrupts   ignore interrupt signals\n\
+"), stdout);
+      fputs (_("\
+      --buffer-size=SIZE    buffer each output independently, with a\n\
+                              SIZE-byte buffer drained by its own thread\n\
+      --buffer-full=POLICY  with --buffer-size, what to do when an\n\
+                              output's buffer fills: 'block' (the default)\n\
+                              or 'drop'.  See POLICY below\n\
 "), stdout);
       fputs (_("\
   -p                        diagnose errors writing to non pipes\n\
@@ -108,6 +150,13 @@ The default MODE for the -p option is 'warn-nopipe'.\n\
 The default operation when --output-error is not specified, is to\n\
 exit immediately on error writing to a pipe, and diagnose errors\n\
 writing to non pipe outputs.\n\
+\n\
+With --buffer-size, one slow output no longer stalls the others:\n\
+each output is written by its own thread from its own buffer.\n\
+POLICY determines behavior when an output's buffer is full:\n\
+  'block'        wait until it drains; all outputs receive all data\n\
+  'drop'         discard data not fitting, so the other outputs\n\
+                 proceed at full speed; drops are reported at exit\n\
 "), stdout);
       emit_ancillary_info (PROGRAM_NAME);
     }
@@ -151,6 +200,16 @@ main (int argc, char **argv)
             output_error = output_error_warn_nopipe;
           break;
 
+        case BUFFER_FULL_OPTION:
+          buffer_full = XARGMATCH ("--buffer-full", optarg,
+                                   buffer_full_args, buffer_full_types);
+          break;
+
+        case BUFFER_SIZE_OPTION:
+          buffer_size = xdectoumax (optarg, BUFSIZ, SIZE_MAX, "EGkKMmPTYZ0",
+                                    _("invalid buffer size"), 0);
+          break;
+
         case_GETOPT_HELP_CHAR;
 
         case_GETOPT_VERSION_CHAR (PROGRAM_NAME, AUTHORS);
@@ -169,13 +228,167 @@ main (int argc, char **argv)
   /* Do *not* warn if tee is given no file arguments.
      POSIX requires that it work when given no arguments.  */
 
-  ok = tee_files (argc - optind, &argv[optind]);
+  ok = (buffer_size
+        ? tee_files_buffered (argc - optind, &argv[optind])
+        : tee_files (argc - optind, &argv[optind]));
   if (close (STDIN_FILENO) != 0)
     die (EXIT_FAILURE, errno, "%s", _("standard input"));
 
   return ok ? EXIT_SUCCESS : EXIT_FAILURE;
 }
 
+#ifdef SPLICE_F_MOVE
+/* Attempt to copy the input pipe to the outputs without the data
+   leaving the kernel: tee(2) duplicates the input's pages into each
+   output pipe, and splice(2) consumes them into a designated sink
+   output.  DESCRIPTORS and FILES are as in tee_files, with N_OUTPUTS
+   descriptors open.  Called only in the default --output-error mode,
+   whose handling of a closed pipe (dying of SIGPIPE) applies here as
+   in the serial loop.  Return false, without transferring anything,
+   to let the caller run the serial loop instead; otherwise transfer
+   everything and return true.
+
+   An output with a full pipe cannot be duplicated to in parts, so
+   AHEAD tracks per output how much of the yet unconsumed input it
+   already holds; only the minimum over all outputs is consumed, and
+   tee always continues each output from the head of what remains.  */
+
+static bool
+tee_files_zero_copy (int nfiles, char **files, FILE **descriptors,
+                     size_t n_outputs)
+{
+  enum { ZERO_COPY_CHUNK = 16 * 1024 * 1024 };
+  struct stat st;
+  int sink = -1;
+  int i;
+
+  if (fstat (STDIN_FILENO, &st) != 0 || ! S_ISFIFO (st.st_mode))
+    return false;
+
+  /* All outputs must be pipes, except that one regular file may be
+     the sink, as splice only needs the input side to be a pipe.
+     (Splicing to a file opened with O_APPEND is not supported.)  */
+  int last_pipe = -1;
+  int nonpipe = -1;
+  for (i = 0; i <= nfiles; i++)
+    {
+      if (! descriptors[i])
+        continue;
+      if (fstat (fileno (descriptors[i]), &st) != 0)
+        return false;
+      if (S_ISFIFO (st.st_mode))
+        last_pipe = i;
+      else if (S_ISREG (st.st_mode) && ! append && nonpipe < 0)
+        nonpipe = i;
+      else
+        return false;
+    }
+  sink = 0 <= nonpipe ? nonpipe : last_pipe;
+  if (sink < 0)
+    return false;
+
+  size_t *ahead = xcalloc (nfiles + 1, sizeof *ahead);
+  int discard_fd = -1;          /* Consumes input once the sink dies.  */
+  bool transferred = false;
+  bool done = false;
+
+  while (! done && n_outputs)
+    {
+      /* Duplicate the head of the unconsumed input into each
+         non-sink output that holds none of it yet.  */
+      size_t consume = SIZE_MAX;
+      for (i = 0; i <= nfiles && ! done; i++)
+        {
+          if (! descriptors[i] || i == sink)
+            continue;
+          while (ahead[i] == 0)
+            {
+              ssize_t t = tee (STDIN_FILENO, fileno (descriptors[i]),
+                               ZERO_COPY_CHUNK, 0);
+              if (t < 0 && errno == EINTR)
+                continue;
+              if (t == 0)
+                {
+                  /* EOF; nothing unconsumed remains in the pipe.  */
+                  done = true;
+                  break;
+                }
+              if (t < 0 && errno == EPIPE)
+                {
+                  /* As in the serial loop: give up on this output.  */
+                  descriptors[i] = NULL;
+                  n_outputs--;
+                  break;
+                }
+              if (t < 0)
+                {
+                  if (! transferred)
+                    {
+                      free (ahead);
+                      return false;
+                    }
+                  die (EXIT_FAILURE, errno, "%s", quotef (files[i]));
+                }
+              ahead[i] = t;
+              transferred = true;
+            }
+          if (ahead[i])
+            consume = MIN (consume, ahead[i]);
+        }
+      if (done || ! n_outputs)
+        break;
+      if (consume == SIZE_MAX)
+        consume = ZERO_COPY_CHUNK;        /* Only the sink remains.  */
+
+      /* Consume exactly the duplicated bytes, into the sink if it is
+         still alive.  */
+      while (consume)
+        {
+          int fd = 0 <= sink ? fileno (descriptors[sink]) : discard_fd;
+          ssize_t s = splice (STDIN_FILENO, NULL, fd, NULL, consume,
+                              SPLICE_F_MOVE);
+          if (s < 0 && errno == EINTR)
+            continue;
+          if (s == 0)
+            {
+              done = true;
+              break;
+            }
+          if (s < 0 && errno == EPIPE && 0 <= sink)
+            {
+              descriptors[sink] = NULL;
+              n_outputs--;
+              sink = -1;
+              discard_fd = open ("/dev/null", O_WRONLY);
+              if (discard_fd < 0)
+                die (EXIT_FAILURE, errno, "%s", quotef ("/dev/null"));
+              continue;
+            }
+          if (s < 0)
+            {
+              if (! transferred)
+                {
+                  free (ahead);
+                  return false;
+                }
+              die (EXIT_FAILURE, errno, "%s",
+                   quotef (0 <= sink ? files[sink] : "/dev/null"));
+            }
+          transferred = true;
+          for (i = 0; i <= nfiles; i++)
+            if (descriptors[i] && i != sink)
+              ahead[i] -= s;
+          consume -= s;
+        }
+    }
+
+  if (0 <= discard_fd)
+    close (discard_fd);
+  free (ahead);
+  return true;
+}
+#endif
+
 /* Copy the standard input into each of the NFILES files in FILES
    and into the standard output.  As a side effect, modify FILES[-1].
    Return true if successful.  */
@@ -226,7 +439,16 @@ tee_files (int nfiles, char **files)
         }
     }
 
-  while (n_outputs)
+  bool zero_copied = false;
+#ifdef SPLICE_F_MOVE
+  /* With a pipe as input and pipes as outputs, fan the data out in
+     the kernel, duplicating pages instead of copying bytes.  */
+  if (output_error == output_error_sigpipe && n_outputs)
+    zero_copied = tee_files_zero_copy (nfiles, files, descriptors,
+                                       n_outputs);
+#endif
+
+  while (! zero_copied && n_outputs)
     {
       bytes_read = read (STDIN_FILENO, buffer, sizeof buffer);
       if (bytes_read < 0 && errno == EINTR)
@@ -276,3 +498,235 @@ tee_files (int nfiles, char **files)
 
   return ok;
 }
+
+/* One output of the buffered mode (--buffer-size).  A thread per
+   output drains a private ring buffer, so a slow output does not
+   stall the others or the input.  The main thread appends under the
+   lock; the writer thread removes, unlocking around the actual write
+   so a blocked write does not block the producer.  */
+
+struct buffered_output
+{
+  FILE *fp;                     /* NULL if not open, or given up on.  */
+  char const *name;
+  char *buf;                    /* Ring of buffer_size bytes, or NULL.  */
+  size_t start;                 /* Offset of the oldest byte.  */
+  size_t used;                  /* Bytes in the buffer.  */
+  bool eof;                     /* No more data will be appended.  */
+  bool failed;                  /* The writer thread gave up.  */
+  int err;                      /* errno of the failed write.  */
+  uintmax_t dropped;            /* Bytes discarded with
+                                   --buffer-full=drop.  */
+  pthread_mutex_t lock;
+  pthread_cond_t change;        /* Signaled on any state change.  */
+  pthread_t thread;
+};
+
+static void *
+buffered_output_thread (void *arg)
+{
+  struct buffered_output *o = arg;
+
+  pthread_mutex_lock (&o->lock);
+  while (true)
+    {
+      while (o->used == 0 && ! o->eof)
+        pthread_cond_wait (&o->change, &o->lock);
+      if (o->used == 0)
+        break;
+
+      /* Write the longest contiguous run without holding the lock;
+         the producer only appends beyond START + USED.  */
+      char const *p = o->buf + o->start;
+      size_t n = MIN (o->used, buffer_size - o->start);
+      pthread_mutex_unlock (&o->lock);
+      bool write_ok = fwrite (p, 1, n, o->fp) == n;
+      int write_errno = errno;
+      pthread_mutex_lock (&o->lock);
+
+      if (! write_ok)
+        {
+          o->failed = true;
+          o->err = write_errno;
+          o->used = 0;
+          break;
+        }
+      o->start = (o->start + n) % buffer_size;
+      o->used -= n;
+      pthread_cond_signal (&o->change);
+    }
+  pthread_cond_signal (&o->change);
+  pthread_mutex_unlock (&o->lock);
+  return NULL;
+}
+
+/* Append the BYTES_READ bytes in BUFFER to O, which fit an empty
+   buffer as buffer_size is at least BUFSIZ.  Return true while O
+   accepts data.  */
+
+static bool
+buffered_output_append (struct buffered_output *o, char const *buffer,
+                        size_t bytes_read)
+{
+  bool alive = true;
+
+  pthread_mutex_lock (&o->lock);
+  if (buffer_full == buffer_full_drop && ! o->failed
+      && buffer_size - o->used < bytes_read)
+    o->dropped += bytes_read;
+  else
+    {
+      while (! o->failed && buffer_size - o->used < bytes_read)
+        pthread_cond_wait (&o->change, &o->lock);
+      if (o->failed)
+        alive = false;
+      else
+        {
+          size_t at = (o->start + o->used) % buffer_size;
+          size_t n = MIN (bytes_read, buffer_size - at);
+          memcpy (o->buf + at, buffer, n);
+          memcpy (o->buf, buffer + n, bytes_read - n);
+          o->used += bytes_read;
+          pthread_cond_signal (&o->change);
+        }
+    }
+  pthread_mutex_unlock (&o->lock);
+  return alive;
+}
+
+/* Report the failed output O as the serial code would, and stop
+   writing to it.  Return true if the failure counts as an error.  */
+
+static bool
+buffered_output_error (struct buffered_output *o)
+{
+  bool fail = o->err != EPIPE || (output_error == output_error_exit
+                                  || output_error == output_error_warn);
+  if (o->fp == stdout)
+    clearerr (stdout);          /* Avoid redundant close_stdout diagnostic.  */
+  if (fail)
+    {
+      error (output_error == output_error_exit
+             || output_error == output_error_exit_nopipe,
+             o->err, "%s", quotef (o->name));
+    }
+  o->fp = NULL;
+  return fail;
+}
+
+/* As tee_files, but each output has its own writer thread and a
+   buffer_size-byte buffer between it and the input (--buffer-size).
+   As a side effect, modify FILES[-1].  Return true if successful.  */
+
+static bool
+tee_files_buffered (int nfiles, char **files)
+{
+  size_t n_outputs = 0;
+  struct buffered_output *outputs;
+  char buffer[BUFSIZ];
+  ssize_t bytes_read = 0;
+  int i;
+  bool ok = true;
+  char const *mode_string =
+    (O_BINARY
+     ? (append ? "ab" : "wb")
+     : (append ? "a" : "w"));
+
+  xset_binary_mode (STDIN_FILENO, O_BINARY);
+  xset_binary_mode (STDOUT_FILENO, O_BINARY);
+  fadvise (stdin, FADVISE_SEQUENTIAL);
+
+  /* Set up FILES[0 .. NFILES] and OUTPUTS[0 .. NFILES].
+     In both arrays, entry 0 corresponds to standard output.  */
+
+  outputs = xnmalloc (nfiles + 1, sizeof *outputs);
+  files--;
+  files[0] = bad_cast (_("standard output"));
+
+  for (i = 0; i <= nfiles; i++)
+    {
+      struct buffered_output *o = &outputs[i];
+
+      /* Do not treat "-" specially - as mandated by POSIX.  */
+      o->fp = i == 0 ? stdout : fopen (files[i], mode_string);
+      o->name = files[i];
+      o->buf = NULL;
+      if (o->fp == NULL)
+        {
+          error (output_error == output_error_exit
+                 || output_error == output_error_exit_nopipe,
+                 errno, "%s", quotef (files[i]));
+          ok = false;
+          continue;
+        }
+      setvbuf (o->fp, NULL, _IONBF, 0);
+      o->buf = xmalloc (buffer_size);
+      o->start = o->used = 0;
+      o->eof = o->failed = false;
+      o->err = 0;
+      o->dropped = 0;
+      pthread_mutex_init (&o->lock, NULL);
+      pthread_cond_init (&o->change, NULL);
+      int err = pthread_create (&o->thread, NULL, buffered_output_thread, o);
+      if (err)
+        die (EXIT_FAILURE, err, _("cannot create thread"));
+      n_outputs++;
+    }
+
+  while (n_outputs)
+    {
+      bytes_read = read (STDIN_FILENO, buffer, sizeof buffer);
+      if (bytes_read < 0 && errno == EINTR)
+        continue;
+      if (bytes_read <= 0)
+        break;
+
+      for (i = 0; i <= nfiles; i++)
+        if (outputs[i].fp
+            && ! buffered_output_append (&outputs[i], buffer, bytes_read))
+          {
+            if (buffered_output_error (&outputs[i]))
+              ok = false;
+            n_outputs--;
+          }
+    }
+
+  if (bytes_read == -1)
+    {
+      error (0, errno, _("read error"));
+      ok = false;
+    }
+
+  /* Wake the writers, wait for them to drain, and report failures
+     not yet observed and any dropped data.  */
+  for (i = 0; i <= nfiles; i++)
+    if (outputs[i].buf)
+      {
+        struct buffered_output *o = &outputs[i];
+
+        pthread_mutex_lock (&o->lock);
+        o->eof = true;
+        pthread_cond_signal (&o->change);
+        pthread_mutex_unlock (&o->lock);
+        pthread_join (o->thread, NULL);
+
+        if (o->failed && o->fp && buffered_output_error (o))
+          ok = false;
+        if (o->dropped)
+          error (0, 0, _("%s: %" PRIuMAX " bytes dropped"),
+                 quotef (o->name), o->dropped);
+        free (o->buf);
+      }
+
+  /* Close the files, but not standard output.  */
+  for (i = 1; i <= nfiles; i++)
+    if (outputs[i].fp && fclose (outputs[i].fp) != 0)
+      {
+        error (0, errno, "%s", quotef (files[i]));
+        ok = false;
+      }
+
+  free (outputs);
+
+  return ok;
+}
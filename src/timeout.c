@@ -53,6 +53,9 @@
 # include <sys/prctl.h>
 #endif
 #include <sys/wait.h>
+#if HAVE_PIDFD_OPEN && HAVE_PIDFD_SEND_SIGNAL
+# include <sys/pidfd.h>
+#endif
 
 #include "system.h"
 #include "cl-strtod.h"
@@ -80,6 +83,7 @@
 static int timed_out;
 static int term_signal = SIGTERM;  /* same default as kill command.  */
 static pid_t monitored_pid;
+static int monitored_pidfd = -1;  /* stable reference to MONITORED_PID.  */
 static double kill_after;
 static bool foreground;      /* whether to use another program group.  */
 static bool preserve_status; /* whether to use a timeout status or not.  */
@@ -192,6 +196,25 @@ send_sig (pid_t where, int sig)
   return kill (where, sig);
 }
 
+/* Send SIG directly to the monitored command through its pidfd, which
+   cannot be misdirected by PID reuse.  Return 0 if the signal was
+   delivered or the process is already gone, and -1 if pidfd signaling
+   is unavailable so the caller must fall back to kill().  Note this is
+   called from signal handlers; pidfd_send_signal is a bare syscall and
+   so async-signal-safe.  */
+
+static int
+send_sig_pidfd (int sig)
+{
+#if HAVE_PIDFD_OPEN && HAVE_PIDFD_SEND_SIGNAL
+  if (0 <= monitored_pidfd
+      && (pidfd_send_signal (monitored_pidfd, sig, NULL, 0) == 0
+          || errno == ESRCH))
+    return 0;
+#endif
+  return -1;
+}
+
 /* Signal handler which is required for sigsuspend() to be interrupted
    whenever SIGCHLD is received.  */
 static void
@@ -222,7 +245,9 @@ cleanup (int sig)
 
       /* Send the signal directly to the monitored child,
          in case it has itself become group leader,
-         or is not running in a separate group.  */
+         or is not running in a separate group.
+         Prefer the pidfd, so the signal cannot land on an unrelated
+         process that reused the PID.  */
       if (verbose)
         {
           char signame[MAX (SIG2STR_MAX, INT_BUFSIZE_BOUND (int))];
@@ -231,7 +256,8 @@ cleanup (int sig)
           error (0, 0, _("sending signal %s to command %s"),
                  signame, quote (command));
         }
-      send_sig (monitored_pid, sig);
+      if (send_sig_pidfd (sig) != 0)
+        send_sig (monitored_pid, sig);
 
       /* The normal case is the job has remained in our
          newly created process group, so send to all processes in that.  */
@@ -240,7 +266,8 @@ cleanup (int sig)
           send_sig (0, sig);
           if (sig != SIGKILL && sig != SIGCONT)
             {
-              send_sig (monitored_pid, SIGCONT);
+              if (send_sig_pidfd (SIGCONT) != 0)
+                send_sig (monitored_pid, SIGCONT);
               send_sig (0, SIGCONT);
             }
         }
@@ -557,6 +584,13 @@ main (int argc, char **argv)
       pid_t wait_result;
       int status;
 
+#if HAVE_PIDFD_OPEN && HAVE_PIDFD_SEND_SIGNAL
+      /* Take a stable reference to the child before any timer can
+         fire.  The child is not reaped until the waitpid() below, so
+         the PID cannot have been recycled yet.  */
+      monitored_pidfd = pidfd_open (monitored_pid, 0);
+#endif
+
       /* We configure timers so that SIGALRM is sent on expiry.
          Therefore ensure we don't inherit a mask blocking SIGALRM.  */
       unblock_signal (SIGALRM);
@@ -28,12 +28,15 @@
 #include "die.h"
 #include "error.h"
 #include "fd-reopen.h"
+#include "meta-pool.h"
 #include "parse-datetime.h"
 #include "posixtm.h"
 #include "posixver.h"
 #include "quote.h"
 #include "stat-time.h"
 #include "utimens.h"
+#include "xdectoint.h"
+#include "xfts.h"
 
 /* The official name of this program (e.g., no 'g' prefix).  */
 #define PROGRAM_NAME "touch"
@@ -74,11 +77,21 @@ static struct timespec newtime[2];
 /* File to use for -r. */
 static char *ref_file;
 
+/* (-R) If true, change the times of directory contents recursively.  */
+static bool recursive;
+
+/* Maximum number of worker threads issuing the time changes.  */
+static size_t nthreads = 1;
+
+/* The pool applying queued time changes, when multithreaded.  */
+static struct meta_pool *pool;
+
 /* For long options that have no equivalent short option, use a
    non-character as a pseudo short option, starting with CHAR_MAX + 1.  */
 enum
 {
-  TIME_OPTION = CHAR_MAX + 1
+  TIME_OPTION = CHAR_MAX + 1,
+  THREADS_OPTION
 };
 
 static struct option const longopts[] =
@@ -86,8 +99,10 @@ static struct option const longopts[] =
   {"time", required_argument, NULL, TIME_OPTION},
   {"no-create", no_argument, NULL, 'c'},
   {"date", required_argument, NULL, 'd'},
+  {"recursive", no_argument, NULL, 'R'},
   {"reference", required_argument, NULL, 'r'},
   {"no-dereference", no_argument, NULL, 'h'},
+  {"threads", required_argument, NULL, THREADS_OPTION},
   {GETOPT_HELP_OPTION_DECL},
   {GETOPT_VERSION_OPTION_DECL},
   {NULL, 0, NULL, 0}
@@ -143,18 +158,6 @@ touch (char const *file)
         open_errno = errno;
     }
 
-  if (change_times != (CH_ATIME | CH_MTIME))
-    {
-      /* We're setting only one of the time values.  */
-      if (change_times == CH_MTIME)
-        newtime[0].tv_nsec = UTIME_OMIT;
-      else
-        {
-          assert (change_times == CH_ATIME);
-          newtime[1].tv_nsec = UTIME_OMIT;
-        }
-    }
-
   if (amtime_now)
     {
       /* Pass NULL to futimens so it will not fail if we have
@@ -203,6 +206,151 @@ touch (char const *file)
   return true;
 }
 
+/* Update the times of FILE, relative to DIR_FD, diagnosing failures
+   against FILE_FULL_NAME.  This is the --recursive analogue of touch:
+   it never creates missing files.  Return true if successful.  */
+
+static bool
+touch_entry (int dir_fd, char const *file, char const *file_full_name)
+{
+  struct timespec const *t = amtime_now ? NULL : newtime;
+  int atflag = no_dereference ? AT_SYMLINK_NOFOLLOW : 0;
+
+  if (utimensat (dir_fd, file, t, atflag) != 0)
+    {
+      if (no_create && errno == ENOENT)
+        return true;
+      error (0, errno, _("setting times of %s"), quoteaf (file_full_name));
+      return false;
+    }
+
+  return true;
+}
+
+static void
+touch_apply (struct meta_job *job, void *tool_data)
+{
+  struct timespec const *t = amtime_now ? NULL : newtime;
+  int atflag = no_dereference ? AT_SYMLINK_NOFOLLOW : 0;
+
+  if (utimensat (job->dir_fd, job->file, t, atflag) != 0)
+    job->err = errno;
+  else
+    job->err = -1;
+}
+
+static bool
+touch_report (struct meta_job *job, void *tool_data)
+{
+  if (job->err < 0)
+    return true;
+  if (no_create && job->err == ENOENT)
+    return true;
+  error (0, job->err, _("setting times of %s"),
+         quoteaf (job->file_full_name));
+  return false;
+}
+
+/* Update the times of every file in the hierarchies rooted at the
+   NULL-terminated operand list FILES.  Return true if successful.  */
+
+static bool
+touch_recursive (char **files)
+{
+  bool ok = true;
+
+  if (1 < nthreads)
+    pool = meta_pool_start (nthreads, touch_apply, touch_report, NULL);
+
+  FTS *fts = xfts_open (files, FTS_PHYSICAL | FTS_NOSTAT, NULL);
+
+  while (1)
+    {
+      FTSENT *ent = fts_read (fts);
+      if (ent == NULL)
+        {
+          if (errno != 0)
+            {
+              error (0, errno, _("fts_read failed"));
+              ok = false;
+            }
+          break;
+        }
+
+      /* Queued changes name files relative to the walk's current
+         directory, so complete them before the walk moves on to
+         another one.  */
+      if (pool
+          && (ent->fts_info == FTS_D || ent->fts_info == FTS_DP
+              || ent->fts_info == FTS_DC || ent->fts_info == FTS_DNR
+              || ent->fts_info == FTS_ERR))
+        ok &= meta_pool_drain (pool);
+
+      switch (ent->fts_info)
+        {
+        case FTS_D:
+          /* Touch directories postorder: reading their entries would
+             otherwise dirty the access time just set.  */
+          break;
+
+        case FTS_DP:
+          ok &= touch_entry (fts->fts_cwd_fd, ent->fts_accpath,
+                             ent->fts_path);
+          break;
+
+        case FTS_DC:		/* directory that causes cycles */
+          if (cycle_warning_required (fts, ent))
+            {
+              emit_cycle_warning (ent->fts_path);
+              ok = false;
+            }
+          break;
+
+        case FTS_NS:
+          if (no_create && ent->fts_errno == ENOENT)
+            break;
+          error (0, ent->fts_errno, _("cannot touch %s"),
+                 quoteaf (ent->fts_path));
+          ok = false;
+          break;
+
+        case FTS_ERR:
+          error (0, ent->fts_errno, "%s", quotef (ent->fts_path));
+          ok = false;
+          break;
+
+        case FTS_DNR:
+          error (0, ent->fts_errno, _("cannot read directory %s"),
+                 quoteaf (ent->fts_path));
+          ok = false;
+          break;
+
+        default:
+          if (pool)
+            meta_pool_submit (pool, fts->fts_cwd_fd, ent->fts_accpath,
+                              ent->fts_path, NULL, 0);
+          else
+            ok &= touch_entry (fts->fts_cwd_fd, ent->fts_accpath,
+                               ent->fts_path);
+          break;
+        }
+    }
+
+  if (pool)
+    {
+      ok &= meta_pool_finish (pool);
+      pool = NULL;
+    }
+
+  if (fts_close (fts) != 0)
+    {
+      error (0, errno, _("fts_close failed"));
+      ok = false;
+    }
+
+  return ok;
+}
+
 void
 usage (int status)
 {
@@ -236,8 +384,11 @@ change the times of the file associated with standard output.\n\
   -m                     change only the modification time\n\
 "), stdout);
       fputs (_("\
+  -R, --recursive        change the times of files and directories\n\
+                         recursively; do not create missing operands\n\
   -r, --reference=FILE   use this file's times instead of current time\n\
   -t STAMP               use [[CC]YY]MMDDhhmm[.ss] instead of current time\n\
+      --threads=N        with -R, issue the time changes with up to N threads\n\
       --time=WORD        change the specified time:\n\
                            WORD is access, atime, or use: equivalent to -a\n\
                            WORD is modify or mtime: equivalent to -m\n\
@@ -272,7 +423,7 @@ main (int argc, char **argv)
   change_times = 0;
   no_create = use_ref = false;
 
-  while ((c = getopt_long (argc, argv, "acd:fhmr:t:", longopts, NULL)) != -1)
+  while ((c = getopt_long (argc, argv, "acd:fhmRr:t:", longopts, NULL)) != -1)
     {
       switch (c)
         {
@@ -299,6 +450,10 @@ main (int argc, char **argv)
           change_times |= CH_MTIME;
           break;
 
+        case 'R':
+          recursive = true;
+          break;
+
         case 'r':
           use_ref = true;
           ref_file = optarg;
@@ -319,6 +474,11 @@ main (int argc, char **argv)
                                      time_args, time_masks);
           break;
 
+        case THREADS_OPTION:
+          nthreads = xdectoumax (optarg, 1, SIZE_MAX, "",
+                                 _("invalid number of threads"), 0);
+          break;
+
         case_GETOPT_HELP_CHAR;
 
         case_GETOPT_VERSION_CHAR (PROGRAM_NAME, AUTHORS);
@@ -425,14 +585,29 @@ main (int argc, char **argv)
         newtime[1].tv_nsec = newtime[0].tv_nsec = UTIME_NOW;
     }
 
+  if (change_times != (CH_ATIME | CH_MTIME))
+    {
+      /* We're setting only one of the time values.  */
+      if (change_times == CH_MTIME)
+        newtime[0].tv_nsec = UTIME_OMIT;
+      else
+        {
+          assert (change_times == CH_ATIME);
+          newtime[1].tv_nsec = UTIME_OMIT;
+        }
+    }
+
   if (optind == argc)
     {
       error (0, 0, _("missing file operand"));
       usage (EXIT_FAILURE);
     }
 
-  for (; optind < argc; ++optind)
-    ok &= touch (argv[optind]);
+  if (recursive)
+    ok = touch_recursive (argv + optind);
+  else
+    for (; optind < argc; ++optind)
+      ok &= touch (argv[optind]);
 
   return ok ? EXIT_SUCCESS : EXIT_FAILURE;
 }
@@ -241,7 +241,9 @@ static bool truncate_set1 = false;
    It is set in main and used there and in validate().  */
 static bool translating;
 
-static char io_buf[BUFSIZ];
+/* Use a buffer much larger than BUFSIZ, as the per-byte work below is
+   cheap enough for the read system calls to show in profiles.  */
+static char io_buf[64 * 1024];
 
 static char const *const char_class_name[] =
 {
@@ -261,6 +263,10 @@ static bool in_squeeze_set[N_CHARS];
    command line when the delete option is given.  */
 static bool in_delete_set[N_CHARS];
 
+/* If the delete set has exactly one member, that character; otherwise
+   -1.  Computed on first use, -2 until then.  */
+static int sole_delete_char = -2;
+
 /* Array of character values defining the translation (if any) that
    tr is to perform.  Translation is performed only when there are
    two specification strings and the delete switch is not given.  */
@@ -1529,6 +1535,19 @@ squeeze_filter (char *buf, size_t size, size_t (*reader) (char *, size_t))
   size_t i = 0;
   size_t nr = 0;
 
+  /* When the squeeze set contains exactly one character, the spans
+     free of that character can be located with memchr, which is much
+     faster than the byte-wise scan below.  This covers the common
+     whitespace-normalizing uses like tr -s ' ' and tr -s '\n'.  */
+  int n_squeeze = 0;
+  int squeeze_char = 0;
+  for (int c = 0; c < N_CHARS; c++)
+    if (in_squeeze_set[c])
+      {
+        squeeze_char = c;
+        n_squeeze++;
+      }
+
   while (true)
     {
       if (i >= nr)
@@ -1541,7 +1560,45 @@ squeeze_filter (char *buf, size_t size, size_t (*reader) (char *, size_t))
 
       size_t begin = i;
 
-      if (char_to_squeeze == NOT_A_CHAR)
+      if (char_to_squeeze == NOT_A_CHAR && n_squeeze == 1)
+        {
+          /* Single-character squeeze set: extend the output span over
+             every lone occurrence of the character, stopping only at a
+             run of two or more (or at the end of the buffer, since the
+             run may continue into the next read).  The whole span is
+             then emitted with one write.  */
+          size_t out_len;
+          size_t j = i;
+          while (true)
+            {
+              char const *p = memchr (buf + j, squeeze_char, nr - j);
+              if (p == NULL)
+                {
+                  j = nr;
+                  break;
+                }
+              j = p - buf;
+              if (j + 1 == nr || to_uchar (buf[j + 1]) == squeeze_char)
+                break;
+              j += 2;
+            }
+
+          if (j >= nr)
+            {
+              i = nr;
+              out_len = nr - begin;
+            }
+          else
+            {
+              char_to_squeeze = buf[j];
+              out_len = j - begin + 1;
+              i = j + 1;
+            }
+          if (out_len > 0
+              && fwrite (&buf[begin], 1, out_len, stdout) != out_len)
+            die (EXIT_FAILURE, errno, _("write error"));
+        }
+      else if (char_to_squeeze == NOT_A_CHAR)
         {
           size_t out_len;
           /* Here, by being a little tricky, we can get a significant
@@ -1623,6 +1680,21 @@ read_and_delete (char *buf, size_t size)
 {
   size_t n_saved;
 
+  if (sole_delete_char == -2)
+    {
+      sole_delete_char = -1;
+      for (int c = 0; c < N_CHARS; c++)
+        if (in_delete_set[c])
+          {
+            if (0 <= sole_delete_char)
+              {
+                sole_delete_char = -1;
+                break;
+              }
+            sole_delete_char = c;
+          }
+    }
+
   /* This enclosing do-while loop is to make sure that
      we don't return zero (indicating EOF) when we've
      just deleted all the characters in a buffer.  */
@@ -1633,6 +1705,30 @@ read_and_delete (char *buf, size_t size)
       if (nr == 0)
         return 0;
 
+      if (0 <= sole_delete_char)
+        {
+          /* With a single-member delete set, as in tr -d '\r', let
+             memchr find the deletions and move the text between
+             them en masse.  */
+          char const *p = memchr (buf, sole_delete_char, nr);
+          if (! p)
+            n_saved = nr;
+          else
+            {
+              char const *lim = buf + nr;
+              n_saved = p - buf;
+              while (++p < lim)
+                {
+                  char const *q = memchr (p, sole_delete_char, lim - p);
+                  size_t len = (q ? q : lim) - p;
+                  memmove (buf + n_saved, p, len);
+                  n_saved += len;
+                  p += len;
+                }
+            }
+          continue;
+        }
+
       /* This first loop may be a waste of code, but gives much
          better performance when no characters are deleted in
          the beginning of a buffer.  It just avoids the copying
@@ -60,9 +60,7 @@ main (int argc, char **argv)
     {
       initialize_main (&argc, &argv);
       set_program_name (argv[0]);
-      setlocale (LC_ALL, "");
-      bindtextdomain (PACKAGE, LOCALEDIR);
-      textdomain (PACKAGE);
+      initialize_locale ();
 
       /* Note true(1) will return EXIT_FAILURE in the
          edge case where writes fail with GNU specific options.  */
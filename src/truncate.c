@@ -23,15 +23,32 @@
 #include <config.h>             /* sets _FILE_OFFSET_BITS=64 etc. */
 #include <stdio.h>
 #include <getopt.h>
+#include <pthread.h>
 #include <sys/types.h>
 
+#if HAVE_LINUX_FALLOC_H
+# include <linux/falloc.h>
+#endif
+
 #include "system.h"
+#include "argmatch.h"
 #include "die.h"
 #include "error.h"
 #include "quote.h"
+#include "readtokens0.h"
 #include "stat-size.h"
 #include "xdectoint.h"
 
+#ifndef HAVE_SYNCFS
+# define HAVE_SYNCFS 0
+#endif
+
+#ifdef O_PATH
+enum { O_PATHSEARCH = O_PATH };
+#else
+enum { O_PATHSEARCH = O_SEARCH };
+#endif
+
 /* The official name of this program (e.g., no 'g' prefix).  */
 #define PROGRAM_NAME "truncate"
 
@@ -46,12 +63,67 @@ static bool block_mode;
 /* (-r) Reference file to use size from */
 static char const *ref_file;
 
+/* How to apply the resolved size to each file.  */
+typedef enum
+{
+  am_truncate = 0,      /* set the length with ftruncate */
+  am_allocate,          /* allocate the space with fallocate */
+  am_punch_hole,        /* deallocate the range, keeping the length */
+  am_collapse_range     /* remove the range, shifting later data down */
+} alloc_mode_t;
+
+static alloc_mode_t alloc_mode;
+
+/* (--offset) Start of the range for the allocation modes.  */
+static off_t alloc_offset;
+
+/* (--sync) The durability barrier to apply to the batch.  */
+enum sync_mode
+{
+  sync_none = 0,        /* no explicit flushing */
+  sync_file,            /* fsync each file before closing it */
+  sync_file_system      /* one syncfs per affected file system at the end */
+};
+
+static enum sync_mode sync_mode;
+
+static char const *const sync_args[] =
+{
+  "none", "file", "filesystem", NULL
+};
+static enum sync_mode const sync_types[] =
+{
+  sync_none, sync_file, sync_file_system
+};
+ARGMATCH_VERIFY (sync_args, sync_types);
+
+/* (--threads) Maximum number of worker threads processing the files.  */
+static size_t nthreads = 1;
+
+enum
+{
+  ALLOCATE_OPTION = CHAR_MAX + 1,
+  COLLAPSE_RANGE_OPTION,
+  FILES0_FROM_OPTION,
+  OFFSET_OPTION,
+  PUNCH_HOLE_OPTION,
+  SYNC_OPTION,
+  THREADS_OPTION
+};
+
 static struct option const longopts[] =
 {
+  {"allocate", no_argument, NULL, ALLOCATE_OPTION},
+  {"collapse-range", no_argument, NULL, COLLAPSE_RANGE_OPTION},
+  {"files0-from", required_argument, NULL, FILES0_FROM_OPTION},
   {"no-create", no_argument, NULL, 'c'},
   {"io-blocks", no_argument, NULL, 'o'},
+  {"offset", required_argument, NULL, OFFSET_OPTION},
+  {"punch-hole", no_argument, NULL, PUNCH_HOLE_OPTION},
   {"reference", required_argument, NULL, 'r'},
   {"size", required_argument, NULL, 's'},
+  {"sync", required_argument, NULL, SYNC_OPTION},
+  {"threads", required_argument, NULL, THREADS_OPTION},
   {GETOPT_HELP_OPTION_DECL},
   {GETOPT_VERSION_OPTION_DECL},
   {NULL, 0, NULL, 0}
@@ -60,6 +132,13 @@ static struct option const longopts[] =
 typedef enum
 { rm_abs = 0, rm_rel, rm_min, rm_max, rm_rdn, rm_rup } rel_mode_t;
 
+/* The resolved size arguments and open flags, shared with the
+   --threads workers.  */
+static off_t size IF_LINT ( = 0);
+static off_t rsize = -1;
+static rel_mode_t rel_mode = rm_abs;
+static int oflags;
+
 void
 usage (int status)
 {
@@ -67,7 +146,10 @@ usage (int status)
     emit_try_help ();
   else
     {
-      printf (_("Usage: %s OPTION... FILE...\n"), program_name);
+      printf (_("\
+Usage: %s OPTION... FILE...\n\
+  or:  %s OPTION... --files0-from=F\n\
+"), program_name, program_name);
       fputs (_("\
 Shrink or extend the size of each FILE to the specified size\n\
 \n\
@@ -81,14 +163,41 @@ reads as zero bytes.\n\
       emit_mandatory_arg_note ();
 
       fputs (_("\
+      --allocate         allocate SIZE bytes starting at OFFSET,\n\
+                           rather than leaving extended parts sparse\n\
+"), stdout);
+      fputs (_("\
   -c, --no-create        do not create any files\n\
+"), stdout);
+      fputs (_("\
+      --collapse-range   remove SIZE bytes starting at OFFSET,\n\
+                           shifting the following data down\n\
+"), stdout);
+      fputs (_("\
+      --files0-from=F    process the files specified by NUL-terminated\n\
+                           names in file F; if F is - then read names\n\
+                           from standard input\n\
 "), stdout);
       fputs (_("\
   -o, --io-blocks        treat SIZE as number of IO blocks instead of bytes\n\
+"), stdout);
+      fputs (_("\
+      --offset=OFFSET    start the allocation modes at OFFSET (default 0)\n\
+"), stdout);
+      fputs (_("\
+      --punch-hole       deallocate SIZE bytes starting at OFFSET,\n\
+                           without changing the file size\n\
 "), stdout);
       fputs (_("\
   -r, --reference=RFILE  base size on RFILE\n\
   -s, --size=SIZE        set or adjust the file size by SIZE bytes\n"), stdout);
+      fputs (_("\
+      --sync=MODE        flush the sizes to stable storage: 'none'\n\
+                           (the default), 'file' to fsync each file, or\n\
+                           'filesystem' for one syncfs per affected\n\
+                           file system after the whole batch\n\
+      --threads=N        process the files with up to N threads\n\
+"), stdout);
       fputs (HELP_OPTION_DESCRIPTION, stdout);
       fputs (VERSION_OPTION_DESCRIPTION, stdout);
       emit_size_note ();
@@ -101,6 +210,45 @@ SIZE may also be prefixed by one of the following modifying characters:\n\
   exit (status);
 }
 
+/* Apply the selected allocation mode to the LENGTH bytes of FNAME,
+   open on FD, starting at alloc_offset.
+   Return true on success, false on error.  */
+static bool
+do_fallocate (int fd, char const *fname, off_t length)
+{
+/* +0 is to work around older <linux/fs.h> defining HAVE_FALLOCATE to empty.  */
+#if HAVE_FALLOCATE + 0
+  int mode = 0;
+# if defined FALLOC_FL_PUNCH_HOLE && defined FALLOC_FL_KEEP_SIZE
+  if (alloc_mode == am_punch_hole)
+    mode = FALLOC_FL_PUNCH_HOLE | FALLOC_FL_KEEP_SIZE;
+# endif
+# ifdef FALLOC_FL_COLLAPSE_RANGE
+  if (alloc_mode == am_collapse_range)
+    mode = FALLOC_FL_COLLAPSE_RANGE;
+# endif
+  if (mode == 0 && alloc_mode != am_allocate)
+    {
+      error (0, 0, _("the file system allocation mode requested"
+                     " is not supported on this system"));
+      return false;
+    }
+  if (fallocate (fd, mode, alloc_offset, length) == -1)
+    {
+      error (0, errno,
+             _("failed to adjust the allocation of %" PRIdMAX
+               " bytes at offset %" PRIdMAX " in %s"),
+             (intmax_t) length, (intmax_t) alloc_offset, quoteaf (fname));
+      return false;
+    }
+  return true;
+#else
+  error (0, 0, _("the file system allocation mode requested"
+                 " is not supported on this system"));
+  return false;
+#endif
+}
+
 /* return true on success, false on error.  */
 static bool
 do_ftruncate (int fd, char const *fname, off_t ssize, off_t rsize,
@@ -187,6 +335,9 @@ do_ftruncate (int fd, char const *fname, off_t ssize, off_t rsize,
   if (nsize < 0)
     nsize = 0;
 
+  if (alloc_mode != am_truncate)
+    return do_fallocate (fd, fname, nsize);
+
   if (ftruncate (fd, nsize) == -1)      /* note updates mtime & ctime */
     {
       error (0, errno,
@@ -198,16 +349,243 @@ do_ftruncate (int fd, char const *fname, off_t ssize, off_t rsize,
   return true;
 }
 
+/* The file systems touched by the batch, for --sync=filesystem.
+   Each distinct device keeps one duped descriptor for the closing
+   syncfs.  Guarded by sync_dev_lock among --threads workers.  */
+struct sync_dev
+{
+  dev_t dev;
+  int fd;
+};
+
+static struct sync_dev *sync_devs;
+static size_t n_sync_devs;
+static size_t n_sync_devs_alloc;
+static pthread_mutex_t sync_dev_lock = PTHREAD_MUTEX_INITIALIZER;
+
+/* Note that FD's file system needs a closing syncfs.  */
+
+static void
+record_sync_dev (int fd)
+{
+  struct stat st;
+  if (fstat (fd, &st) != 0)
+    return;
+
+  pthread_mutex_lock (&sync_dev_lock);
+  size_t i;
+  for (i = 0; i < n_sync_devs; i++)
+    if (sync_devs[i].dev == st.st_dev)
+      break;
+  if (i == n_sync_devs)
+    {
+      int dup_fd = fcntl (fd, F_DUPFD_CLOEXEC, 0);
+      if (0 <= dup_fd)
+        {
+          if (n_sync_devs == n_sync_devs_alloc)
+            sync_devs = x2nrealloc (sync_devs, &n_sync_devs_alloc,
+                                    sizeof *sync_devs);
+          sync_devs[n_sync_devs].dev = st.st_dev;
+          sync_devs[n_sync_devs].fd = dup_fd;
+          n_sync_devs++;
+        }
+    }
+  pthread_mutex_unlock (&sync_dev_lock);
+}
+
+/* Apply the end-of-batch durability barrier: one syncfs per recorded
+   file system, instead of an fsync per file.  Return true on success.  */
+
+static bool
+sync_batch (void)
+{
+  bool ok = true;
+
+#if ! HAVE_SYNCFS
+  /* Without syncfs, one global sync is the closest barrier.  */
+  if (n_sync_devs)
+    sync ();
+#endif
+
+  for (size_t i = 0; i < n_sync_devs; i++)
+    {
+#if HAVE_SYNCFS
+      if (syncfs (sync_devs[i].fd) != 0)
+        {
+          error (0, errno, _("error syncing the file system containing"
+                             " file descriptor %d"), sync_devs[i].fd);
+          ok = false;
+        }
+#endif
+      close (sync_devs[i].fd);
+    }
+
+  return ok;
+}
+
+/* A worker's cache of the most recently used parent directory, so
+   that a --files0-from list grouped by directory resolves each parent
+   path once and opens each file relative to it.  */
+struct dir_cache
+{
+  char *dir;            /* The parent path, or NULL if none cached.  */
+  size_t dir_len;       /* Its length, including the last slash.  */
+  int fd;               /* A search-only descriptor on DIR, or -1.  */
+};
+
+/* Open FNAME for the size operation, via CACHE when it has a parent
+   directory.  Return the descriptor, or -1 (setting errno) on error.  */
+
+static int
+open_file (struct dir_cache *cache, char const *fname)
+{
+  char const *base = last_component (fname);
+  size_t dir_len = base - fname;
+
+  if (dir_len == 0 || !*base)
+    return open (fname, oflags, MODE_RW_UGO);
+
+  if (! (0 <= cache->fd && dir_len == cache->dir_len
+         && memcmp (fname, cache->dir, dir_len) == 0))
+    {
+      if (0 <= cache->fd)
+        close (cache->fd);
+      free (cache->dir);
+      cache->dir = xmalloc (dir_len + 1);
+      memcpy (cache->dir, fname, dir_len);
+      cache->dir[dir_len] = '\0';
+      cache->dir_len = dir_len;
+      cache->fd = open (cache->dir, O_PATHSEARCH | O_DIRECTORY);
+    }
+
+  if (cache->fd < 0)
+    return open (fname, oflags, MODE_RW_UGO);
+  return openat (cache->fd, base, oflags, MODE_RW_UGO);
+}
+
+/* Release CACHE's directory descriptor and name.  */
+
+static void
+dir_cache_free (struct dir_cache *cache)
+{
+  if (0 <= cache->fd)
+    close (cache->fd);
+  free (cache->dir);
+}
+
+/* Open FNAME via CACHE and apply the size operation and per-file
+   sync policy to it.  Return true on success, diagnosing errors.  */
+
+static bool
+process_file (char const *fname, struct dir_cache *cache)
+{
+  int fd = open_file (cache, fname);
+  if (fd < 0)
+    {
+      /* 'truncate -s0 -c no-such-file'  shouldn't gen error
+         'truncate -s0 no-such-dir/file' should gen ENOENT error
+         'truncate -s0 no-such-dir/' should gen EISDIR error
+         'truncate -s0 .' should gen EISDIR error */
+      if (no_create && errno == ENOENT)
+        return true;
+      error (0, errno, _("cannot open %s for writing"), quoteaf (fname));
+      return false;
+    }
+
+  bool ok = do_ftruncate (fd, fname, size, rsize, rel_mode);
+
+  if (ok && sync_mode == sync_file && fsync (fd) != 0)
+    {
+      error (0, errno, _("error syncing %s"), quoteaf (fname));
+      ok = false;
+    }
+  if (ok && sync_mode == sync_file_system)
+    record_sync_dev (fd);
+
+  if (close (fd) != 0)
+    {
+      error (0, errno, _("failed to close %s"), quoteaf (fname));
+      ok = false;
+    }
+  return ok;
+}
+
+/* Work shared by the --threads workers; each claims the next
+   unclaimed file.  */
+struct truncate_pool
+{
+  pthread_mutex_t mutex;        /* Guards NEXT and OK.  */
+  char **files;
+  size_t n_files;
+  size_t next;
+  bool ok;
+};
+
+static void *
+truncate_thread (void *arg)
+{
+  struct truncate_pool *pool = arg;
+  struct dir_cache cache = { NULL, 0, -1 };
+
+  while (true)
+    {
+      pthread_mutex_lock (&pool->mutex);
+      size_t i = pool->next++;
+      pthread_mutex_unlock (&pool->mutex);
+      if (pool->n_files <= i)
+        break;
+
+      if (! process_file (pool->files[i], &cache))
+        {
+          pthread_mutex_lock (&pool->mutex);
+          pool->ok = false;
+          pthread_mutex_unlock (&pool->mutex);
+        }
+    }
+
+  dir_cache_free (&cache);
+  return NULL;
+}
+
+/* Process the N_FILES FILES with up to nthreads worker threads.
+   Return true if every file was handled successfully.  */
+
+static bool
+process_files_parallel (char **files, size_t n_files)
+{
+  struct truncate_pool pool = { PTHREAD_MUTEX_INITIALIZER, files, n_files,
+                                0, true };
+
+  size_t nworkers = MIN (nthreads, n_files);
+  pthread_t *threads = xnmalloc (nworkers - 1, sizeof *threads);
+  size_t started = 0;
+
+  /* This thread is a worker too; if a thread cannot be created, the
+     others simply pick up the remaining files.  */
+  for (size_t i = 0; i + 1 < nworkers; i++)
+    {
+      if (pthread_create (&threads[started], NULL, truncate_thread, &pool)
+          != 0)
+        break;
+      started++;
+    }
+  truncate_thread (&pool);
+  for (size_t i = 0; i < started; i++)
+    pthread_join (threads[i], NULL);
+  free (threads);
+
+  return pool.ok;
+}
+
 int
 main (int argc, char **argv)
 {
   bool got_size = false;
+  bool got_offset = false;
   bool errors = false;
-  off_t size IF_LINT ( = 0);
-  off_t rsize = -1;
-  rel_mode_t rel_mode = rm_abs;
-  int c, fd = -1, oflags;
-  char const *fname;
+  char const *files_from = NULL;
+  struct Tokens tok;
+  int c;
 
   initialize_main (&argc, &argv);
   set_program_name (argv[0]);
@@ -233,6 +611,32 @@ main (int argc, char **argv)
           ref_file = optarg;
           break;
 
+        case ALLOCATE_OPTION:
+        case COLLAPSE_RANGE_OPTION:
+        case PUNCH_HOLE_OPTION:
+          {
+            alloc_mode_t mode = (c == ALLOCATE_OPTION ? am_allocate
+                                 : c == PUNCH_HOLE_OPTION ? am_punch_hole
+                                 : am_collapse_range);
+            if (alloc_mode != am_truncate && alloc_mode != mode)
+              {
+                error (0, 0, _("multiple allocation modes specified"));
+                usage (EXIT_FAILURE);
+              }
+            alloc_mode = mode;
+          }
+          break;
+
+        case FILES0_FROM_OPTION:
+          files_from = optarg;
+          break;
+
+        case OFFSET_OPTION:
+          got_offset = true;
+          alloc_offset = xdectoimax (optarg, 0, OFF_T_MAX, "EgGkKmMPtTYZ0",
+                                     _("Invalid offset"), 0);
+          break;
+
         case 's':
           /* skip any whitespace */
           while (isspace (to_uchar (*optarg)))
@@ -279,6 +683,15 @@ main (int argc, char **argv)
           got_size = true;
           break;
 
+        case SYNC_OPTION:
+          sync_mode = XARGMATCH ("--sync", optarg, sync_args, sync_types);
+          break;
+
+        case THREADS_OPTION:
+          nthreads = xdectoumax (optarg, 1, SIZE_MAX, "",
+                                 _("invalid number of threads"), 0);
+          break;
+
         case_GETOPT_HELP_CHAR;
 
         case_GETOPT_VERSION_CHAR (PROGRAM_NAME, AUTHORS);
@@ -305,6 +718,13 @@ main (int argc, char **argv)
              quote_n (0, "--size"), quote_n (1, "--reference"));
       usage (EXIT_FAILURE);
     }
+  /* an offset is only meaningful with an allocation mode */
+  if (got_offset && alloc_mode == am_truncate)
+    {
+      error (0, 0, _("%s was specified but an allocation mode was not"),
+             quote ("--offset"));
+      usage (EXIT_FAILURE);
+    }
   /* block_mode without size is not valid */
   if (block_mode && !got_size)
     {
@@ -312,8 +732,46 @@ main (int argc, char **argv)
              quote_n (0, "--io-blocks"), quote_n (1, "--size"));
       usage (EXIT_FAILURE);
     }
+  char **files = argv;
+  size_t nfiles = argc;
+
+  if (files_from)
+    {
+      /* When using --files0-from=F, you may not specify any files
+         on the command-line.  */
+      if (argc)
+        {
+          error (0, 0, _("extra operand %s"), quoteaf (argv[0]));
+          fprintf (stderr, "%s\n",
+                   _("file operands cannot be combined with --files0-from"));
+          usage (EXIT_FAILURE);
+        }
+
+      if (! (STREQ (files_from, "-") || freopen (files_from, "r", stdin)))
+        die (EXIT_FAILURE, errno, _("cannot open %s for reading"),
+             quoteaf (files_from));
+
+      readtokens0_init (&tok);
+      if (! readtokens0 (stdin, &tok))
+        die (EXIT_FAILURE, 0, _("cannot read file names from %s"),
+             quoteaf (files_from));
+
+      files = tok.tok;
+      nfiles = tok.n_tok;
+      for (size_t i = 0; i < nfiles; i++)
+        if (files[i][0] == '\0')
+          {
+            /* Using the standard 'filename:line-number:' prefix here is
+               not totally appropriate, since NUL is the separator,
+               not NL, but it might be better than nothing.  */
+            error (0, 0, _("%s:%lu: invalid zero-length file name"),
+                   quotef (files_from), (unsigned long int) i + 1);
+            usage (EXIT_FAILURE);
+          }
+    }
+
   /* must specify at least 1 file */
-  if (argc < 1)
+  if (nfiles < 1)
     {
       error (0, 0, _("missing file operand"));
       usage (EXIT_FAILURE);
@@ -355,34 +813,17 @@ main (int argc, char **argv)
 
   oflags = O_WRONLY | (no_create ? 0 : O_CREAT) | O_NONBLOCK;
 
-  while ((fname = *argv++) != NULL)
+  if (1 < nthreads && 1 < nfiles)
+    errors |= ! process_files_parallel (files, nfiles);
+  else
     {
-      if ((fd = open (fname, oflags, MODE_RW_UGO)) == -1)
-        {
-          /* 'truncate -s0 -c no-such-file'  shouldn't gen error
-             'truncate -s0 no-such-dir/file' should gen ENOENT error
-             'truncate -s0 no-such-dir/' should gen EISDIR error
-             'truncate -s0 .' should gen EISDIR error */
-          if (!(no_create && errno == ENOENT))
-            {
-              error (0, errno, _("cannot open %s for writing"),
-                     quoteaf (fname));
-              errors = true;
-            }
-          continue;
-        }
-
-
-      if (fd != -1)
-        {
-          errors |= !do_ftruncate (fd, fname, size, rsize, rel_mode);
-          if (close (fd) != 0)
-            {
-              error (0, errno, _("failed to close %s"), quoteaf (fname));
-              errors = true;
-            }
-        }
+      struct dir_cache cache = { NULL, 0, -1 };
+      for (size_t i = 0; i < nfiles; i++)
+        errors |= ! process_file (files[i], &cache);
+      dir_cache_free (&cache);
     }
 
+  errors |= ! sync_batch ();
+
   return errors ? EXIT_FAILURE : EXIT_SUCCESS;
 }
@@ -26,7 +26,6 @@
 #include <sys/types.h>
 
 #include "system.h"
-#include "long-options.h"
 #include "die.h"
 #include "error.h"
 #include "fadvise.h"
@@ -55,6 +54,8 @@ struct item
   char const *str;
   struct item *left, *right;
   int balance; /* -1, 0, or +1 */
+  size_t printed; /* 0 if not yet written, else 1 + the number of
+                     strings written before it.  */
   size_t count;
   struct item *qlink;
   struct successor *top;
@@ -72,6 +73,57 @@ static struct item *loop = NULL;
 /* The number of strings to sort.  */
 static size_t n_strings = 0;
 
+/* If true, write each string as soon as all of its known predecessors
+   have been written, instead of waiting for the whole input.  */
+static bool stream_output;
+
+/* The number of strings written so far.  */
+static size_t n_printed = 0;
+
+enum
+{
+  STREAM_OPTION = CHAR_MAX + 1
+};
+
+static struct option const long_options[] =
+{
+  {"stream", no_argument, NULL, STREAM_OPTION},
+  {GETOPT_HELP_OPTION_DECL},
+  {GETOPT_VERSION_OPTION_DECL},
+  {NULL, 0, NULL, 0}
+};
+
+/* Arena from which items, successors and their strings are carved.
+   Nothing is ever freed individually, and a large graph means one
+   item per string plus one successor per relation, so allocating out
+   of large blocks avoids per-node malloc overhead and keeps the nodes
+   adjacent in memory.  */
+
+enum { ARENA_BLOCK_SIZE = 256 * 1024 };
+
+static char *arena_next;
+static size_t arena_avail;
+
+static void *
+arena_alloc (size_t size)
+{
+  /* Align for the pointer and size_t members of the node types.  */
+  size_t align = sizeof (void *);
+  size = (size + align - 1) & ~(align - 1);
+
+  if (arena_avail < size)
+    {
+      size_t block = MAX (size, ARENA_BLOCK_SIZE);
+      arena_next = xmalloc (block);
+      arena_avail = block;
+    }
+
+  void *p = arena_next;
+  arena_next += size;
+  arena_avail -= size;
+  return p;
+}
+
 void
 usage (int status)
 {
@@ -88,6 +140,10 @@ Write totally ordered list consistent with the partial ordering in FILE.\n\
 
       fputs (_("\
 \n\
+      --stream   write each string as soon as all of its known predecessors\n\
+                   have been written, instead of after reading all of the\n\
+                   input; a predecessor given for an already written string\n\
+                   is diagnosed\n\
 "), stdout);
       fputs (HELP_OPTION_DESCRIPTION, stdout);
       fputs (VERSION_OPTION_DESCRIPTION, stdout);
@@ -101,11 +157,19 @@ Write totally ordered list consistent with the partial ordering in FILE.\n\
 static struct item *
 new_item (char const *str)
 {
-  struct item *k = xmalloc (sizeof *k);
+  struct item *k = arena_alloc (sizeof *k);
+  char *str_copy = NULL;
+
+  if (str)
+    {
+      size_t size = strlen (str) + 1;
+      str_copy = memcpy (arena_alloc (size), str, size);
+    }
 
-  k->str = (str ? xstrdup (str): NULL);
+  k->str = str_copy;
   k->left = k->right = NULL;
   k->balance = 0;
+  k->printed = 0;
 
   /* T1. Initialize (COUNT[k] <- 0 and TOP[k] <- ^).  */
   k->count = 0;
@@ -277,13 +341,55 @@ record_relation (struct item *j, struct item *k)
   if (!STREQ (j->str, k->str))
     {
       k->count++;
-      p = xmalloc (sizeof *p);
+      p = arena_alloc (sizeof *p);
       p->suc = k;
       p->next = j->top;
       j->top = p;
     }
 }
 
+/* Write K, which has no unwritten predecessors, then cascade: erase
+   the relations K heads and write any successors thereby freed, as in
+   steps T5--T7, but while the input is still being read.  Strings
+   that gain a predecessor later are caught by the caller; strings
+   left unwritten at end of input are handled by the normal endgame,
+   which also detects loops.  */
+
+static void
+stream_emit (struct item *k)
+{
+  struct item *qhead = k;
+  struct item *qtail = k;
+
+  k->qlink = NULL;
+
+  while (qhead)
+    {
+      struct successor *p = qhead->top;
+
+      puts (qhead->str);
+      qhead->printed = ++n_printed;
+
+      while (p)
+        {
+          p->suc->count--;
+          if (p->suc->count == 0 && !p->suc->printed)
+            {
+              p->suc->qlink = NULL;
+              qtail->qlink = p->suc;
+              qtail = p->suc;
+            }
+
+          p = p->next;
+        }
+
+      qhead = qhead->qlink;
+    }
+
+  /* Let a downstream consumer start on what is ready so far.  */
+  fflush (stdout);
+}
+
 static bool
 count_items (struct item *unused _GL_UNUSED)
 {
@@ -295,7 +401,7 @@ static bool
 scan_zeros (struct item *k)
 {
   /* Ignore strings that have already been printed.  */
-  if (k->count == 0 && k->str)
+  if (k->count == 0 && !k->printed)
     {
       if (head == NULL)
         head = k;
@@ -465,7 +571,36 @@ tsort (char const *file)
       if (j)
         {
           /* T3. Record the relation.  */
-          record_relation (j, k);
+          if (! stream_output)
+            record_relation (j, k);
+          else if (k->printed)
+            {
+              /* K is gone already; do not record the relation, which
+                 would wrongly make K look like part of a loop at end
+                 of input.  Complain unless J happened to go first.  */
+              if ((!j->printed || k->printed < j->printed)
+                  && !STREQ (j->str, k->str))
+                {
+                  error (0, 0,
+                         _("%s: %s: predecessor specified after string was written"),
+                         quotef (file), quote (k->str));
+                  ok = false;
+                }
+            }
+          else if (j->printed)
+            {
+              /* The relation is already satisfied, so do not record it;
+                 it may even have made K ready.  */
+              if (k->count == 0)
+                stream_emit (k);
+            }
+          else
+            {
+              record_relation (j, k);
+              if (j->count == 0)
+                stream_emit (j);
+            }
+
           k = NULL;
         }
 
@@ -476,8 +611,11 @@ tsort (char const *file)
     die (EXIT_FAILURE, 0, _("%s: input contains an odd number of tokens"),
          quotef (file));
 
-  /* T1. Initialize (N <- n).  */
+  /* T1. Initialize (N <- n).  In stream mode most strings have
+     already been written; what remains is empty unless the input
+     contains a loop.  */
   walk_tree (root, count_items);
+  n_strings -= n_printed;
 
   while (n_strings > 0)
     {
@@ -490,12 +628,7 @@ tsort (char const *file)
 
           /* T5. Output front of queue.  */
           puts (head->str);
-#ifdef lint
-          /* suppress valgrind "definitely lost" warnings.  */
-          void *head_str = (void *) head->str;
-          free (head_str);
-#endif
-          head->str = NULL;	/* Avoid printing the same string twice.  */
+          head->printed = ++n_printed;  /* Avoid printing it twice.  */
           n_strings--;
 
           /* T6. Erase relations.  */
@@ -529,8 +662,6 @@ tsort (char const *file)
         }
     }
 
-  IF_LINT (free (root));
-
   if (fclose (stdin) != 0)
     die (EXIT_FAILURE, errno, "%s",
          is_stdin ? _("standard input") : quotef (file));
@@ -542,6 +673,7 @@ int
 main (int argc, char **argv)
 {
   bool ok;
+  int optc;
 
   initialize_main (&argc, &argv);
   set_program_name (argv[0]);
@@ -551,9 +683,20 @@ main (int argc, char **argv)
 
   atexit (close_stdout);
 
-  parse_gnu_standard_options_only (argc, argv, PROGRAM_NAME, PACKAGE_NAME,
-                                   Version, true, usage, AUTHORS,
-                                   (char const *) NULL);
+  while ((optc = getopt_long (argc, argv, "", long_options, NULL)) != -1)
+    switch (optc)
+      {
+      case STREAM_OPTION:
+        stream_output = true;
+        break;
+
+      case_GETOPT_HELP_CHAR;
+
+      case_GETOPT_VERSION_CHAR (PROGRAM_NAME, AUTHORS);
+
+      default:
+        usage (EXIT_FAILURE);
+      }
 
   if (1 < argc - optind)
     {
@@ -99,12 +99,23 @@ Convert blanks in each FILE to tabs, writing to standard output.\n\
   exit (status);
 }
 
+/* Write N bytes from P to stdout, or die.  */
+
+static void
+write_block (char const *p, size_t n)
+{
+  if (fwrite (p, 1, n, stdout) != n)
+    die (EXIT_FAILURE, errno, _("write error"));
+}
+
 /* Change blanks to tabs, writing to stdout.
    Read each file in 'file_list', in order.  */
 
 static void
 unexpand (void)
 {
+  static char buf[EXPAND_BUFFER_SIZE];
+
   /* Input stream.  */
   FILE *fp = next_file (NULL);
 
@@ -113,144 +124,211 @@ unexpand (void)
      stored, not merely counted.  */
   char *pending_blank;
 
-  if (!fp)
-    return;
+  /* ORDINARY[C] is true for characters C that neither are blanks nor
+     need any special handling, and so merely advance the column.  */
+  bool ordinary[UCHAR_MAX + 1];
 
-  /* The worst case is a non-blank character, then one blank, then a
-     tab stop, then MAX_COLUMN_WIDTH - 1 blanks, then a non-blank; so
-     allocate MAX_COLUMN_WIDTH bytes to store the blanks.  */
-  pending_blank = xmalloc (max_column_width);
+  /* If true, perform translations.  */
+  bool convert = true;
 
-  while (true)
-    {
-      /* Input character, or EOF.  */
-      int c;
+  /* The following variables have valid values only when CONVERT
+     is true:  */
 
-      /* If true, perform translations.  */
-      bool convert = true;
+  /* Column of next input character.  */
+  uintmax_t column = 0;
 
+  /* Column the next input tab stop is on.  */
+  uintmax_t next_tab_column = 0;
 
-      /* The following variables have valid values only when CONVERT
-         is true:  */
+  /* Index in TAB_LIST of next tab stop to examine.  */
+  size_t tab_index = 0;
 
-      /* Column of next input character.  */
-      uintmax_t column = 0;
+  /* If true, the first pending blank came just before a tab stop.  */
+  bool one_blank_before_tab_stop = false;
 
-      /* Column the next input tab stop is on.  */
-      uintmax_t next_tab_column = 0;
+  /* If true, the previous input character was a blank.  This is
+     initially true, since initial strings of blanks are treated
+     as if the line was preceded by a blank.  */
+  bool prev_blank = true;
 
-      /* Index in TAB_LIST of next tab stop to examine.  */
-      size_t tab_index = 0;
+  /* Number of pending columns of blanks.  */
+  size_t pending = 0;
 
-      /* If true, the first pending blank came just before a tab stop.  */
-      bool one_blank_before_tab_stop = false;
+  size_t len;
 
-      /* If true, the previous input character was a blank.  This is
-         initially true, since initial strings of blanks are treated
-         as if the line was preceded by a blank.  */
-      bool prev_blank = true;
+  if (!fp)
+    return;
 
-      /* Number of pending columns of blanks.  */
-      size_t pending = 0;
+  /* The worst case is a non-blank character, then one blank, then a
+     tab stop, then MAX_COLUMN_WIDTH - 1 blanks, then a non-blank; so
+     allocate MAX_COLUMN_WIDTH bytes to store the blanks.  */
+  pending_blank = xmalloc (max_column_width);
 
+  for (int i = 0; i <= UCHAR_MAX; i++)
+    ordinary[i] = ! isblank (i) && i != '\b' && i != '\n';
 
-      /* Convert a line of text.  */
+  while ((len = fill_input_buffer (&fp, buf, sizeof buf)) != 0)
+    {
+      char const *p = buf;
+      char const *lim = buf + len;
 
-      do
+      while (p < lim)
         {
-          while ((c = getc (fp)) < 0 && (fp = next_file (fp)))
-            continue;
+          if (! convert)
+            {
+              /* The rest of the line is copied verbatim.  */
+              char const *nl = memchr (p, '\n', lim - p);
+              size_t n = (nl ? nl + 1 : lim) - p;
+              write_block (p, n);
+              p += n;
+              if (nl)
+                {
+                  convert = true;
+                  column = 0;
+                  next_tab_column = 0;
+                  tab_index = 0;
+                  one_blank_before_tab_stop = false;
+                  prev_blank = true;
+                }
+              continue;
+            }
 
-          if (convert)
+          if (ordinary[to_uchar (*p)])
             {
-              bool blank = !! isblank (c);
+              /* A run of characters that only advance the column; the
+                 tab stops do not matter until the next blank.  */
+              char const *q = p + 1;
+              while (q < lim && ordinary[to_uchar (*q)])
+                q++;
+              size_t n = q - p;
+
+              convert = convert_entire_line;
+              if (convert)
+                {
+                  if (column + n < column)
+                    die (EXIT_FAILURE, 0, _("input line is too long"));
+                  column += n;
+                }
 
-              if (blank)
+              if (pending)
                 {
-                  bool last_tab IF_LINT (=0);
+                  if (pending > 1 && one_blank_before_tab_stop)
+                    pending_blank[0] = '\t';
+                  write_block (pending_blank, pending);
+                  pending = 0;
+                  one_blank_before_tab_stop = false;
+                }
+
+              prev_blank = false;
+              write_block (p, n);
+              p = q;
+              continue;
+            }
 
-                  next_tab_column = get_next_tab_column (column, &tab_index,
-                                                         &last_tab);
+          /* A blank, a backspace, or a newline.  */
+          int c = to_uchar (*p);
+          p++;
 
-                  if (last_tab)
-                    convert = false;
+          bool blank = !! isblank (c);
 
-                  if (convert)
+          if (blank)
+            {
+              bool last_tab IF_LINT (=0);
+
+              next_tab_column = get_next_tab_column (column, &tab_index,
+                                                     &last_tab);
+
+              if (last_tab)
+                convert = false;
+
+              if (convert)
+                {
+                  if (next_tab_column < column)
+                    die (EXIT_FAILURE, 0, _("input line is too long"));
+
+                  if (c == '\t')
                     {
-                      if (next_tab_column < column)
-                        die (EXIT_FAILURE, 0, _("input line is too long"));
+                      column = next_tab_column;
 
-                      if (c == '\t')
-                        {
-                          column = next_tab_column;
+                      if (pending)
+                        pending_blank[0] = '\t';
+                    }
+                  else
+                    {
+                      column++;
 
-                          if (pending)
-                            pending_blank[0] = '\t';
-                        }
-                      else
+                      if (! (prev_blank && column == next_tab_column))
                         {
-                          column++;
-
-                          if (! (prev_blank && column == next_tab_column))
-                            {
-                              /* It is not yet known whether the pending blanks
-                                 will be replaced by tabs.  */
-                              if (column == next_tab_column)
-                                one_blank_before_tab_stop = true;
-                              pending_blank[pending++] = c;
-                              prev_blank = true;
-                              continue;
-                            }
-
-                          /* Replace the pending blanks by a tab or two.  */
-                          pending_blank[0] = c = '\t';
+                          /* It is not yet known whether the pending blanks
+                             will be replaced by tabs.  */
+                          if (column == next_tab_column)
+                            one_blank_before_tab_stop = true;
+                          pending_blank[pending++] = c;
+                          prev_blank = true;
+                          continue;
                         }
 
-                      /* Discard pending blanks, unless it was a single
-                         blank just before the previous tab stop.  */
-                      pending = one_blank_before_tab_stop;
+                      /* Replace the pending blanks by a tab or two.  */
+                      pending_blank[0] = c = '\t';
                     }
-                }
-              else if (c == '\b')
-                {
-                  /* Go back one column, and force recalculation of the
-                     next tab stop.  */
-                  column -= !!column;
-                  next_tab_column = column;
-                  tab_index -= !!tab_index;
-                }
-              else
-                {
-                  column++;
-                  if (!column)
-                    die (EXIT_FAILURE, 0, _("input line is too long"));
-                }
 
-              if (pending)
-                {
-                  if (pending > 1 && one_blank_before_tab_stop)
-                    pending_blank[0] = '\t';
-                  if (fwrite (pending_blank, 1, pending, stdout) != pending)
-                    die (EXIT_FAILURE, errno, _("write error"));
-                  pending = 0;
-                  one_blank_before_tab_stop = false;
+                  /* Discard pending blanks, unless it was a single
+                     blank just before the previous tab stop.  */
+                  pending = one_blank_before_tab_stop;
                 }
-
-              prev_blank = blank;
-              convert &= convert_entire_line || blank;
+            }
+          else if (c == '\b')
+            {
+              /* Go back one column, and force recalculation of the
+                 next tab stop.  */
+              column -= !!column;
+              next_tab_column = column;
+              tab_index -= !!tab_index;
+            }
+          else
+            {
+              /* A newline.  */
+              column++;
+              if (!column)
+                die (EXIT_FAILURE, 0, _("input line is too long"));
             }
 
-          if (c < 0)
+          if (pending)
             {
-              free (pending_blank);
-              return;
+              if (pending > 1 && one_blank_before_tab_stop)
+                pending_blank[0] = '\t';
+              write_block (pending_blank, pending);
+              pending = 0;
+              one_blank_before_tab_stop = false;
             }
 
+          prev_blank = blank;
+          convert &= convert_entire_line || blank;
+
           if (putchar (c) < 0)
             die (EXIT_FAILURE, errno, _("write error"));
+
+          if (c == '\n')
+            {
+              convert = true;
+              column = 0;
+              next_tab_column = 0;
+              tab_index = 0;
+              one_blank_before_tab_stop = false;
+              prev_blank = true;
+            }
         }
-      while (c != '\n');
     }
+
+  /* As at a line boundary, flush any blanks still pending at EOF.  */
+  if (pending)
+    {
+      if (pending > 1 && one_blank_before_tab_stop)
+        pending_blank[0] = '\t';
+      write_block (pending_blank, pending);
+    }
+
+  free (pending_blank);
 }
 
 int
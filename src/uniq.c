@@ -23,7 +23,10 @@
 
 #include "system.h"
 #include "argmatch.h"
+#include "hash.h"
 #include "linebuffer.h"
+#include "linebuffer-prefixed.h"
+#include "linebuffer-span.h"
 #include "die.h"
 #include "error.h"
 #include "fadvise.h"
@@ -134,19 +137,58 @@ static enum grouping_method const grouping_method_map[] =
 
 static enum grouping_method grouping = GM_NONE;
 
+/* If true, group matching lines with a hash table instead of relying
+   on them being adjacent, so the input need not be sorted.  */
+static bool unsorted;
+
+enum count_distinct_method
+{
+  /* --count-distinct not specified.  */
+  CD_NONE,
+
+  /* Exact count via a hash set of the distinct keys.  */
+  CD_EXACT,
+
+  /* Approximate count via a HyperLogLog sketch in fixed memory.  */
+  CD_APPROXIMATE
+};
+
+static char const *const count_distinct_method_string[] =
+{
+  "exact", "approximate", NULL
+};
+
+static enum count_distinct_method const count_distinct_method_map[] =
+{
+  CD_EXACT, CD_APPROXIMATE
+};
+
+/* Whether and how to print only the number of distinct keys.  */
+static enum count_distinct_method count_distinct = CD_NONE;
+
+/* If true, lines are length-prefixed binary records rather than
+   delimited text; see varint.h for the format.  */
+static bool length_prefixed;
+
 enum
 {
-  GROUP_OPTION = CHAR_MAX + 1
+  COUNT_DISTINCT_OPTION = CHAR_MAX + 1,
+  GROUP_OPTION,
+  LENGTH_PREFIXED_OPTION,
+  UNSORTED_OPTION
 };
 
 static struct option const longopts[] =
 {
   {"count", no_argument, NULL, 'c'},
+  {"count-distinct", optional_argument, NULL, COUNT_DISTINCT_OPTION},
   {"repeated", no_argument, NULL, 'd'},
   {"all-repeated", optional_argument, NULL, 'D'},
   {"group", optional_argument, NULL, GROUP_OPTION},
   {"ignore-case", no_argument, NULL, 'i'},
+  {"length-prefixed", no_argument, NULL, LENGTH_PREFIXED_OPTION},
   {"unique", no_argument, NULL, 'u'},
+  {"unsorted", no_argument, NULL, UNSORTED_OPTION},
   {"skip-fields", required_argument, NULL, 'f'},
   {"skip-chars", required_argument, NULL, 's'},
   {"check-chars", required_argument, NULL, 'w'},
@@ -178,6 +220,12 @@ With no options, matching lines are merged to the first occurrence.\n\
 
      fputs (_("\
   -c, --count           prefix lines by the number of occurrences\n\
+"), stdout);
+     fputs (_("\
+      --count-distinct[=METHOD]  print only the number of distinct lines;\n\
+                          METHOD={exact(default),approximate}\n\
+"), stdout);
+     fputs (_("\
   -d, --repeated        only print duplicate lines, one for each group\n\
 "), stdout);
      fputs (_("\
@@ -195,8 +243,13 @@ With no options, matching lines are merged to the first occurrence.\n\
 "), stdout);
      fputs (_("\
   -i, --ignore-case     ignore differences in case when comparing\n\
+      --length-prefixed     read and write length-prefixed binary records\n\
+                          (a varint byte count, then the payload) instead\n\
+                          of delimited lines\n\
   -s, --skip-chars=N    avoid comparing the first N characters\n\
   -u, --unique          only print unique lines\n\
+      --unsorted        group matching lines even when not adjacent,\n\
+                          outputting groups in order of first occurrence\n\
 "), stdout);
       fputs (_("\
   -z, --zero-terminated     line delimiter is NUL, not newline\n\
@@ -249,6 +302,26 @@ size_opt (char const *opt, char const *msgid)
   return MIN (size, SIZE_MAX);
 }
 
+/* Nonzero for bytes that field_sep treats as separators.  Initialized
+   by init_field_sep once the locale is known.  */
+static bool field_sep_table[UCHAR_MAX + 1];
+
+/* True when the separators are exactly space, tab and newline, as in
+   the C locale; then field ends can be found with memchr.  */
+static bool field_sep_is_default;
+
+static void
+init_field_sep (void)
+{
+  field_sep_is_default = true;
+  for (int c = 0; c <= UCHAR_MAX; c++)
+    {
+      field_sep_table[c] = field_sep (c);
+      if (field_sep_table[c] != (c == ' ' || c == '\t' || c == '\n'))
+        field_sep_is_default = false;
+    }
+}
+
 /* Given a linebuffer LINE,
    return a pointer to the beginning of the line's field to be compared. */
 
@@ -262,10 +335,32 @@ find_field (struct linebuffer const *line)
 
   for (count = 0; count < skip_fields && i < size; count++)
     {
-      while (i < size && field_sep (lp[i]))
-        i++;
-      while (i < size && !field_sep (lp[i]))
+      while (i < size && field_sep_table[to_uchar (lp[i])])
         i++;
+
+      if (field_sep_is_default)
+        {
+          /* Scan to the field's end with memchr, which examines many
+             bytes at a time.  */
+          char const *p = lp + i;
+          size_t n = size - i;
+          char const *end = memchr (p, '\n', n);
+          if (end)
+            n = end - p;
+          char const *q = memchr (p, ' ', n);
+          if (q)
+            {
+              end = q;
+              n = q - p;
+            }
+          q = memchr (p, '\t', n);
+          if (q)
+            end = q;
+          i = end ? end - lp : size;
+        }
+      else
+        while (i < size && !field_sep_table[to_uchar (lp[i])])
+          i++;
     }
 
   i += MIN (skip_chars, size - i);
@@ -292,6 +387,49 @@ different (char *old, char *new, size_t oldlen, size_t newlen)
     return oldlen != newlen || memcmp (old, new, oldlen);
 }
 
+/* Read the next line or record of input into LB, returning NULL at
+   end of input or on error, as readlinebuffer_span does.  */
+
+static struct linebuffer *
+read_line (struct linebuffer *lb, FILE *fp, char delimiter)
+{
+  return (length_prefixed
+          ? readlinebuffer_prefixed (lb, fp)
+          : readlinebuffer_span (lb, fp, delimiter));
+}
+
+/* Write an output record: the HDR_LEN bytes at HDR (a formatted
+   count, if any) followed by the LEN - 1 payload bytes at PAYLOAD,
+   whose last byte is the delimiter or its stand-in NUL.  With
+   --length-prefixed the record is framed with a length prefix and the
+   stand-in NUL is dropped; otherwise it is written verbatim.  */
+
+static void
+write_output_record (char const *hdr, size_t hdr_len,
+                     char const *payload, size_t len)
+{
+  if (length_prefixed)
+    {
+      char prefix[VARINT_BYTES_BOUND];
+      size_t n = varint_encode (prefix, hdr_len + len - 1);
+      fwrite (prefix, sizeof (char), n, stdout);
+      len--;
+    }
+  if (hdr_len)
+    fwrite (hdr, sizeof (char), hdr_len, stdout);
+  fwrite (payload, sizeof (char), len, stdout);
+}
+
+/* Write the empty line that separates or delimits groups.  With
+   --length-prefixed an empty record serves instead; its encoding is
+   the single byte 0.  */
+
+static void
+write_group_separator (char delimiter)
+{
+  putchar (length_prefixed ? '\0' : delimiter);
+}
+
 /* Output the line in linebuffer LINE to standard output
    provided that the switches say it should be output.
    MATCH is true if the line matches the previous line.
@@ -302,15 +440,19 @@ static void
 writeline (struct linebuffer const *line,
            bool match, uintmax_t linecount)
 {
+  char countbuf[INT_BUFSIZE_BOUND (uintmax_t) + 8];
+  size_t countlen = 0;
+
   if (! (linecount == 0 ? output_unique
          : !match ? output_first_repeated
          : output_later_repeated))
     return;
 
   if (countmode == count_occurrences)
-    printf ("%7" PRIuMAX " ", linecount + 1);
+    countlen = snprintf (countbuf, sizeof countbuf,
+                         "%7" PRIuMAX " ", linecount + 1);
 
-  fwrite (line->buffer, sizeof (char), line->length, stdout);
+  write_output_record (countbuf, countlen, line->buffer, line->length);
 }
 
 /* Process input file INFILE with output to OUTFILE.
@@ -362,7 +504,7 @@ check_file (char const *infile, char const *outfile, char delimiter)
           size_t thislen;
           bool new_group;
 
-          if (readlinebuffer_delim (thisline, stdin, delimiter) == 0)
+          if (read_line (thisline, stdin, delimiter) == 0)
             break;
 
           thisfield = find_field (thisline);
@@ -375,12 +517,12 @@ check_file (char const *infile, char const *outfile, char delimiter)
               && (grouping == GM_PREPEND || grouping == GM_BOTH
                   || (first_group_printed && (grouping == GM_APPEND
                                               || grouping == GM_SEPARATE))))
-            putchar (delimiter);
+            write_group_separator (delimiter);
 
           if (new_group || grouping != GM_NONE)
             {
-              fwrite (thisline->buffer, sizeof (char),
-                      thisline->length, stdout);
+              write_output_record (NULL, 0, thisline->buffer,
+                                   thisline->length);
 
               SWAP_LINES (prevline, thisline);
               prevfield = thisfield;
@@ -389,7 +531,7 @@ check_file (char const *infile, char const *outfile, char delimiter)
             }
         }
       if ((grouping == GM_BOTH || grouping == GM_APPEND) && first_group_printed)
-        putchar (delimiter);
+        write_group_separator (delimiter);
     }
   else
     {
@@ -398,7 +540,7 @@ check_file (char const *infile, char const *outfile, char delimiter)
       uintmax_t match_count = 0;
       bool first_delimiter = true;
 
-      if (readlinebuffer_delim (prevline, stdin, delimiter) == 0)
+      if (read_line (prevline, stdin, delimiter) == 0)
         goto closefiles;
       prevfield = find_field (prevline);
       prevlen = prevline->length - 1 - (prevfield - prevline->buffer);
@@ -408,7 +550,7 @@ check_file (char const *infile, char const *outfile, char delimiter)
           bool match;
           char *thisfield;
           size_t thislen;
-          if (readlinebuffer_delim (thisline, stdin, delimiter) == 0)
+          if (read_line (thisline, stdin, delimiter) == 0)
             {
               if (ferror (stdin))
                 goto closefiles;
@@ -438,7 +580,7 @@ check_file (char const *infile, char const *outfile, char delimiter)
                   if ((delimit_groups == DM_PREPEND)
                       || (delimit_groups == DM_SEPARATE
                           && !first_delimiter))
-                    putchar (delimiter);
+                    write_group_separator (delimiter);
                 }
             }
 
@@ -466,6 +608,335 @@ check_file (char const *infile, char const *outfile, char delimiter)
   free (lb2.buffer);
 }
 
+/* A group of matching lines, for --unsorted.  BUFFER holds the first
+   line of the group, including the delimiter.  FIELD and FIELD_LEN
+   describe the comparison field within BUFFER, already limited to
+   check_chars bytes.  */
+
+struct grouped_line
+{
+  char *buffer;
+  size_t length;
+  char *field;
+  size_t field_len;
+  uintmax_t count;
+};
+
+static size_t
+grouped_line_hash (void const *x, size_t table_size)
+{
+  struct grouped_line const *g = x;
+  size_t h = 0;
+
+  /* FNV-1a, folding case when comparisons do.  */
+  for (size_t i = 0; i < g->field_len; i++)
+    {
+      unsigned char c = g->field[i];
+      if (ignore_case)
+        c = tolower (c);
+      h = (h ^ c) * 16777619;
+    }
+
+  return h % table_size;
+}
+
+static bool
+grouped_line_compare (void const *x, void const *y)
+{
+  struct grouped_line const *a = x;
+  struct grouped_line const *b = y;
+  return ! different (a->field, b->field, a->field_len, b->field_len);
+}
+
+/* Like check_file, but group matching lines with a hash table, so
+   they need not be adjacent.  One pass collects the groups; the
+   output then lists them in order of first occurrence, with the first
+   line of each group as its representative.  Memory use is
+   proportional to the number of distinct lines, not to the input.  */
+
+static void
+check_file_unsorted (char const *infile, char const *outfile, char delimiter)
+{
+  struct linebuffer lb;
+  struct grouped_line **group = NULL;
+  size_t n_groups = 0;
+  size_t n_alloc = 0;
+
+  if (! (STREQ (infile, "-") || freopen (infile, "r", stdin)))
+    die (EXIT_FAILURE, errno, "%s", quotef (infile));
+  if (! (STREQ (outfile, "-") || freopen (outfile, "w", stdout)))
+    die (EXIT_FAILURE, errno, "%s", quotef (outfile));
+
+  fadvise (stdin, FADVISE_SEQUENTIAL);
+
+  Hash_table *table = hash_initialize (61, NULL, grouped_line_hash,
+                                       grouped_line_compare, NULL);
+  if (! table)
+    xalloc_die ();
+
+  initbuffer (&lb);
+
+  while (!feof (stdin))
+    {
+      struct grouped_line probe;
+
+      if (read_line (&lb, stdin, delimiter) == 0)
+        break;
+
+      probe.buffer = lb.buffer;
+      probe.length = lb.length;
+      probe.field = find_field (&lb);
+      probe.field_len = MIN (lb.length - 1 - (probe.field - lb.buffer),
+                             check_chars);
+
+      struct grouped_line *g = hash_lookup (table, &probe);
+      if (g)
+        {
+          g->count++;
+          if (g->count == UINTMAX_MAX)
+            die (EXIT_FAILURE, 0, _("too many repeated lines"));
+        }
+      else
+        {
+          g = xmalloc (sizeof *g);
+          g->buffer = xmalloc (lb.length);
+          memcpy (g->buffer, lb.buffer, lb.length);
+          g->length = lb.length;
+          g->field = g->buffer + (probe.field - lb.buffer);
+          g->field_len = probe.field_len;
+          g->count = 1;
+
+          if (hash_insert (table, g) == NULL)
+            xalloc_die ();
+
+          if (n_groups == n_alloc)
+            group = x2nrealloc (group, &n_alloc, sizeof *group);
+          group[n_groups++] = g;
+        }
+    }
+
+  if (ferror (stdin) || fclose (stdin) != 0)
+    die (EXIT_FAILURE, 0, _("error reading %s"), quoteaf (infile));
+
+  for (size_t i = 0; i < n_groups; i++)
+    {
+      struct grouped_line const *g = group[i];
+
+      if (! (g->count == 1 ? output_unique : output_first_repeated))
+        continue;
+
+      char countbuf[INT_BUFSIZE_BOUND (uintmax_t) + 8];
+      size_t countlen = 0;
+      if (countmode == count_occurrences)
+        countlen = snprintf (countbuf, sizeof countbuf,
+                             "%7" PRIuMAX " ", g->count);
+
+      write_output_record (countbuf, countlen, g->buffer, g->length);
+    }
+
+  /* stdout is handled via the atexit-invoked close_stdout function.  */
+
+  for (size_t i = 0; i < n_groups; i++)
+    {
+      free (group[i]->buffer);
+      free (group[i]);
+    }
+  free (group);
+  hash_free (table);
+  free (lb.buffer);
+}
+
+/* Number of index bits and registers in the HyperLogLog sketch: 2^14
+   one-byte registers, 16KiB no matter how large the input.  The
+   standard error of the resulting estimate is about
+   1.04/sqrt(2^14), i.e. under one percent.  */
+enum { HLL_BITS = 14 };
+enum { HLL_M = 1 << HLL_BITS };
+
+/* 64-bit hash of the LEN-byte comparison key KEY, folding case when
+   comparisons do.  FNV-1a, followed by a mixing step so that the
+   high bits, whose leading zero run the sketch measures, are as well
+   distributed as the low ones.  */
+
+static uint64_t
+key_hash64 (char const *key, size_t len)
+{
+  uint64_t h = UINT64_C (14695981039346656037);
+
+  for (size_t i = 0; i < len; i++)
+    {
+      unsigned char c = key[i];
+      if (ignore_case)
+        c = tolower (c);
+      h = (h ^ c) * UINT64_C (1099511628211);
+    }
+
+  h ^= h >> 33;
+  h *= UINT64_C (0xff51afd7ed558ccd);
+  h ^= h >> 33;
+  h *= UINT64_C (0xc4ceb9fe1a85ec53);
+  h ^= h >> 33;
+  return h;
+}
+
+/* Natural logarithm of X, 1 <= X <= HLL_M, for the low-range
+   correction below; written out here so that uniq need not link
+   against libm for one call per run.  Scaling X into [1,2) makes the
+   atanh series converge fast, and the result is far more precise
+   than the estimate it corrects.  */
+
+static double
+log_for_correction (double x)
+{
+  static double const ln2 = 0.693147180559945309;
+  int e = 0;
+
+  while (2 <= x)
+    {
+      x /= 2;
+      e++;
+    }
+
+  double t = (x - 1) / (x + 1);
+  double t2 = t * t;
+  double term = t;
+  double sum = 0;
+  for (int k = 1; k <= 15; k += 2)
+    {
+      sum += term / k;
+      term *= t2;
+    }
+
+  return 2 * sum + e * ln2;
+}
+
+static void
+grouped_line_free (void *x)
+{
+  struct grouped_line *g = x;
+  free (g->buffer);
+  free (g);
+}
+
+/* Print the number of distinct comparison keys in INFILE to OUTFILE,
+   either exactly via a hash set holding one copy of each key, or
+   approximately via a HyperLogLog sketch whose memory use stays at
+   HLL_M bytes however many distinct keys the input holds.  */
+
+static void
+count_distinct_file (char const *infile, char const *outfile, char delimiter)
+{
+  struct linebuffer lb;
+  uintmax_t count = 0;
+  unsigned char *reg = NULL;
+  Hash_table *table = NULL;
+
+  if (! (STREQ (infile, "-") || freopen (infile, "r", stdin)))
+    die (EXIT_FAILURE, errno, "%s", quotef (infile));
+  if (! (STREQ (outfile, "-") || freopen (outfile, "w", stdout)))
+    die (EXIT_FAILURE, errno, "%s", quotef (outfile));
+
+  fadvise (stdin, FADVISE_SEQUENTIAL);
+
+  if (count_distinct == CD_APPROXIMATE)
+    reg = xzalloc (HLL_M);
+  else
+    {
+      table = hash_initialize (61, NULL, grouped_line_hash,
+                               grouped_line_compare, grouped_line_free);
+      if (! table)
+        xalloc_die ();
+    }
+
+  initbuffer (&lb);
+
+  while (!feof (stdin))
+    {
+      if (read_line (&lb, stdin, delimiter) == 0)
+        break;
+
+      char *field = find_field (&lb);
+      size_t field_len = MIN (lb.length - 1 - (field - lb.buffer),
+                              check_chars);
+
+      if (reg)
+        {
+          uint64_t h = key_hash64 (field, field_len);
+          size_t i = h >> (64 - HLL_BITS);
+          unsigned char rank = 1;
+          for (uint64_t w = h << HLL_BITS;
+               rank <= 64 - HLL_BITS && ! (w >> 63); w <<= 1)
+            rank++;
+          if (reg[i] < rank)
+            reg[i] = rank;
+        }
+      else
+        {
+          struct grouped_line probe;
+          probe.field = field;
+          probe.field_len = field_len;
+
+          if (! hash_lookup (table, &probe))
+            {
+              struct grouped_line *g = xmalloc (sizeof *g);
+              g->buffer = xmalloc (field_len + 1);
+              memcpy (g->buffer, field, field_len);
+              g->length = field_len;
+              g->field = g->buffer;
+              g->field_len = field_len;
+              g->count = 1;
+
+              if (hash_insert (table, g) == NULL)
+                xalloc_die ();
+              count++;
+            }
+        }
+    }
+
+  if (ferror (stdin) || fclose (stdin) != 0)
+    die (EXIT_FAILURE, 0, _("error reading %s"), quoteaf (infile));
+
+  if (reg)
+    {
+      /* The standard HyperLogLog estimate, with the linear-counting
+         correction for the low range; the 64-bit hash makes the
+         classical high-range correction unnecessary.  */
+      double sum = 0;
+      size_t zeros = 0;
+      for (size_t i = 0; i < HLL_M; i++)
+        {
+          sum += 1.0 / ((uint64_t) 1 << reg[i]);
+          zeros += reg[i] == 0;
+        }
+      double m = HLL_M;
+      double alpha = 0.7213 / (1 + 1.079 / m);
+      double estimate = alpha * m * m / sum;
+      if (estimate <= 2.5 * m && zeros)
+        estimate = m * log_for_correction (m / zeros);
+      count = estimate + 0.5;
+      free (reg);
+    }
+  else
+    hash_free (table);
+
+  if (length_prefixed)
+    {
+      char countbuf[INT_BUFSIZE_BOUND (uintmax_t)];
+      int countlen = snprintf (countbuf, sizeof countbuf, "%" PRIuMAX, count);
+      char prefix[VARINT_BYTES_BOUND];
+      size_t n = varint_encode (prefix, countlen);
+      fwrite (prefix, sizeof (char), n, stdout);
+      fwrite (countbuf, sizeof (char), countlen, stdout);
+    }
+  else
+    {
+      printf ("%" PRIuMAX, count);
+      putchar (delimiter);
+    }
+
+  free (lb.buffer);
+}
+
 enum Skip_field_option_type
   {
     SFO_NONE,
@@ -493,6 +964,8 @@ main (int argc, char **argv)
 
   atexit (close_stdout);
 
+  init_field_sep ();
+
   skip_chars = 0;
   skip_fields = 0;
   check_chars = SIZE_MAX;
@@ -585,6 +1058,15 @@ main (int argc, char **argv)
           output_option_used = true;
           break;
 
+        case COUNT_DISTINCT_OPTION:
+          if (optarg == NULL)
+            count_distinct = CD_EXACT;
+          else
+            count_distinct = XARGMATCH ("--count-distinct", optarg,
+                                        count_distinct_method_string,
+                                        count_distinct_method_map);
+          break;
+
         case GROUP_OPTION:
           if (optarg == NULL)
             grouping = GM_SEPARATE;
@@ -614,6 +1096,14 @@ main (int argc, char **argv)
           output_option_used = true;
           break;
 
+        case LENGTH_PREFIXED_OPTION:
+          length_prefixed = true;
+          break;
+
+        case UNSORTED_OPTION:
+          unsorted = true;
+          break;
+
         case 'w':
           check_chars = size_opt (optarg,
                                   N_("invalid number of bytes to compare"));
@@ -656,7 +1146,26 @@ main (int argc, char **argv)
       usage (EXIT_FAILURE);
     }
 
-  check_file (file[0], file[1], delimiter);
+  if (unsorted && (output_later_repeated || grouping != GM_NONE))
+    {
+      error (0, 0, _("--unsorted is mutually exclusive with -D/--group"));
+      usage (EXIT_FAILURE);
+    }
+
+  if (count_distinct != CD_NONE
+      && (output_option_used || grouping != GM_NONE || unsorted))
+    {
+      error (0, 0, _("--count-distinct is mutually exclusive with"
+                     " -c/-d/-D/-u/--group/--unsorted"));
+      usage (EXIT_FAILURE);
+    }
+
+  if (count_distinct != CD_NONE)
+    count_distinct_file (file[0], file[1], delimiter);
+  else if (unsorted)
+    check_file_unsorted (file[0], file[1], delimiter);
+  else
+    check_file (file[0], file[1], delimiter);
 
   return EXIT_SUCCESS;
 }
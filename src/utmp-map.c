@@ -0,0 +1,112 @@
+/* Zero-copy utmp reading via mmap.
+   Copyright (C) 2021 Free Software Foundation, Inc.
+
+   This program is free software: you can redistribute it and/or modify
+   it under the terms of the GNU General Public License as published by
+   the Free Software Foundation, either version 3 of the License, or
+   (at your option) any later version.
+
+   This program is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU General Public License for more details.
+
+   You should have received a copy of the GNU General Public License
+   along with this program.  If not, see <https://www.gnu.org/licenses/>.  */
+
+#include <config.h>
+
+#include <signal.h>
+#include <sys/mman.h>
+#include <sys/types.h>
+
+#include "system.h"
+#include "utmp-map.h"
+
+/* The active mapping, if any.  */
+static void *map_base = MAP_FAILED;
+static size_t map_size;
+
+/* Return true if the utmp entry U should be reported, mirroring what
+   read_utmp does for READ_UTMP_CHECK_PIDS: drop user-process entries
+   whose controlling process no longer exists.  */
+
+static bool
+desirable_entry (STRUCT_UTMP const *u, int options)
+{
+  return ! ((options & READ_UTMP_CHECK_PIDS)
+            && IS_USER_PROCESS (u)
+            && 0 < UT_PID (u)
+            && kill (UT_PID (u), 0) < 0 && errno == ESRCH);
+}
+
+int
+utmp_map (char const *filename, size_t *n_entries,
+          STRUCT_UTMP **utmp_buf, int options)
+{
+  if (options & ~READ_UTMP_CHECK_PIDS)
+    return -1;
+
+  int fd = open (filename, O_RDONLY | O_CLOEXEC);
+  if (fd < 0)
+    return -1;
+
+  struct stat st;
+  if (fstat (fd, &st) != 0 || ! S_ISREG (st.st_mode)
+      || st.st_size % sizeof (STRUCT_UTMP) != 0
+      || SIZE_MAX < (uintmax_t) st.st_size)
+    {
+      close (fd);
+      return -1;
+    }
+
+  if (st.st_size == 0)
+    {
+      close (fd);
+      *n_entries = 0;
+      *utmp_buf = NULL;
+      return 0;
+    }
+
+  /* Map privately and writably: pid filtering below may compact the
+     record array, and such stores must not reach the file.  */
+  void *base = mmap (NULL, st.st_size, PROT_READ | PROT_WRITE,
+                     MAP_PRIVATE, fd, 0);
+  close (fd);
+  if (base == MAP_FAILED)
+    return -1;
+
+  map_base = base;
+  map_size = st.st_size;
+
+  STRUCT_UTMP *u = base;
+  size_t n = st.st_size / sizeof *u;
+
+  if (options & READ_UTMP_CHECK_PIDS)
+    {
+      size_t kept = 0;
+      for (size_t i = 0; i < n; i++)
+        if (desirable_entry (&u[i], options))
+          {
+            if (kept != i)
+              u[kept] = u[i];
+            kept++;
+          }
+      n = kept;
+    }
+
+  *n_entries = n;
+  *utmp_buf = u;
+  return 0;
+}
+
+void
+utmp_unmap (void)
+{
+  if (map_base != MAP_FAILED)
+    {
+      munmap (map_base, map_size);
+      map_base = MAP_FAILED;
+      map_size = 0;
+    }
+}
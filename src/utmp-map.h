@@ -0,0 +1,34 @@
+/* Zero-copy utmp reading via mmap.
+   Copyright (C) 2021 Free Software Foundation, Inc.
+
+   This program is free software: you can redistribute it and/or modify
+   it under the terms of the GNU General Public License as published by
+   the Free Software Foundation, either version 3 of the License, or
+   (at your option) any later version.
+
+   This program is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU General Public License for more details.
+
+   You should have received a copy of the GNU General Public License
+   along with this program.  If not, see <https://www.gnu.org/licenses/>.  */
+
+#ifndef UTMP_MAP_H
+# define UTMP_MAP_H
+
+# include "readutmp.h"
+
+/* Map the utmp database FILENAME and present its records in place,
+   setting *N_ENTRIES and *UTMP_BUF.  OPTIONS is as for read_utmp;
+   only READ_UTMP_CHECK_PIDS is supported.  Return 0 upon success.
+   Return nonzero if the file cannot be mapped or does not look like a
+   raw record array, in which case the caller should fall back to
+   read_utmp.  The entries remain valid until utmp_unmap.  */
+int utmp_map (char const *filename, size_t *n_entries,
+              STRUCT_UTMP **utmp_buf, int options);
+
+/* Release the mapping established by a successful utmp_map.  */
+void utmp_unmap (void);
+
+#endif
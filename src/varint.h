@@ -0,0 +1,79 @@
+/* Variable-length record length prefixes
+   Copyright (C) 2026 Free Software Foundation, Inc.
+
+   This program is free software: you can redistribute it and/or modify
+   it under the terms of the GNU General Public License as published by
+   the Free Software Foundation, either version 3 of the License, or
+   (at your option) any later version.
+
+   This program is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU General Public License for more details.
+
+   You should have received a copy of the GNU General Public License
+   along with this program.  If not, see <https://www.gnu.org/licenses/>.  */
+
+/* A length-prefixed record is a byte count followed by that many
+   payload bytes.  The count is encoded base 128, little endian, seven
+   bits per byte, with the high bit set on every byte but the last, so
+   counts below 128 cost a single byte and the payload may contain any
+   byte value, including NUL and newline.  */
+
+#ifndef VARINT_H
+# define VARINT_H 1
+
+/* An upper bound on the bytes in the encoding of a uintmax_t.  */
+enum { VARINT_BYTES_BOUND = (sizeof (uintmax_t) * CHAR_BIT + 6) / 7 };
+
+/* Encode VALUE into BUF, which must have room for VARINT_BYTES_BOUND
+   bytes.  Return the number of bytes used.  */
+
+static inline size_t
+varint_encode (char *buf, uintmax_t value)
+{
+  size_t i = 0;
+
+  while (0x7f < value)
+    {
+      buf[i++] = (value & 0x7f) | 0x80;
+      value >>= 7;
+    }
+  buf[i++] = value;
+  return i;
+}
+
+/* Decode the encoding at the start of the AVAIL bytes at BUF into
+   *VALUE.  Return the number of bytes consumed; 0 if the encoding
+   continues past the available bytes, or SIZE_MAX if it does not fit
+   in a uintmax_t.  */
+
+static inline size_t
+varint_decode (char const *buf, size_t avail, uintmax_t *value)
+{
+  uintmax_t v = 0;
+  int shift = 0;
+
+  for (size_t i = 0; i < avail; i++)
+    {
+      unsigned char b = buf[i];
+      uintmax_t chunk = b & 0x7f;
+
+      if ((int) (sizeof v * CHAR_BIT) <= shift
+          || chunk >> 1 >> (sizeof v * CHAR_BIT - 1 - shift))
+        return SIZE_MAX;
+      v |= chunk << shift;
+
+      if (! (b & 0x80))
+        {
+          *value = v;
+          return i + 1;
+        }
+
+      shift += 7;
+    }
+
+  return 0;
+}
+
+#endif
@@ -22,21 +22,25 @@
 #include <stdio.h>
 #include <assert.h>
 #include <getopt.h>
+#include <pthread.h>
 #include <sys/types.h>
 #include <wchar.h>
 #include <wctype.h>
 
 #include "system.h"
 #include "argv-iter.h"
+#include "dec-input.h"
 #include "die.h"
 #include "error.h"
 #include "fadvise.h"
+#include "linescan.h"
 #include "mbchar.h"
 #include "physmem.h"
 #include "readtokens0.h"
 #include "safe-read.h"
 #include "stat-size.h"
 #include "xbinary-io.h"
+#include "xdectoint.h"
 
 #if !defined iswspace && !HAVE_ISWSPACE
 # define iswspace(wc) \
@@ -77,6 +81,30 @@ static size_t page_size;
 /* Enable to _not_ treat non breaking space as a word separator.  */
 static bool posixly_correct;
 
+/* If true, filter compressed inputs, recognized by their magic
+   bytes, through the matching decompressor (--decompress).  */
+static bool decompress_input;
+
+/* Maximum number of threads counting the lines of one file, or
+   counting whole files concurrently.  */
+static size_t nthreads = 1;
+
+/* True when whole files are being distributed across threads, in
+   which case each file is counted by a single thread.  */
+static bool file_pool_active;
+
+/* The counts gathered by wc() for one input, printed and added to the
+   totals by the main thread so that output stays in input order.  */
+struct wc_result
+{
+  bool counted;		/* wc() ran; the counts below are valid.  */
+  uintmax_t lines;
+  uintmax_t words;
+  uintmax_t chars;
+  uintmax_t bytes;
+  uintmax_t linelength;
+};
+
 /* The result of calling fstat or stat on a file descriptor or file.  */
 struct fstatus
 {
@@ -92,7 +120,9 @@ struct fstatus
    non-character as a pseudo short option, starting with CHAR_MAX + 1.  */
 enum
 {
-  FILES0_FROM_OPTION = CHAR_MAX + 1
+  DECOMPRESS_OPTION = CHAR_MAX + 1,
+  FILES0_FROM_OPTION,
+  THREADS_OPTION
 };
 
 static struct option const longopts[] =
@@ -101,8 +131,10 @@ static struct option const longopts[] =
   {"chars", no_argument, NULL, 'm'},
   {"lines", no_argument, NULL, 'l'},
   {"words", no_argument, NULL, 'w'},
+  {"decompress", no_argument, NULL, DECOMPRESS_OPTION},
   {"files0-from", required_argument, NULL, FILES0_FROM_OPTION},
   {"max-line-length", no_argument, NULL, 'L'},
+  {"threads", required_argument, NULL, THREADS_OPTION},
   {GETOPT_HELP_OPTION_DECL},
   {GETOPT_VERSION_OPTION_DECL},
   {NULL, 0, NULL, 0}
@@ -137,10 +169,15 @@ the following order: newline, word, character, byte, maximum line length.\n\
   -l, --lines            print the newline counts\n\
 "), stdout);
       fputs (_("\
+      --decompress       filter inputs recognized as compressed by their\n\
+                           magic bytes through the matching decompressor\n\
       --files0-from=F    read input from the files specified by\n\
                            NUL-terminated names in file F;\n\
                            If F is - then read names from standard input\n\
   -L, --max-line-length  print the maximum display width\n\
+      --threads=N        use up to N threads: count multiple file\n\
+                           operands concurrently, or the lines of a\n\
+                           single regular file in concurrent chunks\n\
   -w, --words            print the word counts\n\
 "), stdout);
       fputs (HELP_OPTION_DESCRIPTION, stdout);
@@ -165,6 +202,47 @@ isnbspace (int c)
   return iswnbspace (btowc (c));
 }
 
+#if MB_LEN_MAX > 1
+/* Classification of single-byte characters in the multibyte loop.
+   Bytes outside the basic character set get MB_CLASS_DECODE and are
+   fed to mbrtowc; everything else is handled without decoding.  */
+enum
+{
+  MB_CLASS_DECODE,	/* Possibly the start of a multibyte sequence.  */
+  MB_CLASS_WORD,	/* Printable and not white space.  */
+  MB_CLASS_SEP,		/* White space other than newline.  */
+  MB_CLASS_NEWLINE,	/* Newline: a separator that ends a line.  */
+  MB_CLASS_OTHER	/* Counts as a character, nothing more.  */
+};
+
+static signed char mb_class[UCHAR_MAX + 1];
+
+/* Fill in MB_CLASS, mirroring exactly how the character switch in
+   wc() treats each single-byte character.  */
+static void
+init_mb_class (void)
+{
+  for (int c = 0; c <= UCHAR_MAX; c++)
+    {
+      int mbc = MB_CLASS_DECODE;
+      if (c < 0x80 && is_basic (c))
+        {
+          if (c == '\n')
+            mbc = MB_CLASS_NEWLINE;
+          else if (c == '\r' || c == '\f' || c == '\t' || c == ' '
+                   || c == '\v')
+            mbc = MB_CLASS_SEP;
+          else if (isprint (c))
+            mbc = (isspace (c) || isnbspace (c)
+                   ? MB_CLASS_SEP : MB_CLASS_WORD);
+          else
+            mbc = MB_CLASS_OTHER;
+        }
+      mb_class[c] = mbc;
+    }
+}
+#endif
+
 /* FILE is the name of the file (or NULL for standard input)
    associated with the specified counters.  */
 static void
@@ -208,12 +286,126 @@ write_counts (uintmax_t lines,
   putchar ('\n');
 }
 
+/* Size of the file ranges claimed by each --threads worker.  */
+enum { PARALLEL_CHUNK_SIZE = 32 * 1024 * 1024 };
+
+/* State shared by the threads counting the lines of one file.  */
+struct lines_pool
+{
+  pthread_mutex_t mutex;	/* Guards NEXT and the totals.  */
+  int fd;			/* The file, read with pread.  */
+  off_t next;			/* Start of the next unclaimed range.  */
+  off_t end;			/* End of the region to count.  */
+  uintmax_t lines;
+  uintmax_t bytes;
+  bool ok;			/* Cleared on read failure.  */
+  int err;			/* errno of the first failed read.  */
+};
+
+/* Count the lines of successive PARALLEL_CHUNK_SIZE ranges of the
+   pool's file until none remain, adding to the pool's totals.  */
+static void *
+wc_lines_thread (void *arg)
+{
+  struct lines_pool *pool = arg;
+  char buf[BUFFER_SIZE];
+  bool long_lines = false;
+
+  while (true)
+    {
+      pthread_mutex_lock (&pool->mutex);
+      bool stop = ! pool->ok;
+      off_t start = pool->next;
+      off_t end = MIN (start + PARALLEL_CHUNK_SIZE, pool->end);
+      pool->next = end;
+      pthread_mutex_unlock (&pool->mutex);
+      if (stop || end <= start)
+        break;
+
+      uintmax_t lines = 0;
+      uintmax_t bytes = 0;
+      off_t pos = start;
+      while (pos < end)
+        {
+          size_t to_read = MIN (BUFFER_SIZE, end - pos);
+          ssize_t bytes_read = pread (pool->fd, buf, to_read, pos);
+          if (bytes_read < 0)
+            {
+              if (errno == EINTR)
+                continue;
+              pthread_mutex_lock (&pool->mutex);
+              if (pool->ok)
+                {
+                  pool->ok = false;
+                  pool->err = errno;
+                }
+              pthread_mutex_unlock (&pool->mutex);
+              break;
+            }
+          if (bytes_read == 0)
+            break;		/* The file shrank.  */
+
+          bytes += bytes_read;
+          lines += count_delims (buf, bytes_read, '\n', &long_lines);
+          pos += bytes_read;
+        }
+
+      pthread_mutex_lock (&pool->mutex);
+      pool->lines += lines;
+      pool->bytes += bytes;
+      pthread_mutex_unlock (&pool->mutex);
+    }
+
+  return NULL;
+}
+
+/* Count the lines and bytes in the range [FROM, END) of the regular
+   file FILE open on FD, with up to NTHREADS threads reading disjoint
+   ranges concurrently, and add them to *LINES and *BYTES.  Return
+   true if successful; print a diagnostic and return false upon read
+   error.  */
+static bool
+wc_lines_parallel (int fd, char const *file, off_t from, off_t end,
+                   uintmax_t *lines, uintmax_t *bytes)
+{
+  struct lines_pool pool = { PTHREAD_MUTEX_INITIALIZER, fd, from, end,
+                             0, 0, true, 0 };
+
+  uintmax_t n_chunks = (end - from - 1) / PARALLEL_CHUNK_SIZE + 1;
+  size_t nworkers = MIN (nthreads, n_chunks);
+  pthread_t *threads = xnmalloc (nworkers - 1, sizeof *threads);
+  size_t started = 0;
+
+  /* This thread is a worker too; if a thread cannot be created,
+     its share is simply picked up by the others.  */
+  for (size_t i = 0; i < nworkers - 1; i++)
+    {
+      if (pthread_create (&threads[i], NULL, wc_lines_thread, &pool) != 0)
+        break;
+      started++;
+    }
+
+  wc_lines_thread (&pool);
+
+  for (size_t i = 0; i < started; i++)
+    pthread_join (threads[i], NULL);
+  free (threads);
+
+  if (! pool.ok)
+    error (0, pool.err, "%s", quotef (file));
+
+  *lines += pool.lines;
+  *bytes += pool.bytes;
+  return pool.ok;
+}
+
 /* Count words.  FILE_X is the name of the file (or NULL for standard
    input) that is open on descriptor FD.  *FSTATUS is its status.
    CURRENT_POS is the current file offset if known, negative if unknown.
-   Return true if successful.  */
+   Store the counts in *RESULT.  Return true if successful.  */
 static bool
-wc (int fd, char const *file_x, struct fstatus *fstatus, off_t current_pos)
+wc (int fd, char const *file_x, struct fstatus *fstatus, off_t current_pos,
+    struct wc_result *result)
 {
   bool ok = true;
   char buf[BUFFER_SIZE + 1];
@@ -313,7 +505,34 @@ wc (int fd, char const *file_x, struct fstatus *fstatus, off_t current_pos)
       /* Use a separate loop when counting only lines or lines and bytes --
          but not chars or words.  */
       bool long_lines = false;
-      while ((bytes_read = safe_read (fd, buf, BUFFER_SIZE)) > 0)
+
+      /* With --threads, split a regular file of known size into
+         ranges counted concurrently.  The sequential loop below then
+         picks up anything appended after the size was read.  */
+      if (1 < nthreads && ! file_pool_active)
+        {
+          if (0 < fstatus->failed)
+            fstatus->failed = fstat (fd, &fstatus->st);
+          if (! fstatus->failed && S_ISREG (fstatus->st.st_mode))
+            {
+              if (current_pos < 0)
+                current_pos = lseek (fd, 0, SEEK_CUR);
+              off_t end_pos = fstatus->st.st_size;
+              if (0 <= current_pos && current_pos < end_pos)
+                {
+                  if (! wc_lines_parallel (fd, file, current_pos, end_pos,
+                                           &lines, &bytes))
+                    ok = false;
+                  else if (lseek (fd, end_pos, SEEK_SET) < 0)
+                    {
+                      error (0, errno, "%s", quotef (file));
+                      ok = false;
+                    }
+                }
+            }
+        }
+
+      while (ok && (bytes_read = safe_read (fd, buf, BUFFER_SIZE)) > 0)
         {
           if (bytes_read == SAFE_READ_ERROR)
             {
@@ -323,37 +542,7 @@ wc (int fd, char const *file_x, struct fstatus *fstatus, off_t current_pos)
             }
 
           bytes += bytes_read;
-
-          char *p = buf;
-          char *end = p + bytes_read;
-          uintmax_t plines = lines;
-
-          if (! long_lines)
-            {
-              /* Avoid function call overhead for shorter lines.  */
-              while (p != end)
-                lines += *p++ == '\n';
-            }
-          else
-            {
-              /* memchr is more efficient with longer lines.  */
-              while ((p = memchr (p, '\n', end - p)))
-                {
-                  ++p;
-                  ++lines;
-                }
-            }
-
-          /* If the average line length in the block is >= 15, then use
-             memchr for the next block, where system specific optimizations
-             may outweigh function call overhead.
-             FIXME: This line length was determined in 2015, on both
-             x86_64 and ppc64, but it's worth re-evaluating in future with
-             newer compilers, CPUs, or memchr() implementations etc.  */
-          if (lines - plines <= bytes_read / 15)
-            long_lines = true;
-          else
-            long_lines = false;
+          lines += count_delims (buf, bytes_read, '\n', &long_lines);
         }
     }
 #if MB_LEN_MAX > 1
@@ -395,6 +584,38 @@ wc (int fd, char const *file_x, struct fstatus *fstatus, off_t current_pos)
           bytes_read += prev;
           do
             {
+              if (!in_shift && !print_linelength)
+                {
+                  /* Consume runs of single-byte characters using the
+                     class table; typical UTF-8 text rarely leaves this
+                     loop.  Line lengths need wcwidth() per character,
+                     so -L disables it.  */
+                  while (bytes_read > 0)
+                    {
+                      int mbc = mb_class[to_uchar (*p)];
+                      if (mbc == MB_CLASS_DECODE)
+                        break;
+                      size_t run = 1;
+                      while (run < bytes_read
+                             && mb_class[to_uchar (p[run])] == mbc)
+                        run++;
+                      if (mbc == MB_CLASS_WORD)
+                        in_word = true;
+                      else if (mbc != MB_CLASS_OTHER)
+                        {
+                          if (mbc == MB_CLASS_NEWLINE)
+                            lines += run;
+                          words += in_word;
+                          in_word = false;
+                        }
+                      p += run;
+                      bytes_read -= run;
+                      chars += run;
+                    }
+                  if (bytes_read == 0)
+                    break;
+                }
+
               wchar_t wide_char;
               size_t n;
               bool wide = true;
@@ -574,29 +795,106 @@ wc (int fd, char const *file_x, struct fstatus *fstatus, off_t current_pos)
   if (count_chars < print_chars)
     chars = bytes;
 
-  write_counts (lines, words, chars, bytes, linelength, file_x);
-  total_lines += lines;
-  total_words += words;
-  total_chars += chars;
-  total_bytes += bytes;
-  if (linelength > max_line_length)
-    max_line_length = linelength;
+  result->counted = true;
+  result->lines = lines;
+  result->words = words;
+  result->chars = chars;
+  result->bytes = bytes;
+  result->linelength = linelength;
 
   return ok;
 }
 
+/* The directory containing the most recently opened file, kept open
+   so that successive operands naming files in one directory (the
+   common shape of a --files0-from manifest) resolve their shared
+   prefix only once.  Each thread keeps its own cache.  */
+struct dir_cache
+{
+  char *name;			/* Directory part, or NULL if empty.  */
+  size_t len;
+  int fd;
+};
+
+#define DIR_CACHE_INIT { NULL, 0, -1 }
+
+static void
+dir_cache_close (struct dir_cache *dc)
+{
+  if (dc->name)
+    {
+      close (dc->fd);
+      free (dc->name);
+      dc->name = NULL;
+      dc->fd = -1;
+    }
+}
+
+/* Open FILE for reading as open would, going through the cache *DC
+   (which may be NULL) when FILE has a directory part.  */
+static int
+dir_cache_open (struct dir_cache *dc, char const *file)
+{
+  char const *base = strrchr (file, '/');
+  if (! dc || ! base || base == file || ! base[1])
+    return open (file, O_RDONLY | O_BINARY);
+
+  size_t dirlen = base - file;
+  if (! (dc->name && dc->len == dirlen
+         && memcmp (dc->name, file, dirlen) == 0))
+    {
+      char *dir = xmalloc (dirlen + 1);
+      memcpy (dir, file, dirlen);
+      dir[dirlen] = '\0';
+      int dir_fd = open (dir, O_RDONLY | O_DIRECTORY);
+      if (dir_fd < 0)
+        {
+          /* Let the plain open produce the diagnostic errno.  */
+          free (dir);
+          return open (file, O_RDONLY | O_BINARY);
+        }
+      dir_cache_close (dc);
+      dc->name = dir;
+      dc->len = dirlen;
+      dc->fd = dir_fd;
+    }
+  return openat (dc->fd, base + 1, O_RDONLY | O_BINARY);
+}
+
 static bool
-wc_file (char const *file, struct fstatus *fstatus)
+wc_file (char const *file, struct fstatus *fstatus,
+         struct dir_cache *dc, struct wc_result *result)
 {
   if (! file || STREQ (file, "-"))
     {
       have_read_stdin = true;
       xset_binary_mode (STDIN_FILENO, O_BINARY);
-      return wc (STDIN_FILENO, file, fstatus, -1);
+      int fd = STDIN_FILENO;
+      if (decompress_input)
+        fd = dec_input_fd (fd, file ? file : "-", EXIT_FAILURE);
+      if (fd != STDIN_FILENO)
+        {
+          /* Count the decompressed bytes, not the stored ones.  */
+          struct fstatus decstatus = { .failed = 1 };
+          bool ok = wc (fd, file, &decstatus, -1, result);
+          if (close (fd) != 0)
+            {
+              error (0, errno, "%s", quotef (file ? file : "-"));
+              ok = false;
+            }
+          if (! dec_input_reap (fd))
+            {
+              error (0, 0, _("%s: decompression failed"),
+                     quotef (file ? file : "-"));
+              ok = false;
+            }
+          return ok;
+        }
+      return wc (STDIN_FILENO, file, fstatus, -1, result);
     }
   else
     {
-      int fd = open (file, O_RDONLY | O_BINARY);
+      int fd = dir_cache_open (dc, file);
       if (fd == -1)
         {
           error (0, errno, "%s", quotef (file));
@@ -604,17 +902,126 @@ wc_file (char const *file, struct fstatus *fstatus)
         }
       else
         {
-          bool ok = wc (fd, file, fstatus, 0);
+          off_t current_pos = 0;
+          struct fstatus decstatus = { .failed = 1 };
+          if (decompress_input)
+            {
+              int dfd = dec_input_fd (fd, file, EXIT_FAILURE);
+              if (dfd != fd)
+                {
+                  /* Count the decompressed bytes, not the stored
+                     ones.  */
+                  close (fd);
+                  fd = dfd;
+                  fstatus = &decstatus;
+                  current_pos = -1;
+                }
+            }
+          bool ok = wc (fd, file, fstatus, current_pos, result);
           if (close (fd) != 0)
             {
               error (0, errno, "%s", quotef (file));
               return false;
             }
+          if (! dec_input_reap (fd))
+            {
+              error (0, 0, _("%s: decompression failed"), quotef (file));
+              return false;
+            }
           return ok;
         }
     }
 }
 
+/* Print RESULT for FILE and add it to the grand totals.  */
+static void
+write_result (struct wc_result const *result, char const *file)
+{
+  write_counts (result->lines, result->words, result->chars,
+                result->bytes, result->linelength, file);
+  total_lines += result->lines;
+  total_words += result->words;
+  total_chars += result->chars;
+  total_bytes += result->bytes;
+  if (max_line_length < result->linelength)
+    max_line_length = result->linelength;
+}
+
+/* A pool of threads counting whole files concurrently.  */
+struct file_pool
+{
+  pthread_mutex_t mutex;	/* Protects NEXT.  */
+  char *const *files;		/* The file name operands.  */
+  struct fstatus *fstatus;	/* Their statuses.  */
+  struct wc_result *results;	/* Per-file counts.  */
+  bool *file_ok;		/* Per-file success.  */
+  size_t nfiles;
+  size_t next;			/* Next file index to claim.  */
+};
+
+static void *
+wc_files_thread (void *arg)
+{
+  struct file_pool *pool = arg;
+  struct dir_cache dc = DIR_CACHE_INIT;
+
+  while (true)
+    {
+      pthread_mutex_lock (&pool->mutex);
+      size_t i = pool->next++;
+      pthread_mutex_unlock (&pool->mutex);
+      if (pool->nfiles <= i)
+        break;
+
+      /* Standard input and zero-length names are left uncounted here;
+         the main thread deals with them in input order.  */
+      char const *file = pool->files[i];
+      if (! file || ! file[0] || STREQ (file, "-"))
+        continue;
+
+      pool->file_ok[i] = wc_file (file, &pool->fstatus[i], &dc,
+                                  &pool->results[i]);
+    }
+
+  dir_cache_close (&dc);
+  return NULL;
+}
+
+/* Count the NFILES files in FILES with up to nthreads threads, one
+   file per thread, recording counts and status per file.  Store the
+   per-file success flags in *FILE_OK and return the per-file counts;
+   entries whose COUNTED member is false were not processed.  */
+static struct wc_result *
+wc_files_parallel (char *const *files, size_t nfiles,
+                   struct fstatus *fstatus, bool **file_ok)
+{
+  struct file_pool pool = { PTHREAD_MUTEX_INITIALIZER, files, fstatus,
+                            xcalloc (nfiles, sizeof (struct wc_result)),
+                            xcalloc (nfiles, sizeof (bool)), nfiles, 0 };
+  size_t nworkers = MIN (nthreads, nfiles);
+  pthread_t *threads = xnmalloc (nworkers - 1, sizeof *threads);
+  size_t started = 0;
+
+  file_pool_active = true;
+  for (size_t t = 0; t < nworkers - 1; t++)
+    {
+      /* If a thread cannot be created, proceed with fewer.  */
+      if (pthread_create (&threads[t], NULL, wc_files_thread, &pool) != 0)
+        break;
+      started++;
+    }
+
+  /* This thread is a worker too.  */
+  wc_files_thread (&pool);
+
+  for (size_t t = 0; t < started; t++)
+    pthread_join (threads[t], NULL);
+  free (threads);
+
+  *file_ok = pool.file_ok;
+  return pool.results;
+}
+
 /* Return the file status for the NFILES files addressed by FILE.
    Optimize the case where only one number is printed, for just one
    file; in that case we can use a print width of 1, so we don't need
@@ -729,10 +1136,19 @@ main (int argc, char **argv)
         print_linelength = true;
         break;
 
+      case DECOMPRESS_OPTION:
+        decompress_input = true;
+        break;
+
       case FILES0_FROM_OPTION:
         files_from = optarg;
         break;
 
+      case THREADS_OPTION:
+        nthreads = xdectoumax (optarg, 1, SIZE_MAX, "",
+                               _("invalid number of threads"), 0);
+        break;
+
       case_GETOPT_HELP_CHAR;
 
       case_GETOPT_VERSION_CHAR (PROGRAM_NAME, AUTHORS);
@@ -745,12 +1161,23 @@ main (int argc, char **argv)
          || print_linelength))
     print_lines = print_words = print_bytes = true;
 
+#if MB_LEN_MAX > 1
+  /* The single-byte classifier depends only on the locale and on
+     whether -L was given; build it before any threads start.  */
+  if (MB_CUR_MAX > 1 && ! print_linelength)
+    init_mb_class ();
+#endif
+
   bool read_tokens = false;
   struct argv_iterator *ai;
   if (files_from)
     {
       FILE *stream;
 
+      /* A large manifest means many short result lines; give stdout a
+         buffer that flushes far less often than the stdio default.  */
+      setvbuf (stdout, NULL, _IOFBF, 64 * 1024);
+
       /* When using --files0-from=F, you may not specify any files
          on the command-line.  */
       if (optind < argc)
@@ -808,7 +1235,16 @@ main (int argc, char **argv)
   fstatus = get_input_fstatus (nfiles, files);
   number_width = compute_number_width (nfiles, fstatus);
 
+  /* With --threads and several operands, count whole files
+     concurrently up front; the loop below prints the results (and
+     counts anything the workers left alone) in input order.  */
+  struct wc_result *results = NULL;
+  bool *results_ok = NULL;
+  if (1 < nthreads && 1 < nfiles)
+    results = wc_files_parallel (files, nfiles, fstatus, &results_ok);
+
   ok = true;
+  struct dir_cache dc = DIR_CACHE_INIT;
   for (int i = 0; /* */; i++)
     {
       bool skip_file = false;
@@ -863,19 +1299,35 @@ main (int argc, char **argv)
 
       if (skip_file)
         ok = false;
+      else if (results && results[i].counted)
+        {
+          ok &= results_ok[i];
+          write_result (&results[i], file_name);
+        }
       else
-        ok &= wc_file (file_name, &fstatus[nfiles ? i : 0]);
+        {
+          struct wc_result result = { 0, };
+          ok &= wc_file (file_name, &fstatus[nfiles ? i : 0], &dc, &result);
+          if (result.counted)
+            write_result (&result, file_name);
+        }
 
       if (! nfiles)
         fstatus[0].failed = 1;
     }
  argv_iter_done:
+  dir_cache_close (&dc);
 
   /* No arguments on the command line is fine.  That means read from stdin.
      However, no arguments on the --files0-from input stream is an error
      means don't read anything.  */
   if (ok && !files_from && argv_iter_n_args (ai) == 0)
-    ok &= wc_file (NULL, &fstatus[0]);
+    {
+      struct wc_result result = { 0, };
+      ok &= wc_file (NULL, &fstatus[0], NULL, &result);
+      if (result.counted)
+        write_result (&result, NULL);
+    }
 
   if (read_tokens)
     readtokens0_free (&tok);
@@ -886,6 +1338,8 @@ main (int argc, char **argv)
 
   argv_iter_free (ai);
 
+  free (results);
+  free (results_ok);
   free (fstatus);
 
   if (have_read_stdin && close (STDIN_FILENO) != 0)
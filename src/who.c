@@ -38,6 +38,7 @@
 #include "error.h"
 #include "hard-locale.h"
 #include "quote.h"
+#include "utmp-map.h"
 
 #ifdef TTY_GROUP_NAME
 # include <grp.h>
@@ -623,7 +624,11 @@ who (char const *filename, int options)
   size_t n_users;
   STRUCT_UTMP *utmp_buf;
 
-  if (read_utmp (filename, &n_users, &utmp_buf, options) != 0)
+  /* Prefer presenting the records straight from an mmap of the
+     database; fall back to read_utmp's read-and-copy when the file
+     cannot be mapped as a raw record array.  */
+  bool mapped = utmp_map (filename, &n_users, &utmp_buf, options) == 0;
+  if (! mapped && read_utmp (filename, &n_users, &utmp_buf, options) != 0)
     die (EXIT_FAILURE, errno, "%s", quotef (filename));
 
   if (short_list)
@@ -631,7 +636,10 @@ who (char const *filename, int options)
   else
     scan_entries (n_users, utmp_buf);
 
-  free (utmp_buf);
+  if (mapped)
+    utmp_unmap ();
+  else
+    free (utmp_buf);
 }
 
 void
@@ -25,6 +25,7 @@
 #include "error.h"
 #include "full-write.h"
 #include "long-options.h"
+#include "repeat-fill.h"
 
 /* The official name of this program (e.g., no 'g' prefix).  */
 #define PROGRAM_NAME "yes"
@@ -90,10 +91,12 @@ main (int argc, char **argv)
     }
   while (++operandp < operand_lim);
 
-  /* Improve performance by using a buffer size greater than BUFSIZ / 2.  */
-  if (bufalloc <= BUFSIZ / 2)
+  /* Improve performance by using a buffer sized for the output pipe
+     or device, rather than BUFSIZ.  */
+  size_t fill_size = repeat_fill_bufsize (STDOUT_FILENO);
+  if (bufalloc <= fill_size / 2)
     {
-      bufalloc = BUFSIZ;
+      bufalloc = fill_size;
       reuse_operand_strings = false;
     }
 
@@ -115,12 +118,7 @@ main (int argc, char **argv)
 
   /* If a larger buffer was allocated, fill it by repeating the buffer
      contents.  */
-  size_t copysize = bufused;
-  for (size_t copies = bufalloc / copysize; --copies; )
-    {
-      memcpy (buf + bufused, buf, copysize);
-      bufused += copysize;
-    }
+  bufused = repeat_fill (buf, bufused, bufalloc);
 
   /* Repeatedly output the buffer until there is a write error; then fail.  */
   while (full_write (STDOUT_FILENO, buf, bufused) == bufused)
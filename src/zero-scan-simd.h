@@ -0,0 +1,25 @@
+/* AVX2 kernel for zero-run detection
+   Copyright (C) 2026 Free Software Foundation, Inc.
+
+   This program is free software: you can redistribute it and/or modify
+   it under the terms of the GNU General Public License as published by
+   the Free Software Foundation, either version 3 of the License, or
+   (at your option) any later version.
+
+   This program is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU General Public License for more details.
+
+   You should have received a copy of the GNU General Public License
+   along with this program.  If not, see <https://www.gnu.org/licenses/>.  */
+
+#ifndef COREUTILS_ZERO_SCAN_SIMD_H
+#define COREUTILS_ZERO_SCAN_SIMD_H
+
+/* Return whether the LENGTH bytes at BUF are all NUL, checking with
+   AVX2 loads.  The caller must only call this when the CPU supports
+   AVX2.  */
+bool is_nul_avx2 (void const *buf, size_t length);
+
+#endif
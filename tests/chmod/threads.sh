@@ -0,0 +1,51 @@
+#!/bin/sh
+# Test chmod --threads
+
+# Copyright (C) 2026 Free Software Foundation, Inc.
+
+# This program is free software: you can redistribute it and/or modify
+# it under the terms of the GNU General Public License as published by
+# the Free Software Foundation, either version 3 of the License, or
+# (at your option) any later version.
+
+# This program is distributed in the hope that it will be useful,
+# but WITHOUT ANY WARRANTY; without even the implied warranty of
+# MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+# GNU General Public License for more details.
+
+# You should have received a copy of the GNU General Public License
+# along with this program.  If not, see <https://www.gnu.org/licenses/>.
+
+. "${srcdir=.}/tests/init.sh"; path_prepend_ ./src
+print_ver_ chmod
+
+# A recursive change over a small tree must match the serial engine.
+mkdir -p t/a/b t/a/c t/d || framework_failure_
+for f in t/f1 t/a/f2 t/a/b/f3 t/a/b/f4 t/a/c/f5 t/d/f6; do
+  touch $f || framework_failure_
+done
+
+chmod -R --threads=4 g-rwx,o-rwx t || fail=1
+for f in t/f1 t/a/f2 t/a/b/f3 t/a/b/f4 t/a/c/f5 t/d/f6; do
+  case $(ls -l $f) in -rw-------*) ;; *) fail=1;; esac
+done
+for d in t t/a t/a/b t/a/c t/d; do
+  case $(ls -ld $d) in drwx------*) ;; *) fail=1;; esac
+done
+
+# Plain operands, concurrently.
+chmod --threads=4 a+r t/f1 t/a/f2 t/a/b/f3 || fail=1
+case $(ls -l t/a/b/f3) in -rw-r--r--*) ;; *) fail=1;; esac
+
+# -v must report one line per file, in walk order.
+chmod -v --threads=4 u+x t/f1 t/a/f2 > out || fail=1
+test "$(wc -l < out)" = 2 || fail=1
+grep 'f1' out || fail=1
+
+# A missing operand must still be diagnosed, and the exit status set.
+returns_ 1 chmod --threads=4 a+r t/f1 t/missing t/a/f2 2>err || fail=1
+grep 'missing' err || fail=1
+
+returns_ 1 chmod --threads=0 a+r t/f1 2>/dev/null || fail=1
+
+Exit $fail
@@ -0,0 +1,49 @@
+#!/bin/sh
+# Test chown --threads
+
+# Copyright (C) 2026 Free Software Foundation, Inc.
+
+# This program is free software: you can redistribute it and/or modify
+# it under the terms of the GNU General Public License as published by
+# the Free Software Foundation, either version 3 of the License, or
+# (at your option) any later version.
+
+# This program is distributed in the hope that it will be useful,
+# but WITHOUT ANY WARRANTY; without even the implied warranty of
+# MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+# GNU General Public License for more details.
+
+# You should have received a copy of the GNU General Public License
+# along with this program.  If not, see <https://www.gnu.org/licenses/>.
+
+. "${srcdir=.}/tests/init.sh"; path_prepend_ ./src
+print_ver_ chown
+
+uid=$(id -u) || framework_failure_
+gid=$(id -g) || framework_failure_
+
+# Chowning to oneself is always permitted, so a recursive run
+# exercises the full parallel path without privileges.
+mkdir -p t/a/b t/c || framework_failure_
+for f in t/f1 t/a/f2 t/a/b/f3 t/c/f4; do
+  touch $f || framework_failure_
+done
+
+chown -R --threads=4 $uid:$gid t || fail=1
+chgrp -R --threads=4 $gid t || fail=1
+
+# -v must report one line per file.
+chown -v --threads=4 $uid t/f1 t/a/f2 > out || fail=1
+test "$(wc -l < out)" = 2 || fail=1
+
+# --from that matches nothing must leave the files alone but succeed.
+chown --threads=4 --from=$uid:$gid $uid:$gid t/f1 t/c/f4 || fail=1
+
+# A missing operand must still be diagnosed, and the exit status set.
+returns_ 1 chown --threads=4 $uid t/f1 t/missing 2>err || fail=1
+grep 'missing' err || fail=1
+
+returns_ 1 chown --threads=0 $uid t/f1 2>/dev/null || fail=1
+returns_ 1 chgrp --threads=0 $gid t/f1 2>/dev/null || fail=1
+
+Exit $fail
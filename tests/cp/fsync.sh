@@ -0,0 +1,43 @@
+#!/bin/sh
+# Ensure that cp --fsync and install --fsync copy files intact.
+
+# Copyright (C) 2021 Free Software Foundation, Inc.
+
+# This program is free software: you can redistribute it and/or modify
+# it under the terms of the GNU General Public License as published by
+# the Free Software Foundation, either version 3 of the License, or
+# (at your option) any later version.
+
+# This program is distributed in the hope that it will be useful,
+# but WITHOUT ANY WARRANTY; without even the implied warranty of
+# MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+# GNU General Public License for more details.
+
+# You should have received a copy of the GNU General Public License
+# along with this program.  If not, see <https://www.gnu.org/licenses/>.
+
+. "${srcdir=.}/tests/init.sh"; path_prepend_ ./src
+print_ver_ cp ginstall
+
+mkdir src || framework_failure_
+# Enough files that the batched fsync path is flushed mid-run,
+# not only at exit.
+for i in $(seq 100); do
+  echo data-$i > src/f$i || framework_failure_
+done
+
+cp -R --fsync src dst || fail=1
+diff -r src dst || fail=1
+
+# --fsync composes with --parallel.
+cp -R --fsync --parallel=4 src dst2 || fail=1
+diff -r src dst2 || fail=1
+
+ginstall --fsync src/f1 inst1 || fail=1
+compare src/f1 inst1 || fail=1
+
+mkdir instdir || framework_failure_
+ginstall --fsync -t instdir src/f* || fail=1
+diff -r src instdir || fail=1
+
+Exit $fail
@@ -0,0 +1,57 @@
+#!/bin/sh
+# Test cp --parallel copies trees correctly
+
+# Copyright (C) 2021 Free Software Foundation, Inc.
+
+# This program is free software: you can redistribute it and/or modify
+# it under the terms of the GNU General Public License as published by
+# the Free Software Foundation, either version 3 of the License, or
+# (at your option) any later version.
+
+# This program is distributed in the hope that it will be useful,
+# but WITHOUT ANY WARRANTY; without even the implied warranty of
+# MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+# GNU General Public License for more details.
+
+# You should have received a copy of the GNU General Public License
+# along with this program.  If not, see <https://www.gnu.org/licenses/>.
+
+. "${srcdir=.}/tests/init.sh"; path_prepend_ ./src
+print_ver_ cp
+
+# A tree with many files per directory, plus entries the worker pool
+# must leave to the sequential path.
+mkdir -p a/sub1 a/sub2/sub3 || framework_failure_
+for i in $(seq 50); do
+  echo data-$i > a/f$i || framework_failure_
+  echo sub-$i > a/sub1/f$i || framework_failure_
+done
+echo deep > a/sub2/sub3/f || framework_failure_
+ln -s f1 a/slink || framework_failure_
+ln a/f1 a/hardlink || framework_failure_
+
+cp -R --parallel=4 a b || fail=1
+
+# The copy must be indistinguishable from a sequential one,
+# except that the hard link is split (as with plain cp -R).
+for f in a/f* a/sub1/f* a/sub2/sub3/f; do
+  compare $f b/${f#a/} || fail=1
+done
+test "$(readlink b/slink)" = f1 || fail=1
+
+# --preserve=links must still hook up hard links.
+rm -Rf b || framework_failure_
+cp -R --parallel=4 --preserve=links a b || fail=1
+test b/f1 -ef b/hardlink || fail=1
+
+# --parallel=0 is rejected.
+returns_ 1 cp -R --parallel=0 a c || fail=1
+
+# With no count, --parallel defaults to the number of processors.
+rm -Rf b || framework_failure_
+cp -R --parallel a b || fail=1
+for f in a/f* a/sub1/f* a/sub2/sub3/f; do
+  compare $f b/${f#a/} || fail=1
+done
+
+Exit $fail
@@ -0,0 +1,54 @@
+#!/bin/sh
+# Ensure dd handles the 'async' flag
+
+# Copyright (C) 2026 Free Software Foundation, Inc.
+
+# This program is free software: you can redistribute it and/or modify
+# it under the terms of the GNU General Public License as published by
+# the Free Software Foundation, either version 3 of the License, or
+# (at your option) any later version.
+
+# This program is distributed in the hope that it will be useful,
+# but WITHOUT ANY WARRANTY; without even the implied warranty of
+# MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+# GNU General Public License for more details.
+
+# You should have received a copy of the GNU General Public License
+# along with this program.  If not, see <https://www.gnu.org/licenses/>.
+
+. "${srcdir=.}/tests/init.sh"; path_prepend_ ./src
+print_ver_ dd
+
+# async is built only where POSIX AIO is available
+if ! dd oflag=async if=/dev/null of=ofile 2>err; then
+  grep 'invalid output flag' err || framework_failure_
+  skip_ 'this system lacks POSIX AIO support'
+fi
+
+# async makes sense only for output
+returns_ 1 dd iflag=async if=/dev/null 2>/dev/null || fail=1
+
+# Several full blocks plus a partial final block.
+seq 100000 > in || framework_failure_
+
+dd if=in of=out bs=64K oflag=async || fail=1
+cmp in out || fail=1
+
+# Leading all-NUL blocks exercise the conv=sparse interaction.
+{ dd if=/dev/zero bs=64K count=2 2>/dev/null; cat in; } > in2 \
+  || framework_failure_
+rm -f out
+dd if=in2 of=out bs=64K oflag=async conv=sparse || fail=1
+cmp in2 out || fail=1
+
+# seek= positions the asynchronous writes too
+rm -f out
+dd if=in of=out bs=4K seek=3 oflag=async conv=fdatasync || fail=1
+{ dd if=/dev/zero bs=4K count=3 2>/dev/null; cat in; } > expected \
+  || framework_failure_
+cmp expected out || fail=1
+
+# Writes to a non seekable output fall back to being synchronous
+dd if=in bs=64K oflag=async | cmp in - || fail=1
+
+Exit $fail
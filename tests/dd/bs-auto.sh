@@ -0,0 +1,42 @@
+#!/bin/sh
+# Ensure dd handles bs=auto
+
+# Copyright (C) 2026 Free Software Foundation, Inc.
+
+# This program is free software: you can redistribute it and/or modify
+# it under the terms of the GNU General Public License as published by
+# the Free Software Foundation, either version 3 of the License, or
+# (at your option) any later version.
+
+# This program is distributed in the hope that it will be useful,
+# but WITHOUT ANY WARRANTY; without even the implied warranty of
+# MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+# GNU General Public License for more details.
+
+# You should have received a copy of the GNU General Public License
+# along with this program.  If not, see <https://www.gnu.org/licenses/>.
+
+. "${srcdir=.}/tests/init.sh"; path_prepend_ ./src
+print_ver_ dd
+
+seq 10000 > in || framework_failure_
+
+# Copies are unaffected by the chosen block size.
+dd if=in of=out bs=auto status=none || fail=1
+cmp in out || fail=1
+
+# The chosen size is larger than the 512-byte default,
+# so this input fits in a single partial record.
+dd if=in of=/dev/null bs=auto 2>stats || fail=1
+grep '^0+1 records in' stats || { cat stats; fail=1; }
+
+# A later bs= overrides bs=auto, and vice versa.
+dd if=in of=/dev/null bs=auto bs=512 2>stats || fail=1
+grep '^95+1 records in' stats || { cat stats; fail=1; }
+dd if=in of=/dev/null bs=512 bs=auto 2>stats || fail=1
+grep '^0+1 records in' stats || { cat stats; fail=1; }
+
+# Only the exact word 'auto' is accepted.
+returns_ 1 dd if=in of=out bs=autox 2>/dev/null || fail=1
+
+Exit $fail
@@ -0,0 +1,48 @@
+#!/bin/sh
+# Ensure dd reads sparse files correctly while skipping their holes
+
+# Copyright (C) 2026 Free Software Foundation, Inc.
+
+# This program is free software: you can redistribute it and/or modify
+# it under the terms of the GNU General Public License as published by
+# the Free Software Foundation, either version 3 of the License, or
+# (at your option) any later version.
+
+# This program is distributed in the hope that it will be useful,
+# but WITHOUT ANY WARRANTY; without even the implied warranty of
+# MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+# GNU General Public License for more details.
+
+# You should have received a copy of the GNU General Public License
+# along with this program.  If not, see <https://www.gnu.org/licenses/>.
+
+. "${srcdir=.}/tests/init.sh"; path_prepend_ ./src
+print_ver_ dd
+
+# Leading hole, data, interior hole, data, trailing hole.
+seq 1000 > data || framework_failure_
+truncate -s 300K in || framework_failure_
+dd if=data of=in bs=1 seek=100K conv=notrunc status=none \
+  || framework_failure_
+dd if=data of=in bs=1 seek=200K conv=notrunc status=none \
+  || framework_failure_
+
+# The copied stream must be identical whether or not the holes
+# were skipped, for both aligned and unaligned block sizes.
+for bs in 512 64K 1000; do
+  rm -f out
+  dd if=in of=out bs=$bs status=none || fail=1
+  cmp in out || fail=1
+done
+
+# skip= starting inside a hole
+dd if=in bs=1K skip=50 status=none > out || fail=1
+tail -c +51201 in > expected || framework_failure_
+cmp expected out || fail=1
+
+# A file that is one big hole
+truncate -s 1M allhole || framework_failure_
+dd if=allhole of=out bs=64K status=none || fail=1
+cmp allhole out || fail=1
+
+Exit $fail
@@ -0,0 +1,47 @@
+#!/bin/sh
+# Check the telemetry=FD machine-readable records
+
+# Copyright (C) 2021 Free Software Foundation, Inc.
+
+# This program is free software: you can redistribute it and/or modify
+# it under the terms of the GNU General Public License as published by
+# the Free Software Foundation, either version 3 of the License, or
+# (at your option) any later version.
+
+# This program is distributed in the hope that it will be useful,
+# but WITHOUT ANY WARRANTY; without even the implied warranty of
+# MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+# GNU General Public License for more details.
+
+# You should have received a copy of the GNU General Public License
+# along with this program.  If not, see <https://www.gnu.org/licenses/>.
+
+. "${srcdir=.}/tests/init.sh"; path_prepend_ ./src
+print_ver_ dd
+
+truncate -s 64K in || framework_failure_
+
+# A summary record is always emitted, and the copy is unaffected.
+dd if=in of=out telemetry=3 3>tele || fail=1
+compare in out || fail=1
+grep '"event":"summary"' tele || fail=1
+grep '"bytes":65536' tele || fail=1
+grep '"read_seconds":' tele || fail=1
+grep '"write_seconds":' tele || fail=1
+
+# Each record is one JSON object per line.
+test "$(grep -c '^{.*}$' tele)" = "$(wc -l < tele)" || fail=1
+
+# conv statistics are included.
+printf 'hello\nbye\n' | dd conv=block cbs=3 telemetry=3 3>tele2 \
+  >/dev/null 2>/dev/null || fail=1
+grep '"truncated":1' tele2 || fail=1
+
+# An unwritable descriptor is diagnosed.
+returns_ 1 dd if=in of=out telemetry=9 9>&- 2>err || fail=1
+grep 'telemetry' err || fail=1
+
+# interval= rejects zero.
+returns_ 1 dd if=in of=out interval=0 2>/dev/null || fail=1
+
+Exit $fail
@@ -0,0 +1,38 @@
+#!/bin/sh
+# Ensure df --threads reports the same file systems as the serial code
+
+# Copyright (C) 2026 Free Software Foundation, Inc.
+
+# This program is free software: you can redistribute it and/or modify
+# it under the terms of the GNU General Public License as published by
+# the Free Software Foundation, either version 3 of the License, or
+# (at your option) any later version.
+
+# This program is distributed in the hope that it will be useful,
+# but WITHOUT ANY WARRANTY; without even the implied warranty of
+# MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+# GNU General Public License for more details.
+
+# You should have received a copy of the GNU General Public License
+# along with this program.  If not, see <https://www.gnu.org/licenses/>.
+
+. "${srcdir=.}/tests/init.sh"; path_prepend_ ./src
+print_ver_ df
+
+df --output=target > exp || skip_ "cannot get mount list"
+df --threads=8 --output=target > out || fail=1
+compare exp out || fail=1
+
+# Also with entries that are normally filtered
+df -a --output=target > exp || skip_ "cannot get full mount list"
+df -a --threads=8 --output=target > out || fail=1
+compare exp out || fail=1
+
+# The file argument path is unaffected by --threads
+df --output=target . > exp || skip_ "cannot get info for '.'"
+df --threads=8 --output=target . > out || fail=1
+compare exp out || fail=1
+
+returns_ 1 df --threads=0 2>/dev/null || fail=1
+
+Exit $fail
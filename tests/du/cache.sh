@@ -0,0 +1,79 @@
+#!/bin/sh
+# Ensure that du --cache output matches an uncached run.
+
+# Copyright (C) 2021 Free Software Foundation, Inc.
+
+# This program is free software: you can redistribute it and/or modify
+# it under the terms of the GNU General Public License as published by
+# the Free Software Foundation, either version 3 of the License, or
+# (at your option) any later version.
+
+# This program is distributed in the hope that it will be useful,
+# but WITHOUT ANY WARRANTY; without even the implied warranty of
+# MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+# GNU General Public License for more details.
+
+# You should have received a copy of the GNU General Public License
+# along with this program.  If not, see <https://www.gnu.org/licenses/>.
+
+. "${srcdir=.}/tests/init.sh"; path_prepend_ ./src
+print_ver_ du
+
+mkdir -p t/a/deep t/b t/c || framework_failure_
+printf %4096s x > t/f || framework_failure_
+printf %4096s x > t/a/f1 || framework_failure_
+printf %4096s x > t/a/deep/f2 || framework_failure_
+printf %4096s x > t/b/f3 || framework_failure_
+
+# Backdate the directories so that later modifications are guaranteed
+# to change their timestamps, even with coarse-grained file systems.
+find t -type d -exec touch -d 2020-01-01 {} + || framework_failure_
+
+# A cold run builds the index; a warm run uses it.  One index must
+# serve runs with differing output options.
+for opts in '' '-s' '-S' '--inodes' '-b --time'; do
+  du $opts t > exp || fail=1
+  du --cache=idx $opts t > out || fail=1
+  compare exp out || fail=1
+  du --cache=idx $opts t > out || fail=1
+  compare exp out || fail=1
+done
+test -s idx || fail=1
+
+# Creating a file changes its directory's timestamps, so the change
+# must be noticed by the next cached run.
+printf %4096s x > t/a/deep/f4 || framework_failure_
+du t > exp || fail=1
+du --cache=idx t > out || fail=1
+compare exp out || fail=1
+
+# Directories containing files with multiple hard links are never
+# cached, so such files are still counted only once.
+ln t/f t/c/link1 || framework_failure_
+find t -type d -exec touch -d 2020-01-02 {} + || framework_failure_
+du -s t > exp || fail=1
+du --cache=idx -s t > out || fail=1
+compare exp out || fail=1
+du --cache=idx -s t > out || fail=1
+compare exp out || fail=1
+
+# An unrecognized index file is diagnosed and rebuilt.
+echo garbage > bad || framework_failure_
+du --cache=bad -s t > out 2>err || fail=1
+compare exp out || fail=1
+grep 'unrecognized' err || fail=1
+du --cache=bad -s t > out 2>err || fail=1
+compare exp out || fail=1
+compare /dev/null err || fail=1
+
+# The index may not be combined with options that would poison it.
+returns_ 1 du --cache=idx -L t || fail=1
+returns_ 1 du --cache=idx --exclude=f1 t || fail=1
+
+# With multiple operands the index is not consulted, but results must
+# still be correct.
+du -s t/f t t/f > exp || fail=1
+du --cache=idx -s t/f t t/f > out || fail=1
+compare exp out || fail=1
+
+Exit $fail
@@ -0,0 +1,44 @@
+#!/bin/sh
+# Ensure that --inode-sort changes no results of du, chmod, or rm.
+
+# Copyright (C) 2021 Free Software Foundation, Inc.
+
+# This program is free software: you can redistribute it and/or modify
+# it under the terms of the GNU General Public License as published by
+# the Free Software Foundation, either version 3 of the License, or
+# (at your option) any later version.
+
+# This program is distributed in the hope that it will be useful,
+# but WITHOUT ANY WARRANTY; without even the implied warranty of
+# MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+# GNU General Public License for more details.
+
+# You should have received a copy of the GNU General Public License
+# along with this program.  If not, see <https://www.gnu.org/licenses/>.
+
+. "${srcdir=.}/tests/init.sh"; path_prepend_ ./src
+print_ver_ du chmod rm
+
+mkdir -p t/d1 t/d2 || framework_failure_
+for i in 1 2 3 4 5 6 7 8 9; do
+  printf %2048s x > t/d1/f$i || framework_failure_
+  printf %2048s x > t/d2/f$i || framework_failure_
+done
+
+# du must report the same entries and sizes regardless of visit order.
+du -a t | sort > exp || framework_failure_
+du -a --inode-sort t | sort > out || fail=1
+compare exp out || fail=1
+
+# chmod must change every file.
+chmod -R --inode-sort a-w t || fail=1
+for f in t/d1/f* t/d2/f*; do
+  test -w $f && fail=1
+done
+chmod -R --inode-sort u+w t || fail=1
+
+# rm must remove the whole hierarchy.
+rm -r --inode-sort t || fail=1
+test -e t && fail=1
+
+Exit $fail
@@ -0,0 +1,59 @@
+#!/bin/sh
+# Test du --json streaming structured output
+
+# Copyright (C) 2026 Free Software Foundation, Inc.
+
+# This program is free software: you can redistribute it and/or modify
+# it under the terms of the GNU General Public License as published by
+# the Free Software Foundation, either version 3 of the License, or
+# (at your option) any later version.
+
+# This program is distributed in the hope that it will be useful,
+# but WITHOUT ANY WARRANTY; without even the implied warranty of
+# MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+# GNU General Public License for more details.
+
+# You should have received a copy of the GNU General Public License
+# along with this program.  If not, see <https://www.gnu.org/licenses/>.
+
+. "${srcdir=.}/tests/init.sh"; path_prepend_ ./src
+print_ver_ du
+
+mkdir -p d/sub || framework_failure_
+printf hi > d/f || framework_failure_
+printf bye > d/sub/g || framework_failure_
+
+# One object per line, one per directory, in post-order.
+du --json d > out || fail=1
+test "$(wc -l < out)" = 2 || fail=1
+grep -v '^{"path":.*}$' out && fail=1
+sed -n 1p out | grep '"path":"d/sub","size":[0-9]' || fail=1
+sed -n 2p out | grep '"path":"d","size":[0-9]' || fail=1
+
+# Counts are raw bytes: block-size scaling options change nothing.
+du --json -B 1M d > out2 || fail=1
+compare out out2 || fail=1
+
+# --total appends a final {"total":true,...} record without a path.
+du --json -c d > out || fail=1
+test "$(wc -l < out)" = 3 || fail=1
+sed -n '$p' out | grep '^{"total":true,"size":[0-9]*}$' || fail=1
+
+# --inodes switches the count member.
+du --json --inodes d > out || fail=1
+grep '"inodes":' out || fail=1
+grep '"size":' out && fail=1
+
+# --sparseness and --time add their members.
+du --json --sparseness --time d > out || fail=1
+grep '"apparent":[0-9]' out || fail=1
+grep '"time_sec":-*[0-9]*,"time_nsec":[0-9]' out || fail=1
+
+# Quotes, backslashes and control bytes in paths are escaped.
+mkdir 'q"d' 'q\e' "$(printf 'q\tf')" || framework_failure_
+du --json 'q"d' 'q\e' "$(printf 'q\tf')" > out || fail=1
+grep -F '"path":"q\"d"' out || fail=1
+grep -F '"path":"q\\e"' out || fail=1
+grep -F '"path":"q\tf"' out || fail=1
+
+Exit $fail
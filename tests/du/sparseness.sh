@@ -0,0 +1,47 @@
+#!/bin/sh
+# Exercise du --sparseness.
+
+# Copyright (C) 2021 Free Software Foundation, Inc.
+
+# This program is free software: you can redistribute it and/or modify
+# it under the terms of the GNU General Public License as published by
+# the Free Software Foundation, either version 3 of the License, or
+# (at your option) any later version.
+
+# This program is distributed in the hope that it will be useful,
+# but WITHOUT ANY WARRANTY; without even the implied warranty of
+# MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+# GNU General Public License for more details.
+
+# You should have received a copy of the GNU General Public License
+# along with this program.  If not, see <https://www.gnu.org/licenses/>.
+
+. "${srcdir=.}/tests/init.sh"; path_prepend_ ./src
+print_ver_ du
+
+mkdir d || framework_failure_
+truncate -s 1M d/sparse || framework_failure_
+printf %4096s x > d/dense || framework_failure_
+
+# The first column must match plain du.
+du -a d | sort > exp || framework_failure_
+du -a --sparseness d | cut -f1,3 | sort > out || fail=1
+compare exp out || fail=1
+
+# In bytes, the second column is the apparent size.
+du -b -a d | sort > exp || framework_failure_
+du -a --sparseness -B1 d | cut -f2,3 | sort > out || fail=1
+compare exp out || fail=1
+
+# An entirely sparse file shows more apparent bytes than used ones,
+# on file systems that support holes.
+set x $(du --sparseness -B1 d/sparse); shift
+if test "$1" -lt 1048576; then
+  test "$2" = 1048576 || fail=1
+fi
+
+# --inodes wins, with a warning.
+du --inodes --sparseness d 2>err || fail=1
+grep 'ineffective' err || fail=1
+
+Exit $fail
@@ -0,0 +1,57 @@
+#!/bin/sh
+# Ensure that du --threads output matches the serial traversal.
+
+# Copyright (C) 2021 Free Software Foundation, Inc.
+
+# This program is free software: you can redistribute it and/or modify
+# it under the terms of the GNU General Public License as published by
+# the Free Software Foundation, either version 3 of the License, or
+# (at your option) any later version.
+
+# This program is distributed in the hope that it will be useful,
+# but WITHOUT ANY WARRANTY; without even the implied warranty of
+# MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+# GNU General Public License for more details.
+
+# You should have received a copy of the GNU General Public License
+# along with this program.  If not, see <https://www.gnu.org/licenses/>.
+
+. "${srcdir=.}/tests/init.sh"; path_prepend_ ./src
+print_ver_ du
+
+mkdir -p t/a/deep/er t/b t/c || framework_failure_
+printf %4096s x > t/f || framework_failure_
+printf %4096s x > t/a/f1 || framework_failure_
+printf %4096s x > t/a/deep/f2 || framework_failure_
+printf %4096s x > t/b/f3 || framework_failure_
+
+# Each child subtree is walked independently but buffered, so the
+# merged output must match the serial traversal byte for byte.
+for opts in '' '-a' '-s' '--inodes' '-S' '-c' '-b --time'; do
+  du $opts t > exp || fail=1
+  du --threads=4 $opts t > out || fail=1
+  compare exp out || fail=1
+done
+
+# Hard links must still be counted once, even across subtrees.
+ln t/f t/b/link1 || framework_failure_
+ln t/f t/c/link2 || framework_failure_
+du -s t > exp || fail=1
+du --threads=4 -s t > out || fail=1
+compare exp out || fail=1
+
+# Multiple operands, including non-directories.
+du -s t/f t t/f > exp || fail=1
+du --threads=4 -s t/f t t/f > out || fail=1
+compare exp out || fail=1
+
+# An unreadable child directory must still be diagnosed and counted.
+if ! uid_is_privileged_; then
+  mkdir t/b/no-x && chmod a-x t/b/no-x || framework_failure_
+  du -s t 2>/dev/null; serial_status=$?
+  du --threads=4 -s t 2>err; threads_status=$?
+  test $serial_status = $threads_status || fail=1
+  chmod a+x t/b/no-x
+fi
+
+Exit $fail
@@ -212,6 +212,7 @@ all_tests =					\
   tests/rm/interactive-once.sh			\
   tests/rm/ir-1.sh				\
   tests/rm/one-file-system2.sh			\
+  tests/rm/parallel.sh				\
   tests/rm/r-1.sh				\
   tests/rm/r-2.sh				\
   tests/rm/r-3.sh				\
@@ -241,6 +242,7 @@ all_tests =					\
   tests/fmt/goal-option.sh			\
   tests/misc/echo.sh				\
   tests/misc/env.sh				\
+  tests/misc/env-file.sh			\
   tests/misc/env-signal-handler.sh		\
   tests/misc/ptx.pl				\
   tests/misc/test.pl				\
@@ -251,34 +253,45 @@ all_tests =					\
   tests/misc/seq-locale.sh			\
   tests/misc/seq-long-double.sh			\
   tests/misc/seq-precision.sh			\
+  tests/misc/seq-signed.sh			\
   tests/misc/head.pl				\
   tests/misc/head-elide-tail.pl			\
   tests/tail-2/tail-n0f.sh			\
   tests/misc/ls-misc.pl				\
   tests/misc/date.pl				\
   tests/misc/date-next-dow.pl			\
+  tests/misc/ptx-buffer-size.sh			\
   tests/misc/ptx-overrun.sh			\
+  tests/misc/ptx-threads.sh			\
   tests/misc/xstrtol.pl				\
   tests/tail-2/overlay-headers.sh		\
   tests/tail-2/pid.sh				\
   tests/misc/od.pl				\
   tests/misc/od-endian.sh			\
   tests/misc/od-float.sh			\
+  tests/misc/od-threads.sh			\
   tests/misc/mktemp.pl				\
+  tests/misc/mktemp-count.sh			\
   tests/misc/arch.sh				\
   tests/misc/join.pl				\
+  tests/misc/join-multi.sh			\
   tests/pr/pr-tests.pl				\
   tests/misc/pwd-option.sh			\
   tests/misc/chcon-fail.sh			\
   tests/misc/coreutils.sh			\
+  tests/misc/coreutils-server.sh		\
+  tests/misc/coreutils-launch.sh		\
+  tests/misc/coreutils-launch-sandbox.sh	\
   tests/misc/cut.pl				\
   tests/misc/cut-huge-range.sh			\
   tests/misc/wc.pl				\
   tests/misc/wc-files0-from.pl			\
   tests/misc/wc-files0.sh			\
+  tests/misc/wc-mb-words.sh			\
   tests/misc/wc-nbsp.sh				\
   tests/misc/wc-parallel.sh			\
   tests/misc/wc-proc.sh				\
+  tests/misc/wc-threads.sh			\
   tests/misc/cat-E.sh				\
   tests/misc/cat-proc.sh			\
   tests/misc/cat-buf.sh				\
@@ -289,6 +302,7 @@ all_tests =					\
   tests/misc/close-stdout.sh			\
   tests/misc/chroot-fail.sh			\
   tests/misc/cksum.sh				\
+  tests/misc/cksum-server.sh			\
   tests/misc/comm.pl				\
   tests/misc/csplit.sh				\
   tests/misc/csplit-1000.sh			\
@@ -298,6 +312,7 @@ all_tests =					\
   tests/misc/date-debug.sh			\
   tests/misc/date-sec.sh			\
   tests/misc/date-tz.sh				\
+  tests/misc/decompress-input.sh		\
   tests/misc/dircolors.pl			\
   tests/misc/dirname.pl				\
   tests/misc/env-null.sh			\
@@ -308,6 +323,8 @@ all_tests =					\
   tests/misc/expr-multibyte.pl			\
   tests/misc/factor.pl				\
   tests/misc/factor-parallel.sh			\
+  tests/misc/factor-range.sh			\
+  tests/misc/factor-threads.sh			\
   tests/misc/false-status.sh			\
   tests/misc/fold.pl				\
   tests/misc/groups-dash.sh			\
@@ -317,11 +334,14 @@ all_tests =					\
   tests/misc/head-pos.sh			\
   tests/misc/head-write-error.sh		\
   tests/misc/kill.sh				\
+  tests/misc/kill-tree.sh			\
   tests/misc/b2sum.sh				\
   tests/misc/md5sum.pl				\
   tests/misc/md5sum-bsd.sh			\
+  tests/misc/md5sum-cache.sh			\
   tests/misc/md5sum-newline.pl			\
   tests/misc/md5sum-parallel.sh			\
+  tests/misc/md5sum-threads.sh			\
   tests/misc/mknod.sh				\
   tests/misc/nice.sh				\
   tests/misc/nice-fail.sh			\
@@ -346,6 +366,7 @@ all_tests =					\
   tests/misc/pwd-long.sh			\
   tests/misc/readlink-fp-loop.sh		\
   tests/misc/readlink-root.sh			\
+  tests/misc/realpath-files0.sh		\
   tests/misc/realpath.sh			\
   tests/misc/runcon-no-reorder.sh		\
   tests/misc/sha1sum.pl				\
@@ -358,21 +379,27 @@ all_tests =					\
   tests/misc/shred-passes.sh			\
   tests/misc/shred-remove.sh			\
   tests/misc/shred-size.sh			\
+  tests/misc/shred-threads.sh			\
   tests/misc/shuf.sh				\
+  tests/misc/shuf-external.sh			\
   tests/misc/shuf-reservoir.sh			\
   tests/misc/sleep.sh				\
   tests/misc/sort.pl				\
   tests/misc/sort-benchmark-random.sh		\
+  tests/misc/sort-check-state.sh		\
   tests/misc/sort-compress.sh			\
   tests/misc/sort-compress-hang.sh		\
   tests/misc/sort-compress-proc.sh		\
+  tests/misc/sort-compress-temps.sh		\
   tests/misc/sort-continue.sh			\
+  tests/misc/sort-cpu-affinity.sh		\
   tests/misc/sort-debug-keys.sh			\
   tests/misc/sort-debug-warn.sh			\
   tests/misc/sort-discrim.sh			\
   tests/misc/sort-files0-from.pl		\
   tests/misc/sort-float.sh			\
   tests/misc/sort-h-thousands-sep.sh		\
+  tests/misc/sort-hash-unique.sh		\
   tests/misc/sort-merge.pl			\
   tests/misc/sort-merge-fdlimit.sh		\
   tests/misc/sort-month.sh			\
@@ -380,16 +407,21 @@ all_tests =					\
   tests/misc/sort-rand.sh			\
   tests/misc/sort-spinlock-abuse.sh		\
   tests/misc/sort-stale-thread-mem.sh		\
+  tests/misc/length-prefixed.sh			\
+  tests/misc/sort-top.sh			\
   tests/misc/sort-unique.sh			\
   tests/misc/sort-unique-segv.sh		\
   tests/misc/sort-version.sh			\
   tests/misc/sort-NaN-infloop.sh		\
   tests/misc/sort-u-FMR.sh			\
+  tests/misc/sorted-cache.sh			\
   tests/split/filter.sh				\
+  tests/split/filter-jobs.sh			\
   tests/split/suffix-auto-length.sh		\
   tests/split/suffix-length.sh			\
   tests/split/additional-suffix.sh		\
   tests/split/b-chunk.sh			\
+  tests/split/bytes.sh				\
   tests/split/fail.sh				\
   tests/split/lines.sh				\
   tests/split/line-bytes.sh			\
@@ -399,25 +431,31 @@ all_tests =					\
   tests/split/numeric.sh			\
   tests/split/guard-input.sh			\
   tests/misc/stat-birthtime.sh			\
+  tests/misc/stat-files0.sh			\
   tests/misc/stat-fmt.sh			\
   tests/misc/stat-hyphen.sh			\
   tests/misc/stat-mount.sh			\
   tests/misc/stat-nanoseconds.sh		\
   tests/misc/stat-printf.pl			\
   tests/misc/stat-slash.sh			\
+  tests/misc/stats.sh				\
   tests/misc/stdbuf.sh				\
+  tests/misc/stdbuf-native.sh			\
   tests/misc/stty.sh				\
   tests/misc/stty-invalid.sh			\
   tests/misc/stty-pairs.sh			\
   tests/misc/stty-row-col.sh			\
   tests/misc/sum.pl				\
   tests/misc/sum-sysv.sh			\
+  tests/misc/sum-threads.sh			\
   tests/misc/sync.sh				\
   tests/misc/tac.pl				\
   tests/misc/tac-continue.sh			\
   tests/misc/tac-2-nonseekable.sh		\
   tests/misc/tail.pl				\
   tests/misc/tee.sh				\
+  tests/misc/tee-buffered.sh			\
+  tests/misc/tee-pipes.sh			\
   tests/misc/test-N.sh				\
   tests/misc/test-diag.pl			\
   tests/misc/time-style.sh			\
@@ -431,18 +469,22 @@ all_tests =					\
   tests/misc/truncate-dangling-symlink.sh	\
   tests/misc/truncate-dir-fail.sh		\
   tests/misc/truncate-fail-diag.sh		\
+  tests/misc/truncate-fallocate.sh		\
   tests/misc/truncate-fifo.sh			\
   tests/misc/truncate-no-create-missing.sh	\
   tests/misc/truncate-overflow.sh		\
   tests/misc/truncate-parameters.sh		\
   tests/misc/truncate-relative.sh		\
+  tests/misc/truncate-threads.sh		\
   tests/misc/tsort.pl				\
+  tests/misc/tsort-stream.sh			\
   tests/misc/tty.sh				\
   tests/misc/usage_vs_getopt.sh			\
   tests/misc/unexpand.pl			\
   tests/misc/uniq.pl				\
   tests/misc/uniq-perf.sh			\
   tests/misc/uniq-collate.sh			\
+  tests/misc/uniq-count-distinct.sh		\
   tests/misc/xattr.sh				\
   tests/misc/yes.sh				\
   tests/tail-2/wait.sh				\
@@ -457,12 +499,14 @@ all_tests =					\
   tests/chmod/octal.sh				\
   tests/chmod/setgid.sh				\
   tests/chmod/silent.sh				\
+  tests/chmod/threads.sh			\
   tests/chmod/thru-dangling.sh			\
   tests/chmod/umask-x.sh			\
   tests/chmod/usage.sh				\
   tests/chown/deref.sh				\
   tests/chown/preserve-root.sh			\
   tests/chown/separator.sh			\
+  tests/chown/threads.sh			\
   tests/cp/abuse.sh				\
   tests/cp/acl.sh				\
   tests/cp/attr-existing.sh			\
@@ -486,6 +530,7 @@ all_tests =					\
   tests/cp/fiemap-perf.sh			\
   tests/cp/fiemap-2.sh				\
   tests/cp/file-perm-race.sh			\
+  tests/cp/fsync.sh				\
   tests/cp/into-self.sh				\
   tests/cp/link.sh				\
   tests/cp/link-deref.sh			\
@@ -496,6 +541,7 @@ all_tests =					\
   tests/cp/no-deref-link1.sh			\
   tests/cp/no-deref-link2.sh			\
   tests/cp/no-deref-link3.sh			\
+  tests/cp/parallel.sh				\
   tests/cp/parent-perm.sh			\
   tests/cp/parent-perm-race.sh			\
   tests/cp/perm.sh				\
@@ -520,12 +566,15 @@ all_tests =					\
   tests/df/df-P.sh				\
   tests/df/df-output.sh				\
   tests/df/df-symlink.sh			\
+  tests/df/df-threads.sh			\
   tests/df/unreadable.sh			\
   tests/df/total-unprocessed.sh			\
   tests/df/no-mtab-status.sh			\
   tests/df/skip-duplicates.sh			\
   tests/df/skip-rootfs.sh			\
   tests/dd/ascii.sh				\
+  tests/dd/async.sh				\
+  tests/dd/bs-auto.sh				\
   tests/dd/direct.sh				\
   tests/dd/misc.sh				\
   tests/dd/no-allocate.sh			\
@@ -538,15 +587,18 @@ all_tests =					\
   tests/dd/bytes.sh				\
   tests/dd/skip-seek-past-file.sh		\
   tests/dd/sparse.sh				\
+  tests/dd/sparse-read.sh			\
   tests/dd/stderr.sh				\
   tests/dd/unblock.pl				\
   tests/dd/unblock-sync.sh			\
   tests/dd/stats.sh				\
+  tests/dd/telemetry.sh			\
   tests/df/total-verify.sh			\
   tests/du/2g.sh				\
   tests/du/8gb.sh				\
   tests/du/basic.sh				\
   tests/du/bigtime.sh				\
+  tests/du/cache.sh				\
   tests/du/deref.sh				\
   tests/du/deref-args.sh			\
   tests/du/exclude.sh				\
@@ -557,7 +609,9 @@ all_tests =					\
   tests/du/inacc-dest.sh			\
   tests/du/inacc-dir.sh				\
   tests/du/inaccessible-cwd.sh			\
+  tests/du/inode-sort.sh			\
   tests/du/inodes.sh				\
+  tests/du/json.sh				\
   tests/du/long-from-unreadable.sh		\
   tests/du/long-sloop.sh			\
   tests/du/max-depth.sh				\
@@ -567,6 +621,8 @@ all_tests =					\
   tests/du/one-file-system.sh			\
   tests/du/restore-wd.sh			\
   tests/du/slash.sh				\
+  tests/du/sparseness.sh			\
+  tests/du/threads.sh				\
   tests/du/threshold.sh				\
   tests/du/trailing-slash.sh			\
   tests/du/two-args.sh				\
@@ -602,6 +658,7 @@ all_tests =					\
   tests/ls/color-norm.sh			\
   tests/ls/color-term.sh			\
   tests/ls/color-ext.sh				\
+  tests/ls/colordb.sh				\
   tests/ls/dangle.sh				\
   tests/ls/dired.sh				\
   tests/ls/file-type.sh				\
@@ -611,6 +668,7 @@ all_tests =					\
   tests/ls/hex-option.sh			\
   tests/ls/infloop.sh				\
   tests/ls/inode.sh				\
+  tests/ls/json.sh				\
   tests/ls/m-option.sh				\
   tests/ls/w-option.sh				\
   tests/ls/multihardlink.sh			\
@@ -619,6 +677,7 @@ all_tests =					\
   tests/ls/selinux-segfault.sh			\
   tests/ls/quote-align.sh			\
   tests/ls/readdir-mountpoint-inode.sh		\
+  tests/ls/readlink-prefetch.sh		\
   tests/ls/recursive.sh				\
   tests/ls/removed-directory.sh			\
   tests/ls/root-rel-symlink-color.sh		\
@@ -648,6 +707,7 @@ all_tests =					\
   tests/mkdir/restorecon.sh			\
   tests/mkdir/special-1.sh			\
   tests/mkdir/t-slash.sh			\
+  tests/mkdir/threads.sh			\
   tests/mkdir/smack-no-root.sh			\
   tests/mv/acl.sh				\
   tests/mv/atomic.sh				\
@@ -678,6 +738,7 @@ all_tests =					\
   tests/mv/mv-n.sh				\
   tests/mv/mv-special-1.sh			\
   tests/mv/no-target-dir.sh			\
+  tests/mv/parallel.sh				\
   tests/mv/part-fail.sh				\
   tests/mv/part-hardlink.sh			\
   tests/mv/part-rename.sh			\
@@ -718,6 +779,7 @@ all_tests =					\
   tests/touch/not-owner.sh			\
   tests/touch/obsolescent.sh			\
   tests/touch/read-only.sh			\
+  tests/touch/recursive.sh			\
   tests/touch/relative.sh			\
   tests/touch/trailing-slash.sh			\
   $(all_root_tests)
@@ -0,0 +1,59 @@
+#!/bin/sh
+# Exercise the compiled color database: dircolors --compile and
+# the LS_COLORS_DB environment variable of ls.
+
+# Copyright (C) 2026 Free Software Foundation, Inc.
+
+# This program is free software: you can redistribute it and/or modify
+# it under the terms of the GNU General Public License as published by
+# the Free Software Foundation, either version 3 of the License, or
+# (at your option) any later version.
+
+# This program is distributed in the hope that it will be useful,
+# but WITHOUT ANY WARRANTY; without even the implied warranty of
+# MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+# GNU General Public License for more details.
+
+# You should have received a copy of the GNU General Public License
+# along with this program.  If not, see <https://www.gnu.org/licenses/>.
+
+. "${srcdir=.}/tests/init.sh"; path_prepend_ ./src
+print_ver_ ls dircolors
+working_umask_or_skip_
+
+cat > src.dc <<'EOF' || framework_failure_
+TERM *
+EXEC \e[01;32m
+.tar 01;31
+EOF
+
+mkdir d || framework_failure_
+touch d/f.tar d/plain d/exe || framework_failure_
+chmod a+x d/exe || framework_failure_
+
+dircolors --compile=db src.dc || fail=1
+test -s db || fail=1
+
+# The database must colorize exactly as the equivalent LS_COLORS value.
+LS_COLORS='ex=\e[01;32m:*.tar=01;31' ls -U1 --color=always d > exp || fail=1
+LS_COLORS= LS_COLORS_DB=db ls -U1 --color=always d > out 2> err || fail=1
+compare exp out || fail=1
+compare /dev/null err || fail=1
+
+# The database takes precedence over LS_COLORS.
+LS_COLORS='*.tar=01;35' LS_COLORS_DB=db ls -U1 --color=always d > out \
+  || fail=1
+compare exp out || fail=1
+
+# An invalid database is diagnosed, and ls falls back to LS_COLORS.
+echo garbage > bad || framework_failure_
+LS_COLORS='ex=\e[01;32m:*.tar=01;31' LS_COLORS_DB=bad \
+  ls -U1 --color=always d > out 2> err || fail=1
+compare exp out || fail=1
+grep 'invalid color database' err || { cat err; fail=1; }
+
+# --compile may not be combined with the other output selections.
+returns_ 1 dircolors --compile=x -p 2>/dev/null || fail=1
+returns_ 1 dircolors --compile=x -b 2>/dev/null || fail=1
+
+Exit $fail
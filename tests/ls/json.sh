@@ -0,0 +1,65 @@
+#!/bin/sh
+# Test ls --json machine-readable output
+
+# Copyright (C) 2026 Free Software Foundation, Inc.
+
+# This program is free software: you can redistribute it and/or modify
+# it under the terms of the GNU General Public License as published by
+# the Free Software Foundation, either version 3 of the License, or
+# (at your option) any later version.
+
+# This program is distributed in the hope that it will be useful,
+# but WITHOUT ANY WARRANTY; without even the implied warranty of
+# MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+# GNU General Public License for more details.
+
+# You should have received a copy of the GNU General Public License
+# along with this program.  If not, see <https://www.gnu.org/licenses/>.
+
+. "${srcdir=.}/tests/init.sh"; path_prepend_ ./src
+print_ver_ ls
+
+mkdir dir || framework_failure_
+printf hi > dir/file || framework_failure_
+ln -s file dir/link || framework_failure_
+
+# One self-contained object per line: no headers, totals or blank lines.
+ls --json dir > out || fail=1
+test "$(wc -l < out)" = 2 || fail=1
+grep -v '^{"name":.*}$' out && fail=1
+
+# Entries listed from a directory name it in a "dir" member, and the
+# long-format information is carried as raw values.
+grep '"name":"file","dir":"dir","type":"-"' out || fail=1
+grep '"name":"link","dir":"dir","type":"l"' out || fail=1
+grep '"target":"file"' out || fail=1
+grep '"size":2' out || fail=1
+grep '"mode":"' out || fail=1
+grep '"inode":' out || fail=1
+grep '"mtime_sec":' out || fail=1
+
+# Command-line operands carry no "dir" member.
+ls --json dir/file > out || fail=1
+grep '"dir"' out && fail=1
+
+# --json overrides other layout options, in either order.
+ls --json dir > exp || fail=1
+ls -C --json dir > out || fail=1
+compare exp out || fail=1
+ls --json -1 dir > out || fail=1
+compare exp out || fail=1
+
+# -n suppresses the resolved names but keeps the numeric ids.
+ls --json -n dir > out || fail=1
+grep '"owner"' out && fail=1
+grep '"uid":' out || fail=1
+
+# Quotes, backslashes and control bytes in names are escaped; other
+# bytes pass through verbatim.
+touch 'a"b' 'c\d' "$(printf 'e\tf')" || framework_failure_
+ls --json 'a"b' 'c\d' "$(printf 'e\tf')" > out || fail=1
+grep -F '"name":"a\"b"' out || fail=1
+grep -F '"name":"c\\d"' out || fail=1
+grep -F '"name":"e\tf"' out || fail=1
+
+Exit $fail
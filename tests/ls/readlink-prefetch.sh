@@ -0,0 +1,40 @@
+#!/bin/sh
+# Verify that prefetched symlink targets match in large directories.
+
+# Copyright (C) 2026 Free Software Foundation, Inc.
+
+# This program is free software: you can redistribute it and/or modify
+# it under the terms of the GNU General Public License as published by
+# the Free Software Foundation, either version 3 of the License, or
+# (at your option) any later version.
+
+# This program is distributed in the hope that it will be useful,
+# but WITHOUT ANY WARRANTY; without even the implied warranty of
+# MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+# GNU General Public License for more details.
+
+# You should have received a copy of the GNU General Public License
+# along with this program.  If not, see <https://www.gnu.org/licenses/>.
+
+. "${srcdir=.}/tests/init.sh"; path_prepend_ ./src
+print_ver_ ls
+
+# Use enough entries that the prefetching thread pool engages.
+mkdir d || framework_failure_
+i=1
+while test $i -le 120; do
+  ln -s "target/$i" "d/l$i" || framework_failure_
+  printf 'l%d -> target/%d\n' $i $i >> exp-unsorted || framework_failure_
+  i=$(expr $i + 1)
+done
+sort exp-unsorted > exp || framework_failure_
+
+ls -l d | sed -n 's/.* \(l[0-9]* -> .*\)/\1/p' | sort > out || fail=1
+compare exp out || fail=1
+
+# Dangling links are still resolved and marked.
+ln -s no-such d/dangling || framework_failure_
+ls -l d/dangling > out1 || fail=1
+grep 'dangling -> no-such' out1 || { cat out1; fail=1; }
+
+Exit $fail
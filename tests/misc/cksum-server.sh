@@ -0,0 +1,116 @@
+#!/bin/sh
+# Verify the cksum fd-passing server mode
+
+# Copyright (C) 2026 Free Software Foundation, Inc.
+
+# This program is free software: you can redistribute it and/or modify
+# it under the terms of the GNU General Public License as published by
+# the Free Software Foundation, either version 3 of the License, or
+# (at your option) any later version.
+
+# This program is distributed in the hope that it will be useful,
+# but WITHOUT ANY WARRANTY; without even the implied warranty of
+# MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+# GNU General Public License for more details.
+
+# You should have received a copy of the GNU General Public License
+# along with this program.  If not, see <https://www.gnu.org/licenses/>.
+
+. "${srcdir=.}/tests/init.sh"; path_prepend_ ./src
+print_ver_ cksum
+
+# The protocol passes descriptors via SCM_RIGHTS, so...
+python3 -c 'import array, socket' 2>/dev/null \
+  || skip_ 'python3 with socket support not available'
+
+cat <<'EOF' > client.py || framework_failure_
+import array, os, socket, sys
+
+sock_path, mode = sys.argv[1], sys.argv[2]
+files = sys.argv[3:]
+
+s = socket.socket(socket.AF_UNIX, socket.SOCK_STREAM)
+s.connect(sock_path)
+
+def send_request(fds):
+    s.sendmsg([b'x'],
+              [(socket.SOL_SOCKET, socket.SCM_RIGHTS,
+                array.array('i', fds))])
+
+def read_reply():
+    reply = b''
+    while not reply.endswith(b'\n'):
+        c = s.recv(1)
+        if not c:
+            sys.exit(1)
+        reply += c
+    sys.stdout.write(reply.decode())
+
+for name in files:
+    fd = os.open(name, os.O_RDONLY)
+    if mode == 'multifd':
+        # One request descriptor plus surplus ones the server must
+        # close rather than accumulate.
+        extra = [os.open(name, os.O_RDONLY) for _ in range(2)]
+        send_request([fd] + extra)
+        for e in extra:
+            os.close(e)
+    else:
+        send_request([fd])
+    os.close(fd)
+    if mode == 'hangup':
+        sys.exit(0)         # Disconnect without reading the reply.
+    read_reply()
+EOF
+
+cksum --server=srv.sock & server_pid=$!
+cleanup_() { kill $server_pid 2>/dev/null; }
+
+# Wait for the server to bind its socket.
+for i in $(seq 50); do
+  test -S srv.sock && break
+  sleep 0.1 || sleep 1
+done
+test -S srv.sock || framework_failure_ 'server did not bind its socket'
+
+seq 1000 > a || framework_failure_
+printf '' > empty || framework_failure_
+
+# Replies match the command-line mode, over one connection.
+cksum < a > exp1 || framework_failure_
+cksum < empty > exp2 || framework_failure_
+cat exp1 exp2 > exp || framework_failure_
+python3 client.py srv.sock basic a empty > out || fail=1
+compare exp out || fail=1
+
+# A client that disconnects before reading its reply must not kill
+# the server.
+for i in $(seq 10); do
+  python3 client.py srv.sock hangup a || fail=1
+done
+kill -0 $server_pid || fail=1
+python3 client.py srv.sock basic a > out || fail=1
+compare exp1 out || fail=1
+
+# Surplus descriptors in a request are closed, not accumulated: the
+# server's descriptor table must not grow with such requests.
+if test -d /proc/$server_pid/fd; then
+  python3 client.py srv.sock multifd a > out || fail=1
+  nfds_before=$(ls /proc/$server_pid/fd | wc -l)
+  for i in $(seq 20); do
+    python3 client.py srv.sock multifd a > out || fail=1
+  done
+  nfds_after=$(ls /proc/$server_pid/fd | wc -l)
+  # Allow for a connection the server has not yet noticed closing.
+  test "$nfds_after" -le "$((nfds_before + 2))" || fail=1
+  compare exp1 out || fail=1
+fi
+
+# An unreadable descriptor gets an "error" reply, and the connection
+# survives to answer the next request.
+mkdir dir || framework_failure_
+printf 'error\n' > experr || framework_failure_
+python3 client.py srv.sock basic dir > out || fail=1
+compare experr out || fail=1
+
+Exit $fail
@@ -0,0 +1,53 @@
+#!/bin/sh
+# Verify the launcher's --chroot and --context wrapper options
+
+# Copyright (C) 2026 Free Software Foundation, Inc.
+
+# This program is free software: you can redistribute it and/or modify
+# it under the terms of the GNU General Public License as published by
+# the Free Software Foundation, either version 3 of the License, or
+# (at your option) any later version.
+
+# This program is distributed in the hope that it will be useful,
+# but WITHOUT ANY WARRANTY; without even the implied warranty of
+# MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+# GNU General Public License for more details.
+
+# You should have received a copy of the GNU General Public License
+# along with this program.  If not, see <https://www.gnu.org/licenses/>.
+
+
+. "${srcdir=.}/tests/init.sh"; path_prepend_ ./src
+print_ver_ coreutils
+
+test -s "$abs_top_builddir/src/coreutils.h" \
+ || skip_ "multicall binary is disabled"
+
+# An unusable root directory cancels the launch.
+returns_ 125 coreutils --coreutils-launch --chroot=missing true 2>err \
+  || fail=1
+grep 'cannot change root directory' err || fail=1
+
+if test "$(id -u)" = 0; then
+  # The root is changed before the exec, so the program runs inside it.
+  echo / > exp
+  coreutils --coreutils-launch --chroot=/ pwd > out || fail=1
+  compare exp out || fail=1
+else
+  # Without privilege, even a usable root is refused.
+  mkdir newroot || framework_failure_
+  returns_ 125 coreutils --coreutils-launch --chroot=newroot true 2>err \
+    || fail=1
+  grep 'cannot change root directory' err || fail=1
+fi
+
+# --context either takes effect like runcon, or, on a system or build
+# without SELinux support, cancels the launch with a diagnostic.
+ctx=$(id -Z 2>/dev/null) || ctx=system_u:system_r:unconfined_t
+if coreutils --coreutils-launch --context="$ctx" true 2>err; then
+  :
+else
+  grep 'unable to set security context' err || fail=1
+fi
+
+Exit $fail
@@ -0,0 +1,70 @@
+#!/bin/sh
+# Verify the combined launcher mode of the coreutils multicall binary
+
+# Copyright (C) 2026 Free Software Foundation, Inc.
+
+# This program is free software: you can redistribute it and/or modify
+# it under the terms of the GNU General Public License as published by
+# the Free Software Foundation, either version 3 of the License, or
+# (at your option) any later version.
+
+# This program is distributed in the hope that it will be useful,
+# but WITHOUT ANY WARRANTY; without even the implied warranty of
+# MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+# GNU General Public License for more details.
+
+# You should have received a copy of the GNU General Public License
+# along with this program.  If not, see <https://www.gnu.org/licenses/>.
+
+
+. "${srcdir=.}/tests/init.sh"; path_prepend_ ./src
+print_ver_ coreutils
+
+test -s "$abs_top_builddir/src/coreutils.h" \
+ || skip_ "multicall binary is disabled"
+
+# Environment assignments and --unset are applied, like env.
+cat > exp <<\EOF || framework_failure_
+bar
+unset
+EOF
+FOO=old LAUNCH_GONE=x coreutils --coreutils-launch \
+  FOO=bar --unset=LAUNCH_GONE \
+  sh -c 'echo $FOO; echo ${LAUNCH_GONE-unset}' > out || fail=1
+compare exp out || fail=1
+
+# --nice adjusts the niceness, like nice -n.
+base=$(nice) || framework_failure_
+if test "$base" -le 17; then
+  coreutils --coreutils-launch --nice=2 nice > out || fail=1
+  test "$(cat out)" = "$(expr $base + 2)" || fail=1
+fi
+
+# The buffering options set up stdbuf's environment protocol.
+echo L > exp
+coreutils --coreutils-launch --output=L sh -c 'echo $_STDBUF_O' > out \
+  || fail=1
+compare exp out || fail=1
+
+# --nohup leaves SIGHUP ignored in the command.
+echo alive > exp
+coreutils --coreutils-launch --nohup \
+  sh -c 'kill -HUP $$; echo alive' > out 2>/dev/null || fail=1
+compare exp out || fail=1
+
+# -- introduces a program name that looks like an assignment.
+echo ok > exp
+coreutils --coreutils-launch -- sh -c 'echo ok' > out || fail=1
+compare exp out || fail=1
+
+# A missing program and an invalid adjustment cancel the launch.
+returns_ 125 coreutils --coreutils-launch FOO=bar 2>err || fail=1
+grep 'missing program name' err || fail=1
+returns_ 125 coreutils --coreutils-launch --nice=xx true 2>err || fail=1
+grep 'invalid adjustment' err || fail=1
+
+# A program that cannot be found exits with nohup's convention.
+returns_ 127 coreutils --coreutils-launch no_such_prog 2>err || fail=1
+grep 'failed to run command' err || fail=1
+
+Exit $fail
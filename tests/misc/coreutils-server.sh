@@ -0,0 +1,67 @@
+#!/bin/sh
+# Verify the coprocess server mode of the coreutils multicall binary
+
+# Copyright (C) 2026 Free Software Foundation, Inc.
+
+# This program is free software: you can redistribute it and/or modify
+# it under the terms of the GNU General Public License as published by
+# the Free Software Foundation, either version 3 of the License, or
+# (at your option) any later version.
+
+# This program is distributed in the hope that it will be useful,
+# but WITHOUT ANY WARRANTY; without even the implied warranty of
+# MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+# GNU General Public License for more details.
+
+# You should have received a copy of the GNU General Public License
+# along with this program.  If not, see <https://www.gnu.org/licenses/>.
+
+
+. "${srcdir=.}/tests/init.sh"; path_prepend_ ./src
+print_ver_ coreutils
+
+test -s "$abs_top_builddir/src/coreutils.h" \
+ || skip_ "multicall binary is disabled"
+
+coreutils --coreutils-server=srv.sock & server_pid=$!
+cleanup_() { kill $server_pid 2>/dev/null; }
+
+# Wait for the server to bind its socket.
+for i in $(seq 50); do
+  test -S srv.sock && break
+  sleep 0.1 || sleep 1
+done
+test -S srv.sock || framework_failure_ 'server did not bind its socket'
+
+# Arguments and stdout are forwarded.
+echo 'y x' > exp
+coreutils --coreutils-client=srv.sock yes 'y x' | head -n10 | uniq > out \
+  || fail=1
+compare exp out || fail=1
+
+# The client's working directory is forwarded too.
+mkdir sub || framework_failure_
+(cd sub && coreutils --coreutils-client=../srv.sock pwd) > out || fail=1
+case $(cat out) in */sub) ;; *) fail=1;; esac
+
+# Exit status comes back from the worker.
+coreutils --coreutils-client=srv.sock false && fail=1
+
+# Unknown programs are diagnosed, with the status forwarded.
+coreutils --coreutils-client=srv.sock blah 2>err && fail=1
+grep 'unknown program' err || { cat err; fail=1; }
+
+# A second server must not hijack a live socket.
+coreutils --coreutils-server=srv.sock 2>err && fail=1
+grep 'cannot bind' err || { cat err; fail=1; }
+
+# A stale socket left by a dead server is taken over.
+kill $server_pid && wait $server_pid
+test -S srv.sock || framework_failure_
+coreutils --coreutils-server=srv.sock & server_pid=$!
+sleep 0.5
+echo y > exp
+coreutils --coreutils-client=srv.sock yes | head -n1 > out || fail=1
+compare exp out || fail=1
+
+Exit $fail
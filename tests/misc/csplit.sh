@@ -100,4 +100,18 @@ printf 'x%8199s\nx\n%8199s\nx\n' x x > in
 csplit in '/x\{1\}/' '{*}' > /dev/null || fail=1
 cat xx?? | compare - in || fail=1
 
+# Literal patterns (no regexp metacharacters) take a substring-search
+# fast path; ensure they split identically to equivalent regexps,
+# including a pattern containing the delimiter and a repeated one.
+rm -f in xx??
+printf 'a\nMARK\nb\nMARK\nc\n' > in
+csplit in '/MARK/' '{*}' > /dev/null || fail=1
+cat xx?? | compare - in || fail=1
+rm -f xx??
+printf '1\na/b\n2\n' > in
+csplit in '%a/b%1' > /dev/null || fail=1
+printf '2\n' > exp
+compare exp xx00 || fail=1
+rm -f in exp xx??
+
 Exit $fail
@@ -168,6 +168,20 @@ my @Tests =
   ['zerot-4', '-z -d:', '-f1', {IN=>"a:1\0b:2"}, {OUT=>"a\0b\0"}],
   ['zerot-5', '-z -d:', '-f1-', {IN=>"a1:\0:"}, {OUT=>"a1:\0:\0"}],
   ['zerot-6', "-z -d ''", '-f1,2', '--ou=:', {IN=>"a\0b\0"}, {OUT=>"a:b\0"}],
+  # Up to coreutils 9.1 the NUL terminator was omitted here,
+  # though the corresponding newline-delimited output included one.
+  ['zerot-7', '-z -d:', '-f2', {IN=>"a:"}, {OUT=>"\0"}],
+  ['zerot-8', '-z -d:', '-sf1', {IN=>"a:b"}, {OUT=>"a\0"}],
+
+  # Lines longer than the input buffer exercise the block scanner
+  ['bigline-1', '-b100000,200000', {IN=>"x" x 250000 . "\n"}, {OUT=>"xx\n"}],
+  ['bigline-2', '-b1-2,100001', '--output-d=:', {IN=>"a" x 100002 . "\n"},
+   {OUT=>"aa:a\n"}],
+  ['bigline-3', '-b99999-100003', {IN=>"y" x 200000}, {OUT=>"yyyyy\n"}],
+  # Fields spanning input buffer boundaries
+  ['bigfield-1', '-d:', '-f2', {IN=>"a" x 100000 . ":x:y\n"}, {OUT=>"x\n"}],
+  ['bigfield-2', '-s -d:', '-f1', {IN=>"b" x 100000 . ":z\n"},
+   {OUT=>"b" x 100000 . "\n"}],
 
   # New functionality:
   ['out-delim1', '-c1-3,5-', '--output-d=:', {IN=>"abcdefg\n"},
@@ -0,0 +1,61 @@
+#!/bin/sh
+# Test the --decompress option of sort, wc and cut
+
+# Copyright (C) 2021 Free Software Foundation, Inc.
+
+# This program is free software: you can redistribute it and/or modify
+# it under the terms of the GNU General Public License as published by
+# the Free Software Foundation, either version 3 of the License, or
+# (at your option) any later version.
+
+# This program is distributed in the hope that it will be useful,
+# but WITHOUT ANY WARRANTY; without even the implied warranty of
+# MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+# GNU General Public License for more details.
+
+# You should have received a copy of the GNU General Public License
+# along with this program.  If not, see <https://www.gnu.org/licenses/>.
+
+. "${srcdir=.}/tests/init.sh"; path_prepend_ ./src
+print_ver_ sort wc cut
+
+(gzip --version) >/dev/null 2>&1 \
+  || skip_ 'gzip is required for this test'
+
+seq 1000 | shuf > in || framework_failure_
+gzip -c in > in.gz || framework_failure_
+
+# sort reads the decompressed lines.
+sort -n in > exp || framework_failure_
+sort --decompress -n in.gz > out || fail=1
+compare exp out || fail=1
+
+# Uncompressed inputs pass through unchanged, also when mixed
+# with compressed ones.
+sort --decompress -n in > out || fail=1
+compare exp out || fail=1
+sort -n in in > exp2 || framework_failure_
+sort --decompress -n in.gz in > out || fail=1
+compare exp2 out || fail=1
+
+# wc counts the decompressed bytes.
+wc < in > exp || framework_failure_
+wc --decompress in.gz | sed "s/ in.gz//" > out || fail=1
+compare exp out || fail=1
+
+# cut fields come from the decompressed data.
+cut -c1-2 in > exp || framework_failure_
+cut --decompress -c1-2 in.gz > out || fail=1
+compare exp out || fail=1
+
+# Without --decompress the raw bytes are processed.
+wc -c < in.gz > exp || framework_failure_
+wc -c in.gz | sed "s/ in.gz//" > out || fail=1
+compare exp out || fail=1
+
+# A corrupt compressed file is diagnosed as a failure.
+head -c 20 in.gz > bad.gz || framework_failure_
+returns_ 2 sort --decompress -n bad.gz > /dev/null 2>&1 || fail=1
+returns_ 1 wc --decompress bad.gz > /dev/null 2>&1 || fail=1
+
+Exit $fail
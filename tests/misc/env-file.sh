@@ -0,0 +1,53 @@
+#!/bin/sh
+# Test env --env-file.
+
+# Copyright (C) 2026 Free Software Foundation, Inc.
+
+# This program is free software: you can redistribute it and/or modify
+# it under the terms of the GNU General Public License as published by
+# the Free Software Foundation, either version 3 of the License, or
+# (at your option) any later version.
+
+# This program is distributed in the hope that it will be useful,
+# but WITHOUT ANY WARRANTY; without even the implied warranty of
+# MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+# GNU General Public License for more details.
+
+# You should have received a copy of the GNU General Public License
+# along with this program.  If not, see <https://www.gnu.org/licenses/>.
+
+. "${srcdir=.}/tests/init.sh"; path_prepend_ ./src
+print_ver_ env
+
+# Round trip: env --null output is the profile format.
+env -i --null A=1 B='two words' > profile || framework_failure_
+
+env -i --env-file=profile > out || fail=1
+sort out > out-sorted || framework_failure_
+printf '%s\n' 'A=1' 'B=two words' > exp || framework_failure_
+compare exp out-sorted || fail=1
+
+# NAME=VALUE operands override entries from the file.
+env -i --env-file=profile B=3 sh -c 'echo "$A$B"' > out || fail=1
+echo 13 > exp || framework_failure_
+compare exp out || fail=1
+
+# A later file overrides an earlier one.
+printf 'A=2\0' > profile2 || framework_failure_
+env -i --env-file=profile --env-file=profile2 sh -c 'echo "$A"' > out || fail=1
+echo 2 > exp || framework_failure_
+compare exp out || fail=1
+
+# '-' reads the entries from stdin.
+env -i --env-file=- sh -c 'echo "$A"' < profile > out || fail=1
+echo 1 > exp || framework_failure_
+compare exp out || fail=1
+
+# Entries without '=' are diagnosed.
+printf 'NOEQ\0' > badfile || framework_failure_
+returns_ 125 env -i --env-file=badfile || fail=1
+
+# A missing file is diagnosed.
+returns_ 125 env -i --env-file=no-such-file || fail=1
+
+Exit $fail
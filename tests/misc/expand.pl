@@ -167,6 +167,12 @@ my @Tests =
    ['incre9', '--tab=1,2 -t+5',{IN=>"\ta\tb\tc"}, {OUT=>" a     b    c"}],
 
 
+   # Lines longer than the input buffer exercise the run scanner
+   ['long1', '', {IN=>"a" x 100000 . "\tz\n"},
+    {OUT=>"a" x 100000 . " " x 8 . "z\n"}],
+   ['long2', '-i', {IN=>" " x 100000 . "\tb\tz\n"},
+    {OUT=>" " x 100000 . " " x 8 . "b\tz\n"}],
+
    # Test errors
    ['e1', '--tabs="a"', {IN=>''}, {OUT=>''}, {EXIT=>1},
     {ERR => "$prog: tab size contains invalid character(s): 'a'\n"}],
@@ -178,6 +178,28 @@ my @Tests =
      ['bignum-mul', "$big_p1 '*' $big", {OUT => $big_prod}],
      ['bignum-div', "$big_prod / $big", {OUT => $big_p1}],
 
+     # Exercise the boundary where machine arithmetic spills to GMP.
+     ['fix-spill-add', '9223372036854775807 + 1',
+      {OUT => '9223372036854775808'}],
+     ['fix-spill-sub', '-9223372036854775808 - 1',
+      {OUT => '-9223372036854775809'}],
+     ['fix-spill-mul', '4294967296 \* 4294967296',
+      {OUT => '18446744073709551616'}],
+     ['fix-spill-div', '-9223372036854775808 / -1',
+      {OUT => '9223372036854775808'}],
+     ['fix-spill-mod', '-9223372036854775808 % -1', {OUT => '0'}, {EXIT => 1}],
+     ['fix-spill-cmp', '9223372036854775807 \< 9223372036854775808',
+      {OUT => '1'}],
+
+     # Literal ':' patterns bypass the regexp engine; check the
+     # anchored-prefix semantics and the metacharacter boundary.
+     ['fix-lit-1', "abcdef : abc", {OUT => '3'}],
+     ['fix-lit-2', "abc : abcdef", {OUT => '0'}, {EXIT => 1}],
+     ['fix-lit-3', "abc : ''", {OUT => '0'}, {EXIT => 1}],
+     ['fix-lit-4', "'a.c' : a.c", {OUT => '3'}],
+     ['fix-lit-5', "abc : a.c", {OUT => '3'}],
+     ['fix-lit-6', "'a+b' : a+b", {OUT => '3'}],
+
 
      # Test syntax error messages
      ['se0', '9 9',
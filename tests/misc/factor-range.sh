@@ -0,0 +1,50 @@
+#!/bin/sh
+# Ensure the sieve used for runs of consecutive inputs matches
+# factoring each value separately
+
+# Copyright (C) 2026 Free Software Foundation, Inc.
+
+# This program is free software: you can redistribute it and/or modify
+# it under the terms of the GNU General Public License as published by
+# the Free Software Foundation, either version 3 of the License, or
+# (at your option) any later version.
+
+# This program is distributed in the hope that it will be useful,
+# but WITHOUT ANY WARRANTY; without even the implied warranty of
+# MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+# GNU General Public License for more details.
+
+# You should have received a copy of the GNU General Public License
+# along with this program.  If not, see <https://www.gnu.org/licenses/>.
+
+. "${srcdir=.}/tests/init.sh"; path_prepend_ ./src
+print_ver_ factor
+
+# Shuffled input never forms a run, so it exercises the per-value
+# code; sorting both outputs must then give identical results for a
+# run crossing the internal segment size.
+seq 0 3000 > in || framework_failure_
+factor < in > out || fail=1
+shuf in | factor | sort -n > out-shuffled || fail=1
+sort -n out > exp-sorted || framework_failure_
+compare exp-sorted out-shuffled || fail=1
+
+# Runs with values large enough to leave composite residues
+seq 9999999999900 10000000000000 | factor > out-large || fail=1
+for i in $(seq 9999999999900 10000000000000); do factor $i; done > exp-large \
+  || framework_failure_
+compare exp-large out-large || fail=1
+
+# A run broken by other tokens resumes correctly
+printf '20\n21\n22\n8\n23\n24\n25\n' > mixed || framework_failure_
+factor < mixed > out-mixed || fail=1
+for i in 20 21 22 8 23 24 25; do factor $i; done > exp-mixed \
+  || framework_failure_
+compare exp-mixed out-mixed || fail=1
+
+# Command-line operands form runs too
+factor 90 91 92 93 94 95 96 97 98 99 > out-argv || fail=1
+for i in $(seq 90 99); do factor $i; done > exp-argv || framework_failure_
+compare exp-argv out-argv || fail=1
+
+Exit $fail
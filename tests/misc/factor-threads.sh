@@ -0,0 +1,37 @@
+#!/bin/sh
+# Ensure factor --threads finds the same factors as one thread
+
+# Copyright (C) 2026 Free Software Foundation, Inc.
+
+# This program is free software: you can redistribute it and/or modify
+# it under the terms of the GNU General Public License as published by
+# the Free Software Foundation, either version 3 of the License, or
+# (at your option) any later version.
+
+# This program is distributed in the hope that it will be useful,
+# but WITHOUT ANY WARRANTY; without even the implied warranty of
+# MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+# GNU General Public License for more details.
+
+# You should have received a copy of the GNU General Public License
+# along with this program.  If not, see <https://www.gnu.org/licenses/>.
+
+. "${srcdir=.}/tests/init.sh"; path_prepend_ ./src
+print_ver_ factor
+
+# Two-word semiprimes take the racing-cycle path.
+cat > exp <<'EOF' || framework_failure_
+18446744400127067027: 4294967311 4294967357
+147573955003448041259: 8589934693 17179869263
+EOF
+factor --threads=4 18446744400127067027 147573955003448041259 > out || fail=1
+compare exp out || fail=1
+
+# Small and one-word values are unaffected by --threads
+factor 1 2 97 4294967291 18446744073709551557 > exp || framework_failure_
+factor --threads=4 1 2 97 4294967291 18446744073709551557 > out || fail=1
+compare exp out || fail=1
+
+returns_ 1 factor --threads=0 9 2>/dev/null || fail=1
+
+Exit $fail
@@ -61,7 +61,7 @@ if ($ENV{RUN_EXPENSIVE_TESTS})
     # Brute force: use all combinations of file sizes [0..20] and
     # number of bytes to elide [0..20].  For better coverage, recompile
     # head with -DHEAD_TAIL_PIPE_READ_BUFSIZE=4 and
-    # -DHEAD_TAIL_PIPE_BYTECOUNT_THRESHOLD=8
+    # -DHEAD_TAIL_PIPE_SEGMENT_MAX=8
     my $s = "abcdefghijklmnopqrst";
     for my $file_size (0..20)
       {
@@ -0,0 +1,87 @@
+#!/bin/sh
+# Test joining more than two files at once
+
+# Copyright (C) 2026 Free Software Foundation, Inc.
+
+# This program is free software: you can redistribute it and/or modify
+# it under the terms of the GNU General Public License as published by
+# the Free Software Foundation, either version 3 of the License, or
+# (at your option) any later version.
+
+# This program is distributed in the hope that it will be useful,
+# but WITHOUT ANY WARRANTY; without even the implied warranty of
+# MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+# GNU General Public License for more details.
+
+# You should have received a copy of the GNU General Public License
+# along with this program.  If not, see <https://www.gnu.org/licenses/>.
+
+. "${srcdir=.}/tests/init.sh"; path_prepend_ ./src
+print_ver_ join
+
+printf 'a 1\nb 2\nc 3\n' > f1 || framework_failure_
+printf 'a x\nb y\nd z\n' > f2 || framework_failure_
+printf 'a A\nb B\nc C\n' > f3 || framework_failure_
+printf 'a q\nb r\n' > f4 || framework_failure_
+
+# Three files merge-join in one pass; only fully pairable keys print,
+# as the join field followed by the other fields in file order.
+cat > exp <<\EOF || framework_failure_
+a 1 x A
+b 2 y B
+EOF
+join f1 f2 f3 > out || fail=1
+compare exp out || fail=1
+
+# A fourth file narrows and extends the result the same way.
+cat > exp <<\EOF || framework_failure_
+a 1 x A q
+b 2 y B r
+EOF
+join f1 f2 f3 f4 > out || fail=1
+compare exp out || fail=1
+
+# Groups form a cross product, as with two files.
+printf 'a x\na y\nb z\n' > f2dup || framework_failure_
+cat > exp <<\EOF || framework_failure_
+a 1 x A
+a 1 y A
+b 2 z B
+EOF
+join f1 f2dup f3 > out || fail=1
+compare exp out || fail=1
+
+# -j selects the join field for every file.
+printf '1 a\n2 b\n' > g1 || framework_failure_
+printf 'x a\ny b\n' > g2 || framework_failure_
+printf 'A a\nB b\n' > g3 || framework_failure_
+cat > exp <<\EOF || framework_failure_
+a 1 x A
+b 2 y B
+EOF
+join -j 2 g1 g2 g3 > out || fail=1
+compare exp out || fail=1
+
+# Disorder diagnostics name the offending extra file and line.
+printf 'b B\na A\nc C\n' > f3bad || framework_failure_
+returns_ 1 join --check-order f1 f2 f3bad > /dev/null 2>err || fail=1
+grep 'f3bad:2: is not sorted' err || fail=1
+
+# Without --check-order, disorder behind unpairable lines is still
+# diagnosed and makes join fail.
+printf 'a x\nd z\nc w\n' > f2bad || framework_failure_
+returns_ 1 join f1 f2bad f3 > /dev/null 2>err || fail=1
+grep 'f2bad:3: is not sorted' err || fail=1
+grep 'input is not in sorted order' err || fail=1
+
+# Options limited to two-file joins are rejected up front.
+returns_ 1 join --unsorted f1 f2 f3 2>err || fail=1
+grep -- '--unsorted does not support more than two files' err || fail=1
+returns_ 1 join -a1 f1 f2 f3 2>err || fail=1
+grep -- '-a and -v do not support more than two files' err || fail=1
+returns_ 1 join -v2 f1 f2 f3 2>err || fail=1
+grep -- '-a and -v do not support more than two files' err || fail=1
+returns_ 1 join -o 1.2,2.2 f1 f2 f3 2>err || fail=1
+grep -- '-o does not support more than two files' err || fail=1
+
+Exit $fail
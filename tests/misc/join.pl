@@ -302,6 +302,37 @@ my @tv = (
 ['z6', '-z -t ""',
  ["a\n1\n\0", "a\n1\n\0"], "a\n1\n\0"],
 
+# --unsorted: hash join; output follows FILE2 order
+['hash-1', '--unsorted',
+ ["b 1\nc 2\na 3\n", "a Y\nb Z\n"], "a 3 Y\nb 1 Z\n", 0],
+# unpairable FILE1 lines are output last, in input order
+['hash-2', '--unsorted -a1',
+ ["c 2\nb 1\na 3\n", "a Y\nb Z\n"], "a 3 Y\nb 1 Z\nc 2\n", 0],
+# unpairable FILE2 lines are output in place
+['hash-3', '--unsorted -a2',
+ ["b 1\nc 2\na 3\n", "a Y\nd W\nb Z\n"], "a 3 Y\nd W\nb 1 Z\n", 0],
+['hash-4', '--unsorted -v1',
+ ["b 1\nc 2\na 3\n", "a Y\nb Z\n"], "c 2\n", 0],
+['hash-5', '--unsorted -v2',
+ ["b 1\nc 2\na 3\n", "a Y\nd W\nb Z\n"], "d W\n", 0],
+# duplicate keys join in input order on either side
+['hash-6', '--unsorted',
+ ["a 1\nb 2\na 3\n", "a X\n"], "a 1 X\na 3 X\n", 0],
+['hash-7', '--unsorted',
+ ["a 1\n", "a X\na Y\n"], "a 1 X\na 1 Y\n", 0],
+['hash-8', '--unsorted -i',
+ ["A 1\n", "a X\n"], "A 1 X\n", 0],
+['hash-9', '--unsorted --header',
+ ["ID N\n2 B\n1 A\n", "ID C\n1 r\n"], "ID N C\n1 A r\n", 0],
+['hash-10', '--unsorted -a1 -e. -o auto',
+ ["b 1\na 2\nc 3\n", "a X\n"], "a 2 X\nb 1 .\nc 3 .\n", 0],
+['hash-11', '--unsorted -z',
+ ["b\0a\0", "a\0"], "a\0", 0],
+# --check-order contradicts --unsorted
+['hash-12', '--unsorted --check-order',
+ ["a\n", "a\n"], "", 1,
+ "$prog: --check-order is incompatible with --unsorted\n"],
+
 );
 
 # Convert the above old-style test vectors to the newer
@@ -0,0 +1,72 @@
+#!/bin/sh
+# Validate kill --tree
+
+# Copyright (C) 2026 Free Software Foundation, Inc.
+
+# This program is free software: you can redistribute it and/or modify
+# it under the terms of the GNU General Public License as published by
+# the Free Software Foundation, either version 3 of the License, or
+# (at your option) any later version.
+
+# This program is distributed in the hope that it will be useful,
+# but WITHOUT ANY WARRANTY; without even the implied warranty of
+# MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+# GNU General Public License for more details.
+
+# You should have received a copy of the GNU General Public License
+# along with this program.  If not, see <https://www.gnu.org/licenses/>.
+
+. "${srcdir=.}/tests/init.sh"; path_prepend_ ./src
+print_ver_ kill
+
+test -d /proc/self || skip_ 'requires /proc'
+
+# --tree rejects non-positive pids, which name process groups.
+returns_ 1 env kill --tree -0 0 2>err || fail=1
+grep 'process id must be positive with --tree' err || fail=1
+returns_ 1 env kill --tree -0 -- -1 2>err || fail=1
+grep 'process id must be positive with --tree' err || fail=1
+
+# Build a three-deep process tree: a shell, a child shell, and a
+# grandchild sleep, recording the pids of the lower two.
+sh -c '
+  sh -c "sleep 9 & echo \$! > gpid; wait" &
+  echo $! > cpid
+  wait
+' & tree_pid=$!
+
+cleanup_() { env kill -s CONT $pids 2>/dev/null; kill -9 $pids 2>/dev/null; }
+pids=$tree_pid
+
+# Wait until the whole tree is up.
+for i in $(seq 50); do
+  test -s cpid && test -s gpid && break
+  sleep 0.1 || sleep 1
+done
+test -s cpid && test -s gpid || framework_failure_ 'tree did not start'
+pids="$tree_pid $(cat cpid) $(cat gpid)"
+
+# Return the one-letter state of process $1, or nothing if it is gone.
+state_() { sed 's/.*) \(.\).*/\1/' /proc/$1/stat 2>/dev/null; }
+
+# Stop the root: every descendant must end up stopped too.
+env kill --tree -s STOP $tree_pid || fail=1
+for p in $pids; do
+  for i in $(seq 50); do
+    test "$(state_ $p)" = T && break
+    sleep 0.1 || sleep 1
+  done
+  test "$(state_ $p)" = T || fail=1
+done
+
+# A stopped tree can be continued and then terminated the same way.
+env kill --tree -s CONT $tree_pid || fail=1
+env kill --tree $tree_pid || fail=1
+wait $tree_pid
+for i in $(seq 50); do
+  state_ $(cat gpid) > /dev/null || break
+  sleep 0.1 || sleep 1
+done
+state_ $(cat gpid) > /dev/null && fail=1
+
+Exit $fail
@@ -0,0 +1,69 @@
+#!/bin/sh
+# Test the length-prefixed binary record mode of sort, uniq and shuf
+
+# Copyright (C) 2026 Free Software Foundation, Inc.
+
+# This program is free software: you can redistribute it and/or modify
+# it under the terms of the GNU General Public License as published by
+# the Free Software Foundation, either version 3 of the License, or
+# (at your option) any later version.
+
+# This program is distributed in the hope that it will be useful,
+# but WITHOUT ANY WARRANTY; without even the implied warranty of
+# MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+# GNU General Public License for more details.
+
+# You should have received a copy of the GNU General Public License
+# along with this program.  If not, see <https://www.gnu.org/licenses/>.
+
+. "${srcdir=.}/tests/init.sh"; path_prepend_ ./src
+print_ver_ sort uniq shuf
+
+# A 200-byte payload needs a two-byte count: 200 = 0xC8 0x01.
+x200=$(head -c 200 /dev/zero | tr '\0' x) || framework_failure_
+
+# Records: "b", "a", "a\nb", "" (empty), "a" again, "n\0l" (embedded
+# NUL), and the 200-byte record.  Counts below 128 are single bytes.
+printf '\001b\001a\003a\nb\000\001a\003n\000l\310\001%s' "$x200" > in \
+  || framework_failure_
+
+# Byte order of the payloads, duplicates retained.
+printf '\000\001a\001a\003a\nb\001b\003n\000l\310\001%s' "$x200" > exp \
+  || framework_failure_
+
+# The same with the duplicate "a" removed.
+printf '\000\001a\003a\nb\001b\003n\000l\310\001%s' "$x200" > exp_u \
+  || framework_failure_
+
+# sort orders whole payloads, preserving the framing exactly.
+sort --length-prefixed in > out || fail=1
+compare exp out || fail=1
+
+# uniq collapses adjacent duplicate records.
+uniq --length-prefixed exp > out || fail=1
+compare exp_u out || fail=1
+
+# sort -u agrees with sort | uniq.
+sort -u --length-prefixed in > out || fail=1
+compare exp_u out || fail=1
+
+# shuf permutes without corrupting the framing: re-sorting its output
+# recovers the sorted records, through a pipeline of all three tools.
+sort --length-prefixed in \
+  | uniq --length-prefixed \
+  | shuf --length-prefixed \
+  | sort --length-prefixed > out || fail=1
+compare exp_u out || fail=1
+
+# A truncated payload and an unterminated count are diagnosed.
+printf '\005ab' > trunc || framework_failure_
+returns_ 2 sort --length-prefixed trunc > /dev/null 2>&1 || fail=1
+returns_ 1 shuf --length-prefixed trunc > /dev/null 2>&1 || fail=1
+printf '\200' > trunc || framework_failure_
+returns_ 2 sort --length-prefixed trunc > /dev/null 2>&1 || fail=1
+
+# An empty input holds zero records.
+sort --length-prefixed /dev/null > out || fail=1
+compare /dev/null out || fail=1
+
+Exit $fail
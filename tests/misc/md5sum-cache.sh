@@ -0,0 +1,64 @@
+#!/bin/sh
+# Test the md5sum --check verification cache
+
+# Copyright (C) 2026 Free Software Foundation, Inc.
+
+# This program is free software: you can redistribute it and/or modify
+# it under the terms of the GNU General Public License as published by
+# the Free Software Foundation, either version 3 of the License, or
+# (at your option) any later version.
+
+# This program is distributed in the hope that it will be useful,
+# but WITHOUT ANY WARRANTY; without even the implied warranty of
+# MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+# GNU General Public License for more details.
+
+# You should have received a copy of the GNU General Public License
+# along with this program.  If not, see <https://www.gnu.org/licenses/>.
+
+. "${srcdir=.}/tests/init.sh"; path_prepend_ ./src
+print_ver_ md5sum
+
+for i in 1 2 3; do
+  echo data-$i > f$i || framework_failure_
+done
+md5sum f1 f2 f3 > check || framework_failure_
+
+# The first run populates the cache.
+md5sum --check --cache=cache.db check > out1 || fail=1
+test -f cache.db || fail=1
+test "$(wc -l < cache.db)" = 3 || fail=1
+
+# A second run verifies from the cache; the output is unchanged.
+md5sum --check --cache=cache.db check > out2 || fail=1
+compare out1 out2 || fail=1
+
+# Prove the cached digest stands in for hashing: corrupt the cache
+# entry for f2 without touching f2, and the check must now fail.
+sed '/ f2$/s/^................/0123456789abcdef/' cache.db > cache.tmp \
+  || framework_failure_
+mv cache.tmp cache.db || framework_failure_
+returns_ 1 md5sum --check --cache=cache.db check > out3 2>/dev/null || fail=1
+grep '^f2: FAILED$' out3 || fail=1
+
+# --rehash ignores the stale entry and repairs it.
+md5sum --check --rehash --cache=cache.db check > out4 || fail=1
+compare out1 out4 || fail=1
+md5sum --check --cache=cache.db check > out5 || fail=1
+compare out1 out5 || fail=1
+
+# A modified file is rehashed and detected as usual.
+echo changed >> f3 || framework_failure_
+returns_ 1 md5sum --check --cache=cache.db check > out6 2>/dev/null || fail=1
+grep '^f3: FAILED$' out6 || fail=1
+
+# A corrupted cache merely forces rehashing.
+echo 'not a cache line' > cache.db || framework_failure_
+md5sum f1 > check1 || framework_failure_
+md5sum --check --cache=cache.db check1 > /dev/null || fail=1
+
+# Option validation.
+returns_ 1 md5sum --cache=cache.db f1 || fail=1
+returns_ 1 md5sum --check --rehash check || fail=1
+
+Exit $fail
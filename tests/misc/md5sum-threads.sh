@@ -0,0 +1,55 @@
+#!/bin/sh
+# Test that md5sum --threads matches sequential output exactly
+
+# Copyright (C) 2021 Free Software Foundation, Inc.
+
+# This program is free software: you can redistribute it and/or modify
+# it under the terms of the GNU General Public License as published by
+# the Free Software Foundation, either version 3 of the License, or
+# (at your option) any later version.
+
+# This program is distributed in the hope that it will be useful,
+# but WITHOUT ANY WARRANTY; without even the implied warranty of
+# MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+# GNU General Public License for more details.
+
+# You should have received a copy of the GNU General Public License
+# along with this program.  If not, see <https://www.gnu.org/licenses/>.
+
+. "${srcdir=.}/tests/init.sh"; path_prepend_ ./src
+print_ver_ md5sum
+
+for i in $(seq 40); do
+  echo data-$i > f$i || framework_failure_
+done
+
+# Generation: output must match the sequential order exactly.
+md5sum f* > exp || framework_failure_
+md5sum --threads=4 f* > out || fail=1
+compare exp out || fail=1
+
+# --tag output must be unaffected too.
+md5sum --tag f* > exp-tag || framework_failure_
+md5sum --threads=4 --tag f* > out-tag || fail=1
+compare exp-tag out-tag || fail=1
+
+# Standard input mixed into the operand list is read on the main thread.
+echo stdin-data > in || framework_failure_
+md5sum f1 - f2 < in > exp-stdin || framework_failure_
+md5sum --threads=4 f1 - f2 < in > out-stdin || fail=1
+compare exp-stdin out-stdin || fail=1
+
+# Verification runs the same checks concurrently.
+md5sum --threads=4 --check --quiet exp > out-check || fail=1
+compare /dev/null out-check || fail=1
+
+# An unreadable file must still fail, with diagnostics in order.
+returns_ 1 md5sum --threads=4 f1 missing f2 > out-err 2> err || fail=1
+grep missing err > /dev/null || fail=1
+md5sum f1 f2 > exp-partial || framework_failure_
+compare exp-partial out-err || fail=1
+
+# --threads=0 is rejected.
+returns_ 1 md5sum --threads=0 f1 || fail=1
+
+Exit $fail
@@ -0,0 +1,63 @@
+#!/bin/sh
+# Test mktemp --count batch creation
+
+# Copyright (C) 2026 Free Software Foundation, Inc.
+
+# This program is free software: you can redistribute it and/or modify
+# it under the terms of the GNU General Public License as published by
+# the Free Software Foundation, either version 3 of the License, or
+# (at your option) any later version.
+
+# This program is distributed in the hope that it will be useful,
+# but WITHOUT ANY WARRANTY; without even the implied warranty of
+# MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+# GNU General Public License for more details.
+
+# You should have received a copy of the GNU General Public License
+# along with this program.  If not, see <https://www.gnu.org/licenses/>.
+
+. "${srcdir=.}/tests/init.sh"; path_prepend_ ./src
+print_ver_ mktemp
+
+# A batch creates exactly COUNT files, prints each name once,
+# NUL-terminated, and every name is unique.
+mktemp -n 20 f-XXXXXX > out || fail=1
+test "$(wc -l < out)" = 0 || fail=1
+tr '\0' '\n' < out > names || framework_failure_
+test "$(wc -l < names)" = 20 || fail=1
+test "$(sort -u names | wc -l)" = 20 || fail=1
+test "$(ls f-?????? | wc -l)" = 20 || fail=1
+while read f; do
+  test -f "$f" || fail=1
+done < names
+
+# --directory creates directories instead.
+mktemp -d -n 5 d-XXXXXX > out || fail=1
+tr '\0' '\n' < out > names || framework_failure_
+test "$(sort -u names | wc -l)" = 5 || fail=1
+while read d; do
+  test -d "$d" || fail=1
+done < names
+
+# A directory component in the template is honored.
+mkdir sub || framework_failure_
+mktemp -n 5 sub/s-XXXX > out || fail=1
+test "$(ls sub | wc -l)" = 5 || fail=1
+
+# --dry-run prints names without creating anything.
+mktemp -u -n 5 u-XXXXXX > out || fail=1
+tr '\0' '\n' < out > names || framework_failure_
+test "$(wc -l < names)" = 5 || fail=1
+ls u-?????? 2>/dev/null && fail=1
+
+# A zero or garbage count is diagnosed.
+returns_ 1 mktemp -n 0 f-XXXXXX 2>err || fail=1
+grep 'invalid count' err || fail=1
+returns_ 1 mktemp -n 1x f-XXXXXX 2>err || fail=1
+grep 'invalid count' err || fail=1
+
+# A missing template directory fails up front, creating nothing.
+returns_ 1 mktemp -n 5 missing/m-XXXX 2>err || fail=1
+grep 'failed to open directory' err || fail=1
+
+Exit $fail
@@ -39,6 +39,18 @@ cat <<\EOF > exp
 EOF
 compare exp out || fail=1
 
+# Ensure a missing final newline is added, in both the buffered
+# number-only path and the general per-line path.
+printf 'a\nb' | nl > out || fail=1
+printf 'a\nb' | nl -l2 >> out || fail=1
+cat <<\EOF > exp
+     1	a
+     2	b
+     1	a
+     2	b
+EOF
+compare exp out || fail=1
+
 # Ensure numbering reset at each delimiter.
 # coreutils <= v8.25 only reset at a page header.
 printf '%s\n' '\:\:\:' a '\:\:' b '\:' c > in.txt || framework_failure_
@@ -0,0 +1,53 @@
+#!/bin/sh
+# Ensure od --threads output matches the sequential output
+
+# Copyright (C) 2026 Free Software Foundation, Inc.
+
+# This program is free software: you can redistribute it and/or modify
+# it under the terms of the GNU General Public License as published by
+# the Free Software Foundation, either version 3 of the License, or
+# (at your option) any later version.
+
+# This program is distributed in the hope that it will be useful,
+# but WITHOUT ANY WARRANTY; without even the implied warranty of
+# MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+# GNU General Public License for more details.
+
+# You should have received a copy of the GNU General Public License
+# along with this program.  If not, see <https://www.gnu.org/licenses/>.
+
+. "${srcdir=.}/tests/init.sh"; path_prepend_ ./src
+print_ver_ od
+
+# Span several of the 4 MiB chunks claimed by the worker threads, with
+# a duplicate-block run crossing a chunk boundary and a partial final
+# line, both of which exercise the hand-off to the sequential code.
+seq 350000 > r || framework_failure_
+head -c 4194304 /dev/zero | tr '\0' a > dup || framework_failure_
+cat r dup r > big || framework_failure_
+printf xyz >> big || framework_failure_
+
+for t in x1 x4 x1z; do
+  od -A x -t $t big > exp || framework_failure_
+  od -A x -t $t --threads=4 big > out || fail=1
+  compare exp out || fail=1
+done
+
+# Without duplicate-block abbreviation
+od -An -t x1 -v big > exp || framework_failure_
+od -An -t x1 -v --threads=4 big > out || fail=1
+compare exp out || fail=1
+
+# Skipping and limiting, with addresses not aligned to a block
+od -A d -t x1 -j 1000001 -N 5000000 big > exp || framework_failure_
+od -A d -t x1 -j 1000001 -N 5000000 --threads=4 big > out || fail=1
+compare exp out || fail=1
+
+# Non-regular input falls back to the sequential code
+od -A x -t x1 < big > exp || framework_failure_
+cat big | od -A x -t x1 --threads=4 > out || fail=1
+compare exp out || fail=1
+
+returns_ 1 od --threads=0 big 2>/dev/null || fail=1
+
+Exit $fail
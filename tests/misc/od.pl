@@ -64,6 +64,20 @@ my @Tests =
      ['wide-a',   '-a -w65537 -An', {IN=>{g=>'x'}}, {OUT=>"   x\n"}],
      ['wide-c',   '-c -w65537 -An', {IN=>{g=>'x'}}, {OUT=>"   x\n"}],
      ['wide-x', '-tx1 -w65537 -An', {IN=>{g=>'B'}}, {OUT=>" 42\n"}],
+
+     # Exercise the table-driven formatter used for plain x1/x4 dumps,
+     # including the abbreviated duplicate block and the partial
+     # final block, which takes the generic path.
+     ['hex-x1', '-A x -t x1', {IN=>{g=>'abcdefghijklmnop'}},
+      {OUT=>"000000 61 62 63 64 65 66 67 68 69 6a 6b 6c 6d 6e 6f 70\n"
+            . "000010\n"}],
+     ['hex-x4', '-A x -t x4', {IN=>{g=>'abbaabbaabbaabba'}},
+      {OUT=>"000000 61626261 61626261 61626261 61626261\n000010\n"}],
+     ['hex-x1-dup', '-A x -t x1', {IN=>{g=>'a' x 32}},
+      {OUT=>"000000 61 61 61 61 61 61 61 61 61 61 61 61 61 61 61 61\n"
+            . "*\n000020\n"}],
+     ['hex-x1-part', '-A x -t x1', {IN=>{g=>'abc'}},
+      {OUT=>"000000 61 62 63\n000003\n"}],
     );
 
 my $save_temps = $ENV{DEBUG};
@@ -85,6 +85,9 @@ my @Tests =
   ['excess', 'B 1', {OUT=>'B'},
     {ERR=>"$prog: warning: ignoring excess arguments, starting with '1'\n"}],
   ['percent', '%%', {OUT=>'%'}],
+  # The format is compiled once and replayed over each run of arguments.
+  ['reuse-1', q('%s=%d;' a 1 b 2), {OUT=>"a=1;b=2;"}],
+  ['reuse-2', q('%s,%d\n' x 7 y), {OUT=>"x,7\ny,0\n"}],
   ['d-sp',    q('% d' 33), {OUT=>' 33'}],
   ['d-plus',  q('%+d' 33), {OUT=>'+33'}],
   ['d-minus', q('%-d' 33), {OUT=> '33'}],
@@ -0,0 +1,52 @@
+#!/bin/sh
+# Ensure ptx --buffer-size produces the same output as the in-memory mode.
+
+# Copyright (C) 2026 Free Software Foundation, Inc.
+
+# This program is free software: you can redistribute it and/or modify
+# it under the terms of the GNU General Public License as published by
+# the Free Software Foundation, either version 3 of the License, or
+# (at your option) any later version.
+
+# This program is distributed in the hope that it will be useful,
+# but WITHOUT ANY WARRANTY; without even the implied warranty of
+# MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+# GNU General Public License for more details.
+
+# You should have received a copy of the GNU General Public License
+# along with this program.  If not, see <https://www.gnu.org/licenses/>.
+
+. "${srcdir=.}/tests/init.sh"; path_prepend_ ./src
+print_ver_ ptx
+
+# A few hundred lines, with repeated words so keys collide,
+# and a sentence ending now and then.
+awk 'BEGIN {
+  for (i = 0; i < 400; i++)
+    print "alpha beta" (i % 7) " gamma delta" (i % 5) ". epsilon"
+}' > in || framework_failure_
+
+# A tiny buffer forces many spill runs and several merge levels.
+for opt in '' '-f' '-A' '-O' '-T' '-w 40'; do
+  ptx $opt in > exp || fail=1
+  ptx --buffer-size=1K $opt in > out || fail=1
+  compare exp out || fail=1
+done
+
+# Input reference mode, where the reference precedes the context.
+sed 's/^/ref:/' in > rin || framework_failure_
+ptx -r rin > exp || fail=1
+ptx --buffer-size=1K -r rin > out || fail=1
+compare exp out || fail=1
+
+# A line larger than the initial read window.
+seq -s ' ' 20000 > wide || framework_failure_
+echo 'narrow line' >> wide
+ptx -r -W '[0-9]*1111' wide > exp || fail=1
+ptx --buffer-size=1K -r -W '[0-9]*1111' wide > out || fail=1
+compare exp out || fail=1
+
+# An invalid buffer size is diagnosed.
+returns_ 1 ptx --buffer-size=0 in || fail=1
+
+Exit $fail
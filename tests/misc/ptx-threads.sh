@@ -0,0 +1,48 @@
+#!/bin/sh
+# Ensure ptx --threads produces the same output as one thread.
+
+# Copyright (C) 2026 Free Software Foundation, Inc.
+
+# This program is free software: you can redistribute it and/or modify
+# it under the terms of the GNU General Public License as published by
+# the Free Software Foundation, either version 3 of the License, or
+# (at your option) any later version.
+
+# This program is distributed in the hope that it will be useful,
+# but WITHOUT ANY WARRANTY; without even the implied warranty of
+# MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+# GNU General Public License for more details.
+
+# You should have received a copy of the GNU General Public License
+# along with this program.  If not, see <https://www.gnu.org/licenses/>.
+
+. "${srcdir=.}/tests/init.sh"; path_prepend_ ./src
+print_ver_ ptx
+
+# Enough keyword occurrences to engage the parallel sort and the
+# sharded output.
+awk 'BEGIN {
+  for (i = 0; i < 4000; i++)
+    print "alpha beta" (i % 13) " gamma delta" (i % 11) " epsilon zeta"
+}' > in || framework_failure_
+
+for opt in '' '-A' '-O' '-T'; do
+  ptx $opt in > exp || fail=1
+  ptx --threads=4 $opt in > out || fail=1
+  compare exp out || fail=1
+done
+
+# Combined with --buffer-size, --threads sorts the spill runs.
+ptx in > exp || fail=1
+ptx --threads=4 --buffer-size=64K in > out || fail=1
+compare exp out || fail=1
+
+# Too little input for sharding is still handled.
+echo 'just a few words' > small || framework_failure_
+ptx small > exp || fail=1
+ptx --threads=32 small > out || fail=1
+compare exp out || fail=1
+
+returns_ 1 ptx --threads=0 in || fail=1
+
+Exit $fail
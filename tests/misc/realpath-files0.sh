@@ -0,0 +1,55 @@
+#!/bin/sh
+# Exercise realpath --files0-from and the cached prefix resolution.
+
+# Copyright (C) 2026 Free Software Foundation, Inc.
+
+# This program is free software: you can redistribute it and/or modify
+# it under the terms of the GNU General Public License as published by
+# the Free Software Foundation, either version 3 of the License, or
+# (at your option) any later version.
+
+# This program is distributed in the hope that it will be useful,
+# but WITHOUT ANY WARRANTY; without even the implied warranty of
+# MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+# GNU General Public License for more details.
+
+# You should have received a copy of the GNU General Public License
+# along with this program.  If not, see <https://www.gnu.org/licenses/>.
+
+. "${srcdir=.}/tests/init.sh"; path_prepend_ ./src
+print_ver_ realpath
+
+mkdir -p dir1/dir2 || framework_failure_
+touch dir1/dir2/f dir1/dir2/g || framework_failure_
+ln -s dir1/dir2 ldir2 || framework_failure_
+ln -s dir2/f dir1/lf || framework_failure_
+ln -s nowhere dir1/dangling || framework_failure_
+
+# Operands sharing a directory must resolve as they do individually,
+# including symlinked directories and a symlink or missing final component.
+for name in dir1/dir2/f dir1/dir2/g dir1/dir2/f ldir2/f dir1/lf \
+            dir1/dangling dir1/dir2/missing; do
+  realpath -- "$name" >> exp || fail=1
+done
+printf '%s\0' dir1/dir2/f dir1/dir2/g dir1/dir2/f ldir2/f dir1/lf \
+              dir1/dangling dir1/dir2/missing > names || framework_failure_
+realpath --files0-from=names > out || fail=1
+compare exp out || fail=1
+
+# Read the file name list from stdin.
+realpath --files0-from=- < names > out || fail=1
+compare exp out || fail=1
+
+# A failing name affects the exit status but not the other results.
+printf '%s\0' dir1/dir2/f missing/f dir1/dir2/g > names2 || framework_failure_
+returns_ 1 realpath -q --files0-from=names2 > out || fail=1
+realpath -- dir1/dir2/f dir1/dir2/g > exp2 || framework_failure_
+compare exp2 out || fail=1
+
+# File operands may not be combined with --files0-from.
+returns_ 1 realpath --files0-from=names dir1 2>/dev/null || fail=1
+
+# A file name of - is rejected when the list itself comes from stdin.
+printf -- '-\0' | returns_ 1 realpath --files0-from=- 2>/dev/null || fail=1
+
+Exit $fail
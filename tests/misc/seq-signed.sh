@@ -0,0 +1,67 @@
+#!/bin/sh
+# Test the whole-number fast path with negative bounds and -w
+
+# Copyright (C) 2026 Free Software Foundation, Inc.
+
+# This program is free software: you can redistribute it and/or modify
+# it under the terms of the GNU General Public License as published by
+# the Free Software Foundation, either version 3 of the License, or
+# (at your option) any later version.
+
+# This program is distributed in the hope that it will be useful,
+# but WITHOUT ANY WARRANTY; without even the implied warranty of
+# MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+# GNU General Public License for more details.
+
+# You should have received a copy of the GNU General Public License
+# along with this program.  If not, see <https://www.gnu.org/licenses/>.
+
+. "${srcdir=.}/tests/init.sh"; path_prepend_ ./src
+print_ver_ seq
+
+# Negative run crossing zero, with a step
+seq -7 3 5 > out || fail=1
+printf '%s\n' -7 -4 -1 2 5 > exp || framework_failure_
+compare exp out || fail=1
+
+# All-negative run
+seq -10 3 -1 > out || fail=1
+printf '%s\n' -10 -7 -4 -1 > exp || framework_failure_
+compare exp out || fail=1
+
+# Equal width pads after the sign, and counts leading input zeros
+seq -w -3 2 > out || fail=1
+printf '%s\n' -3 -2 -1 00 01 02 > exp || framework_failure_
+compare exp out || fail=1
+
+seq -w 007 009 > out || fail=1
+printf '%s\n' 007 008 009 > exp || framework_failure_
+compare exp out || fail=1
+
+# Negative values beyond 2^64 are no longer rounded
+seq -- -50000000000000000002 -50000000000000000000 > out || fail=1
+printf '%s\n' -50000000000000000002 -50000000000000000001 \
+  -50000000000000000000 > exp || framework_failure_
+compare exp out || fail=1
+
+# A -0 start keeps its sign, as the general code prints it
+seq -- -0 2 > out || fail=1
+printf '%s\n' -0 1 2 > exp || framework_failure_
+compare exp out || fail=1
+
+# Descending bounds print nothing and succeed
+seq -- -1 -5 > out || fail=1
+compare /dev/null out || fail=1
+
+# Single-character separators are handled in the fast path
+seq -s, -3 -1 > out || fail=1
+printf '%s' '-3,-2,-1
+' > exp || framework_failure_
+compare exp out || fail=1
+
+# Agree with the floating point code on a longer mixed-sign run
+seq -f %.0f -1234 7 1234 > exp || framework_failure_
+seq -1234 7 1234 > out || fail=1
+compare exp out || fail=1
+
+Exit $fail
@@ -0,0 +1,50 @@
+#!/bin/sh
+# Test shred --threads
+
+# Copyright (C) 2026 Free Software Foundation, Inc.
+
+# This program is free software: you can redistribute it and/or modify
+# it under the terms of the GNU General Public License as published by
+# the Free Software Foundation, either version 3 of the License, or
+# (at your option) any later version.
+
+# This program is distributed in the hope that it will be useful,
+# but WITHOUT ANY WARRANTY; without even the implied warranty of
+# MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+# GNU General Public License for more details.
+
+# You should have received a copy of the GNU General Public License
+# along with this program.  If not, see <https://www.gnu.org/licenses/>.
+
+. "${srcdir=.}/tests/init.sh"; path_prepend_ ./src
+print_ver_ shred
+
+for i in 1 2 3 4 5 6 7 8; do
+  printf %4000s x > f$i || framework_failure_
+done
+
+# All operands wiped and removed, concurrently.
+shred -u --threads=4 f1 f2 f3 f4 f5 f6 f7 f8 || fail=1
+for i in 1 2 3 4 5 6 7 8; do
+  test -e f$i && fail=1
+done
+
+# A failing operand must fail the invocation without
+# disturbing the others.
+printf %4000s x > g1 || framework_failure_
+printf %4000s x > g2 || framework_failure_
+returns_ 1 shred -u --threads=2 g1 missing g2 || fail=1
+test -e g1 && fail=1
+test -e g2 && fail=1
+
+# Wiping in place (no -u) must leave the sizes alone.
+printf %4000s x > h1 || framework_failure_
+printf %4000s x > h2 || framework_failure_
+shred --threads=2 -x h1 h2 || fail=1
+for f in h1 h2; do
+  test "$(wc -c < $f)" = 4000 || fail=1
+done
+
+returns_ 1 shred --threads=0 h1 || fail=1
+
+Exit $fail
@@ -0,0 +1,58 @@
+#!/bin/sh
+# Exercise shuf --buffer-size, the disk-backed shuffle.
+
+# Copyright (C) 2021 Free Software Foundation, Inc.
+
+# This program is free software: you can redistribute it and/or modify
+# it under the terms of the GNU General Public License as published by
+# the Free Software Foundation, either version 3 of the License, or
+# (at your option) any later version.
+
+# This program is distributed in the hope that it will be useful,
+# but WITHOUT ANY WARRANTY; without even the implied warranty of
+# MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+# GNU General Public License for more details.
+
+# You should have received a copy of the GNU General Public License
+# along with this program.  If not, see <https://www.gnu.org/licenses/>.
+
+. "${srcdir=.}/tests/init.sh"; path_prepend_ ./src
+print_ver_ shuf
+
+seq 10000 > in || framework_failure_
+sort in > in.sorted || framework_failure_
+
+# Spill files go to the test directory.
+TMPDIR=$PWD; export TMPDIR
+
+# The output must be a permutation of the input.
+shuf -S 4k in > out || fail=1
+sort out > out.sorted || fail=1
+compare in.sorted out.sorted || fail=1
+
+# Likewise when reading from a pipe, where the input size is unknown.
+cat in | shuf -S 4k > out || fail=1
+sort out > out.sorted || fail=1
+compare in.sorted out.sorted || fail=1
+
+# A buffer size larger than the input shuffles in memory as before.
+shuf -S 10M in > out || fail=1
+sort out > out.sorted || fail=1
+compare in.sorted out.sorted || fail=1
+
+# With a fixed --random-source, the result is deterministic.
+yes 01234567 | head -c 100000 > rand-src || framework_failure_
+shuf -S 4k --random-source=rand-src in > out1 || fail=1
+shuf -S 4k --random-source=rand-src in > out2 || fail=1
+compare out1 out2 || fail=1
+
+# --zero-terminated input.
+tr '\n' '\0' < in > in.z || framework_failure_
+shuf -z -S 4k in.z > out.z || fail=1
+tr '\0' '\n' < out.z | sort > out.sorted || fail=1
+compare in.sorted out.sorted || fail=1
+
+# An invalid size is diagnosed.
+returns_ 1 shuf -S 0 in 2>/dev/null || fail=1
+
+Exit $fail
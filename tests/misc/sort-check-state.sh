@@ -0,0 +1,60 @@
+#!/bin/sh
+# Test sort -c --check-state incremental validation
+
+# Copyright (C) 2021 Free Software Foundation, Inc.
+
+# This program is free software: you can redistribute it and/or modify
+# it under the terms of the GNU General Public License as published by
+# the Free Software Foundation, either version 3 of the License, or
+# (at your option) any later version.
+
+# This program is distributed in the hope that it will be useful,
+# but WITHOUT ANY WARRANTY; without even the implied warranty of
+# MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+# GNU General Public License for more details.
+
+# You should have received a copy of the GNU General Public License
+# along with this program.  If not, see <https://www.gnu.org/licenses/>.
+
+. "${srcdir=.}/tests/init.sh"; path_prepend_ ./src
+print_ver_ sort
+
+seq 1000 | sort > in || framework_failure_
+
+# A successful check records state; a re-check still succeeds.
+sort -c --check-state=st in || fail=1
+test -s st || fail=1
+sort -c --check-state=st in || fail=1
+
+# An in-order append passes and extends the state.
+printf '%s\n' zz1 zz2 >> in || fail=1
+sort -c --check-state=st in || fail=1
+
+# An out-of-order append is diagnosed with the same line number
+# a full check reports.
+echo aa >> in || fail=1
+returns_ 1 sort -c in 2> experr || fail=1
+returns_ 1 sort -c --check-state=st in 2> err || fail=1
+compare experr err || fail=1
+
+# A failed check does not update the state; removing the bad line
+# makes the check pass again.
+sed '$d' in > t && mv t in || framework_failure_
+sort -c --check-state=st in || fail=1
+
+# State recorded under different ordering options is not trusted.
+seq 1000 > num || framework_failure_
+rm -f st
+sort -c -n --check-state=st num || fail=1
+returns_ 1 sort -c --check-state=st num 2>/dev/null || fail=1
+
+# Rewriting the file with unsorted content is detected.
+seq 5 -1 1 > num || framework_failure_
+rm -f st2
+returns_ 1 sort -c -n --check-state=st2 num 2>/dev/null || fail=1
+
+# --check-state requires a check option, and refuses random sorting.
+returns_ 2 sort --check-state=st in 2>/dev/null || fail=1
+returns_ 2 sort -c -R --check-state=st in 2>/dev/null || fail=1
+
+Exit $fail
@@ -0,0 +1,44 @@
+#!/bin/sh
+# Test in-process compression of sort temporaries
+
+# Copyright (C) 2021 Free Software Foundation, Inc.
+
+# This program is free software: you can redistribute it and/or modify
+# it under the terms of the GNU General Public License as published by
+# the Free Software Foundation, either version 3 of the License, or
+# (at your option) any later version.
+
+# This program is distributed in the hope that it will be useful,
+# but WITHOUT ANY WARRANTY; without even the implied warranty of
+# MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+# GNU General Public License for more details.
+
+# You should have received a copy of the GNU General Public License
+# along with this program.  If not, see <https://www.gnu.org/licenses/>.
+
+. "${srcdir=.}/tests/init.sh"; path_prepend_ ./src
+print_ver_ sort
+
+# Skip where the built-in codec is unavailable.
+sort --compress-temps </dev/null >/dev/null 2>err ||
+  { grep 'not supported' err >/dev/null && skip_ 'no fopencookie support';
+    fail=1; }
+
+seq -w 200000 > exp || framework_failure_
+tac exp > in || framework_failure_
+
+# Force the use of temp files, compressed and not.
+sort -S 1k --compress-temps -T . in > out || fail=1
+compare exp out || fail=1
+
+# Merging of many compressed temporaries, including intermediate passes.
+sort -S 1k --batch-size=4 --compress-temps -T . in > out || fail=1
+compare exp out || fail=1
+
+# The two compression mechanisms are mutually exclusive.
+returns_ 2 sort --compress-temps --compress-program=cat </dev/null ||
+  fail=1
+returns_ 2 sort --compress-program=cat --compress-temps </dev/null ||
+  fail=1
+
+Exit $fail
@@ -0,0 +1,35 @@
+#!/bin/sh
+# Test sort --cpu-affinity
+
+# Copyright (C) 2021 Free Software Foundation, Inc.
+
+# This program is free software: you can redistribute it and/or modify
+# it under the terms of the GNU General Public License as published by
+# the Free Software Foundation, either version 3 of the License, or
+# (at your option) any later version.
+
+# This program is distributed in the hope that it will be useful,
+# but WITHOUT ANY WARRANTY; without even the implied warranty of
+# MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+# GNU General Public License for more details.
+
+# You should have received a copy of the GNU General Public License
+# along with this program.  If not, see <https://www.gnu.org/licenses/>.
+
+. "${srcdir=.}/tests/init.sh"; path_prepend_ ./src
+print_ver_ sort
+
+# Pinning must not change the result, whether or not threads spawn.
+seq 20000 | shuf > in || framework_failure_
+sort -n in > exp || framework_failure_
+
+if ! sort --cpu-affinity -n in > out 2>err; then
+  # Unsupported on this system.
+  grep 'not supported' err || fail=1
+else
+  compare exp out || fail=1
+  sort --cpu-affinity --parallel=4 -n in > out || fail=1
+  compare exp out || fail=1
+fi
+
+Exit $fail
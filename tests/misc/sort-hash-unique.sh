@@ -0,0 +1,60 @@
+#!/bin/sh
+# Test sort --hash-unique
+
+# Copyright (C) 2021 Free Software Foundation, Inc.
+
+# This program is free software: you can redistribute it and/or modify
+# it under the terms of the GNU General Public License as published by
+# the Free Software Foundation, either version 3 of the License, or
+# (at your option) any later version.
+
+# This program is distributed in the hope that it will be useful,
+# but WITHOUT ANY WARRANTY; without even the implied warranty of
+# MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+# GNU General Public License for more details.
+
+# You should have received a copy of the GNU General Public License
+# along with this program.  If not, see <https://www.gnu.org/licenses/>.
+
+. "${srcdir=.}/tests/init.sh"; path_prepend_ ./src
+print_ver_ sort
+
+# First occurrences are kept, in input order.
+printf '%s\n' 3 1 2 2 1 3 4 > in || framework_failure_
+printf '%s\n' 3 1 2 4 > exp || framework_failure_
+sort --hash-unique in > out || fail=1
+compare exp out || fail=1
+
+# The distinct set matches sort -u.
+seq 500 | shuf -r -n 5000 > big || framework_failure_
+sort -u big > exp || framework_failure_
+sort --hash-unique big | sort > out || fail=1
+compare exp out || fail=1
+
+# Multiple inputs are deduplicated as one stream.
+printf '%s\n' 3 1 2 4 > exp || framework_failure_
+sort --hash-unique in in > out || fail=1
+compare exp out || fail=1
+
+# -u is accepted as a no-op alongside, and -z selects NUL delimiters.
+sort --hash-unique -u in > out || fail=1
+compare exp out || fail=1
+printf '3\0001\0002\0002\000' > inz || framework_failure_
+printf '3\0001\0002\000' > expz || framework_failure_
+sort --hash-unique -z inz > outz || fail=1
+compare expz outz || fail=1
+
+# Sorting a file onto itself is supported.
+cp in self || framework_failure_
+sort --hash-unique -o self self || fail=1
+compare exp self || fail=1
+
+# Ordering options make no sense without a sort.
+returns_ 2 sort --hash-unique -n in 2>/dev/null || fail=1
+returns_ 2 sort --hash-unique -r in 2>/dev/null || fail=1
+returns_ 2 sort --hash-unique -k2 in 2>/dev/null || fail=1
+returns_ 2 sort --hash-unique -c in 2>/dev/null || fail=1
+returns_ 2 sort --hash-unique -m in 2>/dev/null || fail=1
+returns_ 2 sort --hash-unique --top=2 in 2>/dev/null || fail=1
+
+Exit $fail
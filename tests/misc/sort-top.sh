@@ -0,0 +1,67 @@
+#!/bin/sh
+# Test sort --top bounded selection
+
+# Copyright (C) 2021 Free Software Foundation, Inc.
+
+# This program is free software: you can redistribute it and/or modify
+# it under the terms of the GNU General Public License as published by
+# the Free Software Foundation, either version 3 of the License, or
+# (at your option) any later version.
+
+# This program is distributed in the hope that it will be useful,
+# but WITHOUT ANY WARRANTY; without even the implied warranty of
+# MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+# GNU General Public License for more details.
+
+# You should have received a copy of the GNU General Public License
+# along with this program.  If not, see <https://www.gnu.org/licenses/>.
+
+. "${srcdir=.}/tests/init.sh"; path_prepend_ ./src
+print_ver_ sort
+
+seq 1000 | shuf > in || framework_failure_
+
+# --top=K output matches the first K lines of a full sort.
+for opts in '' '-r' '-n' '-nr' '-k1,1' '-u'; do
+  sort $opts in | head -n 10 > exp || framework_failure_
+  sort $opts --top=10 in > out || fail=1
+  compare exp out || fail=1
+done
+
+# A K larger than the input outputs everything, sorted.
+sort -n in > exp || framework_failure_
+sort -n --top=2000 in > out || fail=1
+compare exp out || fail=1
+
+# Multiple input files are merged into one selection.
+seq 500 1500 | shuf > in2 || framework_failure_
+sort -n in in2 | head -n 15 > exp || framework_failure_
+sort -n --top=15 in in2 > out || fail=1
+compare exp out || fail=1
+
+# Ties are broken by input order, matching a stable full sort.
+printf '%s\n' 'a 1' 'b 1' 'c 1' 'd 1' > tie || framework_failure_
+printf '%s\n' 'a 1' 'b 1' > exp || framework_failure_
+sort -s -k2,2n --top=2 tie > out || fail=1
+compare exp out || fail=1
+
+# Sorting a file onto itself is supported, as all input is read
+# before the output is opened.
+cp in self || framework_failure_
+sort -n --top=5 -o self self || fail=1
+seq 5 > exp || framework_failure_
+compare exp self || fail=1
+
+# No temporary files are written, even with a tiny sort buffer.
+mkdir tmpd || framework_failure_
+TMPDIR=$PWD/tmpd sort -n -S 32K --top=10 in > out || fail=1
+seq 10 > exp || framework_failure_
+compare exp out || fail=1
+files=$(ls tmpd) && test -z "$files" || fail=1
+
+# Invalid and incompatible usages are diagnosed.
+returns_ 2 sort --top=0 in 2>/dev/null || fail=1
+returns_ 2 sort --top=5 -c in 2>/dev/null || fail=1
+returns_ 2 sort --top=5 -m in 2>/dev/null || fail=1
+
+Exit $fail
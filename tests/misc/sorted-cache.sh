@@ -0,0 +1,68 @@
+#!/bin/sh
+# Check the comm/join --sorted-cache verified-order index
+
+# Copyright (C) 2021 Free Software Foundation, Inc.
+
+# This program is free software: you can redistribute it and/or modify
+# it under the terms of the GNU General Public License as published by
+# the Free Software Foundation, either version 3 of the License, or
+# (at your option) any later version.
+
+# This program is distributed in the hope that it will be useful,
+# but WITHOUT ANY WARRANTY; without even the implied warranty of
+# MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+# GNU General Public License for more details.
+
+# You should have received a copy of the GNU General Public License
+# along with this program.  If not, see <https://www.gnu.org/licenses/>.
+
+. "${srcdir=.}/tests/init.sh"; path_prepend_ ./src
+print_ver_ comm join
+
+printf '%s\n' a c e > f1 || framework_failure_
+printf '%s\n' b c d > f2 || framework_failure_
+
+# The cache does not change the output.
+comm f1 f2 > exp || framework_failure_
+comm --check-order --sorted-cache=db f1 f2 > out || fail=1
+compare exp out || fail=1
+test -s db || fail=1
+
+# A second run hits the cache, again with identical output.
+comm --check-order --sorted-cache=db f1 f2 > out || fail=1
+compare exp out || fail=1
+
+# Modifying an input invalidates its record.
+printf '%s\n' e c a > f1 || framework_failure_
+touch f1 || framework_failure_
+returns_ 1 comm --check-order --sorted-cache=db f1 f2 >/dev/null 2>err \
+  || fail=1
+grep 'not in sorted order' err || fail=1
+
+# A failed check must not be recorded.
+returns_ 1 comm --check-order --sorted-cache=db f1 f2 >/dev/null 2>/dev/null \
+  || fail=1
+
+# Without --check-order, nothing is recorded.
+printf '%s\n' a c e > f1 || framework_failure_
+rm -f db
+comm --sorted-cache=db f1 f2 > out || fail=1
+test -f db && fail=1
+
+# join: the cache does not change the output, and a record made with
+# one join field does not satisfy a run with another.
+printf '%s\n' '1 a' '2 b' '3 c' > j1 || framework_failure_
+printf '%s\n' '1 x' '3 y' > j2 || framework_failure_
+join j1 j2 > exp || framework_failure_
+join --check-order --sorted-cache=jdb j1 j2 > out || fail=1
+compare exp out || fail=1
+join --check-order --sorted-cache=jdb j1 j2 > out || fail=1
+compare exp out || fail=1
+
+printf '%s\n' '3 c' '1 a' > j1 || framework_failure_
+touch j1 || framework_failure_
+returns_ 1 join --check-order --sorted-cache=jdb j1 j2 >/dev/null 2>err \
+  || fail=1
+grep 'not sorted' err || fail=1
+
+Exit $fail
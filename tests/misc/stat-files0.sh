@@ -0,0 +1,49 @@
+#!/bin/sh
+# Exercise stat --files0-from.
+
+# Copyright (C) 2026 Free Software Foundation, Inc.
+
+# This program is free software: you can redistribute it and/or modify
+# it under the terms of the GNU General Public License as published by
+# the Free Software Foundation, either version 3 of the License, or
+# (at your option) any later version.
+
+# This program is distributed in the hope that it will be useful,
+# but WITHOUT ANY WARRANTY; without even the implied warranty of
+# MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+# GNU General Public License for more details.
+
+# You should have received a copy of the GNU General Public License
+# along with this program.  If not, see <https://www.gnu.org/licenses/>.
+
+. "${srcdir=.}/tests/init.sh"; path_prepend_ ./src
+print_ver_ stat
+
+printf 'a' > 1b || framework_failure_
+printf 'ab' > 2b || framework_failure_
+printf '1b\n2b\n' | tr '\n' '\0' > names || framework_failure_
+
+stat -c '%n %s' --files0-from=names > out || fail=1
+cat <<\EOF > exp || framework_failure_
+1b 1
+2b 2
+EOF
+compare exp out || fail=1
+
+# Read the file name list from stdin.
+stat -c '%n %s' --files0-from=- < names > out || fail=1
+compare exp out || fail=1
+
+# An unstatable name makes stat fail, but the others are still reported.
+printf '1b\0no-such\02b\0' > names2 || framework_failure_
+returns_ 1 stat -c '%n %s' --files0-from=names2 > out 2> err || fail=1
+compare exp out || fail=1
+grep 'no-such' err || { cat err; fail=1; }
+
+# File operands may not be combined with --files0-from.
+returns_ 1 stat --files0-from=names 1b 2>/dev/null || fail=1
+
+# A file name of - is rejected when the list itself comes from stdin.
+printf -- '-\0' | returns_ 1 stat --files0-from=- 2>/dev/null || fail=1
+
+Exit $fail
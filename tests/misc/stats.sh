@@ -0,0 +1,57 @@
+#!/bin/sh
+# Exercise the --stats option of sort, cp and du.
+
+# Copyright (C) 2026 Free Software Foundation, Inc.
+
+# This program is free software: you can redistribute it and/or modify
+# it under the terms of the GNU General Public License as published by
+# the Free Software Foundation, either version 3 of the License, or
+# (at your option) any later version.
+
+# This program is distributed in the hope that it will be useful,
+# but WITHOUT ANY WARRANTY; without even the implied warranty of
+# MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+# GNU General Public License for more details.
+
+# You should have received a copy of the GNU General Public License
+# along with this program.  If not, see <https://www.gnu.org/licenses/>.
+
+. "${srcdir=.}/tests/init.sh"; path_prepend_ ./src
+print_ver_ sort cp du
+
+seq 10000 | shuf > in || framework_failure_
+
+# sort --stats reports on stderr and leaves the output untouched.
+sort in > exp || framework_failure_
+sort --stats in > out 2> err || fail=1
+compare exp out || fail=1
+grep 'lines read' err || { cat err; fail=1; }
+grep 'temporary files' err || { cat err; fail=1; }
+
+# A tiny buffer forces spills, which the report must show.
+sort --stats -S 50k in > out 2> err || fail=1
+compare exp out || fail=1
+grep ': 0 temporary files' err && { cat err; fail=1; }
+
+# -c also reports.
+sort --stats -c exp 2> err || fail=1
+grep 'lines read' err || { cat err; fail=1; }
+
+# cp --stats accounts for the copied bytes.
+cp --stats in copy 2> err || fail=1
+compare in copy || fail=1
+grep 'files copied' err || { cat err; fail=1; }
+grep '^cp: 0 files copied' err && { cat err; fail=1; }
+
+# du --stats counts entries and directories.
+mkdir -p d/e || framework_failure_
+touch d/f d/e/g || framework_failure_
+du --stats d > out 2> err || fail=1
+grep 'entries processed' err || { cat err; fail=1; }
+grep '^du: 0 entries' err && { cat err; fail=1; }
+
+# Without --stats, nothing is reported.
+sort in > out 2> err || fail=1
+compare /dev/null err || fail=1
+
+Exit $fail
@@ -0,0 +1,57 @@
+#!/bin/sh
+# Verify that cat, sort and tail honor _STDBUF_O without stdbuf
+
+# Copyright (C) 2026 Free Software Foundation, Inc.
+
+# This program is free software: you can redistribute it and/or modify
+# it under the terms of the GNU General Public License as published by
+# the Free Software Foundation, either version 3 of the License, or
+# (at your option) any later version.
+
+# This program is distributed in the hope that it will be useful,
+# but WITHOUT ANY WARRANTY; without even the implied warranty of
+# MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+# GNU General Public License for more details.
+
+# You should have received a copy of the GNU General Public License
+# along with this program.  If not, see <https://www.gnu.org/licenses/>.
+
+. "${srcdir=.}/tests/init.sh"; path_prepend_ ./src
+print_ver_ cat sort tail
+
+# These programs read the variable themselves, so an unusable request
+# is diagnosed with no stdbuf (or its preloaded library) involved,
+# and a valid or absent one is not.
+for prog in cat sort tail; do
+  _STDBUF_O=bad $prog /dev/null 2>err || fail=1
+  grep 'ignoring invalid buffering mode' err || fail=1
+  _STDBUF_O=L $prog /dev/null 2>err || fail=1
+  compare /dev/null err || fail=1
+  $prog /dev/null 2>err || fail=1
+  compare /dev/null err || fail=1
+done
+
+# cat treats an explicit size as its output block size.
+seq 10000 > in || framework_failure_
+_STDBUF_O=4096 cat in > out || fail=1
+compare in out || fail=1
+
+# Setting _STDBUF_O=L directly line-buffers tail's output.
+mkfifo_or_skip_ fifo
+cleanup_() { kill $pid 2>/dev/null && wait $pid; }
+
+native_linebuffer()
+{
+  local delay="$1"
+
+  printf '1\n' > exp
+  > out || framework_failure_
+  dd count=1 if=fifo > out 2> err & pid=$!
+  (printf '1\n'; sleep $delay; printf '2\n') | _STDBUF_O=L tail -n +1 > fifo
+  wait $pid
+  compare exp out
+}
+
+retry_delay_ native_linebuffer .1 6 || fail=1
+
+Exit $fail
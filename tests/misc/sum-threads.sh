@@ -0,0 +1,50 @@
+#!/bin/sh
+# Test that sum --threads matches sequential output exactly
+
+# Copyright (C) 2026 Free Software Foundation, Inc.
+
+# This program is free software: you can redistribute it and/or modify
+# it under the terms of the GNU General Public License as published by
+# the Free Software Foundation, either version 3 of the License, or
+# (at your option) any later version.
+
+# This program is distributed in the hope that it will be useful,
+# but WITHOUT ANY WARRANTY; without even the implied warranty of
+# MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+# GNU General Public License for more details.
+
+# You should have received a copy of the GNU General Public License
+# along with this program.  If not, see <https://www.gnu.org/licenses/>.
+
+. "${srcdir=.}/tests/init.sh"; path_prepend_ ./src
+print_ver_ sum
+
+for i in $(seq 40); do
+  printf '%2000s-%s\n' data $i > f$i || framework_failure_
+done
+
+# BSD and System V output must match the sequential order exactly.
+sum f* > exp || framework_failure_
+sum --threads=4 f* > out || fail=1
+compare exp out || fail=1
+
+sum -s f* > exp-s || framework_failure_
+sum -s --threads=4 f* > out-s || fail=1
+compare exp-s out-s || fail=1
+
+# Standard input mixed into the operand list is read on the main thread.
+echo stdin-data > in || framework_failure_
+sum f1 - f2 < in > exp-stdin || framework_failure_
+sum --threads=4 f1 - f2 < in > out-stdin || fail=1
+compare exp-stdin out-stdin || fail=1
+
+# An unreadable file must still fail, with the other results intact.
+returns_ 1 sum --threads=4 f1 missing f2 > out-err 2> err || fail=1
+grep missing err > /dev/null || fail=1
+sum f1 f2 > exp-partial || framework_failure_
+compare exp-partial out-err || fail=1
+
+# --threads=0 is rejected.
+returns_ 1 sum --threads=0 f1 || fail=1
+
+Exit $fail
@@ -38,6 +38,9 @@ sync file || fail=1
 # Ensure multiple args are processed and diagnosed
 returns_ 1 sync file nofile || fail=1
 
+# Multiple args on one file system collapse to a single syncfs
+sync -f file file || fail=1
+
 # Ensure inaccessible dirs give an appropriate error
 mkdir norw || framework_failure_
 chmod 0 norw || framework_failure_
@@ -55,6 +55,12 @@ my @Tests =
   ['opt-b', '-b', {IN=>"\na\nb\nc"}, {OUT=>"\nc\nb\na"}],
   ['opt-s', '-s:', {IN=>"a:b:c:"}, {OUT=>"c:b:a:"}],
   ['opt-sb', qw(-s : -b), {IN=>":a:b:c"}, {OUT=>":c:b:a"}],
+
+  # Self-overlapping separators: matches are found right to left
+  # and may not overlap each other.
+  ['opt-s2', qw(-s aa), {IN=>"xaaax"}, {OUT=>"xxaaa"}],
+  ['opt-s3', qw(-s aa), {IN=>"aaaa"}, {OUT=>"aaaa"}],
+  ['opt-sb2', qw(-s aa -b), {IN=>"aaa"}, {OUT=>"aaa"}],
   ['opt-r', qw(-r -s '\._+'),
    {IN=>"1._2.__3.___4._"},
    {OUT=>"4._3.___2.__1._"}],
@@ -71,7 +77,9 @@ my @Tests =
    {IN=>".__x.___y.____z._1._2.__3.___4"},
    {OUT=>".___4.__3._2._1.____z.___y.__x"}],
 
-  ['pipe-bad-tmpdir',
+  # Use -r, as fixed-string separators now buffer piped input in
+  # memory and need no temporary file unless the stream is huge.
+  ['pipe-bad-tmpdir', '-r',
    {ENV => "TMPDIR=$bad_dir"},
    {IN_PIPE => "a\n"},
    {ERR_SUBST => "s,'$bad_dir': .*,...,"},
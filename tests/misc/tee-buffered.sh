@@ -0,0 +1,54 @@
+#!/bin/sh
+# Test tee --buffer-size
+
+# Copyright (C) 2026 Free Software Foundation, Inc.
+
+# This program is free software: you can redistribute it and/or modify
+# it under the terms of the GNU General Public License as published by
+# the Free Software Foundation, either version 3 of the License, or
+# (at your option) any later version.
+
+# This program is distributed in the hope that it will be useful,
+# but WITHOUT ANY WARRANTY; without even the implied warranty of
+# MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+# GNU General Public License for more details.
+
+# You should have received a copy of the GNU General Public License
+# along with this program.  If not, see <https://www.gnu.org/licenses/>.
+
+. "${srcdir=.}/tests/init.sh"; path_prepend_ ./src
+print_ver_ tee
+
+seq 100000 > sample || framework_failure_
+
+# Buffered outputs receive the same data as in the default mode.
+tee --buffer-size=64K f1 f2 f3 < sample > out || fail=1
+for f in out f1 f2 f3; do
+  compare sample $f || fail=1
+done
+
+# Also with --append.
+tee -a --buffer-size=64K f1 < sample > out || fail=1
+cat sample sample > exp2 || framework_failure_
+compare exp2 f1 || fail=1
+
+# A failing output is still diagnosed, and the others stay complete.
+if test -w /dev/full && test -c /dev/full; then
+  returns_ 1 tee --buffer-size=64K /dev/full < sample > out 2>err || fail=1
+  compare sample out || fail=1
+  grep '/dev/full' err > /dev/null || fail=1
+fi
+
+# --buffer-full=drop does not fail; with input smaller than the
+# buffer nothing can be dropped, so all outputs stay complete.
+seq 1000 > small || framework_failure_
+tee --buffer-size=64K --buffer-full=drop f1 f2 < small > out || fail=1
+compare small out || fail=1
+compare small f1 || fail=1
+compare small f2 || fail=1
+
+# Option validation.
+returns_ 1 tee --buffer-size=1 f1 < sample > out || fail=1
+returns_ 1 tee --buffer-full=bogus f1 < sample > out || fail=1
+
+Exit $fail
@@ -0,0 +1,51 @@
+#!/bin/sh
+# Test tee with pipes as input and outputs, as exercised by the
+# zero-copy path on GNU/Linux
+
+# Copyright (C) 2026 Free Software Foundation, Inc.
+
+# This program is free software: you can redistribute it and/or modify
+# it under the terms of the GNU General Public License as published by
+# the Free Software Foundation, either version 3 of the License, or
+# (at your option) any later version.
+
+# This program is distributed in the hope that it will be useful,
+# but WITHOUT ANY WARRANTY; without even the implied warranty of
+# MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+# GNU General Public License for more details.
+
+# You should have received a copy of the GNU General Public License
+# along with this program.  If not, see <https://www.gnu.org/licenses/>.
+
+. "${srcdir=.}/tests/init.sh"; path_prepend_ ./src
+print_ver_ tee
+
+mkfifo_or_skip_ p1 p2
+
+seq 200000 > sample || framework_failure_
+
+# All outputs are pipes.
+cat p1 > f1 & pid1=$!
+cat p2 > f2 & pid2=$!
+cat sample | tee p1 p2 | cat > out || fail=1
+wait $pid1 $pid2
+compare sample f1 || fail=1
+compare sample f2 || fail=1
+compare sample out || fail=1
+
+# One regular file among the pipes.
+cat p1 > f1 & pid1=$!
+cat sample | tee p1 > out || fail=1
+wait $pid1
+compare sample f1 || fail=1
+compare sample out || fail=1
+
+# --append forgoes the fast path but must still be correct.
+cat p1 > f1 & pid1=$!
+cat sample | tee -a p1 out2 > out || fail=1
+wait $pid1
+compare sample f1 || fail=1
+compare sample out || fail=1
+compare sample out2 || fail=1
+
+Exit $fail
@@ -56,6 +56,9 @@ my @Tests =
   ['j', qw(-d '[:digit:]'), {IN=>'0123456789'}, {OUT=>''}],
   ['k', qw(-d '[:digit:]'),
    {IN=>'a0b1c2d3e4f5g6h7i8j9k'}, {OUT=>'abcdefghijk'}],
+  # Single-member delete sets take a separate path; exceed the I/O buffer.
+  ['k2', qw(-d x), {IN=>'axb' . 'xy' x 100000 . "x\n"},
+   {OUT=>'ab' . 'y' x 100000 . "\n"}],
   ['l', qw(-d '[:lower:]'), {IN=>'abcdefghijklmnopqrstuvwxyz'}, {OUT=>''}],
   ['m', qw(-d '[:upper:]'), {IN=>'ABCDEFGHIJKLMNOPQRSTUVWXYZ'}, {OUT=>''}],
   ['n', qw(-d '[:lower:][:upper:]'),
@@ -0,0 +1,58 @@
+#!/bin/sh
+# Validate truncate --allocate, --punch-hole and --collapse-range
+
+# Copyright (C) 2026 Free Software Foundation, Inc.
+
+# This program is free software: you can redistribute it and/or modify
+# it under the terms of the GNU General Public License as published by
+# the Free Software Foundation, either version 3 of the License, or
+# (at your option) any later version.
+
+# This program is distributed in the hope that it will be useful,
+# but WITHOUT ANY WARRANTY; without even the implied warranty of
+# MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+# GNU General Public License for more details.
+
+# You should have received a copy of the GNU General Public License
+# along with this program.  If not, see <https://www.gnu.org/licenses/>.
+
+. "${srcdir=.}/tests/init.sh"; path_prepend_ ./src
+print_ver_ truncate
+
+# an offset is only valid with an allocation mode
+returns_ 1 truncate --offset=1 -s1 file || fail=1
+
+# only one allocation mode at a time
+returns_ 1 truncate --allocate --punch-hole -s1 file || fail=1
+returns_ 1 truncate --punch-hole --collapse-range -s1 file || fail=1
+
+# the allocation modes still require a size
+returns_ 1 truncate --punch-hole file || fail=1
+
+# --allocate extends like -s, but the extension is not sparse
+if ! truncate --allocate -s1M alloc; then
+  skip_ 'this file system lacks fallocate support'
+fi
+test "$(stat -c %s alloc)" = 1048576 || fail=1
+truncate -s1M sparse || fail=1
+test "$(stat -c %b alloc)" -gt "$(stat -c %b sparse)" || fail=1
+
+# --punch-hole deallocates without changing the size, and the
+# punched range reads as zeros
+dd if=/dev/urandom of=holed bs=8192 count=16 status=none || framework_failure_
+if truncate --punch-hole --offset=8192 -s16K holed; then
+  test "$(stat -c %s holed)" = $((8192 * 16)) || fail=1
+  dd if=holed bs=8192 skip=1 count=2 status=none | tr -d '\0' > got || fail=1
+  compare /dev/null got || fail=1
+fi
+
+# --collapse-range cuts the range out; offset and size must be
+# block multiples, so skip quietly where the file system refuses
+seq 10000 > tail_data || framework_failure_
+dd if=/dev/zero bs=8192 count=1 status=none > collapsed || framework_failure_
+cat tail_data >> collapsed || framework_failure_
+if truncate --collapse-range -s8192 collapsed 2>/dev/null; then
+  compare tail_data collapsed || fail=1
+fi
+
+Exit $fail
@@ -0,0 +1,56 @@
+#!/bin/sh
+# Test truncate's batch options: --threads, --sync and --files0-from
+
+# Copyright (C) 2026 Free Software Foundation, Inc.
+
+# This program is free software: you can redistribute it and/or modify
+# it under the terms of the GNU General Public License as published by
+# the Free Software Foundation, either version 3 of the License, or
+# (at your option) any later version.
+
+# This program is distributed in the hope that it will be useful,
+# but WITHOUT ANY WARRANTY; without even the implied warranty of
+# MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+# GNU General Public License for more details.
+
+# You should have received a copy of the GNU General Public License
+# along with this program.  If not, see <https://www.gnu.org/licenses/>.
+
+. "${srcdir=.}/tests/init.sh"; path_prepend_ ./src
+print_ver_ truncate
+
+# A batch named with --files0-from, processed by several threads,
+# gives the same result as a serial command-line run.
+for i in $(seq 40); do
+  printf xyz > s-$i || framework_failure_
+  printf xyz > t-$i || framework_failure_
+done
+printf 't-%s\0' $(seq 40) > files0 || framework_failure_
+
+truncate -s 100 s-* || fail=1
+truncate -s 100 --threads=4 --files0-from=files0 || fail=1
+for i in $(seq 40); do
+  test "$(stat -c %s t-$i)" = "$(stat -c %s s-$i)" || fail=1
+done
+
+# Relative sizes work the same way threaded.
+truncate -s +5 --threads=4 t-* || fail=1
+test "$(stat -c %s t-1)" = 105 || fail=1
+
+# Each --sync mode accepts the batch; invalid modes are diagnosed.
+truncate -s 10 --sync=none t-1 || fail=1
+truncate -s 10 --sync=file t-1 t-2 || fail=1
+truncate -s 10 --sync=filesystem --threads=2 t-* || fail=1
+returns_ 1 truncate -s 10 --sync=later t-1 2>err || fail=1
+grep 'invalid argument' err || fail=1
+
+# An invalid thread count is diagnosed.
+returns_ 1 truncate -s 10 --threads=0 t-1 2>err || fail=1
+grep 'invalid number of threads' err || fail=1
+
+# A failure in one thread's share of the batch still fails the run.
+mkdir dir || framework_failure_
+returns_ 1 truncate -s 10 --threads=4 t-1 dir t-2 2>err || fail=1
+test "$(stat -c %s t-1)" = 10 || fail=1
+
+Exit $fail
@@ -0,0 +1,76 @@
+#!/bin/sh
+# Test tsort --stream
+
+# Copyright (C) 2026 Free Software Foundation, Inc.
+
+# This program is free software: you can redistribute it and/or modify
+# it under the terms of the GNU General Public License as published by
+# the Free Software Foundation, either version 3 of the License, or
+# (at your option) any later version.
+
+# This program is distributed in the hope that it will be useful,
+# but WITHOUT ANY WARRANTY; without even the implied warranty of
+# MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+# GNU General Public License for more details.
+
+# You should have received a copy of the GNU General Public License
+# along with this program.  If not, see <https://www.gnu.org/licenses/>.
+
+. "${srcdir=.}/tests/init.sh"; path_prepend_ ./src
+print_ver_ tsort
+
+cat > edges <<\EOF || framework_failure_
+a b
+a c
+b d
+c d
+d e
+c f
+f e
+EOF
+
+# The streamed output is a valid topological order: it contains each
+# string exactly once, and every pair comes out in input order.
+tsort --stream edges > out || fail=1
+sort out > got || framework_failure_
+tr ' ' '\n' < edges | sort -u > want || framework_failure_
+compare want got || fail=1
+while read u v; do
+  nu=$(grep -n "^$u\$" out | cut -d: -f1)
+  nv=$(grep -n "^$v\$" out | cut -d: -f1)
+  test "$nu" -lt "$nv" || fail=1
+done < edges
+
+# Output really streams: with the input still open, strings whose
+# predecessors are all written must already have been flushed.
+mkfifo_or_skip_ fifo
+tsort --stream fifo > out & tsort_pid=$!
+cleanup_() { kill $tsort_pid 2>/dev/null; }
+exec 3>fifo
+printf 'a b\n' >&3 || framework_failure_
+for i in $(seq 50); do
+  test -s out && break
+  sleep 0.1 || sleep 1
+done
+test -s out || fail=1
+exec 3>&-
+wait $tsort_pid || fail=1
+printf 'a\nb\n' > exp || framework_failure_
+compare exp out || fail=1
+
+# A predecessor arriving after its string was written is diagnosed.
+printf 'a b\nc a\n' > late || framework_failure_
+returns_ 1 tsort --stream late > /dev/null 2>err || fail=1
+grep 'predecessor specified after string was written' err || fail=1
+
+# A loop still makes tsort fail in stream mode: the pair closing it
+# necessarily names a predecessor for an already written string.
+printf 'a b\nb c\nc a\n' > loop || framework_failure_
+returns_ 1 tsort --stream loop > /dev/null 2>err || fail=1
+grep 'predecessor specified after string was written' err || fail=1
+
+# An odd number of tokens is rejected as usual.
+printf 'a b c\n' > odd || framework_failure_
+returns_ 1 tsort --stream odd > /dev/null 2>&1 || fail=1
+
+Exit $fail
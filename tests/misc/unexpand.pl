@@ -126,6 +126,16 @@ my @Tests =
      ['ts1', '-t8,9', {IN=>"x\t \t y\n"},    {OUT=>"x\t\t\t y\n"}],
      # There is no ambiguity here. This should always be the output.
      ['ts2', '-t5,8', {IN=>"x\t \t y\n"},    {OUT=>"x\t\t y\n"}],
+
+     # Before coreutils 9.1, a '/' or '+' specifier whose repeat size
+     # exceeded every gap in the explicit tab list could overrun the
+     # buffer of pending blanks.
+     ['of1', '-a -t1,2,/5', {IN=>"ab      c\n"}, {OUT=>"ab\t   c\n"}],
+     ['of2', '-a -t1,2,+5', {IN=>"ab     c\n"},  {OUT=>"ab\tc\n"}],
+
+     # Lines longer than the input buffer exercise the run scanner
+     ['long1', '-a', {IN=>"a" x 100000 . "        b\n"},
+      {OUT=>"a" x 100000 . "\tb\n"}],
     );
 
 my $save_temps = $ENV{DEBUG};
@@ -0,0 +1,47 @@
+#!/bin/sh
+# Test uniq --count-distinct, in particular the approximate sketch.
+
+# Copyright (C) 2026 Free Software Foundation, Inc.
+
+# This program is free software: you can redistribute it and/or modify
+# it under the terms of the GNU General Public License as published by
+# the Free Software Foundation, either version 3 of the License, or
+# (at your option) any later version.
+
+# This program is distributed in the hope that it will be useful,
+# but WITHOUT ANY WARRANTY; without even the implied warranty of
+# MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+# GNU General Public License for more details.
+
+# You should have received a copy of the GNU General Public License
+# along with this program.  If not, see <https://www.gnu.org/licenses/>.
+
+. "${srcdir=.}/tests/init.sh"; path_prepend_ ./src
+print_ver_ uniq
+
+seq 20000 > in || framework_failure_
+
+# Exact mode counts exactly, regardless of input order.
+test "$(uniq --count-distinct in)" = 20000 || fail=1
+test "$(shuf in | uniq --count-distinct)" = 20000 || fail=1
+
+# The sketch's standard error is under 1%; allow 5%.
+n=$(uniq --count-distinct=approximate in) || fail=1
+test 19000 -le "$n" && test "$n" -le 21000 || fail=1
+
+# Duplicates must not inflate either count.
+cat in in > in2 || framework_failure_
+test "$(uniq --count-distinct in2)" = 20000 || fail=1
+n=$(uniq --count-distinct=approximate in2) || fail=1
+test 19000 -le "$n" && test "$n" -le 21000 || fail=1
+
+# Both modes agree exactly on empty input.
+test "$(uniq --count-distinct /dev/null)" = 0 || fail=1
+test "$(uniq --count-distinct=approximate /dev/null)" = 0 || fail=1
+
+# With -z the count is NUL-terminated.
+printf 'a\0b\0' | uniq -z --count-distinct > out || fail=1
+printf '2\0' > exp || framework_failure_
+compare exp out || fail=1
+
+Exit $fail
@@ -228,6 +228,34 @@ my @Tests =
         "  - 'separate'\n" .
         "  - 'both'\n" .
         "Try '$prog --help' for more information.\n"}],
+ # Hash-based grouping of non-adjacent matching lines
+ ['146', '--unsorted', {IN=>"a\nb\na\n"}, {OUT=>"a\nb\n"}],
+ ['147', '--unsorted -c', {IN=>"a\nb\na\na\nb\nc\n"},
+  {OUT=>"      3 a\n      2 b\n      1 c\n"}],
+ ['148', '--unsorted -d', {IN=>"a\nb\na\nc\n"}, {OUT=>"a\n"}],
+ ['149', '--unsorted -u', {IN=>"a\nb\na\nc\n"}, {OUT=>"b\nc\n"}],
+ ['150', '--unsorted -i -c', {IN=>"A\nb\na\n"}, {OUT=>"      2 A\n      1 b\n"}],
+ ['151', '--unsorted -f1 -c', {IN=>"x a\ny b\nz a\n"},
+  {OUT=>"      2 x a\n      1 y b\n"}],
+ ['152', '--unsorted -w1 -c', {IN=>"ab\nac\nb\n"},
+  {OUT=>"      2 ab\n      1 b\n"}],
+ ['153', '--unsorted', {IN=>""}, {OUT=>""}],
+ # --unsorted would have to buffer all lines to honor -D or --group
+ ['154', '--unsorted -D',    {IN=>""}, {OUT=>""}, {EXIT=>1},
+  {ERR=>"$prog: --unsorted is mutually exclusive with -D/--group\n" .
+        "Try 'uniq --help' for more information.\n"}],
+ ['155', '--unsorted --group', {IN=>""}, {OUT=>""}, {EXIT=>1},
+  {ERR=>"$prog: --unsorted is mutually exclusive with -D/--group\n" .
+        "Try 'uniq --help' for more information.\n"}],
+ ['156', '--count-distinct', {IN=>"a\nb\na\nc\n"}, {OUT=>"3\n"}],
+ ['157', '--count-distinct=exact', {IN=>""}, {OUT=>"0\n"}],
+ ['158', '--count-distinct -i', {IN=>"A\na\nb\n"}, {OUT=>"2\n"}],
+ ['159', '--count-distinct -f1', {IN=>"x a\ny a\nz b\n"}, {OUT=>"2\n"}],
+ ['160', '--count-distinct -w2', {IN=>"abc\nabd\nac\n"}, {OUT=>"2\n"}],
+ ['161', '--count-distinct -c', {IN=>""}, {OUT=>""}, {EXIT=>1},
+  {ERR=>"$prog: --count-distinct is mutually exclusive with" .
+        " -c/-d/-D/-u/--group/--unsorted\n" .
+        "Try 'uniq --help' for more information.\n"}],
 );
 
 # Locale related tests
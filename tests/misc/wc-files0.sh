@@ -48,6 +48,25 @@ printf '%s\0' "$nlname" | wc --files0-from=- > out || fail=1
 printf '%s\n' "0 0 0 '1'\$'\\n''2'" > exp || framework_failure_
 compare exp out || fail=1
 
+# Ensure names with directory parts work, including repeated and mixed
+# directories, a missing directory, and a trailing slash.
+mkdir d1 d2 || framework_failure_
+echo a > d1/a || framework_failure_
+echo bb > d1/b || framework_failure_
+echo ccc > d2/c || framework_failure_
+printf '%s\0' d1/a d1/b d2/c d1/a nosuch/x d2/ \
+  | wc -c --files0-from=- > out 2>err; test $? = 1 || fail=1
+cat <<\EOF > exp || framework_failure_
+2 d1/a
+3 d1/b
+4 d2/c
+2 d1/a
+0 d2/
+11 total
+EOF
+compare exp out || fail=1
+test "$(wc -l < err)" = 2 || fail=1
+
 # Ensure correct byte counts, which fails between v8.24 and v8.26 inclusive
 truncate -s1G wc.big || framework_failure_
 touch wc.small || framework_failure_
@@ -0,0 +1,50 @@
+#!/bin/sh
+# Exercise the fast word count path used in multibyte locales
+
+# Copyright (C) 2026 Free Software Foundation, Inc.
+
+# This program is free software: you can redistribute it and/or modify
+# it under the terms of the GNU General Public License as published by
+# the Free Software Foundation, either version 3 of the License, or
+# (at your option) any later version.
+
+# This program is distributed in the hope that it will be useful,
+# but WITHOUT ANY WARRANTY; without even the implied warranty of
+# MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+# GNU General Public License for more details.
+
+# You should have received a copy of the GNU General Public License
+# along with this program.  If not, see <https://www.gnu.org/licenses/>.
+
+. "${srcdir=.}/tests/init.sh"; path_prepend_ ./src
+print_ver_ wc printf
+
+export LC_ALL=en_US.UTF-8
+test "$(locale charmap 2>/dev/null)" = UTF-8 \
+  || skip_ 'en_US.UTF-8 locale not available'
+
+# ASCII input must count identically to the C locale.
+seq 10000 | tr '0-9' 'a-j' | sed 's/ccc/ /g' > ascii || framework_failure_
+LC_ALL=C wc -lwm ascii > exp || framework_failure_
+wc -lwm ascii > out || fail=1
+compare exp out || fail=1
+
+# -L decodes every character; the counts it shares with -w must agree.
+env printf 'un deux\ttrois\n quatre 中文 cinq\n' > mb \
+  || framework_failure_
+wc -lwm mb > out || fail=1
+wc -lwmL mb | sed 's/ *[0-9]* [a-z]*$/ mb/' > out2 || fail=1
+compare out out2 || fail=1
+
+printf '%s\n' '6 mb' > exp || framework_failure_
+wc -w mb | sed 's/^ *//' > out || fail=1
+compare exp out || fail=1
+
+# Words split across buffer boundaries and invalid bytes.
+{ seq 100000 | tr -d '\n'; env printf '\xff\xc3 fin\n'; } > big \
+  || framework_failure_
+printf '%s\n' '2 big' > exp || framework_failure_
+wc -w big | sed 's/^ *//' > out || fail=1
+compare exp out || fail=1
+
+Exit $fail
@@ -0,0 +1,78 @@
+#!/bin/sh
+# Ensure wc --threads counts match the sequential counts
+
+# Copyright (C) 2026 Free Software Foundation, Inc.
+
+# This program is free software: you can redistribute it and/or modify
+# it under the terms of the GNU General Public License as published by
+# the Free Software Foundation, either version 3 of the License, or
+# (at your option) any later version.
+
+# This program is distributed in the hope that it will be useful,
+# but WITHOUT ANY WARRANTY; without even the implied warranty of
+# MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+# GNU General Public License for more details.
+
+# You should have received a copy of the GNU General Public License
+# along with this program.  If not, see <https://www.gnu.org/licenses/>.
+
+. "${srcdir=.}/tests/init.sh"; path_prepend_ ./src
+print_ver_ wc
+
+seq 200000 > big || framework_failure_
+printf 'no trailing newline' > tailless || framework_failure_
+: > empty || framework_failure_
+
+for f in big tailless empty; do
+  wc -l "$f" > exp || framework_failure_
+  wc -l --threads=4 "$f" > out || fail=1
+  compare exp out || fail=1
+
+  wc -cl "$f" > exp || framework_failure_
+  wc -cl --threads=4 "$f" > out || fail=1
+  compare exp out || fail=1
+done
+
+# Multiple files, with a total
+wc -l big tailless empty > exp || framework_failure_
+wc -l --threads=4 big tailless empty > out || fail=1
+compare exp out || fail=1
+
+# Non-regular input still works
+wc -l --threads=4 < big > out || fail=1
+cat big | wc -l --threads=4 > out2 || fail=1
+wc -l < big > exp || framework_failure_
+compare exp out || fail=1
+compare exp out2 || fail=1
+
+# Word counting is unaffected by --threads
+wc -lw --threads=4 big > out || fail=1
+wc -lw big > exp || framework_failure_
+compare exp out || fail=1
+
+returns_ 1 wc -l --threads=0 big 2>/dev/null || fail=1
+
+# Per-file parallelism: results and the total stay in input order
+for i in $(seq 30); do seq $i > m$i || framework_failure_; done
+wc -lwc m* > exp || framework_failure_
+wc -lwc --threads=8 m* > out || fail=1
+compare exp out || fail=1
+
+# A missing file affects the exit status, not the other results
+wc -l m1 missing m2 2>/dev/null > exp
+wc -l --threads=8 m1 missing m2 2>/dev/null > out
+compare exp out || fail=1
+returns_ 1 wc -l --threads=8 m1 missing m2 2>/dev/null || fail=1
+
+# Standard input mixed with file operands is read on the main thread
+printf 'x\ny\n' | wc -l m1 - m2 > exp || framework_failure_
+printf 'x\ny\n' | wc -l --threads=8 m1 - m2 > out || fail=1
+compare exp out || fail=1
+
+# --files0-from lists are also counted concurrently
+printf 'm1\0m2\0m3\0' > names || framework_failure_
+wc -l --files0-from=names > exp || framework_failure_
+wc -l --threads=8 --files0-from=names > out || fail=1
+compare exp out || fail=1
+
+Exit $fail
@@ -0,0 +1,62 @@
+#!/bin/sh
+# Test mkdir --threads
+
+# Copyright (C) 2026 Free Software Foundation, Inc.
+
+# This program is free software: you can redistribute it and/or modify
+# it under the terms of the GNU General Public License as published by
+# the Free Software Foundation, either version 3 of the License, or
+# (at your option) any later version.
+
+# This program is distributed in the hope that it will be useful,
+# but WITHOUT ANY WARRANTY; without even the implied warranty of
+# MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+# GNU General Public License for more details.
+
+# You should have received a copy of the GNU General Public License
+# along with this program.  If not, see <https://www.gnu.org/licenses/>.
+
+. "${srcdir=.}/tests/init.sh"; path_prepend_ ./src
+print_ver_ mkdir
+
+# Plain operands, concurrently.
+dirs=
+for i in 1 2 3 4 5 6 7 8 9 10; do
+  dirs="$dirs d$i"
+done
+mkdir --threads=4 $dirs || fail=1
+for d in $dirs; do
+  test -d $d || fail=1
+done
+
+# Deep -p trees sharing ancestors, including trailing slashes.
+mkdir -p --threads=4 \
+  t/a/b/c1/d t/a/b/c2/d t/a/b/c3/d/ t/x/y t/x/z || fail=1
+for d in t/a/b/c1/d t/a/b/c2/d t/a/b/c3/d t/x/y t/x/z; do
+  test -d $d || fail=1
+done
+
+# -p must still accept existing directories but not files.
+touch file || framework_failure_
+mkdir -p --threads=2 t/x/y file d1 2>err && fail=1
+grep 'file' err || fail=1
+grep 'd1' err && fail=1
+
+# Modes must match the serial engine, for -m and for plain umask.
+(umask 077 && mkdir --threads=2 m1 m2) || fail=1
+case $(ls -ld m1) in drwx------*) ;; *) fail=1;; esac
+mkdir -m 705 --threads=2 -p n1/s n2/s || fail=1
+case $(ls -ld n1/s) in drwx---r-x*) ;; *) fail=1;; esac
+case $(ls -ld n1) in drwx*) ;; *) fail=1;; esac
+
+# One message per created directory with --verbose.
+mkdir -pv --threads=4 v/a/b v/a/c v/d > out || fail=1
+test "$(wc -l < out)" = 5 || fail=1
+
+# Without -p, an existing directory is still an error.
+returns_ 1 mkdir --threads=2 m1 m3 2>/dev/null || fail=1
+test -d m3 || fail=1
+
+returns_ 1 mkdir --threads=0 q 2>/dev/null || fail=1
+
+Exit $fail
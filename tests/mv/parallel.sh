@@ -0,0 +1,46 @@
+#!/bin/sh
+# Ensure that mv --parallel moves trees between partitions intact.
+
+# Copyright (C) 2021 Free Software Foundation, Inc.
+
+# This program is free software: you can redistribute it and/or modify
+# it under the terms of the GNU General Public License as published by
+# the Free Software Foundation, either version 3 of the License, or
+# (at your option) any later version.
+
+# This program is distributed in the hope that it will be useful,
+# but WITHOUT ANY WARRANTY; without even the implied warranty of
+# MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+# GNU General Public License for more details.
+
+# You should have received a copy of the GNU General Public License
+# along with this program.  If not, see <https://www.gnu.org/licenses/>.
+
+. "${srcdir=.}/tests/init.sh"; path_prepend_ ./src
+print_ver_ mv
+cleanup_() { rm -rf "$other_partition_tmpdir"; }
+. "$abs_srcdir/tests/other-fs-tmpdir"
+
+mkdir -p t/sub1 t/sub2/sub3 || framework_failure_
+for i in $(seq 50); do
+  echo data-$i > t/f$i || framework_failure_
+  echo sub-$i > t/sub1/f$i || framework_failure_
+done
+echo deep > t/sub2/sub3/f || framework_failure_
+ln -s f1 t/slink || framework_failure_
+ln t/f2 t/hardlink || framework_failure_
+cp -R t expected || framework_failure_
+
+mv --parallel=4 t "$other_partition_tmpdir" || fail=1
+test -e t && fail=1
+
+# Symlinks are copied as symlinks, so compare everything but them
+# by content, and the symlink by its target.
+find expected -type l -delete || framework_failure_
+find "$other_partition_tmpdir/t" -type l | sort > symlinks || fail=1
+echo "$other_partition_tmpdir/t/slink" > symlinks_exp
+compare symlinks_exp symlinks || fail=1
+rm "$other_partition_tmpdir/t/slink" || framework_failure_
+diff -r expected "$other_partition_tmpdir/t" || fail=1
+
+Exit $fail
@@ -0,0 +1,66 @@
+#!/bin/sh
+# Ensure that rm -r --parallel removes the same trees as a serial rm.
+
+# Copyright (C) 2021 Free Software Foundation, Inc.
+
+# This program is free software: you can redistribute it and/or modify
+# it under the terms of the GNU General Public License as published by
+# the Free Software Foundation, either version 3 of the License, or
+# (at your option) any later version.
+
+# This program is distributed in the hope that it will be useful,
+# but WITHOUT ANY WARRANTY; without even the implied warranty of
+# MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+# GNU General Public License for more details.
+
+# You should have received a copy of the GNU General Public License
+# along with this program.  If not, see <https://www.gnu.org/licenses/>.
+
+. "${srcdir=.}/tests/init.sh"; path_prepend_ ./src
+print_ver_ rm
+
+make_tree_ ()
+{
+  mkdir -p t/sub1 t/sub2/sub3 || framework_failure_
+  for i in $(seq 50); do
+    echo data-$i > t/f$i || framework_failure_
+    echo sub-$i > t/sub1/f$i || framework_failure_
+  done
+  echo deep > t/sub2/sub3/f || framework_failure_
+  ln -s f1 t/slink || framework_failure_
+  ln t/f1 t/hardlink || framework_failure_
+  mkfifo t/fifo || framework_failure_
+}
+
+make_tree_
+rm -r --parallel=4 t || fail=1
+test -e t && fail=1
+
+# With --verbose, the same set of names must be reported, in some order.
+make_tree_
+rm -rv t | sort > exp || fail=1
+make_tree_
+rm -rv --parallel=4 t | sort > out || fail=1
+compare exp out || fail=1
+
+# An entry the workers cannot unlink must still be diagnosed, and the
+# exit status must match the serial traversal's.
+if ! uid_is_privileged_; then
+  make_tree_
+  chmod a-w t/sub1 || framework_failure_
+  rm -rf t 2>/dev/null; serial_status=$?
+  chmod u+w t/sub1 2>/dev/null; rm -rf t
+
+  make_tree_
+  chmod a-w t/sub1 || framework_failure_
+  rm -rf --parallel=4 t 2>err; parallel_status=$?
+  test $serial_status = $parallel_status || fail=1
+  test -s err || fail=1
+  chmod u+w t/sub1 2>/dev/null; rm -rf t
+fi
+
+# --parallel=0 is rejected.
+mkdir t || framework_failure_
+returns_ 1 rm -r --parallel=0 t || fail=1
+
+Exit $fail
@@ -0,0 +1,62 @@
+#!/bin/sh
+# Exercise split --bytes, in particular the copy_file_range path
+# taken for regular files and its buffered fallback for pipes.
+
+# Copyright (C) 2021 Free Software Foundation, Inc.
+
+# This program is free software: you can redistribute it and/or modify
+# it under the terms of the GNU General Public License as published by
+# the Free Software Foundation, either version 3 of the License, or
+# (at your option) any later version.
+
+# This program is distributed in the hope that it will be useful,
+# but WITHOUT ANY WARRANTY; without even the implied warranty of
+# MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+# GNU General Public License for more details.
+
+# You should have received a copy of the GNU General Public License
+# along with this program.  If not, see <https://www.gnu.org/licenses/>.
+
+. "${srcdir=.}/tests/init.sh"; path_prepend_ ./src
+print_ver_ split
+
+seq 100000 > in || framework_failure_
+
+check_pieces ()
+{
+  cat x?? > out || fail=1
+  compare in out || fail=1
+  rm -f x?? out
+}
+
+# Regular file operand.
+split -b 100000 in || fail=1
+check_pieces
+
+# Regular file on stdin.
+split -b 100000 < in || fail=1
+check_pieces
+
+# Pipe input takes the buffered path.
+cat in | split -b 100000 || fail=1
+check_pieces
+
+# A piece size larger than the input gives a single piece.
+split -b 10M in || fail=1
+test -f xaa && ! test -f xab || fail=1
+check_pieces
+
+# An input that is an exact multiple of the piece size must not
+# produce a trailing empty piece.
+head -c 4096 in > in4k || framework_failure_
+split -b 1024 in4k || fail=1
+test -f xad && ! test -f xae || fail=1
+cat x?? > out || fail=1
+compare in4k out || fail=1
+rm -f x?? out
+
+# Empty input produces no output files.
+split -b 1024 /dev/null || fail=1
+ls x?? 2>/dev/null && fail=1
+
+Exit $fail
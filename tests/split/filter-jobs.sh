@@ -0,0 +1,66 @@
+#!/bin/sh
+# Exercise split --filter with concurrent filter processes (--jobs).
+
+# Copyright (C) 2021 Free Software Foundation, Inc.
+
+# This program is free software: you can redistribute it and/or modify
+# it under the terms of the GNU General Public License as published by
+# the Free Software Foundation, either version 3 of the License, or
+# (at your option) any later version.
+
+# This program is distributed in the hope that it will be useful,
+# but WITHOUT ANY WARRANTY; without even the implied warranty of
+# MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+# GNU General Public License for more details.
+
+# You should have received a copy of the GNU General Public License
+# along with this program.  If not, see <https://www.gnu.org/licenses/>.
+
+. "${srcdir=.}/tests/init.sh"; path_prepend_ ./src
+print_ver_ split
+
+# --jobs requires --filter
+returns_ 1 split -j4 in 2>/dev/null && fail=1
+
+# Output must be identical to a serial run, chunk for chunk.
+seq 10000 > in || framework_failure_
+
+split -l100 --filter='cat > $FILE.serial' in out- || fail=1
+split -l100 -j4 --filter='cat > $FILE.jobs' in out- || fail=1
+for f in out-*.serial; do
+  compare "$f" "${f%.serial}.jobs" || fail=1
+done
+cat out-*.jobs > out || fail=1
+compare in out || fail=1
+rm -f out*
+
+# A slow filter must not serialize its siblings; mainly check that all
+# children are reaped and the data is intact.
+split -l2500 -j8 --filter='sleep .1; cat > $FILE' in || fail=1
+cat x?? > out || fail=1
+compare in out || fail=1
+
+# A failing filter propagates its exit status, even when reaped late.
+returns_ 2 split -l2500 -j4 --filter='exit 2' in 2>/dev/null || fail=1
+
+# With -n each filter's chunk is read by a dedicated feeder process;
+# chunk boundaries and contents must match a serial run exactly.
+split -n7 --filter='cat > $FILE.serial' in out- || fail=1
+split -n7 -j4 --filter='cat > $FILE.jobs' in out- || fail=1
+for f in out-*.serial; do
+  compare "$f" "${f%.serial}.jobs" || fail=1
+done
+rm -f out*
+
+# More chunks than bytes, with and without the parallel feeders.
+printf 'abc' > short || framework_failure_
+split -e -n5 --filter='cat > $FILE.serial' short out- || fail=1
+split -e -n5 -j4 --filter='cat > $FILE.jobs' short out- || fail=1
+for f in out-*.serial; do
+  compare "$f" "${f%.serial}.jobs" || fail=1
+done
+
+# A failing feeder's filter must not hang, and the status propagates.
+returns_ 2 split -n4 -j4 --filter='exit 2' in 2>/dev/null || fail=1
+
+Exit $fail
@@ -0,0 +1,59 @@
+#!/bin/sh
+# Test touch --recursive
+
+# Copyright (C) 2026 Free Software Foundation, Inc.
+
+# This program is free software: you can redistribute it and/or modify
+# it under the terms of the GNU General Public License as published by
+# the Free Software Foundation, either version 3 of the License, or
+# (at your option) any later version.
+
+# This program is distributed in the hope that it will be useful,
+# but WITHOUT ANY WARRANTY; without even the implied warranty of
+# MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+# GNU General Public License for more details.
+
+# You should have received a copy of the GNU General Public License
+# along with this program.  If not, see <https://www.gnu.org/licenses/>.
+
+. "${srcdir=.}/tests/init.sh"; path_prepend_ ./src
+print_ver_ touch
+
+mkdir -p t/a/b t/c || framework_failure_
+for f in t/f1 t/a/f2 t/a/b/f3 t/c/f4; do
+  touch $f || framework_failure_
+done
+
+# Every file and directory in the tree must end up with the given stamp.
+touch -t 202001010101 ref || framework_failure_
+touch -R -t 202001010101 t || fail=1
+for f in t t/a t/a/b t/c t/f1 t/a/f2 t/a/b/f3 t/c/f4; do
+  test $f -nt ref && fail=1
+  test $f -ot ref && fail=1
+done
+
+# The same, through the worker pool.
+touch -R --threads=4 -t 202002020202 t || fail=1
+touch -t 202002020202 ref || framework_failure_
+for f in t t/a t/a/b t/c t/f1 t/a/f2 t/a/b/f3 t/c/f4; do
+  test $f -nt ref && fail=1
+  test $f -ot ref && fail=1
+done
+
+# -R does not create missing operands.
+returns_ 1 touch -R t/missing 2>err || fail=1
+grep 'missing' err || fail=1
+test -e t/missing && fail=1
+
+# ...but with -c a missing operand is not an error, as for plain touch.
+touch -R -c t/missing || fail=1
+
+# -h must stamp the symlink itself, not its (missing) referent.
+if ln -s nowhere t/dangle 2>/dev/null; then
+  touch -R -c -h -t 202001010101 t/dangle || fail=1
+  test -e t/nowhere && fail=1
+fi
+
+returns_ 1 touch -R --threads=0 t 2>/dev/null || fail=1
+
+Exit $fail